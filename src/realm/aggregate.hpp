@@ -21,6 +21,8 @@
 
 #include <realm/column_type_traits.hpp>
 #include <realm/array.hpp>
+#include <realm/array_basic.hpp>
+#include <realm/array_integer.hpp>
 #include <realm/query_conditions.hpp>
 
 namespace realm {
@@ -87,6 +89,106 @@ struct FindInLeaf<ArrayIntNull> {
     }
 };
 
+// Aggregates a whole leaf in one go, without a state update per value. Returns false if the leaf cannot be handled
+// this way, in which case the caller must fall back to FindInLeaf.
+template <class LeafType>
+struct ReduceLeaf {
+    template <Action action, class R>
+    static bool reduce(const LeafType&, bool, QueryState<R>&)
+    {
+        return false;
+    }
+};
+
+template <Action action, class R, class T>
+inline void update_minmax(QueryState<R>& state, T value, size_t index)
+{
+    if (action == act_Max ? value > state.m_state : value < state.m_state) {
+        state.m_state = value;
+        state.m_minmax_index = state.m_key_values ? state.m_key_values->get(index) + state.m_key_offset : index;
+    }
+}
+
+template <>
+struct ReduceLeaf<ArrayInteger> {
+    template <Action action>
+    static bool reduce(const ArrayInteger& leaf, bool, QueryState<int64_t>& state)
+    {
+        size_t sz = leaf.size();
+        if (sz == 0)
+            return true;
+        if (action == act_Sum) {
+            state.m_state += leaf.get_sum(0, sz);
+        }
+        else {
+            int64_t value;
+            size_t index;
+            if (action == act_Max)
+                leaf.maximum(value, 0, sz, &index);
+            else
+                leaf.minimum(value, 0, sz, &index);
+            update_minmax<action>(state, value, index);
+        }
+        state.m_match_count += sz;
+        return true;
+    }
+};
+
+template <>
+struct ReduceLeaf<ArrayIntNull> {
+    template <Action action>
+    static bool reduce(const ArrayIntNull& leaf, bool, QueryState<int64_t>& state)
+    {
+        // Element 0 holds the value used to represent null, the payload starts at index 1
+        size_t sz = leaf.size();
+        if (sz == 0)
+            return true;
+        int64_t null_value = leaf.null_value();
+        size_t null_count = leaf.Array::count(null_value) - 1;
+        if (action == act_Sum) {
+            // Sum everything and take the nulls out again. Unsigned arithmetic gives the same wrap around as
+            // adding the non-null values one by one.
+            uint64_t sum = uint64_t(leaf.get_sum(1, sz + 1)) - uint64_t(null_value) * null_count;
+            state.m_state = int64_t(uint64_t(state.m_state) + sum);
+        }
+        else {
+            // The null value may be anywhere in the range of the current width, so nulls cannot simply be
+            // ignored by a min/max scan
+            if (null_count > 0)
+                return false;
+            int64_t value;
+            size_t index;
+            if (action == act_Max)
+                leaf.Array::maximum(value, 1, sz + 1, &index);
+            else
+                leaf.Array::minimum(value, 1, sz + 1, &index);
+            update_minmax<action>(state, value, index - 1);
+        }
+        state.m_match_count += sz - null_count;
+        return true;
+    }
+};
+
+template <class T>
+struct ReduceLeaf<BasicArray<T>> {
+    template <Action action, class R>
+    static bool reduce(const BasicArray<T>& leaf, bool, QueryState<R>& state)
+    {
+        if (action == act_Sum) {
+            size_t value_count;
+            state.m_state += leaf.sum(value_count);
+            state.m_match_count += value_count;
+        }
+        else {
+            T value = T(state.m_state);
+            size_t index = 0;
+            state.m_match_count += leaf.template minmax_non_null<action == act_Max>(value, index);
+            update_minmax<action>(state, value, index);
+        }
+        return true;
+    }
+};
+
 } // namespace _aggr
 
 template <Action action, typename T>
@@ -102,6 +204,10 @@ public:
     }
     bool operator()(QueryState<ResultType>& st, T value) const
     {
+        if (action == act_Sum || action == act_Max || action == act_Min) {
+            if (_aggr::ReduceLeaf<LeafType>::template reduce<action>(m_leaf, m_nullable, st))
+                return true;
+        }
         if (action == act_Sum) {
             if (m_nullable)
                 return _aggr::FindInLeaf<LeafType>::template find<act_Sum, NotNull, T, ResultType>(m_leaf, value, st);
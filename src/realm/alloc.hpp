@@ -125,6 +125,10 @@ public:
     {
         m_is_read_only = ro;
     }
+    bool is_read_only() const noexcept
+    {
+        return m_is_read_only;
+    }
     /// Returns a simple allocator that can be used with free-standing
     /// Realm objects (such as a free-standing table). A
     /// free-standing object is one that is not part of a Group, and
@@ -20,6 +20,7 @@
 #include <cstring> // std::memcpy
 #include <iomanip>
 #include <limits>
+#include <memory>
 #include <tuple>
 
 #ifdef REALM_DEBUG
@@ -293,6 +294,128 @@ ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out) const
 }
 
 
+ref_type Array::do_write_compressed(_impl::ArrayWriterBase& out) const
+{
+    // An encoded array is written as it is. A plain one is encoded if that
+    // needs fewer bytes than the elements, either as offsets from its smallest
+    // element, or, if its elements are in ascending order, as offsets from a
+    // line through the first and the last one (delta encoding with a fixed
+    // step). The latter suits timestamps and increasing IDs, whose offsets
+    // from the line are much smaller than their range, and keeps get() O(1),
+    // unlike storing the difference to the preceding element. Offsets are
+    // stored as elements of a signed width, so a range that needs 64 bits
+    // gains nothing.
+    if (out.compress_integer_leaves() && !m_is_encoded && get_wtype_from_header(get_header()) == wtype_Bits) {
+        size_t best_byte_size = get_byte_size();
+        int64_t best_base = 0, best_step = 0;
+        size_t best_width = 0;
+        auto consider = [&](int64_t base, int64_t step, uint64_t range) {
+            if (range > uint64_t(ubound_for_width(32)))
+                return;
+            uint_least8_t width = uint_least8_t(bit_width(int64_t(range)));
+            size_t byte_size = calc_byte_size(wtype_FrameOfReference, m_size, width);
+            if (byte_size < best_byte_size) {
+                best_byte_size = byte_size;
+                best_base = base;
+                best_step = step;
+                best_width = width;
+            }
+        };
+
+        int64_t min = 0, max = 0;
+        if (m_size != 0) {
+            minimum(min);
+            maximum(max);
+        }
+        uint64_t range = uint64_t(max) - uint64_t(min);
+        consider(min, 0, range);
+
+        // The first element is the smallest and the last one the largest of
+        // an ascending array. A step of zero would be the encoding above.
+        if (m_size > 2 && get(0) == min && get(m_size - 1) == max && range / (m_size - 1) != 0 &&
+            range <= uint64_t(std::numeric_limits<int64_t>::max())) {
+            uint64_t step = range / (m_size - 1);
+            // The distance of an element from the line is less than the range
+            int64_t min_offset = 0, max_offset = 0;
+            bool ascending = true;
+            int64_t prev = min;
+            for (size_t i = 1; i < m_size && ascending; ++i) {
+                int64_t v = get(i);
+                ascending = v >= prev;
+                prev = v;
+                int64_t offset = int64_t(uint64_t(v) - uint64_t(min) - step * i);
+                min_offset = std::min(min_offset, offset);
+                max_offset = std::max(max_offset, offset);
+            }
+            if (ascending)
+                consider(int64_t(uint64_t(min) + uint64_t(min_offset)), int64_t(step),
+                         uint64_t(max_offset) - uint64_t(min_offset));
+        }
+
+        if (best_byte_size < get_byte_size())
+            return do_write_encoded(out, best_base, best_step, best_width); // Throws
+    }
+    return do_write_shallow(out); // Throws
+}
+
+
+// Frame-of-reference encoding stores element i as its offset from
+// base + i * step, using the width needed for the largest offset. An encoded
+// leaf is decoded by copy-on-write.
+ref_type Array::do_write_encoded(_impl::ArrayWriterBase& out, int64_t base, int64_t step, size_t width) const
+{
+    size_t byte_size = calc_byte_size(wtype_FrameOfReference, m_size, uint_least8_t(width));
+    std::unique_ptr<char[]> buffer(new char[byte_size]()); // Throws
+    char* header = buffer.get();
+    init_header(header, false, false, m_context_flag, wtype_FrameOfReference, int(width), m_size, byte_size);
+    char* data = get_data_from_header(header);
+    for (size_t i = 0; i < m_size; ++i)
+        set_direct(data, width, i, int64_t(uint64_t(get(i)) - uint64_t(base) - uint64_t(step) * i));
+    std::memcpy(header + byte_size - 2 * sizeof(step), &step, sizeof(step));
+    std::memcpy(header + byte_size - sizeof(base), &base, sizeof(base));
+
+    uint32_t dummy_checksum = 0x41414141UL;                            // "AAAA" in ASCII
+    ref_type new_ref = out.write_array(header, byte_size, dummy_checksum); // Throws
+    REALM_ASSERT_3(new_ref % 8, ==, 0);                                    // 8-byte alignment
+    return new_ref;
+}
+
+MemRef Array::create_decoded(Allocator& target_alloc) const
+{
+    REALM_ASSERT_DEBUG(m_is_encoded);
+    int64_t min = 0, max = 0;
+    if (m_size != 0) {
+        minimum(min);
+        maximum(max);
+    }
+    // Array::create() chooses the width from the initial value
+    int64_t widest = bit_width(min) > bit_width(max) ? min : max;
+    MemRef mem = create(type_Normal, m_context_flag, wtype_Bits, m_size, widest, target_alloc); // Throws
+    char* header = mem.get_addr();
+    char* data = get_data_from_header(header);
+    size_t width = get_width_from_header(header);
+    for (size_t i = 0; i < m_size; ++i)
+        set_direct(data, width, i, get(i));
+    return mem;
+}
+
+void Array::do_copy_on_write(size_t minimum_size)
+{
+    if (!m_is_encoded) {
+        Node::do_copy_on_write(minimum_size);
+        return;
+    }
+
+    // The decoded copy has a different width, so the accessor is attached
+    // anew. Growing the copy beyond its size is left to alloc().
+    ref_type old_ref = m_ref;
+    const char* old_header = get_header_from_data(m_data);
+    MemRef mem = create_decoded(m_alloc); // Throws
+    init_from_mem(mem);
+    update_parent(); // Throws
+    m_alloc.free_(old_ref, old_header);
+}
+
 ref_type Array::do_write_deep(_impl::ArrayWriterBase& out, bool only_if_modified) const
 {
     // Temp array for updated refs
@@ -355,6 +478,9 @@ void Array::move(Array& dst, size_t ndx)
 {
     size_t dest_begin = dst.m_size;
     size_t nb_to_move = m_size - ndx;
+    // The bounds of an encoded array apply to its offsets
+    if (m_is_encoded)
+        copy_on_write(); // Throws
     dst.copy_on_write();
     dst.ensure_minimum_width(this->m_ubound);
     dst.alloc(dst.m_size + nb_to_move, dst.m_width); // Make room for the new elements
@@ -443,6 +569,9 @@ void Array::insert(size_t ndx, int_fast64_t value)
 {
     REALM_ASSERT_DEBUG(ndx <= m_size);
 
+    // Copy first, as that may change the width of an encoded array
+    copy_on_write(); // Throws
+
     const auto old_width = m_width;
     const auto old_size = m_size;
     const Getter old_getter = m_getter; // Save old getter before potential width expansion
@@ -562,6 +691,9 @@ void Array::truncate_and_destroy_children(size_t new_size)
 void Array::do_ensure_minimum_width(int_fast64_t value)
 {
 
+    // Copy first, as that may change the width of an encoded array
+    copy_on_write(); // Throws
+
     // Make room for the new value
     const size_t width = bit_width(value);
 
@@ -720,11 +852,30 @@ size_t find_zero(uint64_t v)
 } // namespace
 
 
+#ifdef REALM_COMPILER_SSE
+namespace {
+
+// Lane-wise signed maximum (or minimum) of two vectors of packed w-bit integers
 template <bool find_max, size_t w>
-bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+inline __m128i minmax_sse(__m128i a, __m128i b)
 {
-    size_t best_index = 0;
+    if (w == 8)
+        return find_max ? _mm_max_epi8(a, b) : _mm_min_epi8(a, b);
+    if (w == 16)
+        return find_max ? _mm_max_epi16(a, b) : _mm_min_epi16(a, b);
+    if (w == 32)
+        return find_max ? _mm_max_epi32(a, b) : _mm_min_epi32(a, b);
+    // There is no 64 bit min/max before AVX-512, so select through a compare mask
+    __m128i a_wins = find_max ? _mm_cmpgt_epi64(a, b) : _mm_cmpgt_epi64(b, a);
+    return _mm_or_si128(_mm_and_si128(a_wins, a), _mm_andnot_si128(a_wins, b));
+}
 
+} // anonymous namespace
+#endif
+
+template <bool find_max, size_t w>
+bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+{
     if (end == size_t(-1))
         end = m_size;
     REALM_ASSERT_11(start, <, m_size, &&, end, <=, m_size, &&, start, <, end);
@@ -734,59 +885,58 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
 
     if (w == 0) {
         if (return_ndx)
-            *return_ndx = best_index;
+            *return_ndx = start;
         result = 0;
         return true;
     }
 
+    size_t best_index = start;
     int64_t m = get<w>(start);
     ++start;
 
-#if 0 // We must now return both value AND index of result. SSE does not support finding index, so we've disabled it
 #ifdef REALM_COMPILER_SSE
-    if (sseavx<42>()) {
+    // SSE cannot track the position of the extreme value, so we only find the value here and then look up its first
+    // occurrence with find_first(), which is vectorized as well.
+    if ((w == 8 || w == 16 || w == 32 || w == 64) && end - start > 2 * sizeof(__m128i) * 8 / no0(w) &&
+        sseavx<42>()) {
+        const size_t first = best_index;
+
         // Test manually until 128 bit aligned
-        for (; (start < end) && (((size_t(m_data) & 0xf) * 8 + start * w) % (128) != 0); start++) {
-            if (find_max ? get<w>(start) > m : get<w>(start) < m) {
-                m = get<w>(start);
-                best_index = start;
-            }
+        for (; (start < end) && (((size_t(m_data) & 0xf) * 8 + start * w) % 128 != 0); start++) {
+            const int64_t v = get<w>(start);
+            if (find_max ? v > m : v < m)
+                m = v;
         }
 
-        if ((w == 8 || w == 16 || w == 32) && end - start > 2 * sizeof (__m128i) * 8 / no0(w)) {
-            __m128i* data = reinterpret_cast<__m128i*>(m_data + start * w / 8);
+        const __m128i* data = reinterpret_cast<__m128i*>(m_data + start * w / 8);
+        const size_t chunks = (end - start) * w / 8 / sizeof(__m128i);
+        if (chunks > 0) {
             __m128i state = data[0];
-            char state2[sizeof (state)];
+            for (size_t t = 1; t < chunks; t++)
+                state = minmax_sse<find_max, w>(state, data[t]);
+            start += chunks * sizeof(__m128i) * 8 / no0(w);
 
-            size_t chunks = (end - start) * w / 8 / sizeof (__m128i);
-            for (size_t t = 0; t < chunks; t++) {
-                if (w == 8)
-                    state = find_max ? _mm_max_epi8(data[t], state) : _mm_min_epi8(data[t], state);
-                else if (w == 16)
-                    state = find_max ? _mm_max_epi16(data[t], state) : _mm_min_epi16(data[t], state);
-                else if (w == 32)
-                    state = find_max ? _mm_max_epi32(data[t], state) : _mm_min_epi32(data[t], state);
-
-                start += sizeof (__m128i) * 8 / no0(w);
-            }
-
-            // Todo: prevent taking address of 'state' to make the compiler keep it in SSE register in above loop (vc2010/gcc4.6)
-
-            // We originally had declared '__m128i state2' and did an 'state2 = state' assignment. When we read from state2 through int16_t, int32_t or int64_t in GetUniversal(),
-            // the compiler thinks it cannot alias state2 and hence reorders the read and assignment.
-
-            // In this fixed version using memcpy, we have char-read-access from __m128i (OK aliasing) and char-write-access to char-array, and finally int8/16/32/64
-            // read access from char-array (OK aliasing).
+            // Read the lanes back through a char array to stay clear of aliasing issues
+            char state2[sizeof(state)];
             memcpy(&state2, &state, sizeof state);
-            for (size_t t = 0; t < sizeof (__m128i) * 8 / no0(w); ++t) {
-                int64_t v = get_universal<w>(reinterpret_cast<char*>(&state2), t);
-                if (find_max ? v > m : v < m) {
+            for (size_t t = 0; t < sizeof(__m128i) * 8 / no0(w); ++t) {
+                int64_t v = get_universal<w>(state2, t);
+                if (find_max ? v > m : v < m)
                     m = v;
-                }
             }
         }
+
+        for (; start < end; ++start) {
+            const int64_t v = get<w>(start);
+            if (find_max ? v > m : v < m)
+                m = v;
+        }
+
+        result = m;
+        if (return_ndx)
+            *return_ndx = find_first(m + m_base, first, end);
+        return true;
     }
-#endif
 #endif
 
     for (; start < end; ++start) {
@@ -805,16 +955,56 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
 
 bool Array::maximum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
 {
-    REALM_TEMPEX2(return minmax, true, m_width, (result, start, end, return_ndx));
+    if (m_step != 0) {
+        // The elements of a delta encoded array are in ascending order
+        if (end == npos)
+            end = m_size;
+        if (start == end)
+            return false;
+        result = get(end - 1);
+        if (return_ndx)
+            *return_ndx = lower_bound_ordered(result, start, end);
+        return true;
+    }
+    bool found;
+    REALM_TEMPEX2(found = minmax, true, m_width, (result, start, end, return_ndx));
+    if (found)
+        result += m_base;
+    return found;
 }
 
 bool Array::minimum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
 {
-    REALM_TEMPEX2(return minmax, false, m_width, (result, start, end, return_ndx));
+    if (m_step != 0) {
+        if (end == npos)
+            end = m_size;
+        if (start == end)
+            return false;
+        result = get(start);
+        if (return_ndx)
+            *return_ndx = start;
+        return true;
+    }
+    bool found;
+    REALM_TEMPEX2(found = minmax, false, m_width, (result, start, end, return_ndx));
+    if (found)
+        result += m_base;
+    return found;
 }
 
 int64_t Array::sum(size_t start, size_t end) const
 {
+    if (m_is_encoded) {
+        if (end == size_t(-1))
+            end = m_size;
+        int64_t s;
+        REALM_TEMPEX(s = sum, m_width, (start, end));
+        uint64_t n = end - start;
+        // Sum of the indexes start to end - 1. One of the factors is even.
+        uint64_t first = start + end - 1;
+        uint64_t indexes = n % 2 == 0 ? n / 2 * first : first / 2 * n;
+        return int64_t(uint64_t(s) + uint64_t(m_base) * n + uint64_t(m_step) * indexes);
+    }
     REALM_TEMPEX(return sum, m_width, (start, end));
 }
 
@@ -986,6 +1176,14 @@ int64_t Array::sum(size_t start, size_t end) const
 
 size_t Array::count(int64_t value) const noexcept
 {
+    if (m_step != 0)
+        return upper_bound_ordered(value, 0, m_size) - lower_bound_ordered(value, 0, m_size);
+    if (m_is_encoded) {
+        value = to_offset(value);
+        if (value < 0 || value > m_ubound)
+            return 0;
+    }
+
     const uint64_t* next = reinterpret_cast<uint64_t*>(m_data);
     size_t value_count = 0;
     const size_t end = m_size;
@@ -1191,6 +1389,12 @@ MemRef Array::clone(MemRef mem, Allocator& alloc, Allocator& target_alloc)
 {
     const char* header = mem.get_addr();
     if (!get_hasrefs_from_header(header)) {
+        if (get_wtype_from_header(header) == wtype_FrameOfReference) {
+            Array array{alloc};
+            array.init_from_mem(mem);
+            return array.create_decoded(target_alloc); // Throws
+        }
+
         // This array has no subarrays, so we can make a byte-for-byte
         // copy, which is more efficient.
 
@@ -1377,15 +1581,47 @@ struct Array::VTableForWidth {
 template <size_t width>
 const typename Array::VTableForWidth<width>::PopulatedVTable Array::VTableForWidth<width>::vtable;
 
+// The finders translate the value themselves, see find_optimized()
+template <size_t width>
+struct Array::VTableForEncodedWidth {
+    struct PopulatedVTable : Array::VTable {
+        PopulatedVTable()
+        {
+            getter = &Array::get_encoded<width>;
+            setter = &Array::set<width>;
+            chunk_getter = &Array::get_chunk_encoded<width>;
+            finder[cond_Equal] = &Array::find<Equal, act_ReturnFirst, width>;
+            finder[cond_NotEqual] = &Array::find<NotEqual, act_ReturnFirst, width>;
+            finder[cond_Greater] = &Array::find<Greater, act_ReturnFirst, width>;
+            finder[cond_Less] = &Array::find<Less, act_ReturnFirst, width>;
+        }
+    };
+    static const PopulatedVTable vtable;
+};
+
+template <size_t width>
+const typename Array::VTableForEncodedWidth<width>::PopulatedVTable Array::VTableForEncodedWidth<width>::vtable;
+
 void Array::update_width_cache_from_header() noexcept
 {
-    auto width = get_width_from_header(get_header());
+    const char* header = get_header();
+    auto width = get_width_from_header(header);
     m_lbound = lbound_for_width(width);
     m_ubound = ubound_for_width(width);
 
     m_width = width;
 
-    REALM_TEMPEX(m_vtable = &VTableForWidth, width, ::vtable);
+    m_is_encoded = get_wtype_from_header(header) == wtype_FrameOfReference;
+    if (m_is_encoded) {
+        m_base = get_base_from_header(header);
+        m_step = get_step_from_header(header);
+        REALM_TEMPEX(m_vtable = &VTableForEncodedWidth, width, ::vtable);
+    }
+    else {
+        m_base = 0;
+        m_step = 0;
+        REALM_TEMPEX(m_vtable = &VTableForWidth, width, ::vtable);
+    }
     m_getter = m_vtable->getter;
 }
 
@@ -1447,6 +1683,15 @@ void Array::get_chunk(size_t ndx, int64_t res[8]) const noexcept
 }
 
 
+template <size_t w>
+void Array::get_chunk_encoded(size_t ndx, int64_t res[8]) const noexcept
+{
+    get_chunk<w>(ndx, res);
+    for (size_t i = 0; i + ndx < m_size && i < 8; i++)
+        res[i] = int64_t(uint64_t(res[i]) + uint64_t(m_base) + uint64_t(m_step) * (ndx + i));
+}
+
+
 template <size_t width>
 void Array::set(size_t ndx, int64_t value)
 {
@@ -1573,14 +1818,60 @@ void Array::verify() const
 
 size_t Array::lower_bound_int(int64_t value) const noexcept
 {
+    if (m_step != 0)
+        return lower_bound_ordered(value, 0, m_size);
+    if (m_is_encoded) {
+        value = to_offset(value);
+        if (value < 0)
+            return 0;
+        if (value > m_ubound)
+            return m_size;
+    }
     REALM_TEMPEX(return lower_bound, m_width, (m_data, m_size, value));
 }
 
 size_t Array::upper_bound_int(int64_t value) const noexcept
 {
+    if (m_step != 0)
+        return upper_bound_ordered(value, 0, m_size);
+    if (m_is_encoded) {
+        value = to_offset(value);
+        if (value < 0)
+            return 0;
+        if (value > m_ubound)
+            return m_size;
+    }
     REALM_TEMPEX(return upper_bound, m_width, (m_data, m_size, value));
 }
 
+// The elements of a delta encoded array are in ascending order, but their
+// offsets are not, so these search the decoded elements.
+size_t Array::lower_bound_ordered(int64_t value, size_t begin, size_t end) const noexcept
+{
+    REALM_ASSERT_DEBUG(m_step != 0);
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (get(mid) < value)
+            begin = mid + 1;
+        else
+            end = mid;
+    }
+    return begin;
+}
+
+size_t Array::upper_bound_ordered(int64_t value, size_t begin, size_t end) const noexcept
+{
+    REALM_ASSERT_DEBUG(m_step != 0);
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (get(mid) <= value)
+            begin = mid + 1;
+        else
+            end = mid;
+    }
+    return begin;
+}
+
 
 void Array::find_all(IntegerColumn* result, int64_t value, size_t col_offset, size_t begin, size_t end) const
 {
@@ -1632,7 +1923,11 @@ int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 {
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
-    return get_direct(data, width, ndx);
+    int64_t value = get_direct(data, width, ndx);
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_FrameOfReference))
+        value = int64_t(uint64_t(value) + uint64_t(get_base_from_header(header)) +
+                        uint64_t(get_step_from_header(header)) * ndx);
+    return value;
 }
 
 
@@ -1641,6 +1936,12 @@ std::pair<int64_t, int64_t> Array::get_two(const char* header, size_t ndx) noexc
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
     std::pair<int64_t, int64_t> p = ::get_two(data, width, ndx);
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_FrameOfReference)) {
+        uint64_t base = uint64_t(get_base_from_header(header));
+        uint64_t step = uint64_t(get_step_from_header(header));
+        p.first = int64_t(uint64_t(p.first) + base + step * ndx);
+        p.second = int64_t(uint64_t(p.second) + base + step * (ndx + 1));
+    }
     return std::make_pair(p.first, p.second);
 }
 
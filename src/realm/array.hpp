@@ -73,6 +73,7 @@ Searching: The main finding function is:
 #include <emmintrin.h>             // SSE2
 #include <realm/realm_nmmintrin.h> // SSE42
 #endif
+#include <realm/array_find_kernels.hpp>
 
 namespace realm {
 
@@ -393,6 +394,15 @@ public:
         return sum(start, end);
     }
 
+    /// Number of elements equal to `value`.
+    size_t count(int64_t value) const noexcept;
+
+    /// Largest (smallest) element in the range [start, end). The index of
+    /// its first occurrence is returned in `return_ndx`. These use SIMD
+    /// instructions for 8, 16, 32 and 64 bit wide arrays when available.
+    bool maximum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const;
+    bool minimum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const;
+
     /// This information is guaranteed to be cached in the array accessor.
     bool is_inner_bptree_node() const noexcept;
 
@@ -443,7 +453,14 @@ public:
     ///
     /// \param only_if_modified Set to `false` to always write, or to `true` to
     /// only write the array if it has been modified.
-    ref_type write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified) const;
+    ///
+    /// \param compress Set to `true` to write this array frame-of-reference
+    /// encoded (see NodeHeader::wtype_FrameOfReference) if \a out allows for
+    /// it, and if that makes it smaller. Only the owner of an integer leaf
+    /// knows whether it is read through the Array interface or
+    /// Array::get(const char*, size_t), which is required, so this must not be
+    /// set for other arrays. It has no effect on arrays with refs.
+    ref_type write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified, bool compress = false) const;
 
     /// Same as non-static write() with `deep` set to true. This is for the
     /// cases where you do not already have an array accessor available.
@@ -527,6 +544,20 @@ public:
     template <Action action, class Callback>
     bool find_action_pattern(size_t index, uint64_t pattern, QueryState<int64_t>* state, Callback callback) const;
 
+    // Find for delta encoded arrays, whose elements are ordered
+    template <class cond, Action action, class Callback>
+    bool find_ordered(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                      Callback callback) const;
+
+    // Find comparing with another array, one of which is encoded
+    template <class cond, Action action, class Callback>
+    bool compare_leafs_encoded(const Array* foreign, size_t start, size_t end, size_t baseindex,
+                               QueryState<int64_t>* state, Callback callback) const;
+
+    // Like find_action(), for a value which is not an offset
+    template <Action action, class Callback>
+    bool find_action_value(size_t index, int64_t value, QueryState<int64_t>* state, Callback callback) const;
+
     // Wrappers for backwards compatibility and for simple use without
     // setting up state initialization etc
     template <class cond>
@@ -580,6 +611,12 @@ public:
 
 #endif
 
+    // Find for the four functions Equal/NotEqual/Less/Greater with one of the vector kernels of
+    // array_find_kernels.hpp
+    template <class Kernel, class cond, Action action, size_t width, class Callback>
+    bool find_vectorized(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                         Callback callback) const;
+
     template <size_t width>
     inline bool test_zero(uint64_t value) const; // Tests value for 0-elements
 
@@ -674,14 +711,27 @@ protected:
 private:
     void update_width_cache_from_header() noexcept;
 
-    void do_ensure_minimum_width(int_fast64_t);
+    /// Map a value to the offsets stored in a frame-of-reference encoded
+    /// array. Values below (above) the representable range are mapped to one
+    /// below (above) it, which preserves the outcome of every comparison. Not
+    /// for delta encoded arrays, whose elements are not offsets from the same
+    /// value.
+    int64_t to_offset(int64_t value) const noexcept;
 
-    int64_t sum(size_t start, size_t end) const;
-    size_t count(int64_t value) const noexcept;
+    /// The positions in [begin, end) of a delta encoded array, which is
+    /// ordered, of the first element not less than (greater than) `value`
+    size_t lower_bound_ordered(int64_t value, size_t begin, size_t end) const noexcept;
+    size_t upper_bound_ordered(int64_t value, size_t begin, size_t end) const noexcept;
 
-    bool maximum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const;
+    template <size_t w>
+    int64_t get_encoded(size_t ndx) const noexcept;
 
-    bool minimum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const;
+    template <size_t w>
+    void get_chunk_encoded(size_t ndx, int64_t res[8]) const noexcept;
+
+    void do_ensure_minimum_width(int_fast64_t);
+
+    int64_t sum(size_t start, size_t end) const;
 
     template <size_t w>
     int64_t sum(size_t start, size_t end) const;
@@ -703,6 +753,10 @@ protected:
 
     void destroy_children(size_t offset = 0) noexcept;
 
+    // Overriding method in Node. A frame-of-reference encoded array is
+    // decoded into a plain one.
+    void do_copy_on_write(size_t minimum_size = 0) override;
+
 protected:
     // Getters and Setters for adaptive-packed arrays
     typedef int64_t (Array::*Getter)(size_t) const; // Note: getters must not throw
@@ -718,6 +772,8 @@ protected:
     };
     template <size_t w>
     struct VTableForWidth;
+    template <size_t w>
+    struct VTableForEncodedWidth;
 
 protected:
     /// Takes a 64-bit value and returns the minimum number of bits needed
@@ -739,9 +795,15 @@ protected:
     bool m_is_inner_bptree_node; // This array is an inner node of B+-tree.
     bool m_has_refs;             // Elements whose first bit is zero are refs to subarrays.
     bool m_context_flag;         // Meaning depends on context.
+    bool m_is_encoded = false;   // Elements are offsets from m_base + i * m_step (wtype_FrameOfReference).
+    int64_t m_base = 0;
+    int64_t m_step = 0; // Nonzero if delta encoded, in which case the elements are ordered
 
 private:
     ref_type do_write_shallow(_impl::ArrayWriterBase&) const;
+    ref_type do_write_compressed(_impl::ArrayWriterBase&) const;
+    ref_type do_write_encoded(_impl::ArrayWriterBase&, int64_t base, int64_t step, size_t width) const;
+    MemRef create_decoded(Allocator& target_alloc) const;
     ref_type do_write_deep(_impl::ArrayWriterBase&, bool only_if_modified) const;
 
     friend class Allocator;
@@ -1078,13 +1140,16 @@ inline void Array::destroy_deep() noexcept
     m_data = nullptr;
 }
 
-inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified) const
+inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified, bool compress) const
 {
     REALM_ASSERT(is_attached());
 
     if (only_if_modified && m_alloc.is_read_only(m_ref))
         return m_ref;
 
+    if (compress && !m_has_refs)
+        return do_write_compressed(out); // Throws
+
     if (!deep || !m_has_refs)
         return do_write_shallow(out); // Throws
 
@@ -1251,6 +1316,21 @@ int64_t Array::get(size_t ndx) const noexcept
     return get_universal<w>(m_data, ndx);
 }
 
+template <size_t w>
+int64_t Array::get_encoded(size_t ndx) const noexcept
+{
+    return int64_t(uint64_t(get_universal<w>(m_data, ndx)) + uint64_t(m_base) + uint64_t(m_step) * ndx);
+}
+
+inline int64_t Array::to_offset(int64_t value) const noexcept
+{
+    REALM_ASSERT_DEBUG(m_is_encoded && m_step == 0);
+    if (value < m_base)
+        return -1;
+    uint64_t offset = uint64_t(value) - uint64_t(m_base);
+    return offset > uint64_t(m_ubound) ? m_ubound + 1 : int64_t(offset);
+}
+
 template <size_t w>
 int64_t Array::get_universal(const char* data, size_t ndx) const
 {
@@ -1314,6 +1394,17 @@ such a pattern.
 template <Action action, class Callback>
 bool Array::find_action(size_t index, util::Optional<int64_t> value, QueryState<int64_t>* state,
                         Callback callback) const
+{
+    if (action == act_CallbackIdx)
+        return callback(index);
+    else if ((action == act_Sum || action == act_Max || action == act_Min) && m_is_encoded)
+        return state->match<action, false>(index, 0, *value + m_base);
+    else
+        return state->match<action, false>(index, 0, value);
+}
+
+template <Action action, class Callback>
+bool Array::find_action_value(size_t index, int64_t value, QueryState<int64_t>* state, Callback callback) const
 {
     if (action == act_CallbackIdx)
         return callback(index);
@@ -1460,6 +1551,15 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
     size_t start2 = start;
     cond c;
 
+    // Everything below compares against the elements as stored
+    if (m_is_encoded) {
+        if (m_step != 0) {
+            REALM_ASSERT_DEBUG(!nullable_array);
+            return find_ordered<cond, action, Callback>(value, start, end, baseindex, state, callback);
+        }
+        value = to_offset(value);
+    }
+
     if (end == npos)
         end = nullable_array ? size() - 1 : size();
 
@@ -1563,7 +1663,8 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
             if (action == act_Min)
                 Array::minimum(res, start2, end2, &res_ndx);
 
-            find_action<action, Callback>(res_ndx + baseindex, res, state, callback);
+            // The result is a value, not an offset, so find_action() is bypassed
+            state->match<action, false>(res_ndx + baseindex, 0, res);
             // find_action will increment match count by 1, so we need to `-1` from the number of elements that
             // we performed the fast Array methods on.
             state->m_match_count += end2 - start2 - 1;
@@ -1582,6 +1683,25 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
     // finder cannot handle this bitwidth
     REALM_ASSERT_3(m_width, !=, 0);
 
+    // Prefer the widest vector kernel that the CPU supports if the payload is at least one chunk in size. Unlike
+    // SSE, the kernels support all four conditions for all widths >= 8. See array_find_kernels.hpp.
+    if constexpr (bitwidth >= 8) {
+        const size_t payload_bytes = (end - start2) * bitwidth / 8;
+#if defined(REALM_COMPILER_AVX)
+        if (payload_bytes >= Avx512FindKernel::chunk_size && Avx512FindKernel::is_supported())
+            return find_vectorized<Avx512FindKernel, cond, action, bitwidth, Callback>(value, start2, end, baseindex,
+                                                                                       state, callback);
+        if (payload_bytes >= Avx2FindKernel::chunk_size && Avx2FindKernel::is_supported())
+            return find_vectorized<Avx2FindKernel, cond, action, bitwidth, Callback>(value, start2, end, baseindex,
+                                                                                     state, callback);
+#endif
+#if defined(REALM_COMPILER_NEON)
+        if (payload_bytes >= NeonFindKernel::chunk_size && NeonFindKernel::is_supported())
+            return find_vectorized<NeonFindKernel, cond, action, bitwidth, Callback>(value, start2, end, baseindex,
+                                                                                     state, callback);
+#endif
+    }
+
 #if defined(REALM_COMPILER_SSE)
     // Only use SSE if payload is at least one SSE chunk (128 bits) in size. Also note taht SSE doesn't support
     // Less-than comparison for 64-bit values.
@@ -2116,6 +2236,64 @@ REALM_FORCEINLINE bool Array::find_sse_intern(__m128i* action_data, __m128i* dat
 }
 #endif // REALM_COMPILER_SSE
 
+// 'start' and 'end' are indexes into this array, which must hold elements of 8 bits or more. The chunks of the
+// range are searched with the kernel, and the elements before the first and after the last chunk with compare().
+template <class Kernel, class cond, Action action, size_t width, class Callback>
+bool Array::find_vectorized(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                            Callback callback) const
+{
+    constexpr size_t chunk_size = Kernel::chunk_size;
+    constexpr size_t mask_bits = Kernel::template mask_bits<width>;
+    constexpr size_t chunk_items = chunk_size * 8 / width;
+    static_assert(chunk_items * mask_bits <= 64, "The mask of a chunk must fit in 64 bits");
+    constexpr uint64_t all =
+        chunk_items * mask_bits == 64 ? ~uint64_t(0) : (uint64_t(1) << chunk_items * mask_bits) - 1;
+    // The lowest bit of each element in a mask, which gives a mask with one bit per element
+    const uint64_t lowest = uint64_t(lower_bits<mask_bits>()) & all;
+
+    const char* const a = static_cast<char*>(round_up(m_data + start * width / 8, chunk_size));
+    const char* const b = static_cast<char*>(round_down(m_data + end * width / 8, chunk_size));
+
+    if (!compare<cond, action, width, Callback>(value, start, (a - m_data) * 8 / width, baseindex, state, callback))
+        return false;
+
+    using T = std::conditional_t<width == 8, int8_t,
+                                 std::conditional_t<width == 16, int16_t,
+                                                    std::conditional_t<width == 32, int32_t, int64_t>>>;
+    alignas(chunk_size) T search[chunk_items];
+    std::fill(std::begin(search), std::end(search), static_cast<T>(value));
+    const char* const s = reinterpret_cast<const char*>(search);
+
+    for (const char* chunk = a; chunk < b; chunk += chunk_size) {
+        uint64_t mask;
+        if (std::is_same<cond, Equal>::value)
+            mask = Kernel::template equal<width>(chunk, s);
+        else if (std::is_same<cond, NotEqual>::value)
+            mask = ~Kernel::template equal<width>(chunk, s) & all;
+        else if (std::is_same<cond, Greater>::value)
+            mask = Kernel::template greater<width>(chunk, s);
+        else if (std::is_same<cond, Less>::value)
+            mask = Kernel::template greater<width>(s, chunk);
+        else
+            REALM_UNREACHABLE();
+        if (mask == 0)
+            continue;
+
+        size_t first = (chunk - m_data) * 8 / width;
+        if (find_action_pattern<action, Callback>(first + baseindex, mask & lowest, state, callback))
+            continue;
+        while (mask != 0) {
+            size_t ndx = first + first_set_bit64(mask) / mask_bits;
+            if (!find_action<action, Callback>(ndx + baseindex, get_universal<width>(m_data, ndx), state, callback))
+                return false;
+            size_t consumed = (ndx - first + 1) * mask_bits;
+            mask = consumed == 64 ? 0 : mask & (~uint64_t(0) << consumed);
+        }
+    }
+
+    return compare<cond, action, width, Callback>(value, (b - m_data) * 8 / width, end, baseindex, state, callback);
+}
+
 template <class cond, Action action, class Callback>
 bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t baseindex,
                           QueryState<int64_t>* state, Callback callback) const
@@ -2125,6 +2303,9 @@ bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t
     if (start == end)
         return true;
 
+    // The comparisons below read the elements as stored
+    if (m_is_encoded || foreign->m_is_encoded)
+        return compare_leafs_encoded<cond, action, Callback>(foreign, start, end, baseindex, state, callback);
 
     int64_t v;
 
@@ -2178,10 +2359,27 @@ bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t
 }
 
 
+template <class cond, Action action, class Callback>
+bool Array::compare_leafs_encoded(const Array* foreign, size_t start, size_t end, size_t baseindex,
+                                  QueryState<int64_t>* state, Callback callback) const
+{
+    cond c;
+    for (; start < end; ++start) {
+        int64_t v = get(start);
+        if (c(v, foreign->get(start))) {
+            if (!find_action_value<action, Callback>(start + baseindex, v, state, callback))
+                return false;
+        }
+    }
+    return true;
+}
+
 template <class cond, Action action, size_t width, class Callback, size_t foreign_width>
 bool Array::compare_leafs_4(const Array* foreign, size_t start, size_t end, size_t baseindex,
                             QueryState<int64_t>* state, Callback callback) const
 {
+    // The elements are read as stored, which are offsets in an encoded array
+    REALM_ASSERT_DEBUG(!m_is_encoded && !foreign->m_is_encoded);
     cond c;
     char* foreign_m_data = foreign->m_data;
 
@@ -2252,6 +2450,31 @@ bool Array::compare_leafs_4(const Array* foreign, size_t start, size_t end, size
 }
 
 
+// The elements of a delta encoded array are ordered, so those less than, equal
+// to and greater than the value each form a run, and a condition holds for
+// either all or none of the elements of a run.
+template <class cond, Action action, class Callback>
+bool Array::find_ordered(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                         Callback callback) const
+{
+    cond c;
+    if (end == npos)
+        end = m_size;
+    size_t lower = lower_bound_ordered(value, start, end);
+    size_t upper = upper_bound_ordered(value, lower, end);
+    const size_t runs[] = {start, lower, upper, end};
+    for (size_t r = 0; r < 3; ++r) {
+        size_t run_begin = runs[r], run_end = runs[r + 1];
+        if (run_begin == run_end || !c(get(run_begin), value))
+            continue;
+        for (size_t i = run_begin; i < run_end; ++i) {
+            if (!find_action_value<action, Callback>(i + baseindex, get(i), state, callback))
+                return false;
+        }
+    }
+    return true;
+}
+
 template <class cond, Action action, size_t bitwidth, class Callback>
 bool Array::compare(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
                     Callback callback) const
@@ -83,6 +83,19 @@ public:
     bool maximum(T& result, size_t begin = 0, size_t end = npos) const;
     bool minimum(T& result, size_t begin = 0, size_t end = npos) const;
 
+    /// Sum of the non-null values in the range [begin, end), accumulated in
+    /// double precision. The number of non-null values is returned in
+    /// `value_count`. Partial sums are kept in several lanes, so the result
+    /// may differ in the last bits from adding the values one at a time.
+    double sum(size_t& value_count, size_t begin = 0, size_t end = npos) const;
+
+    /// If any non-null value in [begin, end) is greater (less) than
+    /// `result`, set `result` to the largest (smallest) one and `ndx` to the
+    /// index of its first occurrence. Returns the number of non-null values
+    /// in the range.
+    template <bool find_max>
+    size_t minmax_non_null(T& result, size_t& ndx, size_t begin = 0, size_t end = npos) const;
+
     /// Compare two arrays for equality.
     bool compare(const BasicArray<T>&) const;
 
@@ -296,18 +296,90 @@ size_t BasicArray<T>::count(T value, size_t begin, size_t end) const
     return std::count(data + begin, data + end, value);
 }
 
-#if 0
-// currently unused
 template <class T>
-double BasicArray<T>::sum(size_t begin, size_t end) const
+double BasicArray<T>::sum(size_t& value_count, size_t begin, size_t end) const
 {
     if (end == npos)
         end = m_size;
     REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+
+    // Nulls are recognized by their bit pattern, which keeps the loop free of branches. The partial sums are kept in
+    // independent lanes so that the compiler can vectorize the loop.
+    using Bits = typename std::conditional<std::is_same<T, float>::value, uint32_t, uint64_t>::type;
+    const Bits null_bits = type_punning<Bits>(null::get_null_float<T>());
+    const T* data = reinterpret_cast<const T*>(m_data);
+    constexpr size_t lanes = 4;
+    double sums[lanes] = {};
+    size_t nulls[lanes] = {};
+
+    size_t i = begin;
+    for (; i + lanes <= end; i += lanes) {
+        for (size_t l = 0; l < lanes; ++l) {
+            Bits bits;
+            std::memcpy(&bits, data + i + l, sizeof(Bits));
+            bool is_null = bits == null_bits;
+            sums[l] += is_null ? 0.0 : double(data[i + l]);
+            nulls[l] += is_null;
+        }
+    }
+    for (; i < end; ++i) {
+        Bits bits;
+        std::memcpy(&bits, data + i, sizeof(Bits));
+        bool is_null = bits == null_bits;
+        sums[0] += is_null ? 0.0 : double(data[i]);
+        nulls[0] += is_null;
+    }
+
+    value_count = end - begin - (nulls[0] + nulls[1] + nulls[2] + nulls[3]);
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+template <class T>
+template <bool find_max>
+size_t BasicArray<T>::minmax_non_null(T& result, size_t& ndx, size_t begin, size_t end) const
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+
+    // Null is a NaN, so it never compares greater or less than anything and is skipped by the comparisons below
+    // without further testing. It must still be excluded from the returned count.
     const T* data = reinterpret_cast<const T*>(m_data);
-    return std::accumulate(data + begin, data + end, double(0));
+    constexpr size_t lanes = 4;
+    T best[lanes] = {result, result, result, result};
+
+    size_t i = begin;
+    for (; i + lanes <= end; i += lanes) {
+        for (size_t l = 0; l < lanes; ++l) {
+            T v = data[i + l];
+            best[l] = (find_max ? v > best[l] : v < best[l]) ? v : best[l];
+        }
+    }
+    for (; i < end; ++i) {
+        T v = data[i];
+        best[0] = (find_max ? v > best[0] : v < best[0]) ? v : best[0];
+    }
+
+    T m = result;
+    size_t j;
+    for (size_t l = 0; l < lanes; ++l) {
+        if (find_max ? best[l] > m : best[l] < m)
+            m = best[l];
+    }
+    if (m != result) {
+        // Report the first occurrence, like a sequential scan would
+        j = begin;
+        while (!(data[j] == m))
+            ++j;
+        result = data[j];
+        ndx = j;
+    }
+
+    size_t value_count = end - begin;
+    for (j = begin; j < end; ++j)
+        value_count -= null::is_null_float(data[j]);
+    return value_count;
 }
-#endif
 
 template <class T>
 template <bool find_max>
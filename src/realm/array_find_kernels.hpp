@@ -0,0 +1,316 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ARRAY_FIND_KERNELS_HPP
+#define REALM_ARRAY_FIND_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <realm/utilities.hpp>
+
+/*
+    Vector kernels used by Array::find_vectorized() to scan leaves of 8, 16, 32 and 64 bit wide elements for the
+    four conditions Equal/NotEqual/Less/Greater. Leaves of smaller widths, and the parts of a range that do not fill
+    a whole chunk, are left to the scalar finder, Array::compare().
+
+    An instruction set plugs in by providing a kernel with the following members, and by being added to the
+    dispatch in Array::find_optimized(), which takes the first kernel that is supported at runtime:
+
+        static constexpr size_t chunk_size;              Bytes compared at a time
+        template <size_t width>
+        static constexpr size_t mask_bits;               Bits per element in the masks returned below
+        static bool is_supported() noexcept;             Whether the CPU supports the kernel
+        template <size_t width>
+        static uint64_t equal(const char* a, const char* b);    Mask of the elements where a == b
+        template <size_t width>
+        static uint64_t greater(const char* a, const char* b);  Mask of the elements where a > b (signed)
+
+    In a mask, all the `mask_bits` bits of the elements that satisfy the condition are set, the elements being in
+    order from the least significant bit, and the bits past the last element are zero. The chunks need not be
+    aligned.
+
+    As with SSE (see realm_nmmintrin.h), gcc and llvm do not offer the AVX2 and AVX-512 intrinsics without flags that
+    would also let them emit those instructions anywhere, so there the kernels are written in inline assembly. Each
+    asm block clears the upper halves of the vector registers before leaving, so that surrounding SSE code compiled
+    without VEX encoding does not pay AVX/SSE transition penalties.
+*/
+
+#if defined(REALM_COMPILER_AVX) && defined(_MSC_VER)
+#include <immintrin.h>
+#endif
+
+#ifdef REALM_COMPILER_NEON
+#include <arm_neon.h>
+#endif
+
+namespace realm {
+
+#ifdef REALM_COMPILER_AVX
+
+#ifndef _MSC_VER
+// The opmask register may only be named as clobbered when the compiler may use AVX-512 itself
+#ifdef __AVX512F__
+#define REALM_AVX512_CLOBBERS "xmm0", "k1"
+#else
+#define REALM_AVX512_CLOBBERS "xmm0"
+#endif
+
+#define REALM_AVX2_MASK_CMP(insn, a, b, ret)                                                                         \
+    __asm__("vmovdqu %1, %%ymm0\n\t" insn " %2, %%ymm0, %%ymm0\n\t"                                                  \
+            "vpmovmskb %%ymm0, %0\n\t"                                                                               \
+            "vzeroupper"                                                                                             \
+            : "=r"(ret)                                                                                              \
+            : "m"(*reinterpret_cast<const Chunk*>(a)), "m"(*reinterpret_cast<const Chunk*>(b))                       \
+            : "xmm0")
+
+#define REALM_AVX512_MASK_CMP(insn, a, b, ret)                                                                       \
+    __asm__("vmovdqu64 %1, %%zmm0\n\t" insn " %2, %%zmm0, %%k1\n\t"                                                  \
+            "kmovq %%k1, %0\n\t"                                                                                     \
+            "vzeroupper"                                                                                             \
+            : "=r"(ret)                                                                                              \
+            : "m"(*reinterpret_cast<const Chunk*>(a)), "m"(*reinterpret_cast<const Chunk*>(b))                       \
+            : REALM_AVX512_CLOBBERS)
+#endif // _MSC_VER
+
+// AVX2 compares 32 bytes at a time, with one bit per byte in the masks (as from vpmovmskb)
+struct Avx2FindKernel {
+    static constexpr size_t chunk_size = 32;
+    template <size_t width>
+    static constexpr size_t mask_bits = width / 8;
+
+    static bool is_supported() noexcept
+    {
+        return sseavx<2>();
+    }
+
+#ifdef _MSC_VER
+    template <size_t width>
+    static uint64_t equal(const char* a, const char* b)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        if constexpr (width == 8)
+            return unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        else if constexpr (width == 16)
+            return unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi16(x, y)));
+        else if constexpr (width == 32)
+            return unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, y)));
+        else
+            return unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi64(x, y)));
+    }
+
+    template <size_t width>
+    static uint64_t greater(const char* a, const char* b)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        if constexpr (width == 8)
+            return unsigned(_mm256_movemask_epi8(_mm256_cmpgt_epi8(x, y)));
+        else if constexpr (width == 16)
+            return unsigned(_mm256_movemask_epi8(_mm256_cmpgt_epi16(x, y)));
+        else if constexpr (width == 32)
+            return unsigned(_mm256_movemask_epi8(_mm256_cmpgt_epi32(x, y)));
+        else
+            return unsigned(_mm256_movemask_epi8(_mm256_cmpgt_epi64(x, y)));
+    }
+#else
+    struct Chunk {
+        char bytes[chunk_size];
+    };
+
+    template <size_t width>
+    static uint64_t equal(const char* a, const char* b)
+    {
+        unsigned int ret;
+        if constexpr (width == 8)
+            REALM_AVX2_MASK_CMP("vpcmpeqb", a, b, ret);
+        else if constexpr (width == 16)
+            REALM_AVX2_MASK_CMP("vpcmpeqw", a, b, ret);
+        else if constexpr (width == 32)
+            REALM_AVX2_MASK_CMP("vpcmpeqd", a, b, ret);
+        else
+            REALM_AVX2_MASK_CMP("vpcmpeqq", a, b, ret);
+        return ret;
+    }
+
+    template <size_t width>
+    static uint64_t greater(const char* a, const char* b)
+    {
+        unsigned int ret;
+        if constexpr (width == 8)
+            REALM_AVX2_MASK_CMP("vpcmpgtb", a, b, ret);
+        else if constexpr (width == 16)
+            REALM_AVX2_MASK_CMP("vpcmpgtw", a, b, ret);
+        else if constexpr (width == 32)
+            REALM_AVX2_MASK_CMP("vpcmpgtd", a, b, ret);
+        else
+            REALM_AVX2_MASK_CMP("vpcmpgtq", a, b, ret);
+        return ret;
+    }
+#endif
+};
+
+// AVX-512 compares 64 bytes at a time into an opmask register, with one bit per element in the masks. The byte and
+// word compares need AVX-512BW, which sseavx<3>() includes.
+struct Avx512FindKernel {
+    static constexpr size_t chunk_size = 64;
+    template <size_t width>
+    static constexpr size_t mask_bits = 1;
+
+    static bool is_supported() noexcept
+    {
+        return sseavx<3>();
+    }
+
+#ifdef _MSC_VER
+    template <size_t width>
+    static uint64_t equal(const char* a, const char* b)
+    {
+        __m512i x = _mm512_loadu_si512(a);
+        __m512i y = _mm512_loadu_si512(b);
+        if constexpr (width == 8)
+            return _mm512_cmpeq_epi8_mask(x, y);
+        else if constexpr (width == 16)
+            return _mm512_cmpeq_epi16_mask(x, y);
+        else if constexpr (width == 32)
+            return _mm512_cmpeq_epi32_mask(x, y);
+        else
+            return _mm512_cmpeq_epi64_mask(x, y);
+    }
+
+    template <size_t width>
+    static uint64_t greater(const char* a, const char* b)
+    {
+        __m512i x = _mm512_loadu_si512(a);
+        __m512i y = _mm512_loadu_si512(b);
+        if constexpr (width == 8)
+            return _mm512_cmpgt_epi8_mask(x, y);
+        else if constexpr (width == 16)
+            return _mm512_cmpgt_epi16_mask(x, y);
+        else if constexpr (width == 32)
+            return _mm512_cmpgt_epi32_mask(x, y);
+        else
+            return _mm512_cmpgt_epi64_mask(x, y);
+    }
+#else
+    struct Chunk {
+        char bytes[chunk_size];
+    };
+
+    template <size_t width>
+    static uint64_t equal(const char* a, const char* b)
+    {
+        uint64_t ret;
+        if constexpr (width == 8)
+            REALM_AVX512_MASK_CMP("vpcmpeqb", a, b, ret);
+        else if constexpr (width == 16)
+            REALM_AVX512_MASK_CMP("vpcmpeqw", a, b, ret);
+        else if constexpr (width == 32)
+            REALM_AVX512_MASK_CMP("vpcmpeqd", a, b, ret);
+        else
+            REALM_AVX512_MASK_CMP("vpcmpeqq", a, b, ret);
+        return ret;
+    }
+
+    template <size_t width>
+    static uint64_t greater(const char* a, const char* b)
+    {
+        uint64_t ret;
+        if constexpr (width == 8)
+            REALM_AVX512_MASK_CMP("vpcmpgtb", a, b, ret);
+        else if constexpr (width == 16)
+            REALM_AVX512_MASK_CMP("vpcmpgtw", a, b, ret);
+        else if constexpr (width == 32)
+            REALM_AVX512_MASK_CMP("vpcmpgtd", a, b, ret);
+        else
+            REALM_AVX512_MASK_CMP("vpcmpgtq", a, b, ret);
+        return ret;
+    }
+#endif
+};
+
+#ifndef _MSC_VER
+#undef REALM_AVX2_MASK_CMP
+#undef REALM_AVX512_MASK_CMP
+#undef REALM_AVX512_CLOBBERS
+#endif
+
+#endif // REALM_COMPILER_AVX
+
+#ifdef REALM_COMPILER_NEON
+
+// NEON compares 16 bytes at a time. There is no movemask instruction, so the compare result is narrowed to four bits
+// per byte, which fits in 64 bits.
+struct NeonFindKernel {
+    static constexpr size_t chunk_size = 16;
+    template <size_t width>
+    static constexpr size_t mask_bits = width / 2;
+
+    static bool is_supported() noexcept
+    {
+        return neon();
+    }
+
+    template <size_t width>
+    static uint64_t equal(const char* a, const char* b)
+    {
+        if constexpr (width == 8)
+            return to_mask(vceqq_s8(vld1q_s8(reinterpret_cast<const int8_t*>(a)),
+                                    vld1q_s8(reinterpret_cast<const int8_t*>(b))));
+        else if constexpr (width == 16)
+            return to_mask(vreinterpretq_u8_u16(vceqq_s16(vld1q_s16(reinterpret_cast<const int16_t*>(a)),
+                                                          vld1q_s16(reinterpret_cast<const int16_t*>(b)))));
+        else if constexpr (width == 32)
+            return to_mask(vreinterpretq_u8_u32(vceqq_s32(vld1q_s32(reinterpret_cast<const int32_t*>(a)),
+                                                          vld1q_s32(reinterpret_cast<const int32_t*>(b)))));
+        else
+            return to_mask(vreinterpretq_u8_u64(vceqq_s64(vld1q_s64(reinterpret_cast<const int64_t*>(a)),
+                                                          vld1q_s64(reinterpret_cast<const int64_t*>(b)))));
+    }
+
+    template <size_t width>
+    static uint64_t greater(const char* a, const char* b)
+    {
+        if constexpr (width == 8)
+            return to_mask(vcgtq_s8(vld1q_s8(reinterpret_cast<const int8_t*>(a)),
+                                    vld1q_s8(reinterpret_cast<const int8_t*>(b))));
+        else if constexpr (width == 16)
+            return to_mask(vreinterpretq_u8_u16(vcgtq_s16(vld1q_s16(reinterpret_cast<const int16_t*>(a)),
+                                                          vld1q_s16(reinterpret_cast<const int16_t*>(b)))));
+        else if constexpr (width == 32)
+            return to_mask(vreinterpretq_u8_u32(vcgtq_s32(vld1q_s32(reinterpret_cast<const int32_t*>(a)),
+                                                          vld1q_s32(reinterpret_cast<const int32_t*>(b)))));
+        else
+            return to_mask(vreinterpretq_u8_u64(vcgtq_s64(vld1q_s64(reinterpret_cast<const int64_t*>(a)),
+                                                          vld1q_s64(reinterpret_cast<const int64_t*>(b)))));
+    }
+
+private:
+    static uint64_t to_mask(uint8x16_t compared)
+    {
+        uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(compared), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+    }
+};
+
+#endif // REALM_COMPILER_NEON
+
+} // namespace realm
+
+#endif // REALM_ARRAY_FIND_KERNELS_HPP
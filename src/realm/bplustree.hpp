@@ -19,6 +19,8 @@
 #ifndef REALM_BPLUSTREE_HPP
 #define REALM_BPLUSTREE_HPP
 
+#include <algorithm>
+
 #include <realm/column_type_traits.hpp>
 #include <realm/decimal128.hpp>
 #include <realm/timestamp.hpp>
@@ -528,6 +530,55 @@ public:
         m_root->bptree_traverse(func);
     }
 
+    /// The position of the first element in [begin, end) for which `pred`
+    /// returns false, all elements for which it returns true preceding the
+    /// others. Each probe that lands in another leaf than the previous one
+    /// also tests the first and last element of the range in that leaf, so the
+    /// tree is only descended until the search is narrowed down to a single
+    /// leaf, which is then searched directly.
+    template <class Pred>
+    size_t partition_point(size_t begin, size_t end, Pred pred) const
+    {
+        while (begin < end) {
+            size_t mid = begin + (end - begin) / 2;
+            const LeafNode* leaf;
+            size_t leaf_begin;
+            if (m_cached_leaf_begin <= mid && mid < m_cached_leaf_end) {
+                leaf = &m_leaf_cache;
+                leaf_begin = m_cached_leaf_begin;
+            }
+            else {
+                auto func = [&](BPlusTreeNode* node, size_t ndx) {
+                    leaf = static_cast<LeafNode*>(node);
+                    leaf_begin = mid - ndx;
+                };
+                m_root->bptree_access(mid, func);
+            }
+            size_t lo = std::max(begin, leaf_begin);
+            size_t hi = std::min(end, leaf_begin + leaf->size());
+            if (!pred(leaf->get(lo - leaf_begin))) {
+                end = lo;
+                continue;
+            }
+            if (pred(leaf->get(hi - 1 - leaf_begin))) {
+                begin = hi;
+                continue;
+            }
+            // The partition point is in (lo, hi - 1]
+            ++lo;
+            --hi;
+            while (lo < hi) {
+                size_t m = lo + (hi - lo) / 2;
+                if (pred(leaf->get(m - leaf_begin)))
+                    lo = m + 1;
+                else
+                    hi = m;
+            }
+            return lo;
+        }
+        return begin;
+    }
+
     void dump_values(std::ostream& o, int level) const
     {
         std::string indent(" ", level * 2);
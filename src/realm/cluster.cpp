@@ -776,7 +776,28 @@ size_t Cluster::erase(ObjKey key, CascadeState& state)
             ref_type ref = values.get(ndx);
 
             if (ref) {
-                if (col_type == col_type_LinkList) {
+                if (attr.test(col_attr_Dictionary)) {
+                    const Table* origin_table = m_tree_top.get_owning_table();
+                    auto key_type = origin_table->get_dictionary_key_type(col_key);
+                    DictionaryClusterTree dict(&values, key_type, m_alloc, ndx);
+                    dict.init_from_parent();
+                    dict.traverse([&](const Cluster* cluster) {
+                        ArrayMixed dict_values(m_alloc);
+                        dict_values.init_from_ref(to_ref(Array::get(cluster->get_mem().get_addr(), 2)));
+                        for (size_t i = 0; i < dict_values.size(); i++) {
+                            Mixed val = dict_values.get(i);
+                            if (!val.is_null() && val.get_type() == type_TypedLink) {
+                                ObjLink link = val.get<ObjLink>();
+                                auto target_obj = origin_table->get_parent_group()->get_object(link);
+                                ColKey backlink_col_key =
+                                    target_obj.get_table()->find_backlink_column(col_key, origin_table->get_key());
+                                target_obj.remove_one_backlink(backlink_col_key, ObjKey(key.value + m_offset));
+                            }
+                        }
+                        return false;
+                    });
+                }
+                else if (col_type == col_type_LinkList) {
                     BPlusTree<ObjKey> links(m_alloc);
                     links.init_from_ref(ref);
                     if (links.size() > 0) {
@@ -801,7 +822,7 @@ size_t Cluster::erase(ObjKey key, CascadeState& state)
                     const Table* origin_table = m_tree_top.get_owning_table();
                     for (size_t i = 0; i < list.size(); i++) {
                         Mixed val = list.get(i);
-                        if (val.get_type() == type_TypedLink) {
+                        if (!val.is_null() && val.get_type() == type_TypedLink) {
                             ObjLink link = val.get<ObjLink>();
                             auto target_obj = origin_table->get_parent_group()->get_object(link);
                             ColKey backlink_col_key =
@@ -24,6 +24,7 @@
 #include "realm/array_bool.hpp"
 #include "realm/array_string.hpp"
 #include "realm/array_fixed_bytes.hpp"
+#include "realm/impl/destroy_guard.hpp"
 
 /*
  * Node-splitting is done in the way that if the new element comes after all the
@@ -113,6 +114,8 @@ public:
     void dump_objects(int64_t key_offset, std::string lead) const override;
 
 private:
+    friend class ClusterTree;
+
     static constexpr size_t s_key_ref_index = 0;
     static constexpr size_t s_sub_tree_depth_index = 1;
     static constexpr size_t s_sub_tree_size = 2;
@@ -932,6 +935,85 @@ bool ClusterTree::traverse(TraverseFunction func) const
     }
 }
 
+bool ClusterTree::get_child_refs(Allocator& alloc, ref_type ref, std::vector<ref_type>& children)
+{
+    Array node(alloc);
+    node.init_from_ref(ref);
+    size_t sz = node.size();
+    children.clear();
+    if (node.is_inner_bptree_node()) {
+        for (size_t i = ClusterNodeInner::s_first_node_index; i < sz; ++i)
+            children.push_back(node.get_as_ref(i));
+        return false;
+    }
+    for (size_t i = Cluster::s_first_col_index; i < sz; ++i) {
+        auto rot = node.get_as_ref_or_tagged(i);
+        children.push_back(rot.is_ref() ? rot.get_as_ref() : 0);
+    }
+    return true;
+}
+
+ref_type ClusterTree::typed_write(ref_type ref, _impl::ArrayWriterBase& out) const
+{
+    // The leaves that are ArrayInteger, and are therefore only read through
+    // the Array interface, by column index. See Cluster::create().
+    std::vector<bool> integer_leaves;
+    for_each_and_every_column([&](ColKey col_key) {
+        auto col_ndx = col_key.get_index().val;
+        if (integer_leaves.size() <= col_ndx)
+            integer_leaves.resize(col_ndx + 1);
+        if (!col_key.is_collection()) {
+            auto type = col_key.get_type();
+            integer_leaves[col_ndx] = (type == col_type_Int && !col_key.is_nullable()) ||
+                                      (type == col_type_String && is_string_enum_type(col_key.get_index()));
+        }
+        return false;
+    });
+    return typed_write(ref, out, integer_leaves); // Throws
+}
+
+ref_type ClusterTree::typed_write(ref_type ref, _impl::ArrayWriterBase& out,
+                                  const std::vector<bool>& integer_leaves) const
+{
+    if (m_alloc.is_read_only(ref))
+        return ref;
+
+    Array node(m_alloc);
+    node.init_from_ref(ref);
+    bool is_inner = node.is_inner_bptree_node();
+
+    // Temp array for updated refs
+    Array written(Allocator::get_default());
+    written.create(is_inner ? Array::type_InnerBptreeNode : Array::type_HasRefs, node.get_context_flag()); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&written);
+
+    size_t sz = node.size();
+    for (size_t i = 0; i < sz; ++i) {
+        RefOrTagged rot = node.get_as_ref_or_tagged(i);
+        if (rot.is_ref() && rot.get_as_ref()) {
+            ref_type child_ref = rot.get_as_ref();
+            if (is_inner && i >= ClusterNodeInner::s_first_node_index) {
+                child_ref = typed_write(child_ref, out, integer_leaves); // Throws
+            }
+            else if (!is_inner && i >= Cluster::s_first_col_index &&
+                     i - Cluster::s_first_col_index < integer_leaves.size() &&
+                     integer_leaves[i - Cluster::s_first_col_index]) {
+                Array leaf(m_alloc);
+                leaf.init_from_ref(child_ref);
+                bool deep = false, only_if_modified = true, compress = true;
+                child_ref = leaf.write(out, deep, only_if_modified, compress); // Throws
+            }
+            else {
+                child_ref = Array::write(child_ref, m_alloc, out, true); // Throws
+            }
+            rot = RefOrTagged::make_ref(child_ref);
+        }
+        written.add(rot); // Throws
+    }
+
+    return written.write(out, false, false); // Throws
+}
+
 void ClusterTree::update(UpdateFunction func)
 {
     if (m_root->is_leaf()) {
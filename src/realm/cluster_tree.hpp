@@ -136,6 +136,19 @@ public:
     bool traverse(TraverseFunction func) const;
     // Visit all leaves and call the supplied function. The function can modify the leaf.
     void update(UpdateFunction func);
+    ref_type get_ref() const noexcept
+    {
+        return m_root->get_ref();
+    }
+    // Get the refs of the children of the node at `ref`. Those of an inner
+    // node are its child nodes. Those of a cluster are its column leafs, by
+    // column index, with zero for a column without a leaf. Returns true for a
+    // cluster.
+    static bool get_child_refs(Allocator& alloc, ref_type ref, std::vector<ref_type>& children);
+    // Write the tree with its root at `ref` as Array::write() would with
+    // `deep` and `only_if_modified` set, but let the writer compress the
+    // leaves of the integer columns. Returns the ref of the written root.
+    ref_type typed_write(ref_type ref, _impl::ArrayWriterBase& out) const;
 
     virtual void for_each_and_every_column(ColIterateFunction) const = 0;
     virtual void update_indexes(ObjKey k, const FieldValues& init_values) = 0;
@@ -151,6 +164,9 @@ public:
     }
     void verify() const;
 
+private:
+    ref_type typed_write(ref_type ref, _impl::ArrayWriterBase& out, const std::vector<bool>& integer_leaves) const;
+
 protected:
     friend class Obj;
     friend class Cluster;
@@ -51,12 +51,13 @@ enum ColumnAttr {
     col_attr_None = 0,
     col_attr_Indexed = 1,
 
-    /// Specifies that this column forms a unique constraint. It requires
-    /// `col_attr_Indexed`.
-    col_attr_Unique = 2,
+    /// Specifies that the search index of this column is a full-text index (a
+    /// FullTextIndex). It requires `col_attr_Indexed`.
+    col_attr_FullTextIndex = 2,
 
-    /// Reserved for future use.
-    col_attr_Reserved = 4,
+    /// Specifies that the search index of this column is ordered (a
+    /// RangeIndex). It requires `col_attr_Indexed`.
+    col_attr_OrderedIndex = 4,
 
     /// Specifies that the links of this column are strong, not weak. Applies
     /// only to link columns (`type_Link` and `type_LinkList`).
@@ -75,7 +76,27 @@ enum ColumnAttr {
     col_attr_Set = 128,
 
     /// Either list, dictionary, or set
-    col_attr_Collection = 128 + 64 + 32
+    col_attr_Collection = 128 + 64 + 32,
+
+    /// Specifies that the search index of this column is a case insensitive
+    /// StringIndex. It requires `col_attr_Indexed`. The eight bits below it
+    /// hold the key type of a dictionary column, and like the other kinds of
+    /// index it is not encoded into the column key.
+    col_attr_CaseInsensitiveIndex = 0x10000
+};
+
+/// The kinds of search index a column can have, see Table::add_search_index().
+enum class IndexType {
+    None,
+    /// StringIndex, serving equality lookups
+    General,
+    /// RangeIndex, serving range lookups and ordered traversal
+    Ordered,
+    /// FullTextIndex, serving word lookups of string columns
+    Fulltext,
+    /// StringIndex of case folded strings, serving case insensitive equality
+    /// lookups of string columns
+    CaseInsensitive
 };
 
 class ColumnAttrMask {
@@ -88,6 +109,10 @@ public:
     {
         return (m_value & prop) != 0;
     }
+    bool test_all(ColumnAttr prop)
+    {
+        return (m_value & prop) == prop;
+    }
     void set(ColumnAttr prop)
     {
         m_value |= prop;
@@ -19,11 +19,13 @@
 #include <algorithm>
 #include <atomic>
 #include <cerrno>
+#include <deque>
 #include <fcntl.h>
 #include <realm/db.hpp>
 #include <iostream>
 #include <mutex>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 #include <random>
 
@@ -42,7 +44,6 @@
 #include <realm/disable_sync_to_disk.hpp>
 
 #ifndef _WIN32
-#include <sys/wait.h>
 #include <sys/time.h>
 #include <unistd.h>
 #else
@@ -60,12 +61,6 @@ using Durability = DBOptions::Durability;
 
 namespace {
 
-// Constants controlling the amount of uncommited writes in flight:
-#ifdef REALM_ASYNC_DAEMON
-const uint16_t max_write_slots = 100;
-const uint16_t relaxed_sync_threshold = 50;
-#endif
-
 // value   change
 // --------------------
 //  4      Unknown
@@ -79,7 +74,9 @@ const uint16_t relaxed_sync_threshold = 50;
 //  9      Fair write transactions requires an additional condition variable,
 //         `write_fairness`
 // 10      Introducing SharedInfo::history_schema_version.
-const uint_fast16_t g_shared_info_version = 10;
+// 11      Introducing SharedInfo::group_commit and SharedInfo::durable_version.
+// 12      Removing the condition variables of the async commit daemon.
+const uint_fast16_t g_shared_info_version = 12;
 
 // The following functions are carefully designed for minimal overhead
 // in case of contention among read transactions. In case of contention,
@@ -327,6 +324,21 @@ public:
         return get(old_pos.load(std::memory_order_relaxed));
     }
 
+    // Calls `fn` for every entry from the oldest to the last one. Entries
+    // which are no longer bound may not have been cleaned up yet.
+    template <class F>
+    void for_each_live(F&& fn) const
+    {
+        uint_fast32_t idx = old_pos.load(std::memory_order_relaxed);
+        uint_fast32_t last_idx = last();
+        for (;;) {
+            fn(get(idx));
+            if (idx == last_idx)
+                break;
+            idx = get(idx).next;
+        }
+    }
+
     bool is_full() const noexcept
     {
         uint_fast32_t idx = get(last()).next;
@@ -459,7 +471,7 @@ struct alignas(8) DB::SharedInfo {
     uint16_t shared_info_version = g_shared_info_version; // Offset 6
 
     uint16_t durability;           // Offset 8
-    uint16_t free_write_slots = 0; // Offset 10
+    uint16_t free_write_slots = 0; // Offset 10 (unused)
 
     /// Number of participating shared groups
     uint32_t num_participants = 0; // Offset 12
@@ -484,17 +496,15 @@ struct alignas(8) DB::SharedInfo {
     /// sync agent can be started.
     uint8_t sync_agent_present = 0; // Offset 40
 
-    /// Set when a participant decides to start the daemon, cleared by the
-    /// daemon when it decides to exit. Participants check during open() and
-    /// start the daemon if running in async mode.
+    /// Used by the async commit daemon, which no longer exists. Kept in place
+    /// as the offsets of the following fields must not change.
     uint8_t daemon_started = 0; // Offset 41
+    uint8_t daemon_ready = 0;   // Offset 42
 
-    /// Set by the daemon when it is ready to handle commits. Participants must
-    /// wait during open() on 'daemon_becomes_ready' for this to become true.
-    /// Cleared by the daemon when it decides to exit.
-    uint8_t daemon_ready = 0; // Offset 42
-
-    uint8_t filler_1; // Offset 43
+    /// True (1) if commits are made durable by group commit (see
+    /// DBOptions::enable_group_commit). Must match across all session
+    /// participants.
+    uint8_t group_commit = 0; // Offset 43
 
     /// Stores a history schema version (as returned by
     /// Replication::get_history_schema_version()). Must match across all
@@ -504,19 +514,17 @@ struct alignas(8) DB::SharedInfo {
     uint16_t filler_2; // Offset 46
 
     InterprocessMutex::SharedPart shared_writemutex; // Offset 48
-#ifdef REALM_ASYNC_DAEMON
-    InterprocessMutex::SharedPart shared_balancemutex;
-#endif
     InterprocessMutex::SharedPart shared_controlmutex;
     // FIXME: windows pthread support for condvar not ready
-    InterprocessCondVar::SharedPart room_to_write;
-    InterprocessCondVar::SharedPart work_to_do;
-    InterprocessCondVar::SharedPart daemon_becomes_ready;
     InterprocessCondVar::SharedPart new_commit_available;
     InterprocessCondVar::SharedPart pick_next_writer;
     std::atomic<uint32_t> next_ticket;
     uint32_t next_served = 0;
 
+    /// The latest version bound by the file header. Guarded by the
+    /// controlmutex.
+    uint64_t durable_version = 0;
+
     // IMPORTANT: The ringbuffer MUST be the last field in SharedInfo - see above.
     Ringbuffer readers;
 
@@ -541,11 +549,8 @@ struct alignas(8) DB::SharedInfo {
 
 DB::SharedInfo::SharedInfo(Durability dura, Replication::HistoryType ht, int hsv)
     : size_of_mutex(sizeof(shared_writemutex))
-    , size_of_condvar(sizeof(room_to_write))
+    , size_of_condvar(sizeof(new_commit_available))
     , shared_writemutex() // Throws
-#ifdef REALM_ASYNC_DAEMON
-    , shared_balancemutex() // Throws
-#endif
     , shared_controlmutex() // Throws
 {
     durability = static_cast<uint16_t>(dura); // durability level is fixed from creation
@@ -556,11 +561,6 @@ DB::SharedInfo::SharedInfo(Durability dura, Replication::HistoryType ht, int hsv
     InterprocessCondVar::init_shared_part(new_commit_available); // Throws
     InterprocessCondVar::init_shared_part(pick_next_writer);     // Throws
     next_ticket = 0;
-#ifdef REALM_ASYNC_DAEMON
-    InterprocessCondVar::init_shared_part(room_to_write);        // Throws
-    InterprocessCondVar::init_shared_part(work_to_do);           // Throws
-    InterprocessCondVar::init_shared_part(daemon_becomes_ready); // Throws
-#endif
 
 // IMPORTANT: The offsets, types (, and meanings) of these members must
 // never change, not even when the SharedInfo layout version is bumped. The
@@ -606,7 +606,7 @@ DB::SharedInfo::SharedInfo(Durability dura, Replication::HistoryType ht, int hsv
             std::is_same<decltype(sync_agent_present), uint8_t>::value &&
             offsetof(SharedInfo, daemon_started) == 41 && std::is_same<decltype(daemon_started), uint8_t>::value &&
             offsetof(SharedInfo, daemon_ready) == 42 && std::is_same<decltype(daemon_ready), uint8_t>::value &&
-            offsetof(SharedInfo, filler_1) == 43 && std::is_same<decltype(filler_1), uint8_t>::value &&
+            offsetof(SharedInfo, group_commit) == 43 && std::is_same<decltype(group_commit), uint8_t>::value &&
             offsetof(SharedInfo, history_schema_version) == 44 &&
             std::is_same<decltype(history_schema_version), uint16_t>::value && offsetof(SharedInfo, filler_2) == 46 &&
             std::is_same<decltype(filler_2), uint16_t>::value && offsetof(SharedInfo, shared_writemutex) == 48 &&
@@ -618,101 +618,246 @@ DB::SharedInfo::SharedInfo(Durability dura, Replication::HistoryType ht, int hsv
 }
 
 
-namespace {
+// The write lock is an interprocess mutex which must be unlocked by the
+// thread that locked it. For asynchronous write transactions it is therefore
+// locked and unlocked by the helper thread, and lent to the transaction which
+// requested it in between. In Durability::Async mode, the helper thread also
+// flushes the commits made through this DB within the flush interval.
+class DB::AsyncCommitHelper {
+public:
+    explicit AsyncCommitHelper(DB& db)
+        : m_db(db)
+    {
+        m_thread = std::thread([this] {
+            main();
+        });
+    }
 
-#ifdef REALM_ASYNC_DAEMON
-// FIXME: Async commits unsupported
-void spawn_daemon(const std::string& file)
-{
-    // determine maximum number of open descriptors
-    errno = 0;
-    int m = int(sysconf(_SC_OPEN_MAX));
-    if (m < 0) {
-        if (errno) {
-            int err = errno; // Eliminate any risk of clobbering
-            throw std::system_error(err, std::system_category(), "sysconf(_SC_OPEN_MAX) failed");
+    ~AsyncCommitHelper() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shutdown = true;
+            m_cv.notify_all();
         }
-        throw std::runtime_error("'sysconf(_SC_OPEN_MAX)' failed with no reason");
+        m_thread.join();
     }
 
-    int pid = fork();
-    if (0 == pid) { // child process:
+    void request_write_lock(Transaction* tr, std::function<void()> when_acquired)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_write_requests.push_back({tr, std::move(when_acquired)});
+        m_cv.notify_all();
+    }
 
-        // close all descriptors:
-        int i;
-        for (i = m - 1; i >= 0; --i)
-            close(i);
-#ifdef REALM_ENABLE_LOGFILE
-        // FIXME: Do we want to always open the log file? Should it be configurable?
-        i = ::open((file + ".log").c_str(), O_RDWR | O_CREAT | O_APPEND | O_SYNC, S_IRWXU);
-#else
-        i = ::open("/dev/null", O_RDWR);
-#endif
-        if (i >= 0) {
-            int j = dup(i);
-            static_cast<void>(j);
-        }
-#ifdef REALM_ENABLE_LOGFILE
-        std::cerr << "Detaching" << std::endl;
-#endif
-        // detach from current session:
-        setsid();
-
-        // start commit daemon executable
-        // Note that getenv (which is not thread safe) is called in a
-        // single threaded context. This is ensured by the fork above.
-        const char* async_daemon = getenv("REALM_ASYNC_DAEMON");
-        if (!async_daemon) {
-#ifndef REALM_DEBUG
-            async_daemon = REALM_INSTALL_LIBEXECDIR "/realmd";
-#else
-            async_daemon = REALM_INSTALL_LIBEXECDIR "/realmd-dbg";
-#endif
+    void request_sync(AsyncSyncCallback when_durable)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sync_requests.push_back(std::move(when_durable));
+        m_cv.notify_all();
+    }
+
+    // Called after each commit in Durability::Async mode. The flush is timed
+    // from the first commit it covers, which bounds how long a commit can
+    // remain unflushed.
+    void schedule_flush() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_flush_scheduled) {
+            m_flush_scheduled = true;
+            m_flush_deadline = std::chrono::steady_clock::now() + m_db.m_async_flush_interval;
+            m_cv.notify_all();
         }
-        execl(async_daemon, async_daemon, file.c_str(), static_cast<char*>(0));
+    }
 
-// if we continue here, exec has failed so return error
-// if exec succeeds, we don't come back here.
-#if REALM_ANDROID
-        _exit(1);
-#else
-        _Exit(1);
-#endif
-        // child process ends here
+    bool take_write_lock(Transaction* tr)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto is_reserved = [&] {
+            return m_state == LockState::reserved && m_reserved_for == tr;
+        };
+        auto is_requested = [&] {
+            return std::any_of(m_write_requests.begin(), m_write_requests.end(), [&](auto& request) {
+                return request.tr == tr;
+            });
+        };
+        if (!is_reserved() && !is_requested())
+            return false;
+        m_cv.wait(lock, [&] {
+            return is_reserved() || !is_requested();
+        });
+        if (!is_reserved())
+            return false; // The helper thread failed to acquire the lock
+        m_state = LockState::in_use;
+        return true;
     }
-    else if (pid > 0) { // parent process, fork succeeded:
 
-        // use childs exit code to catch and report any errors:
-        int status;
-        int pid_changed;
-        do {
-            pid_changed = waitpid(pid, &status, 0);
-        } while (pid_changed == -1 && errno == EINTR);
-        if (pid_changed != pid) {
-            std::cerr << "Waitpid returned pid = " << pid_changed << " and status = " << std::hex << status
-                      << std::endl;
-            throw std::runtime_error("call to waitpid failed");
-        }
-        if (!WIFEXITED(status))
-            throw std::runtime_error("failed starting async commit (exit)");
-        if (WEXITSTATUS(status) == 1) {
-            // FIXME: Or `ld` could not find a required shared library
-            throw std::runtime_error("async commit daemon not found");
-        }
-        if (WEXITSTATUS(status) == 2)
-            throw std::runtime_error("async commit daemon failed");
-        if (WEXITSTATUS(status) == 3)
-            throw std::runtime_error("wrong db given to async daemon");
+    // Called from do_end_write(). Returns true if the lock is to be unlocked
+    // by the helper thread.
+    bool hand_back_write_lock() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_state != LockState::in_use)
+            return false;
+        m_state = LockState::returned;
+        m_reserved_for = nullptr;
+        m_cv.notify_all();
+        return true;
     }
-    else { // Parent process, fork failed!
 
-        throw std::runtime_error("Failed to spawn async commit");
+    void cancel_write_lock_request(Transaction* tr) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::remove_if(m_write_requests.begin(), m_write_requests.end(), [&](auto& request) {
+            return request.tr == tr;
+        });
+        if (it != m_write_requests.end()) {
+            // The callbacks may own the transaction, so they must not be
+            // destroyed while holding the mutex
+            for (auto i = it; i != m_write_requests.end(); ++i)
+                m_cancelled.push_back(std::move(i->when_acquired));
+            m_write_requests.erase(it, m_write_requests.end());
+        }
+        if (m_state == LockState::reserved && m_reserved_for == tr)
+            m_reserved_for = nullptr;
+        m_cv.notify_all();
     }
-}
-#endif
 
+private:
+    enum class LockState {
+        unlocked, // Not held by the helper thread
+        reserved, // Held by the helper thread for `m_reserved_for`
+        in_use,   // Held by the helper thread, and used by `m_reserved_for`
+        returned, // To be unlocked by the helper thread
+    };
+    struct WriteRequest {
+        Transaction* tr;
+        std::function<void()> when_acquired;
+    };
 
-} // anonymous namespace
+    DB& m_db;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<WriteRequest> m_write_requests;
+    std::vector<std::function<void()>> m_cancelled;
+    std::vector<AsyncSyncCallback> m_sync_requests;
+    LockState m_state = LockState::unlocked;
+    Transaction* m_reserved_for = nullptr;
+    bool m_flush_scheduled = false;
+    std::chrono::steady_clock::time_point m_flush_deadline;
+    bool m_shutdown = false;
+
+    void main();
+};
+
+void DB::AsyncCommitHelper::main()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        if (!m_cancelled.empty()) {
+            auto cancelled = std::move(m_cancelled);
+            m_cancelled.clear();
+            lock.unlock();
+            cancelled.clear();
+            lock.lock();
+            continue;
+        }
+        if (m_state == LockState::returned) {
+            lock.unlock();
+            m_db.m_writemutex.unlock();
+            lock.lock();
+            m_state = LockState::unlocked;
+            continue;
+        }
+        if (m_state == LockState::reserved && (!m_reserved_for || m_shutdown)) {
+            // The request was cancelled before the lock was taken
+            m_reserved_for = nullptr;
+            lock.unlock();
+            m_db.do_end_write();
+            lock.lock();
+            m_state = LockState::unlocked;
+            m_cv.notify_all();
+            continue;
+        }
+        if (m_state == LockState::unlocked && !m_sync_requests.empty()) {
+            auto callbacks = std::move(m_sync_requests);
+            m_sync_requests.clear();
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                m_db.sync_latest_version_to_disk(); // Throws
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            for (auto& callback : callbacks) {
+                if (callback)
+                    callback(error);
+            }
+            callbacks.clear();
+            lock.lock();
+            continue;
+        }
+        if (m_state == LockState::unlocked && !m_write_requests.empty() && !m_shutdown) {
+            lock.unlock();
+            bool got_the_lock = true;
+            try {
+                m_db.do_begin_write(); // Throws
+            }
+            catch (...) {
+                // The requesting transaction will get the same error when it
+                // tries to acquire the lock itself
+                got_the_lock = false;
+            }
+            lock.lock();
+            if (m_write_requests.empty()) {
+                // Cancelled while we were waiting for the lock
+                if (got_the_lock) {
+                    lock.unlock();
+                    m_db.do_end_write();
+                    lock.lock();
+                }
+                continue;
+            }
+            WriteRequest request = std::move(m_write_requests.front());
+            m_write_requests.pop_front();
+            if (got_the_lock) {
+                m_state = LockState::reserved;
+                m_reserved_for = request.tr;
+            }
+            m_cv.notify_all();
+            lock.unlock();
+            request.when_acquired();
+            request.when_acquired = nullptr;
+            lock.lock();
+            continue;
+        }
+        if (m_flush_scheduled && !m_shutdown && std::chrono::steady_clock::now() >= m_flush_deadline) {
+            // The write lock is not needed, as commits in Durability::Async
+            // mode leave the file header alone
+            m_flush_scheduled = false;
+            lock.unlock();
+            try {
+                m_db.sync_latest_version_to_disk(); // Throws
+            }
+            catch (...) {
+                // The versions stay unflushed until the next commit schedules
+                // another flush, or the DB is closed.
+            }
+            lock.lock();
+            continue;
+        }
+        if (m_shutdown && m_state != LockState::reserved)
+            break;
+        if (m_flush_scheduled && !m_shutdown) {
+            m_cv.wait_until(lock, m_flush_deadline);
+        }
+        else {
+            m_cv.wait(lock);
+        }
+    }
+}
 
 #if REALM_HAVE_STD_FILESYSTEM
 std::string DBOptions::sys_tmp_dir = std::filesystem::temp_directory_path().u8string();
@@ -738,7 +883,7 @@ std::string DBOptions::sys_tmp_dir = getenv("TMPDIR") ? getenv("TMPDIR") : "";
 // initializing process crashes and leaves the shared memory in an
 // undefined state.
 
-void DB::do_open(const std::string& path, bool no_create_file, bool is_backend, const DBOptions options)
+void DB::do_open(const std::string& path, bool no_create_file, const DBOptions options)
 {
     // Exception safety: Since do_open() is called from constructors, if it
     // throws, it must leave the file closed.
@@ -747,10 +892,9 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
 
     REALM_ASSERT(!is_attached());
 
-#ifndef REALM_ASYNC_DAEMON
-    if (options.durability == Durability::Async)
-        throw std::runtime_error("Async mode not yet supported on Windows, iOS and watchOS");
-#endif
+    m_group_commit = options.enable_group_commit && options.durability == Durability::Full && !m_key;
+    m_group_commit_max_delay = options.group_commit_max_delay;
+    m_async_flush_interval = options.async_flush_interval;
 
     m_db_path = path;
     m_coordination_dir = path + ".management";
@@ -822,6 +966,7 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
             SharedInfo* info_2 = m_file_map.get_addr();
 
             new (info_2) SharedInfo{options.durability, openers_hist_type, openers_hist_schema_version}; // Throws
+            info_2->group_commit = m_group_commit;
 
             // Because init_complete is an std::atomic, it's guaranteed not to be observable by others
             // as being 1 before the entire SharedInfo header has been written.
@@ -932,14 +1077,14 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
             throw IncompatibleLockFile(ss.str());
         }
 
-        if (info->size_of_condvar != sizeof info->room_to_write) {
+        if (info->size_of_condvar != sizeof info->new_commit_available) {
             if (retries_left) {
                 --retries_left;
                 continue;
             }
             std::stringstream ss;
-            ss << "Condtion var size doesn't match: " << info->size_of_condvar << " " << sizeof(info->room_to_write)
-               << ".";
+            ss << "Condtion var size doesn't match: " << info->size_of_condvar << " "
+               << sizeof(info->new_commit_available) << ".";
             throw IncompatibleLockFile(ss.str());
         }
 
@@ -959,10 +1104,6 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
         // again and prevent us from being notified below.
 
         m_writemutex.set_shared_part(info->shared_writemutex, m_lockfile_prefix, "write");
-#ifdef REALM_ASYNC_DAEMON
-        if (info->durability == static_cast<uint16_t>(Durability::Async))
-            m_balancemutex.set_shared_part(info->shared_balancemutex, m_lockfile_prefix, "balance");
-#endif
         m_controlmutex.set_shared_part(info->shared_controlmutex, m_lockfile_prefix, "control");
 
         // even though fields match wrt alignment and size, there may still be incompatibilities
@@ -974,8 +1115,6 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
         // OK! lock file appears valid. We can now continue operations under the protection
         // of the controlmutex. The controlmutex protects the following activities:
         // - attachment of the database file
-        // - start of the async daemon
-        // - stop of the async daemon
         // - DB beginning/ending a session
         // - Waiting for and signalling database changes
         {
@@ -1065,6 +1204,7 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                 case 10:
                 case 11:
                 case 20:
+                case 21:
                     file_format_ok = true;
                     break;
             }
@@ -1075,6 +1215,10 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
 
             target_file_format_version =
                 Group::get_target_file_format_version_for_session(current_file_format_version, openers_hist_type);
+            // Releases which only know format 20 cannot open a format 21
+            // file, so a format 20 file is only upgraded on request.
+            if (current_file_format_version == 20 && !options.upgrade_to_file_format_21)
+                target_file_format_version = 20;
 
             if (begin_new_session) {
                 // Determine version (snapshot number) and check history
@@ -1161,6 +1305,7 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                 info->number_of_versions = 1;
 
                 info->latest_version_number = version;
+                info->durable_version = version;
                 alloc.init_mapping_management(version);
 
                 SharedInfo* r_info = m_reader_map.get_addr();
@@ -1175,6 +1320,8 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                 // use the same durability setting for the same Realm file.
                 if (Durability(info->durability) != options.durability)
                     throw LogicError(LogicError::mixed_durability);
+                if (bool(info->group_commit) != m_group_commit)
+                    throw LogicError(LogicError::mixed_group_commit);
 
                 // History type must be consistent across a session. An
                 // inconsistency is a logic error, as the user is required to
@@ -1244,29 +1391,6 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                                                    options.temp_dir);
             m_pick_next_writer.set_shared_part(info->pick_next_writer, m_lockfile_prefix, "pick_writer",
                                                options.temp_dir);
-#ifdef REALM_ASYNC_DAEMON
-            if (options.durability == Durability::Async) {
-                m_daemon_becomes_ready.set_shared_part(info->daemon_becomes_ready, m_lockfile_prefix, "daemon_ready",
-                                                       options.temp_dir);
-                m_work_to_do.set_shared_part(info->work_to_do, m_lockfile_prefix, "work_ready", options.temp_dir);
-                m_room_to_write.set_shared_part(info->room_to_write, m_lockfile_prefix, "allow_write",
-                                                options.temp_dir);
-                // In async mode, we need to make sure the daemon is running and ready:
-                if (!is_backend) {
-                    while (info->daemon_ready == 0) {
-                        if (info->daemon_started == 0) {
-                            spawn_daemon(path);
-                            info->daemon_started = 1;
-                        }
-                        // FIXME: It might be more robust to sleep a little, then restart the loop
-                        // std::cerr << "Waiting for daemon" << std::endl;
-                        m_daemon_becomes_ready.wait(m_controlmutex, 0);
-                        // std::cerr << " - notified" << std::endl;
-                    }
-                }
-            }
-// std::cerr << "daemon should be ready" << std::endl;
-#endif // REALM_ASYNC_DAEMON
 
             // make our presence noted:
             ++info->num_participants;
@@ -1287,16 +1411,6 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
 
     // std::cerr << "open completed" << std::endl;
 
-#ifdef REALM_ASYNC_DAEMON
-    if (options.durability == Durability::Async) {
-        if (is_backend) {
-            do_async_commits();
-        }
-    }
-#else
-    static_cast<void>(is_backend);
-#endif
-
     // Upgrade file format and/or history schema
     try {
         if (stored_hist_schema_version == -1) {
@@ -1332,8 +1446,7 @@ void DB::open(const std::string& path, bool no_create_file, const DBOptions opti
     // Exception safety: Since open() is called from constructors, if it throws,
     // it must leave the file closed.
 
-    bool is_backend = false;
-    do_open(path, no_create_file, is_backend, options); // Throws
+    do_open(path, no_create_file, options); // Throws
 }
 
 void DB::open(Replication& repl, const DBOptions options)
@@ -1354,8 +1467,7 @@ void DB::open(Replication& repl, const DBOptions options)
 
     std::string file = repl.get_database_path();
     bool no_create = false;
-    bool is_backend = false;
-    do_open(file, no_create, is_backend, options); // Throws
+    do_open(file, no_create, options); // Throws
 }
 
 
@@ -1405,6 +1517,10 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
         if (info->num_participants > 1)
             return false;
 
+        // The compacted file is durable when we are done, so the version
+        // bound by the file header needs no protection.
+        release_durable_read_lock();
+
         // Holding the controlmutex prevents any other DB from attaching to the file.
 
         // local lock blocking any transaction from starting (and stopping)
@@ -1481,7 +1597,27 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
         SharedInfo* r_info = m_reader_map.get_addr();
         size_t file_size = m_alloc.get_baseline();
         r_info->init_versioning(top_ref, file_size, info->latest_version_number);
+        info->durable_version = info->latest_version_number;
+    }
+    // The file has been compacted already
+    m_online_compaction_request = 0;
+    m_evacuation.reset();
+    m_online_compaction_active = false;
+    return true;
+}
+
+bool DB::start_online_compaction(size_t bytes_per_commit)
+{
+    if (is_attached() == false) {
+        throw std::runtime_error(m_db_path + ": compact must be done on an open/attached DB");
     }
+    SharedInfo* info = m_file_map.get_addr();
+    Durability dura = Durability(info->durability);
+    if (m_key || (dura != Durability::Full && dura != Durability::Unsafe))
+        return false;
+    REALM_ASSERT(bytes_per_commit > 0);
+    m_online_compaction_active = true;
+    m_online_compaction_request = bytes_per_commit;
     return true;
 }
 
@@ -1492,6 +1628,25 @@ uint_fast64_t DB::get_number_of_versions()
     return info->number_of_versions;
 }
 
+uint_fast64_t DB::get_number_of_unflushed_versions()
+{
+    SharedInfo* info = m_file_map.get_addr();
+    if (Durability(info->durability) == Durability::MemOnly)
+        return 0;
+    std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
+    return info->latest_version_number - info->durable_version;
+}
+
+void DB::flush()
+{
+    SharedInfo* info = m_file_map.get_addr();
+    if (Durability(info->durability) == Durability::MemOnly)
+        return;
+    if (get_number_of_unflushed_versions() == 0)
+        return;
+    sync_latest_version_to_disk(); // Throws
+}
+
 size_t DB::get_allocated_size() const
 {
     return m_alloc.get_allocated_size();
@@ -1532,6 +1687,24 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
     if (!is_attached())
         return;
 
+    stop_commit_helper();
+    if (!lock.owns_lock()) {
+        // Leave the file header bound to the latest version, as other
+        // participants do not protect the version we made durable.
+        bool pinned;
+        {
+            std::lock_guard<std::mutex> flush_lock(m_flush_mutex);
+            pinned = m_durable_read_lock.m_version != std::numeric_limits<version_type>::max();
+        }
+        if (pinned) {
+            try {
+                sync_latest_version_to_disk(); // Throws
+            }
+            catch (...) {
+            } // ignored on purpose.
+        }
+    }
+    release_durable_read_lock();
     {
         std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
         if (m_write_transaction_open)
@@ -1546,6 +1719,12 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
         if (!lock.owns_lock())
             lock.lock();
 
+        // Other participants may have any part of the file mapped, so space
+        // given back at the end of the file by online compaction is only
+        // returned to the file system by the last one to leave
+        size_t logical_file_size = 0;
+        if (info->num_participants == 1)
+            logical_file_size = get_truncatable_file_size();
         if (m_alloc.is_attached())
             m_alloc.detach();
 
@@ -1568,6 +1747,18 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
                 catch (...) {
                 } // ignored on purpose.
             }
+            else if (logical_file_size != 0) {
+                try {
+                    util::File file(m_db_path, util::File::mode_Update);
+                    if (to_size_t(file.get_size()) > logical_file_size) {
+                        file.resize(logical_file_size);
+                        if (Durability(info->durability) != Durability::Unsafe)
+                            file.sync();
+                    }
+                }
+                catch (...) {
+                } // ignored on purpose.
+            }
             if (m_replication)
                 m_replication->terminate_session();
         }
@@ -1576,11 +1767,6 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
     {
         std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
 
-#ifdef REALM_ASYNC_DAEMON
-        m_room_to_write.close();
-        m_work_to_do.close();
-        m_daemon_becomes_ready.close();
-#endif
         m_new_commit_available.close();
         m_pick_next_writer.close();
 
@@ -1595,6 +1781,69 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
     }
 }
 
+size_t DB::get_truncatable_file_size() noexcept
+{
+    SharedInfo* info = m_file_map.get_addr();
+    Durability durability = Durability(info->durability);
+    if (m_key || !m_alloc.is_attached() || (durability != Durability::Full && durability != Durability::Unsafe))
+        return 0;
+    // The file header must be bound to the latest snapshot, whose logical
+    // file size is then the size of all data still in use
+    if (info->durable_version != info->latest_version_number)
+        return 0;
+    try {
+        std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
+        SharedInfo* r_info = m_reader_map.get_addr();
+        const Ringbuffer::ReadCount& last = r_info->readers.get_last();
+        ref_type top_ref = to_ref(last.current_top);
+        if (!top_ref)
+            return 0;
+        m_alloc.update_reader_view(to_size_t(last.filesize)); // Throws
+        Array top(m_alloc);
+        top.init_from_ref(top_ref);
+        return to_size_t(top.get(2) / 2);
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+void DB::truncate_unused_tail(size_t logical_file_size) noexcept
+{
+#ifndef _WIN32
+    SharedInfo* info = m_file_map.get_addr();
+    Durability durability = Durability(info->durability);
+    if (m_key || (durability != Durability::Full && durability != Durability::Unsafe))
+        return;
+    File& file = m_alloc.get_file();
+    try {
+        size_t file_size = to_size_t(file.get_size());
+        if (file_size <= logical_file_size)
+            return;
+        // The space is only given back when no snapshot which may still be
+        // bound in any session extends into it. Those sessions may have it
+        // mapped, which is fine as long as they never touch it.
+        size_t new_file_size = logical_file_size;
+        SharedInfo* r_info = m_reader_map.get_addr();
+        r_info->readers.for_each_live([&](const Ringbuffer::ReadCount& r) {
+            if (ref_type top_ref = to_ref(r.current_top)) {
+                size_t size = to_size_t(Array::get(m_alloc.translate(top_ref), 2) / 2);
+                new_file_size = std::max(new_file_size, size);
+            }
+        });
+        // A later commit extends the file again from the logical size, so
+        // the truncation does not have to be made durable
+        if (new_file_size < file_size)
+            file.resize(new_file_size);
+    }
+    catch (...) {
+    } // ignored on purpose.
+#else
+    // A file cannot be truncated on Windows while it is mapped
+    static_cast<void>(logical_file_size);
+#endif
+}
+
 bool DB::has_changed(TransactionRef tr)
 {
     bool changed = tr->m_read_lock.m_version != get_version_of_latest_snapshot();
@@ -1636,26 +1885,27 @@ void Transaction::set_transact_stage(DB::TransactStage stage) noexcept
         size_t num_objects = m_total_rows;
         size_t num_available_versions = static_cast<size_t>(db->get_number_of_versions());
         size_t num_decrypted_pages = realm::util::get_num_decrypted_pages();
+        size_t num_unflushed_versions = static_cast<size_t>(db->get_number_of_unflushed_versions());
 
         if (stage == DB::transact_Reading) {
             if (m_transact_stage == DB::transact_Writing) {
                 m_metrics->end_write_transaction(total_size, free_space, num_objects, num_available_versions,
-                                                 num_decrypted_pages);
+                                                 num_decrypted_pages, num_unflushed_versions);
             }
             m_metrics->start_read_transaction();
         }
         else if (stage == DB::transact_Writing) {
             if (m_transact_stage == DB::transact_Reading) {
                 m_metrics->end_read_transaction(total_size, free_space, num_objects, num_available_versions,
-                                                num_decrypted_pages);
+                                                num_decrypted_pages, num_unflushed_versions);
             }
             m_metrics->start_write_transaction();
         }
         else if (stage == DB::transact_Ready) {
             m_metrics->end_read_transaction(total_size, free_space, num_objects, num_available_versions,
-                                            num_decrypted_pages);
+                                            num_decrypted_pages, num_unflushed_versions);
             m_metrics->end_write_transaction(total_size, free_space, num_objects, num_available_versions,
-                                             num_decrypted_pages);
+                                             num_decrypted_pages, num_unflushed_versions);
         }
     }
 #endif
@@ -1663,110 +1913,6 @@ void Transaction::set_transact_stage(DB::TransactStage stage) noexcept
     m_transact_stage = stage;
 }
 
-#ifdef REALM_ASYNC_DAEMON
-void DB::do_async_commits()
-{
-    bool shutdown = false;
-    SharedInfo* info = m_file_map.get_addr();
-
-    // We always want to keep a read lock on the last version
-    // that was commited to disk, to protect it against being
-    // overwritten by commits being made to memory by others.
-    {
-        VersionID version_id = VersionID();      // Latest available snapshot
-        grab_read_lock(m_read_lock, version_id); // Throws
-    }
-    // we must treat version and version_index the same way:
-    {
-        std::lock_guard<InterprocessMutex> lock(m_controlmutex);
-        info->free_write_slots = max_write_slots;
-        info->daemon_ready = 1;
-        m_daemon_becomes_ready.notify_all();
-    }
-
-    while (true) {
-        if (m_file.is_removed()) { // operator removed the lock file. take a hint!
-
-            shutdown = true;
-#ifdef REALM_ENABLE_LOGFILE
-            std::cerr << "Lock file removed, initiating shutdown" << std::endl;
-#endif
-        }
-
-        bool is_same;
-        ReadLockInfo next_read_lock = m_read_lock;
-        {
-            // detect if we're the last "client", and if so, shutdown (must be under lock):
-            std::lock_guard<InterprocessMutex> lock2(m_writemutex);
-            std::lock_guard<InterprocessMutex> lock(m_controlmutex);
-            version_type old_version = next_read_lock.m_version;
-            VersionID version_id = VersionID(); // Latest available snapshot
-            grab_read_lock(next_read_lock, version_id);
-            is_same = (next_read_lock.m_version == old_version);
-            if (is_same && (shutdown || info->num_participants == 1)) {
-#ifdef REALM_ENABLE_LOGFILE
-                std::cerr << "Daemon exiting nicely" << std::endl << std::endl;
-#endif
-                release_read_lock(next_read_lock);
-                release_read_lock(m_read_lock);
-                info->daemon_started = 0;
-                info->daemon_ready = 0;
-                return;
-            }
-        }
-
-        if (!is_same) {
-
-#ifdef REALM_ENABLE_LOGFILE
-            std::cerr << "Syncing from version " << m_read_lock.m_version << " to " << next_read_lock.m_version
-                      << std::endl;
-#endif
-/* FIXME
-            GroupWriter writer(m_group);
-            writer.commit(next_read_lock.m_top_ref);
-            */
-#ifdef REALM_ENABLE_LOGFILE
-            std::cerr << "..and Done" << std::endl;
-#endif
-        }
-
-        // Now we can release the version that was previously commited
-        // to disk and just keep the lock on the latest version.
-        release_read_lock(m_read_lock);
-        m_read_lock = next_read_lock;
-
-        m_balancemutex.lock();
-
-        // We have caught up with the writers, let them know that there are
-        // now free write slots, wakeup any that has been suspended.
-        uint16_t free_write_slots = info->free_write_slots;
-        info->free_write_slots = max_write_slots;
-        if (free_write_slots <= 0) {
-            m_room_to_write.notify_all();
-        }
-
-        // If we have plenty of write slots available, relax and wait a bit before syncing
-        if (free_write_slots > relaxed_sync_threshold) {
-            timespec ts;
-            timeval tv;
-            // clock_gettime(CLOCK_REALTIME, &ts); <- would like to use this, but not there on mac
-            gettimeofday(&tv, nullptr);
-            ts.tv_sec = tv.tv_sec;
-            ts.tv_nsec = tv.tv_usec * 1000;
-            ts.tv_nsec += 10000000;         // 10 msec
-            if (ts.tv_nsec >= 1000000000) { // overflow
-                ts.tv_nsec -= 1000000000;
-                ts.tv_sec += 1;
-            }
-
-            // no timeout support if the condvars are only emulated, so this will assert
-            m_work_to_do.wait(m_balancemutex, &ts);
-        }
-        m_balancemutex.unlock();
-    }
-}
-#endif // REALM_ASYNC_DAEMON
-
 
 void DB::upgrade_file_format(bool allow_file_format_upgrade, int target_file_format_version,
                              int current_hist_schema_version, int target_hist_schema_version)
@@ -1953,6 +2099,10 @@ bool DB::do_try_begin_write()
     bool got_the_lock = m_writemutex.try_lock();
     if (got_the_lock) {
         finish_begin_write();
+        if (m_group_commit) {
+            std::lock_guard<std::mutex> lock(m_flush_mutex);
+            ++m_num_writers;
+        }
     }
     return got_the_lock;
 }
@@ -1961,6 +2111,20 @@ void DB::do_begin_write()
 {
     SharedInfo* info = m_file_map.get_addr();
 
+    // A pending group commit flush may wait for us to join it
+    if (m_group_commit) {
+        std::lock_guard<std::mutex> lock(m_flush_mutex);
+        ++m_num_writers;
+    }
+    bool began_write = false;
+    auto writer_guard = util::make_scope_exit([&]() noexcept {
+        if (m_group_commit && !began_write) {
+            std::lock_guard<std::mutex> lock(m_flush_mutex);
+            --m_num_writers;
+            m_flush_cv.notify_all();
+        }
+    });
+
     // Get write lock - the write lock is held until do_end_write().
     //
     // We use a ticketing scheme to ensure fairness wrt performing write transactions.
@@ -2017,6 +2181,7 @@ void DB::do_begin_write()
     // should take this situation into account by comparing with '>' instead of '!='
     info->next_served = my_ticket;
     finish_begin_write();
+    began_write = true;
 }
 
 void DB::finish_begin_write()
@@ -2026,24 +2191,6 @@ void DB::finish_begin_write()
         m_writemutex.unlock();
         throw std::runtime_error("Crash of other process detected, session restart required");
     }
-
-#ifdef REALM_ASYNC_DAEMON
-    if (info->durability == static_cast<uint16_t>(Durability::Async)) {
-
-        m_balancemutex.lock(); // Throws
-
-        // if we are running low on write slots, kick the sync daemon
-        if (info->free_write_slots < relaxed_sync_threshold)
-            m_work_to_do.notify();
-        // if we are out of write slots, wait for the sync daemon to catch up
-        while (info->free_write_slots <= 0) {
-            m_room_to_write.wait(m_balancemutex, 0);
-        }
-
-        info->free_write_slots--;
-        m_balancemutex.unlock();
-    }
-#endif // REALM_ASYNC_DAEMON
 }
 
 
@@ -2053,13 +2200,23 @@ void DB::do_end_write() noexcept
     info->next_served++;
     m_pick_next_writer.notify_all();
 
-    std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
-    m_write_transaction_open = false;
-    m_writemutex.unlock();
+    {
+        std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
+        m_write_transaction_open = false;
+        // A lock lent by the helper thread must be unlocked by that thread
+        if (!m_commit_helper || !m_commit_helper->hand_back_write_lock())
+            m_writemutex.unlock();
+    }
+
+    if (m_group_commit) {
+        std::lock_guard<std::mutex> lock(m_flush_mutex);
+        --m_num_writers;
+        m_flush_cv.notify_all();
+    }
 }
 
 
-Replication::version_type DB::do_commit(Transaction& transaction)
+Replication::version_type DB::do_commit(Transaction& transaction, bool continue_writing, bool commit_to_disk)
 {
     version_type current_version;
     {
@@ -2076,7 +2233,7 @@ Replication::version_type DB::do_commit(Transaction& transaction)
         // must call Replication::abort_transact().
         new_version = repl->prepare_commit(current_version); // Throws
         try {
-            low_level_commit(new_version, transaction); // Throws
+            low_level_commit(new_version, transaction, continue_writing, commit_to_disk); // Throws
         }
         catch (...) {
             repl->abort_transact();
@@ -2085,13 +2242,13 @@ Replication::version_type DB::do_commit(Transaction& transaction)
         repl->finalize_commit();
     }
     else {
-        low_level_commit(new_version, transaction); // Throws
+        low_level_commit(new_version, transaction, continue_writing, commit_to_disk); // Throws
     }
     return new_version;
 }
 
 
-DB::version_type Transaction::commit_and_continue_as_read()
+DB::version_type Transaction::commit_and_continue_as_read(bool commit_to_disk)
 {
     if (!is_attached())
         throw LogicError(LogicError::wrong_transact_state);
@@ -2100,7 +2257,7 @@ DB::version_type Transaction::commit_and_continue_as_read()
 
     flush_accessors_for_commit();
 
-    DB::version_type version = db->do_commit(*this); // Throws
+    DB::version_type version = db->do_commit(*this, false, commit_to_disk); // Throws
 
     // advance read lock but dont update accessors:
     // As this is done under lock, along with the addition above of the newest commit,
@@ -2119,13 +2276,38 @@ DB::version_type Transaction::commit_and_continue_as_read()
 
     // Remap file if it has grown, and update refs in underlying node structure
     remap_and_update_refs(m_read_lock.m_top_ref, m_read_lock.m_file_size, false); // Throws
+    if (m_arrays_relocated) {
+        // Online compaction moved arrays which the accessors did not modify,
+        // and which they may therefore still refer to. Rebuild the accessors
+        // of every table as when advancing to a new snapshot.
+        m_arrays_relocated = false;
+        refresh_dirty_accessors(); // Throws
+    }
 
     m_history = nullptr;
     set_transact_stage(DB::transact_Reading);
 
+    if (db->m_group_commit && commit_to_disk)
+        db->wait_until_durable(version, true); // Throws
+
+    return version;
+}
+
+DB::version_type Transaction::async_commit(DB::AsyncSyncCallback when_durable)
+{
+    DB::version_type version = commit_and_continue_as_read(false); // Throws
+    db->async_sync_to_disk(std::move(when_durable));              // Throws
     return version;
 }
 
+void Transaction::async_request_write_lock(std::function<void()> when_acquired)
+{
+    if (m_transact_stage != DB::transact_Reading)
+        throw LogicError(LogicError::wrong_transact_state);
+    REALM_ASSERT(when_acquired);
+    db->get_commit_helper().request_write_lock(this, std::move(when_acquired)); // Throws
+}
+
 // Caller must lock m_mutex.
 bool DB::grow_reader_mapping(uint_fast32_t index)
 {
@@ -2181,10 +2363,33 @@ DB::version_type DB::get_version_of_latest_snapshot()
 }
 
 
-void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction)
+void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, bool continue_writing,
+                          bool commit_to_disk)
 {
     SharedInfo* info = m_file_map.get_addr();
 
+    // A deferred commit leaves the file header bound to an earlier snapshot,
+    // and is made durable by a later flush. In Durability::Async mode, every
+    // commit is deferred, and flushed by the helper thread. The pages of an
+    // encrypted file only reach the file when the GroupWriter is destroyed, so
+    // commits to such files are never deferred.
+    Durability durability = Durability(info->durability);
+    bool deferred = !m_key && ((durability == Durability::Full && (m_group_commit || !commit_to_disk)) ||
+                               durability == Durability::Async);
+    bool async_flush = deferred && durability == Durability::Async;
+    if (async_flush)
+        get_commit_helper(); // Throws
+    if (deferred) {
+        // The file header is not updated by this commit, so the space used
+        // by the snapshot it is bound to must not be reused. The latest
+        // snapshot is durable unless its commit is still waiting for a flush,
+        // in which case the participant that made it holds a lock on an
+        // earlier, durable snapshot.
+        std::lock_guard<std::mutex> lock(m_flush_mutex);
+        if (m_durable_read_lock.m_version == std::numeric_limits<version_type>::max())
+            grab_read_lock(m_durable_read_lock, VersionID()); // Throws
+    }
+
     // Version of oldest snapshot currently (or recently) bound in a transaction
     // of the current session.
     uint_fast64_t oldest_version;
@@ -2220,6 +2425,14 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction)
     // info->readers.dump();
     GroupWriter out(transaction, Durability(info->durability)); // Throws
     out.set_versions(new_version, oldest_version);
+    if (size_t bytes_per_commit = m_online_compaction_request.exchange(0)) {
+        m_evacuation = std::make_unique<_impl::EvacuationState>();
+        m_evacuation->bytes_per_commit = bytes_per_commit;
+    }
+    // Relocated arrays would leave the accessors of a transaction which
+    // continues writing out of sync with the history.
+    if (m_evacuation && !continue_writing)
+        out.set_evacuation(m_evacuation.get());
     ref_type new_top_ref;
     // Recursively write all changed arrays to end of file
     {
@@ -2227,27 +2440,40 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction)
         std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
         new_top_ref = out.write_group();                         // Throws
     }
+    transaction.m_arrays_relocated = out.relocated_arrays();
     {
         // protect access to shared variables and m_reader_mapping from here
         std::lock_guard<std::recursive_mutex> lock_guard(m_mutex);
-        m_free_space = out.get_free_space_size();
-        m_locked_space = out.get_locked_space_size();
-        m_used_space = out.get_file_size() - m_free_space;
         // std::cout << "Writing version " << new_version << ", Topptr " << new_top_ref
         //     << " Read lock at version " << oldest_version << std::endl;
         switch (Durability(info->durability)) {
             case Durability::Full:
+            case Durability::Async:
+                if (deferred) {
+                    // The commit is made durable by flush_latest_version()
+                    break;
+                }
+                out.commit(new_top_ref); // Throws
+                break;
             case Durability::Unsafe:
                 out.commit(new_top_ref); // Throws
                 break;
             case Durability::MemOnly:
-            case Durability::Async:
                 // In Durability::MemOnly mode, we just use the file as backing for
                 // the shared memory. So we never actually flush the data to disk
                 // (the OS may do so opportinisticly, or when swapping). So in this
                 // mode the file on disk may very likely be in an invalid state.
                 break;
         }
+        if (!deferred)
+            truncate_unused_tail(out.get_logical_file_size());
+        m_free_space = out.get_free_space_size();
+        m_locked_space = out.get_locked_space_size();
+        m_used_space = out.get_file_size() - m_free_space;
+        if (m_evacuation && m_evacuation->done) {
+            m_evacuation.reset();
+            m_online_compaction_active = false;
+        }
         size_t new_file_size = out.get_file_size();
         // We must reset the allocators free space tracking before communicating the new
         // version through the ring buffer. If not, a reader may start updating the allocators
@@ -2290,9 +2516,191 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction)
         std::lock_guard<InterprocessMutex> lock(m_controlmutex);
         info->number_of_versions = new_version - oldest_version + 1;
         info->latest_version_number = new_version;
+        if (!deferred && durability != Durability::MemOnly)
+            info->durable_version = new_version;
 
         m_new_commit_available.notify_all();
     }
+    if (!deferred && durability != Durability::MemOnly) {
+        // The file header is now bound to the new snapshot, which makes the
+        // earlier deferred commits durable too, so the snapshot protected
+        // for them may be reclaimed.
+        ReadLockInfo durable_read_lock;
+        {
+            std::lock_guard<std::mutex> lock(m_flush_mutex);
+            std::swap(durable_read_lock, m_durable_read_lock);
+            if (new_version > m_durable_version)
+                m_durable_version = new_version;
+            m_flush_cv.notify_all();
+        }
+        if (durable_read_lock.m_version != std::numeric_limits<version_type>::max())
+            release_read_lock(durable_read_lock);
+    }
+    if (async_flush) {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        if (m_commit_helper)
+            m_commit_helper->schedule_flush();
+    }
+}
+
+DB::AsyncCommitHelper& DB::get_commit_helper()
+{
+    std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
+    if (!is_attached())
+        throw LogicError(LogicError::wrong_transact_state);
+    if (!m_commit_helper)
+        m_commit_helper = std::make_unique<AsyncCommitHelper>(*this); // Throws
+    return *m_commit_helper;
+}
+
+bool DB::take_async_write_lock(Transaction* tr)
+{
+    AsyncCommitHelper* helper;
+    {
+        std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
+        helper = m_commit_helper.get();
+    }
+    return helper && helper->take_write_lock(tr);
+}
+
+void DB::cancel_async_write_lock_request(Transaction* tr) noexcept
+{
+    AsyncCommitHelper* helper;
+    {
+        std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
+        helper = m_commit_helper.get();
+    }
+    if (helper)
+        helper->cancel_write_lock_request(tr);
+}
+
+void DB::stop_commit_helper() noexcept
+{
+    std::unique_ptr<AsyncCommitHelper> helper;
+    {
+        std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
+        helper = std::move(m_commit_helper);
+    }
+    // Completes the pending flushes
+    helper.reset();
+}
+
+void DB::async_begin_write(AsyncWriteCallback when_acquired)
+{
+    REALM_ASSERT(when_acquired);
+    TransactionRef tr = start_read(); // Throws
+    Transaction* tr_ptr = tr.get();
+    get_commit_helper().request_write_lock(tr_ptr, [tr = std::move(tr), when_acquired]() mutable {
+        try {
+            tr->promote_to_write(); // Throws
+        }
+        catch (...) {
+            tr.reset();
+            when_acquired(nullptr, std::current_exception());
+            return;
+        }
+        when_acquired(std::move(tr), nullptr);
+    }); // Throws
+}
+
+void DB::async_sync_to_disk(AsyncSyncCallback when_durable)
+{
+    get_commit_helper().request_sync(std::move(when_durable)); // Throws
+}
+
+DB::version_type DB::sync_latest_version_to_disk()
+{
+    SharedInfo* info = m_file_map.get_addr();
+    if (m_group_commit || (Durability(info->durability) == Durability::Async && !m_key)) {
+        version_type version = get_version_of_latest_snapshot();
+        wait_until_durable(version, false); // Throws
+        return version;
+    }
+    // Other commits write the file header while holding the write lock, so
+    // we must do the same.
+    do_begin_write(); // Throws
+    auto guard = util::make_scope_exit([&]() noexcept {
+        do_end_write();
+    });
+    return flush_latest_version(); // Throws
+}
+
+void DB::wait_until_durable(version_type version, bool may_delay)
+{
+    std::unique_lock<std::mutex> lock(m_flush_mutex);
+    while (m_durable_version < version) {
+        if (m_flush_in_progress) {
+            // The flush in progress may or may not cover our version
+            m_flush_cv.wait(lock);
+            continue;
+        }
+        // Become the leader of the next flush. Give the threads which are
+        // waiting for, or holding, the write lock a chance to commit first,
+        // so that their commits are covered by the same flush.
+        m_flush_in_progress = true;
+        if (may_delay && m_num_writers > 0) {
+            m_flush_cv.wait_for(lock, m_group_commit_max_delay, [&] {
+                return m_num_writers == 0;
+            });
+        }
+        lock.unlock();
+        version_type durable_version;
+        try {
+            durable_version = flush_latest_version(); // Throws
+        }
+        catch (...) {
+            lock.lock();
+            m_flush_in_progress = false;
+            m_flush_cv.notify_all();
+            throw;
+        }
+        lock.lock();
+        m_flush_in_progress = false;
+        if (durable_version > m_durable_version)
+            m_durable_version = durable_version;
+        m_flush_cv.notify_all();
+    }
+}
+
+DB::version_type DB::flush_latest_version()
+{
+    ReadLockInfo read_lock;
+    grab_read_lock(read_lock, VersionID()); // Throws
+    ReadLockGuard rlg(*this, read_lock);
+
+    // All snapshots up to and including the latest one have been written to
+    // the file, so a single flush makes them all durable.
+    if (!get_disable_sync_to_disk())
+        m_alloc.get_file().sync(); // Throws
+
+    {
+        std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
+        SharedInfo* info = m_file_map.get_addr();
+        if (read_lock.m_version > info->durable_version) {
+            GroupWriter::write_top_ref(m_alloc, read_lock.m_top_ref, info->file_format_version); // Throws
+            info->durable_version = read_lock.m_version;
+        }
+    }
+
+    // Move our protection to the new durable snapshot
+    version_type version = read_lock.m_version;
+    rlg.release();
+    {
+        std::lock_guard<std::mutex> lock(m_flush_mutex);
+        std::swap(read_lock, m_durable_read_lock);
+    }
+    if (read_lock.m_version != std::numeric_limits<version_type>::max())
+        release_read_lock(read_lock);
+    return version;
+}
+
+void DB::release_durable_read_lock() noexcept
+{
+    std::lock_guard<std::mutex> lock(m_flush_mutex);
+    if (m_durable_read_lock.m_version != std::numeric_limits<version_type>::max()) {
+        release_read_lock(m_durable_read_lock);
+        m_durable_read_lock = ReadLockInfo();
+    }
 }
 
 #ifdef REALM_DEBUG
@@ -2399,6 +2807,7 @@ void Transaction::end_read()
 
 void Transaction::do_end_read() noexcept
 {
+    db->cancel_async_write_lock_request(this);
     detach();
     db->release_read_lock(m_read_lock);
     m_alloc.note_reader_end(this);
@@ -2504,9 +2913,13 @@ DB::version_type Transaction::commit()
 
     db->do_end_write();
 
+    DBRef db_ref = db; // Reset by do_end_read()
     do_end_read();
     m_read_lock = lock_after_commit;
 
+    if (db_ref->m_group_commit)
+        db_ref->wait_until_durable(new_version, true); // Throws
+
     return new_version;
 }
 
@@ -2522,7 +2935,8 @@ void Transaction::commit_and_continue_writing()
     // before committing, allow any accessors at group level or below to sync
     flush_accessors_for_commit();
 
-    db->do_commit(*this); // Throws
+    bool continue_writing = true;
+    DB::version_type version = db->do_commit(*this, continue_writing); // Throws
 
     // We need to set m_read_lock in order for wait_for_change to work.
     // To set it, we grab a readlock on the latest available snapshot
@@ -2535,6 +2949,10 @@ void Transaction::commit_and_continue_writing()
 
     bool writable = true;
     remap_and_update_refs(m_read_lock.m_top_ref, m_read_lock.m_file_size, writable); // Throws
+
+    // We still hold the write lock, so no other commit can join the flush
+    if (db->m_group_commit)
+        db->wait_until_durable(version, false); // Throws
 }
 
 void Transaction::initialize_replication()
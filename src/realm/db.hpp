@@ -19,9 +19,15 @@
 #ifndef REALM_GROUP_SHARED_HPP
 #define REALM_GROUP_SHARED_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <cstdint>
+#include <exception>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <realm/util/features.h>
 #include <realm/util/thread.hpp>
 #include <realm/util/interprocess_condvar.hpp>
@@ -38,6 +44,7 @@ namespace realm {
 
 namespace _impl {
 class WriteLogCollector;
+struct EvacuationState;
 }
 
 class Transaction;
@@ -226,6 +233,26 @@ public:
     // an invalid TransactionRef is returned.
     TransactionRef start_write(bool nonblocking = false);
 
+    /// Asynchronous write transactions:
+    ///
+    /// async_begin_write() returns immediately. The write lock is acquired by
+    /// a helper thread owned by this DB, which then calls `when_acquired` with
+    /// a transaction in the writing stage. If the write transaction could not
+    /// be started, the transaction is null and the exception is passed
+    /// instead. The callback is invoked on the helper thread, and would
+    /// normally hand the transaction over to the thread that is going to use
+    /// it. It must not block, as the helper thread also performs the flushes
+    /// requested through async_sync_to_disk().
+    ///
+    /// async_sync_to_disk() returns immediately, and makes every version
+    /// committed so far durable on the helper thread. `when_durable` is then
+    /// called on the helper thread, with the exception that occurred, if any.
+    /// See also Transaction::async_commit().
+    using AsyncWriteCallback = std::function<void(TransactionRef, std::exception_ptr)>;
+    using AsyncSyncCallback = std::function<void(std::exception_ptr)>;
+    void async_begin_write(AsyncWriteCallback when_acquired);
+    void async_sync_to_disk(AsyncSyncCallback when_durable);
+
 
     // report statistics of last commit done on THIS DB.
     // The free space reported is what can be expected to be freed
@@ -251,6 +278,18 @@ public:
     /// a read transaction will not immediately release any versions.
     uint_fast64_t get_number_of_versions();
 
+    /// Report the number of versions which have been committed, but not yet
+    /// made durable, and would be lost if the system crashed. Such versions
+    /// are only left behind by commits in Durability::Async mode, with group
+    /// commit, or through Transaction::async_commit(). Always zero in
+    /// Durability::MemOnly mode.
+    uint_fast64_t get_number_of_unflushed_versions();
+
+    /// Make all versions committed so far durable, and wait for it to
+    /// complete. Must not be called by a thread which has a write transaction
+    /// in progress on this DB.
+    void flush();
+
     /// Get the size of the currently allocated slab area
     size_t get_allocated_size() const;
 
@@ -286,6 +325,39 @@ public:
     /// WARNING: Compact() is not thread-safe with respect to a concurrent close()
     bool compact(bool bump_version_number = false, util::Optional<const char*> output_encryption_key = util::none);
 
+    /// Compact the database file without taking it offline.
+    ///
+    /// Unlike compact(), this does not rewrite the file. Instead, live arrays
+    /// are moved away from the end of the file as part of the write
+    /// transactions committed through this DB afterwards, roughly
+    /// `bytes_per_commit` bytes per commit, and free space at the end of the
+    /// file is cut off from the logical file size as soon as no live version
+    /// uses it. The file itself is truncated by the first commit after no
+    /// snapshot that may still be bound in any session extends into that
+    /// space, so a reader that holds on to an old snapshot delays it. On
+    /// Windows, where a mapped file cannot be truncated, this only happens
+    /// when the last session closes. Readers and
+    /// other writers are never blocked beyond the commit that they would wait
+    /// for anyway. Since progress is only made when transactions are
+    /// committed, an application with no other writes can drive the
+    /// compaction by committing empty write transactions until
+    /// online_compaction_in_progress() returns false.
+    ///
+    /// Commits made by Transaction::commit_and_continue_writing() do not take
+    /// part in the compaction.
+    ///
+    /// Returns false if the file cannot be compacted this way, which is the
+    /// case for encrypted files and for files not using full (or unsafe)
+    /// durability.
+    bool start_online_compaction(size_t bytes_per_commit = 1024 * 1024);
+
+    /// Returns true from a call to start_online_compaction() until the file
+    /// has been compacted (or no further progress could be made).
+    bool online_compaction_in_progress() const noexcept
+    {
+        return m_online_compaction_active;
+    }
+
 #ifdef REALM_DEBUG
     void test_ringbuf();
 #endif
@@ -401,19 +473,36 @@ private:
     const char* m_key;
     int m_file_format_version = 0;
     util::InterprocessMutex m_writemutex;
-#ifdef REALM_ASYNC_DAEMON
-    util::InterprocessMutex m_balancemutex;
-#endif
     util::InterprocessMutex m_controlmutex;
-#ifdef REALM_ASYNC_DAEMON
-    util::InterprocessCondVar m_room_to_write;
-    util::InterprocessCondVar m_work_to_do;
-    util::InterprocessCondVar m_daemon_becomes_ready;
-#endif
     util::InterprocessCondVar m_new_commit_available;
     util::InterprocessCondVar m_pick_next_writer;
     std::function<void(int, int)> m_upgrade_callback;
 
+    // Online compaction is requested from any thread, but carried out by the
+    // thread that commits. The state is only accessed under the write lock.
+    std::atomic<size_t> m_online_compaction_request{0};
+    std::atomic<bool> m_online_compaction_active{false};
+    std::unique_ptr<_impl::EvacuationState> m_evacuation;
+
+    // Group commit. The members below are guarded by m_flush_mutex.
+    bool m_group_commit = false;
+    std::chrono::microseconds m_group_commit_max_delay;
+    std::mutex m_flush_mutex;
+    std::condition_variable m_flush_cv;
+    int m_num_writers = 0; // Threads waiting for or holding the write lock
+    bool m_flush_in_progress = false;
+    uint_fast64_t m_durable_version = 0;
+    // Keeps the space used by the version bound by the file header from
+    // being reused until a later version has been made durable.
+    ReadLockInfo m_durable_read_lock;
+
+    // Acquires the write lock and flushes on behalf of asynchronous write
+    // transactions. In Durability::Async mode it also flushes the commits
+    // periodically. Created on demand, guarded by m_mutex.
+    class AsyncCommitHelper;
+    std::chrono::milliseconds m_async_flush_interval;
+    std::unique_ptr<AsyncCommitHelper> m_commit_helper;
+
     std::shared_ptr<metrics::Metrics> m_metrics;
     /// Attach this DB instance to the specified database file.
     ///
@@ -453,7 +542,7 @@ private:
     void open(Replication&, const DBOptions options = DBOptions());
 
 
-    void do_open(const std::string& file, bool no_create, bool is_backend, const DBOptions options);
+    void do_open(const std::string& file, bool no_create, const DBOptions options);
 
     Replication* const* get_repl() const noexcept
     {
@@ -493,17 +582,44 @@ private:
     /// return true if write transaction can commence, false otherwise.
     bool do_try_begin_write();
     void do_begin_write();
-    version_type do_commit(Transaction&);
+    version_type do_commit(Transaction&, bool continue_writing = false, bool commit_to_disk = true);
     void do_end_write() noexcept;
 
+    // Group commit: wait until the specified version has been made durable,
+    // possibly by flushing the file on behalf of other waiting threads.
+    // `may_delay` must be false if the caller holds the write lock.
+    void wait_until_durable(version_type, bool may_delay);
+    version_type flush_latest_version();
+    void release_durable_read_lock() noexcept;
+    // The logical size of the file in the latest snapshot, if the file may be
+    // truncated to it when the session ends, otherwise zero. Must be called
+    // with the control mutex locked.
+    size_t get_truncatable_file_size() noexcept;
+    // Truncate the file to the largest logical file size of the snapshots
+    // which may still be bound, if that is below the physical size. Called by
+    // a commit which has bound the file header to a snapshot with the
+    // specified logical file size.
+    void truncate_unused_tail(size_t logical_file_size) noexcept;
+
+    // Make all versions committed so far durable. Must not be called while
+    // holding the write lock.
+    version_type sync_latest_version_to_disk();
+
+    AsyncCommitHelper& get_commit_helper();
+    // Returns true if the write lock has been acquired for the specified
+    // transaction by the helper thread (possibly after waiting for it), in
+    // which case it must not be acquired again.
+    bool take_async_write_lock(Transaction*);
+    void cancel_async_write_lock_request(Transaction*) noexcept;
+    void stop_commit_helper() noexcept;
+
     // make sure the given index is within the currently mapped area.
     // if not, expand the mapped area. Returns true if the area is expanded.
     bool grow_reader_mapping(uint_fast32_t index);
 
     // Must be called only by someone that has a lock on the write mutex.
-    void low_level_commit(uint_fast64_t new_version, Transaction& transaction);
-
-    void do_async_commits();
+    void low_level_commit(uint_fast64_t new_version, Transaction& transaction, bool continue_writing,
+                          bool commit_to_disk);
 
     /// Upgrade file format and/or history schema
     void upgrade_file_format(bool allow_file_format_upgrade, int target_file_format_version,
@@ -564,7 +680,26 @@ public:
     void end_read();
 
     // Live transactions state changes, often taking an observer functor:
-    DB::version_type commit_and_continue_as_read();
+    //
+    // If `commit_to_disk` is false, the changes are not flushed to stable
+    // storage (in Durability::Full mode) by the commit. They become durable
+    // with a later call to DB::async_sync_to_disk(), or with the next commit
+    // which is flushed.
+    DB::version_type commit_and_continue_as_read(bool commit_to_disk = true);
+
+    /// Commit without waiting for the changes to reach stable storage, and
+    /// continue as a read transaction. `when_durable` is called on the helper
+    /// thread of the DB once they have (see DB::async_sync_to_disk()).
+    DB::version_type async_commit(DB::AsyncSyncCallback when_durable);
+
+    /// Request the write lock for this transaction without blocking. The lock
+    /// is acquired by the helper thread of the DB, which then calls
+    /// `when_acquired`. A subsequent call to promote_to_write() will not
+    /// block, but use the lock acquired on behalf of this transaction. If
+    /// promote_to_write() is called before that, it waits for the request to
+    /// complete. The request is cancelled if the transaction is ended.
+    void async_request_write_lock(std::function<void()> when_acquired);
+
     template <class O>
     void rollback_and_continue_as_read(O* observer);
     void rollback_and_continue_as_read()
@@ -638,6 +773,9 @@ private:
 
     DB::ReadLockInfo m_read_lock;
     DB::TransactStage m_transact_stage = DB::transact_Ready;
+    // Set by a commit in which online compaction moved arrays that accessors
+    // of this transaction may refer to
+    bool m_arrays_relocated = false;
 
     friend class DB;
     friend class DisableReplication;
@@ -856,7 +994,10 @@ inline bool Transaction::promote_to_write(O* observer, bool nonblocking)
     if (m_transact_stage != DB::transact_Reading)
         throw LogicError(LogicError::wrong_transact_state);
 
-    if (nonblocking) {
+    if (db->take_async_write_lock(this)) {
+        // Already acquired by async_request_write_lock()
+    }
+    else if (nonblocking) {
         bool succes = db->do_try_begin_write();
         if (!succes) {
             return false;
@@ -19,6 +19,7 @@
 #ifndef REALM_GROUP_SHARED_OPTIONS_HPP
 #define REALM_GROUP_SHARED_OPTIONS_HPP
 
+#include <chrono>
 #include <functional>
 #include <string>
 
@@ -31,7 +32,7 @@ struct DBOptions {
     enum class Durability : uint16_t {
         Full,
         MemOnly,
-        Async, ///< Not yet supported on windows.
+        Async, ///< Commits are flushed in the background, see async_flush_interval.
         Unsafe // If you use this, you loose ACID property
     };
 
@@ -101,6 +102,44 @@ struct DBOptions {
     /// is exceeded without being consumed, only the most recent entries will be stored.
     size_t metrics_buffer_size;
 
+    /// If \a enable_group_commit is set to `true`, a commit does not flush
+    /// the file by itself. The write lock is released as soon as the changes
+    /// have been written, and the committing thread then waits until its
+    /// version has been made durable. A single flush covers the versions
+    /// committed by all threads that are waiting at that point, and it is
+    /// postponed by up to \a group_commit_max_delay while other threads of
+    /// the same DB are still in (or waiting for) a write transaction, so that
+    /// they can join it. Changes become visible to readers before they are
+    /// durable.
+    ///
+    /// Group commit only has an effect for unencrypted files with
+    /// Durability::Full, and must be used consistently by all participants of
+    /// a session.
+    bool enable_group_commit = false;
+    std::chrono::microseconds group_commit_max_delay = std::chrono::milliseconds(2);
+
+    /// With Durability::Async, a commit returns as soon as the changes have
+    /// been written to the file, without flushing it. A background thread
+    /// owned by the DB flushes the file no later than \a async_flush_interval
+    /// after a commit, so a crash loses at most the versions committed within
+    /// that interval. DB::flush() makes all versions committed so far durable
+    /// immediately, and DB::get_number_of_unflushed_versions() reports how
+    /// many are outstanding. Commits to encrypted files are still flushed
+    /// before they return.
+    std::chrono::milliseconds async_flush_interval = std::chrono::milliseconds(100);
+
+    /// Realm files of file format 20 are only upgraded to file format 21 if
+    /// \a upgrade_to_file_format_21 is set to `true` (and \a
+    /// allow_file_format_upgrade allows it). Otherwise they keep format 20,
+    /// and remain readable by releases which only know that format, but their
+    /// integer leaves are not encoded, and ordered, full-text, case
+    /// insensitive, collection and composite indexes cannot be added to them
+    /// (LogicError::file_format_upgrade_required). New files, and files of
+    /// older formats, which need an upgrade anyway, always use format 21. All
+    /// participants of a session must agree on the setting, or opening the
+    /// file throws IncompatibleLockFile.
+    bool upgrade_to_file_format_21 = false;
+
     /// sys_tmp_dir will be used if the temp_dir is empty when creating DBOptions.
     /// It must be writable and allowed to create pipe/fifo file on it.
     /// set_sys_tmp_dir is not a thread-safe call and it is only supposed to be called once
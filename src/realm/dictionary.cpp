@@ -20,6 +20,7 @@
 #include <realm/dictionary_cluster_tree.hpp>
 #include <realm/array_mixed.hpp>
 #include <realm/group.hpp>
+#include <realm/index_collection.hpp>
 #include <realm/replication.hpp>
 #include <algorithm>
 
@@ -304,7 +305,10 @@ std::pair<Dictionary::Iterator, bool> Dictionary::insert(Mixed key, Mixed value)
     update_if_needed();
 
     ObjLink new_link;
-    if (value.get_type() == type_TypedLink) {
+    if (value.is_null()) {
+        // Nothing to validate
+    }
+    else if (value.get_type() == type_TypedLink) {
         new_link = value.get<ObjLink>();
         m_obj.get_table()->get_parent_group()->validate(new_link);
     }
@@ -330,6 +334,8 @@ std::pair<Dictionary::Iterator, bool> Dictionary::insert(Mixed key, Mixed value)
     bump_content_version();
     try {
         ClusterNode::State state = m_clusters->insert(k, key, value);
+        if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+            index->insert(m_obj.get_key(), value);
 
         if (new_link) {
             CascadeState cascade_state;
@@ -356,6 +362,10 @@ std::pair<Dictionary::Iterator, bool> Dictionary::insert(Mixed key, Mixed value)
             m_obj.replace_backlink(m_col_key, old_link, new_link, cascade_state);
         }
 
+        if (CollectionIndex* index = m_obj.get_collection_index(m_col_key)) {
+            index->erase(m_obj.get_key(), old_value);
+            index->insert(m_obj.get_key(), value);
+        }
         values.set(state.index, value);
         return {Iterator(this, state.index), false};
     }
@@ -374,6 +384,8 @@ const Mixed Dictionary::operator[](Mixed key)
         ObjKey k(int64_t(hash & 0x7FFFFFFFFFFFFFFF));
         bump_content_version();
         m_clusters->insert(k, key, Mixed{});
+        if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+            index->insert(m_obj.get_key(), Mixed{});
     }
 
     return ret;
@@ -404,6 +416,8 @@ void Dictionary::erase(Mixed key)
         if (Replication* repl = this->m_obj.get_replication()) {
             repl->dictionary_erase(*this, key);
         }
+        if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+            index->erase(m_obj.get_key(), get(key));
         m_clusters->erase(k, state);
         bump_content_version();
     }
@@ -426,6 +440,9 @@ void Dictionary::nullify(Mixed key)
     ref_type ref = to_ref(Array::get(state.mem.get_addr(), 2));
     values.init_from_ref(ref);
     values.set(state.index, Mixed());
+    // The link was not indexed
+    if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+        index->insert(m_obj.get_key(), Mixed());
 }
 
 void Dictionary::clear()
@@ -437,6 +454,8 @@ void Dictionary::clear()
                 repl->dictionary_erase(*this, elem.first);
             }
         }
+        if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+            index->erase(m_obj.get_key());
         // Just destroy the whole cluster
         m_clusters->destroy();
         delete m_clusters;
@@ -92,6 +92,9 @@ const char* LogicError::message() const noexcept
         case mixed_durability:
             return "Durability setting (as passed to the DB constructor) was "
                    "not consistent across the session";
+        case mixed_group_commit:
+            return "Group commit setting (DBOptions::enable_group_commit, as passed to the DB constructor) was "
+                   "not consistent across the session";
         case mixed_history_type:
             return "History type (as specified by the Replication implementation passed to "
                    "the DB constructor) was not consistent across the session";
@@ -106,6 +109,8 @@ const char* LogicError::message() const noexcept
             return "Search index on a subtable of a subtable is not yet supported";
         case collection_type_mismatch:
             return "Instantiating a collection object not matching column type";
+        case file_format_upgrade_required:
+            return "The Realm file must be upgraded to file format 21 for this kind of index";
     }
     return "Unknown error";
 }
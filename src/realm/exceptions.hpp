@@ -297,6 +297,10 @@ public:
         /// not consistent across the session.
         mixed_durability,
 
+        /// Group commit setting (DBOptions::enable_group_commit, as passed to
+        /// the DB constructor) was not consistent across the session.
+        mixed_group_commit,
+
         /// History type (as specified by the Replication implementation passed
         /// to the DB constructor) was not consistent across the
         /// session.
@@ -317,7 +321,11 @@ public:
         subtable_of_subtable_index,
 
         /// You try to instantiate a collection object not matching column type
-        collection_type_mismatch
+        collection_type_mismatch,
+
+        /// The Realm file must be upgraded to file format 21 for this (see
+        /// DBOptions::upgrade_to_file_format_21).
+        file_format_upgrade_required
     };
 
     LogicError(ErrorKind message);
@@ -131,14 +131,17 @@ public:
     {
         return (1 << (unsigned(m_header[4]) & 0x07)) >> 1;
     }
+    unsigned width_type() const
+    {
+        return (unsigned(m_header[4]) & 0x18) >> 3;
+    }
     unsigned size() const
     {
         return unsigned(m_size);
     }
     unsigned length() const
     {
-        unsigned width_type = (unsigned(m_header[4]) & 0x18) >> 3;
-        return calc_byte_size(width_type, m_size, width());
+        return calc_byte_size(width_type(), m_size, width());
     }
     uint64_t ref() const
     {
@@ -171,6 +174,12 @@ protected:
             case 2:
                 num_bytes = size;
                 break;
+            case 3: {
+                // Frame-of-reference encoded integers, followed by the step and the base
+                unsigned num_bits = size * width;
+                num_bytes = ((num_bits + 7) >> 3) + 2 * sizeof(int64_t);
+                break;
+            }
         }
 
         // Ensure 8-byte alignment
@@ -194,6 +203,8 @@ public:
     }
     int64_t get_val(size_t ndx) const
     {
+        if (width_type() == realm::NodeHeader::wtype_FrameOfReference)
+            return realm::Array::get(m_header, ndx);
         int64_t val = realm::get_direct(m_data, width(), ndx);
 
         if (m_has_refs) {
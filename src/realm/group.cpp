@@ -316,12 +316,13 @@ int Group::get_target_file_format_version_for_session(int current_file_format_ve
     // Please see Group::get_file_format_version() for information about the
     // individual file format versions.
 
-    if (requested_history_type == Replication::hist_None && current_file_format_version == 11) {
-        // We are able to open file format 11 in RO mode
-        return 11;
+    if (requested_history_type == Replication::hist_None &&
+        (current_file_format_version == 11 || current_file_format_version == 20)) {
+        // We are able to open file format 11 and 20 in RO mode
+        return current_file_format_version;
     }
 
-    return 20;
+    return 21;
 }
 
 void Group::get_version_and_history_info(const Array& top, _impl::History::version_type& version, int& history_type,
@@ -379,7 +380,7 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // Be sure to revisit the following upgrade logic when a new file format
     // version is introduced. The following assert attempt to help you not
     // forget it.
-    REALM_ASSERT_EX(target_file_format_version == 20, target_file_format_version);
+    REALM_ASSERT_EX(target_file_format_version == 21, target_file_format_version);
 
     int current_file_format_version = get_file_format_version();
     REALM_ASSERT(current_file_format_version < target_file_format_version);
@@ -387,7 +388,8 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // DB::do_open() must ensure this. Be sure to revisit the
     // following upgrade logic when DB::do_open() is changed (or
     // vice versa).
-    REALM_ASSERT_EX(current_file_format_version >= 5 && current_file_format_version <= 11,
+    REALM_ASSERT_EX((current_file_format_version >= 5 && current_file_format_version <= 11) ||
+                        current_file_format_version == 20,
                     current_file_format_version);
 
 
@@ -525,6 +527,9 @@ void Transaction::upgrade_file_format(int target_file_format_version)
         }
     }
 
+    // Nothing needs to be converted when going from 20 to 21. Integer leaves
+    // are written frame-of-reference encoded as they are modified.
+
     // NOTE: Additional future upgrade steps go here.
 }
 
@@ -547,6 +552,7 @@ void Group::open(ref_type top_ref, const std::string& file_path)
             break;
         case 11:
         case 20:
+        case 21:
             file_format_ok = true;
             break;
     }
@@ -1698,6 +1704,32 @@ void Group::flush_accessors_for_commit()
             acc->flush_for_commit();
 }
 
+ref_type Group::typed_write_tables(_impl::ArrayWriterBase& out)
+{
+    if (m_alloc.is_read_only(m_tables.get_ref()))
+        return m_tables.get_ref();
+
+    // Temp array for updated refs
+    Array written(Allocator::get_default());
+    written.create(Array::type_HasRefs, m_tables.get_context_flag()); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&written);
+
+    size_t sz = m_tables.size();
+    for (size_t j = 0; j < sz; ++j) {
+        RefOrTagged rot = m_tables.get_as_ref_or_tagged(j);
+        if (rot.is_ref() && rot.get_as_ref()) {
+            ref_type ref = rot.get_as_ref();
+            // An unmodified table is left as it is, without creating its accessor
+            if (!m_alloc.is_read_only(ref))
+                ref = do_get_table(j)->typed_write(ref, out); // Throws
+            rot = RefOrTagged::make_ref(ref);
+        }
+        written.add(rot); // Throws
+    }
+
+    return written.write(out, false, false); // Throws
+}
+
 void Group::refresh_dirty_accessors()
 {
     if (!m_tables.is_attached()) {
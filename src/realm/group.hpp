@@ -755,6 +755,10 @@ private:
     void advance_transact(ref_type new_top_ref, _impl::NoCopyInputStream&, bool writable);
     void refresh_dirty_accessors();
     void flush_accessors_for_commit();
+    /// Write the modified tables as `m_tables.write(out, true, true)` would,
+    /// but let the writer compress the integer leaves of their clusters. See
+    /// Table::typed_write().
+    ref_type typed_write_tables(_impl::ArrayWriterBase& out);
 
     /// \brief The version of the format of the node structure (in file or in
     /// memory) in use by Realm objects associated with this group.
@@ -825,6 +829,36 @@ private:
     ///
     ///  20 New data types: Decimal128 and ObjectId. Embedded tables.
     ///
+    ///  21 Integer column leaves may be frame-of-reference encoded
+    ///     (NodeHeader::wtype_FrameOfReference), optionally as offsets from a
+    ///     line with a fixed step (delta encoding). New kinds of search
+    ///     index, held in the same slot of the table's search index refs as
+    ///     a StringIndex, and told apart by new column attributes:
+    ///
+    ///     - col_attr_OrderedIndex (4, was col_attr_Reserved): RangeIndex,
+    ///       a top array of two B+trees, the values and the object keys
+    ///       (see SortedIndexEntries).
+    ///     - col_attr_FullTextIndex (2, was col_attr_Unique, which was never
+    ///       set): FullTextIndex, a top array of two B+trees, the case
+    ///       folded tokens and the object keys.
+    ///     - col_attr_Indexed on a list, set or dictionary column:
+    ///       CollectionIndex, a top array of three B+trees, the values, the
+    ///       object keys and the number of occurrences.
+    ///     - col_attr_CaseInsensitiveIndex (0x10000, above the dictionary
+    ///       key type in bits 8 - 15): a StringIndex of the case folded
+    ///       strings.
+    ///
+    ///     Composite indexes are held in a new slot of the table's top array
+    ///     (Table::top_position_for_composite_indexes), an array of the refs
+    ///     of their top arrays: the column keys, the object keys and one
+    ///     B+tree of values per column.
+    ///
+    ///     All of these are only written once a file is format 21, so format
+    ///     20 files are upgraded without any conversion, but only when
+    ///     requested with DBOptions::upgrade_to_file_format_21, as the
+    ///     upgraded file can no longer be opened by releases which only know
+    ///     format 20.
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in Group::open() and DB::do_open, the file
     /// format selection logic in
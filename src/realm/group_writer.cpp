@@ -268,6 +268,11 @@ size_t GroupWriter::get_file_size() const noexcept
     return sz;
 }
 
+size_t GroupWriter::get_logical_file_size() const noexcept
+{
+    return to_size_t(m_group.m_top.get(2) / 2);
+}
+
 void GroupWriter::sync_all_mappings()
 {
     if (m_durability == Durability::Unsafe)
@@ -320,6 +325,11 @@ ref_type GroupWriter::write_group()
     read_in_freelist();
     // Now, 'm_size_map' holds all free elements candidate for recycling
 
+    // Relocate live arrays before anything is written, so that the relocated
+    // arrays are written along with the rest of the changes.
+    if (m_evacuation && is_shared)
+        evacuate(); // Throws
+
     Array& top = m_group.m_top;
 #if REALM_ALLOC_DEBUG
     std::cout << "    In-file freelist after merge:  " << m_size_map.size() << std::endl;
@@ -334,7 +344,7 @@ ref_type GroupWriter::write_group()
     // version.
     bool deep = true, only_if_modified = true;
     ref_type names_ref = m_group.m_table_names.write(*this, deep, only_if_modified); // Throws
-    ref_type tables_ref = m_group.m_tables.write(*this, deep, only_if_modified);     // Throws
+    ref_type tables_ref = m_group.typed_write_tables(*this);                         // Throws
 
     int_fast64_t value_1 = from_ref(names_ref);
     int_fast64_t value_2 = from_ref(tables_ref);
@@ -571,6 +581,166 @@ void GroupWriter::read_in_freelist()
     free_in_file.move_free_in_file_to_size_map(m_size_map);
 }
 
+void GroupWriter::evacuate()
+{
+    _impl::EvacuationState& state = *m_evacuation;
+    if (state.done)
+        return;
+
+    bool tail_locked = false;
+    if (shrink_logical_file_size(tail_locked)) // Throws
+        state.progress_in_pass = true;
+    size_t logical_file_size = to_size_t(m_group.m_top.get(2) / 2);
+
+    if (state.cursor.empty()) {
+        // Start a new pass. The target size is the amount of live data plus
+        // some room for the arrays written by the commits during the pass.
+        size_t free_space = 0;
+        for (const auto& chunk : m_size_map)
+            free_space += chunk.first;
+        for (const auto& locked : m_not_free_in_file)
+            free_space += locked.size;
+        size_t used = logical_file_size - free_space;
+        size_t slack = std::max(used / 4, size_t(64 * 1024));
+        state.limit = to_ref(util::round_up_to_page_size(used + slack));
+        state.cursor.push_back(Group::s_table_name_ndx);
+    }
+    if (logical_file_size <= state.limit) {
+        state.done = true;
+        return;
+    }
+
+    m_alloc_limit = state.limit;
+    m_evacuation_budget = state.bytes_per_commit;
+
+    // The roots are the table names, the tables and the history
+    Array& top = m_group.m_top;
+    auto& cursor = state.cursor;
+    while (cursor[0] <= Group::s_hist_ref_ndx) {
+        size_t slot = cursor[0];
+        bool complete = true;
+        if (slot == Group::s_table_name_ndx) {
+            complete = evacuate_node(m_group.m_table_names, 1); // Throws
+        }
+        else if (slot == Group::s_table_refs_ndx) {
+            complete = evacuate_node(m_group.m_tables, 1); // Throws
+        }
+        else if (slot == Group::s_hist_ref_ndx && top.size() > slot && top.get_as_ref(slot) != 0) {
+            Array history(m_alloc);
+            history.set_parent(&top, slot);
+            history.init_from_parent();
+            complete = evacuate_node(history, 1); // Throws
+        }
+        if (!complete)
+            return; // Resume in next commit
+        cursor.resize(1);
+        ++cursor[0];
+    }
+    cursor.clear();
+
+    // The pass is complete. Give up if nothing can be moved and nothing is
+    // waiting for readers to release the end of the file.
+    if (state.progress_in_pass || tail_locked) {
+        state.idle_passes = 0;
+    }
+    else if (++state.idle_passes == 2) {
+        state.done = true;
+    }
+    state.progress_in_pass = false;
+}
+
+bool GroupWriter::shrink_logical_file_size(bool& tail_locked)
+{
+    Array& top = m_group.m_top;
+    size_t logical_file_size = to_size_t(top.get(2) / 2);
+    for (const auto& locked : m_not_free_in_file) {
+        if (locked.ref + locked.size == logical_file_size)
+            tail_locked = true;
+    }
+    auto it = std::find_if(m_size_map.begin(), m_size_map.end(), [&](const auto& chunk) {
+        return chunk.second + chunk.first == logical_file_size;
+    });
+    if (it == m_size_map.end())
+        return false;
+
+    // The file size must remain a multiple of the page size
+    size_t chunk_pos = it->second;
+    size_t new_file_size = util::round_up_to_page_size(chunk_pos);
+    if (new_file_size >= logical_file_size)
+        return false;
+    m_size_map.erase(it);
+    if (new_file_size > chunk_pos)
+        m_size_map.emplace(new_file_size - chunk_pos, chunk_pos);
+
+    top.set(2, 1 + 2 * uint64_t(new_file_size)); // Throws
+#if REALM_ALLOC_DEBUG
+    std::cout << "        ** File shrunk from " << logical_file_size << " to " << new_file_size << std::endl;
+#endif
+    return true;
+}
+
+bool GroupWriter::evacuate_node(Array& node, size_t depth)
+{
+    ref_type ref = node.get_ref();
+    if (ref >= m_evacuation->limit && m_alloc.is_read_only(ref)) {
+        // The copy will be written below the limit by write_group()
+        m_evacuation_budget -= std::min(m_evacuation_budget, node.get_byte_size());
+        node.copy_on_write(); // Throws
+        m_evacuation->progress_in_pass = true;
+        m_relocated_arrays = true;
+    }
+    if (!node.has_refs())
+        return true;
+    return evacuate_children(node, depth); // Throws
+}
+
+bool GroupWriter::evacuate_children(Array& parent, size_t depth)
+{
+    // Visiting a node without moving it is charged as well, so that a pass
+    // over a large file is spread over several commits.
+    constexpr size_t visit_cost = 64;
+    auto& cursor = m_evacuation->cursor;
+    if (cursor.size() == depth)
+        cursor.push_back(0);
+    while (cursor[depth] < parent.size()) {
+        size_t ndx = cursor[depth];
+        int64_t value = parent.get(ndx);
+        if (value != 0 && (value & 1) == 0) {
+            if (m_evacuation_budget < visit_cost)
+                return false;
+            m_evacuation_budget -= visit_cost;
+            ref_type ref = to_ref(value);
+            const char* header = m_alloc.translate(ref);
+            if (ref >= m_evacuation->limit && m_alloc.is_read_only(ref)) {
+                // The child may be any kind of node, so it is copied the way
+                // copy_on_write() would do it, but without an accessor.
+                size_t byte_size = NodeHeader::get_byte_size_from_header(header);
+                MemRef mem = m_alloc.alloc(byte_size); // Throws
+                realm::safe_copy_n(header, byte_size, mem.get_addr());
+                NodeHeader::set_capacity_in_header(byte_size, mem.get_addr());
+                parent.set_as_ref(ndx, mem.get_ref()); // Throws
+                m_alloc.free_(ref, header);
+                ref = mem.get_ref();
+                header = mem.get_addr();
+                m_evacuation_budget -= std::min(m_evacuation_budget, byte_size);
+                m_evacuation->progress_in_pass = true;
+                m_relocated_arrays = true;
+            }
+            if (NodeHeader::get_hasrefs_from_header(header)) {
+                Array child(m_alloc);
+                child.set_parent(&parent, ndx);
+                child.init_from_ref(ref);
+                if (!evacuate_children(child, depth + 1)) // Throws
+                    return false;
+            }
+        }
+        cursor.resize(depth + 1);
+        ++cursor[depth];
+    }
+    cursor.resize(depth);
+    return true;
+}
+
 size_t GroupWriter::recreate_freelist(size_t reserve_pos)
 {
     std::vector<FreeSpaceEntry> free_in_file;
@@ -733,6 +903,10 @@ GroupWriter::FreeListElement GroupWriter::search_free_space_in_free_list_element
     // search through the chunk, finding a place within it,
     // where an allocation will not cross a mmap boundary
     size_t start_pos = it->second;
+    if (start_pos >= m_alloc_limit) {
+        return m_size_map.end();
+    }
+    chunk_size = std::min(chunk_size, m_alloc_limit - start_pos);
     size_t alloc_pos = alloc.find_section_in_range(start_pos, chunk_size, size);
     if (alloc_pos == 0) {
         return m_size_map.end();
@@ -773,6 +947,15 @@ GroupWriter::FreeListElement GroupWriter::search_free_space_in_part_of_freelist(
 GroupWriter::FreeListElement GroupWriter::reserve_free_space(size_t size)
 {
     auto chunk = search_free_space_in_part_of_freelist(size);
+    if (chunk == m_size_map.end() && m_alloc_limit != std::numeric_limits<ref_type>::max()) {
+        // During online compaction, prefer space beyond the evacuation limit
+        // over extending the file.
+        ref_type limit = m_alloc_limit;
+        m_alloc_limit = std::numeric_limits<ref_type>::max();
+        chunk = reserve_free_space(size); // Throws
+        m_alloc_limit = limit;
+        return chunk;
+    }
     while (chunk == m_size_map.end()) {
         // No free space, so we have to extend the file.
         auto new_chunk = extend_free_space(size);
@@ -863,6 +1046,13 @@ bool inline is_aligned(char* addr)
     return (as_binary & 7) == 0;
 }
 
+bool GroupWriter::compress_integer_leaves() const noexcept
+{
+    // Frame-of-reference encoded leaves were introduced in file format 21
+    return m_group.get_file_format_version() >= 21;
+}
+
+
 ref_type GroupWriter::write_array(const char* data, size_t size, uint32_t checksum)
 {
     // Get position of free space to write in (expanding file if needed)
@@ -949,6 +1139,35 @@ void GroupWriter::commit(ref_type new_top_ref)
 }
 
 
+void GroupWriter::write_top_ref(SlabAlloc& alloc, ref_type top_ref, int file_format_version)
+{
+    using Header = SlabAlloc::Header;
+    File::Map<Header> map(alloc.get_file(), File::access_ReadWrite); // Throws
+    Header& file_header = *map.get_addr();
+    util::encryption_read_barrier(&file_header, sizeof file_header, map.get_encrypted_mapping());
+
+    // Same slot selection scheme as commit()
+    unsigned new_flags = file_header.m_flags ^ SlabAlloc::flags_SelectBit;
+    int slot_selector = ((new_flags & SlabAlloc::flags_SelectBit) != 0 ? 1 : 0);
+
+    using type_1 = std::remove_reference<decltype(file_header.m_file_format[0])>::type;
+    REALM_ASSERT(!util::int_cast_has_overflow<type_1>(file_format_version));
+    file_header.m_file_format[slot_selector] = type_1(file_format_version);
+    file_header.m_top_ref[slot_selector] = top_ref;
+    util::encryption_write_barrier(&file_header, sizeof file_header, map.get_encrypted_mapping());
+
+    bool disable_sync = get_disable_sync_to_disk();
+    if (!disable_sync)
+        map.sync(); // Throws
+
+    using type_2 = std::remove_reference<decltype(file_header.m_flags)>::type;
+    file_header.m_flags = type_2(new_flags);
+    util::encryption_write_barrier(&file_header.m_flags, sizeof file_header.m_flags, map.get_encrypted_mapping());
+    if (!disable_sync)
+        map.sync(); // Throws
+}
+
+
 #ifdef REALM_DEBUG
 
 void GroupWriter::dump()
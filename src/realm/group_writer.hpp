@@ -20,8 +20,10 @@
 #define REALM_GROUP_WRITER_HPP
 
 #include <cstdint> // unint8_t etc
+#include <limits>
 #include <utility>
 #include <map>
+#include <vector>
 
 #include <realm/util/file.hpp>
 #include <realm/alloc.hpp>
@@ -36,6 +38,32 @@ namespace realm {
 class Group;
 class SlabAlloc;
 
+namespace _impl {
+
+/// Progress of an online compaction (see DB::start_online_compaction()). It
+/// is owned by the DB and handed to the GroupWriter of each commit, so that
+/// the relocation of live arrays can be resumed where the previous commit
+/// left off.
+struct EvacuationState {
+    /// Approximate number of bytes to relocate per commit. Visiting an array
+    /// without moving it is charged a small fixed amount.
+    size_t bytes_per_commit = 1024 * 1024;
+    /// Arrays at or beyond this position are relocated. Zero until the first
+    /// pass has been started.
+    ref_type limit = 0;
+    /// Path of child indexes (starting with the slot in the top array) at
+    /// which the walk over the live arrays is to be resumed. Empty when a new
+    /// pass is to be started.
+    std::vector<size_t> cursor;
+    /// Number of complete passes in a row that neither relocated anything nor
+    /// shrank the file.
+    int idle_passes = 0;
+    bool progress_in_pass = false;
+    bool done = false;
+};
+
+} // namespace _impl
+
 
 /// This class is not supposed to be reused for multiple write sessions. In
 /// particular, do not reuse it in case any of the functions throw.
@@ -58,6 +86,12 @@ public:
 
     void set_versions(uint64_t current, uint64_t read_lock) noexcept;
 
+    /// Relocate live arrays away from the end of the file as part of this
+    /// commit, and give back free space at the end of the file. Must be called
+    /// before write_group(). The accessors of the group must be refreshed
+    /// from the new top ref after the commit (or be detached).
+    void set_evacuation(_impl::EvacuationState*) noexcept;
+
     /// Write all changed array nodes into free space.
     ///
     /// Returns the new top ref. When in full durability mode, call
@@ -69,9 +103,25 @@ public:
     /// returned by write_group().
     void commit(ref_type new_top_ref);
 
+    /// Bind the file header to a snapshot whose data has already been
+    /// flushed to stable storage, then flush the header. Used by group
+    /// commit, where several commits are made durable by a single flush.
+    static void write_top_ref(SlabAlloc&, ref_type top_ref, int file_format_version);
+
     size_t get_file_size() const noexcept;
 
+    /// The logical file size of the snapshot written by write_group()
+    size_t get_logical_file_size() const noexcept;
+
+    /// Whether online compaction moved any arrays in this commit. Accessors
+    /// referring to them must be refreshed if the transaction continues.
+    bool relocated_arrays() const noexcept
+    {
+        return m_relocated_arrays;
+    }
+
     ref_type write_array(const char*, size_t, uint32_t) override;
+    bool compress_integer_leaves() const noexcept override;
 
 #ifdef REALM_DEBUG
     void dump();
@@ -100,6 +150,10 @@ private:
     size_t m_free_space_size = 0;
     size_t m_locked_space_size = 0;
     Durability m_durability;
+    _impl::EvacuationState* m_evacuation = nullptr;
+    // Allocations are only made below this position if possible
+    ref_type m_alloc_limit = std::numeric_limits<ref_type>::max();
+    bool m_relocated_arrays = false;
 
     struct FreeSpaceEntry {
         FreeSpaceEntry(size_t r, size_t s, uint64_t v)
@@ -127,6 +181,17 @@ private:
 
     void read_in_freelist();
     size_t recreate_freelist(size_t reserve_pos);
+
+    // Online compaction: give back free space at the end of the file, then
+    // relocate live arrays beyond the evacuation limit
+    void evacuate();
+    // Returns true if the file was shrunk. Sets `tail_locked` if the last
+    // chunk of the file is free, but still used by a live version.
+    bool shrink_logical_file_size(bool& tail_locked);
+    // Return false when the budget of this commit is exhausted
+    bool evacuate_node(Array& node, size_t depth);
+    bool evacuate_children(Array& parent, size_t depth);
+    size_t m_evacuation_budget = 0;
     // Currently cached memory mappings. We keep as many as 16 1MB windows
     // open for writing. The allocator will favor sequential allocation
     // from a modest number of windows, depending upon fragmentation, so
@@ -196,6 +261,11 @@ inline void GroupWriter::set_versions(uint64_t current, uint64_t read_lock) noex
     m_readlock_version = read_lock;
 }
 
+inline void GroupWriter::set_evacuation(_impl::EvacuationState* state) noexcept
+{
+    m_evacuation = state;
+}
+
 } // namespace realm
 
 #endif // REALM_GROUP_WRITER_HPP
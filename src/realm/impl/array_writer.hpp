@@ -36,6 +36,14 @@ public:
     /// Returns the ref (position in the target stream) of the written copy of
     /// the specified array data.
     virtual ref_type write_array(const char* data, size_t size, uint32_t checksum) = 0;
+
+    /// Whether integer leaves written with `compress` set, see Array::write(),
+    /// may be written frame-of-reference encoded. The target must have a file
+    /// format that allows for such leaves.
+    virtual bool compress_integer_leaves() const noexcept
+    {
+        return false;
+    }
 };
 
 } // namespace impl_
@@ -0,0 +1,222 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include <realm/index_collection.hpp>
+#include <realm/collection.hpp>
+#include <realm/query_conditions.hpp>
+
+using namespace realm;
+
+namespace {
+
+// Values comparing equal, but of different types (like 1 and true in a
+// dictionary), have separate entries
+bool same_value(const Mixed& a, const Mixed& b)
+{
+    if (a.is_null() || b.is_null())
+        return a.is_null() && b.is_null();
+    return a.get_type() == b.get_type() && a.compare(b) == 0;
+}
+
+} // unnamed namespace
+
+CollectionIndex::CollectionIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_entries(alloc)
+    , m_counts(alloc)
+    , m_target_column(target_column)
+{
+    m_top.create(Array::type_HasRefs, false, 3); // Throws
+    m_entries.create(m_top, 1, 0, 1);            // Throws
+    m_counts.set_parent(&m_top, 2);
+    m_counts.create(); // Throws
+}
+
+CollectionIndex::CollectionIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                                 const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_entries(alloc)
+    , m_counts(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    init_trees();
+}
+
+bool CollectionIndex::type_supported(ColKey col)
+{
+    if (col.is_dictionary())
+        return col.get_type() != col_type_Link;
+    if (!col.is_list() && !col.is_set())
+        return false;
+    auto type = col.get_type();
+    return (type == col_type_Int || type == col_type_Bool || type == col_type_String ||
+            type == col_type_Timestamp || type == col_type_ObjectId || type == col_type_UUID);
+}
+
+void CollectionIndex::init_trees()
+{
+    // The values are in the first slot of the top array, the keys in the
+    // second one
+    m_entries.init_from_parent(m_top, 1, 0, 1);
+    m_counts.set_parent(&m_top, 2);
+    m_counts.init_from_parent();
+}
+
+void CollectionIndex::update_from_parent() noexcept
+{
+    m_top.update_from_parent();
+    init_trees();
+}
+
+void CollectionIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_top.init_from_parent();
+    init_trees();
+    m_target_column = target_column;
+}
+
+// Position of the entry of (value, key), or npos. `insert_ndx` is set to
+// where such an entry belongs.
+size_t CollectionIndex::find_entry(Mixed value, ObjKey key, size_t& insert_ndx) const
+{
+    insert_ndx = m_entries.find_entry(&value, key);
+    size_t sz = size();
+    for (size_t ndx = insert_ndx; ndx < sz && get_key(ndx) == key; ++ndx) {
+        Mixed v = get_value(ndx);
+        if (v.compare(value) != 0)
+            break;
+        if (same_value(v, value))
+            return ndx;
+    }
+    return npos;
+}
+
+void CollectionIndex::erase_entry(size_t ndx)
+{
+    m_entries.erase(ndx);
+    m_counts.erase(ndx);
+}
+
+void CollectionIndex::insert(ObjKey key, const Mixed& value)
+{
+    if (!value.is_null() && !value_type_supported(value.get_type()))
+        return;
+    size_t insert_ndx;
+    size_t ndx = find_entry(value, key, insert_ndx);
+    if (ndx != npos) {
+        m_counts.set(ndx, m_counts.get(ndx) + 1); // Throws
+        return;
+    }
+    m_entries.insert(insert_ndx, &value, key); // Throws
+    m_counts.insert(insert_ndx, 1);            // Throws
+}
+
+void CollectionIndex::erase(ObjKey key, Mixed value)
+{
+    if (!value.is_null() && !value_type_supported(value.get_type()))
+        return;
+    size_t insert_ndx;
+    size_t ndx = find_entry(value, key, insert_ndx);
+    REALM_ASSERT(ndx != npos);
+    int64_t count = m_counts.get(ndx);
+    if (count > 1) {
+        m_counts.set(ndx, count - 1);
+    }
+    else {
+        erase_entry(ndx);
+    }
+}
+
+void CollectionIndex::erase(ObjKey key)
+{
+    const Obj obj = m_target_column.get_object(key);
+    auto collection = obj.get_collection_ptr(m_target_column.get_column_key());
+    size_t sz = collection->size();
+    for (size_t i = 0; i < sz; ++i) {
+        Mixed value = collection->get_any(i);
+        if (!value.is_null() && !value_type_supported(value.get_type()))
+            continue;
+        size_t insert_ndx;
+        size_t ndx = find_entry(value, key, insert_ndx);
+        // Repeated values only have one entry
+        if (ndx != npos)
+            erase_entry(ndx);
+    }
+}
+
+void CollectionIndex::set(ObjKey key, const Mixed& new_value)
+{
+    erase(key);
+    insert(key, new_value); // Throws
+}
+
+void CollectionIndex::clear()
+{
+    m_entries.clear();
+    m_counts.clear();
+}
+
+ObjKey CollectionIndex::find_first(const Mixed& value) const
+{
+    std::vector<ObjKey> result;
+    find_all(result, value);
+    return result.empty() ? ObjKey() : result.front();
+}
+
+size_t CollectionIndex::count(const Mixed& value) const
+{
+    std::vector<ObjKey> result;
+    find_all(result, value);
+    return result.size();
+}
+
+void CollectionIndex::find_all(std::vector<ObjKey>& result, const Mixed& value) const
+{
+    size_t begin = m_entries.lower_bound(value);
+    size_t end = m_entries.upper_bound(value);
+    if (end <= begin)
+        return;
+
+    size_t old_size = result.size();
+    Equal equal;
+    for (size_t i = begin; i < end; ++i) {
+        // Values of another type may compare equal without matching
+        if (equal(get_value(i), value))
+            result.push_back(get_key(i));
+    }
+    std::sort(result.begin() + old_size, result.end());
+    result.erase(std::unique(result.begin() + old_size, result.end()), result.end());
+}
+
+void CollectionIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    // Values of different types comparing equal have separate entries of the
+    // same key
+    m_entries.verify(true);
+    m_counts.verify();
+    REALM_ASSERT(m_counts.size() == size());
+    size_t sz = size();
+    for (size_t i = 0; i < sz; ++i)
+        REALM_ASSERT(m_counts.get(i) > 0);
+#endif
+}
@@ -0,0 +1,146 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_COLLECTION_HPP
+#define REALM_INDEX_COLLECTION_HPP
+
+#include <vector>
+
+#include <realm/index_sorted.hpp>
+#include <realm/index_string.hpp>
+
+/*
+The CollectionIndex class is the search index of a list or set column of type_Int, type_Bool, type_String,
+type_Timestamp, type_ObjectId or type_UUID, or of the values of a dictionary column. It holds an entry for each
+distinct value of the collection of each object, so that the objects whose collection contains a given value can be
+found without visiting the collections.
+
+The index consists of three B+trees of the same size: the values and the object keys (see SortedIndexEntries), and
+the number of times the value occurs in the collection of the object. Entries are ordered by value, using Mixed::compare(), and entries with equal
+values are ordered by object key:
+
+       values:  "a"  "a"  "b"  "c"
+       keys:      1    4    1    2
+       counts:    2    1    1    1       (the list of object 1 holds "a" twice)
+
+As the entries of an object are only found through its values, the collection classes report every value added
+or removed (see Lst<T>::do_insert() and friends). Only when all entries of an object are removed is the collection
+read. Link values of a dictionary are not indexed.
+
+The top array holds the refs of the three trees.
+*/
+
+namespace realm {
+
+class CollectionIndex : public SearchIndex {
+public:
+    CollectionIndex(const ClusterColumn& target_column, Allocator&);
+    CollectionIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    IndexType get_index_type() const noexcept override
+    {
+        return IndexType::General;
+    }
+    ColKey get_column_key() const override
+    {
+        return m_target_column.get_column_key();
+    }
+
+    static bool type_supported(ColKey col);
+
+    /// True if find_all() can look up values of type `type`
+    static bool value_type_supported(DataType type)
+    {
+        return type != type_Link && type != type_TypedLink;
+    }
+
+    // Accessor concept:
+    void destroy() noexcept override;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept override;
+    void update_from_parent() noexcept override;
+    void refresh_accessor_tree(const ClusterColumn& target_column) override;
+    ref_type get_ref() const noexcept override;
+
+    // SearchIndex interface:
+
+    /// Another occurrence of `value` was added to the collection of the object
+    void insert(ObjKey key, const Mixed& value) override;
+    /// The collection of the object was replaced by one holding `new_value`
+    /// alone
+    void set(ObjKey key, const Mixed& new_value) override;
+    /// Remove all entries of the object, whose collection is read to find them
+    void erase(ObjKey key) override;
+    void clear() override;
+    ObjKey find_first(const Mixed& value) const override;
+    /// Append the keys of the objects whose collection contains a value equal
+    /// to `value` to `result`, in key order.
+    void find_all(std::vector<ObjKey>& result, const Mixed& value) const override;
+    size_t count(const Mixed& value) const override;
+    void verify() const override;
+
+    // CollectionIndex interface:
+
+    /// An occurrence of `value` was removed from the collection of the object
+    void erase(ObjKey key, Mixed value);
+
+    size_t size() const noexcept
+    {
+        return m_entries.size();
+    }
+    Mixed get_value(size_t ndx) const
+    {
+        return m_entries.get_value(ndx);
+    }
+    ObjKey get_key(size_t ndx) const
+    {
+        return m_entries.get_key(ndx);
+    }
+    size_t get_count(size_t ndx) const
+    {
+        return size_t(m_counts.get(ndx));
+    }
+
+private:
+    Array m_top;
+    SortedIndexEntries m_entries;
+    BPlusTree<int64_t> m_counts;
+    ClusterColumn m_target_column;
+
+    void init_trees();
+    size_t find_entry(Mixed value, ObjKey key, size_t& insert_ndx) const;
+    void erase_entry(size_t ndx);
+};
+
+inline void CollectionIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void CollectionIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline ref_type CollectionIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_COLLECTION_HPP
@@ -0,0 +1,191 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include <realm/index_composite.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+CompositeIndex::CompositeIndex(const Table& table, const std::vector<ColKey>& columns, Allocator& alloc)
+    : m_top(alloc)
+    , m_column_keys(alloc)
+    , m_entries(alloc)
+    , m_table(&table)
+    , m_columns(columns)
+{
+    m_top.create(Array::type_HasRefs, false, 2 + columns.size()); // Throws
+    m_column_keys.set_parent(&m_top, 0);
+    m_column_keys.create(Array::type_Normal); // Throws
+    m_column_keys.update_parent();
+    for (auto col : columns)
+        m_column_keys.add(col.value);                // Throws
+    m_entries.create(m_top, 1, 2, columns.size()); // Throws
+}
+
+CompositeIndex::CompositeIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent, const Table& table,
+                               Allocator& alloc)
+    : m_top(alloc)
+    , m_column_keys(alloc)
+    , m_entries(alloc)
+    , m_table(&table)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    init_trees(); // Throws
+}
+
+bool CompositeIndex::type_supported(ColKey col)
+{
+    if (col.is_collection())
+        return false;
+    auto type = col.get_type();
+    return (type == col_type_Int || type == col_type_Bool || type == col_type_String ||
+            type == col_type_Timestamp || type == col_type_ObjectId);
+}
+
+bool CompositeIndex::has_column(ColKey col) const noexcept
+{
+    return std::find(m_columns.begin(), m_columns.end(), col) != m_columns.end();
+}
+
+void CompositeIndex::init_trees()
+{
+    m_column_keys.set_parent(&m_top, 0);
+    m_column_keys.init_from_parent();
+    size_t num_columns = m_column_keys.size();
+    m_columns.resize(num_columns);
+    for (size_t i = 0; i < num_columns; ++i)
+        m_columns[i] = ColKey(m_column_keys.get(i));
+
+    // The object keys are in the second slot of the top array, followed by
+    // the values of each column
+    m_entries.init_from_parent(m_top, 1, 2, num_columns); // Throws
+}
+
+void CompositeIndex::update_from_parent() noexcept
+{
+    m_top.update_from_parent();
+    m_column_keys.update_from_parent();
+    m_entries.init_from_parent(m_top, 1, 2, m_columns.size());
+}
+
+void CompositeIndex::refresh_accessor_tree()
+{
+    m_top.init_from_parent();
+    init_trees(); // Throws
+}
+
+CompositeIndex::Values CompositeIndex::get_values(ObjKey key) const
+{
+    Values values;
+    values.reserve(m_columns.size());
+    const Obj obj = m_table->get_object(key);
+    for (auto col : m_columns)
+        values.push_back(obj.get_any(col));
+    return values;
+}
+
+void CompositeIndex::insert_entry(const Values& values, ObjKey key)
+{
+    size_t ndx = m_entries.find_entry(values.data(), key);
+    m_entries.insert(ndx, values.data(), key); // Throws
+}
+
+void CompositeIndex::erase_entry(const Values& values, ObjKey key)
+{
+    size_t ndx = m_entries.find_entry(values.data(), key);
+    REALM_ASSERT_3(ndx, <, size());
+    REALM_ASSERT(get_key(ndx) == key);
+    m_entries.erase(ndx);
+}
+
+void CompositeIndex::insert(ObjKey key)
+{
+    insert_entry(get_values(key), key); // Throws
+}
+
+void CompositeIndex::set(ObjKey key, ColKey col, Mixed new_value)
+{
+    Values values = get_values(key);
+    size_t column = std::find(m_columns.begin(), m_columns.end(), col) - m_columns.begin();
+    REALM_ASSERT(column < m_columns.size());
+    if (values[column].compare(new_value) == 0)
+        return;
+    erase_entry(values, key);
+    values[column] = new_value;
+    insert_entry(values, key); // Throws
+}
+
+void CompositeIndex::erase(ObjKey key)
+{
+    erase_entry(get_values(key), key);
+}
+
+void CompositeIndex::clear()
+{
+    m_entries.clear();
+}
+
+void CompositeIndex::find_all(std::vector<ObjKey>& result, const std::vector<Mixed>& prefix, Condition condition,
+                              Mixed value) const
+{
+    REALM_ASSERT(prefix.size() <= m_columns.size());
+    Values probe(prefix);
+    size_t begin;
+    size_t end;
+    if (condition == Condition::Equal) {
+        begin = lower_bound(probe);
+        end = upper_bound(probe);
+    }
+    else {
+        REALM_ASSERT(prefix.size() < m_columns.size());
+        if (value.is_null())
+            return;
+        size_t prefix_end = upper_bound(probe);
+        probe.push_back(value);
+        switch (condition) {
+            case Condition::Greater:
+                begin = upper_bound(probe);
+                end = prefix_end;
+                break;
+            case Condition::GreaterEqual:
+                begin = lower_bound(probe);
+                end = prefix_end;
+                break;
+            default:
+                end = (condition == Condition::Less) ? lower_bound(probe) : upper_bound(probe);
+                // Skip the null entries, which come first
+                probe.back() = Mixed();
+                begin = upper_bound(probe);
+                break;
+        }
+    }
+    if (end <= begin)
+        return;
+    m_entries.get_keys(begin, end, result);
+}
+
+void CompositeIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    m_entries.verify();
+    REALM_ASSERT(size() == m_table->size());
+#endif
+}
@@ -0,0 +1,167 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_COMPOSITE_HPP
+#define REALM_INDEX_COMPOSITE_HPP
+
+#include <vector>
+
+#include <realm/index_sorted.hpp>
+#include <realm/keys.hpp>
+#include <realm/query_conditions.hpp>
+
+/*
+The CompositeIndex class is an ordered index over the values of 2 to 4 columns of a table. Entries are ordered
+lexicographically by the values of the columns, in the order the columns were given, and entries with equal values are
+ordered by object key. The objects satisfying equality conditions on a leading subset of the columns, optionally
+combined with a range condition on the column following them, therefore form a contiguous run of entries:
+
+       a:     1  1  1  1  2
+       b:     x  y  y  z  x
+       keys:  7  2  4  1  3       a == 1 && b >= "y"  ->  keys 2, 4, 1
+
+The top array holds the keys of the indexed columns, the B+tree of object keys, and one B+tree of values per column
+(see SortedIndexEntries). Values are compared with Mixed::compare(), so null comes first.
+*/
+
+namespace realm {
+
+class Table;
+
+class CompositeIndex {
+public:
+    enum class Condition { Equal, Greater, GreaterEqual, Less, LessEqual };
+
+    static constexpr size_t min_columns = 2;
+    static constexpr size_t max_columns = 4;
+
+    CompositeIndex(const Table& table, const std::vector<ColKey>& columns, Allocator&);
+    CompositeIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const Table& table, Allocator&);
+
+    static bool type_supported(ColKey col);
+
+    /// The condition evaluated by find_all() for `Cond`
+    template <class Cond>
+    static constexpr bool condition_supported =
+        realm::is_any<Cond, Equal, Greater, GreaterEqual, Less, LessEqual>::value;
+    template <class Cond>
+    static constexpr Condition condition_of();
+
+    const std::vector<ColKey>& get_column_keys() const noexcept
+    {
+        return m_columns;
+    }
+    bool has_column(ColKey col) const noexcept;
+
+    // Accessor concept:
+    void destroy() noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    void update_from_parent() noexcept;
+    void refresh_accessor_tree();
+    ref_type get_ref() const noexcept;
+
+    // CompositeIndex interface:
+
+    /// Add the object, whose values are read from the table
+    void insert(ObjKey key);
+    /// Must be called before the new value is stored in the column, as the
+    /// current values are read from the table to locate the entry.
+    void set(ObjKey key, ColKey col, Mixed new_value);
+    void erase(ObjKey key);
+    void clear();
+
+    size_t size() const noexcept
+    {
+        return m_entries.size();
+    }
+    ObjKey get_key(size_t ndx) const
+    {
+        return m_entries.get_key(ndx);
+    }
+    Mixed get_value(size_t ndx, size_t column) const
+    {
+        return m_entries.get_value(ndx, column);
+    }
+
+    /// Append the keys of the objects whose values of the first
+    /// `prefix.size()` columns are equal to `prefix` to `result`, in key
+    /// order. If `condition` is not Equal, the value of the next column must
+    /// furthermore satisfy it against `value`; null never satisfies a range
+    /// condition.
+    void find_all(std::vector<ObjKey>& result, const std::vector<Mixed>& prefix,
+                  Condition condition = Condition::Equal, Mixed value = {}) const;
+
+    void verify() const;
+
+private:
+    using Values = std::vector<Mixed>;
+
+    Array m_top;
+    Array m_column_keys;
+    SortedIndexEntries m_entries;
+    const Table* m_table;
+    std::vector<ColKey> m_columns;
+
+    void init_trees();
+    Values get_values(ObjKey key) const;
+    size_t lower_bound(const Values& values) const
+    {
+        return m_entries.lower_bound(values.data(), values.size());
+    }
+    size_t upper_bound(const Values& values) const
+    {
+        return m_entries.upper_bound(values.data(), values.size());
+    }
+    void insert_entry(const Values& values, ObjKey key);
+    void erase_entry(const Values& values, ObjKey key);
+};
+
+template <class Cond>
+constexpr CompositeIndex::Condition CompositeIndex::condition_of()
+{
+    static_assert(condition_supported<Cond>, "Condition not supported by CompositeIndex");
+    if constexpr (std::is_same_v<Cond, Greater>)
+        return Condition::Greater;
+    else if constexpr (std::is_same_v<Cond, GreaterEqual>)
+        return Condition::GreaterEqual;
+    else if constexpr (std::is_same_v<Cond, Less>)
+        return Condition::Less;
+    else if constexpr (std::is_same_v<Cond, LessEqual>)
+        return Condition::LessEqual;
+    else
+        return Condition::Equal;
+}
+
+inline void CompositeIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void CompositeIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline ref_type CompositeIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_COMPOSITE_HPP
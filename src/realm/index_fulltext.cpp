@@ -0,0 +1,327 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <iterator>
+
+#include <realm/index_fulltext.hpp>
+#include <realm/unicode.hpp>
+
+using namespace realm;
+
+namespace {
+
+// Decode the UTF-8 sequence at `p`, which must be before `end`, and advance
+// `p` past it. Invalid and truncated sequences are skipped one byte at a time
+// and decoded as U+FFFD.
+uint32_t next_char(const char*& p, const char* end)
+{
+    const uint32_t replacement = 0xFFFD;
+    size_t len = sequence_length(*p);
+    if (len > 4 || len > size_t(end - p) || (len == 1 && static_cast<unsigned char>(*p) >= 0x80)) {
+        ++p;
+        return replacement;
+    }
+    for (size_t i = 1; i < len; ++i) {
+        if ((static_cast<unsigned char>(p[i]) & 0xC0) != 0x80) {
+            ++p;
+            return replacement;
+        }
+    }
+    uint32_t c = utf8value(p);
+    p += len;
+    return c;
+}
+
+bool is_token_char(uint32_t c)
+{
+    if (c < 0x80)
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    // Without character tables, any other character is taken to be part of a
+    // word unless it belongs to one of the blocks of spaces, punctuation and
+    // symbols below
+    if (c < 0xC0) // Latin-1 controls, spaces, punctuation and symbols
+        return c == 0xAA || c == 0xB5 || c == 0xBA;
+    if (c == 0xD7 || c == 0xF7) // Multiplication and division signs
+        return false;
+    if (c >= 0x2000 && c < 0x2C00) // General punctuation up to miscellaneous symbols and arrows
+        return false;
+    if (c >= 0x2E00 && c < 0x2E80) // Supplemental punctuation
+        return false;
+    if (c >= 0x3000 && c < 0x3040) // CJK symbols and punctuation
+        return false;
+    if ((c >= 0xFE10 && c < 0xFE20) || (c >= 0xFE30 && c < 0xFE70)) // Vertical, compatibility and small forms
+        return false;
+    if (c >= 0xFF00 && c < 0xFF66) // Fullwidth ASCII punctuation and halfwidth CJK punctuation
+        return (c >= 0xFF10 && c < 0xFF1A) || (c >= 0xFF21 && c < 0xFF3B) || (c >= 0xFF41 && c < 0xFF5B);
+    if (c >= 0xFFF0 && c < 0x10000) // Specials, including the replacement character
+        return false;
+    if (c >= 0x1F000 && c < 0x1FB00) // Emoji and pictographs
+        return false;
+    return true;
+}
+
+} // unnamed namespace
+
+FullTextIndex::FullTextIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_tokens(alloc)
+    , m_keys(alloc)
+    , m_target_column(target_column)
+{
+    m_top.create(Array::type_HasRefs, false, 2); // Throws
+    m_tokens.set_parent(&m_top, 0);
+    m_tokens.create(); // Throws
+    m_keys.set_parent(&m_top, 1);
+    m_keys.create(); // Throws
+}
+
+FullTextIndex::FullTextIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                             const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_tokens(alloc)
+    , m_keys(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    init_trees();
+}
+
+FullTextIndex::Tokens FullTextIndex::tokenize(StringData text)
+{
+    Tokens tokens;
+    if (text.is_null())
+        return tokens;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    const char* begin = nullptr;
+    while (p != end) {
+        const char* char_begin = p;
+        bool token_char = is_token_char(next_char(p, end));
+        if (token_char && !begin) {
+            begin = char_begin;
+        }
+        else if (!token_char && begin) {
+            tokens.insert(case_map(StringData(begin, char_begin - begin), false, IgnoreErrors)); // Throws
+            begin = nullptr;
+        }
+    }
+    if (begin)
+        tokens.insert(case_map(StringData(begin, end - begin), false, IgnoreErrors)); // Throws
+    return tokens;
+}
+
+bool FullTextIndex::matches(StringData text, const Tokens& tokens)
+{
+    if (tokens.empty())
+        return false;
+    Tokens text_tokens = tokenize(text); // Throws
+    return std::includes(text_tokens.begin(), text_tokens.end(), tokens.begin(), tokens.end());
+}
+
+void FullTextIndex::init_trees()
+{
+    m_tokens.set_parent(&m_top, 0);
+    m_tokens.init_from_parent();
+    m_keys.set_parent(&m_top, 1);
+    m_keys.init_from_parent();
+}
+
+void FullTextIndex::update_from_parent() noexcept
+{
+    m_top.update_from_parent();
+    init_trees();
+}
+
+void FullTextIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_top.init_from_parent();
+    init_trees();
+    m_target_column = target_column;
+}
+
+FullTextIndex::Tokens FullTextIndex::get_tokens(ObjKey key) const
+{
+    Mixed value = m_target_column.get_value(key);
+    return value.is_null() ? Tokens() : tokenize(value.get_string());
+}
+
+size_t FullTextIndex::lower_bound(StringData token) const
+{
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m_tokens.get(mid) < token)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+size_t FullTextIndex::upper_bound(StringData token) const
+{
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (!(token < m_tokens.get(mid)))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Position of the first entry not ordered before (token, key)
+size_t FullTextIndex::find_entry(StringData token, ObjKey key) const
+{
+    size_t lo = lower_bound(token);
+    size_t hi = upper_bound(token);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m_keys.get(mid) < key.value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void FullTextIndex::insert_tokens(ObjKey key, const Tokens& tokens)
+{
+    for (auto& token : tokens) {
+        StringData t(token);
+        size_t ndx = find_entry(t, key);
+        m_tokens.insert(ndx, t);        // Throws
+        m_keys.insert(ndx, key.value);  // Throws
+    }
+}
+
+void FullTextIndex::erase_tokens(ObjKey key, const Tokens& tokens)
+{
+    for (auto& token : tokens) {
+        size_t ndx = find_entry(StringData(token), key);
+        REALM_ASSERT_3(ndx, <, size());
+        REALM_ASSERT(m_keys.get(ndx) == key.value);
+        m_tokens.erase(ndx);
+        m_keys.erase(ndx);
+    }
+}
+
+void FullTextIndex::insert(ObjKey key, const Mixed& value)
+{
+    if (!value.is_null())
+        insert_tokens(key, tokenize(value.get_string())); // Throws
+}
+
+void FullTextIndex::set(ObjKey key, const Mixed& new_value)
+{
+    Tokens old_tokens = get_tokens(key); // Throws
+    Tokens new_tokens = new_value.is_null() ? Tokens() : tokenize(new_value.get_string()); // Throws
+    // Entries of tokens found in both values are kept
+    Tokens removed;
+    Tokens added;
+    std::set_difference(old_tokens.begin(), old_tokens.end(), new_tokens.begin(), new_tokens.end(),
+                        std::inserter(removed, removed.end()));
+    std::set_difference(new_tokens.begin(), new_tokens.end(), old_tokens.begin(), old_tokens.end(),
+                        std::inserter(added, added.end()));
+    erase_tokens(key, removed);
+    insert_tokens(key, added); // Throws
+}
+
+void FullTextIndex::erase(ObjKey key)
+{
+    erase_tokens(key, get_tokens(key));
+}
+
+void FullTextIndex::clear()
+{
+    m_tokens.clear();
+    m_keys.clear();
+}
+
+ObjKey FullTextIndex::find_first(const Mixed& text) const
+{
+    std::vector<ObjKey> result;
+    find_all(result, text);
+    return result.empty() ? ObjKey() : result.front();
+}
+
+size_t FullTextIndex::count(const Mixed& text) const
+{
+    std::vector<ObjKey> result;
+    find_all(result, text);
+    return result.size();
+}
+
+void FullTextIndex::find_all(std::vector<ObjKey>& result, const Mixed& text) const
+{
+    if (text.is_null())
+        return;
+    Tokens tokens = tokenize(text.get_string()); // Throws
+    if (tokens.empty())
+        return;
+
+    // Intersect the key ordered runs of entries of the tokens
+    std::vector<int64_t> keys;
+    bool first = true;
+    for (auto& token : tokens) {
+        StringData t(token);
+        size_t begin = lower_bound(t);
+        size_t end = upper_bound(t);
+        if (first) {
+            for (size_t i = begin; i < end; ++i)
+                keys.push_back(m_keys.get(i));
+            first = false;
+        }
+        else {
+            auto out = keys.begin();
+            size_t i = begin;
+            for (auto k : keys) {
+                while (i < end && m_keys.get(i) < k)
+                    ++i;
+                if (i < end && m_keys.get(i) == k)
+                    *out++ = k;
+            }
+            keys.erase(out, keys.end());
+        }
+        if (keys.empty())
+            return;
+    }
+    result.reserve(result.size() + keys.size());
+    for (auto k : keys)
+        result.emplace_back(k);
+}
+
+void FullTextIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    m_tokens.verify();
+    m_keys.verify();
+    REALM_ASSERT(m_tokens.size() == m_keys.size());
+    size_t sz = size();
+    for (size_t i = 1; i < sz; ++i) {
+        StringData prev = m_tokens.get(i - 1);
+        StringData cur = m_tokens.get(i);
+        REALM_ASSERT(prev < cur || (prev == cur && m_keys.get(i - 1) < m_keys.get(i)));
+    }
+#endif
+}
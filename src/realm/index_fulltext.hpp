@@ -0,0 +1,145 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_FULLTEXT_HPP
+#define REALM_INDEX_FULLTEXT_HPP
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <realm/array_integer.hpp>
+#include <realm/array_string.hpp>
+#include <realm/bplustree.hpp>
+#include <realm/index_string.hpp>
+
+/*
+The FullTextIndex class is an inverted index of the words of a type_String column. It is added with
+Table::add_search_index(col, IndexType::Fulltext) and serves the TEXT condition (Query::fulltext()), which matches
+the strings holding all the words of the search text, in any order and position.
+
+A string is split into tokens at every character which is not part of a word. Within ASCII, the letters and digits
+are part of words. Outside of ASCII, characters are part of words, so words of other scripts are kept whole, except
+those of the blocks of spaces, punctuation and symbols: the Latin-1 controls, spaces, punctuation and symbols (but
+not the ordinal indicators and the micro sign), the multiplication and division signs, General Punctuation up to
+Miscellaneous Symbols and Arrows, Supplemental Punctuation, CJK Symbols and Punctuation, the vertical, compatibility
+and small forms, the fullwidth and halfwidth punctuation, the Specials, and the emoji and pictographs. An invalid
+UTF-8 sequence is read as the replacement character, so it splits tokens as well. Tokens are case folded with
+case_map() of unicode.cpp, so the search is case insensitive for the characters it knows. The index holds an entry for each
+distinct token of the string of each object. Entries are ordered by token, and entries with equal tokens by object
+key:
+
+       tokens:  "brown"  "fox"  "fox"  "quick"
+       keys:         1       1      3        1
+
+The top array holds the refs of the two B+trees.
+*/
+
+namespace realm {
+
+class FullTextIndex : public SearchIndex {
+public:
+    using Tokens = std::set<std::string>;
+
+    FullTextIndex(const ClusterColumn& target_column, Allocator&);
+    FullTextIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    IndexType get_index_type() const noexcept override
+    {
+        return IndexType::Fulltext;
+    }
+    ColKey get_column_key() const override
+    {
+        return m_target_column.get_column_key();
+    }
+
+    static bool type_supported(ColKey col)
+    {
+        return col.get_type() == col_type_String && !col.is_collection();
+    }
+
+    /// The distinct, case folded tokens of `text`
+    static Tokens tokenize(StringData text);
+    /// True if `text` holds all of `tokens`. This is what the index computes
+    /// for the strings of the column.
+    static bool matches(StringData text, const Tokens& tokens);
+
+    // Accessor concept:
+    void destroy() noexcept override;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept override;
+    void update_from_parent() noexcept override;
+    void refresh_accessor_tree(const ClusterColumn& target_column) override;
+    ref_type get_ref() const noexcept override;
+
+    // SearchIndex interface. Values are strings or null, and null has no
+    // tokens.
+
+    void insert(ObjKey key, const Mixed& value) override;
+    /// Replace the entries of the current value of the object by those of
+    /// `new_value`
+    void set(ObjKey key, const Mixed& new_value) override;
+    /// Remove all entries of the object, whose current value is read to find them
+    void erase(ObjKey key) override;
+    void clear() override;
+    ObjKey find_first(const Mixed& text) const override;
+    /// Append the keys of the objects whose string holds all tokens of `text`
+    /// to `result`, in key order. Nothing is found if `text` has no tokens.
+    void find_all(std::vector<ObjKey>& result, const Mixed& text) const override;
+    size_t count(const Mixed& text) const override;
+    void verify() const override;
+
+    // FullTextIndex interface:
+
+    size_t size() const noexcept
+    {
+        return m_keys.size();
+    }
+
+private:
+    Array m_top;
+    BPlusTree<StringData> m_tokens;
+    BPlusTree<int64_t> m_keys;
+    ClusterColumn m_target_column;
+
+    void init_trees();
+    Tokens get_tokens(ObjKey key) const;
+    size_t lower_bound(StringData token) const;
+    size_t upper_bound(StringData token) const;
+    size_t find_entry(StringData token, ObjKey key) const;
+    void insert_tokens(ObjKey key, const Tokens& tokens);
+    void erase_tokens(ObjKey key, const Tokens& tokens);
+};
+
+inline void FullTextIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void FullTextIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline ref_type FullTextIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_FULLTEXT_HPP
@@ -0,0 +1,104 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_range.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+RangeIndex::RangeIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_entries(alloc)
+    , m_target_column(target_column)
+{
+    m_top.create(Array::type_HasRefs, false, 2); // Throws
+    m_entries.create(m_top, 1, 0, 1);            // Throws
+}
+
+RangeIndex::RangeIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent, const ClusterColumn& target_column,
+                       Allocator& alloc)
+    : m_top(alloc)
+    , m_entries(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    init_trees();
+}
+
+void RangeIndex::init_trees()
+{
+    // The values are in the first slot of the top array, the keys in the
+    // second one
+    m_entries.init_from_parent(m_top, 1, 0, 1);
+}
+
+void RangeIndex::update_from_parent() noexcept
+{
+    m_top.update_from_parent();
+    init_trees();
+}
+
+void RangeIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_top.init_from_parent();
+    init_trees();
+    m_target_column = target_column;
+}
+
+void RangeIndex::insert(ObjKey key, const Mixed& value)
+{
+    size_t ndx = m_entries.find_entry(&value, key);
+    m_entries.insert(ndx, &value, key); // Throws
+}
+
+void RangeIndex::set(ObjKey key, const Mixed& new_value)
+{
+    Mixed old_value = m_target_column.get_value(key);
+    if (old_value.compare(new_value) == 0)
+        return;
+    erase(key);
+    insert(key, new_value); // Throws
+}
+
+void RangeIndex::erase(ObjKey key)
+{
+    Mixed value = m_target_column.get_value(key);
+    size_t ndx = m_entries.find_entry(&value, key);
+    REALM_ASSERT_3(ndx, <, size());
+    REALM_ASSERT(get_key(ndx) == key);
+    m_entries.erase(ndx);
+}
+
+void RangeIndex::clear()
+{
+    m_entries.clear();
+}
+
+void RangeIndex::find_all(std::vector<ObjKey>& result, const Mixed& value) const
+{
+    find_all<Equal>(result, value);
+}
+
+void RangeIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    m_entries.verify();
+    REALM_ASSERT(size() == m_target_column.size());
+#endif
+}
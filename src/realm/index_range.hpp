@@ -0,0 +1,187 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_RANGE_HPP
+#define REALM_INDEX_RANGE_HPP
+
+#include <vector>
+
+#include <realm/index_sorted.hpp>
+#include <realm/index_string.hpp>
+#include <realm/query_conditions.hpp>
+
+/*
+The RangeIndex class is an ordered index for type_Int, type_Timestamp and type_ObjectId columns. Contrary to the
+StringIndex, which only supports lookup of a given value, it keeps the entries sorted by value, so that the objects
+satisfying a range condition form a contiguous run of entries, and the objects of a table can be visited in the order
+of the column.
+
+The index consists of two B+trees of the same size (see SortedIndexEntries): one holding the values and one holding
+the object keys. Entries are ordered by value, using Mixed::compare() (so null comes first), and entries with equal
+values are ordered by object key:
+
+       values:  null  3  3  7  12
+       keys:      4   1  9  2   5
+
+The top array holds the refs of the two trees.
+*/
+
+namespace realm {
+
+class RangeIndex : public SearchIndex {
+public:
+    RangeIndex(const ClusterColumn& target_column, Allocator&);
+    RangeIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    IndexType get_index_type() const noexcept override
+    {
+        return IndexType::Ordered;
+    }
+    ColKey get_column_key() const override
+    {
+        return m_target_column.get_column_key();
+    }
+
+    static bool type_supported(realm::DataType type)
+    {
+        return (type == type_Int || type == type_Timestamp || type == type_ObjectId);
+    }
+
+    /// Conditions that can be evaluated by find_all()
+    template <class Cond>
+    static constexpr bool condition_supported =
+        realm::is_any<Cond, Equal, Greater, GreaterEqual, Less, LessEqual>::value;
+
+    // Accessor concept:
+    void destroy() noexcept override;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept override;
+    void update_from_parent() noexcept override;
+    void refresh_accessor_tree(const ClusterColumn& target_column) override;
+    ref_type get_ref() const noexcept override;
+
+    // SearchIndex interface:
+
+    void insert(ObjKey key, const Mixed& value) override;
+    void set(ObjKey key, const Mixed& new_value) override;
+    void erase(ObjKey key) override;
+    void clear() override;
+    ObjKey find_first(const Mixed& value) const override
+    {
+        size_t ndx = lower_bound(value);
+        return (ndx < size() && get_value(ndx).compare(value) == 0) ? get_key(ndx) : ObjKey();
+    }
+    /// Append the keys of the objects holding `value` to `result`, in key
+    /// order
+    void find_all(std::vector<ObjKey>& result, const Mixed& value) const override;
+    size_t count(const Mixed& value) const override
+    {
+        return upper_bound(value) - lower_bound(value);
+    }
+    void verify() const override;
+
+    // RangeIndex interface:
+
+    size_t size() const noexcept
+    {
+        return m_entries.size();
+    }
+    Mixed get_value(size_t ndx) const
+    {
+        return m_entries.get_value(ndx);
+    }
+    ObjKey get_key(size_t ndx) const
+    {
+        return m_entries.get_key(ndx);
+    }
+
+    /// Position of the first entry whose value is not less than (greater
+    /// than) `value`.
+    size_t lower_bound(Mixed value) const
+    {
+        return m_entries.lower_bound(value);
+    }
+    size_t upper_bound(Mixed value) const
+    {
+        return m_entries.upper_bound(value);
+    }
+
+    /// Append the keys of the objects whose value satisfies `Cond` against
+    /// `value` to `result`, in key order. Null never satisfies a range
+    /// condition. If more than `max_matches` objects match, nothing is
+    /// appended and false is returned.
+    template <class Cond>
+    bool find_all(std::vector<ObjKey>& result, Mixed value, size_t max_matches = npos) const;
+
+private:
+    Array m_top;
+    SortedIndexEntries m_entries;
+    ClusterColumn m_target_column;
+
+    void init_trees();
+};
+
+template <class Cond>
+bool RangeIndex::find_all(std::vector<ObjKey>& result, Mixed value, size_t max_matches) const
+{
+    static_assert(condition_supported<Cond>, "Condition not supported by RangeIndex");
+
+    size_t begin;
+    size_t end;
+    if constexpr (std::is_same_v<Cond, Equal>) {
+        begin = lower_bound(value);
+        end = upper_bound(value);
+    }
+    else {
+        if (value.is_null())
+            return true;
+        if constexpr (std::is_same_v<Cond, Greater> || std::is_same_v<Cond, GreaterEqual>) {
+            begin = std::is_same_v<Cond, Greater> ? upper_bound(value) : lower_bound(value);
+            end = size();
+        }
+        else {
+            // Skip the null entries, which come first
+            begin = upper_bound(Mixed());
+            end = std::is_same_v<Cond, Less> ? lower_bound(value) : upper_bound(value);
+        }
+    }
+    if (end <= begin)
+        return true;
+    if (end - begin > max_matches)
+        return false;
+    m_entries.get_keys(begin, end, result);
+    return true;
+}
+
+inline void RangeIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+inline void RangeIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+inline ref_type RangeIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+} // namespace realm
+
+#endif // REALM_INDEX_RANGE_HPP
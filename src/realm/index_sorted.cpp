@@ -0,0 +1,163 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include <realm/index_sorted.hpp>
+
+using namespace realm;
+
+SortedIndexEntries::SortedIndexEntries(Allocator& alloc)
+    : m_keys(alloc)
+{
+}
+
+void SortedIndexEntries::attach(Array& parent, size_t keys_ndx, size_t values_ndx, size_t num_columns)
+{
+    m_keys.set_parent(&parent, keys_ndx);
+    m_values.resize(num_columns);
+    for (size_t i = 0; i < num_columns; ++i) {
+        if (!m_values[i])
+            m_values[i] = std::make_unique<BPlusTree<Mixed>>(parent.get_alloc()); // Throws
+        m_values[i]->set_parent(&parent, values_ndx + i);
+    }
+}
+
+void SortedIndexEntries::create(Array& parent, size_t keys_ndx, size_t values_ndx, size_t num_columns)
+{
+    attach(parent, keys_ndx, values_ndx, num_columns); // Throws
+    m_keys.create();                                   // Throws
+    for (auto& tree : m_values)
+        tree->create(); // Throws
+}
+
+void SortedIndexEntries::init_from_parent(Array& parent, size_t keys_ndx, size_t values_ndx, size_t num_columns)
+{
+    attach(parent, keys_ndx, values_ndx, num_columns); // Throws
+    m_keys.init_from_parent();
+    for (auto& tree : m_values)
+        tree->init_from_parent();
+}
+
+std::pair<size_t, size_t> SortedIndexEntries::equal_range(size_t column, Mixed value, size_t begin,
+                                                          size_t end) const
+{
+    const BPlusTree<Mixed>& tree = *m_values[column];
+    begin = tree.partition_point(begin, end, [&](const Mixed& v) {
+        return v.compare(value) < 0;
+    });
+    end = tree.partition_point(begin, end, [&](const Mixed& v) {
+        return v.compare(value) <= 0;
+    });
+    return {begin, end};
+}
+
+size_t SortedIndexEntries::lower_bound(const Mixed* values, size_t num_values) const
+{
+    REALM_ASSERT(num_values <= m_values.size());
+    size_t begin = 0;
+    size_t end = size();
+    for (size_t i = 0; i < num_values && begin < end; ++i) {
+        if (i + 1 == num_values) {
+            return m_values[i]->partition_point(begin, end, [&](const Mixed& v) {
+                return v.compare(values[i]) < 0;
+            });
+        }
+        std::tie(begin, end) = equal_range(i, values[i], begin, end);
+    }
+    return begin;
+}
+
+size_t SortedIndexEntries::upper_bound(const Mixed* values, size_t num_values) const
+{
+    REALM_ASSERT(num_values <= m_values.size());
+    size_t begin = 0;
+    size_t end = size();
+    for (size_t i = 0; i < num_values && begin < end; ++i) {
+        if (i + 1 == num_values) {
+            return m_values[i]->partition_point(begin, end, [&](const Mixed& v) {
+                return v.compare(values[i]) <= 0;
+            });
+        }
+        std::tie(begin, end) = equal_range(i, values[i], begin, end);
+    }
+    return (num_values == 0 ? end : begin);
+}
+
+size_t SortedIndexEntries::find_entry(const Mixed* values, ObjKey key) const
+{
+    size_t begin = 0;
+    size_t end = size();
+    for (size_t i = 0; i < m_values.size() && begin < end; ++i)
+        std::tie(begin, end) = equal_range(i, values[i], begin, end);
+    return m_keys.partition_point(begin, end, [&](int64_t k) {
+        return k < key.value;
+    });
+}
+
+void SortedIndexEntries::insert(size_t ndx, const Mixed* values, ObjKey key)
+{
+    for (size_t i = 0; i < m_values.size(); ++i)
+        m_values[i]->insert(ndx, values[i]); // Throws
+    m_keys.insert(ndx, key.value);            // Throws
+}
+
+void SortedIndexEntries::erase(size_t ndx)
+{
+    for (auto& tree : m_values)
+        tree->erase(ndx);
+    m_keys.erase(ndx);
+}
+
+void SortedIndexEntries::clear()
+{
+    for (auto& tree : m_values)
+        tree->clear();
+    m_keys.clear();
+}
+
+void SortedIndexEntries::get_keys(size_t begin, size_t end, std::vector<ObjKey>& result) const
+{
+    size_t old_size = result.size();
+    result.reserve(old_size + (end - begin));
+    for (size_t i = begin; i < end; ++i)
+        result.emplace_back(m_keys.get(i));
+    std::sort(result.begin() + old_size, result.end());
+}
+
+void SortedIndexEntries::verify(bool allow_equal_keys) const
+{
+#ifdef REALM_DEBUG
+    m_keys.verify();
+    size_t sz = size();
+    for (auto& tree : m_values) {
+        tree->verify();
+        REALM_ASSERT(tree->size() == sz);
+    }
+    for (size_t i = 1; i < sz; ++i) {
+        int c = 0;
+        for (size_t j = 0; j < m_values.size() && c == 0; ++j)
+            c = m_values[j]->get(i - 1).compare(m_values[j]->get(i));
+        int64_t k1 = m_keys.get(i - 1);
+        int64_t k2 = m_keys.get(i);
+        REALM_ASSERT(c < 0 || (c == 0 && (k1 < k2 || (allow_equal_keys && k1 == k2))));
+    }
+#else
+    static_cast<void>(allow_equal_keys);
+#endif
+}
@@ -0,0 +1,111 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_SORTED_HPP
+#define REALM_INDEX_SORTED_HPP
+
+#include <memory>
+#include <vector>
+
+#include <realm/array_integer.hpp>
+#include <realm/array_mixed.hpp>
+#include <realm/bplustree.hpp>
+#include <realm/keys.hpp>
+
+/*
+The SortedIndexEntries class holds the entries of the ordered indexes (RangeIndex, CollectionIndex and CompositeIndex):
+one B+tree of values per indexed column and one B+tree of object keys, all of the same size, each a child of the top
+array of the index. Entries are ordered lexicographically by their values, compared with Mixed::compare() (so null
+comes first), and entries with equal values are ordered by object key.
+
+Searches narrow the range of entries one column at a time with BPlusTree::partition_point(), which only descends
+from the root of a tree until the range lies within a single leaf, and searches that leaf directly.
+*/
+
+namespace realm {
+
+class SortedIndexEntries {
+public:
+    explicit SortedIndexEntries(Allocator&);
+
+    /// Create the trees of `num_columns` columns. The tree of keys becomes
+    /// the child `keys_ndx` of `parent`, and those of values the
+    /// `num_columns` children from `values_ndx`.
+    void create(Array& parent, size_t keys_ndx, size_t values_ndx, size_t num_columns);
+    /// Attach to the trees created by create()
+    void init_from_parent(Array& parent, size_t keys_ndx, size_t values_ndx, size_t num_columns);
+
+    size_t num_columns() const noexcept
+    {
+        return m_values.size();
+    }
+    size_t size() const noexcept
+    {
+        return m_keys.size();
+    }
+    Mixed get_value(size_t ndx, size_t column = 0) const
+    {
+        return m_values[column]->get(ndx);
+    }
+    ObjKey get_key(size_t ndx) const
+    {
+        return ObjKey(m_keys.get(ndx));
+    }
+
+    /// Position of the first entry whose values of the first `num_values`
+    /// columns are not less than (greater than) `values`
+    size_t lower_bound(const Mixed* values, size_t num_values) const;
+    size_t upper_bound(const Mixed* values, size_t num_values) const;
+    size_t lower_bound(Mixed value) const
+    {
+        return lower_bound(&value, 1);
+    }
+    size_t upper_bound(Mixed value) const
+    {
+        return upper_bound(&value, 1);
+    }
+    /// Position of the first entry not ordered before the entry of
+    /// (`values`, `key`), `values` holding a value for every column
+    size_t find_entry(const Mixed* values, ObjKey key) const;
+
+    void insert(size_t ndx, const Mixed* values, ObjKey key);
+    void erase(size_t ndx);
+    void clear();
+
+    /// Append the keys of the entries in [begin, end) to `result`, in key
+    /// order
+    void get_keys(size_t begin, size_t end, std::vector<ObjKey>& result) const;
+
+    /// Check that the entries are ordered. Entries of equal values must have
+    /// distinct keys unless `allow_equal_keys` is true.
+    void verify(bool allow_equal_keys = false) const;
+
+private:
+    std::vector<std::unique_ptr<BPlusTree<Mixed>>> m_values;
+    BPlusTree<int64_t> m_keys;
+
+    // The run of entries in [begin, end), all of which have equal values of
+    // the columns before `column`, whose value of `column` is equal to
+    // `value`
+    std::pair<size_t, size_t> equal_range(size_t column, Mixed value, size_t begin, size_t end) const;
+    void attach(Array& parent, size_t keys_ndx, size_t values_ndx, size_t num_columns);
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_SORTED_HPP
@@ -54,6 +54,12 @@ bool ClusterColumn::is_nullable() const
     return m_column_key.get_attrs().test(col_attr_Nullable);
 }
 
+Mixed ClusterColumn::get_value(ObjKey key) const
+{
+    const Obj obj{m_cluster_tree->get(key)};
+    return obj.get_any(m_column_key);
+}
+
 StringData ClusterColumn::get_index_data(ObjKey key, StringConversionBuffer& buffer) const
 {
     const Obj obj{m_cluster_tree->get(key)};
@@ -81,7 +87,8 @@ StringData ClusterColumn::get_index_data(ObjKey key, StringConversionBuffer& buf
     }
     else if (type == type_String) {
         GetIndexData<String> stringifier;
-        return stringifier.get_index_data(obj.get<String>(m_column_key), buffer);
+        StringData str = stringifier.get_index_data(obj.get<String>(m_column_key), buffer);
+        return m_case_folded ? fold_case(str, buffer) : str;
     }
     else if (type == type_Timestamp) {
         GetIndexData<Timestamp> stringifier;
@@ -117,6 +124,14 @@ StringData ClusterColumn::get_index_data(ObjKey key, StringConversionBuffer& buf
 }
 
 namespace realm {
+StringData fold_case(StringData value, StringConversionBuffer& buffer)
+{
+    if (value.is_null())
+        return value;
+    buffer.folded = case_map(value, true, IgnoreErrors);
+    return StringData(buffer.folded);
+}
+
 StringData GetIndexData<Timestamp>::get_index_data(const Timestamp& dt, StringConversionBuffer& buffer)
 {
     if (dt.is_null())
@@ -661,6 +676,90 @@ void IndexArray::index_string_all(StringData value, std::vector<ObjKey>& result,
 }
 
 
+void IndexArray::prefix_all(const char* header, StringData prefix, size_t offset, std::vector<ObjKey>& result,
+                            const ClusterColumn& column) const
+{
+    const char* const data = get_data_from_header(header);
+    const uint_least8_t width = get_width_from_header(header);
+    const bool is_inner_node = get_is_inner_bptree_node_from_header(header);
+
+    // The keys of the entries holding strings which begin with the remaining part of the prefix form a contiguous
+    // range. If at least 4 bytes remain it is a single key. Otherwise the bytes following the prefix may be anything.
+    // Both ends of a range share the most significant byte, so the range is contiguous in the signed ordering of
+    // the keys as well. When no bytes remain, every entry of the node matches.
+    const size_t remaining = prefix.size() - offset;
+    key_type lower_key = std::numeric_limits<key_type>::min();
+    key_type upper_key = std::numeric_limits<key_type>::max();
+    if (remaining >= StringIndex::s_index_key_length) {
+        lower_key = upper_key = StringIndex::create_key(prefix, offset);
+    }
+    else if (remaining > 0) {
+        uint32_t lower = 0;
+        for (size_t i = 0; i < StringIndex::s_index_key_length; ++i) {
+            lower <<= 8;
+            if (i < remaining)
+                lower |= uint32_t(static_cast<unsigned char>(prefix[offset + i]));
+        }
+        uint32_t upper = lower | (0xFFFFFFFFu >> (8 * remaining));
+        lower_key = key_type(lower);
+        upper_key = key_type(upper);
+    }
+
+    // Get subnode table
+    ref_type offsets_ref = to_ref(get_direct(data, width, 0));
+    const char* const offsets_header = m_alloc.translate(offsets_ref);
+    const char* const offsets_data = get_data_from_header(offsets_header);
+    const size_t offsets_size = get_size_from_header(offsets_header);
+
+    // The buffer is needed when for when this is an integer index.
+    StringConversionBuffer buffer;
+    auto check = [&](ObjKey k) {
+        StringData str = column.get_index_data(k, buffer);
+        if (!str.is_null() && str.begins_with(prefix))
+            result.push_back(k);
+    };
+
+    for (size_t pos = ::lower_bound<32>(offsets_data, offsets_size, lower_key); pos < offsets_size; ++pos) {
+        const key_type stored_key = key_type(get_direct<32>(offsets_data, pos));
+        const uint64_t ref = get_direct(data, width, pos + 1); // first entry in refs points to offsets
+
+        if (is_inner_node) {
+            // The key of an inner node entry is the last key found in that child
+            prefix_all(m_alloc.translate(to_ref(ref)), prefix, offset, result, column);
+            if (stored_key >= upper_key)
+                break;
+            continue;
+        }
+
+        if (stored_key > upper_key)
+            break;
+
+        // Literal row index (tagged)
+        if (ref & 1) {
+            check(ObjKey(int64_t(ref >> 1)));
+            continue;
+        }
+
+        const char* const sub_header = m_alloc.translate(ref_type(ref));
+        const bool sub_isindex = get_context_flag_from_header(sub_header);
+
+        // List of row indices with common prefix up to this point. Strings shorter than the key length are
+        // terminated by a marker in the key, so they must be checked even if the whole prefix was matched.
+        if (!sub_isindex) {
+            const IntegerColumn sub(m_alloc, ref_type(ref));
+            for (IntegerColumn::const_iterator it = sub.cbegin(); it != sub.cend(); ++it) {
+                check(ObjKey(*it));
+            }
+            continue;
+        }
+
+        // Recurse into sub-index
+        size_t sub_offset = std::min(offset + StringIndex::s_index_key_length, prefix.size());
+        prefix_all(sub_header, prefix, sub_offset, result, column);
+    }
+}
+
+
 } // namespace realm
 
 ObjKey IndexArray::index_string_find_first(StringData value, const ClusterColumn& column) const
@@ -680,6 +779,14 @@ void IndexArray::index_string_find_all(std::vector<ObjKey>& result, StringData v
     }
 }
 
+void IndexArray::index_string_find_all_prefix(std::vector<ObjKey>& result, StringData prefix,
+                                              const ClusterColumn& column) const
+{
+    size_t sz = result.size();
+    prefix_all(get_header_from_data(m_data), prefix, 0, result, column);
+    std::sort(result.begin() + sz, result.end());
+}
+
 FindRes IndexArray::index_string_find_all_no_copy(StringData value, const ClusterColumn& column,
                                                   InternalFindResult& result) const
 {
@@ -1195,6 +1302,77 @@ StringData StringIndex::get(ObjKey key, StringConversionBuffer& buffer) const
     return m_target_column.get_index_data(key, buffer);
 }
 
+StringData StringIndex::mixed_to_index_str(const Mixed& value, StringConversionBuffer& buffer) const
+{
+    if (get_column_key().get_type() == col_type_Mixed || value.is_null())
+        return to_index_str(Mixed(value), buffer);
+    switch (value.get_type()) {
+        case type_Int:
+            return to_index_str(value.get<int64_t>(), buffer);
+        case type_Bool:
+            return to_index_str(value.get<bool>(), buffer);
+        case type_String:
+            return to_index_str(value.get<StringData>(), buffer);
+        case type_Timestamp:
+            return to_index_str(value.get<Timestamp>(), buffer);
+        case type_ObjectId:
+            return to_index_str(value.get<ObjectId>(), buffer);
+        case type_UUID:
+            return to_index_str(value.get<UUID>(), buffer);
+        default:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
+void StringIndex::do_set(ObjKey key, StringData new_value)
+{
+    StringConversionBuffer buffer;
+    StringData old_value = get(key, buffer);
+
+    // Note that insert_with_offset() throws UniqueConstraintViolation.
+
+    if (REALM_LIKELY(new_value != old_value)) {
+        // We must erase this row first because erase uses find_first which
+        // might find the duplicate if we insert before erasing.
+        erase(key); // Throws
+
+        size_t offset = 0;                          // First key from beginning of string
+        insert_with_offset(key, new_value, offset); // Throws
+    }
+}
+
+void StringIndex::insert(ObjKey key, const Mixed& value)
+{
+    StringConversionBuffer buffer;
+    size_t offset = 0;                                                  // First key from beginning of string
+    insert_with_offset(key, mixed_to_index_str(value, buffer), offset); // Throws
+}
+
+void StringIndex::set(ObjKey key, const Mixed& new_value)
+{
+    StringConversionBuffer buffer;
+    do_set(key, mixed_to_index_str(new_value, buffer)); // Throws
+}
+
+ObjKey StringIndex::find_first(const Mixed& value) const
+{
+    StringConversionBuffer buffer;
+    return m_array->index_string_find_first(mixed_to_index_str(value, buffer), m_target_column);
+}
+
+void StringIndex::find_all(std::vector<ObjKey>& result, const Mixed& value) const
+{
+    StringConversionBuffer buffer;
+    m_array->index_string_find_all(result, mixed_to_index_str(value, buffer), m_target_column);
+}
+
+size_t StringIndex::count(const Mixed& value) const
+{
+    StringConversionBuffer buffer;
+    return m_array->index_string_count(mixed_to_index_str(value, buffer), m_target_column);
+}
+
 void StringIndex::clear()
 {
     Array values(m_array->get_alloc());
@@ -24,6 +24,7 @@
 #include <array>
 
 #include <realm/array.hpp>
+#include <realm/search_index.hpp>
 #include <realm/table_cluster_tree.hpp>
 
 /*
@@ -85,6 +86,9 @@ public:
     FindRes index_string_find_all_no_copy(StringData value, const ClusterColumn& column,
                                           InternalFindResult& result) const;
     size_t index_string_count(StringData value, const ClusterColumn& column) const;
+    // Finds the objects whose strings begin with `prefix`. The result is sorted.
+    void index_string_find_all_prefix(std::vector<ObjKey>& result, StringData prefix,
+                                      const ClusterColumn& column) const;
 
 private:
     template <IndexMethod>
@@ -103,22 +107,32 @@ private:
     void index_string_all(StringData value, std::vector<ObjKey>& result, const ClusterColumn& column) const;
 
     void index_string_all_ins(StringData value, std::vector<ObjKey>& result, const ClusterColumn& column) const;
+
+    void prefix_all(const char* header, StringData prefix, size_t offset, std::vector<ObjKey>& result,
+                    const ClusterColumn& column) const;
 };
 
 // 16 is the biggest element size of any non-string/binary Realm type
 constexpr size_t string_conversion_buffer_size = 16;
-using StringConversionBuffer = std::array<char, string_conversion_buffer_size>;
+struct StringConversionBuffer : std::array<char, string_conversion_buffer_size> {
+    // Holds the case folded string when the index is case insensitive
+    std::string folded;
+};
 static_assert(sizeof(UUID::UUIDBytes) <= string_conversion_buffer_size,
               "if you change the size of a UUID then also change the string index buffer space");
 
 // The purpose of this class is to get easy access to fields in a specific column in the
 // cluster. When you have an object like this, you can get a string version of the relevant
 // field based on the key for the object.
+//
+// A case folded column presents its strings in the form they have in a case insensitive StringIndex, see
+// fold_case().
 class ClusterColumn {
 public:
-    ClusterColumn(const TableClusterTree* cluster_tree, ColKey column_key)
+    ClusterColumn(const TableClusterTree* cluster_tree, ColKey column_key, bool case_folded = false)
         : m_cluster_tree(cluster_tree)
         , m_column_key(column_key)
+        , m_case_folded(case_folded)
     {
     }
     size_t size() const
@@ -142,14 +156,28 @@ public:
         return m_column_key;
     }
     bool is_nullable() const;
+    bool is_case_folded() const
+    {
+        return m_case_folded;
+    }
     StringData get_index_data(ObjKey key, StringConversionBuffer& buffer) const;
+    Mixed get_value(ObjKey key) const;
+    Obj get_object(ObjKey key) const
+    {
+        return m_cluster_tree->get(key);
+    }
 
 private:
     const TableClusterTree* m_cluster_tree;
     ColKey m_column_key;
+    bool m_case_folded;
 };
 
-class StringIndex {
+// The key under which a case insensitive StringIndex stores `value`: the string mapped to upper case. The folded
+// string is held by `buffer`. Null is kept as null.
+StringData fold_case(StringData value, StringConversionBuffer& buffer);
+
+class StringIndex : public SearchIndex {
 public:
     StringIndex(const ClusterColumn& target_column, Allocator&);
     StringIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
@@ -157,11 +185,22 @@ public:
     {
     }
 
-    ColKey get_column_key() const
+    IndexType get_index_type() const noexcept override
+    {
+        return is_case_insensitive() ? IndexType::CaseInsensitive : IndexType::General;
+    }
+    ColKey get_column_key() const override
     {
         return m_target_column.get_column_key();
     }
 
+    // A case insensitive index stores the strings case folded (see fold_case()). It is created from a case folded
+    // ClusterColumn, and all lookups in it ignore case.
+    bool is_case_insensitive() const noexcept
+    {
+        return m_target_column.is_case_folded();
+    }
+
     static bool type_supported(realm::DataType type)
     {
         return (type == type_Int || type == type_String || type == type_Bool || type == type_Timestamp ||
@@ -174,15 +213,28 @@ public:
 
     // Accessor concept:
     Allocator& get_alloc() const noexcept;
-    void destroy() noexcept;
+    void destroy() noexcept override;
     void detach();
     bool is_attached() const noexcept;
-    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept override;
     size_t get_ndx_in_parent() const noexcept;
     void set_ndx_in_parent(size_t ndx_in_parent) noexcept;
-    void update_from_parent() noexcept;
-    void refresh_accessor_tree(const ClusterColumn& target_column);
-    ref_type get_ref() const noexcept;
+    void update_from_parent() noexcept override;
+    void refresh_accessor_tree(const ClusterColumn& target_column) override;
+    ref_type get_ref() const noexcept override;
+
+    // SearchIndex interface. The value is stored in the form of the column
+    // type, like the typed functions below do, and hashed only in a column of
+    // type_Mixed.
+
+    void insert(ObjKey key, const Mixed& value) override;
+    void set(ObjKey key, const Mixed& new_value) override;
+    void erase(ObjKey key) override;
+    void clear() override;
+    ObjKey find_first(const Mixed& value) const override;
+    void find_all(std::vector<ObjKey>& result, const Mixed& value) const override;
+    size_t count(const Mixed& value) const override;
+    void verify() const override;
 
     // StringIndex interface:
 
@@ -198,24 +250,21 @@ public:
     template <class T>
     void set(ObjKey key, util::Optional<T> new_value);
 
-    void erase(ObjKey key);
-
     template <class T>
     ObjKey find_first(T value) const;
     template <class T>
     void find_all(std::vector<ObjKey>& result, T value, bool case_insensitive = false) const;
     template <class T>
     FindRes find_all_no_copy(T value, InternalFindResult& result) const;
+    // Finds the objects whose strings begin with `prefix` (after case folding if the index is case insensitive).
+    // Only meaningful for an index over a string column.
+    void find_all_prefix(std::vector<ObjKey>& result, StringData prefix) const;
     template <class T>
     size_t count(T value) const;
     template <class T>
     void update_ref(T value, size_t old_row_ndx, size_t new_row_ndx);
 
-    void clear();
-
     bool has_duplicate_values() const noexcept;
-
-    void verify() const;
 #ifdef REALM_DEBUG
     template <class T>
     void verify_entries(const ClusterColumn& column) const;
@@ -300,6 +349,13 @@ private:
     void do_delete(ObjKey key, StringData, size_t offset);
 
     StringData get(ObjKey key, StringConversionBuffer& buffer) const;
+    // The form in which `value` is stored in this index
+    template <class T>
+    StringData to_index_str(T&& value, StringConversionBuffer& buffer) const;
+    // The form in which `value` is stored in this index, as a value of the
+    // column type
+    StringData mixed_to_index_str(const Mixed& value, StringConversionBuffer& buffer) const;
+    void do_set(ObjKey key, StringData new_value);
 
     void node_add_key(ref_type ref);
 
@@ -410,7 +466,7 @@ template <>
 struct GetIndexData<ObjectId> {
     static StringData get_index_data(ObjectId value, StringConversionBuffer& buffer)
     {
-        memcpy(&buffer, &value, sizeof(ObjectId));
+        memcpy(buffer.data(), &value, sizeof(ObjectId));
         return StringData{buffer.data(), sizeof(ObjectId)};
     }
 };
@@ -519,12 +575,21 @@ inline StringIndex::key_type StringIndex::create_key(StringData str, size_t offs
     return create_key(str.substr(offset));
 }
 
+template <class T>
+inline StringData StringIndex::to_index_str(T&& value, StringConversionBuffer& buffer) const
+{
+    StringData str = to_str(value, buffer);
+    if (m_target_column.is_case_folded())
+        return fold_case(str, buffer);
+    return str;
+}
+
 template <class T>
 void StringIndex::insert(ObjKey key, T value)
 {
     StringConversionBuffer buffer;
-    size_t offset = 0;                                      // First key from beginning of string
-    insert_with_offset(key, to_str(value, buffer), offset); // Throws
+    size_t offset = 0;                                            // First key from beginning of string
+    insert_with_offset(key, to_index_str(value, buffer), offset); // Throws
 }
 
 template <class T>
@@ -542,20 +607,7 @@ template <class T>
 void StringIndex::set(ObjKey key, T new_value)
 {
     StringConversionBuffer buffer;
-    StringConversionBuffer buffer2;
-    StringData old_value = get(key, buffer);
-    StringData new_value2 = to_str(new_value, buffer2);
-
-    // Note that insert_with_offset() throws UniqueConstraintViolation.
-
-    if (REALM_LIKELY(new_value2 != old_value)) {
-        // We must erase this row first because erase uses find_first which
-        // might find the duplicate if we insert before erasing.
-        erase(key); // Throws
-
-        size_t offset = 0;                               // First key from beginning of string
-        insert_with_offset(key, new_value2, offset);     // Throws
-    }
+    do_set(key, to_index_str(new_value, buffer)); // Throws
 }
 
 template <class T>
@@ -574,7 +626,7 @@ ObjKey StringIndex::find_first(T value) const
 {
     // Use direct access method
     StringConversionBuffer buffer;
-    return m_array->index_string_find_first(to_str(value, buffer), m_target_column);
+    return m_array->index_string_find_first(to_index_str(value, buffer), m_target_column);
 }
 
 template <class T>
@@ -582,7 +634,9 @@ void StringIndex::find_all(std::vector<ObjKey>& result, T value, bool case_insen
 {
     // Use direct access method
     StringConversionBuffer buffer;
-    return m_array->index_string_find_all(result, to_str(value, buffer), m_target_column, case_insensitive);
+    // The keys of a case insensitive index are compared as they are
+    return m_array->index_string_find_all(result, to_index_str(value, buffer), m_target_column,
+                                          case_insensitive && !is_case_insensitive());
 }
 
 template <class T>
@@ -590,7 +644,13 @@ FindRes StringIndex::find_all_no_copy(T value, InternalFindResult& result) const
 {
     // Use direct access method
     StringConversionBuffer buffer;
-    return m_array->index_string_find_all_no_copy(to_str(value, buffer), m_target_column, result);
+    return m_array->index_string_find_all_no_copy(to_index_str(value, buffer), m_target_column, result);
+}
+
+inline void StringIndex::find_all_prefix(std::vector<ObjKey>& result, StringData prefix) const
+{
+    StringConversionBuffer buffer;
+    m_array->index_string_find_all_prefix(result, to_index_str(prefix, buffer), m_target_column);
 }
 
 template <class T>
@@ -598,7 +658,7 @@ size_t StringIndex::count(T value) const
 {
     // Use direct access method
     StringConversionBuffer buffer;
-    return m_array->index_string_count(to_str(value, buffer), m_target_column);
+    return m_array->index_string_count(to_index_str(value, buffer), m_target_column);
 }
 
 template <class T>
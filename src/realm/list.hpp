@@ -22,6 +22,7 @@
 #include <realm/collection.hpp>
 
 #include <realm/obj.hpp>
+#include <realm/index_collection.hpp>
 #include <realm/bplustree.hpp>
 #include <realm/obj_list.hpp>
 #include <realm/array_basic.hpp>
@@ -523,18 +524,26 @@ inline void Lst<T>::ensure_created()
 template <class T>
 inline void Lst<T>::do_set(size_t ndx, T value)
 {
+    if (CollectionIndex* index = m_obj.get_collection_index(m_col_key)) {
+        index->erase(m_obj.get_key(), Mixed(m_tree->get(ndx)));
+        index->insert(m_obj.get_key(), Mixed(value));
+    }
     m_tree->set(ndx, value);
 }
 
 template <class T>
 inline void Lst<T>::do_insert(size_t ndx, T value)
 {
+    if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+        index->insert(m_obj.get_key(), Mixed(value));
     m_tree->insert(ndx, value);
 }
 
 template <class T>
 inline void Lst<T>::do_remove(size_t ndx)
 {
+    if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+        index->erase(m_obj.get_key(), Mixed(m_tree->get(ndx)));
     m_tree->erase(ndx);
 }
 
@@ -577,6 +586,8 @@ void Lst<T>::clear()
         if (Replication* repl = this->m_obj.get_replication()) {
             repl->list_clear(*this);
         }
+        if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+            index->erase(m_obj.get_key());
         m_tree->clear();
         bump_content_version();
     }
@@ -28,6 +28,7 @@ TransactionInfo::TransactionInfo(TransactionInfo::TransactionType type)
     , m_type(type)
     , m_num_versions(0)
     , m_num_decrypted_pages(0)
+    , m_num_unflushed_versions(0)
 {
 #if REALM_METRICS
     if (m_type == write_transaction) {
@@ -92,14 +93,21 @@ size_t TransactionInfo::get_num_decrypted_pages() const
     return m_num_decrypted_pages;
 }
 
+size_t TransactionInfo::get_num_unflushed_versions() const
+{
+    return m_num_unflushed_versions;
+}
+
 void TransactionInfo::update_stats(size_t disk_size, size_t free_space, size_t total_objects,
-                                   size_t available_versions, size_t num_decrypted_pages)
+                                   size_t available_versions, size_t num_decrypted_pages,
+                                   size_t num_unflushed_versions)
 {
     m_realm_disk_size = disk_size;
     m_realm_free_space = free_space;
     m_total_objects = total_objects;
     m_num_versions = available_versions;
     m_num_decrypted_pages = num_decrypted_pages;
+    m_num_unflushed_versions = num_unflushed_versions;
 }
 
 void TransactionInfo::finish_timer()
@@ -47,6 +47,8 @@ public:
     size_t get_total_objects() const;
     size_t get_num_available_versions() const;
     size_t get_num_decrypted_pages() const;
+    // the number of committed versions which were not yet durable, see DB::get_number_of_unflushed_versions()
+    size_t get_num_unflushed_versions() const;
 
 private:
     MetricTimerResult m_transaction_time;
@@ -60,10 +62,11 @@ private:
     TransactionType m_type;
     size_t m_num_versions;
     size_t m_num_decrypted_pages;
+    size_t m_num_unflushed_versions;
 
     friend class Metrics;
     void update_stats(size_t disk_size, size_t free_space, size_t total_objects, size_t available_versions,
-                      size_t num_decrypted_pages);
+                      size_t num_decrypted_pages, size_t num_unflushed_versions);
     void finish_timer();
 };
 
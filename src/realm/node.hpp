@@ -336,12 +336,12 @@ protected:
     static void init_header(char* header, bool is_inner_bptree_node, bool has_refs, bool context_flag,
                             WidthType width_type, int width, size_t size, size_t capacity) noexcept;
 
+    virtual void do_copy_on_write(size_t minimum_size = 0);
+
 private:
     ArrayParent* m_parent = nullptr;
     size_t m_ndx_in_parent = 0; // Ignored if m_parent is null.
     bool m_missing_parent_update = false;
-
-    void do_copy_on_write(size_t minimum_size = 0);
 };
 
 class Spec;
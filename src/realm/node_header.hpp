@@ -21,6 +21,9 @@
 
 #include <realm/util/assert.hpp>
 
+#include <cstdint>
+#include <cstring>
+
 namespace realm {
 
 const size_t max_array_size = 0x00ffffffL;            // Maximum number of elements in an array
@@ -52,6 +55,13 @@ public:
         wtype_Bits = 0,     // width indicates how many bits every element occupies
         wtype_Multiply = 1, // width indicates how many bytes every element occupies
         wtype_Ignore = 2,   // each element is 1 byte
+        // Like wtype_Bits, but element i is stored as its offset from
+        // base + i * step. The step and the base are 64-bit values stored in
+        // the last 16 bytes of the node, in that order. A step of zero is plain
+        // frame-of-reference encoding. A nonzero step is only used for arrays
+        // whose elements are in ascending order, which stay ordered. Only
+        // written to the file, see Array::write().
+        wtype_FrameOfReference = 3,
     };
 
     static const int header_size = 8; // Number of bytes used by header
@@ -116,6 +126,26 @@ public:
         return (size_t(h[5]) << 16) + (size_t(h[6]) << 8) + h[7];
     }
 
+    /// The base that must be added to every element of a node whose width
+    /// type is wtype_FrameOfReference.
+    static int64_t get_base_from_header(const char* header) noexcept
+    {
+        REALM_ASSERT_DEBUG(get_wtype_from_header(header) == wtype_FrameOfReference);
+        int64_t base;
+        std::memcpy(&base, header + get_byte_size_from_header(header) - sizeof(base), sizeof(base));
+        return base;
+    }
+
+    /// The step that must be added to every element of a node whose width
+    /// type is wtype_FrameOfReference, multiplied by the index of the element.
+    static int64_t get_step_from_header(const char* header) noexcept
+    {
+        REALM_ASSERT_DEBUG(get_wtype_from_header(header) == wtype_FrameOfReference);
+        int64_t step;
+        std::memcpy(&step, header + get_byte_size_from_header(header) - 2 * sizeof(step), sizeof(step));
+        return step;
+    }
+
     static size_t get_capacity_from_header(const char* header) noexcept
     {
         typedef unsigned char uchar;
@@ -159,6 +189,7 @@ public:
         // 0: bits      (width/8) * size
         // 1: multiply  width * size
         // 2: ignore    1 * size
+        // 3: frame of reference (width/8) * size + 8
         typedef unsigned char uchar;
         uchar* h = reinterpret_cast<uchar*>(header);
         h[4] = uchar((int(h[4]) & ~0x18) | int(value) << 3);
@@ -229,6 +260,12 @@ public:
             case wtype_Ignore:
                 num_bytes = size;
                 break;
+            case wtype_FrameOfReference: {
+                REALM_ASSERT_3(size, <, 0x1000000);
+                size_t num_bits = size * width;
+                num_bytes = ((num_bits + 7) >> 3) + 2 * sizeof(int64_t);
+                break;
+            }
         }
 
         // Ensure 8-byte alignment
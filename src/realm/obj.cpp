@@ -32,6 +32,8 @@
 #include "realm/array_typed_link.hpp"
 #include "realm/column_type_traits.hpp"
 #include "realm/index_string.hpp"
+#include "realm/index_range.hpp"
+#include "realm/index_fulltext.hpp"
 #include "realm/cluster_tree.hpp"
 #include "realm/spec.hpp"
 #include "realm/set.hpp"
@@ -95,6 +97,11 @@ const Spec& Obj::get_spec() const
     return m_table.unchecked_ptr()->m_spec;
 }
 
+CollectionIndex* Obj::get_collection_index(ColKey col_key) const
+{
+    return m_table.unchecked_ptr()->get_collection_index(col_key);
+}
+
 Replication* Obj::get_replication() const
 {
     return m_table->get_repl();
@@ -327,6 +334,8 @@ int64_t Obj::_get<int64_t>(ColKey::Idx col_ndx) const
 
     ref_type ref = to_ref(Array::get(m_mem.get_addr(), col_ndx.val + 1));
     char* header = alloc.translate(ref);
+    if (REALM_UNLIKELY(Array::get_wtype_from_header(header) == Array::wtype_FrameOfReference))
+        return Array::get(header, m_row_ndx);
     int width = Array::get_width_from_header(header);
     char* data = Array::get_data_from_header(header);
     REALM_TEMPEX(return get_direct, width, (data, m_row_ndx));
@@ -1317,9 +1326,10 @@ Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
 
     ensure_writeable();
 
-    if (StringIndex* index = m_table->get_search_index(col_key)) {
-        index->set<int64_t>(m_key, value);
+    if (SearchIndex* index = m_table->get_index(col_key)) {
+        index->set(m_key, value);
     }
+    m_table->set_in_composite_indexes(m_key, col_key, value);
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -1377,9 +1387,10 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
         util::Optional<int64_t> old = values.get(m_row_ndx);
         if (old) {
             auto new_val = add_wrap(*old, value);
-            if (StringIndex* index = m_table->get_search_index(col_key)) {
-                index->set<int64_t>(m_key, new_val);
+            if (SearchIndex* index = m_table->get_index(col_key)) {
+                index->set(m_key, new_val);
             }
+            m_table->set_in_composite_indexes(m_key, col_key, new_val);
             values.set(m_row_ndx, new_val);
         }
         else {
@@ -1392,9 +1403,10 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
         values.init_from_parent();
         int64_t old = values.get(m_row_ndx);
         auto new_val = add_wrap(old, value);
-        if (StringIndex* index = m_table->get_search_index(col_key)) {
-            index->set<int64_t>(m_key, new_val);
+        if (SearchIndex* index = m_table->get_index(col_key)) {
+            index->set(m_key, new_val);
         }
+        m_table->set_in_composite_indexes(m_key, col_key, new_val);
         values.set(m_row_ndx, new_val);
     }
 
@@ -1599,9 +1611,10 @@ Obj& Obj::set(ColKey col_key, T value, bool is_default)
 
     ensure_writeable();
 
-    if (StringIndex* index = m_table->get_search_index(col_key)) {
-        index->set<T>(m_key, value);
+    if (SearchIndex* index = m_table->get_index(col_key)) {
+        index->set(m_key, Mixed(value));
     }
+    m_table->set_in_composite_indexes(m_key, col_key, Mixed(value));
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -2090,9 +2103,10 @@ Obj& Obj::set_null(ColKey col_key, bool is_default)
         update_if_needed();
         ensure_writeable();
 
-        if (StringIndex* index = m_table->get_search_index(col_key)) {
-            index->set(m_key, null{});
+        if (SearchIndex* index = m_table->get_index(col_key)) {
+            index->set(m_key, Mixed());
         }
+        m_table->set_in_composite_indexes(m_key, col_key, Mixed());
 
         switch (col_type) {
             case col_type_Int:
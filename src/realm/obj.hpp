@@ -34,6 +34,7 @@ class Replication;
 class TableView;
 class CollectionBase;
 class CascadeState;
+class CollectionIndex;
 class LstBase;
 class SetBase;
 struct GlobalKey;
@@ -314,6 +315,7 @@ private:
     TableRef get_target_table(ColKey col_key) const;
     TableRef get_target_table(ObjLink link) const;
     const Spec& get_spec() const;
+    CollectionIndex* get_collection_index(ColKey col_key) const;
 
     template <typename U>
     U _get(ColKey::Idx col_ndx) const;
@@ -703,7 +703,7 @@ void RealmCoordinator::wake_up_notifier_worker()
     }
 }
 
-void RealmCoordinator::commit_write(Realm& realm)
+void RealmCoordinator::commit_write(Realm& realm, bool commit_to_disk)
 {
     REALM_ASSERT(!m_config.immutable());
     REALM_ASSERT(realm.is_in_transaction());
@@ -715,7 +715,7 @@ void RealmCoordinator::commit_write(Realm& realm)
         // skip version
         util::CheckedLockGuard l(m_notifier_mutex);
 
-        tr.commit_and_continue_as_read();
+        tr.commit_and_continue_as_read(commit_to_disk);
 
         // Don't need to check m_new_notifiers because those don't skip versions
         bool have_notifiers = std::any_of(m_notifiers.begin(), m_notifiers.end(), [&](auto&& notifier) {
@@ -742,6 +742,11 @@ void RealmCoordinator::commit_write(Realm& realm)
     }
 }
 
+void RealmCoordinator::async_sync_to_disk(std::function<void(std::exception_ptr)> callback)
+{
+    m_db->async_sync_to_disk(std::move(callback));
+}
+
 void RealmCoordinator::enable_wait_for_change()
 {
     m_db->enable_wait_for_change();
@@ -186,8 +186,13 @@ public:
     void promote_to_write(Realm& realm) REQUIRES(!m_notifier_mutex);
 
     // Commit a Realm's current write transaction and send notifications to all
-    // other Realm instances for that path, including in other processes
-    void commit_write(Realm& realm) REQUIRES(!m_notifier_mutex);
+    // other Realm instances for that path, including in other processes. If
+    // `commit_to_disk` is false, the commit is not flushed to disk.
+    void commit_write(Realm& realm, bool commit_to_disk = true) REQUIRES(!m_notifier_mutex);
+
+    // Flush all commits to disk on a background thread, and then call
+    // `callback` on that thread
+    void async_sync_to_disk(std::function<void(std::exception_ptr)> callback);
 
     void enable_wait_for_change();
     bool wait_for_change(std::shared_ptr<Transaction> tr);
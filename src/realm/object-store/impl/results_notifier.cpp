@@ -20,6 +20,7 @@
 
 #include <realm/object-store/shared_realm.hpp>
 
+#include <algorithm>
 #include <numeric>
 
 using namespace realm;
@@ -73,6 +74,8 @@ void ResultsNotifier::release_data() noexcept
 {
     m_query = {};
     m_run_tv = {};
+    m_matches = {};
+    m_matches_are_current = false;
     m_handover_tv = {};
     m_handover_transaction = {};
     m_delivered_tv = {};
@@ -109,8 +112,11 @@ bool ResultsNotifier::need_to_run()
     {
         auto lock = lock_target();
         // Don't run the query if the results aren't actually going to be used
-        if (!get_realm() || (!have_callbacks() && !m_results_were_used))
+        if (!get_realm() || (!have_callbacks() && !m_results_were_used)) {
+            // The changes made in this version won't be applied to m_matches
+            m_matches_are_current = false;
             return false;
+        }
     }
 
     // If we've run previously, check if we need to rerun
@@ -123,6 +129,55 @@ bool ResultsNotifier::need_to_run()
     return true;
 }
 
+bool ResultsNotifier::can_maintain_matches() const
+{
+    // A plain limit lets find_all() stop early, which beats collecting all matches
+    return m_query->produces_results_in_table_order() &&
+           (!m_descriptor_ordering.will_apply_limit() || m_descriptor_ordering.will_apply_sort() ||
+            m_descriptor_ordering.will_apply_distinct());
+}
+
+bool ResultsNotifier::update_matches()
+{
+    if (!m_matches_are_current || !has_run() || m_info->schema_changed)
+        return false;
+
+    auto& table = m_query->get_table();
+    auto it = m_info->tables.find(table->get_key().value);
+    if (it == m_info->tables.end() || it->second.clear_did_occur())
+        return false;
+    auto& changes = it->second;
+
+    // Evaluating the changed objects one at a time is slower per object than
+    // the query's scan of whole leaves, so rerun the query instead if a large
+    // part of the table has changed
+    size_t changed = changes.insertions_size() + changes.modifications_size();
+    if (changed > 100 && changed > table->size() / 16)
+        return false;
+
+    std::vector<ObjKey> candidates;
+    candidates.reserve(changed);
+    for (auto key : changes.get_insertions())
+        candidates.push_back(ObjKey(key));
+    for (auto& modification : changes.get_modifications())
+        candidates.push_back(ObjKey(modification.first));
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    auto is_stale = [&](ObjKey key) {
+        return changes.deletions_contains(key.value) ||
+               std::binary_search(candidates.begin(), candidates.end(), key);
+    };
+    if (!changes.deletions_empty() || !candidates.empty())
+        m_matches.erase(std::remove_if(m_matches.begin(), m_matches.end(), is_stale), m_matches.end());
+
+    auto matching = m_query->find_matching(candidates);
+    size_t unchanged = m_matches.size();
+    m_matches.insert(m_matches.end(), matching.begin(), matching.end());
+    std::inplace_merge(m_matches.begin(), m_matches.begin() + unchanged, m_matches.end());
+    return true;
+}
+
 void ResultsNotifier::calculate_changes()
 {
     if (has_run() && have_callbacks()) {
@@ -151,6 +206,8 @@ void ResultsNotifier::run()
         m_change = {};
         m_change.deletions.set(m_previous_rows.size());
         m_previous_rows.clear();
+        m_matches.clear();
+        m_matches_are_current = false;
         return;
     }
 
@@ -158,11 +215,29 @@ void ResultsNotifier::run()
         return;
 
     m_query->sync_view_if_needed();
-    m_run_tv = m_query->find_all();
-    m_run_tv.apply_descriptor_ordering(m_descriptor_ordering);
+    if (update_matches()) {
+        m_run_tv = m_query->find_all(m_matches, m_descriptor_ordering);
+    }
+    else if (can_maintain_matches()) {
+        m_run_tv = m_query->find_all();
+        m_matches.resize(m_run_tv.size());
+        for (size_t i = 0; i < m_run_tv.size(); ++i)
+            m_matches[i] = m_run_tv.get_key(i);
+        if (!m_descriptor_ordering.is_empty())
+            m_run_tv = m_query->find_all(m_matches, m_descriptor_ordering);
+    }
+    else {
+        m_run_tv = m_query->find_all(m_descriptor_ordering);
+    }
     m_run_tv.sync_if_needed();
     m_last_seen_version = m_run_tv.ObjList::get_dependency_versions();
 
+    // The matches can only be patched using the change info for this table if
+    // nothing else can affect the results
+    m_matches_are_current = can_maintain_matches() && m_last_seen_version.size() == 1;
+    if (!m_matches_are_current)
+        m_matches.clear();
+
     calculate_changes();
 }
 
@@ -67,10 +67,21 @@ private:
     // The rows from the previous run of the query, for calculating diffs
     std::vector<int64_t> m_previous_rows;
 
+    // The keys of all objects matching the query as of m_last_seen_version,
+    // in table order and before the descriptor ordering is applied. Lets
+    // subsequent runs re-evaluate only the objects reported as changed by the
+    // transaction log instead of running the query over the whole table.
+    std::vector<ObjKey> m_matches;
+    // False if m_matches can't be patched, either because the query depends
+    // on other tables or because a version was skipped without running
+    bool m_matches_are_current = false;
+
     TransactionChangeInfo* m_info = nullptr;
     bool m_results_were_used = true;
 
     bool need_to_run();
+    bool can_maintain_matches() const;
+    bool update_matches();
     void calculate_changes();
 
     void run() override;
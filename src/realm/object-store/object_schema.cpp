@@ -147,7 +147,7 @@ ObjectSchema::ObjectSchema(Group const& group, StringData name, TableKey key)
         Property property;
         property.name = column_name;
         property.type = ObjectSchema::from_core_type(col_key);
-        property.is_indexed = table->has_search_index(col_key) || pk_col == col_key;
+        property.is_indexed = table->search_index_type(col_key) != IndexType::None || pk_col == col_key;
         property.column_key = col_key;
 
         if (property.type == PropertyType::Object) {
@@ -161,6 +161,13 @@ ObjectSchema::ObjectSchema(Group const& group, StringData name, TableKey key)
     if (pk_col)
         primary_key = table->get_column_name(pk_col);
     set_primary_key_property();
+
+    for (auto& columns : table->get_composite_indexes()) {
+        std::vector<std::string> names;
+        for (auto col_key : columns)
+            names.push_back(table->get_column_name(col_key));
+        composite_indexes.push_back(std::move(names));
+    }
 }
 
 Property* ObjectSchema::property_for_name(StringData name) noexcept
@@ -389,6 +396,27 @@ void ObjectSchema::validate(Schema const& schema, std::vector<ObjectSchemaValida
         exceptions.emplace_back("Specified primary key '%1.%2' does not exist.", name, primary_key);
     }
 
+    // Validate composite indexes
+    for (auto const& names : composite_indexes) {
+        if (names.size() < 2 || names.size() > 4) {
+            exceptions.emplace_back("Composite index on '%1' must have between 2 and 4 properties.", name);
+            continue;
+        }
+        for (auto it = names.begin(); it != names.end(); ++it) {
+            auto prop = property_for_name(*it);
+            if (!prop || property_is_computed(*prop)) {
+                exceptions.emplace_back("Property '%1.%2' of composite index does not exist.", name, *it);
+            }
+            else if (!prop->type_is_indexable() || is_collection(prop->type) || prop->type == PropertyType::UUID) {
+                exceptions.emplace_back("Property '%1.%2' of type '%3' cannot be part of a composite index.", name,
+                                        *it, string_for_property_type(prop->type));
+            }
+            else if (std::find(names.begin(), it, *it) != it) {
+                exceptions.emplace_back("Property '%1.%2' appears more than once in a composite index.", name, *it);
+            }
+        }
+    }
+
     if (for_sync && !is_embedded) {
         if (primary_key.empty()) {
             exceptions.emplace_back(util::format("There must be a primary key property named '_id' on a synchronized "
@@ -406,7 +434,8 @@ void ObjectSchema::validate(Schema const& schema, std::vector<ObjectSchemaValida
 namespace realm {
 bool operator==(ObjectSchema const& a, ObjectSchema const& b) noexcept
 {
-    return std::tie(a.name, a.is_embedded, a.primary_key, a.persisted_properties, a.computed_properties) ==
-           std::tie(b.name, b.is_embedded, b.primary_key, b.persisted_properties, b.computed_properties);
+    return std::tie(a.name, a.is_embedded, a.primary_key, a.persisted_properties, a.computed_properties,
+                    a.composite_indexes) == std::tie(b.name, b.is_embedded, b.primary_key, b.persisted_properties,
+                                                     b.computed_properties, b.composite_indexes);
 }
 } // namespace realm
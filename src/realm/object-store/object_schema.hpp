@@ -63,6 +63,8 @@ public:
     std::string primary_key;
     TableKey table_key;
     IsEmbedded is_embedded = false;
+    // The names of the properties of each composite index, in index order
+    std::vector<std::vector<std::string>> composite_indexes;
 
     Property* property_for_public_name(StringData public_name) noexcept;
     const Property* property_for_public_name(StringData public_name) const noexcept;
@@ -176,6 +176,25 @@ TableRef create_table(Group& group, ObjectSchema const& object_schema)
     return table;
 }
 
+std::vector<ColKey> composite_index_columns(Table& table, std::vector<std::string> const& properties)
+{
+    std::vector<ColKey> columns;
+    for (auto& name : properties)
+        columns.push_back(table.get_column_key(name));
+    return columns;
+}
+
+std::string join_names(std::vector<std::string> const& names)
+{
+    std::string result;
+    for (auto& name : names) {
+        if (!result.empty())
+            result += ", ";
+        result += name;
+    }
+    return result;
+}
+
 void add_initial_columns(Group& group, ObjectSchema const& object_schema)
 {
     auto name = ObjectStore::table_name_for_object_type(object_schema.name);
@@ -189,6 +208,8 @@ void add_initial_columns(Group& group, ObjectSchema const& object_schema)
 #endif // REALM_ENABLE_SYNC
         add_column(group, *table, prop);
     }
+    for (auto const& properties : object_schema.composite_indexes)
+        table->add_composite_index(composite_index_columns(*table, properties));
 }
 
 void make_property_optional(Table& table, Property property)
@@ -215,6 +236,16 @@ void remove_search_index(Table& table, Property property)
     table.remove_search_index(table.get_column_key(property.name));
 }
 
+void add_composite_index(Table& table, std::vector<std::string> const& properties)
+{
+    table.add_composite_index(composite_index_columns(table, properties));
+}
+
+void remove_composite_index(Table& table, std::vector<std::string> const& properties)
+{
+    table.remove_composite_index(composite_index_columns(table, properties));
+}
+
 } // anonymous namespace
 
 void ObjectStore::set_schema_version(Group& group, uint64_t version)
@@ -354,6 +385,18 @@ struct SchemaDifferenceExplainer {
     {
         errors.emplace_back("Property '%1.%2' has been made unindexed.", op.object->name, op.property->name);
     }
+
+    void operator()(schema_change::AddCompositeIndex op)
+    {
+        errors.emplace_back("Composite index on '%1' (%2) has been added.", op.object->name,
+                            join_names(*op.properties));
+    }
+
+    void operator()(schema_change::RemoveCompositeIndex op)
+    {
+        errors.emplace_back("Composite index on '%1' (%2) has been removed.", op.object->name,
+                            join_names(*op.properties));
+    }
 };
 
 class TableHelper {
@@ -440,6 +483,14 @@ bool ObjectStore::needs_migration(std::vector<SchemaChange> const& changes)
         {
             return false;
         }
+        bool operator()(AddCompositeIndex)
+        {
+            return false;
+        }
+        bool operator()(RemoveCompositeIndex)
+        {
+            return false;
+        }
         bool operator()(RemoveProperty)
         {
             return true;
@@ -468,6 +519,8 @@ void ObjectStore::verify_no_migration_required(std::vector<SchemaChange> const&
         void operator()(AddInitialProperties) {}
         void operator()(AddIndex) {}
         void operator()(RemoveIndex) {}
+        void operator()(AddCompositeIndex) {}
+        void operator()(RemoveCompositeIndex) {}
     } verifier;
     verify_no_errors<SchemaMismatchException>(verifier, changes);
 }
@@ -503,6 +556,14 @@ bool ObjectStore::verify_valid_additive_changes(std::vector<SchemaChange> const&
         {
             index_changes = true;
         }
+        void operator()(AddCompositeIndex)
+        {
+            index_changes = true;
+        }
+        void operator()(RemoveCompositeIndex)
+        {
+            index_changes = true;
+        }
     } verifier;
     verify_no_errors<InvalidAdditiveSchemaChangeException>(verifier, changes);
     return verifier.other_changes || (verifier.index_changes && update_indexes);
@@ -520,6 +581,8 @@ void ObjectStore::verify_valid_external_changes(std::vector<SchemaChange> const&
         void operator()(AddProperty) {}
         void operator()(AddIndex) {}
         void operator()(RemoveIndex) {}
+        void operator()(AddCompositeIndex) {}
+        void operator()(RemoveCompositeIndex) {}
 
         // Deleting tables is not okay
         void operator()(RemoveTable op)
@@ -542,6 +605,8 @@ void ObjectStore::verify_compatible_for_immutable_and_readonly(std::vector<Schem
         void operator()(RemoveProperty) {}
         void operator()(AddIndex) {}
         void operator()(RemoveIndex) {}
+        void operator()(AddCompositeIndex) {}
+        void operator()(RemoveCompositeIndex) {}
     } verifier;
     verify_no_errors<InvalidReadOnlySchemaChangeException>(verifier, changes);
 }
@@ -578,6 +643,14 @@ static void apply_non_migration_changes(Group& group, std::vector<SchemaChange>
         {
             table(op.object).remove_search_index(op.property->column_key);
         }
+        void operator()(AddCompositeIndex op)
+        {
+            add_composite_index(table(op.object), *op.properties);
+        }
+        void operator()(RemoveCompositeIndex op)
+        {
+            remove_composite_index(table(op.object), *op.properties);
+        }
     } applier{group};
     verify_no_errors<SchemaMismatchException>(applier, changes);
 }
@@ -652,6 +725,14 @@ static void create_initial_tables(Group& group, std::vector<SchemaChange> const&
         {
             remove_search_index(table(op.object), *op.property);
         }
+        void operator()(AddCompositeIndex op)
+        {
+            add_composite_index(table(op.object), *op.properties);
+        }
+        void operator()(RemoveCompositeIndex op)
+        {
+            remove_composite_index(table(op.object), *op.properties);
+        }
 
         void operator()(ChangePropertyType op)
         {
@@ -701,6 +782,16 @@ void ObjectStore::apply_additive_changes(Group& group, std::vector<SchemaChange>
             if (update_indexes)
                 table(op.object).remove_search_index(op.property->column_key);
         }
+        void operator()(AddCompositeIndex op)
+        {
+            if (update_indexes)
+                add_composite_index(table(op.object), *op.properties);
+        }
+        void operator()(RemoveCompositeIndex op)
+        {
+            if (update_indexes)
+                remove_composite_index(table(op.object), *op.properties);
+        }
         void operator()(RemoveProperty) {}
 
         // No need for errors for these, as we've already verified that they aren't present
@@ -772,6 +863,14 @@ static void apply_pre_migration_changes(Group& group, std::vector<SchemaChange>
         {
             remove_search_index(table(op.object), *op.property);
         }
+        void operator()(AddCompositeIndex op)
+        {
+            add_composite_index(table(op.object), *op.properties);
+        }
+        void operator()(RemoveCompositeIndex op)
+        {
+            remove_composite_index(table(op.object), *op.properties);
+        }
     } applier{group};
 
     for (auto& change : changes) {
@@ -844,6 +943,14 @@ static void apply_post_migration_changes(Group& group, std::vector<SchemaChange>
         {
             table(op.object).remove_search_index(op.property->column_key);
         }
+        void operator()(AddCompositeIndex op)
+        {
+            add_composite_index(table(op.object), *op.properties);
+        }
+        void operator()(RemoveCompositeIndex op)
+        {
+            remove_composite_index(table(op.object), *op.properties);
+        }
 
         void operator()(ChangeTableType) {}
         void operator()(RemoveTable) {}
@@ -947,7 +1054,7 @@ util::Optional<Property> ObjectStore::property_for_column_key(ConstTableRef& tab
     property.name = column_name;
     property.type = ObjectSchema::from_core_type(column_key);
     property.is_primary = table->get_primary_key_column() == column_key;
-    property.is_indexed = table->has_search_index(column_key);
+    property.is_indexed = table->search_index_type(column_key) != IndexType::None;
     property.column_key = column_key;
 
     if (property.type == PropertyType::Object) {
@@ -319,9 +319,13 @@ inline Property::Property(std::string name, PropertyType type, std::string objec
 
 inline bool Property::type_is_indexable() const noexcept
 {
-    return !is_collection(type) &&
-           (type == PropertyType::Int || type == PropertyType::Bool || type == PropertyType::Date ||
-            type == PropertyType::String || type == PropertyType::ObjectId || type == PropertyType::UUID);
+    auto base_type = type & ~PropertyType::Flags;
+    // The values of a dictionary of mixed are indexed as well, except for links
+    if (is_dictionary(type) && base_type == PropertyType::Mixed)
+        return true;
+    return (base_type == PropertyType::Int || base_type == PropertyType::Bool || base_type == PropertyType::Date ||
+            base_type == PropertyType::String || base_type == PropertyType::ObjectId ||
+            base_type == PropertyType::UUID);
 }
 
 inline bool Property::type_is_nullable() const noexcept
@@ -463,6 +463,17 @@ size_t Results::index_of(Query&& q)
     return row ? index_of(const_cast<Table&>(*m_table).get_object(row)) : not_found;
 }
 
+bool Results::can_aggregate_on_query(DataType type) const
+{
+    // Sorting does not change the result of an aggregate, but distinct and
+    // limit do. Without them we can let the query engine aggregate whole
+    // cluster leaves instead of first building a TableView and then visiting
+    // each object in it.
+    if (m_descriptor_ordering.will_apply_distinct() || m_descriptor_ordering.will_apply_limit())
+        return false;
+    return type == type_Int || type == type_Double || type == type_Float;
+}
+
 DataType Results::prepare_for_aggregate(ColKey column, const char* name)
 {
     DataType type;
@@ -478,6 +489,12 @@ DataType Results::prepare_for_aggregate(ColKey column, const char* name)
             m_mode = Mode::Query;
             REALM_FALLTHROUGH;
         case Mode::Query:
+            type = m_table->get_column_type(column);
+            if (can_aggregate_on_query(type)) {
+                m_query.sync_view_if_needed();
+                break;
+            }
+            REALM_FALLTHROUGH;
         case Mode::TableView:
             do_evaluate_query_if_needed();
             type = m_table->get_column_type(column);
@@ -691,6 +708,23 @@ Mixed call_with_helper(Func&& func, Table&& table, DataType type)
     }
 }
 
+// Only the types which the query engine can aggregate leaf by leaf are
+// passed on to the query, see Results::can_aggregate_on_query()
+template <typename Func>
+Mixed call_with_query_helper(Func&& func, Query& query, DataType type)
+{
+    switch (type) {
+        case type_Double:
+            return func(AggregateHelper<double, Query&>{query});
+        case type_Float:
+            return func(AggregateHelper<Float, Query&>{query});
+        case type_Int:
+            return func(AggregateHelper<Int, Query&>{query});
+        default:
+            REALM_COMPILER_HINT_UNREACHABLE();
+    }
+}
+
 struct ReturnIndexHelper {
     ObjKey key;
     size_t index = npos;
@@ -723,6 +757,8 @@ util::Optional<Mixed> Results::aggregate(ColKey column, const char* name, Aggreg
             return call_with_helper(func, *m_table, type);
         case Mode::List:
             return call_with_helper(func, *m_collection, type);
+        case Mode::Query:
+            return call_with_query_helper(func, m_query, type);
         default:
             return call_with_helper(func, m_table_view, type);
     }
@@ -167,6 +167,8 @@ void Schema::validate(bool for_sync) const
 static void compare(ObjectSchema const& existing_schema, ObjectSchema const& target_schema,
                     std::vector<SchemaChange>& changes)
 {
+    // Properties whose column is recreated, which drops the composite indexes including them
+    std::unordered_set<std::string> recreated_properties;
     for (auto& current_prop : existing_schema.persisted_properties) {
         auto target_prop = target_schema.property_for_name(current_prop.name);
 
@@ -184,11 +186,14 @@ static void compare(ObjectSchema const& existing_schema, ObjectSchema const& tar
             is_dictionary(current_prop.type) != is_dictionary(target_prop->type)) {
 
             changes.emplace_back(schema_change::ChangePropertyType{&existing_schema, &current_prop, target_prop});
+            recreated_properties.insert(current_prop.name);
             continue;
         }
         if (is_nullable(current_prop.type) != is_nullable(target_prop->type)) {
-            if (is_nullable(current_prop.type))
+            if (is_nullable(current_prop.type)) {
                 changes.emplace_back(schema_change::MakePropertyRequired{&existing_schema, &current_prop});
+                recreated_properties.insert(current_prop.name);
+            }
             else
                 changes.emplace_back(schema_change::MakePropertyNullable{&existing_schema, &current_prop});
         }
@@ -210,6 +215,21 @@ static void compare(ObjectSchema const& existing_schema, ObjectSchema const& tar
     if (existing_schema.primary_key != target_schema.primary_key) {
         changes.emplace_back(schema_change::ChangePrimaryKey{&existing_schema, target_schema.primary_key_property()});
     }
+
+    auto& existing_indexes = existing_schema.composite_indexes;
+    auto& target_indexes = target_schema.composite_indexes;
+    for (auto& current_index : existing_indexes) {
+        if (std::find(target_indexes.begin(), target_indexes.end(), current_index) == target_indexes.end())
+            changes.emplace_back(schema_change::RemoveCompositeIndex{&existing_schema, &current_index});
+    }
+    for (auto& target_index : target_indexes) {
+        bool recreated = std::any_of(target_index.begin(), target_index.end(), [&](const std::string& name) {
+            return recreated_properties.count(name) != 0;
+        });
+        if (recreated ||
+            std::find(existing_indexes.begin(), existing_indexes.end(), target_index) == existing_indexes.end())
+            changes.emplace_back(schema_change::AddCompositeIndex{&existing_schema, &target_index});
+    }
 }
 
 template <typename T, typename U, typename Func>
@@ -305,6 +325,7 @@ bool operator==(SchemaChange const& lft, SchemaChange const& rgt) noexcept
         return cmp(value.type) == cmp(rgt);                                                                          \
     }
 
+        REALM_SC_COMPARE(AddCompositeIndex, v.object, v.properties)
         REALM_SC_COMPARE(AddIndex, v.object, v.property)
         REALM_SC_COMPARE(AddProperty, v.object, v.property)
         REALM_SC_COMPARE(AddInitialProperties, v.object)
@@ -315,6 +336,7 @@ bool operator==(SchemaChange const& lft, SchemaChange const& rgt) noexcept
         REALM_SC_COMPARE(ChangePropertyType, v.object, v.old_property, v.new_property)
         REALM_SC_COMPARE(MakePropertyNullable, v.object, v.property)
         REALM_SC_COMPARE(MakePropertyRequired, v.object, v.property)
+        REALM_SC_COMPARE(RemoveCompositeIndex, v.object, v.properties)
         REALM_SC_COMPARE(RemoveIndex, v.object, v.property)
         REALM_SC_COMPARE(RemoveProperty, v.object, v.property)
 
@@ -138,12 +138,23 @@ struct ChangePrimaryKey {
     const ObjectSchema* object;
     const Property* property;
 };
+
+struct AddCompositeIndex {
+    const ObjectSchema* object;
+    const std::vector<std::string>* properties;
+};
+
+struct RemoveCompositeIndex {
+    const ObjectSchema* object;
+    const std::vector<std::string>* properties;
+};
 } // namespace schema_change
 
 #define REALM_FOR_EACH_SCHEMA_CHANGE_TYPE(macro)                                                                     \
     macro(AddTable) macro(RemoveTable) macro(ChangeTableType) macro(AddInitialProperties) macro(AddProperty)         \
         macro(RemoveProperty) macro(ChangePropertyType) macro(MakePropertyNullable) macro(MakePropertyRequired)      \
-            macro(AddIndex) macro(RemoveIndex) macro(ChangePrimaryKey)
+            macro(AddIndex) macro(RemoveIndex) macro(ChangePrimaryKey) macro(AddCompositeIndex)                  \
+                macro(RemoveCompositeIndex)
 
 class SchemaChange {
 public:
@@ -640,18 +640,103 @@ void Realm::commit_transaction()
         throw InvalidTransactionException("Can't commit a non-existing write transaction");
     }
 
+    do_commit_transaction(true);
+}
+
+void Realm::do_commit_transaction(bool commit_to_disk)
+{
     if (auto audit = audit_context()) {
         auto prev_version = transaction().get_version_of_current_transaction();
-        m_coordinator->commit_write(*this);
+        m_coordinator->commit_write(*this, commit_to_disk);
         audit->record_write(prev_version, transaction().get_version_of_current_transaction());
         // m_shared_group->unpin_version(prev_version);
     }
     else {
-        m_coordinator->commit_write(*this);
+        m_coordinator->commit_write(*this, commit_to_disk);
     }
     cache_new_schema();
 }
 
+std::function<void(std::function<void()>)> Realm::make_async_completion_poster()
+{
+    // Runs on the helper thread of the DB, so it must not keep the Realm alive
+    return [queue = m_async_completions, scheduler = m_scheduler](std::function<void()> completion) {
+        {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->completions.push_back(std::move(completion));
+        }
+        scheduler->notify();
+    };
+}
+
+void Realm::run_async_completions()
+{
+    std::vector<std::function<void()>> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_async_completions->mutex);
+        completions.swap(m_async_completions->completions);
+    }
+    for (auto& completion : completions)
+        completion();
+}
+
+void Realm::async_begin_transaction(std::function<void()> callback)
+{
+    verify_thread();
+    check_can_create_write_transaction(this);
+    if (!can_deliver_notifications()) {
+        throw InvalidTransactionException("Asynchronous transactions require a scheduler which can deliver "
+                                          "notifications");
+    }
+    if (is_in_transaction()) {
+        throw InvalidTransactionException("The Realm is already in a write transaction");
+    }
+
+    read_group();
+    auto post = make_async_completion_poster();
+    transaction().async_request_write_lock(
+        [post = std::move(post), weak_realm = weak_from_this(), callback = std::move(callback)] {
+            post([weak_realm, callback] {
+                auto realm = weak_realm.lock();
+                if (!realm || realm->is_closed())
+                    return;
+                // The lock acquired for us is taken by begin_transaction(),
+                // unless a write transaction was begun in the meantime.
+                if (!realm->is_in_transaction())
+                    realm->begin_transaction();
+                if (callback)
+                    callback();
+            });
+        });
+}
+
+void Realm::async_commit_transaction(std::function<void(std::exception_ptr)> callback)
+{
+    check_can_create_write_transaction(this);
+    verify_thread();
+
+    if (!is_in_transaction()) {
+        throw InvalidTransactionException("Can't commit a non-existing write transaction");
+    }
+    if (!can_deliver_notifications()) {
+        throw InvalidTransactionException("Asynchronous transactions require a scheduler which can deliver "
+                                          "notifications");
+    }
+
+    do_commit_transaction(false);
+    auto post = make_async_completion_poster();
+    m_coordinator->async_sync_to_disk(
+        [post = std::move(post), weak_realm = weak_from_this(), callback = std::move(callback)](
+            std::exception_ptr error) {
+            if (!callback)
+                return;
+            post([weak_realm, callback, error] {
+                if (auto realm = weak_realm.lock(); realm && !realm->is_closed())
+                    callback(error);
+            });
+        });
+}
+
 void Realm::cancel_transaction()
 {
     check_can_create_write_transaction(this);
@@ -724,6 +809,10 @@ OwnedBinaryData Realm::write_copy()
 
 void Realm::notify()
 {
+    if (!is_closed() && !is_frozen()) {
+        verify_thread();
+        run_async_completions();
+    }
     if (is_closed() || is_in_transaction() || is_frozen()) {
         return;
     }
@@ -27,6 +27,7 @@
 #include <realm/version_id.hpp>
 
 #include <memory>
+#include <mutex>
 
 namespace realm {
 class AsyncOpenTask;
@@ -294,6 +295,19 @@ public:
     void cancel_transaction();
     bool is_in_transaction() const noexcept;
 
+    // Asynchronous write transactions. These require a scheduler which can
+    // deliver notifications, as the callbacks are invoked on this Realm's
+    // scheduler.
+    //
+    // async_begin_transaction() acquires the write lock without blocking the
+    // calling thread, and then calls `callback` with the Realm in a write
+    // transaction. async_commit_transaction() commits the current write
+    // transaction without waiting for the changes to be flushed to disk, and
+    // calls `callback` (if any) once they have been, passing the error which
+    // occurred while flushing, if any.
+    void async_begin_transaction(std::function<void()> callback);
+    void async_commit_transaction(std::function<void(std::exception_ptr)> callback = nullptr);
+
     // Returns a frozen copy for the current version of this Realm
     SharedRealm freeze();
 
@@ -448,6 +462,17 @@ private:
     // primary key values)
     bool m_in_migration = false;
 
+    // Completions of asynchronous write transactions, posted by the helper
+    // thread of the DB and run on this Realm's scheduler by notify()
+    struct AsyncCompletionQueue {
+        std::mutex mutex;
+        std::vector<std::function<void()>> completions;
+    };
+    std::shared_ptr<AsyncCompletionQueue> m_async_completions = std::make_shared<AsyncCompletionQueue>();
+    std::function<void(std::function<void()>)> make_async_completion_poster();
+    void run_async_completions();
+    void do_commit_transaction(bool commit_to_disk);
+
     void begin_read(VersionID);
     bool do_refresh();
 
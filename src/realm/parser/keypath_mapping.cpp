@@ -18,6 +18,10 @@
 
 #include "keypath_mapping.hpp"
 
+#include <realm/exceptions.hpp>
+#include <realm/group.hpp>
+
+#include <algorithm>
 #include <functional>
 
 namespace realm {
@@ -43,6 +47,7 @@ bool KeyPathMapping::add_mapping(ConstTableRef table, std::string name, std::str
 {
     if (m_mapping.find({table, name}) == m_mapping.end()) {
         m_mapping[{table, name}] = alias;
+        ++m_version;
         return true;
     }
     return false;
@@ -53,6 +58,7 @@ void KeyPathMapping::remove_mapping(ConstTableRef table, std::string name)
     auto it = m_mapping.find({table, name});
     REALM_ASSERT_DEBUG(it != m_mapping.end());
     m_mapping.erase(it);
+    ++m_version;
 }
 
 bool KeyPathMapping::has_mapping(ConstTableRef table, std::string name)
@@ -167,11 +173,86 @@ KeyPathElement KeyPathMapping::process_next_path(ConstTableRef table, KeyPath& k
 void KeyPathMapping::set_allow_backlinks(bool allow)
 {
     m_allow_backlinks = allow;
+    ++m_version;
 }
 
 void KeyPathMapping::set_backlink_class_prefix(std::string prefix)
 {
     m_backlink_class_prefix = prefix;
+    ++m_version;
+}
+
+std::string KeyPathMapping::get_signature() const
+{
+    // Every string is prefixed by its size, so that the parts cannot run into each other
+    auto append = [](std::string& out, const std::string& str) {
+        out += std::to_string(str.size());
+        out += ':';
+        out += str;
+    };
+    std::vector<std::string> entries;
+    for (auto& entry : m_mapping) {
+        std::string str = std::to_string(entry.first.first->get_key().value);
+        append(str, entry.first.second);
+        append(str, entry.second);
+        entries.push_back(std::move(str));
+    }
+    std::sort(entries.begin(), entries.end());
+
+    std::string signature = m_allow_backlinks ? "1" : "0";
+    append(signature, m_backlink_class_prefix);
+    for (auto& str : entries)
+        append(signature, str);
+    return signature;
+}
+
+bool KeyPathCache::get(const Table& table, const KeyPathMapping& mapping, const std::string& key_path,
+                       std::vector<KeyPathElement>& link_chain) const
+{
+    std::vector<Element> elements;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_link_chains.find({table.get_key(), mapping.get_version(), key_path});
+        if (it == m_link_chains.end())
+            return false;
+        elements = it->second;
+    }
+
+    const Group* group = table.get_parent_group();
+    if (!group)
+        return false;
+    std::vector<KeyPathElement> chain;
+    for (auto& element : elements) {
+        ConstTableRef element_table;
+        try {
+            element_table = group->get_table(element.table_key);
+        }
+        catch (const NoSuchTable&) {
+            return false;
+        }
+        if (element_table->get_name() != element.table_name)
+            return false;
+        if (element.col_key && (!element_table->valid_column(element.col_key) ||
+                                element_table->get_column_name(element.col_key) != element.col_name))
+            return false;
+        chain.push_back(KeyPathElement{element_table, element.col_key, element.operation});
+    }
+    link_chain = std::move(chain);
+    return true;
+}
+
+void KeyPathCache::add(const Table& table, const KeyPathMapping& mapping, const std::string& key_path,
+                       const std::vector<KeyPathElement>& link_chain)
+{
+    std::vector<Element> elements;
+    for (auto& element : link_chain) {
+        std::string col_name = element.col_key ? std::string(element.table->get_column_name(element.col_key)) : "";
+        elements.push_back(Element{element.table->get_key(), element.table->get_name(), element.col_key,
+                                   std::move(col_name), element.operation});
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_link_chains[{table.get_key(), mapping.get_version(), key_path}] = std::move(elements);
 }
 
 LinkChain KeyPathMapping::link_chain_getter(ConstTableRef table, const std::vector<KeyPathElement>& links,
@@ -197,9 +278,13 @@ std::vector<KeyPathElement> generate_link_chain_from_string(Query& q, const std:
                                                             KeyPathMapping& mapping)
 {
     ConstTableRef cur_table = q.get_table();
+    std::vector<KeyPathElement> link_chain;
+    KeyPathCache* cache = mapping.get_keypath_cache();
+    if (cache && cache->get(*cur_table, mapping, key_path_string, link_chain))
+        return link_chain;
+
     KeyPath key_path = key_path_from_string(key_path_string);
     size_t index = 0;
-    std::vector<KeyPathElement> link_chain;
     while (index < key_path.size()) {
         KeyPathElement element = mapping.process_next_path(cur_table, key_path, index);
         if (index != key_path.size()) {
@@ -221,6 +306,8 @@ std::vector<KeyPathElement> generate_link_chain_from_string(Query& q, const std:
         }
         link_chain.push_back(element);
     }
+    if (cache)
+        cache->add(*q.get_table(), mapping, key_path_string, link_chain);
     return link_chain;
 }
 
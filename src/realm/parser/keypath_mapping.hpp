@@ -23,8 +23,12 @@
 
 #include "parser_utils.hpp"
 
+#include <map>
+#include <mutex>
 #include <unordered_map>
 #include <string>
+#include <tuple>
+#include <vector>
 
 namespace realm {
 namespace parser {
@@ -48,6 +52,8 @@ public:
     /// runtime_error::what() returns the msg provided in the constructor.
 };
 
+class KeyPathCache;
+
 struct TableAndColHash {
     std::size_t operator()(const std::pair<ConstTableRef, std::string>& p) const;
 };
@@ -73,10 +79,57 @@ public:
     static LinkChain link_chain_getter(ConstTableRef table, const std::vector<KeyPathElement>& links,
                                        ExpressionComparisonType type = ExpressionComparisonType::Any);
 
+    // If set, generate_link_chain_from_string() takes the link chains from the cache, and adds the ones it had to
+    // resolve to it. The cache must only be used with mappings that had the same signature when it was set.
+    void set_keypath_cache(KeyPathCache* cache)
+    {
+        m_keypath_cache = cache;
+    }
+    KeyPathCache* get_keypath_cache() const
+    {
+        return m_keypath_cache;
+    }
+    // Two mappings with the same signature resolve every keypath the same way
+    std::string get_signature() const;
+    // Changes whenever the mapping does, such as when the variable of a subquery is added
+    size_t get_version() const noexcept
+    {
+        return m_version;
+    }
+
 protected:
     bool m_allow_backlinks;
     std::string m_backlink_class_prefix;
     std::unordered_map<std::pair<ConstTableRef, std::string>, std::string, TableAndColHash> m_mapping;
+    KeyPathCache* m_keypath_cache = nullptr;
+    size_t m_version = 0;
+};
+
+// The link chains of the keypaths of a query, as resolved by generate_link_chain_from_string(). The tables and
+// columns on a chain are stored by key along with their names, which are checked before the chain is used. A chain
+// is therefore resolved again if a table or column on its path has been renamed, removed or recreated since. May be
+// used concurrently.
+class KeyPathCache {
+public:
+    // Returns false if the link chain for the keypath starting at `table` has not been added with a mapping of the
+    // same version, or is out of date
+    bool get(const Table& table, const KeyPathMapping& mapping, const std::string& key_path,
+             std::vector<KeyPathElement>& link_chain) const;
+    void add(const Table& table, const KeyPathMapping& mapping, const std::string& key_path,
+             const std::vector<KeyPathElement>& link_chain);
+
+private:
+    struct Element {
+        TableKey table_key;
+        std::string table_name;
+        ColKey col_key;
+        std::string col_name;
+        KeyPathElement::KeyPathOperation operation;
+    };
+
+    mutable std::mutex m_mutex;
+    // By the key of the table the keypath starts at, the version of the mapping and the keypath
+    std::map<std::tuple<TableKey, size_t, std::string>, std::vector<Element>> m_link_chains;
 };
 
 std::vector<KeyPathElement> generate_link_chain_from_string(Query& q, const std::string& key_path_string,
@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2021 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "parse_cache.hpp"
+#include "query_builder.hpp"
+
+namespace realm {
+namespace parser {
+
+QueryTemplate::QueryTemplate(std::shared_ptr<const ParserResult> parsed)
+    : m_parsed(std::move(parsed))
+{
+}
+
+void QueryTemplate::apply(Query& query, query_builder::Arguments& arguments, KeyPathMapping mapping) const
+{
+    mapping.set_keypath_cache(&m_keypaths);
+    query_builder::apply_predicate(query, m_parsed->predicate, arguments, std::move(mapping)); // Throws
+}
+
+ParseCache::ParseCache(size_t capacity)
+    : m_capacity(capacity)
+{
+}
+
+ParseCache& ParseCache::get_default()
+{
+    static ParseCache cache;
+    return cache;
+}
+
+std::shared_ptr<const ParserResult> ParseCache::parse(StringData query)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto result = m_parsed.find(query)) {
+            ++m_hit_count;
+            return *result;
+        }
+        ++m_miss_count;
+    }
+
+    // Parse without holding the lock, so that other queries are not held up
+    auto result = std::make_shared<const ParserResult>(parser::parse(query)); // Throws
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_parsed.find(query))
+        m_parsed.add(std::string(query), result, m_capacity);
+    return result;
+}
+
+std::shared_ptr<const QueryTemplate> ParseCache::get_template(const Table& table, StringData query,
+                                                              const KeyPathMapping& mapping)
+{
+    std::string signature = mapping.get_signature();
+    std::string key = std::to_string(table.get_key().value);
+    key += ':';
+    key += std::to_string(signature.size());
+    key += ':';
+    key += signature;
+    key += query;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto result = m_templates.find(key))
+            return *result;
+    }
+
+    auto result = std::make_shared<const QueryTemplate>(parse(query)); // Throws
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_templates.find(key))
+        m_templates.add(std::move(key), result, m_capacity);
+    return result;
+}
+
+void ParseCache::set_capacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    m_parsed.evict(capacity);
+    m_templates.evict(capacity);
+}
+
+size_t ParseCache::get_capacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+size_t ParseCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_parsed.list.size();
+}
+
+size_t ParseCache::get_num_templates() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_templates.list.size();
+}
+
+void ParseCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_parsed.clear();
+    m_templates.clear();
+    m_hit_count = 0;
+    m_miss_count = 0;
+}
+
+size_t ParseCache::get_hit_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hit_count;
+}
+
+size_t ParseCache::get_miss_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_miss_count;
+}
+
+template <class T>
+T* ParseCache::Entries<T>::find(StringData key)
+{
+    auto it = index.find(key);
+    if (it == index.end())
+        return nullptr;
+    list.splice(list.begin(), list, it->second);
+    return &it->second->second;
+}
+
+template <class T>
+void ParseCache::Entries<T>::add(std::string key, T value, size_t capacity)
+{
+    if (capacity == 0)
+        return;
+    evict(capacity - 1);
+    list.emplace_front(std::move(key), std::move(value));
+    index.emplace(list.front().first, list.begin());
+}
+
+template <class T>
+void ParseCache::Entries<T>::evict(size_t max_size)
+{
+    while (list.size() > max_size) {
+        index.erase(list.back().first);
+        list.pop_back();
+    }
+}
+
+template <class T>
+void ParseCache::Entries<T>::clear()
+{
+    index.clear();
+    list.clear();
+}
+
+} // namespace parser
+} // namespace realm
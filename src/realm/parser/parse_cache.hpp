@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2021 Realm Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALM_PARSE_CACHE_HPP
+#define REALM_PARSE_CACHE_HPP
+
+#include "keypath_mapping.hpp"
+#include "parser.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace realm {
+class Query;
+
+namespace query_builder {
+class Arguments;
+}
+
+namespace parser {
+
+// A query string bound to a table: its parse result, and the link chains of
+// its keypaths, which are resolved against the table the first time the
+// template is applied. Applying the template again only binds the argument
+// values, which end up in the query nodes. May be applied concurrently.
+class QueryTemplate {
+public:
+    explicit QueryTemplate(std::shared_ptr<const ParserResult> parsed);
+
+    const ParserResult& get_parsed() const noexcept
+    {
+        return *m_parsed;
+    }
+
+    // Same as query_builder::apply_predicate(). `query` must be on the table
+    // of the template, and `mapping` must have the signature of the one the
+    // template was made for.
+    void apply(Query& query, query_builder::Arguments& arguments, KeyPathMapping mapping) const;
+
+private:
+    std::shared_ptr<const ParserResult> m_parsed;
+    mutable KeyPathCache m_keypaths;
+};
+
+// A bounded cache of parse results keyed by the query string, and of query
+// templates keyed by the table, the query string and the signature of the
+// keypath mapping. A parse result depends on neither the table nor the
+// arguments of the query, so templates with the same string share it. When
+// either part of the cache is full, its least recently used entry is evicted.
+class ParseCache {
+public:
+    static constexpr size_t default_capacity = 256;
+
+    explicit ParseCache(size_t capacity = default_capacity);
+
+    // The cache used by Table::query()
+    static ParseCache& get_default();
+
+    // The result of parsing `query`. The query is only parsed if it is not in
+    // the cache; parse errors are thrown and not cached. May be called
+    // concurrently.
+    std::shared_ptr<const ParserResult> parse(StringData query);
+
+    // The template for `query` on `table` with `mapping`. May be called
+    // concurrently.
+    std::shared_ptr<const QueryTemplate> get_template(const Table& table, StringData query,
+                                                      const KeyPathMapping& mapping);
+
+    // A capacity of 0 disables the cache
+    void set_capacity(size_t capacity);
+    size_t get_capacity() const;
+    // The number of parse results
+    size_t size() const;
+    size_t get_num_templates() const;
+    void clear();
+
+    // Of parse()
+    size_t get_hit_count() const;
+    size_t get_miss_count() const;
+
+private:
+    template <class T>
+    struct Entries {
+        using Entry = std::pair<std::string, T>;
+        // Most recently used first
+        std::list<Entry> list;
+        // Keys refer to the strings of `list`
+        std::unordered_map<StringData, typename std::list<Entry>::iterator> index;
+
+        T* find(StringData key);
+        void add(std::string key, T value, size_t capacity);
+        void evict(size_t max_size);
+        void clear();
+    };
+
+    mutable std::mutex m_mutex;
+    size_t m_capacity;
+    Entries<std::shared_ptr<const ParserResult>> m_parsed;
+    Entries<std::shared_ptr<const QueryTemplate>> m_templates;
+    size_t m_hit_count = 0;
+    size_t m_miss_count = 0;
+};
+
+} // namespace parser
+} // namespace realm
+
+#endif // REALM_PARSE_CACHE_HPP
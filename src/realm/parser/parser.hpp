@@ -101,7 +101,8 @@ struct Predicate
         EndsWith,
         Contains,
         Like,
-        In
+        In,
+        Text
     };
 
     enum class OperatorOption
@@ -18,6 +18,7 @@
 
 #include "query_builder.hpp"
 
+#include "parse_cache.hpp"
 #include "parser.hpp"
 #include "parser_utils.hpp"
 #include "property_expression.hpp"
@@ -172,6 +173,8 @@ const char* operator_description(const Predicate::Operator& op)
             return "LIKE";
         case realm::parser::Predicate::Operator::In:
             return "IN";
+        case realm::parser::Predicate::Operator::Text:
+            return "TEXT";
     }
     REALM_ASSERT_DEBUG(false);
     return "";
@@ -214,6 +217,17 @@ make_string_constraint_query(const Predicate::Comparison& cmp, LHS&& lhs, RHS&&
             return lhs.not_equal(rhs, case_sensitive);
         case Predicate::Operator::Like:
             return lhs.like(rhs, case_sensitive);
+        case Predicate::Operator::Text:
+            // Words are always matched case folded
+            if (!case_sensitive)
+                throw_logic_error("The 'TEXT' operator does not support the '[c]' modifier.");
+            if constexpr (std::is_same_v<std::decay_t<LHS>, Columns<String>> &&
+                          std::is_same_v<std::decay_t<RHS>, StringData>) {
+                if (!lhs.links_exist())
+                    return lhs.get_base_table()->where().fulltext(lhs.column_key(), rhs);
+            }
+            throw_logic_error("The 'TEXT' operator is only supported between a string property of the queried "
+                              "object and a string literal.");
         default:
             throw_logic_error(
                 util::format("Unsupported operator '%1' for string queries.", operator_description(cmp.op)));
@@ -968,8 +982,11 @@ Query Table::query(const std::string& query_string, query_builder::Arguments& ar
 {
     auto q = where();
 
-    parser::ParserResult res = realm::parser::parse(query_string);
-    realm::query_builder::apply_predicate(q, res.predicate, arguments, mapping);
+    // The parse result and the keypaths resolved against this table are
+    // shared by the queries with the same string; only the arguments are bound
+    // anew
+    auto query_template = parser::ParseCache::get_default().get_template(*this, query_string, mapping);
+    query_template->apply(q, arguments, mapping);
 
     return q;
 }
@@ -26,12 +26,95 @@
 #include <realm/table_view.hpp>
 #include <realm/table_tpl.hpp>
 
+#include <realm/util/scope_exit.hpp>
+#include <realm/util/worker_pool.hpp>
+
 #include <algorithm>
+#include <cmath>
+#include <deque>
 
 
 using namespace realm;
 using namespace realm::metrics;
 
+namespace {
+
+// Splits the leaves of a cluster tree into a number of partitions, each
+// covering a contiguous run of leaves, and evaluates the partitions on
+// the threads of the shared worker pool. Used for parallel query evaluation.
+class ParallelClusterTraversal {
+public:
+    ParallelClusterTraversal(const ClusterTree& tree, size_t max_threads)
+        : m_tree(tree)
+    {
+        tree.traverse([this](const Cluster* cluster) {
+            m_leaves.push_back({cluster->get_ref(), cluster->get_offset()});
+            return false; // Continue
+        });
+        size_t num_partitions = std::min(max_threads, m_leaves.size());
+        m_partition_begin.push_back(0);
+        for (size_t i = 1; i <= num_partitions; ++i)
+            m_partition_begin.push_back(i * m_leaves.size() / num_partitions);
+    }
+
+    size_t num_partitions() const noexcept
+    {
+        return m_partition_begin.size() - 1;
+    }
+
+    // Calls `func(partition_ndx, cluster)` for every leaf until it returns
+    // true. The leaves of a partition are visited in key order by a single
+    // thread. The first partition is evaluated by the calling thread.
+    template <class F>
+    void run(F func) const
+    {
+        util::run_in_parallel(num_partitions(), [&](size_t partition) {
+            Allocator& alloc = m_tree.get_alloc();
+            for (size_t i = m_partition_begin[partition]; i < m_partition_begin[partition + 1]; ++i) {
+                Cluster leaf(m_leaves[i].offset, alloc, m_tree);
+                leaf.init(MemRef(m_leaves[i].ref, alloc));
+                if (func(partition, &leaf))
+                    break;
+            }
+        });
+    }
+
+private:
+    struct Leaf {
+        ref_type ref;
+        uint64_t offset;
+    };
+
+    const ClusterTree& m_tree;
+    std::vector<Leaf> m_leaves;
+    std::vector<size_t> m_partition_begin;
+};
+
+// Folds the state of a later partition into that of an earlier one. Keeps
+// the first of several equal min/max values, like sequential evaluation does.
+template <Action action, class R>
+void merge_query_state(QueryState<R>& dst, const QueryState<R>& src)
+{
+    if constexpr (action == act_Sum) {
+        dst.m_state += src.m_state;
+    }
+    else if constexpr (action == act_Max) {
+        if (src.m_state > dst.m_state) {
+            dst.m_state = src.m_state;
+            dst.m_minmax_index = src.m_minmax_index;
+        }
+    }
+    else if constexpr (action == act_Min) {
+        if (src.m_state < dst.m_state) {
+            dst.m_state = src.m_state;
+            dst.m_minmax_index = src.m_minmax_index;
+        }
+    }
+    dst.m_match_count += src.m_match_count;
+}
+
+} // anonymous namespace
+
 Query::Query()
 {
     create();
@@ -81,6 +164,7 @@ Query::Query(const Query& source)
     : error_code(source.error_code)
     , m_groups(source.m_groups)
     , m_table(source.m_table)
+    , m_max_threads(source.m_max_threads)
 {
     if (source.m_owned_source_table_view) {
         m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -105,6 +189,7 @@ Query& Query::operator=(const Query& source)
     if (this != &source) {
         m_groups = source.m_groups;
         m_table = source.m_table;
+        m_max_threads = source.m_max_threads;
 
         if (source.m_owned_source_table_view) {
             m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -151,6 +236,7 @@ Query::Query(const Query* source, Transaction* tr, PayloadPolicy policy)
         m_view = m_source_link_list.get();
     }
     m_groups = source->m_groups;
+    m_max_threads = source->m_max_threads;
     if (source->m_table)
         set_table(tr->import_copy_of(source->m_table));
     // otherwise: empty query.
@@ -831,6 +917,14 @@ Query& Query::like(ColKey column_key, StringData value, bool case_sensitive)
         add_condition<LikeIns>(column_key, value);
     return *this;
 }
+Query& Query::fulltext(ColKey column_key, StringData value)
+{
+    m_table->check_column(column_key);
+    if (column_key.get_type() != col_type_String || column_key.is_collection())
+        throw_type_mismatch_error();
+    add_node(std::unique_ptr<ParentNode>(new StringNodeFulltext(value, column_key)));
+    return *this;
+}
 
 
 // Aggregates =================================================================================
@@ -875,6 +969,42 @@ R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) c
                     }
                 });
             }
+            else if (use_parallel_evaluation()) {
+                // no index, traverse cluster tree on multiple threads
+                ParallelClusterTraversal traversal(m_table.unchecked_ptr()->m_clusters, m_max_threads);
+                size_t num_partitions = traversal.num_partitions();
+                bool nullable = m_table->is_nullable(column_key);
+
+                std::vector<Query> queries(num_partitions, *this);
+                std::deque<QueryState<ResultType>> states;
+                std::deque<LeafType> leafs;
+                for (auto& q : queries) {
+                    q.init();
+                    auto qn = q.root_node();
+                    for (size_t c = 0; c < qn->m_children.size(); c++)
+                        qn->m_children[c]->aggregate_local_prepare(action, ColumnTypeTraits<T>::id, nullable);
+                    states.emplace_back(action);
+                    leafs.emplace_back(m_table.unchecked_ptr()->get_alloc());
+                }
+
+                traversal.run([column_key, &queries, &states, &leafs](size_t partition, const Cluster* cluster) {
+                    Query& q = queries[partition];
+                    auto qn = q.root_node();
+                    auto& partition_st = states[partition];
+                    auto& leaf = leafs[partition];
+                    size_t e = cluster->node_size();
+                    qn->set_cluster(cluster);
+                    cluster->init_leaf(column_key, &leaf);
+                    partition_st.m_key_offset = cluster->get_offset();
+                    partition_st.m_key_values = cluster->get_key_array();
+                    q.aggregate_internal(qn, &partition_st, 0, e, &leaf);
+                    // Continue
+                    return false;
+                });
+
+                for (auto& partition_st : states)
+                    merge_query_state<action>(st, partition_st);
+            }
             else {
                 // no index, traverse cluster tree
                 node = pn;
@@ -919,6 +1049,15 @@ R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) c
     }
 }
 
+bool Query::use_parallel_evaluation() const
+{
+    // Concurrent readers are only safe when nothing can modify the table underneath them
+    if (m_max_threads <= 1 || m_view || !has_conditions())
+        return false;
+    const Table* table = m_table.unchecked_ptr();
+    return table->get_alloc().is_read_only() && table->size() > 0;
+}
+
 size_t Query::find_best_node(ParentNode* pn) const
 {
     auto score_compare = [](const ParentNode* a, const ParentNode* b) {
@@ -1348,6 +1487,49 @@ void Query::find_all(ConstTableView& ret, size_t begin, size_t end, size_t limit
                 });
                 return;
             }
+            if (begin == 0 && end == m_table->size() && limit == size_t(-1) && use_parallel_evaluation()) {
+                // no index, descend B+-tree on multiple threads and concatenate the partial results in key order
+                ParallelClusterTraversal traversal(m_table->m_clusters, m_max_threads);
+                size_t num_partitions = traversal.num_partitions();
+
+                std::vector<Query> queries(num_partitions, *this);
+                std::deque<KeyColumn> keys;
+                std::deque<QueryState<int64_t>> states;
+                auto destroy_keys = util::make_scope_exit([&]() noexcept {
+                    for (auto& k : keys)
+                        k.destroy();
+                });
+                for (auto& q : queries) {
+                    q.init();
+                    auto qn = q.root_node();
+                    for (size_t c = 0; c < qn->m_children.size(); c++)
+                        qn->m_children[c]->aggregate_local_prepare(act_FindAll, type_Int, false);
+                    keys.emplace_back(Allocator::get_default());
+                    keys.back().create();
+                    states.emplace_back(act_FindAll, &keys.back());
+                }
+
+                traversal.run([&queries, &states](size_t partition, const Cluster* cluster) {
+                    Query& q = queries[partition];
+                    auto qn = q.root_node();
+                    auto& st = states[partition];
+                    size_t e = cluster->node_size();
+                    qn->set_cluster(cluster);
+                    st.m_key_offset = cluster->get_offset();
+                    st.m_key_values = cluster->get_key_array();
+                    q.aggregate_internal(qn, &st, 0, e, nullptr);
+                    // Continue
+                    return false;
+                });
+
+                for (auto& k : keys) {
+                    size_t sz = k.size();
+                    for (size_t i = 0; i < sz; i++)
+                        ret.m_key_values.add(k.get(i));
+                }
+                return;
+            }
+
             // no index on best node (and likely no index at all), descend B+-tree
             node = pn;
             QueryState<int64_t> st(act_FindAll, &ret.m_key_values, limit);
@@ -1435,6 +1617,39 @@ size_t Query::do_count(size_t limit) const
             });
             return counter;
         }
+        if (limit == size_t(-1) && use_parallel_evaluation()) {
+            // no index, descend down the B+-tree on multiple threads
+            ParallelClusterTraversal traversal(m_table->m_clusters, m_max_threads);
+            size_t num_partitions = traversal.num_partitions();
+
+            std::vector<Query> queries(num_partitions, *this);
+            std::deque<QueryState<int64_t>> states;
+            for (auto& q : queries) {
+                q.init();
+                auto qn = q.root_node();
+                for (size_t c = 0; c < qn->m_children.size(); c++)
+                    qn->m_children[c]->aggregate_local_prepare(act_Count, type_Int, false);
+                states.emplace_back(act_Count);
+            }
+
+            traversal.run([&queries, &states](size_t partition, const Cluster* cluster) {
+                Query& q = queries[partition];
+                auto qn = q.root_node();
+                auto& st = states[partition];
+                size_t e = cluster->node_size();
+                qn->set_cluster(cluster);
+                st.m_key_offset = cluster->get_offset();
+                st.m_key_values = cluster->get_key_array();
+                q.aggregate_internal(qn, &st, 0, e, nullptr);
+                // Continue
+                return false;
+            });
+
+            for (auto& st : states)
+                cnt += size_t(st.m_state);
+            return cnt;
+        }
+
         // no index, descend down the B+-tree instead
         node = pn;
         QueryState<int64_t> st(act_Count, limit);
@@ -1503,6 +1718,34 @@ TableView Query::find_all(const DescriptorOrdering& descriptor)
     return ret;
 }
 
+TableView Query::find_all(const std::vector<ObjKey>& matches, const DescriptorOrdering& descriptor)
+{
+    TableView ret(m_table, *this, 0, size_t(-1), size_t(-1));
+    for (auto key : matches)
+        ret.m_key_values.add(key);
+    ret.m_descriptor_ordering = descriptor;
+    ret.m_descriptor_ordering.collect_dependencies(m_table.unchecked_ptr());
+    ret.do_sort(ret.m_descriptor_ordering);
+    ret.m_last_seen_versions = ret.get_dependency_versions();
+    return ret;
+}
+
+std::vector<ObjKey> Query::find_matching(const std::vector<ObjKey>& candidates) const
+{
+    REALM_ASSERT(!m_view);
+    std::vector<ObjKey> ret;
+    if (candidates.empty())
+        return ret;
+
+    init();
+    const Table* table = m_table.unchecked_ptr();
+    for (auto key : candidates) {
+        if (table->is_valid(key) && eval_object(table->get_object(key)))
+            ret.push_back(key);
+    }
+    return ret;
+}
+
 size_t Query::count(const DescriptorOrdering& descriptor)
 {
 #if REALM_METRICS
@@ -1538,136 +1781,6 @@ size_t Query::remove()
     return rows;
 }
 
-#if REALM_MULTITHREAD_QUERY
-TableView Query::find_all_multi(size_t start, size_t end)
-{
-    static_cast<void>(start);
-    static_cast<void>(end);
-
-    // Initialization
-    init();
-    ts.next_job = start;
-    ts.end_job = end;
-    ts.done_job = 0;
-    ts.count = 0;
-    ts.table = &table;
-    ts.node = first[0];
-
-    // Signal all threads to start
-    pthread_mutex_unlock(&ts.jobs_mutex);
-    pthread_cond_broadcast(&ts.jobs_cond);
-
-    // Wait until all threads have completed
-    pthread_mutex_lock(&ts.completed_mutex);
-    while (ts.done_job < ts.end_job)
-        pthread_cond_wait(&ts.completed_cond, &ts.completed_mutex);
-    pthread_mutex_lock(&ts.jobs_mutex);
-    pthread_mutex_unlock(&ts.completed_mutex);
-
-    TableView tv(*m_table);
-
-    // Sort search results because user expects ascending order
-    sort(ts.chunks.begin(), ts.chunks.end(), &Query::comp);
-    for (size_t i = 0; i < ts.chunks.size(); ++i) {
-        const size_t from = ts.chunks[i].m_root_node;
-        const size_t upto = (i == ts.chunks.size() - 1) ? size_t(-1) : ts.chunks[i + 1].m_root_node;
-        size_t first = ts.chunks[i].second;
-
-        while (first < ts.results.size() && ts.results[first] < upto && ts.results[first] >= from) {
-            tv.get_ref_column().add(ts.results[first]);
-            ++first;
-        }
-    }
-
-    return move(tv);
-}
-
-int Query::set_threads(unsigned int threadcount)
-{
-#if defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
-    pthread_win32_process_attach_np();
-#endif
-    pthread_mutex_init(&ts.result_mutex, nullptr);
-    pthread_cond_init(&ts.completed_cond, nullptr);
-    pthread_mutex_init(&ts.jobs_mutex, nullptr);
-    pthread_mutex_init(&ts.completed_mutex, nullptr);
-    pthread_cond_init(&ts.jobs_cond, nullptr);
-
-    pthread_mutex_lock(&ts.jobs_mutex);
-
-    for (size_t i = 0; i < m_threadcount; ++i)
-        pthread_detach(threads[i]);
-
-    for (size_t i = 0; i < threadcount; ++i) {
-        int r = pthread_create(&threads[i], nullptr, query_thread, (void*)&ts);
-        if (r != 0)
-            REALM_ASSERT(false); // todo
-    }
-    m_threadcount = threadcount;
-    return 0;
-}
-
-
-void* Query::query_thread(void* arg)
-{
-    static_cast<void>(arg);
-    thread_state* ts = static_cast<thread_state*>(arg);
-
-    std::vector<size_t> res;
-    std::vector<pair<size_t, size_t>> chunks;
-
-    for (;;) {
-        // Main waiting loop that waits for a query to start
-        pthread_mutex_lock(&ts->jobs_mutex);
-        while (ts->next_job == ts->end_job)
-            pthread_cond_wait(&ts->jobs_cond, &ts->jobs_mutex);
-        pthread_mutex_unlock(&ts->jobs_mutex);
-
-        for (;;) {
-            // Pick a job
-            pthread_mutex_lock(&ts->jobs_mutex);
-            if (ts->next_job == ts->end_job)
-                break;
-            const size_t chunk = min(ts->end_job - ts->next_job, thread_chunk_size);
-            const size_t mine = ts->next_job;
-            ts->next_job += chunk;
-            size_t r = mine - 1;
-            const size_t end = mine + chunk;
-
-            pthread_mutex_unlock(&ts->jobs_mutex);
-
-            // Execute job
-            for (;;) {
-                r = ts->node->find_first(r + 1, end);
-                if (r == end)
-                    break;
-                res.push_back(r);
-            }
-
-            // Append result in common queue shared by all threads.
-            pthread_mutex_lock(&ts->result_mutex);
-            ts->done_job += chunk;
-            if (res.size() > 0) {
-                ts->chunks.push_back(std::pair<size_t, size_t>(mine, ts->results.size()));
-                ts->count += res.size();
-                for (size_t i = 0; i < res.size(); i++) {
-                    ts->results.push_back(res[i]);
-                }
-                res.clear();
-            }
-            pthread_mutex_unlock(&ts->result_mutex);
-
-            // Signal main thread that we might have compleeted
-            pthread_mutex_lock(&ts->completed_mutex);
-            pthread_cond_signal(&ts->completed_cond);
-            pthread_mutex_unlock(&ts->completed_mutex);
-        }
-    }
-    return 0;
-}
-
-#endif // REALM_MULTITHREADQUERY
-
 std::string Query::validate()
 {
     if (!m_groups.size())
@@ -1701,16 +1814,192 @@ std::string Query::get_description() const
     return get_description(state);
 }
 
+QueryPlan Query::explain() const
+{
+    QueryPlan plan;
+    init();
+    size_t sz = m_view ? m_view->size() : m_table->size();
+    if (!has_conditions()) {
+        plan.estimated_rows = double(sz);
+        plan.actual_rows = sz;
+        return plan;
+    }
+
+    // The estimates are taken before any evaluation updates the statistics
+    // of the conditions
+    ParentNode* root = root_node();
+    // init() does not estimate a single condition from the statistics
+    if (!m_view && root->m_children.size() == 1)
+        plan_conditions(root);
+    ParentNode* first = root->m_children[find_best_node(root)];
+    plan.index_driven = !m_view && first->has_search_index();
+    util::serializer::SerialisationState state;
+    for (ParentNode* node : first->m_children) {
+        QueryPlan::Condition condition;
+        condition.description = node->describe(state);
+        condition.uses_index = !m_view && node->has_search_index();
+        condition.estimated_rows = std::min(sz / node->m_dD, double(sz));
+        plan.conditions.push_back(std::move(condition));
+    }
+    plan.estimated_rows = double(sz);
+    for (ParentNode* node = root; node; node = node->m_child.get())
+        plan.estimated_rows *= std::min(1 / node->m_dD, 1.0);
+
+    for (size_t i = 0; i < plan.conditions.size(); ++i) {
+        auto node = first->m_children[i]->clone();
+        node->m_child.reset();
+        node->init(!m_view);
+        std::vector<ParentNode*> v;
+        node->gather_children(v);
+        size_t matches = 0;
+        if (m_view) {
+            for (size_t t = 0; t < sz; t++) {
+                if (node->match(m_view->get_object(t)))
+                    ++matches;
+            }
+        }
+        else {
+            m_table->traverse_clusters([&](const Cluster* cluster) {
+                size_t e = cluster->node_size();
+                node->set_cluster(cluster);
+                for (size_t r = node->find_first(0, e); r != not_found; r = node->find_first(r + 1, e))
+                    ++matches;
+                return false; // Continue
+            });
+        }
+        plan.conditions[i].actual_rows = matches;
+    }
+    plan.actual_rows = count();
+    return plan;
+}
+
+std::string QueryPlan::description() const
+{
+    auto rows = [](double estimated, size_t actual) {
+        return " (estimated rows: " + util::to_string(size_t(std::round(estimated))) +
+               ", actual rows: " + util::to_string(actual) + ")";
+    };
+    std::string s = (index_driven ? "INDEX LOOKUP" : "SCAN") + rows(estimated_rows, actual_rows);
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        auto& condition = conditions[i];
+        s += "\n" + util::to_string(i + 1) + ". " + condition.description + (condition.uses_index ? " [index]" : "") +
+             rows(condition.estimated_rows, condition.actual_rows);
+    }
+    return s;
+}
+
 void Query::init() const
 {
     m_table.check();
     if (ParentNode* root = root_node()) {
         root->init(m_view == nullptr);
+        root->m_composite_node.reset();
+        if (!m_view)
+            init_composite_index(root);
         std::vector<ParentNode*> vec;
         root->gather_children(vec);
+        // A single condition has nothing to be ordered against, so the table
+        // is not sampled for it
+        if (!m_view && root->m_children.size() > 1)
+            plan_conditions(root);
+    }
+}
+
+// Replace the initial guess of the distance between the matches of each of the
+// conditions ANDed together at the top level by an estimate from the column
+// statistics of the table, so that the condition expected to have the fewest
+// matches for its cost drives the search from the start, whether it is found
+// through an index or not. Each condition then tests the others on its matches
+// in the order of their cost.
+void Query::plan_conditions(ParentNode* root) const
+{
+    const Table* table = m_table.unchecked_ptr();
+    size_t sz = table->size();
+    if (sz < min_planned_rows)
+        return;
+
+    for (ParentNode* node : root->m_children) {
+        if (auto selectivity = node->estimate_selectivity())
+            node->m_dD = 1 / std::max(*selectivity, 1.0 / (sz + 1));
+    }
+    for (ParentNode* node : root->m_children) {
+        std::stable_sort(node->m_children.begin() + 1, node->m_children.end(), [](ParentNode* a, ParentNode* b) {
+            return a->cost() < b->cost();
+        });
     }
 }
 
+// Find the composite index covering most of the conditions ANDed together at
+// the top level of the query: equality conditions on its leading columns,
+// optionally followed by a range condition on the next column. If it covers
+// more than one condition, the objects found in it become the candidates
+// which the conditions are evaluated on.
+void Query::init_composite_index(ParentNode* root) const
+{
+    auto& indexes = m_table.unchecked_ptr()->get_composite_index_accessors();
+    if (indexes.empty())
+        return;
+
+    struct IndexCondition {
+        ColKey col_key;
+        Mixed value;
+        CompositeIndex::Condition condition;
+    };
+    std::vector<IndexCondition> conditions;
+    for (ParentNode* node = root; node; node = node->m_child.get()) {
+        IndexCondition c;
+        if (node->m_condition_column_key && node->get_index_condition(c.value, c.condition)) {
+            c.col_key = node->m_condition_column_key;
+            conditions.push_back(c);
+        }
+    }
+    if (conditions.size() < CompositeIndex::min_columns)
+        return;
+
+    const CompositeIndex* best_index = nullptr;
+    std::vector<Mixed> best_prefix;
+    const IndexCondition* best_range = nullptr;
+    size_t best_covered = 1;
+    for (auto index : indexes) {
+        std::vector<Mixed> prefix;
+        const IndexCondition* range = nullptr;
+        for (auto col_key : index->get_column_keys()) {
+            auto equal = std::find_if(conditions.begin(), conditions.end(), [&](auto& c) {
+                return c.col_key == col_key && c.condition == CompositeIndex::Condition::Equal;
+            });
+            if (equal != conditions.end()) {
+                prefix.push_back(equal->value);
+                continue;
+            }
+            auto it = std::find_if(conditions.begin(), conditions.end(), [&](auto& c) {
+                return c.col_key == col_key;
+            });
+            if (it != conditions.end())
+                range = &*it;
+            break;
+        }
+        size_t covered = prefix.size() + (range ? 1 : 0);
+        if (covered > best_covered) {
+            best_index = index;
+            best_prefix = std::move(prefix);
+            best_range = range;
+            best_covered = covered;
+        }
+    }
+    if (!best_index)
+        return;
+
+    std::vector<ObjKey> keys;
+    if (best_range)
+        best_index->find_all(keys, best_prefix, best_range->condition, best_range->value);
+    else
+        best_index->find_all(keys, best_prefix);
+    auto node = std::make_unique<CompositeIndexNode>(std::move(keys));
+    node->set_table(m_table);
+    node->init(true);
+    root->m_composite_node = std::move(node);
+}
+
 size_t Query::find_internal(size_t start, size_t end) const
 {
     if (end == size_t(-1))
@@ -26,14 +26,6 @@
 #include <string>
 #include <vector>
 
-#define REALM_MULTITHREAD_QUERY 0
-
-#if REALM_MULTITHREAD_QUERY
-// FIXME: Use our C++ thread abstraction API since it provides a much
-// higher level of encapsulation and safety.
-#include <pthread.h>
-#endif
-
 #include <realm/obj_list.hpp>
 #include <realm/table_ref.hpp>
 #include <realm/binary_data.hpp>
@@ -79,6 +71,31 @@ struct QueryGroup {
     State m_state = State::Default;
 };
 
+// The plan chosen for evaluating a query, as returned by Query::explain()
+struct QueryPlan {
+    struct Condition {
+        std::string description;
+        // True if the matches of the condition are looked up in an index
+        bool uses_index = false;
+        // Number of rows matching the condition alone
+        double estimated_rows = 0;
+        size_t actual_rows = 0;
+    };
+
+    // The conditions ANDed together at the top level of the query. The
+    // first one drives the search, the others are tested on its matches in
+    // the order given.
+    std::vector<Condition> conditions;
+    // True if the search is driven by looking up the matches of the first
+    // condition in an index rather than by scanning the table
+    bool index_driven = false;
+    // Number of rows matching the query
+    double estimated_rows = 0;
+    size_t actual_rows = 0;
+
+    std::string description() const;
+};
+
 class Query final {
 public:
     Query(ConstTableRef table, ConstTableView* tv = nullptr);
@@ -193,6 +210,9 @@ public:
     Query& ends_with(ColKey column_key, StringData value, bool case_sensitive = true);
     Query& contains(ColKey column_key, StringData value, bool case_sensitive = true);
     Query& like(ColKey column_key, StringData value, bool case_sensitive = true);
+    /// Matches the strings holding all the words of `value`, in any order and
+    /// case. Uses the full-text index of the column, if any (see FullTextIndex).
+    Query& fulltext(ColKey column_key, StringData value);
 
     // These are shortcuts for equal(StringData(c_str)) and
     // not_equal(StringData(c_str)), and are needed to avoid unwanted
@@ -240,6 +260,17 @@ public:
     size_t count() const;
     TableView find_all(const DescriptorOrdering& descriptor);
     size_t count(const DescriptorOrdering& descriptor);
+
+    // Build the result of find_all(descriptor) from `matches`, which must be
+    // the keys of exactly the objects currently matching the query, in table
+    // order. The conditions are not evaluated again, which makes this a cheap
+    // way to produce the result when the caller already knows the matches,
+    // e.g. by patching a previous result with find_matching().
+    TableView find_all(const std::vector<ObjKey>& matches, const DescriptorOrdering& descriptor);
+    // Evaluate the query for each of `candidates` and return the keys of those
+    // that match, in the same order. Keys of objects which no longer exist are
+    // skipped. The query must not be restricted by a view.
+    std::vector<ObjKey> find_matching(const std::vector<ObjKey>& candidates) const;
     int64_t sum_int(ColKey column_key) const;
     double average_int(ColKey column_key, size_t* resultcount = nullptr) const;
     int64_t maximum_int(ColKey column_key, ObjKey* return_ndx = nullptr) const;
@@ -262,12 +293,25 @@ public:
     // Deletion
     size_t remove();
 
-#if REALM_MULTITHREAD_QUERY
     // Multi-threading
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1));
-    ConstTableView find_all_multi(size_t start = 0, size_t end = size_t(-1)) const;
-    int set_threads(unsigned int threadcount);
-#endif
+    //
+    // Allow find_all(), count() and the aggregate functions to partition the
+    // clusters of the table into up to `max_threads` parts, which are
+    // evaluated by the calling thread and the threads of a worker pool shared
+    // by all queries (see util::WorkerPool). Each part is evaluated with its
+    // own copy of the conditions, and the partial results are merged in key
+    // order, so the result is the same as for sequential evaluation.
+    // Parallel evaluation is only used when the table is accessed through a
+    // read transaction or is frozen, when the query is not restricted by a
+    // view or a list, and when the query cannot be served from a search
+    // index. Under the same conditions, large views created from the query
+    // are sorted in up to `max_threads` parts on the same pool. Setting
+    // `max_threads` to 1 (the default) disables it.
+    Query& set_max_threads(size_t max_threads) noexcept
+    {
+        m_max_threads = max_threads;
+        return *this;
+    }
 
     ConstTableRef& get_table()
     {
@@ -292,12 +336,19 @@ public:
     std::string get_description() const;
     std::string get_description(util::serializer::SerialisationState& state) const;
 
+    // The plan chosen for evaluating the query, with the estimated number of
+    // matches next to the actual number, which is found by evaluating each
+    // condition separately.
+    QueryPlan explain() const;
+
     bool eval_object(const Obj& obj) const;
 
 private:
     void create();
 
     void init() const;
+    void init_composite_index(ParentNode* root) const;
+    void plan_conditions(ParentNode* root) const;
     size_t find_internal(size_t start = 0, size_t end = size_t(-1)) const;
     void handle_pending_not();
     void set_table(TableRef tr);
@@ -329,6 +380,7 @@ private:
     R aggregate(ColKey column_key, size_t* resultcount = nullptr, ObjKey* return_ndx = nullptr) const;
 
     size_t find_best_node(ParentNode* pn) const;
+    bool use_parallel_evaluation() const;
     void aggregate_internal(ParentNode* pn, QueryStateBase* st, size_t start, size_t end,
                             ArrayPayload* source_column) const;
 
@@ -370,6 +422,8 @@ private:
     LnkLstPtr m_source_link_list;                  // link lists are owned by the query.
     ConstTableView* m_source_table_view = nullptr; // table views are not refcounted, and not owned by the query.
     std::unique_ptr<ConstTableView> m_owned_source_table_view; // <--- except when indicated here
+
+    size_t m_max_threads = 1;
 };
 
 // Implementation:
@@ -67,6 +67,33 @@ size_t ParentNode::find_first(size_t start, size_t end)
     return not_found;
 }
 
+util::Optional<double> ParentNode::estimate_selectivity() const
+{
+    Mixed value;
+    CompositeIndex::Condition condition;
+    if (!m_condition_column_key || !get_index_condition(value, condition))
+        return util::none;
+    const Table* table = m_table.unchecked_ptr();
+    if (table->size() < min_planned_rows)
+        return util::none;
+    auto stats = table->get_column_statistics(m_condition_column_key);
+    if (!stats)
+        return util::none;
+    switch (condition) {
+        case CompositeIndex::Condition::Equal:
+            return stats->fraction_equal(value);
+        case CompositeIndex::Condition::Greater:
+            return stats->fraction_greater(value, false);
+        case CompositeIndex::Condition::GreaterEqual:
+            return stats->fraction_greater(value, true);
+        case CompositeIndex::Condition::Less:
+            return stats->fraction_less(value, false);
+        case CompositeIndex::Condition::LessEqual:
+            return stats->fraction_less(value, true);
+    }
+    return util::none;
+}
+
 template <class T>
 inline bool Obj::evaluate(T func) const
 {
@@ -374,6 +401,22 @@ bool StringNode<Equal>::do_consume_condition(ParentNode& node)
     return true;
 }
 
+util::Optional<double> StringNode<Equal>::estimate_selectivity() const
+{
+    if (m_needles.empty())
+        return ParentNode::estimate_selectivity();
+    const Table* table = m_table.unchecked_ptr();
+    if (table->size() < min_planned_rows)
+        return util::none;
+    auto stats = table->get_column_statistics(m_condition_column_key);
+    if (!stats)
+        return util::none;
+    double selectivity = 0;
+    for (auto& needle : m_needles)
+        selectivity += stats->fraction_equal(Mixed(needle));
+    return std::min(selectivity, 1.0);
+}
+
 size_t StringNode<Equal>::_find_first_local(size_t start, size_t end)
 {
     if (m_needles.empty()) {
@@ -411,7 +454,11 @@ std::string StringNode<Equal>::describe(util::serializer::SerialisationState& st
 
 void StringNode<EqualIns>::_search_index_init()
 {
-    auto index = ParentNode::m_table->get_search_index(ParentNode::m_condition_column_key);
+    // A case insensitive index holds the matches under the folded value, the general index has to be searched for
+    // all case permutations of it
+    auto index = ParentNode::m_table->get_case_insensitive_index(ParentNode::m_condition_column_key);
+    if (!index)
+        index = ParentNode::m_table->get_search_index(ParentNode::m_condition_column_key);
     m_index_matches.clear();
     index->find_all(m_index_matches, StringData(StringNodeBase::m_value), true);
     m_results_start = 0;
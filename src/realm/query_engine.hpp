@@ -113,6 +113,9 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <realm/util/string_buffer.hpp>
 #include <realm/utilities.hpp>
 #include <realm/index_string.hpp>
+#include <realm/index_composite.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/index_range.hpp>
 
 #include <map>
 #include <unordered_set>
@@ -138,6 +141,14 @@ const size_t probe_matches = 4;
 
 const size_t bitwidth_time_unit = 64;
 
+// Tables with fewer rows are queried without estimating the selectivity of the conditions from column statistics,
+// as sampling the rows would cost about as much as scanning them.
+const size_t min_planned_rows = 1000;
+
+// Fraction of the rows which equality conditions on an indexed column ORed together must be expected to match before
+// testing every row against all the values is preferred over looking up each value in the index.
+const double in_list_scan_fraction = 0.1;
+
 typedef bool (*CallbackDummy)(int64_t);
 using Evaluator = util::FunctionRef<bool(const Obj& obj)>;
 
@@ -154,15 +165,48 @@ public:
     }
     virtual void index_based_aggregate(size_t, Evaluator) {}
 
+    // An equality or range condition on m_condition_column_key which a
+    // composite index can evaluate
+    virtual bool get_index_condition(Mixed&, CompositeIndex::Condition&) const
+    {
+        return false;
+    }
+
+    // Estimated fraction of the rows of the table matching this condition
+    // alone, or none if it cannot be estimated. Conditions found by
+    // get_index_condition() are estimated from the column statistics of the
+    // table.
+    virtual util::Optional<double> estimate_selectivity() const;
+
+    // Estimated fraction of the rows matching this condition and the ones
+    // ANDed to it, assuming that they are independent
+    util::Optional<double> estimate_chain_selectivity() const
+    {
+        util::Optional<double> selectivity;
+        for (const ParentNode* node = this; node; node = node->m_child.get()) {
+            if (auto s = node->estimate_selectivity())
+                selectivity = selectivity.value_or(1.0) * *s;
+        }
+        return selectivity;
+    }
+
     void gather_children(std::vector<ParentNode*>& v)
     {
         m_children.clear();
         size_t i = v.size();
         v.push_back(this);
+        if (m_composite_node)
+            v.push_back(m_composite_node.get());
 
         if (m_child)
             m_child->gather_children(v);
 
+        if (m_composite_node) {
+            auto& children = m_composite_node->m_children;
+            children = v;
+            children.erase(children.begin() + i + 1);
+            children.insert(children.begin(), m_composite_node.get());
+        }
         m_children = v;
         m_children.erase(m_children.begin() + i);
         m_children.insert(m_children.begin(), this);
@@ -212,6 +256,9 @@ public:
     void set_cluster(const Cluster* cluster)
     {
         m_cluster = cluster;
+        m_zone_checked = false;
+        if (m_composite_node)
+            m_composite_node->set_cluster(cluster);
         if (m_child)
             m_child->set_cluster(cluster);
         cluster_changed();
@@ -335,6 +382,9 @@ public:
     }
 
     std::unique_ptr<ParentNode> m_child;
+    // Evaluates conditions of this chain through a composite index. It is
+    // not part of the chain, but is included in m_children (see Query::init())
+    std::unique_ptr<ParentNode> m_composite_node;
     std::vector<ParentNode*> m_children;
     std::string m_condition_column_name;
     mutable ColKey m_condition_column_key = ColKey(); // Column of search criteria
@@ -352,8 +402,26 @@ protected:
     ConstTableRef m_table = ConstTableRef();
     const Cluster* m_cluster = nullptr;
     QueryStateBase* m_state = nullptr;
+    bool m_zone_checked = false;
+    bool m_zone_may_match = true;
     std::string error_code;
 
+    // False if the zone map of the leaf of the current cluster shows that no
+    // value in it can satisfy `Cond` against `value`. Single rows are tested
+    // without consulting it, as when another node is driving the search.
+    template <class Cond, class LeafType>
+    bool leaf_may_match(const LeafType& leaf, Mixed value, size_t start, size_t end)
+    {
+        if (!m_zone_checked) {
+            if (end - start < 2)
+                return true;
+            auto zone_map = m_table.unchecked_ptr()->get_zone_map(m_condition_column_key, leaf);
+            m_zone_may_match = !zone_map || zone_map->template may_match<Cond>(value);
+            m_zone_checked = true;
+        }
+        return m_zone_may_match;
+    }
+
     ColumnType get_real_column_type(ColKey key)
     {
         return m_table.unchecked_ptr()->get_real_column_type(key);
@@ -439,6 +507,78 @@ protected:
     ArrayPayload* m_source_column = nullptr;
 };
 
+size_t do_search_index(ObjKey& last_start_key, size_t& result_get, std::vector<ObjKey>& results,
+                       const Cluster* cluster, size_t start, size_t end);
+
+// Matches the objects found by looking up a conjunction of conditions in a
+// composite index. The conditions themselves stay in the query, so this node
+// only serves to select the candidates.
+class CompositeIndexNode : public ParentNode {
+public:
+    CompositeIndexNode(std::vector<ObjKey> result)
+        : m_result(std::move(result))
+    {
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        ParentNode::init(will_query_ranges);
+        m_result_get = 0;
+        m_last_start_key = ObjKey();
+        m_dD = 100.0 * (m_table->size() + 1) / (m_result.size() + 1);
+        m_dT = 0;
+    }
+
+    bool has_search_index() const override
+    {
+        return true;
+    }
+
+    util::Optional<double> estimate_selectivity() const override
+    {
+        size_t sz = m_table->size();
+        return sz ? double(m_result.size()) / sz : 0.0;
+    }
+
+    std::string describe(util::serializer::SerialisationState&) const override
+    {
+        return "COMPOSITE INDEX";
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        for (size_t t = 0; t < m_result.size() && limit > 0; ++t) {
+            auto obj = m_table->get_object(m_result[t]);
+            if (evaluator(obj)) {
+                --limit;
+            }
+        }
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (start >= end)
+            return not_found;
+        return do_search_index(m_last_start_key, m_result_get, m_result, m_cluster, start, end);
+    }
+
+    std::unique_ptr<ParentNode> clone() const override
+    {
+        return std::unique_ptr<ParentNode>(new CompositeIndexNode(*this));
+    }
+
+private:
+    std::vector<ObjKey> m_result;
+    size_t m_result_get = 0;
+    ObjKey m_last_start_key;
+
+    CompositeIndexNode(const CompositeIndexNode& from)
+        : ParentNode(from)
+        , m_result(from.m_result)
+    {
+    }
+};
+
 template <class LeafType>
 class IntegerNodeBase : public ColumnNodeBase {
     using ThisType = IntegerNodeBase<LeafType>;
@@ -644,6 +784,52 @@ public:
     {
     }
 
+    void init(bool will_query_ranges) override
+    {
+        BaseType::init(will_query_ranges);
+
+        m_index_evaluated = false;
+        if constexpr (RangeIndex::condition_supported<TConditionFunction>) {
+            if (auto index = this->m_table->get_range_index(this->m_condition_column_key)) {
+                // If the condition is not selective, scanning the leafs is cheaper
+                // than looking up the matching objects one by one
+                size_t max_matches = this->m_table->size() / 2;
+                m_result.clear();
+                if (index->template find_all<TConditionFunction>(m_result, Mixed(this->m_value), max_matches)) {
+                    m_index_evaluated = true;
+                    m_result_get = 0;
+                    m_last_start_key = ObjKey();
+                    this->m_dT = 0;
+                }
+            }
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_index_evaluated;
+    }
+
+    bool get_index_condition(Mixed& value, CompositeIndex::Condition& condition) const override
+    {
+        if constexpr (CompositeIndex::condition_supported<TConditionFunction>) {
+            value = Mixed(this->m_value);
+            condition = CompositeIndex::condition_of<TConditionFunction>();
+            return true;
+        }
+        return false;
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        for (size_t t = 0; t < m_result.size() && limit > 0; ++t) {
+            auto obj = this->m_table->get_object(m_result[t]);
+            if (evaluator(obj)) {
+                --limit;
+            }
+        }
+    }
+
     void aggregate_local_prepare(Action action, DataType col_id, bool is_nullable) override
     {
         this->m_fastmode_disabled = (col_id == type_Float || col_id == type_Double);
@@ -657,11 +843,22 @@ public:
                            ArrayPayload* source_column) override
     {
         constexpr int cond = TConditionFunction::condition;
+        if (!leaf_may_match(start, end)) {
+            this->m_dD = double(end - start);
+            return end;
+        }
         return this->aggregate_local_impl(st, start, end, local_limit, source_column, cond);
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_evaluated) {
+            if (start >= end)
+                return not_found;
+            return do_search_index(m_last_start_key, m_result_get, m_result, this->m_cluster, start, end);
+        }
+        if (!leaf_may_match(start, end))
+            return not_found;
         return this->m_leaf_ptr->template find_first<TConditionFunction>(this->m_value, start, end);
     }
 
@@ -680,6 +877,22 @@ public:
     {
         return std::unique_ptr<ParentNode>(new ThisType(*this));
     }
+
+private:
+    std::vector<ObjKey> m_result;
+    size_t m_result_get = 0;
+    ObjKey m_last_start_key;
+    bool m_index_evaluated = false;
+
+    bool leaf_may_match(size_t start, size_t end)
+    {
+        if constexpr (ZoneMap::condition_supported<TConditionFunction>) {
+            if (!m_index_evaluated)
+                return ParentNode::leaf_may_match<TConditionFunction>(*this->m_leaf_ptr, Mixed(this->m_value),
+                                                                      start, end);
+        }
+        return true;
+    }
 };
 
 template <size_t linear_search_threshold, class LeafType, class NeedleContainer>
@@ -724,6 +937,7 @@ public:
         BaseType::init(will_query_ranges);
         m_nb_needles = m_needles.size();
 
+        m_range_index_evaluated = false;
         if (has_search_index()) {
             // _search_index_init();
             m_result.clear();
@@ -733,6 +947,16 @@ public:
             m_last_start_key = ObjKey();
             IntegerNodeBase<LeafType>::m_dT = 0;
         }
+        else if (m_nb_needles == 0) {
+            if (auto index = ParentNode::m_table->get_range_index(ParentNode::m_condition_column_key)) {
+                m_result.clear();
+                index->template find_all<Equal>(m_result, Mixed(BaseType::m_value));
+                m_range_index_evaluated = true;
+                m_result_get = 0;
+                m_last_start_key = ObjKey();
+                IntegerNodeBase<LeafType>::m_dT = 0;
+            }
+        }
     }
 
     bool do_consume_condition(ParentNode& node) override
@@ -749,7 +973,35 @@ public:
 
     bool has_search_index() const override
     {
-        return this->m_table->has_search_index(IntegerNodeBase<LeafType>::m_condition_column_key);
+        // The search index only holds the matches of m_value
+        if (!m_needles.empty())
+            return false;
+        return m_range_index_evaluated ||
+               this->m_table->has_search_index(IntegerNodeBase<LeafType>::m_condition_column_key);
+    }
+
+    util::Optional<double> estimate_selectivity() const override
+    {
+        if (m_needles.empty())
+            return ParentNode::estimate_selectivity();
+        if (this->m_table->size() < min_planned_rows)
+            return util::none;
+        auto stats = this->m_table->get_column_statistics(this->m_condition_column_key);
+        if (!stats)
+            return util::none;
+        double selectivity = 0;
+        for (auto& needle : m_needles)
+            selectivity += stats->fraction_equal(Mixed(needle));
+        return std::min(selectivity, 1.0);
+    }
+
+    bool get_index_condition(Mixed& value, CompositeIndex::Condition& condition) const override
+    {
+        if (!m_needles.empty())
+            return false;
+        value = Mixed(this->m_value);
+        condition = CompositeIndex::Condition::Equal;
+        return true;
     }
 
     void index_based_aggregate(size_t limit, Evaluator evaluator) override
@@ -774,6 +1026,10 @@ public:
                            ArrayPayload* source_column) override
     {
         constexpr int cond = Equal::condition;
+        if (!leaf_may_match(start, end)) {
+            this->m_dD = double(end - start);
+            return end;
+        }
         return this->aggregate_local_impl(st, start, end, local_limit, source_column, cond);
     }
  
@@ -789,6 +1045,9 @@ public:
             else if (has_search_index()) {
                 return do_search_index(m_last_start_key, m_result_get, m_result, BaseType::m_cluster, start, end);
             }
+            else if (!ParentNode::leaf_may_match<Equal>(*this->m_leaf_ptr, Mixed(this->m_value), start, end)) {
+                return realm::npos;
+            }
             else if (end - start == 1) {
                 if (this->m_leaf_ptr->get(start) == this->m_value) {
                     s = start;
@@ -837,6 +1096,14 @@ private:
     size_t m_nb_needles = 0;
     size_t m_result_get = 0;
     ObjKey m_last_start_key;
+    bool m_range_index_evaluated = false;
+
+    bool leaf_may_match(size_t start, size_t end)
+    {
+        if (m_nb_needles || has_search_index())
+            return true;
+        return ParentNode::leaf_may_match<Equal>(*this->m_leaf_ptr, Mixed(this->m_value), start, end);
+    }
 
     IntegerNode(const IntegerNode<LeafType, Equal>& from)
         : BaseType(from)
@@ -883,6 +1150,11 @@ public:
     {
         TConditionFunction cond;
 
+        if constexpr (ZoneMap::condition_supported<TConditionFunction>) {
+            if (!leaf_may_match<TConditionFunction>(*m_leaf_ptr, Mixed(m_value), start, end))
+                return not_found;
+        }
+
         auto find = [&](bool nullability) {
             bool m_value_nan = nullability ? null::is_null_float(m_value) : false;
             for (size_t s = start; s < end; ++s) {
@@ -1158,6 +1430,16 @@ public:
         m_leaf_ptr = m_array_ptr.get();
     }
 
+    bool get_index_condition(Mixed& value, CompositeIndex::Condition& condition) const override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            value = Mixed(m_value);
+            condition = CompositeIndex::Condition::Equal;
+            return true;
+        }
+        return false;
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
         TConditionFunction condition;
@@ -1235,8 +1517,63 @@ class TimestampNode : public TimestampNodeBase {
 public:
     using TimestampNodeBase::TimestampNodeBase;
 
+    void init(bool will_query_ranges) override
+    {
+        TimestampNodeBase::init(will_query_ranges);
+
+        m_index_evaluated = false;
+        if constexpr (RangeIndex::condition_supported<TConditionFunction>) {
+            if (auto index = m_table->get_range_index(m_condition_column_key)) {
+                // If the condition is not selective, scanning the leafs is cheaper
+                // than looking up the matching objects one by one
+                size_t max_matches = std::is_same_v<TConditionFunction, Equal> ? npos : m_table->size() / 2;
+                m_result.clear();
+                if (index->template find_all<TConditionFunction>(m_result, Mixed(m_value), max_matches)) {
+                    m_index_evaluated = true;
+                    m_result_get = 0;
+                    m_last_start_key = ObjKey();
+                    m_dT = 0;
+                }
+            }
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_index_evaluated;
+    }
+
+    bool get_index_condition(Mixed& value, CompositeIndex::Condition& condition) const override
+    {
+        if constexpr (CompositeIndex::condition_supported<TConditionFunction>) {
+            value = Mixed(m_value);
+            condition = CompositeIndex::condition_of<TConditionFunction>();
+            return true;
+        }
+        return false;
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        for (size_t t = 0; t < m_result.size() && limit > 0; ++t) {
+            auto obj = m_table->get_object(m_result[t]);
+            if (evaluator(obj)) {
+                --limit;
+            }
+        }
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_evaluated) {
+            if (start >= end)
+                return not_found;
+            return do_search_index(m_last_start_key, m_result_get, m_result, m_cluster, start, end);
+        }
+        if constexpr (ZoneMap::condition_supported<TConditionFunction>) {
+            if (!leaf_may_match<TConditionFunction>(*m_leaf_ptr, Mixed(m_value), start, end))
+                return not_found;
+        }
         return m_leaf_ptr->find_first<TConditionFunction>(m_value, start, end);
     }
 
@@ -1257,6 +1594,12 @@ protected:
         : TimestampNodeBase(from, tr)
     {
     }
+
+private:
+    std::vector<ObjKey> m_result;
+    size_t m_result_get = 0;
+    ObjKey m_last_start_key;
+    bool m_index_evaluated = false;
 };
 
 class DecimalNodeBase : public ParentNode {
@@ -1312,6 +1655,11 @@ public:
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if constexpr (ZoneMap::condition_supported<TConditionFunction>) {
+            if (!leaf_may_match<TConditionFunction>(*m_leaf_ptr, Mixed(m_value), start, end))
+                return realm::npos;
+        }
+
         TConditionFunction cond;
         bool value_is_null = m_value.is_null();
         for (size_t i = start; i < end; i++) {
@@ -1341,9 +1689,6 @@ protected:
     }
 };
 
-size_t do_search_index(ObjKey& last_start_key, size_t& result_get, std::vector<ObjKey>& results,
-                       const Cluster* cluster, size_t start, size_t end);
-
 template <class ObjectType, class ArrayType>
 class FixedBytesNodeBase : public ParentNode {
 public:
@@ -1460,6 +1805,14 @@ public:
             m_last_start_key = ObjKey();
             this->m_dT = 0;
         }
+        else if (auto index = BaseType::m_table->get_range_index(BaseType::m_condition_column_key)) {
+            m_result.clear();
+            index->template find_all<Equal>(m_result, Mixed(m_optional_value));
+            m_range_index_evaluated = true;
+            m_result_get = 0;
+            m_last_start_key = ObjKey();
+            this->m_dT = 0;
+        }
     }
 
     void index_based_aggregate(size_t limit, Evaluator evaluator) override
@@ -1474,7 +1827,14 @@ public:
 
     bool has_search_index() const override
     {
-        return this->m_table->has_search_index(BaseType::m_condition_column_key);
+        return m_range_index_evaluated || this->m_table->has_search_index(BaseType::m_condition_column_key);
+    }
+
+    bool get_index_condition(Mixed& value, CompositeIndex::Condition& condition) const override
+    {
+        value = this->m_value_is_null ? Mixed() : Mixed(this->m_value);
+        condition = CompositeIndex::Condition::Equal;
+        return true;
     }
 
     size_t find_first_local(size_t start, size_t end) override
@@ -1523,6 +1883,7 @@ protected:
     std::vector<ObjKey> m_result;
     size_t m_result_get = 0;
     ObjKey m_last_start_key;
+    bool m_range_index_evaluated = false;
 };
 
 
@@ -1737,10 +2098,51 @@ public:
     {
         StringNodeBase::init(will_query_ranges);
         clear_leaf_state();
+
+        m_index_evaluated = false;
+        if constexpr (realm::is_any_v<TConditionFunction, BeginsWith, BeginsWithIns>) {
+            if (const StringIndex* index = get_prefix_index()) {
+                m_result.clear();
+                index->find_all_prefix(m_result, StringData(*m_value));
+                m_index_evaluated = true;
+                m_result_get = 0;
+                m_last_start_key = ObjKey();
+                m_dT = 0;
+            }
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_index_evaluated;
+    }
+
+    void cluster_changed() override
+    {
+        // If we use the index, we do not need further access to clusters
+        if (!m_index_evaluated) {
+            StringNodeBase::cluster_changed();
+        }
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        for (size_t t = 0; t < m_result.size() && limit > 0; ++t) {
+            auto obj = m_table->get_object(m_result[t]);
+            if (evaluator(obj)) {
+                --limit;
+            }
+        }
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_evaluated) {
+            if (start >= end)
+                return not_found;
+            return do_search_index(m_last_start_key, m_result_get, m_result, m_cluster, start, end);
+        }
+
         TConditionFunction cond;
 
         for (size_t s = start; s < end; ++s) {
@@ -1772,6 +2174,29 @@ public:
 protected:
     std::string m_ucase;
     std::string m_lcase;
+
+private:
+    // Used for BEGINSWITH conditions answered by a prefix walk of an index
+    bool m_index_evaluated = false;
+    std::vector<ObjKey> m_result;
+    size_t m_result_get = 0;
+    ObjKey m_last_start_key;
+
+    // A case sensitive prefix is looked up in the regular search index, a case insensitive one only in a case
+    // insensitive index as the regular index would have to be walked for all case permutations of the prefix.
+    // An empty prefix matches all non-null strings, so there is nothing to gain from the index.
+    const StringIndex* get_prefix_index() const
+    {
+        if (!m_value || m_value->empty())
+            return nullptr;
+        const Table* table = m_table.unchecked_ptr();
+        if constexpr (std::is_same_v<TConditionFunction, BeginsWithIns>) {
+            return table->get_case_insensitive_index(m_condition_column_key);
+        }
+        else {
+            return table->get_search_index(m_condition_column_key);
+        }
+    }
 };
 
 // Specialization for Contains condition on Strings - we specialize because we can utilize Boyer-Moore
@@ -1996,6 +2421,17 @@ public:
 
     bool do_consume_condition(ParentNode& other) override;
 
+    bool get_index_condition(Mixed& value, CompositeIndex::Condition& condition) const override
+    {
+        if (!m_needles.empty())
+            return false;
+        value = m_value ? Mixed(StringData(*m_value)) : Mixed();
+        condition = CompositeIndex::Condition::Equal;
+        return true;
+    }
+
+    util::Optional<double> estimate_selectivity() const override;
+
     std::unique_ptr<ParentNode> clone() const override
     {
         return std::unique_ptr<ParentNode>(new StringNode<Equal>(*this));
@@ -2085,7 +2521,8 @@ public:
     void table_changed() override
     {
         StringNodeBase::table_changed();
-        m_has_search_index = m_table.unchecked_ptr()->has_search_index(m_condition_column_key);
+        m_has_search_index = m_table.unchecked_ptr()->has_search_index(m_condition_column_key) ||
+                             m_table.unchecked_ptr()->get_case_insensitive_index(m_condition_column_key);
     }
     void _search_index_init() override;
 
@@ -2130,6 +2567,94 @@ private:
     size_t _find_first_local(size_t start, size_t end) override;
 };
 
+// Condition matching the strings which hold all the words of the search text (see FullTextIndex). The full-text
+// index of the column is used if there is one. Otherwise the strings are tokenized one by one.
+class StringNodeFulltext : public StringNodeBase {
+public:
+    StringNodeFulltext(StringData v, ColKey column)
+        : StringNodeBase(v, column)
+        , m_tokens(FullTextIndex::tokenize(v))
+    {
+        m_dT = 50.0;
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        StringNodeBase::init(will_query_ranges);
+        clear_leaf_state();
+
+        m_index_evaluated = false;
+        if (auto index = m_table.unchecked_ptr()->get_fulltext_index(m_condition_column_key)) {
+            m_result.clear();
+            index->find_all(m_result, m_value ? StringData(*m_value) : StringData());
+            m_index_evaluated = true;
+            m_result_get = 0;
+            m_last_start_key = ObjKey();
+            m_dT = 0;
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_index_evaluated;
+    }
+
+    void cluster_changed() override
+    {
+        // If we use the index, we do not need further access to clusters
+        if (!m_index_evaluated) {
+            StringNodeBase::cluster_changed();
+        }
+    }
+
+    void index_based_aggregate(size_t limit, Evaluator evaluator) override
+    {
+        for (size_t t = 0; t < m_result.size() && limit > 0; ++t) {
+            auto obj = m_table->get_object(m_result[t]);
+            if (evaluator(obj)) {
+                --limit;
+            }
+        }
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_index_evaluated) {
+            if (start >= end)
+                return not_found;
+            return do_search_index(m_last_start_key, m_result_get, m_result, m_cluster, start, end);
+        }
+        for (size_t s = start; s < end; ++s) {
+            if (FullTextIndex::matches(get_string(s), m_tokens))
+                return s;
+        }
+        return not_found;
+    }
+
+    std::string describe_condition() const override
+    {
+        return "TEXT";
+    }
+
+    std::unique_ptr<ParentNode> clone() const override
+    {
+        return std::unique_ptr<ParentNode>(new StringNodeFulltext(*this));
+    }
+
+    StringNodeFulltext(const StringNodeFulltext& from)
+        : StringNodeBase(from)
+        , m_tokens(from.m_tokens)
+    {
+    }
+
+private:
+    FullTextIndex::Tokens m_tokens;
+    bool m_index_evaluated = false;
+    std::vector<ObjKey> m_result;
+    size_t m_result_get = 0;
+    ObjKey m_last_start_key;
+};
+
 // OR node contains at least two node pointers: Two or more conditions to OR
 // together in m_conditions, and the next AND condition (if any) in m_child.
 //
@@ -2201,10 +2726,22 @@ public:
         }
     }
 
+    util::Optional<double> estimate_selectivity() const override
+    {
+        double none_match = 1;
+        for (auto& condition : m_conditions) {
+            auto selectivity = condition->estimate_chain_selectivity();
+            if (!selectivity)
+                return util::none;
+            none_match *= 1 - *selectivity;
+        }
+        return 1 - none_match;
+    }
+
     void init(bool will_query_ranges) override
     {
         ParentNode::init(will_query_ranges);
-        combine_conditions(!will_query_ranges);
+        combine_conditions(!will_query_ranges || prefer_scan());
 
         m_start.clear();
         m_start.resize(m_conditions.size(), 0);
@@ -2287,6 +2824,27 @@ public:
     std::vector<std::unique_ptr<ParentNode>> m_conditions;
 
 private:
+    // True if the conditions are expected to match so many rows that testing
+    // each row against all of them is cheaper than following a search index
+    // for each of them. Equality conditions on the same column can then be
+    // combined into one testing against a set of values.
+    bool prefer_scan() const
+    {
+        bool any_index = std::any_of(m_conditions.begin(), m_conditions.end(), [](auto& condition) {
+            return condition->has_search_index();
+        });
+        if (!any_index)
+            return false;
+        double selectivity = 0;
+        for (auto& condition : m_conditions) {
+            auto s = condition->estimate_chain_selectivity();
+            if (!s)
+                return false;
+            selectivity += *s;
+        }
+        return selectivity >= in_list_scan_fraction;
+    }
+
     void combine_conditions(bool ignore_indexes)
     {
         std::sort(m_conditions.begin(), m_conditions.end(), [](auto& a, auto& b) {
@@ -2334,6 +2892,13 @@ public:
         m_first_in_known_range = not_found;
     }
 
+    util::Optional<double> estimate_selectivity() const override
+    {
+        if (auto selectivity = m_condition->estimate_chain_selectivity())
+            return 1 - *selectivity;
+        return util::none;
+    }
+
     void init(bool will_query_ranges) override
     {
         ParentNode::init(will_query_ranges);
@@ -247,6 +247,21 @@ void Columns<Dictionary>::set_cluster(const Cluster* cluster)
     }
 }
 
+std::vector<ObjKey> Columns<Dictionary>::find_all(Mixed value) const
+{
+    std::vector<ObjKey> result;
+    m_link_map.get_target_table()->get_collection_index(m_column_key)->find_all(result, value);
+    if (!links_exist())
+        return result;
+
+    std::vector<ObjKey> ret;
+    for (ObjKey k : result) {
+        auto ndxs = m_link_map.get_origin_ndxs(k);
+        ret.insert(ret.end(), ndxs.begin(), ndxs.end());
+    }
+    return ret;
+}
+
 void Columns<Dictionary>::evaluate(size_t index, ValueBase& destination)
 {
     if (links_exist()) {
@@ -138,6 +138,7 @@ The Columns class encapsulates all this into a simple class that, for any type T
 #include <realm/column_integer.hpp>
 #include <realm/column_type_traits.hpp>
 #include <realm/table.hpp>
+#include <realm/index_collection.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query.hpp>
 #include <realm/list.hpp>
@@ -751,6 +752,12 @@ public:
         return {};
     }
 
+    // True if find_all() can look up `value`
+    virtual bool index_supports(const Mixed& value) const
+    {
+        return value.is_null() || value.get_type() == get_type();
+    }
+
     virtual DataType get_type() const = 0;
 
     virtual void evaluate(size_t index, ValueBase& destination) = 0;
@@ -2118,6 +2125,21 @@ public:
     void set_cluster(const Cluster* cluster) override;
     void evaluate(size_t index, ValueBase& destination) override;
 
+    // The index holds the values of all keys, so it can only be used when
+    // comparing any value of the dictionary
+    bool has_search_index() const override
+    {
+        return m_key.is_null() && m_link_map.get_target_table()->get_collection_index(m_column_key) != nullptr;
+    }
+
+    // An empty dictionary matches null as well, which the index cannot tell
+    bool index_supports(const Mixed& value) const override
+    {
+        return !value.is_null() && CollectionIndex::value_type_supported(value.get_type());
+    }
+
+    std::vector<ObjKey> find_all(Mixed value) const override;
+
     std::unique_ptr<Subexpr> clone() const override
     {
         return make_subexpr<Columns>(static_cast<const Columns&>(*this));
@@ -2846,6 +2868,26 @@ public:
         return ColumnListBase::m_comparison_type;
     }
 
+    bool has_search_index() const override
+    {
+        return m_link_map.get_target_table()->get_collection_index(m_column_key) != nullptr;
+    }
+
+    std::vector<ObjKey> find_all(Mixed value) const override
+    {
+        std::vector<ObjKey> result;
+        m_link_map.get_target_table()->get_collection_index(m_column_key)->find_all(result, value);
+        if (!links_exist())
+            return result;
+
+        std::vector<ObjKey> ret;
+        for (ObjKey k : result) {
+            auto ndxs = m_link_map.get_origin_ndxs(k);
+            ret.insert(ret.end(), ndxs.begin(), ndxs.end());
+        }
+        return ret;
+    }
+
     SizeOperator<int64_t> size();
 
     ColumnListElementLength<T> element_lengths() const
@@ -2944,6 +2986,11 @@ public:
         return std::unique_ptr<Subexpr>(new ColumnListSize<T>(*this));
     }
 
+    bool has_search_index() const override
+    {
+        return false;
+    }
+
 private:
     template <typename StorageType>
     void evaluate(size_t index, ValueBase& destination)
@@ -4089,17 +4136,12 @@ public:
         double dT = m_left_is_const ? 10.0 : 50.0;
         if (std::is_same_v<TCond, Equal> && m_left_is_const && m_right->has_search_index() &&
             m_right->get_comparison_type() == ExpressionComparisonType::Any) {
-            if (m_left_value.is_null()) {
-                m_matches = m_right->find_all(Mixed());
-            }
-            else {
-                if (m_right->get_type() != m_left_value.get_type()) {
-                    // If the type we are looking for is not the same type as the target
-                    // column, we cannot use the index
-                    return dT;
-                }
-                m_matches = m_right->find_all(m_left_value);
+            if (!m_right->index_supports(m_left_value)) {
+                // If the type we are looking for is not the same type as the target
+                // column, we cannot use the index
+                return dT;
             }
+            m_matches = m_right->find_all(m_left_value);
             // Sort
             std::sort(m_matches.begin(), m_matches.end());
             // Remove all duplicates
@@ -0,0 +1,89 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_SEARCH_INDEX_HPP
+#define REALM_SEARCH_INDEX_HPP
+
+#include <vector>
+
+#include <realm/column_type.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+
+/*
+The SearchIndex class is the interface of the index of a single column. A Table holds one accessor per column, and
+the class of the accessor follows from the IndexType of the column:
+
+       General          StringIndex, or CollectionIndex for a list, set or dictionary column
+       Ordered          RangeIndex
+       Fulltext         FullTextIndex
+       CaseInsensitive  StringIndex of a case folded column
+
+Through this interface the table keeps any index up to date without knowing its class. Values are passed as Mixed,
+and each index stores them in its own form. Lookups of the specific indexes (ranges, prefixes, the values of a
+collection) are reached through the typed accessors of Table.
+*/
+
+namespace realm {
+
+class ArrayParent;
+class ClusterColumn;
+
+class SearchIndex {
+public:
+    virtual ~SearchIndex() noexcept {}
+
+    virtual IndexType get_index_type() const noexcept = 0;
+    virtual ColKey get_column_key() const = 0;
+
+    // Accessor concept:
+    virtual void destroy() noexcept = 0;
+    virtual void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept = 0;
+    virtual void update_from_parent() noexcept = 0;
+    virtual void refresh_accessor_tree(const ClusterColumn& target_column) = 0;
+    virtual ref_type get_ref() const noexcept = 0;
+
+    // SearchIndex interface:
+
+    /// Add the entries of `value` for the object. For a CollectionIndex,
+    /// another occurrence of `value` was added to the collection.
+    virtual void insert(ObjKey key, const Mixed& value) = 0;
+    /// Replace the entries of the object by those of `new_value`. Must be
+    /// called before the new value is stored in the column, as the current
+    /// value is read from it to locate the entries. For a CollectionIndex, the
+    /// collection is left holding `new_value` alone.
+    virtual void set(ObjKey key, const Mixed& new_value) = 0;
+    /// Remove all entries of the object
+    virtual void erase(ObjKey key) = 0;
+    virtual void clear() = 0;
+
+    /// The lowest key among the objects matching `value`, or a null key. What
+    /// matches is defined by the index: equality, holding all words of the
+    /// text, or holding the value in the collection.
+    virtual ObjKey find_first(const Mixed& value) const = 0;
+    /// Append the keys of the objects matching `value` to `result`
+    virtual void find_all(std::vector<ObjKey>& result, const Mixed& value) const = 0;
+    /// The number of objects matching `value`
+    virtual size_t count(const Mixed& value) const = 0;
+
+    virtual void verify() const = 0;
+};
+
+} // namespace realm
+
+#endif // REALM_SEARCH_INDEX_HPP
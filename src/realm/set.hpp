@@ -20,6 +20,7 @@
 #define REALM_SET_HPP
 
 #include <realm/collection.hpp>
+#include <realm/index_collection.hpp>
 #include <realm/bplustree.hpp>
 #include <realm/array_key.hpp>
 
@@ -743,6 +744,8 @@ inline void Set<T>::clear()
         if (Replication* repl = this->m_obj.get_replication()) {
             this->clear_repl(repl);
         }
+        if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+            index->erase(m_obj.get_key());
         m_tree->clear();
         bump_content_version();
 
@@ -824,12 +827,16 @@ inline void Set<T>::distinct(std::vector<size_t>& indices, util::Optional<bool>
 template <class T>
 void Set<T>::do_insert(size_t ndx, T value)
 {
+    if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+        index->insert(m_obj.get_key(), Mixed(value));
     m_tree->insert(ndx, value);
 }
 
 template <class T>
 void Set<T>::do_erase(size_t ndx)
 {
+    if (CollectionIndex* index = m_obj.get_collection_index(m_col_key))
+        index->erase(m_obj.get_key(), Mixed(m_tree->get(ndx)));
     m_tree->erase(ndx);
 }
 
@@ -20,9 +20,98 @@
 #include <realm/table.hpp>
 #include <realm/db.hpp>
 #include <realm/util/assert.hpp>
+#include <realm/util/worker_pool.hpp>
 #include <realm/list.hpp>
 
 using namespace realm;
+using util::run_in_parallel;
+
+namespace {
+
+// Views smaller than this are always sorted on the calling thread
+constexpr size_t s_min_parallel_sort_size = 10000;
+
+// Sort `v` by `predicate`. Large views are split into runs which are sorted
+// on the threads of the shared worker pool and then merged pairwise. As the
+// predicate is a total ordering, the result is the same as for a sequential
+// sort.
+void sort_index_pairs(BaseDescriptor::IndexPairs& v, const BaseDescriptor::Sorter& predicate)
+{
+    size_t num_runs = std::min(predicate.get_max_threads(), v.size() / (s_min_parallel_sort_size / 2));
+    if (num_runs <= 1 || v.size() < s_min_parallel_sort_size) {
+        std::sort(v.begin(), v.end(), std::ref(predicate));
+        return;
+    }
+
+    std::vector<size_t> run_begin;
+    for (size_t i = 0; i <= num_runs; ++i)
+        run_begin.push_back(i * v.size() / num_runs);
+
+    run_in_parallel(num_runs, [&](size_t run) {
+        std::sort(v.begin() + run_begin[run], v.begin() + run_begin[run + 1], std::ref(predicate));
+    });
+
+    // Merge neighbouring runs until one is left. The merges of a round are
+    // independent of each other.
+    for (size_t width = 1; width < num_runs; width *= 2) {
+        size_t num_merges = (num_runs + 2 * width - 1) / (2 * width);
+        run_in_parallel(num_merges, [&](size_t merge) {
+            size_t first = 2 * width * merge;
+            size_t middle = first + width;
+            if (middle >= num_runs)
+                return;
+            size_t last = std::min(middle + width, num_runs);
+            std::inplace_merge(v.begin() + run_begin[first], v.begin() + run_begin[middle],
+                               v.begin() + run_begin[last], std::ref(predicate));
+        });
+    }
+}
+
+// True if comparing the values returned by Obj::get_any() gives the same
+// result as Obj::cmp() for columns of this type
+bool can_cache_column(ColKey col)
+{
+    switch (col.get_type()) {
+        case col_type_Int:
+        case col_type_String:
+        case col_type_Float:
+        case col_type_Double:
+        case col_type_Timestamp:
+        case col_type_ObjectId:
+        case col_type_UUID:
+        case col_type_Mixed:
+            return !col.is_collection();
+        default:
+            return false;
+    }
+}
+
+// Compare cached values like Obj::cmp() compares the objects
+int compare_cached_values(ColKey col, const Mixed& a, const Mixed& b)
+{
+    switch (col.get_type()) {
+        case col_type_String: {
+            // Strings are compared bytewise, not by Mixed::compare()
+            StringData str_a = a.is_null() ? StringData() : a.get_string();
+            StringData str_b = b.is_null() ? StringData() : b.get_string();
+            return str_a < str_b ? -1 : (str_b < str_a ? 1 : 0);
+        }
+        case col_type_Float:
+        case col_type_Double: {
+            // Null is stored as NaN, which is neither smaller nor greater
+            // than any value
+            if (a.is_null() || b.is_null())
+                return 0;
+            double val_a = col.get_type() == col_type_Float ? double(a.get_float()) : a.get_double();
+            double val_b = col.get_type() == col_type_Float ? double(b.get_float()) : b.get_double();
+            return val_a < val_b ? -1 : (val_a > val_b ? 1 : 0);
+        }
+        default:
+            return a.compare(b);
+    }
+}
+
+} // unnamed namespace
 
 LinkPathPart::LinkPathPart(ColKey col_key, ConstTableRef source)
     : column_key(col_key)
@@ -221,7 +310,7 @@ void DistinctDescriptor::execute(IndexPairs& v, const Sorter& predicate, const B
     }
 
     // Sort by the columns to distinct on
-    std::sort(v.begin(), v.end(), std::ref(predicate));
+    sort_index_pairs(v, predicate);
 
     // Move duplicates to the back - "not less than" is "equal" since they're sorted
     auto duplicates = std::unique(v.begin(), v.end(), [&](const IP& a, const IP& b) {
@@ -252,7 +341,20 @@ BaseDescriptor::Sorter SortDescriptor::sorter(Table const& table, const IndexPai
 
 void SortDescriptor::execute(IndexPairs& v, const Sorter& predicate, const BaseDescriptor* next) const
 {
-    std::sort(v.begin(), v.end(), std::ref(predicate));
+    // When followed by a limit, only the first `limit` entries need to be in
+    // order. The rest is removed by the LimitDescriptor.
+    if (next && next->get_type() == DescriptorType::Limit) {
+        size_t limit = static_cast<const LimitDescriptor*>(next)->get_limit();
+        if (limit < v.size()) {
+            std::partial_sort(v.begin(), v.begin() + limit, v.end(), std::ref(predicate));
+        }
+        else {
+            sort_index_pairs(v, predicate);
+        }
+    }
+    else {
+        sort_index_pairs(v, predicate);
+    }
 
     // not doing this on the last step is an optimisation
     if (next) {
@@ -311,6 +413,10 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
         if (t == 0) {
             c = i.cached_value.compare(j.cached_value);
         }
+        else if (!m_columns[t].cached_values.empty()) {
+            auto& values = m_columns[t].cached_values;
+            c = compare_cached_values(m_columns[t].col_key, values[i.index_in_view], values[j.index_in_view]);
+        }
         else {
             ObjKey key_i = i.key_for_object;
             ObjKey key_j = j.key_for_object;
@@ -333,28 +439,44 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
     return total_ordering ? i.index_in_view < j.index_in_view : 0;
 }
 
-void BaseDescriptor::Sorter::cache_first_column(IndexPairs& v)
+void BaseDescriptor::Sorter::cache_columns(IndexPairs& v)
 {
-    if (m_columns.empty())
+    if (m_columns.empty() || v.empty())
         return;
 
-    auto& col = m_columns[0];
-    ColKey ck = col.col_key;
-    for (size_t i = 0; i < v.size(); i++) {
-        IndexPair& index = v[i];
-        ObjKey key = index.key_for_object;
-
+    auto get_key = [](const SortColumn& col, const IndexPair& index, ObjKey& key) {
+        key = index.key_for_object;
         if (!col.translated_keys.empty()) {
-            if (col.is_null[i]) {
-                index.cached_value = Mixed();
-                continue;
-            }
-            else {
-                key = col.translated_keys[v[i].index_in_view];
-            }
+            if (col.is_null[index.index_in_view])
+                return false;
+            key = col.translated_keys[index.index_in_view];
+        }
+        return true;
+    };
+
+    auto& first = m_columns[0];
+    for (auto& index : v) {
+        ObjKey key;
+        if (get_key(first, index, key)) {
+            index.cached_value = first.table->get_object(key).get_any(first.col_key);
         }
+        else {
+            index.cached_value = Mixed();
+        }
+    }
 
-        index.cached_value = col.table->get_object(key).get_any(ck);
+    size_t translated_size = std::max_element(v.begin(), v.end())->index_in_view + 1;
+    for (size_t t = 1; t < m_columns.size(); ++t) {
+        auto& col = m_columns[t];
+        if (!can_cache_column(col.col_key))
+            continue;
+        col.cached_values.resize(translated_size);
+        for (auto& index : v) {
+            ObjKey key;
+            // Entries with a null link are ordered before the values are compared
+            if (get_key(col, index, key))
+                col.cached_values[index.index_in_view] = col.table->get_object(key).get_any(col.col_key);
+        }
     }
 }
 
@@ -92,7 +92,24 @@ public:
                 return col.is_null.empty() ? false : col.is_null[i.index_in_view];
             });
         }
-        void cache_first_column(IndexPairs& v);
+        // Read the values of the sort columns up front, so that comparisons
+        // need not look up the objects. The values of the first column are
+        // stored in IndexPair::cached_value, those of the other columns in
+        // the Sorter, if their type allows comparing the cached values with
+        // the same result as comparing the objects.
+        void cache_columns(IndexPairs& v);
+
+        // Allow SortDescriptor::execute() to sort large views on up to
+        // `max_threads` threads (including the calling thread). Only to be
+        // used when the objects cannot be modified during the sort.
+        void set_max_threads(size_t max_threads) noexcept
+        {
+            m_max_threads = max_threads;
+        }
+        size_t get_max_threads() const noexcept
+        {
+            return m_max_threads;
+        }
 
     private:
         struct SortColumn {
@@ -104,12 +121,15 @@ public:
             }
             std::vector<bool> is_null;
             std::vector<ObjKey> translated_keys;
+            // Values of the column, indexed by IndexPair::index_in_view
+            std::vector<Mixed> cached_values;
 
             const Table* table;
             ColKey col_key;
             bool ascending;
         };
         std::vector<SortColumn> m_columns;
+        size_t m_max_threads = 1;
         friend class ObjList;
     };
 
@@ -147,6 +167,11 @@ public:
     }
     void collect_dependencies(const Table* table, std::vector<TableKey>& table_keys) const override;
 
+    const std::vector<std::vector<ColKey>>& get_column_keys() const noexcept
+    {
+        return m_column_keys;
+    }
+
 protected:
     std::vector<std::vector<ColKey>> m_column_keys;
 };
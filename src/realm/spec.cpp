@@ -167,9 +167,11 @@ MemRef Spec::create_empty_spec(Allocator& alloc)
 ColKey Spec::update_colkey(ColKey existing_key, size_t spec_ndx, TableKey table_key)
 {
     auto attr = get_column_attr(spec_ndx);
-    // index and uniqueness are not passed on to the key, so clear them
+    // the kind of index is not passed on to the key, so clear it
     attr.reset(col_attr_Indexed);
-    attr.reset(col_attr_Unique);
+    attr.reset(col_attr_FullTextIndex);
+    attr.reset(col_attr_OrderedIndex);
+    attr.reset(col_attr_CaseInsensitiveIndex);
     auto type = get_column_type(spec_ndx);
     if (existing_key.get_type() != type || existing_key.get_attrs() != attr) {
         unsigned upper = unsigned(table_key.value);
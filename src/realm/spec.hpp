@@ -86,6 +86,10 @@ public:
     void verify() const;
 
 private:
+    // The bits of an element of m_attr holding column attributes. The key
+    // type of a dictionary is stored in bits 8 to 15.
+    static constexpr int64_t s_attr_mask = 0xFF | col_attr_CaseInsensitiveIndex;
+
     // Underlying array structure.
     //
     Array m_top;
@@ -230,7 +234,7 @@ inline ColumnType Spec::get_column_type(size_t ndx) const noexcept
 inline ColumnAttrMask Spec::get_column_attr(size_t ndx) const noexcept
 {
     REALM_ASSERT(ndx < get_column_count());
-    return ColumnAttrMask(m_attr.get(ndx) & 0xFF);
+    return ColumnAttrMask(m_attr.get(ndx) & s_attr_mask);
 }
 
 inline void Spec::set_dictionary_key_type(size_t ndx, DataType key_type)
@@ -242,7 +246,7 @@ inline void Spec::set_dictionary_key_type(size_t ndx, DataType key_type)
 inline DataType Spec::get_dictionary_key_type(size_t ndx) const
 {
     REALM_ASSERT(ndx < get_column_count());
-    return DataType(m_attr.get(ndx) >> 8);
+    return DataType((m_attr.get(ndx) >> 8) & 0xFF);
 }
 
 inline void Spec::set_column_attr(size_t column_ndx, ColumnAttrMask attr)
@@ -251,8 +255,9 @@ inline void Spec::set_column_attr(size_t column_ndx, ColumnAttrMask attr)
 
     // At this point we only allow one attr at a time
     // so setting it will overwrite existing. In the future
-    // we will allow combinations.
-    m_attr.set(column_ndx, attr.m_value);
+    // we will allow combinations. The key type of a dictionary,
+    // stored in bits 8 to 15, is kept.
+    m_attr.set(column_ndx, (m_attr.get(column_ndx) & ~s_attr_mask) | attr.m_value);
 
     update_internals();
 }
@@ -556,6 +556,12 @@ inline ClientImpl::ClientImpl(Client::Config config)
                  config.fast_reconnect_limit); // Throws
     logger.debug("Config param: disable_upload_compaction = %1",
                  config.disable_upload_compaction); // Throws
+    logger.debug("Config param: disable_zstd_compression = %1",
+                 config.disable_zstd_compression); // Throws
+    logger.debug("Config param: disable_lz4_compression = %1",
+                 config.disable_lz4_compression); // Throws
+    logger.debug("Config param: max_integration_batch_size = %1 bytes",
+                 config.max_integration_batch_size); // Throws
     logger.debug("Config param: tcp_no_delay = %1",
                  config.tcp_no_delay); // Throws
     logger.debug("Config param: disable_sync_to_disk = %1",
@@ -730,6 +736,9 @@ ClientImplBase::Config ClientImpl::make_client_impl_base_config(Client::Config&
     config_2.tcp_no_delay                    = config.tcp_no_delay;
     config_2.enable_default_port_hack        = config.enable_default_port_hack;
     config_2.disable_upload_compaction       = config.disable_upload_compaction;
+    config_2.disable_zstd_compression        = config.disable_zstd_compression;
+    config_2.disable_lz4_compression         = config.disable_lz4_compression;
+    config_2.max_integration_batch_size      = config.max_integration_batch_size;
     config_2.roundtrip_time_handler          = std::move(config.roundtrip_time_handler);
     // clang-format on
 
@@ -1530,6 +1539,10 @@ auto SessionWrapper::make_session_impl_config(SyncTransactReporter& transact_rep
     config_2.sync_transact_reporter = &transact_reporter;
     config_2.disable_upload = config.disable_upload;
     config_2.disable_empty_upload = config.disable_empty_upload;
+    if (!config.zstd_dictionary.empty()) {
+        BinaryData content{config.zstd_dictionary.data(), config.zstd_dictionary.size()};
+        config_2.zstd_dictionary = std::make_shared<_impl::compression::ZstdDictionary>(content); // Throws
+    }
     return config_2;
 }
 
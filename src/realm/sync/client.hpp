@@ -193,6 +193,30 @@ public:
         /// consumption.
         bool disable_upload_compaction = false;
 
+        /// If `disable_zstd_compression` is true, UPLOAD message bodies are
+        /// never compressed with Zstd, even when the server supports it. zlib
+        /// takes several times more CPU time, and usually produces larger
+        /// bodies. DOWNLOAD message bodies compressed with Zstd are still
+        /// accepted.
+        bool disable_zstd_compression = false;
+
+        /// If `disable_lz4_compression` is true, UPLOAD message bodies are
+        /// never compressed with LZ4, even when the server supports it. LZ4
+        /// takes the least CPU time, but produces larger bodies than Zstd and
+        /// zlib. DOWNLOAD message bodies compressed with LZ4 are still
+        /// accepted.
+        bool disable_lz4_compression = false;
+
+        /// The changesets of a DOWNLOAD message are integrated in batches,
+        /// each in its own transaction, and each of a size that does not exceed
+        /// `max_integration_batch_size` bytes unless it consists of a single
+        /// changeset. This bounds the size of each transaction, however large
+        /// the history downloaded during bootstrapping is. It does not bound
+        /// the memory used by the client, which holds the decompressed body of
+        /// the message and all of its parsed changesets until the last batch
+        /// has been integrated.
+        std::size_t max_integration_batch_size = 0x1000000; // 16 MiB
+
         /// Set the `TCP_NODELAY` option on all TCP/IP sockets. This disables
         /// the Nagle algorithm. Disabling it, can in some cases be used to
         /// decrease latencies, but possibly at the expense of scalability. Be
@@ -623,6 +647,17 @@ public:
         /// This feature exists exclusively for testing purposes at this time.
         bool disable_empty_upload = false;
 
+        /// The content of a pre-trained Zstandard dictionary for the schema of
+        /// this Realm, as produced by `zstd --train`, or empty for none. If the
+        /// server has a dictionary with the same ID (it lists the IDs in the
+        /// handshake response), the session is bound to it, and the bodies of
+        /// the UPLOAD and DOWNLOAD messages of the session are compressed with
+        /// Zstd and the dictionary. Small bodies compress much better this way.
+        ///
+        /// The session constructor throws if this is not a Zstandard
+        /// dictionary, or if the library was built without Zstandard.
+        std::string zstd_dictionary;
+
         /// Set to true to cause the integration of the first received changeset
         /// (in a DOWNLOAD message) to fail.
         ///
@@ -411,6 +411,15 @@ public:
     /// changeset to the cooker after operational transformation; that is, when
     /// the chageset is ready to be applied to the local Realm state.
     std::shared_ptr<ChangesetCooker> changeset_cooker;
+
+    /// The maximum number of threads used to parse the incoming changesets,
+    /// and the local changesets that they are transformed against, during
+    /// ClientHistory::integrate_server_changesets(). Besides the calling
+    /// thread, these are threads of the worker pool shared with parallel
+    /// queries and sorting (see util::WorkerPool). Small batches are always
+    /// parsed on the calling thread. Zero means as many as there are hardware
+    /// threads.
+    unsigned max_integration_threads = 4;
 };
 
 /// \brief Create a "sync history" implementation of the realm::Replication
@@ -198,6 +198,17 @@ void ChangesetIndex::add_changeset(Changeset& log)
                 REALM_ASSERT(&cg == &object_conflict_group(ids[i]));
             }
             add_instruction_at(cg.ranges, log, it);
+
+            // Instructions are added in the order of the changeset, so the
+            // positions stay sorted.
+            if (auto path_instr = instr.get_if<Instruction::PathInstruction>()) {
+                size_t hash = hash_property(ids[0], log.get_string(path_instr->field));
+                cg.property_index.properties[hash][&log].push_back(it);
+                cg.property_index.paths[hash_object(ids[0])][&log].push_back(it);
+            }
+            else {
+                cg.property_index.objects[hash_object(ids[0])][&log].push_back(it);
+            }
         }
     }
 }
@@ -270,6 +281,51 @@ auto ChangesetIndex::get_modifications_for_object(GlobalID id) const -> const Ra
     return const_cast<ChangesetIndex*>(this)->get_modifications_for_object(id);
 }
 
+auto ChangesetIndex::get_property_index_for_object(GlobalID id) const -> const PropertyIndex*
+{
+    if (m_contains_destructive_schema_changes)
+        return nullptr;
+    auto it = m_object_instructions.find(id.table_name);
+    if (it == m_object_instructions.end())
+        return nullptr;
+
+    auto& object_instructions = it->second;
+    auto it2 = object_instructions.find(id.object_id);
+    if (it2 == object_instructions.end())
+        return nullptr;
+    return &it2->second->property_index;
+}
+
+auto ChangesetIndex::PropertyIndex::find_property(size_t hash) const noexcept -> const Positions*
+{
+    auto it = properties.find(hash);
+    return it == properties.end() ? nullptr : &it->second;
+}
+
+auto ChangesetIndex::PropertyIndex::find_paths(size_t hash) const noexcept -> const Positions*
+{
+    auto it = paths.find(hash);
+    return it == paths.end() ? nullptr : &it->second;
+}
+
+auto ChangesetIndex::PropertyIndex::find_object(size_t hash) const noexcept -> const Positions*
+{
+    auto it = objects.find(hash);
+    return it == objects.end() ? nullptr : &it->second;
+}
+
+size_t ChangesetIndex::hash_object(const GlobalID& id) noexcept
+{
+    size_t h = std::hash<StringData>{}(id.table_name);
+    return h ^ (std::hash<PrimaryKey>{}(id.object_id) + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
+size_t ChangesetIndex::hash_property(const GlobalID& id, StringData field) noexcept
+{
+    size_t h = hash_object(id);
+    return h ^ (std::hash<StringData>{}(field) + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
 auto ChangesetIndex::schema_conflict_group(StringData class_name) -> ConflictGroup&
 {
     auto& conflict_group = m_schema_instructions[class_name];
@@ -434,6 +490,19 @@ void ChangesetIndex::verify() const
         for (auto& ranges : cg.ranges) {
             changesets.insert(ranges.first);
         }
+
+        // Check that the property index only refers to instructions in the
+        // conflict group.
+        for (auto buckets : {&cg.property_index.properties, &cg.property_index.paths, &cg.property_index.objects}) {
+            for (auto& bucket : *buckets) {
+                for (auto& pair : bucket.second) {
+                    REALM_ASSERT(std::is_sorted(pair.second.begin(), pair.second.end()));
+                    for (auto& pos : pair.second) {
+                        REALM_ASSERT(ranges_cover(cg.ranges, *pair.first, pos));
+                    }
+                }
+            }
+        }
     }
 
     // Run through all instructions in each changeset and check that
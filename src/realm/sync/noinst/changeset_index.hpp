@@ -2,6 +2,7 @@
 #ifndef REALM_NOINST_CHANGESET_INDEX_HPP
 #define REALM_NOINST_CHANGESET_INDEX_HPP
 
+#include <algorithm>
 #include <deque>
 #include <list>
 #include <map>
@@ -10,6 +11,7 @@
 #include <realm/sync/changeset.hpp>
 #include <realm/util/metered/map.hpp>
 #include <realm/util/metered/set.hpp>
+#include <realm/util/metered/unordered_map.hpp>
 #include <realm/util/metered/vector.hpp>
 
 namespace realm {
@@ -40,6 +42,37 @@ struct ChangesetIndex {
     using Ranges =
         util::metered::map<Changeset*, util::metered::vector<Changeset::Range>, CompareChangesetPointersByVersion>;
 
+    // This is always sorted by (changeset->version, position).
+    using Positions =
+        util::metered::map<Changeset*, util::metered::vector<Changeset::iterator>, CompareChangesetPointersByVersion>;
+
+    /// The instructions of a conflict group, hashed by the object and property
+    /// they modify.
+    ///
+    /// An instruction that modifies a property of an object can only conflict
+    /// with instructions modifying the same property of the same object, and
+    /// with the creation or erasure of that object. The creation or erasure of
+    /// an object can only conflict with instructions on the same object. The
+    /// merge algorithm uses this to skip the other instructions in the conflict
+    /// group. Different objects or properties may hash to the same bucket,
+    /// which only means that some instructions that cannot conflict are
+    /// visited anyway.
+    struct PropertyIndex {
+        // Path instructions, by hash_property().
+        util::metered::unordered_map<size_t, Positions> properties;
+        // Path instructions, by hash_object().
+        util::metered::unordered_map<size_t, Positions> paths;
+        // CreateObject and EraseObject instructions, by hash_object().
+        util::metered::unordered_map<size_t, Positions> objects;
+
+        const Positions* find_property(size_t hash) const noexcept;
+        const Positions* find_paths(size_t hash) const noexcept;
+        const Positions* find_object(size_t hash) const noexcept;
+    };
+
+    static size_t hash_object(const GlobalID&) noexcept;
+    static size_t hash_property(const GlobalID&, StringData field) noexcept;
+
     /// Scan changeset to discover objects connected by link instructions,
     /// classes connected by link columns, and destructive schema changes.
     ///
@@ -77,6 +110,12 @@ struct ChangesetIndex {
     const Ranges* get_modifications_for_object(GlobalID id) const;
     //@}
 
+    /// Returns the instructions returned by `get_modifications_for_object()`
+    /// hashed by the object and property they modify, or null if they have to
+    /// be visited in full because the changesets contain destructive schema
+    /// changes.
+    const PropertyIndex* get_property_index_for_object(GlobalID id) const;
+
     //@{
     /// Returns the ranges for all instructions added to the index.
     ///
@@ -115,6 +154,7 @@ struct ChangesetIndex {
 private:
     struct ConflictGroup {
         Ranges ranges;
+        PropertyIndex property_index;
         util::metered::map<StringData, util::metered::vector<PrimaryKey>> objects;
         util::metered::vector<StringData> schemas;
         size_t size = 0;
@@ -180,6 +220,24 @@ struct ChangesetIndex::RangeIterator {
         }
     }
 
+    /// Create an iterator pointing at \a pos, which must be covered by the
+    /// ranges for \a changeset.
+    RangeIterator(ChangesetIndex::Ranges* ranges, Changeset* changeset, Changeset::iterator pos) noexcept
+        : m_ranges(ranges)
+        , m_outer(ranges->find(changeset))
+    {
+        REALM_ASSERT(m_outer != ranges->end());
+        auto& ranges_for_changeset = m_outer->second;
+        m_inner = std::upper_bound(ranges_for_changeset.begin(), ranges_for_changeset.end(), pos,
+                                   [](const Changeset::iterator& pos, const Changeset::Range& range) {
+                                       return pos < range.begin;
+                                   });
+        REALM_ASSERT(m_inner != ranges_for_changeset.begin());
+        --m_inner;
+        m_pos = pos;
+        check();
+    }
+
     struct end_tag {
     };
     /// Create an iterator representing the end.
@@ -476,6 +476,23 @@ bool ClientHistoryImpl::integrate_server_changesets(const SyncProgress& progress
     // (due to technical debt) is unable in some cases to produce a correct
     // changeset while applying another one (i.e., it cannot carbon copy).
 
+    REALM_ASSERT(num_changesets != 0);
+
+    // Parsing does not depend on the state of the Realm, so it is done before
+    // the write transaction is started, and on several threads when the
+    // changesets are large enough.
+    std::vector<sync::Changeset> changesets;
+    changesets.resize(num_changesets); // Throws
+    try {
+        sync::parse_remote_changesets(incoming_changesets, num_changesets, changesets.data(),
+                                      m_max_integration_threads); // Throws
+    }
+    catch (sync::TransformError& e) {
+        logger.error("Failed to parse received changeset: %1", e.what()); // Throws
+        integration_error = IntegrationError::bad_changeset;
+        return false;
+    }
+
     VersionID old_version;
     TransactionRef transact;
     auto cleanup = util::make_scope_exit([&transact]() noexcept {
@@ -490,8 +507,6 @@ bool ClientHistoryImpl::integrate_server_changesets(const SyncProgress& progress
         }
     });
 
-    REALM_ASSERT(num_changesets != 0);
-
     transact = m_shared_group->start_write(); // Throws
     // FIXME: Using SharedGroup::get_version_of_current_transaction() is not as
     // efficient as using SharedGroupFriend::get_version_of_bound_snapshot(),
@@ -516,8 +531,6 @@ bool ClientHistoryImpl::integrate_server_changesets(const SyncProgress& progress
 
     std::vector<char> assembled_transformed_changeset;
     util::AppendBuffer<char> cooked_changeset_buffer;
-    std::vector<sync::Changeset> changesets;
-    changesets.resize(num_changesets); // Throws
 
     std::uint_fast64_t downloaded_bytes_in_message = 0;
 
@@ -529,8 +542,6 @@ bool ClientHistoryImpl::integrate_server_changesets(const SyncProgress& progress
                          changeset.origin_file_ident != transact->get_sync_file_id());
             downloaded_bytes_in_message += changeset.original_changeset_size;
 
-            sync::parse_remote_changeset(changeset, changesets[i]); // Throws
-
             // It is possible that the synchronization history has been trimmed
             // to a point where a prefix of the merge window is no longer
             // available, but this can only happen if that prefix consisted
@@ -285,6 +285,8 @@ private:
 
     const std::shared_ptr<ChangesetCooker> m_changeset_cooker;
 
+    const unsigned m_max_integration_threads;
+
     /// A cache of the `s_ch_base_index_iip` slot in the history compartment
     /// root array. When the cooked history is not empty, this is the index into
     /// the total untrimmed sequence of cooked changesets of the first cooked
@@ -349,6 +351,7 @@ inline ClientHistoryImpl::ClientHistoryImpl(const std::string& realm_path, Confi
     : ClientReplication{realm_path}
     , m_owner_is_sync_client{config.owner_is_sync_agent}
     , m_changeset_cooker{std::move(config.changeset_cooker)}
+    , m_max_integration_threads{config.max_integration_threads}
 {
 }
 
@@ -357,6 +360,7 @@ inline ClientHistoryImpl::ClientHistoryImpl(const std::string& realm_path, bool
     : ClientReplication{realm_path} // Throws
     , m_owner_is_sync_client{owner_is_sync_client}
     , m_changeset_cooker{std::move(changeset_cooker)}
+    , m_max_integration_threads{Config{}.max_integration_threads}
 {
 }
 
@@ -403,7 +407,7 @@ inline void ClientHistoryImpl::clamp_sync_version_range(version_type& begin, ver
 inline auto ClientHistoryImpl::get_transformer() -> Transformer&
 {
     if (!m_transformer)
-        m_transformer = sync::make_transformer(); // Throws
+        m_transformer = sync::make_transformer(m_max_integration_threads); // Throws
     return *m_transformer;
 }
 
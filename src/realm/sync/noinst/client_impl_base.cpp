@@ -118,6 +118,9 @@ ClientImplBase::ClientImplBase(Config config)
     , m_tcp_no_delay{config.tcp_no_delay}
     , m_enable_default_port_hack{config.enable_default_port_hack}
     , m_disable_upload_compaction{config.disable_upload_compaction}
+    , m_disabled_codecs{(config.disable_zstd_compression ? compression::codec_set(compression::Codec::zstd) : 0) |
+                        (config.disable_lz4_compression ? compression::codec_set(compression::Codec::lz4) : 0)}
+    , m_max_integration_batch_size{config.max_integration_batch_size}
     , m_roundtrip_time_handler{std::move(config.roundtrip_time_handler)}
     , m_user_agent_string{make_user_agent_string(config)} // Throws
     , m_service{}                                         // Throws
@@ -361,6 +364,7 @@ void Connection::websocket_handshake_completion_handler(const HTTPHeaders& heade
                 if (good_version) {
                     logger.detail("Negotiated protocol version: %1", value_2);
                     m_negotiated_protocol_version = value_2;
+                    receive_codec_headers(headers); // Throws
                     handle_connection_established(); // Throws
                     return;
                 }
@@ -377,6 +381,24 @@ void Connection::websocket_handshake_completion_handler(const HTTPHeaders& heade
 }
 
 
+void Connection::receive_codec_headers(const HTTPHeaders& headers)
+{
+    // A server that omits the headers only knows zlib, and has no Zstandard
+    // dictionaries
+    util::StringView codecs, dictionaries;
+    auto i = headers.find(_impl::g_sync_codecs_header);
+    if (i != headers.end())
+        codecs = i->second;
+    auto j = headers.find(_impl::g_sync_zstd_dictionaries_header);
+    if (j != headers.end())
+        dictionaries = j->second;
+    m_server_codecs = _impl::parse_codec_list(codecs);
+    m_server_zstd_dictionaries = _impl::parse_zstd_dictionary_list(dictionaries); // Throws
+    logger.debug("Server codecs: '%1', Zstandard dictionaries: '%2'", _impl::format_codec_list(m_server_codecs),
+                 dictionaries); // Throws
+}
+
+
 void Connection::websocket_read_error_handler(std::error_code ec)
 {
     read_error(ec); // Throws
@@ -946,7 +968,9 @@ void Connection::initiate_websocket_handshake()
     HTTPHeaders headers;
     ClientImplBase& client = get_client();
     headers["User-Agent"] = client.get_user_agent_string(); // Throws
-    set_http_request_headers(headers);                      // Throws
+    headers[_impl::g_sync_codecs_header] =
+        _impl::format_codec_list(compression::get_available_codecs()); // Throws
+    set_http_request_headers(headers);                                  // Throws
 
     m_websocket.initiate_client_handshake(path, m_http_host, sec_websocket_protocol,
                                           std::move(headers)); // Throws
@@ -1713,22 +1737,46 @@ bool Session::integrate_changesets(ClientHistoryBase& history, const SyncProgres
         history.set_sync_progress(progress, &downloadable_bytes, version_info); // Throws
         return true;
     }
+    // The changesets are integrated in batches of bounded size. Each batch is
+    // integrated as if the server had sent it in a DOWNLOAD message of its
+    // own, that is, with the download progress reached by its last changeset,
+    // and with the remaining changesets of the message counted as
+    // downloadable.
     const sync::Transformer::RemoteChangeset* changesets = received_changesets.data();
     std::size_t num_changesets = received_changesets.size();
-    bool success = history.integrate_server_changesets(progress, &downloadable_bytes, changesets, num_changesets,
-                                                       version_info, error, logger,
-                                                       m_sync_transact_reporter); // Throws
-    if (REALM_LIKELY(success)) {
-        if (num_changesets == 1) {
+    std::size_t max_batch_size = get_client().m_max_integration_batch_size;
+    std::size_t begin = 0;
+    while (begin < num_changesets) {
+        std::size_t end = begin + 1;
+        std::size_t batch_size = changesets[begin].data.size();
+        while (end < num_changesets && batch_size + changesets[end].data.size() <= max_batch_size) {
+            batch_size += changesets[end].data.size();
+            ++end;
+        }
+        SyncProgress batch_progress = progress;
+        std::uint_fast64_t batch_downloadable_bytes = downloadable_bytes;
+        if (end < num_changesets) {
+            const sync::Transformer::RemoteChangeset& last = changesets[end - 1];
+            batch_progress.download = {last.remote_version, last.last_integrated_local_version};
+            for (std::size_t i = end; i < num_changesets; ++i)
+                batch_downloadable_bytes += changesets[i].original_changeset_size;
+        }
+        bool success = history.integrate_server_changesets(batch_progress, &batch_downloadable_bytes,
+                                                           changesets + begin, end - begin, version_info, error,
+                                                           logger, m_sync_transact_reporter); // Throws
+        if (REALM_UNLIKELY(!success))
+            return false;
+        if (end - begin == 1) {
             logger.debug("1 remote changeset integrated, producing client version %1",
                          version_info.sync_version.version); // Throws
         }
         else {
             logger.debug("%2 remote changesets integrated, producing client version %1",
-                         version_info.sync_version.version, num_changesets); // Throws
+                         version_info.sync_version.version, end - begin); // Throws
         }
+        begin = end;
     }
-    return success;
+    return true;
 }
 
 
@@ -2056,16 +2104,26 @@ void Session::send_bind_message()
     const std::string& signed_access_token = get_signed_access_token();
     bool need_client_file_ident = !have_client_file_ident();
 
+    int protocol_version = m_conn.get_negotiated_protocol_version();
+
+    // The session is bound to the Zstandard dictionary only if the server has
+    // one with the same ID
+    m_bound_zstd_dictionary = nullptr;
+    if (m_zstd_dictionary && protocol_version >= 2 &&
+        m_conn.server_has_zstd_dictionary(m_zstd_dictionary->get_id()))
+        m_bound_zstd_dictionary = m_zstd_dictionary.get();
+    std::uint_fast32_t zstd_dictionary_id = (m_bound_zstd_dictionary ? m_bound_zstd_dictionary->get_id() : 0);
+
     logger.debug("Sending: BIND(path='%1', signed_user_token_size=%2, "
-                 "need_client_file_ident=%3, is_subserver=%4)",
-                 path, signed_access_token.size(), int(need_client_file_ident), int(m_is_subserver)); // Throws
+                 "need_client_file_ident=%3, is_subserver=%4, zstd_dictionary_id=%5)",
+                 path, signed_access_token.size(), int(need_client_file_ident), int(m_is_subserver),
+                 zstd_dictionary_id); // Throws
 
     ClientProtocol& protocol = m_conn.get_client_protocol();
-    int protocol_version = m_conn.get_negotiated_protocol_version();
     OutputBuffer& out = m_conn.get_output_buffer();
     protocol.make_bind_message(protocol_version, out, session_ident, path, signed_access_token,
-                               need_client_file_ident, m_is_subserver); // Throws
-    m_conn.initiate_write_message(out, this);                           // Throws
+                               need_client_file_ident, m_is_subserver, zstd_dictionary_id); // Throws
+    m_conn.initiate_write_message(out, this);                                               // Throws
 
     m_bind_message_sent = true;
     m_access_token_sent = true;
@@ -2282,10 +2340,12 @@ void Session::send_upload_message()
     int protocol_version = m_conn.get_negotiated_protocol_version();
     OutputBuffer& out = m_conn.get_output_buffer();
     session_ident_type session_ident = get_ident();
+    auto codec = _impl::select_body_codec(protocol_version, m_conn.get_server_codecs(),
+                                          get_client().m_disabled_codecs, m_bound_zstd_dictionary != nullptr);
     upload_message_builder.make_upload_message(protocol_version, out, session_ident, progress_client_version,
-                                               progress_server_version,
-                                               locked_server_version); // Throws
-    m_conn.initiate_write_message(out, this);                          // Throws
+                                               progress_server_version, locked_server_version, codec,
+                                               m_bound_zstd_dictionary); // Throws
+    m_conn.initiate_write_message(out, this);                            // Throws
 
     // Other messages may be waiting to be sent
     enlist_to_send(); // Throws
@@ -2,6 +2,7 @@
 #ifndef REALM_NOINST_CLIENT_IMPL_BASE_HPP
 #define REALM_NOINST_CLIENT_IMPL_BASE_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <utility>
 #include <functional>
@@ -94,6 +95,8 @@ private:
     const bool m_tcp_no_delay;
     const bool m_enable_default_port_hack;
     const bool m_disable_upload_compaction;
+    const compression::CodecSet m_disabled_codecs;
+    const std::size_t m_max_integration_batch_size;
     const std::function<RoundtripTimeHandler> m_roundtrip_time_handler;
     const std::string m_user_agent_string;
     util::network::Service m_service;
@@ -134,6 +137,9 @@ public:
     bool tcp_no_delay = false;
     bool enable_default_port_hack = false;
     bool disable_upload_compaction = false;
+    bool disable_zstd_compression = false;
+    bool disable_lz4_compression = false;
+    std::size_t max_integration_batch_size = 0x1000000; // 16 MiB
     std::function<RoundtripTimeHandler> roundtrip_time_handler;
 };
 
@@ -287,6 +293,19 @@ public:
     /// than or equal to sync::get_current_protocol_version().
     int get_negotiated_protocol_version() noexcept;
 
+    /// Returns the body codecs that the server listed in the handshake
+    /// response, see _impl::g_sync_codecs_header.
+    compression::CodecSet get_server_codecs() const noexcept;
+
+    /// Returns true if the server listed a Zstandard dictionary with the
+    /// specified ID in the handshake response.
+    bool server_has_zstd_dictionary(std::uint_fast32_t id) const noexcept;
+
+    /// Returns the Zstandard dictionary that the specified session is bound
+    /// to, or null if there is no such session, or if it is not bound to a
+    /// dictionary.
+    const compression::ZstdDictionary* get_zstd_dictionary(session_ident_type) const noexcept;
+
     // Overriding methods in util::websocket::Config
     util::Logger& websocket_get_logger() noexcept override;
     std::mt19937_64& websocket_get_random() noexcept override;
@@ -383,6 +402,8 @@ private:
     util::Optional<util::HTTPClient<Connection>> m_proxy_client;
     ReconnectInfo m_reconnect_info;
     int m_negotiated_protocol_version = 0;
+    compression::CodecSet m_server_codecs = 0;
+    std::vector<std::uint_fast32_t> m_server_zstd_dictionaries;
 
     enum class State { disconnected, connecting, connected };
     State m_state = State::disconnected;
@@ -481,6 +502,7 @@ private:
     void initiate_ssl_handshake();
     void handle_ssl_handshake(std::error_code);
     void initiate_websocket_handshake();
+    void receive_codec_headers(const util::HTTPHeaders&);
     void handle_connection_established();
     void schedule_urgent_ping();
     void initiate_ping_delay(milliseconds_type now);
@@ -904,6 +926,11 @@ private:
     const bool m_disable_upload;
     const bool m_disable_empty_upload;
     const bool m_is_subserver;
+    const std::shared_ptr<const compression::ZstdDictionary> m_zstd_dictionary;
+
+    // The dictionary that the session was bound to by the last BIND message,
+    // which is m_zstd_dictionary if the server has it, otherwise null.
+    const compression::ZstdDictionary* m_bound_zstd_dictionary = nullptr;
 
     // Session life cycle state:
     //
@@ -1128,6 +1155,7 @@ public:
     bool disable_upload = false;
     bool disable_empty_upload = false;
     bool is_subserver = false;
+    std::shared_ptr<const compression::ZstdDictionary> zstd_dictionary;
 };
 
 
@@ -1282,6 +1310,24 @@ inline auto ClientImplBase::Connection::get_output_buffer() noexcept -> OutputBu
     return m_output_buffer;
 }
 
+inline compression::CodecSet ClientImplBase::Connection::get_server_codecs() const noexcept
+{
+    return m_server_codecs;
+}
+
+inline bool ClientImplBase::Connection::server_has_zstd_dictionary(std::uint_fast32_t id) const noexcept
+{
+    const auto& ids = m_server_zstd_dictionaries;
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+inline auto ClientImplBase::Connection::get_zstd_dictionary(session_ident_type ident) const noexcept
+    -> const compression::ZstdDictionary*
+{
+    Session* sess = get_session(ident);
+    return sess ? sess->m_bound_zstd_dictionary : nullptr;
+}
+
 inline auto ClientImplBase::Connection::get_session(session_ident_type ident) const noexcept -> Session*
 {
     auto i = m_sessions.find(ident);
@@ -1425,6 +1471,7 @@ inline ClientImplBase::Session::Session(Connection& conn, session_ident_type ide
     , m_disable_upload{config.disable_upload}
     , m_disable_empty_upload{config.disable_empty_upload}
     , m_is_subserver{config.is_subserver}
+    , m_zstd_dictionary{std::move(config.zstd_dictionary)}
 {
     if (get_client().m_disable_upload_activation_delay)
         m_allow_upload = true;
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <limits>
+#include <new>
 
 #include <zlib.h>
 #include <zconf.h> // for zlib
@@ -8,6 +11,15 @@
 #include <realm/util/assert.hpp>
 #include <realm/util/aes_cryptor.hpp>
 
+#if REALM_HAVE_ZSTD
+#include <zstd.h>
+#include <zstd_errors.h>
+#endif
+
+#if REALM_HAVE_LZ4
+#include <lz4.h>
+#endif
+
 namespace {
 
 constexpr std::size_t g_max_stream_avail =
@@ -48,6 +60,8 @@ public:
                 return "Missing block header";
             case error::invalid_block_size:
                 return "Invalid block size";
+            case error::codec_unavailable:
+                return "Codec not available in this build";
         }
         REALM_UNREACHABLE();
     }
@@ -274,12 +288,377 @@ std::error_code compression::decompress(const char* compressed_buf, std::size_t
 }
 
 
+bool compression::is_valid_codec(int value) noexcept
+{
+    switch (Codec(value)) {
+        case Codec::none:
+        case Codec::deflate:
+        case Codec::zstd:
+        case Codec::lz4:
+            return true;
+    }
+    return false;
+}
+
+
+bool compression::is_codec_available(Codec codec) noexcept
+{
+    switch (codec) {
+        case Codec::none:
+        case Codec::deflate:
+            return true;
+        case Codec::zstd:
+            return REALM_HAVE_ZSTD;
+        case Codec::lz4:
+            return REALM_HAVE_LZ4;
+    }
+    return false;
+}
+
+
+compression::CodecSet compression::get_available_codecs() noexcept
+{
+    CodecSet codecs = 0;
+    for (Codec codec : {Codec::none, Codec::deflate, Codec::zstd, Codec::lz4}) {
+        if (is_codec_available(codec))
+            codecs |= codec_set(codec);
+    }
+    return codecs;
+}
+
+
+const char* compression::get_codec_name(Codec codec) noexcept
+{
+    switch (codec) {
+        case Codec::none:
+            return "none";
+        case Codec::deflate:
+            return "deflate";
+        case Codec::zstd:
+            return "zstd";
+        case Codec::lz4:
+            return "lz4";
+    }
+    return "unknown";
+}
+
+
+std::error_code compression::decompress(Codec codec, const char* compressed_buf, std::size_t compressed_size,
+                                        char* decompressed_buf, std::size_t decompressed_size,
+                                        const ZstdDictionary* dictionary)
+{
+    switch (codec) {
+        case Codec::none:
+            if (compressed_size != decompressed_size)
+                return error::incorrect_decompressed_size;
+            std::copy(compressed_buf, compressed_buf + compressed_size, decompressed_buf);
+            return std::error_code{};
+        case Codec::deflate:
+            return decompress(compressed_buf, compressed_size, decompressed_buf, decompressed_size);
+        case Codec::zstd:
+            return zstd_decompress(compressed_buf, compressed_size, decompressed_buf, decompressed_size,
+                                   dictionary);
+        case Codec::lz4:
+            return lz4_decompress(compressed_buf, compressed_size, decompressed_buf, decompressed_size);
+    }
+    return error::invalid_input;
+}
+
+
+std::unique_ptr<compression::ZstdDictionary> compression::ZstdDictionary::load(const std::string& path)
+{
+    util::File file{path};                                            // Throws
+    std::size_t size = to_size_t(file.get_size());                    // Throws
+    std::unique_ptr<char[]> content = std::make_unique<char[]>(size); // Throws
+    file.read(content.get(), size);                                   // Throws
+    return std::make_unique<ZstdDictionary>(BinaryData{content.get(), size}); // Throws
+}
+
+
+#if REALM_HAVE_ZSTD
+
+namespace {
+
+constexpr int g_zstd_compression_level = 1;
+
+struct ZstdDecompressionContextDeleter {
+    void operator()(ZSTD_DCtx* dctx) const noexcept
+    {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+} // unnamed namespace
+
+
+ZSTD_CCtx* compression::CompressMemoryArena::get_zstd_context() noexcept
+{
+    if (!m_zstd_context)
+        m_zstd_context.reset(ZSTD_createCCtx());
+    return m_zstd_context.get();
+}
+
+
+void compression::CompressMemoryArena::ZstdContextDeleter::operator()(ZSTD_CCtx* cctx) const noexcept
+{
+    ZSTD_freeCCtx(cctx);
+}
+
+
+compression::ZstdDictionary::ZstdDictionary(BinaryData content)
+{
+    m_id = ZSTD_getDictID_fromDict(content.data(), content.size());
+    if (m_id == 0)
+        throw std::system_error(make_error_code(error::invalid_input));
+    m_cdict = ZSTD_createCDict(content.data(), content.size(), g_zstd_compression_level);
+    m_ddict = ZSTD_createDDict(content.data(), content.size());
+    if (!m_cdict || !m_ddict) {
+        ZSTD_freeCDict(m_cdict);
+        ZSTD_freeDDict(m_ddict);
+        throw std::bad_alloc();
+    }
+}
+
+
+compression::ZstdDictionary::~ZstdDictionary() noexcept
+{
+    ZSTD_freeCDict(m_cdict);
+    ZSTD_freeDDict(m_ddict);
+}
+
+
+std::size_t compression::zstd_compress_bound(std::size_t uncompressed_size) noexcept
+{
+    return ZSTD_compressBound(uncompressed_size);
+}
+
+
+std::error_code compression::zstd_compress(const char* uncompressed_buf, std::size_t uncompressed_size,
+                                           char* compressed_buf, std::size_t compressed_buf_size,
+                                           std::size_t& compressed_size, CompressMemoryArena& compress_memory_arena,
+                                           const ZstdDictionary* dictionary)
+{
+    ZSTD_CCtx* cctx = compress_memory_arena.get_zstd_context();
+    if (!cctx)
+        return error::out_of_memory;
+
+    std::size_t result;
+    if (dictionary) {
+        result = ZSTD_compress_usingCDict(cctx, compressed_buf, compressed_buf_size, uncompressed_buf,
+                                          uncompressed_size, dictionary->get_compression_dictionary());
+    }
+    else {
+        result = ZSTD_compressCCtx(cctx, compressed_buf, compressed_buf_size, uncompressed_buf, uncompressed_size,
+                                   g_zstd_compression_level);
+    }
+    if (ZSTD_isError(result)) {
+        switch (ZSTD_getErrorCode(result)) {
+            case ZSTD_error_dstSize_tooSmall:
+                return error::compress_buffer_too_small;
+            case ZSTD_error_memory_allocation:
+                return error::out_of_memory;
+            default:
+                return error::compress_error;
+        }
+    }
+    compressed_size = result;
+    return std::error_code{};
+}
+
+
+std::error_code compression::zstd_decompress(const char* compressed_buf, std::size_t compressed_size,
+                                             char* decompressed_buf, std::size_t decompressed_size,
+                                             const ZstdDictionary* dictionary)
+{
+    // A body is a single frame. The decompressor validates every length and
+    // offset against the buffers, but the dictionary must be checked here,
+    // because a frame may omit its ID.
+    std::size_t frame_size = ZSTD_findFrameCompressedSize(compressed_buf, compressed_size);
+    if (ZSTD_isError(frame_size) || frame_size != compressed_size)
+        return error::corrupt_input;
+    unsigned dictionary_id = ZSTD_getDictID_fromFrame(compressed_buf, compressed_size);
+    std::size_t result;
+    if (dictionary_id == 0) {
+        result = ZSTD_decompress(decompressed_buf, decompressed_size, compressed_buf, compressed_size);
+    }
+    else {
+        if (!dictionary || dictionary->get_id() != dictionary_id)
+            return error::corrupt_input;
+        std::unique_ptr<ZSTD_DCtx, ZstdDecompressionContextDeleter> dctx{ZSTD_createDCtx()};
+        if (!dctx)
+            return error::out_of_memory;
+        result = ZSTD_decompress_usingDDict(dctx.get(), decompressed_buf, decompressed_size, compressed_buf,
+                                            compressed_size, dictionary->get_decompression_dictionary());
+    }
+    if (ZSTD_isError(result)) {
+        switch (ZSTD_getErrorCode(result)) {
+            case ZSTD_error_dstSize_tooSmall:
+                return error::incorrect_decompressed_size;
+            case ZSTD_error_memory_allocation:
+                return error::out_of_memory;
+            default:
+                return error::corrupt_input;
+        }
+    }
+    if (result != decompressed_size)
+        return error::incorrect_decompressed_size;
+    return std::error_code{};
+}
+
+#else // !REALM_HAVE_ZSTD
+
+ZSTD_CCtx_s* compression::CompressMemoryArena::get_zstd_context() noexcept
+{
+    return nullptr;
+}
+
+
+void compression::CompressMemoryArena::ZstdContextDeleter::operator()(ZSTD_CCtx_s*) const noexcept {}
+
+
+compression::ZstdDictionary::ZstdDictionary(BinaryData)
+{
+    throw std::system_error(make_error_code(error::codec_unavailable));
+}
+
+
+compression::ZstdDictionary::~ZstdDictionary() noexcept {}
+
+
+std::size_t compression::zstd_compress_bound(std::size_t) noexcept
+{
+    return 0;
+}
+
+
+std::error_code compression::zstd_compress(const char*, std::size_t, char*, std::size_t, std::size_t&,
+                                           CompressMemoryArena&, const ZstdDictionary*)
+{
+    return error::codec_unavailable;
+}
+
+
+std::error_code compression::zstd_decompress(const char*, std::size_t, char*, std::size_t, const ZstdDictionary*)
+{
+    return error::codec_unavailable;
+}
+
+#endif // !REALM_HAVE_ZSTD
+
+
+#if REALM_HAVE_LZ4
+
+std::size_t compression::lz4_compress_bound(std::size_t uncompressed_size) noexcept
+{
+    if (uncompressed_size > LZ4_MAX_INPUT_SIZE)
+        return 0;
+    return std::size_t(LZ4_compressBound(int(uncompressed_size)));
+}
+
+
+std::error_code compression::lz4_compress(const char* uncompressed_buf, std::size_t uncompressed_size,
+                                          char* compressed_buf, std::size_t compressed_buf_size,
+                                          std::size_t& compressed_size, CompressMemoryArena& compress_memory_arena)
+{
+    if (uncompressed_size > LZ4_MAX_INPUT_SIZE)
+        return error::invalid_input;
+
+    // The compression state lives in the arena, so that the memory is reused
+    // from one message to the next
+    std::size_t state_size = std::size_t(LZ4_sizeofState());
+    compress_memory_arena.reset();
+    void* state = compress_memory_arena.alloc(state_size);
+    if (!state) {
+        compress_memory_arena.resize(state_size); // Throws
+        state = compress_memory_arena.alloc(state_size);
+        REALM_ASSERT(state);
+    }
+
+    int capacity = int(std::min<std::size_t>(compressed_buf_size, std::numeric_limits<int>::max()));
+    int acceleration = 1;
+    int result = LZ4_compress_fast_extState(state, uncompressed_buf, compressed_buf, int(uncompressed_size),
+                                            capacity, acceleration);
+    if (result <= 0)
+        return error::compress_buffer_too_small;
+    compressed_size = std::size_t(result);
+    return std::error_code{};
+}
+
+
+std::error_code compression::lz4_decompress(const char* compressed_buf, std::size_t compressed_size,
+                                            char* decompressed_buf, std::size_t decompressed_size)
+{
+    // LZ4_decompress_safe() validates every length and offset against the
+    // buffers, and fails if the block does not end exactly at the end of the
+    // input.
+    constexpr std::size_t max_size = std::size_t(std::numeric_limits<int>::max());
+    if (compressed_size > max_size || decompressed_size > max_size)
+        return error::corrupt_input;
+    int result =
+        LZ4_decompress_safe(compressed_buf, decompressed_buf, int(compressed_size), int(decompressed_size));
+    if (result < 0)
+        return error::corrupt_input;
+    if (std::size_t(result) != decompressed_size)
+        return error::incorrect_decompressed_size;
+    return std::error_code{};
+}
+
+#else // !REALM_HAVE_LZ4
+
+std::size_t compression::lz4_compress_bound(std::size_t) noexcept
+{
+    return 0;
+}
+
+
+std::error_code compression::lz4_compress(const char*, std::size_t, char*, std::size_t, std::size_t&,
+                                          CompressMemoryArena&)
+{
+    return error::codec_unavailable;
+}
+
+
+std::error_code compression::lz4_decompress(const char*, std::size_t, char*, std::size_t)
+{
+    return error::codec_unavailable;
+}
+
+#endif // !REALM_HAVE_LZ4
+
+
 std::size_t compression::allocate_and_compress(CompressMemoryArena& compress_memory_arena,
-                                               BinaryData uncompressed_buf, std::vector<char>& compressed_buf)
+                                               BinaryData uncompressed_buf, std::vector<char>& compressed_buf,
+                                               Codec codec, const ZstdDictionary* dictionary)
 {
+    REALM_ASSERT(codec != Codec::none);
     const int compression_level = 1;
     std::size_t compressed_size = 0;
 
+    if (codec == Codec::zstd || codec == Codec::lz4) {
+        // Both codecs compress in one step into a buffer of the size of the
+        // bound
+        if (!is_codec_available(codec))
+            throw std::system_error(make_error_code(error::codec_unavailable));
+        std::size_t bound = (codec == Codec::zstd ? zstd_compress_bound(uncompressed_buf.size())
+                                                  : lz4_compress_bound(uncompressed_buf.size()));
+        if (bound == 0)
+            throw std::system_error(make_error_code(error::invalid_input));
+        if (compressed_buf.size() < bound)
+            compressed_buf.resize(bound); // Throws
+        std::error_code ec;
+        if (codec == Codec::zstd) {
+            ec = zstd_compress(uncompressed_buf.data(), uncompressed_buf.size(), compressed_buf.data(),
+                               compressed_buf.size(), compressed_size, compress_memory_arena, dictionary);
+        }
+        else {
+            ec = lz4_compress(uncompressed_buf.data(), uncompressed_buf.size(), compressed_buf.data(),
+                              compressed_buf.size(), compressed_size, compress_memory_arena); // Throws
+        }
+        if (REALM_UNLIKELY(ec))
+            throw std::system_error(ec);
+        return compressed_size;
+    }
+
     compress_memory_arena.reset();
 
     if (compressed_buf.size() < 256)
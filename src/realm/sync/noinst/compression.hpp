@@ -14,6 +14,11 @@
 #include <realm/util/file.hpp>
 #include <realm/util/optional.hpp>
 
+// Opaque Zstandard types, see <zstd.h>
+struct ZSTD_CCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
 namespace realm {
 namespace _impl {
 namespace compression {
@@ -31,6 +36,7 @@ enum class error {
     decryption_error = 10,
     missing_block_header = 11,
     invalid_block_size = 12,
+    codec_unavailable = 13,
 };
 
 const std::error_category& error_category() noexcept;
@@ -102,11 +108,104 @@ public:
         m_offset = 0;
     }
 
+    /// Returns the Zstandard compression context of this arena, creating it
+    /// on first use. Returns null on "out of memory". The context is reused
+    /// from one message to the next, like the memory of the arena.
+    ZSTD_CCtx_s* get_zstd_context() noexcept;
+
 private:
+    struct ZstdContextDeleter {
+        void operator()(ZSTD_CCtx_s*) const noexcept;
+    };
+
     size_t m_size = 0, m_offset = 0;
     std::unique_ptr<char[]> m_buffer;
+    std::unique_ptr<ZSTD_CCtx_s, ZstdContextDeleter> m_zstd_context;
+};
+
+
+/// The codecs used to compress the bodies of UPLOAD and DOWNLOAD messages. The
+/// value is sent in the messages, so it must never change.
+///
+/// Zstd bodies are single Zstandard frames at compression level 1, which
+/// compress and decompress several times faster than zlib at level 1, and
+/// usually compress better. A frame may refer to the Zstandard dictionary
+/// bound to the session (see ZstdDictionary). LZ4 bodies are single LZ4
+/// blocks (not frames), which are the cheapest to compress and decompress, at
+/// a lower compression ratio.
+///
+/// Zstd and LZ4 are only available when the library was built with
+/// Zstandard and LZ4 respectively (REALM_HAVE_ZSTD and REALM_HAVE_LZ4).
+enum class Codec {
+    none = 0,
+    deflate = 1, ///< zlib deflate() at compression level 1
+    zstd = 2,
+    lz4 = 3,
 };
 
+/// Returns true if  value is one of the values of Codec.
+bool is_valid_codec(int value) noexcept;
+
+/// Returns true if this build can compress and decompress with \a codec.
+bool is_codec_available(Codec codec) noexcept;
+
+const char* get_codec_name(Codec) noexcept;
+
+/// A set of codecs, with bit N set for the codec whose value is N.
+using CodecSet = unsigned;
+
+constexpr CodecSet codec_set(Codec codec) noexcept
+{
+    return CodecSet(1) << int(codec);
+}
+
+/// Returns the set of codecs for which is_codec_available() returns true.
+CodecSet get_available_codecs() noexcept;
+
+/// A pre-trained Zstandard dictionary, as produced by `zstd --train` or
+/// ZDICT_trainFromBuffer(). Small bodies, which is the common case for UPLOAD
+/// messages, compress much better with a dictionary trained on changesets of
+/// the same schema.
+///
+/// The dictionary is identified on the wire by the ID recorded in it, which
+/// must be nonzero. The prepared compression and decompression dictionaries
+/// are immutable, so one instance can be shared by any number of sessions
+/// and threads.
+class ZstdDictionary {
+public:
+    /// Throws std::system_error with error::codec_unavailable if the library
+    /// was built without Zstandard, and with error::invalid_input if \a
+    /// content is not a Zstandard dictionary with a nonzero ID.
+    explicit ZstdDictionary(BinaryData content);
+    ~ZstdDictionary() noexcept;
+
+    ZstdDictionary(const ZstdDictionary&) = delete;
+    ZstdDictionary& operator=(const ZstdDictionary&) = delete;
+
+    std::uint_fast32_t get_id() const noexcept
+    {
+        return m_id;
+    }
+
+    ZSTD_CDict_s* get_compression_dictionary() const noexcept
+    {
+        return m_cdict;
+    }
+
+    ZSTD_DDict_s* get_decompression_dictionary() const noexcept
+    {
+        return m_ddict;
+    }
+
+    /// Loads a dictionary from the file at \a path. Throws on errors, as the
+    /// constructor and util::File do.
+    static std::unique_ptr<ZstdDictionary> load(const std::string& path);
+
+private:
+    std::uint_fast32_t m_id = 0;
+    ZSTD_CDict_s* m_cdict = nullptr;
+    ZSTD_DDict_s* m_ddict = nullptr;
+};
 
 /// compress_bound() calculates an upper bound on the size of the compressed
 /// data. The caller can use this function to allocate memory buffer calling
@@ -138,8 +237,59 @@ std::error_code decompress(const char* compressed_buf, size_t compressed_size, c
                            size_t decompressed_size);
 
 
+/// decompress() with a \a codec decompresses data compressed with that codec,
+/// with the same semantics as the zlib decompress() above. Codec::none
+/// requires the sizes to be equal and copies the data. \a dictionary is the
+/// Zstandard dictionary that Zstd frames may refer to, see zstd_decompress().
+std::error_code decompress(Codec codec, const char* compressed_buf, size_t compressed_size, char* decompressed_buf,
+                           size_t decompressed_size, const ZstdDictionary* dictionary = nullptr);
+
+/// zstd_compress_bound() returns the largest possible size of \a
+/// uncompressed_size bytes compressed with zstd_compress().
+size_t zstd_compress_bound(size_t uncompressed_size) noexcept;
+
+/// zstd_compress() compresses into a single Zstandard frame that records the
+/// uncompressed size, and the ID of \a dictionary if one is specified. The
+/// compression context is taken from \a compress_memory_arena. The returned
+/// error code is error::compress_buffer_too_small if \a compressed_buf_size
+/// is too small.
+std::error_code zstd_compress(const char* uncompressed_buf, size_t uncompressed_size, char* compressed_buf,
+                              size_t compressed_buf_size, size_t& compressed_size,
+                              CompressMemoryArena& compress_memory_arena,
+                              const ZstdDictionary* dictionary = nullptr);
+
+/// zstd_decompress() decompresses a single Zstandard frame produced by
+/// zstd_compress(), or by any other Zstandard compressor. A frame that refers
+/// to a dictionary is only accepted if it is \a dictionary. Anything else is
+/// error::corrupt_input.
+std::error_code zstd_decompress(const char* compressed_buf, size_t compressed_size, char* decompressed_buf,
+                                size_t decompressed_size, const ZstdDictionary* dictionary = nullptr);
+
+/// lz4_compress_bound() returns the largest possible size of \a
+/// uncompressed_size bytes compressed with lz4_compress(), or zero if \a
+/// uncompressed_size is too large for a single LZ4 block.
+size_t lz4_compress_bound(size_t uncompressed_size) noexcept;
+
+/// lz4_compress() compresses into a single LZ4 block. The compression state
+/// is allocated from \a compress_memory_arena, which is resized if it is too
+/// small. The returned error code is error::compress_buffer_too_small if \a
+/// compressed_buf_size is too small.
+std::error_code lz4_compress(const char* uncompressed_buf, size_t uncompressed_size, char* compressed_buf,
+                             size_t compressed_buf_size, size_t& compressed_size,
+                             CompressMemoryArena& compress_memory_arena);
+
+/// lz4_decompress() decompresses a single LZ4 block, which must decompress to
+/// exactly \a decompressed_size bytes. Anything else is error::corrupt_input.
+std::error_code lz4_decompress(const char* compressed_buf, size_t compressed_size, char* decompressed_buf,
+                               size_t decompressed_size);
+
+/// allocate_and_compress() compresses with \a codec, which must not be
+/// Codec::none, growing \a compressed_buf and \a compress_memory_arena as
+/// needed. It returns the size of the compressed data. \a dictionary is only
+/// used by Codec::zstd.
 size_t allocate_and_compress(CompressMemoryArena& compress_memory_arena, BinaryData uncompressed_buf,
-                             std::vector<char>& compressed_buf);
+                             std::vector<char>& compressed_buf, Codec codec = Codec::deflate,
+                             const ZstdDictionary* dictionary = nullptr);
 
 /// compress_file() compresses the file at path \a src_path into \a dst_path.
 /// The function returns {} on success and returns an error if the source file
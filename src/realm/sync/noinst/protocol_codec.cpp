@@ -1,3 +1,5 @@
+#include <limits>
+
 #include <realm/util/assert.hpp>
 #include <realm/sync/noinst/protocol_codec.hpp>
 #include <realm/sync/noinst/server_impl_base.hpp>
@@ -11,17 +13,96 @@ using _impl::ServerProtocol;
 using OutputBuffer = util::ResettableExpandableBufferOutputStream;
 
 
+namespace {
+
+// Calls fn() with each comma-separated element of value, without surrounding
+// spaces and tabs. Empty elements are skipped.
+template <class F>
+void for_each_list_element(util::StringView value, F&& fn)
+{
+    std::size_t begin = 0;
+    while (begin <= value.size()) {
+        std::size_t end = value.find(',', begin);
+        if (end == util::StringView::npos)
+            end = value.size();
+        util::StringView element = value.substr(begin, end - begin);
+        std::size_t first = element.find_first_not_of(" \t");
+        if (first != util::StringView::npos) {
+            std::size_t last = first;
+            for (std::size_t i = first; i < element.size(); ++i) {
+                if (element[i] != ' ' && element[i] != '\t')
+                    last = i;
+            }
+            fn(element.substr(first, last - first + 1)); // Throws
+        }
+        begin = end + 1;
+    }
+}
+
+} // unnamed namespace
+
+
+std::string _impl::format_codec_list(compression::CodecSet codecs)
+{
+    using compression::Codec;
+    std::string list;
+    for (Codec codec : {Codec::deflate, Codec::zstd, Codec::lz4}) {
+        if ((codecs & compression::codec_set(codec)) == 0)
+            continue;
+        if (!list.empty())
+            list += ",";                             // Throws
+        list += compression::get_codec_name(codec); // Throws
+    }
+    return list;
+}
+
+
+_impl::compression::CodecSet _impl::parse_codec_list(util::StringView value) noexcept
+{
+    using compression::Codec;
+    compression::CodecSet codecs = compression::codec_set(Codec::none) | compression::codec_set(Codec::deflate);
+    for_each_list_element(value, [&](util::StringView name) noexcept {
+        for (Codec codec : {Codec::zstd, Codec::lz4}) {
+            if (name == util::StringView(compression::get_codec_name(codec)))
+                codecs |= compression::codec_set(codec);
+        }
+    });
+    return codecs;
+}
+
+
+std::vector<std::uint_fast32_t> _impl::parse_zstd_dictionary_list(util::StringView value)
+{
+    std::vector<std::uint_fast32_t> ids;
+    for_each_list_element(value, [&](util::StringView element) {
+        std::uint_fast64_t id = 0;
+        for (char ch : element) {
+            if (ch < '0' || ch > '9' || id > std::numeric_limits<std::uint32_t>::max())
+                return;
+            id = 10 * id + std::uint_fast64_t(ch - '0');
+        }
+        if (id != 0 && id <= std::numeric_limits<std::uint32_t>::max())
+            ids.push_back(std::uint_fast32_t(id)); // Throws
+    });
+    return ids;
+}
+
+
 // Client protocol
 
 void ClientProtocol::make_bind_message(int protocol_version, OutputBuffer& out, session_ident_type session_ident,
                                        const std::string& server_path, const std::string& signed_user_token,
-                                       bool need_client_file_ident, bool is_subserver)
+                                       bool need_client_file_ident, bool is_subserver,
+                                       std::uint_fast32_t zstd_dictionary_id)
 {
-    static_cast<void>(protocol_version);
     out << "bind " << session_ident << " " << server_path.size() << " " << signed_user_token.size() << " "
         << int(need_client_file_ident); // Throws
     out << " " << int(is_subserver);    // Throws
-    out << "\n";                        // Throws
+    if (protocol_version >= 2)
+        out << " " << zstd_dictionary_id; // Throws
+    else
+        REALM_ASSERT(zstd_dictionary_id == 0);
+    out << "\n"; // Throws
     REALM_ASSERT(!out.fail());
 
     out.write(server_path.data(), server_path.size());             // Throws
@@ -96,27 +177,33 @@ void ClientProtocol::UploadMessageBuilder::make_upload_message(int protocol_vers
                                                                session_ident_type session_ident,
                                                                version_type progress_client_version,
                                                                version_type progress_server_version,
-                                                               version_type locked_server_version)
+                                                               version_type locked_server_version,
+                                                               _impl::compression::Codec codec,
+                                                               const _impl::compression::ZstdDictionary* dictionary)
 {
-    static_cast<void>(protocol_version);
+    // Codecs other than zlib are not understood by protocol version 1
+    REALM_ASSERT(protocol_version >= 2 || codec == _impl::compression::Codec::none ||
+                 codec == _impl::compression::Codec::deflate);
     BinaryData body = {m_body_buffer.data(), std::size_t(m_body_buffer.size())};
     std::size_t compressed_body_size = body.size();
 
     constexpr std::size_t g_max_uncompressed = 1024;
 
-    if (body.size() > g_max_uncompressed) {
+    if (body.size() > g_max_uncompressed && codec != _impl::compression::Codec::none) {
         compressed_body_size = _impl::compression::allocate_and_compress(m_compress_memory_arena, body,
-                                                                         m_compression_buffer); // Throws
+                                                                         m_compression_buffer, codec,
+                                                                         dictionary); // Throws
     }
 
     // The compressed body is only sent if it is smaller than the uncompressed body.
     bool is_body_compressed = (compressed_body_size < body.size());
-    if (!is_body_compressed)
+    if (!is_body_compressed) {
         compressed_body_size = 0;
+        codec = _impl::compression::Codec::none;
+    }
 
     // The header of the upload message.
-    out << "upload " << session_ident << " " << int(is_body_compressed) << " " << body.size() << " "
-        << compressed_body_size;
+    out << "upload " << session_ident << " " << int(codec) << " " << body.size() << " " << compressed_body_size;
     out << " " << progress_client_version << " " << progress_server_version << " " << locked_server_version; // Throws
     out << "\n";                                                                                             // Throws
 
@@ -230,27 +317,31 @@ void ServerProtocol::make_download_message(int protocol_version, OutputBuffer& o
                                            version_type upload_client_version, version_type upload_server_version,
                                            std::uint_fast64_t downloadable_bytes, std::size_t num_changesets,
                                            const char* body, std::size_t uncompressed_body_size,
-                                           std::size_t compressed_body_size, bool body_is_compressed,
+                                           std::size_t compressed_body_size, _impl::compression::Codec body_codec,
                                            util::Logger& logger)
 {
-    static_cast<void>(protocol_version);
+    // Codecs other than zlib are not understood by protocol version 1
+    REALM_ASSERT(protocol_version >= 2 || body_codec == _impl::compression::Codec::none ||
+                 body_codec == _impl::compression::Codec::deflate);
     // The header of the download message.
     out << "download " << session_ident << " " << download_server_version << " " << download_client_version << " "
         << latest_server_version << " " << latest_server_version_salt << " " << upload_client_version << " "
-        << upload_server_version << " " << downloadable_bytes << " " << int(body_is_compressed) << " "
+        << upload_server_version << " " << downloadable_bytes << " " << int(body_codec) << " "
         << uncompressed_body_size << " " << compressed_body_size << "\n"; // Throws
 
+    bool body_is_compressed = (body_codec != _impl::compression::Codec::none);
     std::size_t body_size = (body_is_compressed ? compressed_body_size : uncompressed_body_size);
     out.write(body, body_size);
 
     logger.detail("Sending: DOWNLOAD(download_server_version=%1, download_client_version=%2, "
                   "latest_server_version=%3, latest_server_version_salt=%4, "
                   "upload_client_version=%5, upload_server_version=%6, "
-                  "num_changesets=%7, is_body_compressed=%8, body_size=%9, "
+                  "num_changesets=%7, body_codec=%8, body_size=%9, "
                   "compressed_body_size=%10)",
                   download_server_version, download_client_version, latest_server_version, latest_server_version_salt,
-                  upload_client_version, upload_server_version, num_changesets, body_is_compressed,
-                  uncompressed_body_size, compressed_body_size); // Throws
+                  upload_client_version, upload_server_version, num_changesets,
+                  _impl::compression::get_codec_name(body_codec), uncompressed_body_size,
+                  compressed_body_size); // Throws
 }
 
 
@@ -26,6 +26,73 @@
 namespace realm {
 namespace _impl {
 
+/// The HTTP header of the handshake request and response in which each peer
+/// lists the body codecs that it can decompress, as a comma-separated list of
+/// codec names (see compression::get_codec_name()). A peer that omits the
+/// header can only decompress zlib. Sent from protocol version 2.
+constexpr const char* g_sync_codecs_header = "X-Realm-Sync-Codecs";
+
+/// The HTTP header of the handshake response in which the server lists the
+/// IDs of the Zstandard dictionaries that it has, as a comma-separated list
+/// of decimal numbers. The client binds a session to one of them in the BIND
+/// message.
+constexpr const char* g_sync_zstd_dictionaries_header = "X-Realm-Sync-Zstd-Dictionaries";
+
+/// Formats \a codecs for the codecs header. Codec::none is implied and never
+/// listed.
+std::string format_codec_list(compression::CodecSet codecs);
+
+/// Parses the value of the codecs header. Unknown names are ignored, so that
+/// later versions can add codecs. Codec::none and Codec::deflate are always
+/// included in the result.
+compression::CodecSet parse_codec_list(util::StringView value) noexcept;
+
+/// Parses the value of the Zstandard dictionaries header. Entries that are
+/// not nonzero decimal numbers are ignored.
+std::vector<std::uint_fast32_t> parse_zstd_dictionary_list(util::StringView value);
+
+/// Selects the codec used for the bodies of the UPLOAD and DOWNLOAD messages
+/// sent on a session. The candidates are the codecs that both peers can
+/// decompress (\a peer_codecs is what the peer listed in the codecs header)
+/// and that are not disabled by the configuration of the sending side. LZ4,
+/// which is the cheapest in CPU time, is preferred, then Zstd, then
+/// zlib. When the session is bound to a Zstandard dictionary, Zstd is
+/// preferred over LZ4, because it then compresses small bodies much better at
+/// a comparable cost. Protocol version 1 only knows zlib.
+inline compression::Codec select_body_codec(int protocol_version, compression::CodecSet peer_codecs,
+                                            compression::CodecSet disabled_codecs, bool have_zstd_dictionary) noexcept
+{
+    using compression::Codec;
+    if (protocol_version < 2)
+        return Codec::deflate;
+    compression::CodecSet candidates = peer_codecs & compression::get_available_codecs() & ~disabled_codecs;
+    auto is_candidate = [&](Codec codec) {
+        return (candidates & compression::codec_set(codec)) != 0;
+    };
+    if (have_zstd_dictionary && is_candidate(Codec::zstd))
+        return Codec::zstd;
+    for (Codec codec : {Codec::lz4, Codec::zstd}) {
+        if (is_candidate(codec))
+            return codec;
+    }
+    return Codec::deflate;
+}
+
+/// Returns true if \a value is a body codec that the peer may use on a
+/// connection of the specified protocol version. In version 1 the field is the
+/// <is body compressed> flag, so it can only be 0 or 1. Zstd (2) and LZ4 (3)
+/// require version 2, and must be available in this build, which is the case
+/// if they were listed in the codecs header sent to the peer.
+inline bool is_valid_body_codec(int protocol_version, int value) noexcept
+{
+    if (!compression::is_valid_codec(value))
+        return false;
+    auto codec = compression::Codec(value);
+    if (codec == compression::Codec::none || codec == compression::Codec::deflate)
+        return true;
+    return protocol_version >= 2 && compression::is_codec_available(codec);
+}
+
 class ClientProtocol {
 public:
     // clang-format off
@@ -64,9 +131,12 @@ public:
 
     /// Messages sent by the client.
 
+    /// \a zstd_dictionary_id is the ID of the Zstandard dictionary to bind
+    /// the session to, or zero for none. It must be zero in protocol version
+    /// 1.
     void make_bind_message(int protocol_version, OutputBuffer&, session_ident_type session_ident,
                            const std::string& server_path, const std::string& signed_user_token,
-                           bool need_client_file_ident, bool is_subserver);
+                           bool need_client_file_ident, bool is_subserver, std::uint_fast32_t zstd_dictionary_id = 0);
 
     void make_refresh_message(OutputBuffer&, session_ident_type session_ident, const std::string& signed_user_token);
 
@@ -93,9 +163,14 @@ public:
         void add_changeset(version_type client_version, version_type server_version, timestamp_type origin_timestamp,
                            file_ident_type origin_file_ident, ChunkedBinaryData changeset);
 
+        /// The body is compressed with \a codec if that makes it smaller. See
+        /// select_body_codec(). \a dictionary is the Zstandard dictionary
+        /// that the session is bound to, if any.
         void make_upload_message(int protocol_version, OutputBuffer&, session_ident_type session_ident,
                                  version_type progress_client_version, version_type progress_server_version,
-                                 version_type locked_server_version);
+                                 version_type locked_server_version,
+                                 _impl::compression::Codec codec = _impl::compression::Codec::deflate,
+                                 const _impl::compression::ZstdDictionary* dictionary = nullptr);
 
     private:
         std::size_t m_num_changesets = 0;
@@ -161,6 +236,8 @@ public:
         std::string message_type;
         in >> message_type;
 
+        int protocol_version = connection.get_negotiated_protocol_version();
+
         if (message_type == "download") {
             session_ident_type session_ident;
             version_type download_server_version, download_client_version;
@@ -168,20 +245,21 @@ public:
             salt_type latest_server_version_salt;
             version_type upload_client_version, upload_server_version;
             std::int_fast64_t downloadable_bytes;
-            int is_body_compressed;
+            int body_codec;
             std::size_t uncompressed_body_size, compressed_body_size;
             char sp_1, sp_2, sp_3, sp_4, sp_5, sp_6, sp_7, sp_8, sp_9, sp_10, sp_11, newline;
             in >> sp_1 >> session_ident >> sp_2 >> download_server_version >> sp_3 >> download_client_version >>
                 sp_4 >> latest_server_version >> sp_5 >> latest_server_version_salt >> sp_6 >>
                 upload_client_version >> sp_7 >> upload_server_version >> sp_8 >> downloadable_bytes >> sp_9 >>
-                is_body_compressed >> sp_10 >> uncompressed_body_size >> sp_11 >> compressed_body_size >>
+                body_codec >> sp_10 >> uncompressed_body_size >> sp_11 >> compressed_body_size >>
                 newline; // Throws
             header_size = std::size_t(in.tellg());
-            std::size_t body_size = (is_body_compressed ? compressed_body_size : uncompressed_body_size);
+            std::size_t body_size = (body_codec ? compressed_body_size : uncompressed_body_size);
             std::size_t expected_size = header_size + body_size;
             bool good_syntax = (in && sp_1 == ' ' && sp_2 == ' ' && sp_3 == ' ' && sp_4 == ' ' && sp_5 == ' ' &&
                                 sp_6 == ' ' && sp_7 == ' ' && sp_8 == ' ' && sp_9 == ' ' && sp_10 == ' ' &&
-                                sp_11 == ' ' && newline == '\n' && expected_size == size);
+                                sp_11 == ' ' && newline == '\n' && expected_size == size &&
+                                _impl::is_valid_body_codec(protocol_version, body_codec));
             if (!good_syntax)
                 goto bad_syntax;
             if (uncompressed_body_size > s_max_body_size)
@@ -191,14 +269,17 @@ public:
             BinaryData uncompressed_body;
 
             std::unique_ptr<char[]> uncompressed_body_buffer;
-            // if is_body_compressed == true, we must decompress the received body.
-            if (is_body_compressed) {
+            // if the body is compressed, we must decompress the received body.
+            auto codec = _impl::compression::Codec(body_codec);
+            if (codec != _impl::compression::Codec::none) {
                 uncompressed_body_buffer.reset(new char[uncompressed_body_size]);
                 std::error_code ec = _impl::compression::decompress(
-                    body.data(), compressed_body_size, uncompressed_body_buffer.get(), uncompressed_body_size);
+                    codec, body.data(), compressed_body_size, uncompressed_body_buffer.get(), uncompressed_body_size,
+                    connection.get_zstd_dictionary(session_ident));
 
                 if (ec) {
-                    logger.error("compression::inflate: %1", ec.message());
+                    logger.error("compression::decompress(%1): %2", _impl::compression::get_codec_name(codec),
+                                 ec.message());
                     connection.handle_protocol_error(Error::bad_decompression);
                     return;
                 }
@@ -209,9 +290,9 @@ public:
                 uncompressed_body = body;
             }
 
-            logger.trace("Download message compression: is_body_compressed = %1, "
+            logger.trace("Download message compression: body_codec = %1, "
                          "compressed_body_size=%2, uncompressed_body_size=%3",
-                         is_body_compressed, compressed_body_size, uncompressed_body_size);
+                         _impl::compression::get_codec_name(codec), compressed_body_size, uncompressed_body_size);
 
             util::MemoryInputStream in;
             in.unsetf(std::ios_base::skipws);
@@ -516,7 +597,7 @@ public:
                                version_type upload_client_version, version_type upload_server_version,
                                std::uint_fast64_t downloadable_bytes, std::size_t num_changesets, const char* body,
                                std::size_t uncompressed_body_size, std::size_t compressed_body_size,
-                               bool body_is_compressed, util::Logger&);
+                               _impl::compression::Codec body_codec, util::Logger&);
 
     void make_mark_message(OutputBuffer&, session_ident_type session_ident, request_ident_type request_ident);
 
@@ -582,24 +663,24 @@ public:
         in >> message_type;
 
         int protocol_version = connection.get_client_protocol_version();
-        static_cast<void>(protocol_version); // No divergent protocol behavior (yet).
 
         if (message_type == "upload") {
             session_ident_type session_ident;
-            int is_body_compressed;
+            int body_codec;
             std::size_t uncompressed_body_size, compressed_body_size;
             version_type progress_client_version, progress_server_version;
             version_type locked_server_version;
             char sp_1, sp_2, sp_3, sp_4, sp_5, sp_6, sp_7, newline;
-            in >> sp_1 >> session_ident >> sp_2 >> is_body_compressed >> sp_3 >> uncompressed_body_size >> sp_4 >>
+            in >> sp_1 >> session_ident >> sp_2 >> body_codec >> sp_3 >> uncompressed_body_size >> sp_4 >>
                 compressed_body_size;
             in >> sp_5 >> progress_client_version >> sp_6 >> progress_server_version >> sp_7 >> locked_server_version;
             in >> newline;
             header_size = std::size_t(in.tellg());
-            std::size_t body_size = (is_body_compressed ? compressed_body_size : uncompressed_body_size);
+            std::size_t body_size = (body_codec ? compressed_body_size : uncompressed_body_size);
             std::size_t expected_size = header_size + body_size;
             bool good_syntax = (in && sp_1 == ' ' && sp_2 == ' ' && sp_3 == ' ' && sp_4 == ' ' && sp_5 == ' ' &&
-                                sp_6 == ' ' && sp_7 == ' ' && newline == '\n' && expected_size == size);
+                                sp_6 == ' ' && sp_7 == ' ' && newline == '\n' && expected_size == size &&
+                                _impl::is_valid_body_codec(protocol_version, body_codec));
             if (!good_syntax)
                 goto bad_syntax;
             if (uncompressed_body_size > s_max_body_size)
@@ -608,14 +689,17 @@ public:
             BinaryData body(data + header_size, body_size);
             BinaryData uncompressed_body;
             std::unique_ptr<char[]> uncompressed_body_buffer;
-            // if is_body_compressed == true, we must decompress the received body.
-            if (is_body_compressed) {
+            // if the body is compressed, we must decompress the received body.
+            auto codec = _impl::compression::Codec(body_codec);
+            if (codec != _impl::compression::Codec::none) {
                 uncompressed_body_buffer.reset(new char[uncompressed_body_size]);
                 std::error_code ec = _impl::compression::decompress(
-                    body.data(), compressed_body_size, uncompressed_body_buffer.get(), uncompressed_body_size);
+                    codec, body.data(), compressed_body_size, uncompressed_body_buffer.get(), uncompressed_body_size,
+                    connection.get_zstd_dictionary(session_ident));
 
                 if (ec) {
-                    logger.error("compression::inflate: %1", ec.message());
+                    logger.error("compression::decompress(%1): %2", _impl::compression::get_codec_name(codec),
+                                 ec.message());
                     connection.handle_protocol_error(Error::bad_decompression);
                     return;
                 }
@@ -626,12 +710,12 @@ public:
                 uncompressed_body = body;
             }
 
-            logger.debug("Upload message compression: is_body_compressed = %1, "
+            logger.debug("Upload message compression: body_codec = %1, "
                          "compressed_body_size=%2, uncompressed_body_size=%3, "
                          "progress_client_version=%4, progress_server_version=%5, "
                          "locked_server_version=%6",
-                         is_body_compressed, compressed_body_size, uncompressed_body_size, progress_client_version,
-                         progress_server_version, locked_server_version); // Throws
+                         _impl::compression::get_codec_name(codec), compressed_body_size, uncompressed_body_size,
+                         progress_client_version, progress_server_version, locked_server_version); // Throws
 
             util::MemoryInputStream in;
             in.unsetf(std::ios_base::skipws);
@@ -726,13 +810,17 @@ public:
             std::size_t signed_user_token_size;
             bool need_client_file_ident;
             bool is_subserver;
-            char sp_1, sp_2, sp_3, sp_4, sp_5, newline;
+            std::uint_fast32_t zstd_dictionary_id = 0;
+            char sp_1, sp_2, sp_3, sp_4, sp_5, sp_6 = ' ', newline;
             in >> sp_1 >> session_ident >> sp_2 >> path_size >> sp_3 >> signed_user_token_size >> sp_4 >>
-                need_client_file_ident >> sp_5 >> is_subserver >> newline;
+                need_client_file_ident >> sp_5 >> is_subserver;
+            if (protocol_version >= 2)
+                in >> sp_6 >> zstd_dictionary_id;
+            in >> newline;
             header_size = std::size_t(in.tellg());
             std::size_t expected_size = header_size + path_size + signed_user_token_size;
             bool good_syntax = (in && sp_1 == ' ' && sp_2 == ' ' && sp_3 == ' ' && sp_4 == ' ' && sp_5 == ' ' &&
-                                newline == '\n' && expected_size == size && path_size != 0);
+                                sp_6 == ' ' && newline == '\n' && expected_size == size && path_size != 0);
             if (!good_syntax)
                 goto bad_syntax;
             if (path_size > s_max_path_size)
@@ -745,7 +833,7 @@ public:
                                           signed_user_token_size); // Throws
 
             connection.receive_bind_message(session_ident, std::move(path), std::move(signed_user_token),
-                                            need_client_file_ident, is_subserver); // Throws
+                                            need_client_file_ident, is_subserver, zstd_dictionary_id); // Throws
             return;
         }
         if (message_type == "refresh") {
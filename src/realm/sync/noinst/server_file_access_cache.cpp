@@ -27,11 +27,14 @@ void ServerFileAccessCache::access(Slot& slot)
         return;
     }
 
-    // Close least recently accessed Realm file
-    if (m_num_open_files == m_max_open_files) {
+    // Close least recently accessed Realm file that is not pinned
+    if (m_num_open_files >= m_max_open_files) {
         REALM_ASSERT(m_first_open_file);
-        Slot& least_recently_accessed = *m_first_open_file->m_prev_open_file;
-        least_recently_accessed.proper_close(); // Throws
+        Slot* least_recently_accessed = m_first_open_file->m_prev_open_file;
+        while (least_recently_accessed->is_pinned() && least_recently_accessed != m_first_open_file)
+            least_recently_accessed = least_recently_accessed->m_prev_open_file;
+        if (!least_recently_accessed->is_pinned())
+            least_recently_accessed->proper_close(); // Throws
     }
 
     slot.open(); // Throws
@@ -43,7 +46,8 @@ void ServerFileAccessCache::poll_core_metrics()
     if (m_metrics && m_first_open_file) {
         auto slot = m_first_open_file;
         do {
-            if (slot->is_open() && slot->m_file) {
+            // The metrics of a pinned file may be in use by another thread
+            if (slot->is_open() && slot->m_file && !slot->is_pinned()) {
                 std::shared_ptr<realm::metrics::Metrics> metrics = slot->m_file->shared_group->get_metrics();
                 if (metrics) {
                     constexpr const char* query_metrics_prefix = "core.query";
@@ -99,6 +99,16 @@ public:
     /// Close the Realm file now if it is open (idempotency).
     void close() noexcept;
 
+    /// While a slot is pinned, its file is not closed to make room for files
+    /// of other slots, so the reference returned by access() remains valid
+    /// when other slots are accessed. This allows several threads to work on
+    /// different files of the same cache, provided that the application
+    /// serializes all calls into the cache. If all open files are pinned,
+    /// the number of open files may temporarily exceed the maximum.
+    void pin() noexcept;
+    void unpin() noexcept;
+    bool is_pinned() const noexcept;
+
     DBOptions make_shared_group_options() const noexcept;
 
 private:
@@ -108,6 +118,7 @@ private:
 
     Slot* m_prev_open_file = nullptr;
     Slot* m_next_open_file = nullptr;
+    bool m_pinned = false;
 
     std::unique_ptr<File> m_file;
 
@@ -227,6 +238,21 @@ inline void ServerFileAccessCache::Slot::close() noexcept
         do_close();
 }
 
+inline void ServerFileAccessCache::Slot::pin() noexcept
+{
+    m_pinned = true;
+}
+
+inline void ServerFileAccessCache::Slot::unpin() noexcept
+{
+    m_pinned = false;
+}
+
+inline bool ServerFileAccessCache::Slot::is_pinned() const noexcept
+{
+    return m_pinned;
+}
+
 inline DBOptions ServerFileAccessCache::Slot::make_shared_group_options() const noexcept
 {
     DBOptions options;
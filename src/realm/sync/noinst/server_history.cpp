@@ -997,31 +997,57 @@ bool ServerHistory::fetch_download_info(file_ident_type client_file_ident, Downl
     }
 
     // Set cumulative byte sizes.
-    std::int_fast64_t cumulative_byte_size_current_2 = 0;
-    std::int_fast64_t cumulative_byte_size_total_2 = 0;
-    if (download_progress_2.server_version > m_history_base_version) {
-        std::size_t begin_ndx = to_size_t(download_progress_2.server_version - m_history_base_version) - 1;
-        cumulative_byte_size_current_2 = m_acc->sh_cumul_byte_sizes.get(begin_ndx);
-        REALM_ASSERT(cumulative_byte_size_current_2 >= 0);
-    }
-    if (m_history_size > 0) {
-        std::size_t end_ndx = m_history_size - 1;
-        cumulative_byte_size_total_2 = m_acc->sh_cumul_byte_sizes.get(end_ndx);
-    }
-    REALM_ASSERT(cumulative_byte_size_current_2 <= cumulative_byte_size_total_2);
+    std::uint_fast64_t cumulative_byte_size_current_2;
+    std::uint_fast64_t cumulative_byte_size_total_2;
+    do_get_cumulative_byte_sizes(download_progress_2.server_version, cumulative_byte_size_current_2,
+                                 cumulative_byte_size_total_2);
 
     version_type upload_client_version = version_type(m_acc->cf_client_versions.get(client_file_index));
     version_type upload_server_version = version_type(m_acc->cf_rh_base_versions.get(client_file_index));
 
     download_progress = download_progress_2;
-    cumulative_byte_size_current = std::uint_fast64_t(cumulative_byte_size_current_2);
-    cumulative_byte_size_total = std::uint_fast64_t(cumulative_byte_size_total_2);
+    cumulative_byte_size_current = cumulative_byte_size_current_2;
+    cumulative_byte_size_total = cumulative_byte_size_total_2;
     upload_progress = UploadCursor{upload_client_version, upload_server_version};
 
     return true;
 }
 
 
+void ServerHistory::get_cumulative_byte_sizes(version_type server_version,
+                                              std::uint_fast64_t& cumulative_byte_size_current,
+                                              std::uint_fast64_t& cumulative_byte_size_total) const
+{
+    TransactionRef tr = m_shared_group->start_read(); // Throws
+    version_type realm_version = tr->get_version();
+    const_cast<ServerHistory*>(this)->set_group(tr.get());
+    ensure_updated(realm_version); // Throws
+
+    REALM_ASSERT(server_version >= m_history_base_version);
+    do_get_cumulative_byte_sizes(server_version, cumulative_byte_size_current, cumulative_byte_size_total);
+}
+
+
+void ServerHistory::do_get_cumulative_byte_sizes(version_type server_version, std::uint_fast64_t& current,
+                                                 std::uint_fast64_t& total) const noexcept
+{
+    std::int_fast64_t current_2 = 0;
+    std::int_fast64_t total_2 = 0;
+    if (server_version > m_history_base_version) {
+        std::size_t begin_ndx = to_size_t(server_version - m_history_base_version) - 1;
+        current_2 = m_acc->sh_cumul_byte_sizes.get(begin_ndx);
+        REALM_ASSERT(current_2 >= 0);
+    }
+    if (m_history_size > 0) {
+        std::size_t end_ndx = m_history_size - 1;
+        total_2 = m_acc->sh_cumul_byte_sizes.get(end_ndx);
+    }
+    REALM_ASSERT(current_2 <= total_2);
+    current = std::uint_fast64_t(current_2);
+    total = std::uint_fast64_t(total_2);
+}
+
+
 void ServerHistory::add_upstream_sync_status()
 {
     TransactionRef tr = m_shared_group->start_write(); // Throws
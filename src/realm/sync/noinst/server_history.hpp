@@ -396,6 +396,17 @@ public:
                              std::uint_fast64_t& cumulative_byte_size_total, bool disable_download_compaction,
                              std::size_t accum_byte_size_soft_limit = 0x20000) const;
 
+    /// Get the cumulative byte sizes that fetch_download_info() reports when it
+    /// stops at \a server_version, without fetching any changesets.
+    ///
+    /// \param cumulative_byte_size_current is the cumulative byte size of all
+    /// changesets up to \a server_version.
+    ///
+    /// \param cumulative_byte_size_total is the cumulative byte size of the
+    /// entire history.
+    void get_cumulative_byte_sizes(version_type server_version, std::uint_fast64_t& cumulative_byte_size_current,
+                                   std::uint_fast64_t& cumulative_byte_size_total) const;
+
     /// The application must call this function before using the history as an
     /// upstream client history.
     ///
@@ -716,6 +727,8 @@ private:
                                     version_type& last_integrated_remote_version) const noexcept;
     HistoryEntry get_history_entry(version_type server_version) const noexcept;
     bool received_from(const HistoryEntry&, file_ident_type remote_file_ident) const noexcept;
+    void do_get_cumulative_byte_sizes(version_type server_version, std::uint_fast64_t& current,
+                                      std::uint_fast64_t& total) const noexcept;
 
     SaltedFileIdent allocate_file_ident(file_ident_type proxy_file_ident, ClientType);
     void register_assigned_file_ident(file_ident_type file_ident);
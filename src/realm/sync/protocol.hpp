@@ -18,12 +18,16 @@ namespace sync {
 //   1 Initial version, matching io.realm.sync-30, but not including query-based
 //     sync, serialized transactions, and state realms (async open).
 //
+//   2 The `<is body compressed>` parameter of UPLOAD and DOWNLOAD messages is
+//     replaced by `<body codec>`, which also allows for bodies compressed with
+//     Zstandard (see _impl::compression::Codec).
+//
 //  XX Changes:
 //     - Add support for Mixed and TypedLinks columns.
 //
 constexpr int get_current_protocol_version() noexcept
 {
-    return 1;
+    return 2;
 }
 
 constexpr const char* get_websocket_protocol_prefix() noexcept
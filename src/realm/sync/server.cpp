@@ -7,9 +7,12 @@
 #include <locale>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <set>
 #include <map>
+#include <list>
 #include <memory>
+#include <tuple>
 #include <sstream>
 #include <chrono>
 #include <cctype>
@@ -236,6 +239,7 @@ struct Gauges {
     double session_online = 0;
     double session_total = 0;
     double realms_open = 0;
+    double download_cache_size = 0;
     std::map<std::string, double> user_sessions;
 };
 
@@ -254,17 +258,78 @@ struct ChangesetGroupStats {
 };
 
 
-struct DownloadCache {
-    std::unique_ptr<char[]> body;
-    std::size_t uncompressed_body_size;
-    std::size_t compressed_body_size;
-    bool body_is_compressed;
-    version_type end_version;
-    DownloadCursor download_progress;
-    std::uint_fast64_t downloadable_bytes;
-    std::size_t num_changesets;
-    std::size_t accum_original_size;
-    std::size_t accum_compacted_size;
+// The bodies of the DOWNLOAD messages used for client bootstrapping, shared by
+// all the sessions of a server file. Each chunk is the body of one DOWNLOAD
+// message, limited by Server::Config::max_download_size like any other, and is
+// keyed by the server file, by the codec requested when it was produced, and by
+// the download progress at which it begins. A bootstrapping client has no
+// changesets of its own in the history, so a chunk can be sent to any of them
+// that has reached that download progress, whatever the server version was when
+// the chunk was produced. A chunk is produced when the first session reaches it,
+// so the cache never grows ahead of the fastest bootstrapping client.
+//
+// There is one cache for the whole server, and the accumulated size of the
+// chunks of all files is kept within Server::Config::max_download_cache_size by
+// evicting the least recently used ones. The chunks are kept in a list ordered
+// by their last use, so that finding, adding, and evicting a chunk takes
+// logarithmic time in the number of cached chunks.
+class DownloadCache {
+public:
+    struct Chunk {
+        std::unique_ptr<char[]> body;
+        std::size_t uncompressed_body_size;
+        std::size_t compressed_body_size;
+        _impl::compression::Codec body_codec;
+        DownloadCursor download_progress;
+        std::size_t num_changesets;
+        std::size_t accum_original_size;
+        std::size_t accum_compacted_size;
+
+        std::size_t body_size() const noexcept
+        {
+            return (body_codec != _impl::compression::Codec::none ? compressed_body_size : uncompressed_body_size);
+        }
+    };
+
+    explicit DownloadCache(std::size_t max_size) noexcept
+        : m_max_size{max_size}
+    {
+    }
+
+    // Returns null if no chunk of the specified file begins at `begin`, or if
+    // the chunk that does ends after `end_version`. Chunks are only shared
+    // between sessions that use the same codec and the same Zstandard
+    // dictionary (zero for none).
+    const Chunk* find(const ServerFile&, _impl::compression::Codec, std::uint_fast32_t zstd_dictionary_id,
+                      DownloadCursor begin, version_type end_version) noexcept;
+
+    // Does nothing if a chunk of the specified file already begins at `begin`,
+    // or if the body of the specified one is larger than the maximum size of
+    // the cache on its own.
+    void add(const ServerFile&, _impl::compression::Codec, std::uint_fast32_t zstd_dictionary_id,
+             DownloadCursor begin, Chunk);
+
+    // Evicts all the chunks of the specified file.
+    void remove(const ServerFile&) noexcept;
+
+    // The accumulated size of the cached bodies.
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+private:
+    using Key =
+        std::tuple<const ServerFile*, _impl::compression::Codec, std::uint_fast32_t, version_type, version_type>;
+    // Most recently used first
+    using LruList = std::list<std::pair<Key, Chunk>>;
+
+    const std::size_t m_max_size;
+    LruList m_lru;
+    std::map<Key, LruList::iterator> m_index;
+    std::size_t m_size = 0;
+
+    void evict(std::map<Key, LruList::iterator>::iterator) noexcept;
 };
 
 
@@ -333,21 +398,6 @@ const AllocationMetricName g_worker_scratch_metric{"worker_scratch"};
 const AllocationMetricName g_worker_queue_metric{"worker_queue"};
 
 
-class WorkerState {
-public:
-    FileIdentAllocSlots file_ident_alloc_slots;
-    util::ScratchMemory scratch_memory;
-    bool use_file_cache = true;
-    std::unique_ptr<ServerHistory> reference_hist;
-    DBRef reference_sg;
-
-    WorkerState()
-        : scratch_memory{AllocationMetricsContext::get_current().get_metric(g_worker_scratch_metric)}
-    {
-    }
-};
-
-
 // ============================ IntegrationReporterImpl ============================
 
 class IntegrationReporterImpl : public ServerHistory::IntegrationReporter {
@@ -378,6 +428,31 @@ inline SteadyTimePoint IntegrationReporterImpl::get_session_start_time() const n
 }
 
 
+// ============================ WorkerState ============================
+
+// State owned by a thread executing work units on behalf of the Worker.
+class WorkerState {
+public:
+    FileIdentAllocSlots file_ident_alloc_slots;
+    util::ScratchMemory scratch_memory;
+    bool use_file_cache = true;
+    std::unique_ptr<ServerHistory> reference_hist;
+    DBRef reference_sg;
+
+    // Handed out to the histories of the files being integrated on this
+    // thread through the Worker's implementation of ServerHistory::Context.
+    std::mt19937_64 random;
+    const std::unique_ptr<Transformer> transformer;
+    util::Buffer<char> transform_buffer;
+    IntegrationReporterImpl integration_reporter;
+
+    WorkerState(ServerImpl&);
+};
+
+// The state of the thread currently executing a work unit, if any.
+REALM_THREAD_LOCAL WorkerState* g_current_worker_state = nullptr;
+
+
 // ============================ SessionQueue ============================
 
 class SessionQueue {
@@ -404,6 +479,8 @@ protected:
 
 // ============================ WorkerBox =============================
 
+// A pool of threads executing jobs in the order in which they are added. Each
+// thread has its own WorkerState.
 class WorkerBox {
 public:
     using JobType = std::function<void(WorkerState&)>;
@@ -423,8 +500,7 @@ public:
             if (m_threads.size() < m_max_num_threads && m_active >= m_threads.size()) {
                 m_threads.emplace_back([this, &tenant]() {
                     AllocationMetricsContextScope context_scope{tenant};
-                    WorkerState state;
-                    state.use_file_cache = false;
+                    WorkerState state{m_server};
                     JobType the_job;
                     std::unique_lock<std::mutex> lock(m_mutex);
                     for (;;) {
@@ -432,8 +508,8 @@ public:
                             m_changes.wait(lock);
                         if (m_finish_up)
                             break; // terminate thread
-                        the_job = std::move(m_jobs.back());
-                        m_jobs.pop_back();
+                        the_job = std::move(m_jobs.front());
+                        m_jobs.pop_front();
                         run_a_job(lock, state, the_job);
                         m_changes.notify_all();
                     }
@@ -453,8 +529,8 @@ public:
         std::unique_lock<std::mutex> lock(m_mutex);
         while (!m_jobs.empty() || m_active > 0) {
             if (!m_jobs.empty()) { // if possible, make this thread participate in running m_jobs
-                JobType the_job = std::move(m_jobs.back());
-                m_jobs.pop_back();
+                JobType the_job = std::move(m_jobs.front());
+                m_jobs.pop_front();
                 run_a_job(lock, state, the_job);
             }
             else {
@@ -466,7 +542,8 @@ public:
         }
     }
 
-    WorkerBox(unsigned int num_threads)
+    WorkerBox(ServerImpl& server, unsigned int num_threads)
+        : m_server{server}
     {
         m_queue_limit = num_threads * 10; // fudge factor for job size variation
         m_max_num_threads = num_threads;
@@ -484,10 +561,11 @@ public:
     }
 
 private:
+    ServerImpl& m_server;
     std::mutex m_mutex;
     std::condition_variable m_changes;
     std::vector<std::thread> m_threads;
-    std::vector<JobType> m_jobs;
+    std::deque<JobType> m_jobs;
     unsigned int m_active = 0;
     bool m_finish_up = false;
     unsigned int m_queue_limit = 0;
@@ -553,10 +631,7 @@ public:
         return m_file.access(); // Throws
     }
 
-    ServerFileAccessCache::File& worker_access()
-    {
-        return m_worker_file.access(); // Throws
-    }
+    ServerFileAccessCache::File& worker_access();
 
     version_type get_realm_version() const noexcept
     {
@@ -573,7 +648,6 @@ public:
         return m_version_info.sync_version;
     }
 
-    DownloadCache& get_download_cache() noexcept;
 
     void register_client_access(file_ident_type client_file_ident);
 
@@ -766,7 +840,9 @@ private:
     // (group_postprocess_stage_3()). Always zero for partial files.
     bool m_has_work_in_progress = 0;
 
-    // This one must only be accessed by the worker thread.
+    // This one must only be accessed by the worker thread executing the
+    // current work unit of this file, and only through Worker::access_file(),
+    // Worker::release_file(), and Worker::close_file().
     //
     // More specifically, `m_worker_file.access()` must only be called by the
     // worker thread, and if it was ever called, it must be closed by the worker
@@ -796,8 +872,6 @@ private:
     // must be rejected at receipt of the BIND message.
     bool m_realm_deletion_is_ongoing = false;
 
-    DownloadCache m_download_cache;
-
     static ClientFileBlacklist make_client_file_blacklist(const ServerImpl&, const std::string& virt_path);
 
     void changesets_from_downstream_added(std::size_t num_changesets, std::size_t num_bytes) noexcept;
@@ -837,9 +911,50 @@ private:
 };
 
 
-inline DownloadCache& ServerFile::get_download_cache() noexcept
+auto DownloadCache::find(const ServerFile& file, _impl::compression::Codec codec,
+                         std::uint_fast32_t zstd_dictionary_id, DownloadCursor begin,
+                         version_type end_version) noexcept -> const Chunk*
 {
-    return m_download_cache;
+    auto i = m_index.find(
+        Key{&file, codec, zstd_dictionary_id, begin.server_version, begin.last_integrated_client_version});
+    if (i == m_index.end() || i->second->second.download_progress.server_version > end_version)
+        return nullptr;
+    m_lru.splice(m_lru.begin(), m_lru, i->second);
+    return &i->second->second;
+}
+
+void DownloadCache::add(const ServerFile& file, _impl::compression::Codec codec, std::uint_fast32_t zstd_dictionary_id,
+                        DownloadCursor begin, Chunk chunk)
+{
+    Key key{&file, codec, zstd_dictionary_id, begin.server_version, begin.last_integrated_client_version};
+    std::size_t body_size = chunk.body_size();
+    if (body_size > m_max_size || m_index.count(key) != 0)
+        return;
+    while (m_size + body_size > m_max_size)
+        evict(m_index.find(m_lru.back().first));
+    m_lru.emplace_front(key, std::move(chunk)); // Throws
+    try {
+        m_index.emplace(key, m_lru.begin()); // Throws
+    }
+    catch (...) {
+        m_lru.pop_front();
+        throw;
+    }
+    m_size += body_size;
+}
+
+void DownloadCache::remove(const ServerFile& file) noexcept
+{
+    auto i = m_index.lower_bound(Key{&file, _impl::compression::Codec::none, 0, 0, 0});
+    while (i != m_index.end() && std::get<0>(i->first) == &file)
+        evict(i++);
+}
+
+void DownloadCache::evict(std::map<Key, LruList::iterator>::iterator i) noexcept
+{
+    m_size -= i->second->second.body_size();
+    m_lru.erase(i->second);
+    m_index.erase(i);
 }
 
 inline void ServerFile::changesets_from_downstream_added(std::size_t num_changesets, std::size_t num_bytes) noexcept
@@ -892,6 +1007,14 @@ public:
 
     void enqueue(ServerFile*);
 
+    // Work units of different files may be executed concurrently, so the file
+    // access cache must only be used through these. A file accessed through
+    // access_file() is kept open until release_file() or close_file() is
+    // called for it, regardless of which other files are accessed meanwhile.
+    ServerFileAccessCache::File& access_file(ServerFileAccessCache::Slot&);
+    void release_file(ServerFileAccessCache::Slot&) noexcept;
+    void close_file(ServerFileAccessCache::Slot&);
+
     // Overriding members of ServerHistory::Context
     bool owner_is_sync_server() const noexcept override final;
     std::mt19937_64& server_history_get_random() noexcept override final;
@@ -903,22 +1026,33 @@ public:
 
 private:
     ServerImpl& m_server;
-    std::mt19937_64 m_random;
-    const std::unique_ptr<Transformer> m_transformer;
-    util::Buffer<char> m_transform_buffer;
-    IntegrationReporterImpl m_integration_reporter;
     ServerFileAccessCache m_file_access_cache;
     AllocationMetricsContext& m_allocation_metrics_context;
 
+    util::Mutex m_file_access_mutex; // Protects `m_file_access_cache`
+
     util::Mutex m_mutex;
     util::CondVar m_cond; // Protected by `m_mutex`
 
     bool m_stop = false; // Protected by `m_mutex`
 
+    // The first error thrown by a work unit executed by `m_worker_box`.
+    std::exception_ptr m_error; // Protected by `m_mutex`
+
     util::CircularBuffer<ServerFile*> m_queue; // Protected by `m_mutex`
 
+    // State of the worker thread itself
     WorkerState m_state;
 
+    // Null unless Server::Config::num_worker_threads is greater than 1, in
+    // which case work units are executed by this pool rather than directly by
+    // the worker thread.
+    std::unique_ptr<WorkerBox> m_worker_box;
+
+    WorkerState& get_state() noexcept;
+    const WorkerState& get_state() const noexcept;
+    void process_work_unit(ServerFile&, WorkerState&);
+
     void run();
     void stop() noexcept;
 
@@ -933,7 +1067,17 @@ inline ServerFileAccessCache& Worker::get_file_access_cache() noexcept
 
 inline SteadyTimePoint Worker::get_integration_session_start_time() const noexcept
 {
-    return m_integration_reporter.get_session_start_time();
+    return get_state().integration_reporter.get_session_start_time();
+}
+
+inline WorkerState& Worker::get_state() noexcept
+{
+    return g_current_worker_state ? *g_current_worker_state : m_state;
+}
+
+inline const WorkerState& Worker::get_state() const noexcept
+{
+    return g_current_worker_state ? *g_current_worker_state : m_state;
 }
 
 
@@ -943,8 +1087,8 @@ class ServerImpl : public ServerImplBase, public ServerHistory::Context {
 public:
     std::uint_fast64_t errors_seen = 0;
 
-    std::atomic<milliseconds_type> m_par_time;
-    std::atomic<milliseconds_type> m_seq_time;
+    std::atomic<milliseconds_type> m_par_time{0};
+    std::atomic<milliseconds_type> m_seq_time{0};
 
     util::Mutex last_client_accesses_mutex;
 
@@ -1005,11 +1149,37 @@ public:
         return m_compress_memory_arena;
     }
 
+    // The codecs that must not be used for DOWNLOAD message bodies
+    _impl::compression::CodecSet get_disabled_codecs() const noexcept
+    {
+        return m_disabled_codecs;
+    }
+
+    // Returns null if there is no Zstandard dictionary with the specified ID
+    const _impl::compression::ZstdDictionary* find_zstd_dictionary(std::uint_fast32_t id) const noexcept
+    {
+        auto i = m_zstd_dictionaries.find(id);
+        return (i != m_zstd_dictionaries.end() ? i->second.get() : nullptr);
+    }
+
+    // The IDs of the Zstandard dictionaries, formatted for the handshake
+    // response (see _impl::g_sync_zstd_dictionaries_header). Empty if there
+    // are none.
+    const std::string& get_zstd_dictionary_list() const noexcept
+    {
+        return m_zstd_dictionary_list;
+    }
+
     MiscBuffers& get_misc_buffers() noexcept
     {
         return m_misc_buffers;
     }
 
+    DownloadCache& get_download_cache() noexcept
+    {
+        return m_download_cache;
+    }
+
     int_fast64_t get_current_server_session_ident() const noexcept
     {
         return m_current_server_session_ident;
@@ -1227,6 +1397,8 @@ private:
     ServerFileAccessCache m_file_access_cache;
     Metrics& m_metrics;
     Worker m_worker;
+    // Must outlive the server files, which evict their chunks when destroyed
+    DownloadCache m_download_cache;
     std::map<std::string, util::bind_ptr<ServerFile>> m_files; // Key is virtual path
     util::network::Acceptor m_acceptor;
     std::int_fast64_t m_next_conn_id = 0;
@@ -1236,6 +1408,9 @@ private:
     std::map<std::int_fast64_t, std::unique_ptr<SyncConnection>> m_sync_connections;
     ServerProtocol m_server_protocol;
     _impl::compression::CompressMemoryArena m_compress_memory_arena;
+    const _impl::compression::CodecSet m_disabled_codecs;
+    std::map<std::uint_fast32_t, std::unique_ptr<_impl::compression::ZstdDictionary>> m_zstd_dictionaries;
+    std::string m_zstd_dictionary_list;
     MiscBuffers m_misc_buffers;
     std::unique_ptr<Transformer> m_transformer;
     util::Buffer<char> m_transform_buffer;
@@ -1410,7 +1585,8 @@ public:
     SyncConnection(ServerImpl& serv, std::int_fast64_t id, std::unique_ptr<util::network::Socket>&& socket,
                    std::unique_ptr<util::network::ssl::Stream>&& ssl_stream,
                    std::unique_ptr<util::network::ReadAheadBuffer>&& read_ahead_buffer, int client_protocol_version,
-                   std::string client_user_agent, std::string remote_endpoint)
+                   _impl::compression::CodecSet client_codecs, std::string client_user_agent,
+                   std::string remote_endpoint)
         : logger{make_logger_prefix(id), serv.logger} // Throws
         , m_server{serv}
         , m_id{id}
@@ -1419,6 +1595,7 @@ public:
         , m_read_ahead_buffer{std::move(read_ahead_buffer)}
         , m_websocket{*this}
         , m_client_protocol_version{client_protocol_version}
+        , m_client_codecs{client_codecs}
         , m_client_user_agent{std::move(client_user_agent)}
         , m_remote_endpoint{std::move(remote_endpoint)}
     {
@@ -1451,6 +1628,18 @@ public:
         return m_client_protocol_version;
     }
 
+    // The body codecs that the client listed in the handshake request, see
+    // _impl::g_sync_codecs_header.
+    _impl::compression::CodecSet get_client_codecs() const noexcept
+    {
+        return m_client_codecs;
+    }
+
+    // Returns the Zstandard dictionary that the specified session is bound
+    // to, or null if there is no such session, or if it is not bound to a
+    // dictionary.
+    const _impl::compression::ZstdDictionary* get_zstd_dictionary(session_ident_type) const noexcept;
+
     const std::string& get_client_user_agent() const noexcept
     {
         return m_client_user_agent;
@@ -1616,7 +1805,7 @@ public:
     void handle_protocol_error(ServerProtocol::Error error);
 
     void receive_bind_message(session_ident_type, std::string path, std::string signed_user_token,
-                              bool need_client_file_ident, bool is_subserver);
+                              bool need_client_file_ident, bool is_subserver, std::uint_fast32_t zstd_dictionary_id);
 
     void receive_ident_message(session_ident_type, file_ident_type client_file_ident,
                                salt_type client_file_ident_salt, version_type scan_server_version,
@@ -1667,6 +1856,9 @@ private:
     // The protocol version in use by the connected client.
     const int m_client_protocol_version;
 
+    // The body codecs that the connected client can decompress.
+    const _impl::compression::CodecSet m_client_codecs;
+
     // The user agent description passed by the client.
     const std::string m_client_user_agent;
 
@@ -2224,6 +2416,25 @@ private:
         REALM_ASSERT(response);
         add_common_http_response_headers(*response);
 
+        // Codec negotiation, see _impl::g_sync_codecs_header. Protocol version
+        // 1 only knows zlib.
+        using _impl::compression::Codec;
+        _impl::compression::CodecSet client_codecs =
+            _impl::compression::codec_set(Codec::none) | _impl::compression::codec_set(Codec::deflate);
+        if (negotiated_protocol_version >= 2) {
+            util::StringView value;
+            auto i = request.headers.find(_impl::g_sync_codecs_header);
+            if (i != request.headers.end())
+                value = i->second;
+            client_codecs = _impl::parse_codec_list(value);
+            response->headers[_impl::g_sync_codecs_header] =
+                _impl::format_codec_list(_impl::compression::get_available_codecs()); // Throws
+            const std::string& dictionaries = m_server.get_zstd_dictionary_list();
+            if (!dictionaries.empty())
+                response->headers[_impl::g_sync_zstd_dictionaries_header] = dictionaries; // Throws
+            logger.debug("Client codecs: '%1'", _impl::format_codec_list(client_codecs)); // Throws
+        }
+
         std::string user_agent;
         {
             auto i = request.headers.find(g_user_agent);
@@ -2231,7 +2442,8 @@ private:
                 user_agent = i->second; // Throws (copy)
         }
 
-        auto handler = [negotiated_protocol_version, user_agent = std::move(user_agent), this](std::error_code ec) {
+        auto handler = [negotiated_protocol_version, client_codecs, user_agent = std::move(user_agent),
+                        this](std::error_code ec) {
             // If the operation is aborted, the socket object may have been destroyed.
             if (ec != util::error::operation_aborted) {
                 if (ec) {
@@ -2241,7 +2453,7 @@ private:
 
                 std::unique_ptr<SyncConnection> sync_conn = std::make_unique<SyncConnection>(
                     m_server, m_id, std::move(m_socket), std::move(m_ssl_stream), std::move(m_read_ahead_buffer),
-                    negotiated_protocol_version, std::move(user_agent),
+                    negotiated_protocol_version, client_codecs, std::move(user_agent),
                     std::move(m_remote_endpoint)); // Throws
                 SyncConnection& sync_conn_ref = *sync_conn;
                 m_server.add_sync_connection(m_id, std::move(sync_conn));
@@ -2596,6 +2808,11 @@ public:
         return m_connection.gauges();
     }
 
+    const _impl::compression::ZstdDictionary* get_zstd_dictionary() const noexcept
+    {
+        return m_zstd_dictionary;
+    }
+
     session_ident_type get_session_ident() const noexcept
     {
         return m_session_ident;
@@ -2890,13 +3107,26 @@ public:
     }
 
     bool receive_bind_message(std::string path, std::string signed_user_token, bool need_client_file_ident,
-                              bool is_subserver, ProtocolError& error)
+                              bool is_subserver, std::uint_fast32_t zstd_dictionary_id, ProtocolError& error)
     {
         if (logger.would_log(util::Logger::Level::info)) {
             logger.detail("Received: BIND(server_path=%1, signed_user_token='%2', "
-                          "need_client_file_ident=%3, is_subserver=%4)",
+                          "need_client_file_ident=%3, is_subserver=%4, zstd_dictionary_id=%5)",
                           path, short_token_fmt(signed_user_token), int(need_client_file_ident),
-                          int(is_subserver)); // Throws
+                          int(is_subserver), zstd_dictionary_id); // Throws
+        }
+
+        // The client only binds to dictionaries listed in the handshake
+        // response
+        if (zstd_dictionary_id != 0) {
+            m_zstd_dictionary = m_connection.get_server().find_zstd_dictionary(zstd_dictionary_id);
+            if (REALM_UNLIKELY(!m_zstd_dictionary)) {
+                logger.error("Unknown Zstandard dictionary %1 in BIND message",
+                             zstd_dictionary_id);         // Throws
+                metrics().increment("protocol.violated"); // Throws
+                error = ProtocolError::unsupported_session_feature;
+                return false;
+            }
         }
 
         bool is_refresh = false;
@@ -3688,6 +3918,10 @@ private:
     bool m_disable_download = false;
     bool m_is_subserver = false;
 
+    // The Zstandard dictionary that the session was bound to by the BIND
+    // message, if any. Owned by the server.
+    const _impl::compression::ZstdDictionary* m_zstd_dictionary = nullptr;
+
     using file_ident_request_type = ServerFile::file_ident_request_type;
 
     // When nonzero, this session has an outstanding request for a client file
@@ -3804,7 +4038,14 @@ private:
             const char* body;
             std::size_t uncompressed_body_size;
             std::size_t compressed_body_size = 0;
-            bool body_is_compressed = false;
+            using _impl::compression::Codec;
+            Codec body_codec = Codec::none;
+            Codec codec =
+                _impl::select_body_codec(m_connection.get_client_protocol_version(), m_connection.get_client_codecs(),
+                                         server.get_disabled_codecs(), m_zstd_dictionary != nullptr);
+            const _impl::compression::ZstdDictionary* dictionary =
+                (codec == Codec::zstd ? m_zstd_dictionary : nullptr);
+            std::uint_fast32_t zstd_dictionary_id = (dictionary ? dictionary->get_id() : 0);
             version_type end_version = last_server_version.version;
             DownloadCursor download_progress;
             UploadCursor upload_progress = {0, 0};
@@ -3814,99 +4055,95 @@ private:
             std::size_t accum_compacted_size;
             ServerProtocol& protocol = get_server_protocol();
             bool disable_download_compaction = config.disable_download_compaction;
-            bool enable_cache = (config.enable_download_bootstrap_cache && m_download_progress.server_version == 0 &&
-                                 m_upload_progress.client_version == 0 && m_upload_threshold.client_version == 0);
-            DownloadCache& cache = m_server_file->get_download_cache();
-            bool fetch_from_cache = (enable_cache && cache.body && end_version == cache.end_version);
-            if (fetch_from_cache) {
-                body = cache.body.get();
-                uncompressed_body_size = cache.uncompressed_body_size;
-                compressed_body_size = cache.compressed_body_size;
-                body_is_compressed = cache.body_is_compressed;
-                download_progress = cache.download_progress;
-                downloadable_bytes = cache.downloadable_bytes;
-                num_changesets = cache.num_changesets;
-                accum_original_size = cache.accum_original_size;
-                accum_compacted_size = cache.accum_compacted_size;
+            bool enable_cache = (config.enable_download_bootstrap_cache && m_upload_progress.client_version == 0 &&
+                                 m_upload_threshold.client_version == 0);
+            DownloadCache& cache = server.get_download_cache();
+            const DownloadCache::Chunk* cached_chunk = nullptr;
+            if (enable_cache) {
+                // The body of a cached chunk may end before `end_version`, in
+                // which case the rest of the history follows in the next
+                // DOWNLOAD message.
+                cached_chunk = cache.find(*m_server_file, codec, zstd_dictionary_id, m_download_progress, end_version);
+                metrics().increment(cached_chunk ? "download.cache.hit" : "download.cache.miss"); // Throws
+            }
+            if (cached_chunk) {
+                body = cached_chunk->body.get();
+                uncompressed_body_size = cached_chunk->uncompressed_body_size;
+                compressed_body_size = cached_chunk->compressed_body_size;
+                body_codec = cached_chunk->body_codec;
+                download_progress = cached_chunk->download_progress;
+                // The history may have grown since the chunk was produced
+                std::uint_fast64_t cumulative_byte_size_current;
+                std::uint_fast64_t cumulative_byte_size_total;
+                history.get_cumulative_byte_sizes(download_progress.server_version, cumulative_byte_size_current,
+                                                  cumulative_byte_size_total); // Throws
+                downloadable_bytes = cumulative_byte_size_total - cumulative_byte_size_current;
+                num_changesets = cached_chunk->num_changesets;
+                accum_original_size = cached_chunk->accum_original_size;
+                accum_compacted_size = cached_chunk->accum_compacted_size;
             }
             else {
-                // Discard the old cached DOWNLOAD body before generating a new
-                // one to be cached. This can make a big difference because the
-                // size of that body can be very large (10GiB has been seen in a
-                // real-world case).
-                if (enable_cache)
-                    cache.body = {};
-
                 OutputBuffer& out = server.get_misc_buffers().download_message;
                 out.reset();
                 download_progress = m_download_progress;
-                auto fetch_and_compress = [&](std::size_t max_download_size) {
-                    DownloadHistoryEntryHandler handler{protocol, out, logger};
-                    std::uint_fast64_t cumulative_byte_size_current;
-                    std::uint_fast64_t cumulative_byte_size_total;
-                    bool not_expired = history.fetch_download_info(
-                        m_client_file_ident, download_progress, end_version, upload_progress, handler,
-                        cumulative_byte_size_current, cumulative_byte_size_total, disable_download_compaction,
-                        max_download_size); // Throws
-                    REALM_ASSERT(upload_progress.client_version >= download_progress.last_integrated_client_version);
-                    SyncConnection& conn = get_connection();
-                    if (REALM_UNLIKELY(!not_expired)) {
-                        logger.debug("History scanning failed: Client file entry "
-                                     "expired during session"); // Throws
-                        conn.protocol_error(ProtocolError::client_file_expired, this);
-                        // Session object may have been destroyed at this point
-                        // (suicide).
-                        return false;
-                    }
+                DownloadHistoryEntryHandler handler{protocol, out, logger};
+                std::uint_fast64_t cumulative_byte_size_current;
+                std::uint_fast64_t cumulative_byte_size_total;
+                bool not_expired = history.fetch_download_info(
+                    m_client_file_ident, download_progress, end_version, upload_progress, handler,
+                    cumulative_byte_size_current, cumulative_byte_size_total, disable_download_compaction,
+                    config.max_download_size); // Throws
+                REALM_ASSERT(upload_progress.client_version >= download_progress.last_integrated_client_version);
+                SyncConnection& conn = get_connection();
+                if (REALM_UNLIKELY(!not_expired)) {
+                    logger.debug("History scanning failed: Client file entry "
+                                 "expired during session"); // Throws
+                    conn.protocol_error(ProtocolError::client_file_expired, this);
+                    // Session object may have been destroyed at this point
+                    // (suicide).
+                    return;
+                }
 
-                    downloadable_bytes = cumulative_byte_size_total - cumulative_byte_size_current;
-                    uncompressed_body_size = out.size();
-                    BinaryData uncompressed = {out.data(), uncompressed_body_size};
-                    body = uncompressed.data();
-                    std::size_t max_uncompressed = 1024;
-                    if (uncompressed.size() > max_uncompressed) {
-                        _impl::compression::CompressMemoryArena& arena = server.get_compress_memory_arena();
-                        std::vector<char>& buffer = server.get_misc_buffers().compress;
-                        std::size_t size = _impl::compression::allocate_and_compress(arena, uncompressed,
-                                                                                     buffer); // Throws
-                        if (size < uncompressed.size()) {
-                            body = buffer.data();
-                            compressed_body_size = size;
-                            body_is_compressed = true;
-                        }
-                    }
-                    num_changesets = handler.num_changesets;
-                    accum_original_size = handler.accum_original_size;
-                    accum_compacted_size = handler.accum_compacted_size;
-                    return true;
-                };
-                if (enable_cache) {
-                    std::size_t max_download_size = std::numeric_limits<size_t>::max();
-                    if (!fetch_and_compress(max_download_size)) { // Throws
-                        // Session object may have been destroyed at this point
-                        // (suicide).
-                        return;
+                downloadable_bytes = cumulative_byte_size_total - cumulative_byte_size_current;
+                uncompressed_body_size = out.size();
+                BinaryData uncompressed = {out.data(), uncompressed_body_size};
+                body = uncompressed.data();
+                std::size_t max_uncompressed = 1024;
+                if (uncompressed.size() > max_uncompressed) {
+                    _impl::compression::CompressMemoryArena& arena = server.get_compress_memory_arena();
+                    std::vector<char>& buffer = server.get_misc_buffers().compress;
+                    std::size_t size = _impl::compression::allocate_and_compress(arena, uncompressed, buffer, codec,
+                                                                                 dictionary); // Throws
+                    if (size < uncompressed.size()) {
+                        body = buffer.data();
+                        compressed_body_size = size;
+                        body_codec = codec;
                     }
+                }
+                num_changesets = handler.num_changesets;
+                accum_original_size = handler.accum_original_size;
+                accum_compacted_size = handler.accum_compacted_size;
+
+                if (enable_cache && download_progress.server_version > m_download_progress.server_version) {
                     REALM_ASSERT(upload_progress.client_version == 0);
+                    bool body_is_compressed = (body_codec != Codec::none);
                     std::size_t body_size = (body_is_compressed ? compressed_body_size : uncompressed_body_size);
-                    cache.body = std::make_unique<char[]>(body_size); // Throws
-                    std::copy(body, body + body_size, cache.body.get());
-                    cache.uncompressed_body_size = uncompressed_body_size;
-                    cache.compressed_body_size = compressed_body_size;
-                    cache.body_is_compressed = body_is_compressed;
-                    cache.end_version = end_version;
-                    cache.download_progress = download_progress;
-                    cache.downloadable_bytes = downloadable_bytes;
-                    cache.num_changesets = num_changesets;
-                    cache.accum_original_size = accum_original_size;
-                    cache.accum_compacted_size = accum_compacted_size;
-                }
-                else {
-                    std::size_t max_download_size = config.max_download_size;
-                    if (!fetch_and_compress(max_download_size)) { // Throws
-                        // Session object may have been destroyed at this point
-                        // (suicide).
-                        return;
+                    DownloadCache::Chunk chunk;
+                    chunk.body = std::make_unique<char[]>(body_size); // Throws
+                    std::copy(body, body + body_size, chunk.body.get());
+                    chunk.uncompressed_body_size = uncompressed_body_size;
+                    chunk.compressed_body_size = compressed_body_size;
+                    chunk.body_codec = body_codec;
+                    chunk.download_progress = download_progress;
+                    chunk.num_changesets = num_changesets;
+                    chunk.accum_original_size = accum_original_size;
+                    chunk.accum_compacted_size = accum_compacted_size;
+                    std::size_t old_cache_size = cache.size();
+                    cache.add(*m_server_file, codec, zstd_dictionary_id, m_download_progress,
+                              std::move(chunk)); // Throws
+                    if (cache.size() != old_cache_size) {
+                        gauges().download_cache_size += double(cache.size()) - double(old_cache_size);
+                        metrics().gauge("download.cache.size", gauges().download_cache_size); // Throws
                     }
                 }
             }
@@ -3918,7 +4155,7 @@ private:
                 download_progress.last_integrated_client_version, last_server_version.version,
                 last_server_version.salt, upload_progress.client_version,
                 upload_progress.last_integrated_server_version, downloadable_bytes, num_changesets, body,
-                uncompressed_body_size, compressed_body_size, body_is_compressed, logger); // Throws
+                uncompressed_body_size, compressed_body_size, body_codec, logger); // Throws
             milliseconds_type elapsed = steady_duration(start_time);
             metrics().increment("download.constructed");                                   // Throws
             metrics().timing("download.constructed", double(elapsed));                     // Throws
@@ -4236,10 +4473,18 @@ ServerFile::~ServerFile() noexcept
 
     REALM_ASSERT(m_file_ident_request == 0);
 
+    DownloadCache& cache = m_server.get_download_cache();
+    std::size_t old_cache_size = cache.size();
+    cache.remove(*this);
+
     // FIXME: Muffling an exception is not ideal. A better approach is to move
     // the metrics operation out of the destructor.
     try {
         m_server.metrics().gauge("realms.open", --m_server.gauges().realms_open); // Throws
+        if (cache.size() != old_cache_size) {
+            m_server.gauges().download_cache_size -= double(old_cache_size) - double(cache.size());
+            m_server.metrics().gauge("download.cache.size", m_server.gauges().download_cache_size); // Throws
+        }
     }
     catch (...) {
         // Throwing in destructor is not allowed, so we catch here
@@ -4437,17 +4682,29 @@ BootstrapError ServerFile::bootstrap_client_session(SaltedFileIdent client_file_
 }
 
 // NOTE: This function is executed by the worker thread
+ServerFileAccessCache::File& ServerFile::worker_access()
+{
+    return m_server.get_worker().access_file(m_worker_file); // Throws
+}
+
+
+// NOTE: This function is executed by the worker thread, or by one of the
+// threads of its WorkerBox when Server::Config::num_worker_threads is greater
+// than 1.
 void ServerFile::worker_process_work_unit(WorkerState& state)
 {
     SteadyTimePoint start_time = steady_clock_now();
-    milliseconds_type parallel_time = 0;
+    Worker& worker = m_server.get_worker();
+    auto release_file = util::make_scope_exit([&]() noexcept {
+        worker.release_file(m_worker_file);
+    });
 
     Work& work = m_work;
     wlogger.debug("Work unit execution started"); // Throws
 
     if (work.has_primary_work) {
         if (REALM_UNLIKELY(work.request_deletion)) {
-            m_worker_file.proper_close(); // Throws
+            worker.close_file(m_worker_file); // Throws
             goto done;
         }
 
@@ -4461,16 +4718,18 @@ void ServerFile::worker_process_work_unit(WorkerState& state)
     // Compaction
     if (REALM_UNLIKELY(work.group_has_compaction_requests)) {
         if (work.request_compaction)
-            m_worker_file.proper_close(); // Throws
+            worker.close_file(m_worker_file); // Throws
     }
 
 done:
     wlogger.debug("Work unit execution completed"); // Throws
 
+    // Work units executed while other files can be integrated concurrently
+    // count as parallel time.
     milliseconds_type time = steady_duration(start_time);
-    milliseconds_type seq_time = time - parallel_time;
-    m_server.m_seq_time.fetch_add(seq_time, std::memory_order_relaxed);
-    m_server.m_par_time.fetch_add(parallel_time, std::memory_order_relaxed);
+    bool parallel = (m_server.get_config().num_worker_threads > 1);
+    auto& timer = (parallel ? m_server.m_par_time : m_server.m_seq_time);
+    timer.fetch_add(time, std::memory_order_relaxed);
     m_server.metrics().timing("workunit.time", double(time)); // Throws
 
     // Pass control back to the network event loop thread
@@ -5132,18 +5391,30 @@ bool ServerFile::realm_deletion_is_ongoing() const
 }
 
 
+// ============================ WorkerState implementation ============================
+
+WorkerState::WorkerState(ServerImpl& server)
+    : scratch_memory{AllocationMetricsContext::get_current().get_metric(g_worker_scratch_metric)}
+    , transformer{make_transformer()} // Throws
+    , integration_reporter{server}
+{
+    util::seed_prng_nondeterministically(random); // Throws
+}
+
+
 // ============================ Worker implementation ============================
 
 Worker::Worker(ServerImpl& server)
     : logger{"Worker: ", server.logger} // Throws
     , m_server{server}
-    , m_transformer{make_transformer()} // Throws
-    , m_integration_reporter{server}
     , m_file_access_cache{server.get_config().max_open_files, logger, *this, server.get_config().encryption_key,
                           server.get_config().metrics}
     , m_allocation_metrics_context{AllocationMetricsContext::get_current()}
+    , m_state{server} // Throws
 {
-    util::seed_prng_nondeterministically(m_random); // Throws
+    unsigned int num_threads = server.get_config().num_worker_threads;
+    if (num_threads > 1)
+        m_worker_box = std::make_unique<WorkerBox>(server, num_threads); // Throws
 }
 
 
@@ -5155,6 +5426,30 @@ void Worker::enqueue(ServerFile* file)
 }
 
 
+ServerFileAccessCache::File& Worker::access_file(ServerFileAccessCache::Slot& slot)
+{
+    util::LockGuard lock{m_file_access_mutex};
+    ServerFileAccessCache::File& file = slot.access(); // Throws
+    slot.pin();
+    return file;
+}
+
+
+void Worker::release_file(ServerFileAccessCache::Slot& slot) noexcept
+{
+    util::LockGuard lock{m_file_access_mutex};
+    slot.unpin();
+}
+
+
+void Worker::close_file(ServerFileAccessCache::Slot& slot)
+{
+    util::LockGuard lock{m_file_access_mutex};
+    slot.unpin();
+    slot.proper_close(); // Throws
+}
+
+
 bool Worker::owner_is_sync_server() const noexcept
 {
     return true;
@@ -5163,7 +5458,7 @@ bool Worker::owner_is_sync_server() const noexcept
 
 std::mt19937_64& Worker::server_history_get_random() noexcept
 {
-    return m_random;
+    return get_state().random;
 }
 
 
@@ -5192,19 +5487,19 @@ Clock::time_point Worker::get_compaction_clock_now() const noexcept
 
 sync::Transformer& Worker::get_transformer()
 {
-    return *m_transformer;
+    return *get_state().transformer;
 }
 
 
 util::Buffer<char>& Worker::get_transform_buffer()
 {
-    return m_transform_buffer;
+    return get_state().transform_buffer;
 }
 
 
 IntegrationReporterImpl& Worker::get_integration_reporter()
 {
-    return m_integration_reporter;
+    return get_state().integration_reporter;
 }
 
 
@@ -5216,13 +5511,36 @@ void Worker::run()
     // started, but this is a little cumbersome with ThreadExecGuard.
     AllocationMetricsContextScope tenant_scope{m_allocation_metrics_context};
 
+    if (!m_worker_box) {
+        for (;;) {
+            ServerFile* file = nullptr;
+            {
+                util::LockGuard lock{m_mutex};
+                for (;;) {
+                    if (REALM_UNLIKELY(m_stop))
+                        return;
+                    if (!m_queue.empty()) {
+                        file = m_queue.front();
+                        m_queue.pop_front();
+                        break;
+                    }
+                    m_cond.wait(lock);
+                }
+            }
+            file->worker_process_work_unit(m_state); // Throws
+        }
+    }
+
+    // A file is passed to the worker only when it has no work unit in
+    // progress, so the work units of a particular file are still executed one
+    // at a time and in order.
     for (;;) {
         ServerFile* file = nullptr;
         {
             util::LockGuard lock{m_mutex};
             for (;;) {
-                if (REALM_UNLIKELY(m_stop))
-                    return;
+                if (REALM_UNLIKELY(m_stop || m_error))
+                    break;
                 if (!m_queue.empty()) {
                     file = m_queue.front();
                     m_queue.pop_front();
@@ -5231,7 +5549,37 @@ void Worker::run()
                 m_cond.wait(lock);
             }
         }
-        file->worker_process_work_unit(m_state); // Throws
+        if (!file)
+            break;
+        m_worker_box->add_work(m_state, [this, file](WorkerState& state) {
+            process_work_unit(*file, state); // Throws
+        });                                  // Throws
+    }
+
+    // Pending work units are skipped, as they would be when executed directly
+    // by this thread
+    m_worker_box->wait_completion(m_state); // Throws
+    if (m_error)
+        std::rethrow_exception(m_error);
+}
+
+
+void Worker::process_work_unit(ServerFile& file, WorkerState& state)
+{
+    {
+        util::LockGuard lock{m_mutex};
+        if (m_stop || m_error)
+            return;
+    }
+    auto current_state = util::make_temp_assign(g_current_worker_state, &state, g_current_worker_state);
+    try {
+        file.worker_process_work_unit(state); // Throws
+    }
+    catch (...) {
+        util::LockGuard lock{m_mutex};
+        if (!m_error)
+            m_error = std::current_exception();
+        m_cond.notify_all();
     }
 }
 
@@ -5257,12 +5605,28 @@ ServerImpl::ServerImpl(const std::string& root_dir, util::Optional<sync::PKey> p
     , m_file_access_cache{m_config.max_open_files, logger, *this, config.encryption_key, m_config.metrics} // Throws
     , m_metrics{m_config.metrics ? *m_config.metrics : g_null_metrics}
     , m_worker{*this} // Throws
+    , m_download_cache{m_config.max_download_cache_size}
     , m_acceptor{get_service()}
     , m_server_protocol{}       // Throws
     , m_compress_memory_arena{} // Throws
+    , m_disabled_codecs{
+          (m_config.disable_zstd_compression ? _impl::compression::codec_set(_impl::compression::Codec::zstd) : 0) |
+          (m_config.disable_lz4_compression ? _impl::compression::codec_set(_impl::compression::Codec::lz4) : 0)}
     , m_integration_reporter{*this}
     , m_allocation_metrics_timer{get_service()}
 {
+    for (const std::string& content : m_config.zstd_dictionaries) {
+        auto dictionary = std::make_unique<_impl::compression::ZstdDictionary>(
+            BinaryData{content.data(), content.size()}); // Throws
+        std::uint_fast32_t id = dictionary->get_id();
+        bool was_inserted = m_zstd_dictionaries.emplace(id, std::move(dictionary)).second; // Throws
+        if (!was_inserted)
+            throw std::runtime_error(util::format("Duplicate Zstandard dictionary ID %1", id));
+        if (!m_zstd_dictionary_list.empty())
+            m_zstd_dictionary_list += ",";         // Throws
+        m_zstd_dictionary_list += util::to_string(id); // Throws
+    }
+
     if (m_config.ssl) {
         m_ssl_context = std::make_unique<util::network::ssl::Context>();          // Throws
         m_ssl_context->use_certificate_chain_file(m_config.ssl_certificate_path); // Throws
@@ -5334,7 +5698,19 @@ void ServerImpl::start()
                 (m_config.disable_download_compaction ? "No" : "Yes")); // Throws
     logger.info("Download bootstrap caching: %1",
                 (m_config.enable_download_bootstrap_cache ? "Yes" : "No"));                // Throws
+    {
+        auto describe = [&](_impl::compression::Codec codec) {
+            if (!_impl::compression::is_codec_available(codec))
+                return "Not available";
+            return ((m_disabled_codecs & _impl::compression::codec_set(codec)) != 0 ? "No" : "Yes");
+        };
+        logger.info("Zstd compression: %1", describe(_impl::compression::Codec::zstd)); // Throws
+        logger.info("LZ4 compression: %1", describe(_impl::compression::Codec::lz4));   // Throws
+        logger.info("Zstd dictionaries: %1",
+                    (m_zstd_dictionary_list.empty() ? std::string("None") : m_zstd_dictionary_list)); // Throws
+    }
     logger.info("Max download size: %1 bytes", m_config.max_download_size);                // Throws
+    logger.info("Max download cache size: %1 bytes", m_config.max_download_cache_size);    // Throws
     logger.info("Max upload backlog: %1 bytes", m_max_upload_backlog);                     // Throws
     logger.info("HTTP request timeout: %1 ms", m_config.http_request_timeout);             // Throws
     logger.info("HTTP response timeout: %1 ms", m_config.http_response_timeout);           // Throws
@@ -5452,6 +5828,8 @@ void ServerImpl::run()
         worker_thread.stop_and_rethrow(); // Throws
     }
 
+    logger.debug("Time spent executing work units: %1ms in parallel, %2ms sequentially",
+                 milliseconds_type(m_par_time), milliseconds_type(m_seq_time)); // Throws
     logger.info("Realm sync server stopped");
 }
 
@@ -6001,9 +6379,17 @@ void SyncConnection::handle_protocol_error(ServerProtocol::Error error)
 }
 
 
+const _impl::compression::ZstdDictionary*
+SyncConnection::get_zstd_dictionary(session_ident_type session_ident) const noexcept
+{
+    auto i = m_sessions.find(session_ident);
+    return (i != m_sessions.end() && i->second ? i->second->get_zstd_dictionary() : nullptr);
+}
+
+
 void SyncConnection::receive_bind_message(session_ident_type session_ident, std::string path,
                                           std::string signed_user_token, bool need_client_file_ident,
-                                          bool is_subserver)
+                                          bool is_subserver, std::uint_fast32_t zstd_dictionary_id)
 {
     auto p = m_sessions.emplace(session_ident, nullptr); // Throws
     bool was_inserted = p.second;
@@ -6027,7 +6413,7 @@ void SyncConnection::receive_bind_message(session_ident_type session_ident, std:
     ProtocolError error;
     bool success =
         sess.receive_bind_message(std::move(path), std::move(signed_user_token), need_client_file_ident, is_subserver,
-                                  error); // Throws
+                                  zstd_dictionary_id, error); // Throws
     if (REALM_UNLIKELY(!success))         // Throws
         protocol_error(error, &sess);     // Throws
 }
@@ -6,6 +6,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 #include <exception>
 
 #include <realm/util/network.hpp>
@@ -86,6 +87,17 @@ public:
         /// for each major thread).
         long max_open_files = 256;
 
+        /// The number of threads integrating changes uploaded by clients. No
+        /// more than one thread works on a particular Realm file at any time,
+        /// so changes to one file are still integrated in the order in which
+        /// they were received, but when this is greater than 1, different
+        /// files are integrated concurrently, and a slow integration into one
+        /// file no longer delays the others. The background cache of open
+        /// Realm files (see `max_open_files`) is shared by these threads,
+        /// and files in use by one thread are never closed to make room for
+        /// files needed by another.
+        unsigned int num_worker_threads = 1;
+
         /// An optional custom clock to be used for token expiration checks. If
         /// no clock is specified, the server will use the system clock.
         Clock* token_expiration_clock = nullptr;
@@ -183,10 +195,48 @@ public:
         /// minimizing download sizes at the expense of server CPU usage.
         bool disable_download_compaction = false;
 
+        /// If set to true, DOWNLOAD message bodies are never compressed with
+        /// Zstd, even for clients supporting it. zlib takes several times more
+        /// CPU time, and usually produces larger bodies. UPLOAD message bodies
+        /// compressed with Zstd are still accepted.
+        bool disable_zstd_compression = false;
+
+        /// If set to true, DOWNLOAD message bodies are never compressed with
+        /// LZ4, even for clients supporting it. LZ4 takes the least CPU time,
+        /// but produces larger bodies than Zstd and zlib. UPLOAD message
+        /// bodies compressed with LZ4 are still accepted.
+        bool disable_lz4_compression = false;
+
+        /// The contents of pre-trained Zstandard dictionaries, as produced by
+        /// `zstd --train`, typically one per schema. Their IDs are listed in
+        /// the handshake response, and a client session that has a dictionary
+        /// with one of these IDs binds to it, after which the bodies of its
+        /// UPLOAD and DOWNLOAD messages are compressed with Zstd and the
+        /// dictionary.
+        ///
+        /// The server constructor throws if one of them is not a Zstandard
+        /// dictionary, if two of them have the same ID, or if the library was
+        /// built without Zstandard.
+        std::vector<std::string> zstd_dictionaries;
+
         /// If set to true, the server will cache the contents of the DOWNLOAD
-        /// message(s) used for client bootstrapping.
+        /// message(s) used for client bootstrapping. Like any other DOWNLOAD
+        /// messages, they are limited by `max_download_size`, and each of them
+        /// is cached when it is first sent. The cache of a Realm file is shared
+        /// by all the clients bootstrapping from it, even when they started at
+        /// different server versions.
+        ///
+        /// Cache hits and misses are reported through the `download.cache.hit`
+        /// and `download.cache.miss` counters, and the accumulated size of
+        /// the cached bodies through the `download.cache.size` gauge.
         bool enable_download_bootstrap_cache = false;
 
+        /// The maximum accumulated size in bytes of the DOWNLOAD message
+        /// bodies cached for all Realm files together when
+        /// `enable_download_bootstrap_cache` is true. The least recently sent
+        /// ones are evicted first, whichever file they belong to.
+        std::size_t max_download_cache_size = 0x10000000; // 256 MiB
+
         /// The accumulated size of changesets that are included in download
         /// messages. The size of the changesets is calculated before log
         /// compaction (if enabled). A larger value leads to more efficient
@@ -416,7 +466,9 @@ public:
     void recognize_external_change(const std::string& virt_path);
 
     /// Get accumulated time spent on runs of the worker thread(s) since start
-    /// of the server.
+    /// of the server. Work units executed while several worker threads are
+    /// available (Config::num_worker_threads > 1) count as parallel time, all
+    /// others as sequential time.
     void get_workunit_timers(milliseconds_type& parallel_section, milliseconds_type& sequential_section);
 
 private:
@@ -106,8 +106,12 @@ int main(int argc, char* argv[])
         config_2.ssl_certificate_path = config.ssl_certificate_path;
         config_2.ssl_certificate_key_path = config.ssl_certificate_key_path;
         config_2.disable_download_compaction = config.disable_download_compaction;
+        config_2.disable_zstd_compression = config.disable_zstd_compression;
+        config_2.disable_lz4_compression = config.disable_lz4_compression;
+        config_2.zstd_dictionaries = config.zstd_dictionaries;
         config_2.enable_download_bootstrap_cache = config.enable_download_bootstrap_cache;
         config_2.max_download_size = config.max_download_size;
+        config_2.max_download_cache_size = config.max_download_cache_size;
         config_2.listen_backlog = config.listen_backlog;
         config_2.tcp_no_delay = config.tcp_no_delay;
         config_2.log_lsof_period = config.log_lsof_period;
@@ -63,11 +63,15 @@ void parse_arguments(int argc, char* argv[], Configuration& configuration)
         {"disable-history-compaction",           no_argument,       nullptr, 'O'},
         {"disable-download-compaction",          no_argument,       nullptr, 'Q'},
         {"max-download-size",                    required_argument, nullptr, 'F'},
+        {"disable-zstd-compression",             no_argument,       nullptr, 'Z'},
+        {"disable-lz4-compression",              no_argument,       nullptr, 'z'},
+        {"zstd-dictionary",                      required_argument, nullptr, 'X'},
+        {"max-download-cache-size",              required_argument, nullptr, 'W'},
         {nullptr,                                0,                 nullptr, 0}
         // clang-format on
     };
 
-    static const char* opt_desc = "r:L:p:J:M:i:d:N:l:YPk:m:hnsC:K:b:DSu:t:f:H:I:qe:jRGEa:g:U:BA12:v:x:o:cOQF:";
+    static const char* opt_desc = "r:L:p:J:M:i:d:N:l:YPk:m:hnsC:K:b:DSu:t:f:H:I:qe:jRGEa:g:U:BA12:v:x:o:cOQF:ZzX:W:";
 
     int opt_index = 0;
     int opt;
@@ -331,6 +335,25 @@ void parse_arguments(int argc, char* argv[], Configuration& configuration)
             case 'Q':
                 configuration.disable_download_compaction = true;
                 break;
+            case 'Z':
+                configuration.disable_zstd_compression = true;
+                break;
+            case 'z':
+                configuration.disable_lz4_compression = true;
+                break;
+            case 'X': {
+                std::string zstd_dictionary_path = std::string(optarg);
+                try {
+                    util::File file{zstd_dictionary_path};
+                    std::string content(to_size_t(file.get_size()), '\0');
+                    file.read(&content[0], content.size());
+                    configuration.zstd_dictionaries.push_back(std::move(content));
+                }
+                catch (util::File::AccessError& e) {
+                    std::cerr << "The Zstandard dictionary file could not be read: " << e.what() << "\n";
+                    std::exit(EXIT_FAILURE);
+                }
+            } break;
             case 'F': {
                 std::istringstream in(optarg);
                 in.unsetf(std::ios_base::skipws);
@@ -345,6 +368,20 @@ void parse_arguments(int argc, char* argv[], Configuration& configuration)
                     std::exit(EXIT_FAILURE);
                 }
             } break;
+            case 'W': {
+                std::istringstream in(optarg);
+                in.unsetf(std::ios_base::skipws);
+                std::size_t v = 0;
+                in >> v;
+                if (in && in.eof()) {
+                    configuration.max_download_cache_size = v;
+                }
+                else {
+                    std::cerr << "Error: Invalid size `" << optarg << "'.\n\n";
+                    show_help(argv[0]);
+                    std::exit(EXIT_FAILURE);
+                }
+            } break;
             default:
                 std::cerr << '\n';
                 show_help(argv[0]);
@@ -719,6 +756,13 @@ void show_help(const std::string& program_name)
         "  -Q, --disable-download-compaction\n"
         "                                 Disable compaction during download.\n"
         "  -F, --max-download-size        See `sync::Server::Config::max_download_size`.\n"
+        "  -Z, --disable-zstd-compression\n"
+        "                                 Never compress DOWNLOAD messages with Zstd.\n"
+        "  -z, --disable-lz4-compression  Never compress DOWNLOAD messages with LZ4.\n"
+        "  -X, --zstd-dictionary PATH     Offer the pre-trained Zstandard dictionary in the\n"
+        "                                 specified file (`zstd --train`) to clients. May be\n"
+        "                                 specified multiple times.\n"
+        "  -W, --max-download-cache-size  See `sync::Server::Config::max_download_cache_size`.\n"
         "\n";
     // clang-format on
 }
@@ -43,8 +43,12 @@ struct Configuration {
     std::chrono::seconds history_compaction_interval = std::chrono::seconds{3600};
     bool history_compaction_ignore_clients = false;
     bool disable_download_compaction = false;
+    bool disable_zstd_compression = false;
+    bool disable_lz4_compression = false;
+    std::vector<std::string> zstd_dictionaries; // Contents of the files
     bool enable_download_bootstrap_cache = false;
     std::size_t max_download_size = 0x1000000; // 16 MB
+    std::size_t max_download_cache_size = 0x10000000; // 256 MB
     int listen_backlog = util::network::Acceptor::max_connections;
     bool tcp_no_delay = false;
     bool is_subtier_server = false;
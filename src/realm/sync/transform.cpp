@@ -3,6 +3,7 @@
 #include <utility>
 #include <vector>
 #include <map>
+#include <numeric>
 #include <sstream>
 #include <fstream>
 
@@ -30,6 +31,7 @@
 #include <realm/util/metered/vector.hpp>
 #include <realm/util/metered/map.hpp>
 #include <realm/util/logger.hpp>
+#include <realm/util/worker_pool.hpp>
 
 namespace realm {
 
@@ -61,6 +63,44 @@ namespace {
 
 const util::AllocationMetricName g_transform_metric_scope{"transform"};
 
+// Changesets of a smaller accumulated size are parsed on the calling thread.
+constexpr std::size_t s_min_parallel_parse_size = 0x10000; // 64 KiB
+
+// Calls `parse(i)` for every i in [0, sizes.size()), where `sizes[i]` is the
+// size of the i'th changeset. Large inputs are divided into contiguous ranges of
+// roughly equal accumulated size, which are handled by the calling thread and
+// the threads of the shared worker pool. The exception of the earliest range
+// is rethrown on the calling thread.
+template <class F>
+void parse_in_parallel(const std::vector<std::size_t>& sizes, unsigned max_threads, F parse)
+{
+    std::size_t total_size = std::accumulate(sizes.begin(), sizes.end(), std::size_t(0));
+    if (max_threads == 0)
+        max_threads = unsigned(util::WorkerPool::get_default().num_threads() + 1);
+    std::size_t num_ranges =
+        std::min({std::size_t(max_threads), sizes.size(), total_size / s_min_parallel_parse_size});
+    if (num_ranges <= 1) {
+        for (std::size_t i = 0; i < sizes.size(); ++i)
+            parse(i);
+        return;
+    }
+
+    std::vector<std::size_t> range_begin = {0};
+    std::size_t accum_size = 0;
+    for (std::size_t i = 0; i < sizes.size() && range_begin.size() < num_ranges; ++i) {
+        accum_size += sizes[i];
+        if (accum_size >= range_begin.size() * (total_size / num_ranges))
+            range_begin.push_back(i + 1);
+    }
+    range_begin.push_back(sizes.size());
+    num_ranges = range_begin.size() - 1;
+
+    util::run_in_parallel(num_ranges, [&](std::size_t range) {
+        for (std::size_t i = range_begin[range]; i < range_begin[range + 1]; ++i)
+            parse(i);
+    });
+}
+
 } // unnamed namespace
 
 using namespace realm;
@@ -330,6 +370,12 @@ struct TransformerImpl::MinorSide : TransformerImpl::Side {
     _impl::ChangesetIndex::RangeIterator m_position;
     _impl::ChangesetIndex* m_changeset_index = nullptr;
     _impl::ChangesetIndex::Ranges* m_conflict_ranges = nullptr;
+
+    // When set, only the instructions found through the property index of the
+    // conflict group need to be visited (see set_property_positions()).
+    bool m_use_property_index = false;
+    const _impl::ChangesetIndex::Positions* m_path_positions = nullptr;
+    const _impl::ChangesetIndex::Positions* m_object_positions = nullptr;
 };
 
 #if defined(REALM_DEBUG) // LCOV_EXCL_START Debug utilities
@@ -700,9 +746,42 @@ struct TransformerImpl::Transformer {
     {
         const auto& major_instr = m_major_side.get();
         m_minor_side.m_conflict_ranges = get_conflict_ranges_for_instruction(major_instr);
+        set_property_positions(major_instr);
         /* m_minor_side.m_changeset_index->verify(); */
     }
 
+    // An instruction modifying a property of an object can only conflict with
+    // the instructions modifying the same property of the same object, and
+    // with the creation or erasure of the object. The creation or erasure of
+    // an object can only conflict with the instructions on the same object
+    // (see the merge rules below). So only those need to be visited out of
+    // the whole conflict group.
+    void set_property_positions(const Instruction& instr)
+    {
+        m_minor_side.m_use_property_index = false;
+        auto object_instr = instr.get_if<Instruction::ObjectInstruction>();
+        if (!object_instr)
+            return;
+
+        _impl::ChangesetIndex::GlobalID id{m_major_side.get_string(object_instr->table),
+                                           m_major_side.m_changeset->get_key(object_instr->object)};
+        const _impl::ChangesetIndex& index = *m_minor_side.m_changeset_index;
+        auto property_index = index.get_property_index_for_object(id);
+        if (!property_index)
+            return;
+
+        size_t object_hash = index.hash_object(id);
+        if (auto path_instr = instr.get_if<Instruction::PathInstruction>()) {
+            StringData field = m_major_side.get_string(path_instr->field);
+            m_minor_side.m_path_positions = property_index->find_property(index.hash_property(id, field));
+        }
+        else {
+            m_minor_side.m_path_positions = property_index->find_paths(object_hash);
+        }
+        m_minor_side.m_object_positions = property_index->find_object(object_hash);
+        m_minor_side.m_use_property_index = true;
+    }
+
     void set_next_major_changeset(Changeset* changeset) noexcept
     {
         m_major_side.m_changeset = changeset;
@@ -770,6 +849,12 @@ struct TransformerImpl::Transformer {
     {
         auto orig_major_was_discarded = m_major_side.was_discarded;
 
+        // The prepended instructions are merged with all the remaining
+        // instructions in the conflict ranges, regardless of the property
+        // modified by the instruction that instigated the prepend.
+        auto orig_use_property_index = m_minor_side.m_use_property_index;
+        m_minor_side.m_use_property_index = false;
+
         // Reset 'was_discarded', as it should refer to the prepended
         // instructions in the below, not the instruction that instigated the
         // prepend.
@@ -818,33 +903,23 @@ struct TransformerImpl::Transformer {
 #endif // REALM_DEBUG LCOV_EXCL_STOP
 
         m_major_side.was_discarded = orig_major_was_discarded;
+        m_minor_side.m_use_property_index = orig_use_property_index;
     }
 
     void transform_major()
     {
+        if (m_minor_side.m_use_property_index) {
+            transform_major_through_property_index();
+            return;
+        }
+
         m_minor_side.skip_tombstones();
 
-#if defined(REALM_DEBUG) // LCOV_EXCL_START Debug tracing
-        const bool print_noop_merges = false;
         bool new_major = true; // print an instruction every time we go to the next major regardless
-#endif                         // LCOV_EXCL_STOP REALM_DEBUG
 
         while (m_minor_side.m_position != m_minor_end) {
             m_minor_side.init_with_instruction(m_minor_side.m_position);
-
-#if defined(REALM_DEBUG) // LCOV_EXCL_START Debug tracing
-            if (m_trace) {
-                MergeTracer tracer{m_minor_side, m_major_side};
-                merge_instructions(m_major_side, m_minor_side);
-                tracer.print_diff(std::cerr, new_major || print_noop_merges);
-                new_major = false;
-            }
-            else {
-#endif // LCOV_EXCL_STOP REALM_DEBUG
-                merge_instructions(m_major_side, m_minor_side);
-#if defined(REALM_DEBUG) // LCOV_EXCL_START
-            }
-#endif // LCOV_EXCL_STOP REALM_DEBUG
+            merge_current_instructions(new_major);
 
             if (m_major_side.was_discarded)
                 break;
@@ -855,6 +930,76 @@ struct TransformerImpl::Transformer {
         }
     }
 
+    // Same as transform_major(), but only visits the instructions found by
+    // set_property_positions(), in the order they appear in the conflict
+    // ranges. Must start at the beginning of the conflict ranges.
+    void transform_major_through_property_index()
+    {
+        using Positions = _impl::ChangesetIndex::Positions;
+        using PositionVector = Positions::mapped_type;
+
+        bool new_major = true; // print an instruction every time we go to the next major regardless
+
+        // Returns false if the major instruction was discarded.
+        auto visit = [&](Changeset* changeset, const PositionVector& a, const PositionVector& b) {
+            auto i = a.begin();
+            auto j = b.begin();
+            while (i != a.end() || j != b.end()) {
+                Changeset::iterator pos = (j == b.end() || (i != a.end() && *i < *j)) ? *i++ : *j++;
+                if (!*pos)
+                    continue; // Discarded
+                m_minor_side.init_with_instruction(
+                    MinorSide::Position{m_minor_side.m_conflict_ranges, changeset, pos});
+                merge_current_instructions(new_major);
+                if (m_major_side.was_discarded)
+                    return false;
+            }
+            return true;
+        };
+
+        Positions no_positions;
+        PositionVector none;
+        const Positions& path = m_minor_side.m_path_positions ? *m_minor_side.m_path_positions : no_positions;
+        const Positions& object = m_minor_side.m_object_positions ? *m_minor_side.m_object_positions : no_positions;
+        Positions::key_compare less;
+        auto i = path.begin();
+        auto j = object.begin();
+        while (i != path.end() || j != object.end()) {
+            if (j == object.end() || (i != path.end() && less(i->first, j->first))) {
+                if (!visit(i->first, i->second, none))
+                    return;
+                ++i;
+            }
+            else if (i == path.end() || less(j->first, i->first)) {
+                if (!visit(j->first, none, j->second))
+                    return;
+                ++j;
+            }
+            else {
+                if (!visit(i->first, i->second, j->second))
+                    return;
+                ++i;
+                ++j;
+            }
+        }
+    }
+
+    void merge_current_instructions(bool& new_major)
+    {
+#if defined(REALM_DEBUG) // LCOV_EXCL_START Debug tracing
+        const bool print_noop_merges = false;
+        if (m_trace) {
+            MergeTracer tracer{m_minor_side, m_major_side};
+            merge_instructions(m_major_side, m_minor_side);
+            tracer.print_diff(std::cerr, new_major || print_noop_merges);
+            new_major = false;
+            return;
+        }
+#endif // LCOV_EXCL_STOP REALM_DEBUG
+        static_cast<void>(new_major);
+        merge_instructions(m_major_side, m_minor_side);
+    }
+
     void merge_instructions(MajorSide& left, MinorSide& right);
     template <class OuterSide, class InnerSide>
     void merge_nested(OuterSide& outer, InnerSide& inner);
@@ -2380,8 +2525,9 @@ void TransformerImpl::Transformer::merge_nested(OuterSide& outer_side, InnerSide
 }
 
 
-TransformerImpl::TransformerImpl()
+TransformerImpl::TransformerImpl(unsigned max_threads)
     : m_changeset_parser() // Throws
+    , m_max_threads{max_threads}
 {
 }
 
@@ -2544,6 +2690,16 @@ void TransformerImpl::transform_remote_changesets(TransformHistory& history, fil
     metered::vector<Changeset*> our_changesets;
 
     try {
+        if (m_max_threads != 1 && num_changesets != 0) {
+            auto first_base = std::min_element(parsed_changesets, parsed_changesets + num_changesets,
+                                               [](const Changeset& a, const Changeset& b) {
+                                                   return a.last_integrated_remote_version <
+                                                          b.last_integrated_remote_version;
+                                               });
+            prefetch_reciprocal_transforms(history, local_file_ident, first_base->last_integrated_remote_version,
+                                           current_local_version); // Throws
+        }
+
         // p points to the beginning of a range of changesets that share the same
         // "base", i.e. are based on the same local version.
         auto p = parsed_changesets;
@@ -2577,6 +2733,15 @@ void TransformerImpl::transform_remote_changesets(TransformHistory& history, fil
 
             p = same_base_range_end;
             our_changesets.clear(); // deliberately not releasing memory
+
+            // The remaining incoming changesets are merged with the local
+            // changesets that follow the local version they are based on, so
+            // the reciprocal transforms of the preceding ones are final. They
+            // are written back as soon as they are, instead of holding every
+            // reciprocal transform in the cache until all incoming changesets
+            // have been merged.
+            if (p != parsed_changesets_end)
+                flush_reciprocal_transform_cache(history, p->last_integrated_remote_version); // Throws
         }
     }
     catch (...) {
@@ -2597,6 +2762,22 @@ void TransformerImpl::transform_remote_changesets(TransformHistory& history, fil
 }
 
 
+namespace {
+
+void set_reciprocal_transform_origin(Changeset& changeset, version_type version, const HistoryEntry& history_entry,
+                                     file_ident_type local_file_ident) noexcept
+{
+    changeset.version = version;
+    changeset.last_integrated_remote_version = history_entry.remote_version;
+    changeset.origin_timestamp = history_entry.origin_timestamp;
+    file_ident_type origin_file_ident = history_entry.origin_file_ident;
+    if (origin_file_ident == 0)
+        origin_file_ident = local_file_ident;
+    changeset.origin_file_ident = origin_file_ident;
+}
+
+} // unnamed namespace
+
 Changeset& TransformerImpl::get_reciprocal_transform(TransformHistory& history, file_ident_type local_file_ident,
                                                      version_type version, const HistoryEntry& history_entry)
 {
@@ -2608,32 +2789,71 @@ Changeset& TransformerImpl::get_reciprocal_transform(TransformHistory& history,
         ChunkedBinaryInputStream in{data};
         Changeset& changeset = *i->second;
         sync::parse_changeset(in, changeset); // Throws
-
-        changeset.version = version;
-        changeset.last_integrated_remote_version = history_entry.remote_version;
-        changeset.origin_timestamp = history_entry.origin_timestamp;
-        file_ident_type origin_file_ident = history_entry.origin_file_ident;
-        if (origin_file_ident == 0)
-            origin_file_ident = local_file_ident;
-        changeset.origin_file_ident = origin_file_ident;
+        set_reciprocal_transform_origin(changeset, version, history_entry, local_file_ident);
     }
     return *i->second;
 }
 
 
-void TransformerImpl::flush_reciprocal_transform_cache(TransformHistory& history)
+// Parses the reciprocal transforms of all the local changesets following
+// `begin_version`, that are not already cached, on up to `m_max_threads`
+// threads. The data is read from the history on the calling thread.
+void TransformerImpl::prefetch_reciprocal_transforms(TransformHistory& history, file_ident_type local_file_ident,
+                                                     version_type begin_version, version_type end_version)
+{
+    struct Entry {
+        version_type version;
+        HistoryEntry history_entry;
+        std::unique_ptr<char[]> data;
+        std::unique_ptr<Changeset> changeset;
+    };
+    std::vector<Entry> entries;
+    std::vector<std::size_t> sizes;
+    for (;;) {
+        Entry entry;
+        entry.version = history.find_history_entry(begin_version, end_version, entry.history_entry);
+        if (entry.version == 0)
+            break; // No more local changesets
+        begin_version = entry.version;
+        if (m_reciprocal_transform_cache.count(entry.version) != 0)
+            continue;
+        ChunkedBinaryData data = history.get_reciprocal_transform(entry.version);
+        sizes.push_back(data.copy_to(entry.data)); // Throws
+        entry.changeset = std::make_unique<Changeset>(); // Throws
+        entries.push_back(std::move(entry)); // Throws
+    }
+
+    parse_in_parallel(sizes, m_max_threads, [&](std::size_t i) {
+        ChunkedBinaryData data{BinaryData{entries[i].data.get(), sizes[i]}};
+        ChunkedBinaryInputStream in{data};
+        sync::parse_changeset(in, *entries[i].changeset); // Throws
+    });
+
+    for (Entry& entry : entries) {
+        set_reciprocal_transform_origin(*entry.changeset, entry.version, entry.history_entry, local_file_ident);
+        m_reciprocal_transform_cache.emplace(entry.version, std::move(entry.changeset)); // Throws
+    }
+}
+
+
+// Writes back the modified reciprocal transforms of the local changesets up to
+// and including `end_version`, and removes them from the cache. If reading
+// them again is needed, they are read from the history.
+void TransformerImpl::flush_reciprocal_transform_cache(TransformHistory& history, version_type end_version)
 {
     try {
-        util::Buffer<char> output_buffer;
-        for (const auto& entry : m_reciprocal_transform_cache) {
-            if (entry.second->is_dirty()) {
-                std::size_t size = emit_changesets(&*entry.second, 1, output_buffer); // Throws
-                version_type version = entry.first;
-                BinaryData data{output_buffer.data(), size};
+        auto end = m_reciprocal_transform_cache.upper_bound(end_version);
+        for (auto i = m_reciprocal_transform_cache.begin(); i != end; ++i) {
+            if (i->second->is_dirty()) {
+                m_reciprocal_transform_encoder.reset();
+                m_reciprocal_transform_encoder.encode_single(*i->second); // Throws
+                const auto& buffer = m_reciprocal_transform_encoder.buffer();
+                version_type version = i->first;
+                BinaryData data{buffer.data(), buffer.size()};
                 history.set_reciprocal_transform(version, data); // Throws
             }
         }
-        m_reciprocal_transform_cache.clear();
+        m_reciprocal_transform_cache.erase(m_reciprocal_transform_cache.begin(), end);
     }
     catch (...) {
         m_reciprocal_transform_cache.clear();
@@ -2641,26 +2861,12 @@ void TransformerImpl::flush_reciprocal_transform_cache(TransformHistory& history
     }
 }
 
-
-size_t TransformerImpl::emit_changesets(const Changeset* changesets, size_t num_changesets,
-                                        util::Buffer<char>& out_buffer)
-{
-    // FIXME: Consider taking an output stream argument rather than an output buffer.
-    AppendBuffer<char> buffer;
-    for (size_t i = 0; i < num_changesets; ++i) {
-        encode_changeset(changesets[i], buffer);
-    }
-    size_t r = buffer.size();
-    out_buffer = buffer.release();
-    return r;
-}
-
 } // namespace _impl
 
 namespace sync {
-std::unique_ptr<Transformer> make_transformer()
+std::unique_ptr<Transformer> make_transformer(unsigned max_threads)
 {
-    return std::make_unique<_impl::TransformerImpl>(); // Throws
+    return std::make_unique<_impl::TransformerImpl>(max_threads); // Throws
 }
 
 
@@ -2684,5 +2890,16 @@ void parse_remote_changeset(const Transformer::RemoteChangeset& remote_changeset
     parsed_changeset.origin_file_ident = remote_changeset.origin_file_ident;
 }
 
+void parse_remote_changesets(const Transformer::RemoteChangeset* remote_changesets, std::size_t num_changesets,
+                             Changeset* parsed_changesets, unsigned max_threads)
+{
+    std::vector<std::size_t> sizes(num_changesets);
+    for (std::size_t i = 0; i < num_changesets; ++i)
+        sizes[i] = remote_changesets[i].data.size();
+    parse_in_parallel(sizes, max_threads, [&](std::size_t i) {
+        parse_remote_changeset(remote_changesets[i], parsed_changesets[i]); // Throws
+    });
+}
+
 } // namespace sync
 } // namespace realm
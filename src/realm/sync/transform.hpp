@@ -3,6 +3,7 @@
 #define REALM_SYNC_TRANSFORM_HPP
 
 #include <stddef.h>
+#include <limits>
 
 #include <realm/util/buffer.hpp>
 #include <realm/impl/cont_transact_hist.hpp>
@@ -10,6 +11,7 @@
 #include <realm/db.hpp>
 #include <realm/impl/transact_log.hpp>
 #include <realm/chunked_binary.hpp>
+#include <realm/sync/changeset_encoder.hpp>
 #include <realm/sync/instructions.hpp>
 #include <realm/sync/protocol.hpp>
 
@@ -178,7 +180,12 @@ public:
     virtual ~Transformer() noexcept {}
 };
 
-std::unique_ptr<Transformer> make_transformer();
+/// \param max_threads The maximum number of threads, including the calling
+/// thread and threads of the shared util::WorkerPool, used to parse the local
+/// changesets (their reciprocal transforms) that incoming changesets are
+/// transformed against, before the sequential merge begins. Zero means as many
+/// as there are hardware threads.
+std::unique_ptr<Transformer> make_transformer(unsigned max_threads = 1);
 
 } // namespace sync
 
@@ -194,7 +201,7 @@ public:
     using TransformHistory = sync::TransformHistory;
     using version_type = sync::version_type;
 
-    TransformerImpl();
+    TransformerImpl(unsigned max_threads = 1);
 
     void transform_remote_changesets(TransformHistory&, file_ident_type, version_type, Changeset*, std::size_t,
                                      Reporter*, util::Logger*) override;
@@ -214,13 +221,19 @@ protected:
 private:
     util::metered::map<version_type, std::unique_ptr<Changeset>> m_reciprocal_transform_cache;
 
+    // Reused for every reciprocal transform written back to the history.
+    sync::ChangesetEncoder m_reciprocal_transform_encoder;
+
     TransactLogParser m_changeset_parser;
 
+    const unsigned m_max_threads;
+
     Changeset& get_reciprocal_transform(TransformHistory&, file_ident_type local_file_ident, version_type version,
                                         const HistoryEntry&);
-    void flush_reciprocal_transform_cache(TransformHistory&);
-
-    static size_t emit_changesets(const Changeset*, size_t num_changesets, util::Buffer<char>& output_buffer);
+    void prefetch_reciprocal_transforms(TransformHistory&, file_ident_type local_file_ident,
+                                        version_type begin_version, version_type end_version);
+    void flush_reciprocal_transform_cache(TransformHistory&,
+                                          version_type end_version = std::numeric_limits<version_type>::max());
 
     struct Discriminant;
     struct Transformer;
@@ -288,6 +301,16 @@ public:
 
 void parse_remote_changeset(const Transformer::RemoteChangeset&, Changeset&);
 
+/// Same as calling parse_remote_changeset() for each of the specified
+/// changesets. When their accumulated size is large enough, they are divided
+/// into contiguous ranges of roughly equal size, which are parsed by the
+/// calling thread and threads of the shared util::WorkerPool, on up to
+/// `max_threads` threads in total (as many as there are hardware threads if
+/// zero). The exception thrown for the earliest changeset, if any, is rethrown
+/// on the calling thread.
+void parse_remote_changesets(const Transformer::RemoteChangeset*, std::size_t num_changesets, Changeset*,
+                             unsigned max_threads);
+
 
 // Implementation
 
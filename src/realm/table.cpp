@@ -29,6 +29,10 @@
 #include <realm/exceptions.hpp>
 #include <realm/table.hpp>
 #include <realm/alloc_slab.hpp>
+#include <realm/index_collection.hpp>
+#include <realm/index_composite.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/index_range.hpp>
 #include <realm/index_string.hpp>
 #include <realm/db.hpp>
 #include <realm/replication.hpp>
@@ -543,6 +547,8 @@ void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bo
     REALM_ASSERT(!(is_writable && is_frzn));
     m_is_frozen = is_frzn;
     m_alloc.set_read_only(!is_writable);
+    m_zone_maps.clear();
+    m_statistics.clear();
     // Load from allocated memory
     m_top.set_parent(parent, ndx_in_parent);
     m_top.init_from_ref(top_ref);
@@ -623,6 +629,7 @@ void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bo
     else {
         m_tombstones = nullptr;
     }
+    refresh_composite_index_accessors();
     m_cookie = cookie_initialized;
 }
 
@@ -651,65 +658,20 @@ ColKey Table::do_insert_column(ColKey col_key, DataType type, StringData name, T
 
 void Table::populate_search_index(ColKey col_key)
 {
-    auto col_ndx = col_key.get_index().val;
-    StringIndex* index = m_index_accessors[col_ndx];
+    SearchIndex* index = m_index_accessors[col_key.get_index().val];
+    if (col_key.is_collection()) {
+        for (auto o : *this) {
+            auto collection = o.get_collection_ptr(col_key);
+            size_t sz = collection->size();
+            for (size_t i = 0; i < sz; ++i)
+                index->insert(o.get_key(), collection->get_any(i)); // Throws
+        }
+        return;
+    }
 
     // Insert ref to index
     for (auto o : *this) {
-        ObjKey key = o.get_key();
-        DataType type = get_column_type(col_key);
-
-        if (type == type_Int) {
-            if (is_nullable(col_key)) {
-                Optional<int64_t> value = o.get<Optional<int64_t>>(col_key);
-                index->insert(key, value); // Throws
-            }
-            else {
-                int64_t value = o.get<int64_t>(col_key);
-                index->insert(key, value); // Throws
-            }
-        }
-        else if (type == type_Bool) {
-            if (is_nullable(col_key)) {
-                Optional<bool> value = o.get<Optional<bool>>(col_key);
-                index->insert(key, value); // Throws
-            }
-            else {
-                bool value = o.get<bool>(col_key);
-                index->insert(key, value); // Throws
-            }
-        }
-        else if (type == type_String) {
-            StringData value = o.get<StringData>(col_key);
-            index->insert(key, value); // Throws
-        }
-        else if (type == type_Timestamp) {
-            Timestamp value = o.get<Timestamp>(col_key);
-            index->insert(key, value); // Throws
-        }
-        else if (type == type_ObjectId) {
-            if (is_nullable(col_key)) {
-                Optional<ObjectId> value = o.get<Optional<ObjectId>>(col_key);
-                index->insert(key, value); // Throws
-            }
-            else {
-                ObjectId value = o.get<ObjectId>(col_key);
-                index->insert(key, value); // Throws
-            }
-        }
-        else if (type == type_UUID) {
-            if (is_nullable(col_key)) {
-                Optional<UUID> value = o.get<Optional<UUID>>(col_key);
-                index->insert(key, value); // Throws
-            }
-            else {
-                UUID value = o.get<UUID>(col_key);
-                index->insert(key, value); // Throws
-            }
-        }
-        else {
-            REALM_ASSERT_RELEASE(false && "Data type does not support search index");
-        }
+        index->insert(o.get_key(), o.get_any(col_key)); // Throws
     }
 }
 
@@ -722,6 +684,9 @@ void Table::erase_from_search_indexes(ObjKey key)
                 index->erase(key);
             }
         }
+        for (auto index : m_composite_index_accessors) {
+            index->erase(key);
+        }
     }
 }
 
@@ -744,68 +709,44 @@ void Table::update_indexes(ObjKey key, const FieldValues& values)
             ++value;
         }
 
-        if (auto index = m_index_accessors[column_ndx]) {
-            // There is an index for this column
-            auto col_key = m_leaf_ndx2colkey[column_ndx];
-            auto type = col_key.get_type();
-            auto attr = col_key.get_attrs();
-            bool nullable = attr.test(col_attr_Nullable);
-            switch (type) {
+        auto index = m_index_accessors[column_ndx];
+        auto col_key = m_leaf_ndx2colkey[column_ndx];
+        // The collections of a new object are empty
+        if (!index || col_key.is_collection())
+            continue;
+
+        if (init_value.is_null() && !col_key.get_attrs().test(col_attr_Nullable)) {
+            // The default value of the column
+            switch (col_key.get_type()) {
                 case col_type_Int:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayIntNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<int64_t>());
-                    }
+                    init_value = ArrayInteger::default_value(false);
                     break;
                 case col_type_Bool:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayBoolNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<bool>());
-                    }
+                    init_value = false;
                     break;
                 case col_type_String:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayString::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<String>());
-                    }
+                    init_value = ArrayString::default_value(false);
                     break;
                 case col_type_Timestamp:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayTimestamp::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<Timestamp>());
-                    }
+                    init_value = ArrayTimestamp::default_value(false);
                     break;
                 case col_type_ObjectId:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayObjectIdNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<ObjectId>());
-                    }
-                    break;
-                case col_type_Mixed:
-                    index->insert(key, init_value);
+                    init_value = ArrayObjectIdNull::default_value(false);
                     break;
                 case col_type_UUID:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayUUIDNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<UUID>());
-                    }
+                    init_value = ArrayUUIDNull::default_value(false);
+                    break;
+                case col_type_Mixed:
                     break;
                 default:
                     REALM_UNREACHABLE();
             }
         }
+        index->insert(key, init_value); // Throws
+    }
+    // Composite indexes read the values from the object
+    for (auto index : m_composite_index_accessors) {
+        index->insert(key);
     }
 }
 
@@ -816,57 +757,102 @@ void Table::clear_indexes()
             index->clear();
         }
     }
+    for (auto index : m_composite_index_accessors) {
+        index->clear();
+    }
+}
+
+void Table::set_in_composite_indexes(ObjKey key, ColKey col_key, Mixed value)
+{
+    for (auto index : m_composite_index_accessors) {
+        if (index->has_column(col_key)) {
+            index->set(key, col_key, value);
+        }
+    }
 }
 
-void Table::add_search_index(ColKey col_key)
+void Table::add_search_index(ColKey col_key, IndexType type)
 {
     check_column(col_key);
     size_t column_ndx = col_key.get_index().val;
 
+    if (type == IndexType::None) {
+        remove_search_index(col_key);
+        return;
+    }
+
     // Early-out if already indexed
-    if (m_index_accessors[column_ndx] != nullptr)
+    IndexType current_type = search_index_type(col_key);
+    if (current_type == type)
         return;
 
-    if (!StringIndex::type_supported(DataType(col_key.get_type())) || col_key.is_collection()) {
+    bool supported;
+    if (type == IndexType::Fulltext)
+        supported = FullTextIndex::type_supported(col_key);
+    else if (type == IndexType::CaseInsensitive)
+        supported = col_key.get_type() == col_type_String && !col_key.is_collection();
+    else if (col_key.is_collection())
+        supported = (type == IndexType::General) && CollectionIndex::type_supported(col_key);
+    else
+        supported = (type == IndexType::Ordered) ? RangeIndex::type_supported(DataType(col_key.get_type()))
+                                                 : StringIndex::type_supported(DataType(col_key.get_type()));
+    if (!supported) {
         // FIXME: This is what we used to throw, so keep throwing that for compatibility reasons, even though it
         // should probably be a type mismatch exception instead.
         throw LogicError(LogicError::illegal_combination);
     }
+    if (type != IndexType::General || col_key.is_collection())
+        check_file_format_for_index();
+
+    // An index of the other type is replaced
+    if (current_type != IndexType::None)
+        remove_search_index(col_key);
 
-    // m_index_accessors always has the same number of pointers as the number of columns. Columns without search
-    // index have 0-entries.
+    // The index accessor vector always has the same number of pointers as the number of columns. Columns without
+    // search index have 0-entries.
     REALM_ASSERT(m_index_accessors.size() == m_leaf_ndx2colkey.size());
     REALM_ASSERT(m_index_accessors[column_ndx] == nullptr);
 
-    // Create the index
-    StringIndex* index = new StringIndex(ClusterColumn(&m_clusters, col_key), get_alloc()); // Throws
+    // Create the index and insert ref to it
+    SearchIndex* index = create_index_accessor(col_key, type, 0); // Throws
     m_index_accessors[column_ndx] = index;
-
-    // Insert ref to index
-    index->set_parent(&m_index_refs, column_ndx);
     m_index_refs.set(column_ndx, index->get_ref()); // Throws
 
     // Update spec
     auto spec_ndx = leaf_ndx2spec_ndx(col_key.get_index());
     auto attr = m_spec.get_column_attr(spec_ndx);
     attr.set(col_attr_Indexed);
+    if (type == IndexType::Ordered)
+        attr.set(col_attr_OrderedIndex);
+    if (type == IndexType::Fulltext)
+        attr.set(col_attr_FullTextIndex);
+    if (type == IndexType::CaseInsensitive)
+        attr.set(col_attr_CaseInsensitiveIndex);
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 
     populate_search_index(col_key);
 }
 
+// The indexes introduced by file format 21 cannot be added to a file which is
+// kept at format 20 (see DBOptions::upgrade_to_file_format_21).
+void Table::check_file_format_for_index() const
+{
+    Group* group = get_parent_group();
+    if (group && group->get_file_format_version() == 20)
+        throw LogicError(LogicError::file_format_upgrade_required);
+}
+
 void Table::remove_search_index(ColKey col_key)
 {
     check_column(col_key);
     auto column_ndx = col_key.get_index();
 
-    // Early-out if non-indexed
-    if (m_index_accessors[column_ndx.val] == nullptr)
-        return;
-
     // Destroy and remove the index column
-    StringIndex* index = m_index_accessors[column_ndx.val];
-    REALM_ASSERT(index != nullptr);
+    SearchIndex* index = m_index_accessors[column_ndx.val];
+    if (!index) {
+        // Early-out if non-indexed
+        return;
+    }
     index->destroy();
     delete index;
     m_index_accessors[column_ndx.val] = nullptr;
@@ -877,9 +863,131 @@ void Table::remove_search_index(ColKey col_key)
     auto spec_ndx = leaf_ndx2spec_ndx(column_ndx);
     auto attr = m_spec.get_column_attr(spec_ndx);
     attr.reset(col_attr_Indexed);
+    attr.reset(col_attr_OrderedIndex);
+    attr.reset(col_attr_FullTextIndex);
+    attr.reset(col_attr_CaseInsensitiveIndex);
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 }
 
+void Table::add_composite_index(const std::vector<ColKey>& columns)
+{
+    if (columns.size() < CompositeIndex::min_columns || columns.size() > CompositeIndex::max_columns)
+        throw LogicError(LogicError::illegal_combination);
+    for (auto it = columns.begin(); it != columns.end(); ++it) {
+        check_column(*it);
+        if (!CompositeIndex::type_supported(*it) || std::find(columns.begin(), it, *it) != it)
+            throw LogicError(LogicError::illegal_combination);
+    }
+
+    // Early-out if already indexed
+    if (has_composite_index(columns))
+        return;
+    check_file_format_for_index();
+
+    if (m_top.size() <= top_position_for_composite_indexes || !m_top.get_as_ref(top_position_for_composite_indexes)) {
+        while (m_top.size() <= top_position_for_composite_indexes)
+            m_top.add(0); // Throws
+        MemRef mem = Array::create_empty_array(Array::type_HasRefs, false, m_alloc); // Throws
+        m_top.set_as_ref(top_position_for_composite_indexes, mem.get_ref());     // Throws
+        m_composite_index_refs.init_from_parent();
+    }
+
+    // Create the index and insert ref to it
+    std::unique_ptr<CompositeIndex> index(new CompositeIndex(*this, columns, get_alloc())); // Throws
+    size_t ndx = m_composite_index_refs.size();
+    m_composite_index_accessors.reserve(ndx + 1); // Throws
+    index->set_parent(&m_composite_index_refs, ndx);
+    m_composite_index_refs.add(from_ref(index->get_ref())); // Throws
+    m_composite_index_accessors.push_back(index.release());
+
+    for (auto& obj : *this) {
+        m_composite_index_accessors.back()->insert(obj.get_key()); // Throws
+    }
+}
+
+void Table::remove_composite_index(const std::vector<ColKey>& columns)
+{
+    for (size_t i = 0; i < m_composite_index_accessors.size(); ++i) {
+        CompositeIndex* index = m_composite_index_accessors[i];
+        if (index->get_column_keys() == columns) {
+            index->destroy();
+            delete index;
+            m_composite_index_accessors.erase(m_composite_index_accessors.begin() + i);
+            m_composite_index_refs.erase(i);
+            for (size_t j = i; j < m_composite_index_accessors.size(); ++j)
+                m_composite_index_accessors[j]->set_parent(&m_composite_index_refs, j);
+            return;
+        }
+    }
+}
+
+bool Table::has_composite_index(const std::vector<ColKey>& columns) const noexcept
+{
+    return get_composite_index(columns) != nullptr;
+}
+
+CompositeIndex* Table::get_composite_index(const std::vector<ColKey>& columns) const noexcept
+{
+    for (auto index : m_composite_index_accessors) {
+        if (index->get_column_keys() == columns)
+            return index;
+    }
+    return nullptr;
+}
+
+std::vector<std::vector<ColKey>> Table::get_composite_indexes() const
+{
+    std::vector<std::vector<ColKey>> indexes;
+    for (auto index : m_composite_index_accessors)
+        indexes.push_back(index->get_column_keys());
+    return indexes;
+}
+
+// Remove the composite indexes including the column
+void Table::remove_composite_indexes(ColKey col_key)
+{
+    for (size_t i = m_composite_index_accessors.size(); i > 0; --i) {
+        CompositeIndex* index = m_composite_index_accessors[i - 1];
+        if (index->has_column(col_key))
+            remove_composite_index(std::vector<ColKey>(index->get_column_keys()));
+    }
+}
+
+void Table::refresh_composite_index_accessors()
+{
+    // An index whose ref has not changed has not been modified, so its
+    // accessor is kept, also if the index has moved to another position.
+    std::vector<std::unique_ptr<CompositeIndex>> old_accessors;
+    old_accessors.reserve(m_composite_index_accessors.size()); // Throws
+    for (auto index : m_composite_index_accessors)
+        old_accessors.emplace_back(index);
+    m_composite_index_accessors.clear();
+
+    if (m_top.size() > top_position_for_composite_indexes && m_top.get_as_ref(top_position_for_composite_indexes)) {
+        m_composite_index_refs.init_from_parent();
+        size_t sz = m_composite_index_refs.size();
+        m_composite_index_accessors.reserve(sz); // Throws
+        for (size_t i = 0; i < sz; ++i) {
+            ref_type ref = m_composite_index_refs.get_as_ref(i);
+            auto old = std::find_if(old_accessors.begin(), old_accessors.end(), [&](auto& index) {
+                return index && index->get_ref() == ref;
+            });
+            std::unique_ptr<CompositeIndex> index;
+            if (old != old_accessors.end()) {
+                index = std::move(*old);
+                index->set_parent(&m_composite_index_refs, i);
+            }
+            else {
+                index.reset(new CompositeIndex(ref, &m_composite_index_refs, i, *this, get_alloc())); // Throws
+            }
+            m_composite_index_accessors.push_back(index.release());
+        }
+    }
+    else {
+        m_composite_index_refs.detach();
+    }
+}
+
 void Table::enumerate_string_column(ColKey col_key)
 {
     check_column(col_key);
@@ -979,6 +1087,7 @@ ColKey Table::do_insert_root_column(ColKey col_key, ColumnType type, StringData
 
 void Table::do_erase_root_column(ColKey col_key)
 {
+    remove_composite_indexes(col_key);
     size_t col_ndx = col_key.get_index().val;
     // If the column had a source index we have to remove and destroy that as well
     ref_type index_ref = m_index_refs.get_as_ref(col_ndx);
@@ -986,7 +1095,6 @@ void Table::do_erase_root_column(ColKey col_key)
         Array::destroy_deep(index_ref, m_index_refs.get_alloc());
         m_index_refs.set(col_ndx, 0);
         delete m_index_accessors[col_ndx];
-        m_index_accessors[col_ndx] = nullptr;
     }
     m_opposite_table.set(col_ndx, TableKey().value);
     m_opposite_column.set(col_ndx, ColKey().value);
@@ -1079,6 +1187,13 @@ void Table::fully_detach() noexcept
     m_opposite_table.detach();
     m_opposite_column.detach();
     m_index_accessors.clear();
+    for (auto index : m_composite_index_accessors) {
+        delete index;
+    }
+    m_composite_index_refs.detach();
+    m_composite_index_accessors.clear();
+    m_zone_maps.clear();
+    m_statistics.clear();
 }
 
 
@@ -1097,13 +1212,104 @@ Table::~Table() noexcept
         delete index;
     }
     m_index_accessors.clear();
+    for (auto& index : m_composite_index_accessors) {
+        delete index;
+    }
+    m_composite_index_accessors.clear();
     m_cookie = cookie_deleted;
 }
 
 
 bool Table::has_search_index(ColKey col_key) const noexcept
 {
-    return m_index_accessors[col_key.get_index().val] != nullptr;
+    return search_index_type(col_key) == IndexType::General;
+}
+
+bool Table::has_range_index(ColKey col_key) const noexcept
+{
+    return search_index_type(col_key) == IndexType::Ordered;
+}
+
+IndexType Table::search_index_type(ColKey col_key) const noexcept
+{
+    SearchIndex* index = m_index_accessors[col_key.get_index().val];
+    return index ? index->get_index_type() : IndexType::None;
+}
+
+StringIndex* Table::get_search_index(ColKey col) const noexcept
+{
+    report_invalid_key(col);
+    if (!has_search_index(col) || col.is_collection())
+        return nullptr;
+    return static_cast<StringIndex*>(m_index_accessors[col.get_index().val]);
+}
+
+RangeIndex* Table::get_range_index(ColKey col) const
+{
+    report_invalid_key(col);
+    if (!has_range_index(col))
+        return nullptr;
+    return static_cast<RangeIndex*>(m_index_accessors[col.get_index().val]);
+}
+
+CollectionIndex* Table::get_collection_index(ColKey col) const
+{
+    report_invalid_key(col);
+    if (!has_search_index(col) || !col.is_collection())
+        return nullptr;
+    return static_cast<CollectionIndex*>(m_index_accessors[col.get_index().val]);
+}
+
+FullTextIndex* Table::get_fulltext_index(ColKey col) const
+{
+    report_invalid_key(col);
+    if (search_index_type(col) != IndexType::Fulltext)
+        return nullptr;
+    return static_cast<FullTextIndex*>(m_index_accessors[col.get_index().val]);
+}
+
+StringIndex* Table::get_case_insensitive_index(ColKey col) const
+{
+    report_invalid_key(col);
+    if (search_index_type(col) != IndexType::CaseInsensitive)
+        return nullptr;
+    return static_cast<StringIndex*>(m_index_accessors[col.get_index().val]);
+}
+
+namespace {
+
+template <class T>
+SearchIndex* make_index_accessor(ref_type ref, Array& parent, size_t ndx_in_parent, const ClusterColumn& target_column,
+                                 Allocator& alloc)
+{
+    if (ref)
+        return new T(ref, &parent, ndx_in_parent, target_column, alloc); // Throws
+    T* index = new T(target_column, alloc); // Throws
+    index->set_parent(&parent, ndx_in_parent);
+    return index;
+}
+
+} // anonymous namespace
+
+SearchIndex* Table::create_index_accessor(ColKey col_key, IndexType type, ref_type ref)
+{
+    size_t col_ndx = col_key.get_index().val;
+    ClusterColumn virtual_col(&m_clusters, col_key, type == IndexType::CaseInsensitive);
+    switch (type) {
+        case IndexType::General:
+            if (col_key.is_collection())
+                return make_index_accessor<CollectionIndex>(ref, m_index_refs, col_ndx, virtual_col, get_alloc());
+            return make_index_accessor<StringIndex>(ref, m_index_refs, col_ndx, virtual_col, get_alloc());
+        case IndexType::Ordered:
+            return make_index_accessor<RangeIndex>(ref, m_index_refs, col_ndx, virtual_col, get_alloc());
+        case IndexType::Fulltext:
+            return make_index_accessor<FullTextIndex>(ref, m_index_refs, col_ndx, virtual_col, get_alloc());
+        case IndexType::CaseInsensitive:
+            return make_index_accessor<StringIndex>(ref, m_index_refs, col_ndx, virtual_col, get_alloc());
+        case IndexType::None:
+            break;
+    }
+    REALM_UNREACHABLE();
 }
 
 void Table::migrate_column_info()
@@ -1184,10 +1390,9 @@ void Table::migrate_indexes(ColKey pk_col_key)
                 // Primary key columns does not need an index
                 if (m_leaf_ndx2colkey[col_ndx] != pk_col_key) {
                     // Otherwise create new index. Will be updated when objects are created
-                    StringIndex* index =
-                        new StringIndex(ClusterColumn(&m_clusters, m_spec.get_key(col_ndx)), get_alloc()); // Throws
+                    SearchIndex* index =
+                        create_index_accessor(m_spec.get_key(col_ndx), IndexType::General, 0); // Throws
                     m_index_accessors[col_ndx] = index;
-                    index->set_parent(&m_index_refs, col_ndx);
                     m_index_refs.set(col_ndx, index->get_ref());
                 }
             }
@@ -1920,6 +2125,7 @@ ref_type Table::create_empty_table(Allocator& alloc, TableKey key)
     top.add(0); // pk col key
     top.add(0); // flags
     top.add(0); // tombstones
+    top.add(0); // composite indexes
 
     REALM_ASSERT(top.size() == top_array_size);
 
@@ -2046,6 +2252,9 @@ size_t Table::count_int(ColKey col_key, int64_t value) const
     if (auto index = this->get_search_index(col_key)) {
         return index->count(value);
     }
+    if (auto index = this->get_range_index(col_key)) {
+        return index->count(value);
+    }
 
     size_t count;
     if (is_nullable(col_key)) {
@@ -2293,6 +2502,9 @@ ObjKey Table::find_first(ColKey col_key, T value) const
         if (StringIndex* index = get_search_index(col_key)) {
             return index->find_first(value);
         }
+        if (RangeIndex* index = get_range_index(col_key)) {
+            return index->find_first(Mixed(value));
+        }
 
         if (col_key == m_primary_key_col) {
             return this->find_primary_key(value);
@@ -2553,6 +2765,12 @@ void Table::update_from_parent() noexcept
                 index->update_from_parent();
             }
         }
+        if (m_composite_index_refs.is_attached()) {
+            m_composite_index_refs.update_from_parent();
+            for (auto index : m_composite_index_accessors) {
+                index->update_from_parent();
+            }
+        }
         // FIXME: REMOVE CONDITIONAL CHECKS?
         if (m_top.size() > top_position_for_opposite_table)
             m_opposite_table.update_from_parent();
@@ -2570,6 +2788,7 @@ void Table::update_from_parent() noexcept
 
         refresh_content_version();
         m_has_any_embedded_objects.reset();
+        prune_zone_maps();
     }
     m_alloc.bump_storage_version();
 }
@@ -2712,6 +2931,39 @@ void Table::flush_for_commit()
     }
 }
 
+ref_type Table::typed_write(ref_type ref, _impl::ArrayWriterBase& out) const
+{
+    REALM_ASSERT_DEBUG(ref == m_top.get_ref());
+    if (m_alloc.is_read_only(ref))
+        return ref;
+
+    // Temp array for updated refs
+    Array written(Allocator::get_default());
+    written.create(Array::type_HasRefs, m_top.get_context_flag()); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&written);
+
+    size_t sz = m_top.size();
+    for (size_t i = 0; i < sz; ++i) {
+        RefOrTagged rot = m_top.get_as_ref_or_tagged(i);
+        if (rot.is_ref() && rot.get_as_ref()) {
+            ref_type child_ref = rot.get_as_ref();
+            if (i == top_position_for_cluster_tree) {
+                child_ref = m_clusters.typed_write(child_ref, out); // Throws
+            }
+            else if (i == top_position_for_tombstones && m_tombstones) {
+                child_ref = m_tombstones->typed_write(child_ref, out); // Throws
+            }
+            else {
+                child_ref = Array::write(child_ref, m_alloc, out, true); // Throws
+            }
+            rot = RefOrTagged::make_ref(child_ref);
+        }
+        written.add(rot); // Throws
+    }
+
+    return written.write(out, false, false); // Throws
+}
+
 void Table::refresh_content_version()
 {
     REALM_ASSERT(m_top.is_attached());
@@ -2757,6 +3009,18 @@ void Table::refresh_accessor_tree()
     bump_storage_version();
     build_column_mapping();
     refresh_index_accessors();
+    refresh_composite_index_accessors();
+    prune_zone_maps();
+}
+
+void Table::prune_zone_maps() noexcept
+{
+    try {
+        m_zone_maps.prune(m_clusters); // Throws
+    }
+    catch (...) {
+        m_zone_maps.clear();
+    }
 }
 
 void Table::refresh_index_accessors()
@@ -2778,22 +3042,34 @@ void Table::refresh_index_accessors()
     // and the index accessor vector is not updated correspondingly.
     for (size_t col_ndx = 0; col_ndx < col_ndx_end; col_ndx++) {
 
-        bool has_old_accessor = m_index_accessors[col_ndx];
         ref_type ref = m_index_refs.get_as_ref(col_ndx);
-
-        if (has_old_accessor && ref == 0) { // accessor drop
-            delete m_index_accessors[col_ndx];
-            m_index_accessors[col_ndx] = nullptr;
+        auto col_key = m_leaf_ndx2colkey[col_ndx];
+        // The attributes of a removed column must not be read
+        ColumnAttrMask attr = ref ? m_spec.get_column_attr(m_leaf_ndx2spec_ndx[col_ndx]) : ColumnAttrMask();
+        IndexType type = IndexType::General;
+        if (attr.test(col_attr_CaseInsensitiveIndex))
+            type = IndexType::CaseInsensitive;
+        else if (attr.test(col_attr_FullTextIndex))
+            type = IndexType::Fulltext;
+        else if (attr.test(col_attr_OrderedIndex))
+            type = IndexType::Ordered;
+
+        // accessor drop, also if the index has been replaced by one of another type, or the column by a collection
+        // column of the same index
+        SearchIndex*& index = m_index_accessors[col_ndx];
+        if (index && (ref == 0 || index->get_index_type() != type ||
+                      index->get_column_key().is_collection() != col_key.is_collection())) {
+            delete index;
+            index = nullptr;
         }
-        else if (has_old_accessor && ref != 0) { // still there, refresh:
-            auto col_key = m_leaf_ndx2colkey[col_ndx];
-            ClusterColumn virtual_col(&m_clusters, col_key);
-            m_index_accessors[col_ndx]->refresh_accessor_tree(virtual_col);
+        if (ref == 0)
+            continue;
+
+        if (index) { // still there, refresh:
+            index->refresh_accessor_tree(ClusterColumn(&m_clusters, col_key, type == IndexType::CaseInsensitive));
         }
-        else if (!has_old_accessor && ref != 0) { // new index!
-            auto col_key = m_leaf_ndx2colkey[col_ndx];
-            ClusterColumn virtual_col(&m_clusters, col_key);
-            m_index_accessors[col_ndx] = new StringIndex(ref, &m_index_refs, col_ndx, virtual_col, get_alloc());
+        else { // new index!
+            index = create_index_accessor(col_key, type, ref);
         }
     }
 }
@@ -3425,7 +3701,7 @@ void Table::build_column_mapping()
 ColKey Table::generate_col_key(ColumnType tp, ColumnAttrMask attr)
 {
     REALM_ASSERT(!attr.test(col_attr_Indexed));
-    REALM_ASSERT(!attr.test(col_attr_Unique)); // Must not be encoded into col_key
+    REALM_ASSERT(!attr.test(col_attr_FullTextIndex)); // Must not be encoded into col_key
     // FIXME: Change this to be random number mixed with the TableKey.
     int64_t col_seq_number = m_top.get_as_ref_or_tagged(top_position_for_column_key).get_as_int();
     unsigned upper = unsigned(col_seq_number ^ get_key().value);
@@ -3848,7 +4124,12 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
 
     check_column(col_key);
 
-    bool si = has_search_index(col_key);
+    IndexType index_type = search_index_type(col_key);
+    std::vector<std::vector<ColKey>> composite_indexes;
+    for (auto& columns : get_composite_indexes()) {
+        if (std::find(columns.begin(), columns.end(), col_key) != columns.end())
+            composite_indexes.push_back(std::move(columns));
+    }
     std::string column_name(get_column_name(col_key));
     auto type = col_key.get_type();
     auto attr = col_key.get_attrs();
@@ -3875,8 +4156,12 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
     erase_root_column(col_key);
     m_spec.rename_column(colkey2spec_ndx(new_col), column_name);
 
-    if (si)
-        add_search_index(new_col);
+    if (index_type != IndexType::None)
+        add_search_index(new_col, index_type);
+    for (auto& columns : composite_indexes) {
+        std::replace(columns.begin(), columns.end(), col_key, new_col);
+        add_composite_index(columns);
+    }
 
     if (is_pk_col) {
         // If we go from non nullable to nullable, no values change,
@@ -35,6 +35,8 @@
 #include <realm/table_cluster_tree.hpp>
 #include <realm/keys.hpp>
 #include <realm/global_key.hpp>
+#include <realm/zone_map.hpp>
+#include <realm/table_statistics.hpp>
 
 // Only set this to one when testing the code paths that exercise object ID
 // hash collisions. It artificially limits the "optimistic" local ID to use
@@ -51,7 +53,12 @@ class BinaryColumy;
 class ConstTableView;
 class Group;
 class SortDescriptor;
+class SearchIndex;
 class StringIndex;
+class RangeIndex;
+class CollectionIndex;
+class FullTextIndex;
+class CompositeIndex;
 class TableView;
 template <class>
 class Columns;
@@ -164,13 +171,30 @@ public:
 
     //@{
 
-    /// has_search_index() returns true if, and only if a search index has been
-    /// added to the specified column. Rather than throwing, it returns false if
-    /// the table accessor is detached or the specified index is out of range.
+    /// has_search_index() returns true if, and only if a general search index
+    /// (IndexType::General) has been added to the specified column. Rather
+    /// than throwing, it returns false if the table accessor is detached or
+    /// the specified index is out of range. search_index_type() tells which
+    /// kind of index, if any, the column has.
     ///
-    /// add_search_index() adds a search index to the specified column of the
-    /// table. It has no effect if a search index has already been added to the
-    /// specified column (idempotency).
+    /// add_search_index() adds a search index of the specified type to the
+    /// specified column of the table. It has no effect if a search index of
+    /// that type has already been added to the specified column (idempotency).
+    /// An index of another type is replaced. An ordered index
+    /// (IndexType::Ordered) can be added to Int, Timestamp and ObjectId
+    /// columns, and is used for range conditions and for sorting on the
+    /// column.
+    /// A general index can also be added to a list or set of Int, Bool,
+    /// String, Timestamp, ObjectId or UUID, and to a dictionary which does not
+    /// hold links (see CollectionIndex). It is used when comparing any element
+    /// of the collection for equality.
+    /// A full-text index (IndexType::Fulltext) can be added to a String
+    /// column. It is an index of the words of the strings (see FullTextIndex),
+    /// and is used by the TEXT condition (Query::fulltext()).
+    /// A case insensitive index (IndexType::CaseInsensitive) can be added to a
+    /// String column. It is a StringIndex of the case folded strings, and is
+    /// used by case insensitive `==` conditions. It is not used for case
+    /// sensitive ones.
     ///
     /// remove_search_index() removes the search index from the specified column
     /// of the table. It has no effect if the specified column has no search
@@ -180,9 +204,26 @@ public:
     /// \param col_key The key of a column of the table.
 
     bool has_search_index(ColKey col_key) const noexcept;
-    void add_search_index(ColKey col_key);
+    bool has_range_index(ColKey col_key) const noexcept;
+    IndexType search_index_type(ColKey col_key) const noexcept;
+    void add_search_index(ColKey col_key, IndexType type = IndexType::General);
     void remove_search_index(ColKey col_key);
 
+    /// add_composite_index() adds an ordered index over the combined values
+    /// of 2 to 4 Int, Bool, String, Timestamp or ObjectId columns, in the
+    /// given order. Queries with equality conditions on a leading subset of
+    /// the columns, optionally followed by a range condition on the next
+    /// column, are answered from it. It has no effect if an index over the
+    /// same columns in the same order exists. The index is removed together
+    /// with any of its columns.
+    ///
+    /// remove_composite_index() removes the index over the specified columns.
+    /// It has no effect if there is no such index.
+    void add_composite_index(const std::vector<ColKey>& columns);
+    void remove_composite_index(const std::vector<ColKey>& columns);
+    bool has_composite_index(const std::vector<ColKey>& columns) const noexcept;
+    std::vector<std::vector<ColKey>> get_composite_indexes() const;
+
     void enumerate_string_column(ColKey col_key);
     bool is_enumerated(ColKey col_key) const noexcept;
     bool contains_unique_values(ColKey col_key) const;
@@ -373,14 +414,42 @@ public:
     double average_double(ColKey col_key, size_t* value_count = nullptr) const;
     Decimal128 average_decimal(ColKey col_key, size_t* value_count = nullptr) const;
 
-    // Will return pointer to search index accessor. Will return nullptr if no index
-    StringIndex* get_search_index(ColKey col) const noexcept
+    // Will return pointer to the index accessor of the column, of any index type. Will return nullptr if no index
+    SearchIndex* get_index(ColKey col) const
     {
         report_invalid_key(col);
-        if (!has_search_index(col))
-            return nullptr;
         return m_index_accessors[col.get_index().val];
     }
+    // Will return pointer to search index accessor. Will return nullptr if no index
+    StringIndex* get_search_index(ColKey col) const noexcept;
+    // Will return pointer to the ordered index accessor. Will return nullptr if no ordered index
+    RangeIndex* get_range_index(ColKey col) const;
+    // Will return pointer to the index accessor of a collection column. Will return nullptr if no index
+    CollectionIndex* get_collection_index(ColKey col) const;
+    // Will return pointer to the full-text index accessor. Will return nullptr if no full-text index
+    FullTextIndex* get_fulltext_index(ColKey col) const;
+    // Will return pointer to the case insensitive index accessor. Will return nullptr if no case insensitive index
+    StringIndex* get_case_insensitive_index(ColKey col) const;
+    // Will return pointer to the composite index accessor over the columns. Will return nullptr if no such index
+    CompositeIndex* get_composite_index(const std::vector<ColKey>& columns) const noexcept;
+    /// The min/max summary of a column leaf of this table, if the leaf is
+    /// in read-only memory (see ZoneMap)
+    template <class LeafType>
+    util::Optional<ZoneMap> get_zone_map(ColKey col, const LeafType& leaf) const
+    {
+        return m_zone_maps.get(col, leaf, m_alloc);
+    }
+    size_t get_num_zone_maps() const noexcept
+    {
+        return m_zone_maps.size();
+    }
+    /// Statistics of the values of a column, sampled from the content of the
+    /// table (see ColumnStatistics). Null for collections.
+    std::shared_ptr<const ColumnStatistics> get_column_statistics(ColKey col) const
+    {
+        report_invalid_key(col);
+        return m_statistics.get(*this, col, {m_in_file_version_at_transaction_boundary, m_top.get_ref()});
+    }
     template <class T>
     ObjKey find_first(ColKey col_key, T value) const;
 
@@ -637,7 +706,11 @@ private:
     Array m_index_refs;                             // 5th slot in m_top
     Array m_opposite_table;                         // 7th slot in m_top
     Array m_opposite_column;                        // 8th slot in m_top
-    std::vector<StringIndex*> m_index_accessors;
+    std::vector<SearchIndex*> m_index_accessors;
+    Array m_composite_index_refs; // 15th slot in m_top
+    std::vector<CompositeIndex*> m_composite_index_accessors;
+    mutable ZoneMaps m_zone_maps;
+    mutable TableStatistics m_statistics;
     ColKey m_primary_key_col;
     Replication* const* m_repl;
     static Replication* g_dummy_replication;
@@ -652,6 +725,13 @@ private:
     void erase_from_search_indexes(ObjKey key);
     void update_indexes(ObjKey key, const FieldValues& values);
     void clear_indexes();
+    void set_in_composite_indexes(ObjKey key, ColKey col_key, Mixed value);
+    void remove_composite_indexes(ColKey col_key);
+    void refresh_composite_index_accessors();
+    const std::vector<CompositeIndex*>& get_composite_index_accessors() const noexcept
+    {
+        return m_composite_index_accessors;
+    }
 
     // Migration support
     void migrate_column_info();
@@ -769,8 +849,17 @@ private:
     /// table.
     void refresh_accessor_tree();
     void refresh_index_accessors();
+    /// Create the accessor of an index of `type` over `col_key`: of the index
+    /// at `ref`, or of a new empty index if `ref` is 0.
+    SearchIndex* create_index_accessor(ColKey col_key, IndexType type, ref_type ref);
+    void check_file_format_for_index() const;
     void refresh_content_version();
+    void prune_zone_maps() noexcept;
     void flush_for_commit();
+    /// Write the table with its top array at `ref` as Array::write() would
+    /// with `deep` and `only_if_modified` set, but let the writer compress the
+    /// integer leaves of its clusters. See ClusterTree::typed_write().
+    ref_type typed_write(ref_type ref, _impl::ArrayWriterBase& out) const;
 
     bool is_cross_table_link_target() const noexcept;
     template <Action action, typename T, typename R>
@@ -800,7 +889,8 @@ private:
     static constexpr int top_position_for_flags = 12;
     // flags contents: bit 0 - is table embedded?
     static constexpr int top_position_for_tombstones = 13;
-    static constexpr int top_array_size = 14;
+    static constexpr int top_position_for_composite_indexes = 14;
+    static constexpr int top_array_size = 15;
 
     enum { s_collision_map_lo = 0, s_collision_map_hi = 1, s_collision_map_local_id = 2, s_collision_map_num_slots };
 
@@ -1120,11 +1210,13 @@ inline Table::Table(Allocator& alloc)
     , m_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
+    , m_composite_index_refs(m_alloc)
     , m_repl(&g_dummy_replication)
     , m_own_ref(this, alloc.get_instance_version())
 {
     m_spec.set_parent(&m_top, top_position_for_spec);
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
+    m_composite_index_refs.set_parent(&m_top, top_position_for_composite_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
 
@@ -1142,11 +1234,13 @@ inline Table::Table(Replication* const* repl, Allocator& alloc)
     , m_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
+    , m_composite_index_refs(m_alloc)
     , m_repl(repl)
     , m_own_ref(this, alloc.get_instance_version())
 {
     m_spec.set_parent(&m_top, top_position_for_spec);
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
+    m_composite_index_refs.set_parent(&m_top, top_position_for_composite_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
     m_cookie = cookie_created;
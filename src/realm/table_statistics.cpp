@@ -0,0 +1,143 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include <realm/table_statistics.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+namespace {
+
+bool mixed_less(const Mixed& a, const Mixed& b)
+{
+    return a.compare(b) < 0;
+}
+
+} // unnamed namespace
+
+ColumnStatistics::ColumnStatistics(const Table& table, ColKey col)
+    : m_row_count(table.size())
+{
+    m_sample_size = std::min(m_row_count, max_sample_size);
+    m_values.reserve(m_sample_size);
+    // Reserved up front, so that the strings are never moved
+    m_buffers.reserve(m_sample_size);
+    for (size_t i = 0; i < m_sample_size; ++i) {
+        Mixed value = table.get_object(i * m_row_count / m_sample_size).get_any(col);
+        if (value.is_null()) {
+            ++m_null_count;
+            continue;
+        }
+        if (value.get_type() == type_String) {
+            StringData str = value.get_string();
+            m_buffers.emplace_back(str.data(), str.size());
+            value = StringData(m_buffers.back());
+        }
+        else if (value.get_type() == type_Binary) {
+            BinaryData bin = value.get_binary();
+            m_buffers.emplace_back(bin.data(), bin.size());
+            value = BinaryData(m_buffers.back().data(), bin.size());
+        }
+        m_values.push_back(value);
+    }
+    std::sort(m_values.begin(), m_values.end(), mixed_less);
+
+    for (size_t i = 0; i < m_values.size(); ++i) {
+        if (i == 0 || m_values[i - 1].compare(m_values[i]) != 0)
+            ++m_distinct_count;
+    }
+}
+
+double ColumnStatistics::null_fraction() const noexcept
+{
+    return m_sample_size ? double(m_null_count) / m_sample_size : 0;
+}
+
+double ColumnStatistics::estimated_cardinality() const noexcept
+{
+    if (is_complete() || m_distinct_count < m_values.size())
+        return double(m_distinct_count);
+    return m_row_count * (1 - null_fraction());
+}
+
+double ColumnStatistics::fraction_equal(Mixed value) const
+{
+    if (m_sample_size == 0)
+        return 0;
+    if (value.is_null())
+        return null_fraction();
+    auto range = std::equal_range(m_values.begin(), m_values.end(), value, mixed_less);
+    if (range.first != range.second)
+        return double(range.second - range.first) / m_sample_size;
+    if (is_complete())
+        return 0;
+    // The value is rarer than any sampled value
+    return 1 / std::max(estimated_cardinality(), double(m_sample_size));
+}
+
+double ColumnStatistics::fraction_less(Mixed value, bool or_equal) const
+{
+    if (m_sample_size == 0 || value.is_null())
+        return 0;
+    auto end = or_equal ? std::upper_bound(m_values.begin(), m_values.end(), value, mixed_less)
+                        : std::lower_bound(m_values.begin(), m_values.end(), value, mixed_less);
+    return double(end - m_values.begin()) / m_sample_size;
+}
+
+double ColumnStatistics::fraction_greater(Mixed value, bool or_equal) const
+{
+    if (m_sample_size == 0 || value.is_null())
+        return 0;
+    auto begin = or_equal ? std::lower_bound(m_values.begin(), m_values.end(), value, mixed_less)
+                          : std::upper_bound(m_values.begin(), m_values.end(), value, mixed_less);
+    return double(m_values.end() - begin) / m_sample_size;
+}
+
+std::shared_ptr<const ColumnStatistics> TableStatistics::get(const Table& table, ColKey col, Version version)
+{
+    if (col.is_collection())
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!(version == m_version)) {
+        m_entries.clear();
+        m_version = version;
+    }
+    auto& entry = m_entries[col.value];
+    if (entry) {
+        // Rows added or removed since the first modification in this write
+        // transaction
+        size_t row_count = entry->get_row_count();
+        size_t current_row_count = table.size();
+        size_t drift = std::max(row_count, current_row_count) - std::min(row_count, current_row_count);
+        if (drift > row_count / 8)
+            entry.reset();
+    }
+    if (!entry)
+        entry = std::make_shared<ColumnStatistics>(table, col); // Throws
+    return entry;
+}
+
+void TableStatistics::clear() noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_version = Version();
+}
@@ -0,0 +1,130 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_TABLE_STATISTICS_HPP
+#define REALM_TABLE_STATISTICS_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <realm/alloc.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+
+/*
+ColumnStatistics describe the values of a column of a table from a sample of its rows: the fraction of nulls, the
+number of distinct values and the sampled values themselves, ordered by Mixed::compare(). The query planner uses them
+to estimate how many rows a condition matches (see Query::init()).
+
+Statistics are not stored in the file. The TableStatistics of a table accessor collects the statistics of a column the
+first time they are asked for, and keeps them until the table changes. A table is taken to have changed when another
+version of it is committed, when it is first modified in a write transaction, or when its number of rows has changed by
+more than an eighth since the statistics were collected. Other modifications in the same write transaction do not
+collect them again, as that would make every query of a table being modified sample it anew.
+*/
+
+namespace realm {
+
+class Table;
+
+class ColumnStatistics {
+public:
+    /// Number of rows sampled at most
+    static constexpr size_t max_sample_size = 256;
+
+    /// Statistics of the non-collection column `col`, from up to
+    /// `max_sample_size` rows spread evenly over the table
+    ColumnStatistics(const Table& table, ColKey col);
+
+    size_t get_row_count() const noexcept
+    {
+        return m_row_count;
+    }
+    size_t get_sample_size() const noexcept
+    {
+        return m_sample_size;
+    }
+    /// The sampled non-null values, ordered by Mixed::compare()
+    const std::vector<Mixed>& get_values() const noexcept
+    {
+        return m_values;
+    }
+
+    double null_fraction() const noexcept;
+    /// The estimated number of distinct non-null values of the column. If no
+    /// value occurs twice in the sample, the values are taken to be unique.
+    double estimated_cardinality() const noexcept;
+
+    /// Estimated fraction of the rows whose value is equal to `value`
+    double fraction_equal(Mixed value) const;
+    /// Estimated fraction of the rows whose value is smaller than (or equal
+    /// to) `value`. Nulls never match.
+    double fraction_less(Mixed value, bool or_equal) const;
+    /// Estimated fraction of the rows whose value is greater than (or equal
+    /// to) `value`. Nulls never match.
+    double fraction_greater(Mixed value, bool or_equal) const;
+
+private:
+    size_t m_row_count = 0;
+    size_t m_sample_size = 0;
+    size_t m_null_count = 0;
+    size_t m_distinct_count = 0;
+    std::vector<Mixed> m_values;
+    // Copies of the sampled strings and binaries, which m_values refer to
+    std::vector<std::string> m_buffers;
+
+    bool is_complete() const noexcept
+    {
+        return m_sample_size == m_row_count;
+    }
+};
+
+class TableStatistics {
+public:
+    /// The version of a table that statistics are collected from: the version
+    /// stored in the table by the last commit that modified it, and the ref
+    /// of its top array, which changes when the table is first modified in a
+    /// write transaction.
+    struct Version {
+        uint64_t committed_version = 0;
+        ref_type top_ref = 0;
+
+        bool operator==(const Version& other) const noexcept
+        {
+            return committed_version == other.committed_version && top_ref == other.top_ref;
+        }
+    };
+
+    /// The statistics of column `col` of `table`, collected only once for
+    /// each version of the table (see above). Null for collection columns.
+    /// May be called concurrently.
+    std::shared_ptr<const ColumnStatistics> get(const Table& table, ColKey col, Version version);
+    void clear() noexcept;
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<int64_t, std::shared_ptr<const ColumnStatistics>> m_entries;
+    Version m_version;
+};
+
+} // namespace realm
+
+#endif // REALM_TABLE_STATISTICS_HPP
@@ -19,6 +19,7 @@
 #include <realm/table_view.hpp>
 #include <realm/column_integer.hpp>
 #include <realm/index_string.hpp>
+#include <realm/index_range.hpp>
 #include <realm/db.hpp>
 
 #include <unordered_set>
@@ -611,8 +612,13 @@ void ConstTableView::do_sync()
         else
             m_key_values.create();
 
-        if (m_query.m_view)
+        if (m_query.m_view) {
             m_query.m_view->sync_if_needed();
+        }
+        else if (sync_from_range_index()) {
+            m_last_seen_versions = get_dependency_versions();
+            return;
+        }
         m_query.find_all(*const_cast<ConstTableView*>(this), m_start, m_end, m_limit);
     }
 
@@ -621,6 +627,78 @@ void ConstTableView::do_sync()
     m_last_seen_versions = get_dependency_versions();
 }
 
+// A sort on a single column with a range index, optionally followed by a limit, is
+// served by visiting the objects in index order, so that the result of the query
+// never has to be materialized and sorted. Returns false if the ordering does not
+// qualify. If a limit is given, the walk stops as soon as it has been reached.
+bool ConstTableView::sync_from_range_index()
+{
+    if (m_start != 0 || m_end != size_t(-1) || m_limit != size_t(-1))
+        return false;
+    size_t num_descriptors = m_descriptor_ordering.size();
+    if (num_descriptors == 0 || num_descriptors > 2)
+        return false;
+    if (m_descriptor_ordering.get_type(0) != DescriptorType::Sort)
+        return false;
+    size_t limit = size_t(-1);
+    if (num_descriptors == 2) {
+        if (m_descriptor_ordering.get_type(1) != DescriptorType::Limit)
+            return false;
+        limit = static_cast<const LimitDescriptor*>(m_descriptor_ordering[1])->get_limit();
+    }
+    // Without a limit, all objects must be visited anyway, and evaluating the
+    // conditions object by object is slower than running the query
+    bool has_conditions = m_query.has_conditions();
+    if (has_conditions && limit == size_t(-1))
+        return false;
+
+    auto sort = static_cast<const SortDescriptor*>(m_descriptor_ordering[0]);
+    auto& column_keys = sort->get_column_keys();
+    if (column_keys.size() != 1 || column_keys[0].size() != 1)
+        return false;
+    ColKey col_key = column_keys[0][0];
+    if (!m_table->valid_column(col_key))
+        return false;
+    const RangeIndex* index = m_table->get_range_index(col_key);
+    if (!index)
+        return false;
+    bool ascending = sort->is_ascending(0).value_or(true);
+
+    if (has_conditions)
+        m_query.init();
+    auto add_if_match = [&](size_t ndx) {
+        ObjKey key = index->get_key(ndx);
+        if (!has_conditions || m_query.eval_object(m_table->get_object(key)))
+            m_key_values.add(key);
+    };
+
+    size_t sz = index->size();
+    if (ascending) {
+        for (size_t i = 0; i < sz && m_key_values.size() < limit; ++i)
+            add_if_match(i);
+    }
+    else {
+        // Entries with equal values are kept in key order, as the sort is stable
+        size_t end = sz;
+        while (end > 0 && m_key_values.size() < limit) {
+            size_t begin = index->lower_bound(index->get_value(end - 1));
+            for (size_t i = begin; i < end && m_key_values.size() < limit; ++i)
+                add_if_match(i);
+            end = begin;
+        }
+    }
+
+    // Unless the walk stopped at the limit, it has visited every object and
+    // nothing was excluded. Otherwise the matches are counted with the query,
+    // which is still cheaper than materializing and sorting them.
+    m_limit_count = 0;
+    if (m_key_values.size() == limit) {
+        size_t num_matches = has_conditions ? m_query.count() : m_table->size();
+        m_limit_count = num_matches - limit;
+    }
+    return true;
+}
+
 void ConstTableView::do_sort(const DescriptorOrdering& ordering)
 {
     if (ordering.is_empty())
@@ -653,9 +731,13 @@ void ConstTableView::do_sort(const DescriptorOrdering& ordering)
         BaseDescriptor::Sorter predicate = base_descr->sorter(*m_table, index_pairs);
 
         // Sorting can be specified by multiple columns, so that if two entries in the first column are
-        // identical, then the rows are ordered according to the second column, and so forth. For the
-        // first column, we cache all the payload of fields of the view in a std::vector<Mixed>
-        predicate.cache_first_column(index_pairs);
+        // identical, then the rows are ordered according to the second column, and so forth. The values
+        // of the sort columns are read up front, so that the comparisons need not look up the objects.
+        predicate.cache_columns(index_pairs);
+        // Like query evaluation, sorting may only use several threads when
+        // nothing can modify the objects underneath it
+        if (m_table->get_alloc().is_read_only())
+            predicate.set_max_threads(m_query.m_max_threads);
 
         base_descr->execute(index_pairs, predicate, next);
     }
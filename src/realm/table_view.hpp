@@ -381,6 +381,7 @@ protected:
     void get_dependencies(TableVersions&) const override;
 
     void do_sync();
+    bool sync_from_range_index();
     void do_sort(const DescriptorOrdering&);
 
     mutable ConstTableRef m_table;
@@ -0,0 +1,151 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <exception>
+
+#include <realm/util/assert.hpp>
+#include <realm/util/worker_pool.hpp>
+
+using namespace realm;
+using namespace realm::util;
+
+
+struct WorkerPool::Batch {
+    FunctionRef<void(size_t)> func;
+    size_t size;
+    size_t next = 0;
+    size_t num_done = 0;
+    std::vector<std::exception_ptr> errors;
+    std::condition_variable all_done;
+
+    Batch(FunctionRef<void(size_t)> f, size_t n)
+        : func(f)
+        , size(n)
+        , errors(n)
+    {
+    }
+};
+
+
+WorkerPool::WorkerPool(size_t num_threads)
+    : m_num_threads(num_threads != 0 ? num_threads : std::max(std::thread::hardware_concurrency(), 2u) - 1)
+{
+}
+
+
+WorkerPool::~WorkerPool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        REALM_ASSERT(m_queue.empty());
+        m_stop = true;
+    }
+    m_work_available.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+
+WorkerPool& WorkerPool::get_default()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+
+void WorkerPool::run(size_t n, FunctionRef<void(size_t)> func)
+{
+    if (n == 0)
+        return;
+
+    Batch batch(func, n);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    size_t i = batch.next++;
+    if (batch.next < n) {
+        if (m_threads.empty()) {
+            m_threads.reserve(m_num_threads); // Throws
+            for (size_t j = 0; j < m_num_threads; ++j)
+                m_threads.emplace_back([this] {
+                    worker_loop();
+                }); // Throws
+        }
+        m_queue.push_back(&batch); // Throws
+        m_work_available.notify_all();
+    }
+
+    // Run the calls that no pool thread has taken
+    for (;;) {
+        lock.unlock();
+        execute(batch, i);
+        lock.lock();
+        if (batch.next == n)
+            break;
+        i = claim(batch);
+    }
+    batch.all_done.wait(lock, [&] {
+        return batch.num_done == n;
+    });
+    lock.unlock();
+
+    for (auto& error : batch.errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+
+void WorkerPool::worker_loop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_work_available.wait(lock, [&] {
+            return m_stop || !m_queue.empty();
+        });
+        if (m_stop)
+            return;
+        Batch& batch = *m_queue.front();
+        size_t i = claim(batch);
+        lock.unlock();
+        execute(batch, i);
+        lock.lock();
+    }
+}
+
+
+size_t WorkerPool::claim(Batch& batch)
+{
+    size_t i = batch.next++;
+    if (batch.next == batch.size)
+        m_queue.erase(std::find(m_queue.begin(), m_queue.end(), &batch));
+    return i;
+}
+
+
+void WorkerPool::execute(Batch& batch, size_t i) noexcept
+{
+    try {
+        batch.func(i);
+    }
+    catch (...) {
+        batch.errors[i] = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (++batch.num_done == batch.size)
+        batch.all_done.notify_one();
+}
@@ -0,0 +1,97 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_UTIL_WORKER_POOL_HPP
+#define REALM_UTIL_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <realm/util/function_ref.hpp>
+
+namespace realm {
+namespace util {
+
+/// A fixed set of threads running the calls of run_in_parallel().
+///
+/// The threads are started by the first call that has work for them, and wait
+/// for more work in between calls. A thread calling run() takes part in its
+/// own work, and runs the calls that no pool thread has started yet itself
+/// instead of waiting for them. Calls of run() may therefore be nested, and
+/// made from any number of threads at once.
+class WorkerPool {
+public:
+    /// A pool of `num_threads` threads, one less than the number of hardware
+    /// threads if zero.
+    explicit WorkerPool(size_t num_threads = 0);
+    ~WorkerPool() noexcept;
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /// The pool used by run_in_parallel().
+    static WorkerPool& get_default();
+
+    size_t num_threads() const noexcept
+    {
+        return m_num_threads;
+    }
+
+    /// Calls `func(i)` for every i in [0, n), concurrently, and returns when
+    /// all of them have returned. The first call is made on the calling
+    /// thread. If any call throws, the exception of the lowest i is rethrown
+    /// on the calling thread.
+    void run(size_t n, FunctionRef<void(size_t)> func);
+
+private:
+    struct Batch;
+
+    const size_t m_num_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    // Batches with calls not yet started, in the order they were submitted
+    std::deque<Batch*> m_queue;
+    std::vector<std::thread> m_threads;
+    bool m_stop = false;
+
+    void worker_loop();
+    // Start the next call of `batch`, which must be in the queue. The mutex
+    // must be locked.
+    size_t claim(Batch& batch);
+    void execute(Batch& batch, size_t i) noexcept;
+};
+
+/// Calls `func(i)` for every i in [0, n) on the threads of the default worker
+/// pool, see WorkerPool::run().
+inline void run_in_parallel(size_t n, FunctionRef<void(size_t)> func)
+{
+    if (n == 1) {
+        func(0);
+        return;
+    }
+    WorkerPool::get_default().run(n, func);
+}
+
+} // namespace util
+} // namespace realm
+
+#endif // REALM_UTIL_WORKER_POOL_HPP
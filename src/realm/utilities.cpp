@@ -71,6 +71,7 @@ namespace realm {
 
 signed char sse_support = -1;
 signed char avx_support = -1;
+signed char neon_support = -1;
 
 StringCompareCallback string_compare_callback = nullptr;
 string_compare_method_t string_compare_method = STRING_COMPARE_CORE;
@@ -106,6 +107,7 @@ void cpuid_init()
     }
 
     bool avxSupported = false;
+    unsigned long long xcrFeatureMask = 0;
 
 // seems like in jenkins builds, __GNUC__ is defined for clang?! todo fixme
 #if !defined __clang__ && ((defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__)
@@ -114,20 +116,50 @@ void cpuid_init()
 
     if (osUsesXSAVE_XRSTORE && cpuAVXSuport) {
         // Check if the OS will save the YMM registers
-        unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
+        xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
         avxSupported = (xcrFeatureMask & 0x6) || false;
     }
 #endif
 
     if (avxSupported) {
-        avx_support = 0; // AVX1 supported
+        // AVX2 is reported in bit 5 of EBX for CPUID leaf 7, sub-leaf 0, and
+        // AVX-512 Foundation and Byte/Word in bits 16 and 30
+        int ebx7;
+#ifdef _MSC_VER
+        __cpuidex(CPUInfo, 7, 0);
+        ebx7 = CPUInfo[1];
+#else
+        __asm("mov $7, %%eax; "
+              "xor %%ecx, %%ecx; "
+              "cpuid;"
+              "mov %%ebx, %0;"                 // ebx into ebx7
+              : "=r"(ebx7)                     // output
+              :                                // input
+              : "%eax", "%ebx", "%ecx", "%edx" // clobbered register
+              );
+#endif
+        // The OS must also save the opmask registers and the upper halves of
+        // the ZMM registers for AVX-512
+        const int avx512_bits = (1 << 16) | (1 << 30);
+        if ((ebx7 & avx512_bits) == avx512_bits && (xcrFeatureMask & 0xE0) == 0xE0) {
+            avx_support = 2; // AVX-512 (F and BW) supported
+        }
+        else if (ebx7 & (1 << 5)) {
+            avx_support = 1; // AVX2 supported
+        }
+        else {
+            avx_support = 0; // AVX1 supported
+        }
     }
     else {
         avx_support = -1; // No AVX supported
     }
 
-// 1 is reserved for AVX2
+#endif
 
+#ifdef REALM_COMPILER_NEON
+    // Advanced SIMD is a mandatory part of AArch64
+    neon_support = 1;
 #endif
 }
 
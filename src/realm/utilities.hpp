@@ -72,12 +72,17 @@ typedef SSIZE_T ssize_t;
 #define REALM_COMPILER_AVX
 #endif
 
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define REALM_COMPILER_NEON // Compiler supports Advanced SIMD through arm_neon.h
+#endif
+
 namespace realm {
 
 using StringCompareCallback = std::function<bool(const char* string1, const char* string2)>;
 
 extern signed char sse_support;
 extern signed char avx_support;
+extern signed char neon_support;
 
 template <int version>
 REALM_FORCEINLINE bool sseavx()
@@ -92,7 +97,8 @@ REALM_FORCEINLINE bool sseavx()
 
     avx_support = -1: No AVX support
     avx_support = 0: AVX1 supported
-    sse_support = 1: AVX2 supported (not yet implemented for detection in our cpuid_init(), todo)
+    avx_support = 1: AVX2 supported
+    avx_support = 2: AVX-512 Foundation and Byte/Word supported (version = 3)
 
     This lets us test very rapidly at runtime because we just need 1 compare instruction (with 0) to test both for
     SSE 3 and 4.2 by caller (compiler optimizes if calls are concecutive), and can decide branch with ja/jl/je because
@@ -101,8 +107,9 @@ REALM_FORCEINLINE bool sseavx()
     We runtime-initialize sse_support in a constructor of a static variable which is not guaranteed to be called
     prior to cpu_sse(). So we compile-time initialize sse_support to -2 as fallback.
     */
-    static_assert(version == 1 || version == 2 || version == 30 || version == 42,
-                  "Only version == 1 (AVX), 2 (AVX2), 30 (SSE 3) and 42 (SSE 4.2) are supported for detection");
+    static_assert(version == 1 || version == 2 || version == 3 || version == 30 || version == 42,
+                  "Only version == 1 (AVX), 2 (AVX2), 3 (AVX-512), 30 (SSE 3) and 42 (SSE 4.2) are supported for "
+                  "detection");
 #ifdef REALM_COMPILER_SSE
     if (version == 30)
         return (sse_support >= 0);
@@ -112,6 +119,8 @@ REALM_FORCEINLINE bool sseavx()
         return (avx_support >= 0);
     else if (version == 2) // avx2
         return (avx_support > 0);
+    else if (version == 3) // avx-512
+        return (avx_support > 1);
     else
         return false;
 #else
@@ -119,6 +128,17 @@ REALM_FORCEINLINE bool sseavx()
 #endif
 }
 
+// Whether Advanced SIMD (NEON) may be used. It is part of every AArch64 CPU, so neon_support is only cleared to
+// disable it, such as for testing the fallback.
+REALM_FORCEINLINE bool neon()
+{
+#ifdef REALM_COMPILER_NEON
+    return (neon_support > 0);
+#else
+    return false;
+#endif
+}
+
 void cpuid_init();
 void* round_up(void* p, size_t align);
 void* round_down(void* p, size_t align);
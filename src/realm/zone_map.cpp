@@ -0,0 +1,132 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <unordered_set>
+
+#include <realm/zone_map.hpp>
+#include <realm/cluster_tree.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+void ZoneMaps::prune(const ClusterTree& tree)
+{
+    Allocator& alloc = tree.get_alloc();
+    ref_type root = tree.get_ref();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // A tree being written to still only holds read-only leafs of the version
+    // the write started from, and the memory of that version cannot be reused
+    // before the write ends
+    if (root == m_root || !alloc.is_read_only(root))
+        return;
+    if (m_entries.empty()) {
+        m_nodes.clear();
+        m_root = 0;
+        return;
+    }
+
+    // Read the nodes which were not part of the last tree. Without a last
+    // tree, all of them are read.
+    bool incremental = m_root != 0;
+    std::unordered_map<ref_type, Node> added;
+    std::unordered_set<ref_type> kept_nodes;
+    std::unordered_set<ref_type> added_leafs;
+    std::vector<ref_type> stack = {root};
+    while (!stack.empty()) {
+        ref_type ref = stack.back();
+        stack.pop_back();
+        if (incremental && m_nodes.count(ref)) {
+            kept_nodes.insert(ref);
+            continue;
+        }
+        Node node;
+        node.is_cluster = ClusterTree::get_child_refs(alloc, ref, node.children); // Throws
+        if (node.is_cluster) {
+            for (ref_type leaf : node.children) {
+                if (leaf)
+                    added_leafs.insert(leaf);
+            }
+        }
+        else {
+            stack.insert(stack.end(), node.children.begin(), node.children.end());
+        }
+        added.emplace(ref, std::move(node));
+    }
+
+    if (incremental) {
+        // Drop the nodes of the last tree which are not kept, and the
+        // summaries of their leafs which did not move to an added cluster
+        stack = {m_root};
+        while (!stack.empty()) {
+            ref_type ref = stack.back();
+            stack.pop_back();
+            if (kept_nodes.count(ref))
+                continue;
+            auto it = m_nodes.find(ref);
+            REALM_ASSERT(it != m_nodes.end());
+            const Node& node = it->second;
+            if (node.is_cluster) {
+                for (ref_type leaf : node.children) {
+                    if (leaf && !added_leafs.count(leaf))
+                        m_entries.erase(leaf);
+                }
+            }
+            else {
+                stack.insert(stack.end(), node.children.begin(), node.children.end());
+            }
+            m_nodes.erase(it);
+        }
+
+        // Summarize the leafs of the added clusters in the columns which have
+        // been summarized before, so that a commit does not leave the leafs it
+        // modified to be summarized by the next scan
+        const Table* table = tree.get_owning_table();
+        for (auto& entry : added) {
+            const Node& node = entry.second;
+            if (!node.is_cluster)
+                continue;
+            for (auto& column : m_columns) {
+                if (!table->valid_column(column.first))
+                    continue;
+                size_t ndx = column.first.get_index().val;
+                ref_type leaf = ndx < node.children.size() ? node.children[ndx] : 0;
+                if (leaf && !m_entries.count(leaf))
+                    m_entries.emplace(leaf, column.second(leaf, alloc)); // Throws
+            }
+        }
+    }
+    else {
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (added_leafs.count(it->first))
+                ++it;
+            else
+                it = m_entries.erase(it);
+        }
+    }
+    m_nodes.merge(added);
+    m_root = root;
+}
+
+void ZoneMaps::clear() noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_nodes.clear();
+    m_root = 0;
+    m_columns.clear();
+}
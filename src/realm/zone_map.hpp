@@ -0,0 +1,360 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ZONE_MAP_HPP
+#define REALM_ZONE_MAP_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <realm/alloc.hpp>
+#include <realm/array_basic.hpp>
+#include <realm/array_integer.hpp>
+#include <realm/decimal128.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+#include <realm/null.hpp>
+#include <realm/query_conditions.hpp>
+#include <realm/timestamp.hpp>
+#include <realm/util/optional.hpp>
+
+/*
+A ZoneMap summarizes the values of one column leaf of a cluster: the smallest and the largest value, and the number
+of nulls. A query condition can skip the whole leaf if the summary shows that none of its values can satisfy it.
+
+Zone maps are not stored in the file, not even in file format 21: a persisted summary would have to be rewritten by
+every commit that modifies the leaf, and older readers would have to skip it. The ZoneMaps of a table accessor
+computes the summary of a leaf the first time it is scanned and keeps it, so every session pays for summarizing a
+leaf once per version of it, and a query which runs once on a freshly opened file gets no benefit from them. Integer and floating point leafs are summarized with the vectorized Array::minimum(),
+Array::maximum() and BasicArray::minmax_non_null(), other leafs one value at a time. Only leafs in read-only memory
+are summarized, as those cannot change as long as they are part of the version the accessor is bound to.
+
+Whenever the accessor moves to another version, ZoneMaps::prune() drops the summaries of the leafs that are no longer
+part of the table, and summarizes the leafs that replaced them in the columns that have been scanned before. To find
+those, ZoneMaps keeps the child refs of every node of the cluster tree. A node in read-only memory cannot change, and
+its ref cannot be reused as long as a version holding it is bound, so a node found under the same ref in the new
+version is the same node, and so is all of its subtree. Only the nodes written since the last version are read,
+which for most commits is a path from the root to each modified cluster.
+*/
+
+namespace realm {
+
+class ClusterTree;
+
+struct ZoneMap {
+    /// Smallest and largest non-null value, or null if the leaf has no
+    /// non-null values. Float and double NaN values are left out, as they
+    /// never satisfy a condition against a number.
+    Mixed min;
+    Mixed max;
+    size_t null_count = 0;
+
+    /// Conditions that can be evaluated by may_match()
+    template <class Cond>
+    static constexpr bool condition_supported =
+        realm::is_any<Cond, Equal, Greater, GreaterEqual, Less, LessEqual>::value;
+
+    template <class LeafType>
+    static ZoneMap create(const LeafType& leaf);
+
+    /// False if no value in the leaf can satisfy `Cond` against `value`
+    template <class Cond>
+    bool may_match(Mixed value) const;
+};
+
+class ZoneMaps {
+public:
+    /// The summary of `leaf`, the leaf of column `col` in a cluster, computed
+    /// only once. Leafs which are not in read-only memory may still change,
+    /// so none is returned for those. May be called concurrently.
+    template <class LeafType>
+    util::Optional<ZoneMap> get(ColKey col, const LeafType& leaf, Allocator& alloc);
+
+    /// Drop the summaries of the leafs which are no longer part of `tree`,
+    /// and summarize the leafs which replaced them in the columns passed to
+    /// get() before. Must be called whenever the owning table accessor is
+    /// bound to another version, as the memory of a dropped leaf may be
+    /// reused later.
+    void prune(const ClusterTree& tree);
+    void clear() noexcept;
+
+    size_t size() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+private:
+    using Summarizer = ZoneMap (*)(ref_type, Allocator&);
+    struct Node {
+        std::vector<ref_type> children;
+        bool is_cluster;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<ref_type, ZoneMap> m_entries;
+    // The nodes of the tree bound at the last call to prune(), by ref, if
+    // any leaf had been summarized by then. Otherwise m_root is zero.
+    std::unordered_map<ref_type, Node> m_nodes;
+    ref_type m_root = 0;
+    std::vector<std::pair<ColKey, Summarizer>> m_columns;
+
+    template <class LeafType>
+    static ZoneMap summarize(ref_type ref, Allocator& alloc)
+    {
+        LeafType leaf(alloc);
+        leaf.init_from_ref(ref);
+        return ZoneMap::create(leaf);
+    }
+};
+
+
+// Implementation:
+
+namespace _impl {
+
+enum class ZoneValue { value, null, nan };
+
+inline ZoneValue zone_classify(int64_t) noexcept
+{
+    return ZoneValue::value;
+}
+
+template <class T>
+inline std::enable_if_t<std::is_floating_point_v<T>, ZoneValue> zone_classify(T v) noexcept
+{
+    if (null::is_null_float(v))
+        return ZoneValue::null;
+    return std::isnan(v) ? ZoneValue::nan : ZoneValue::value;
+}
+
+template <class T>
+inline ZoneValue zone_classify(const util::Optional<T>& v) noexcept
+{
+    return v ? zone_classify(*v) : ZoneValue::null;
+}
+
+inline ZoneValue zone_classify(const Timestamp& v) noexcept
+{
+    return v.is_null() ? ZoneValue::null : ZoneValue::value;
+}
+
+// Decimal128 orders NaN before all other values, so it is kept as a value
+inline ZoneValue zone_classify(const Decimal128& v) noexcept
+{
+    return v.is_null() ? ZoneValue::null : ZoneValue::value;
+}
+
+template <class T>
+inline const T& zone_unwrap(const T& v) noexcept
+{
+    return v;
+}
+
+template <class T>
+inline const T& zone_unwrap(const util::Optional<T>& v) noexcept
+{
+    return *v;
+}
+
+inline bool zone_is_nan(const Mixed& value) noexcept
+{
+    switch (value.get_type()) {
+        case type_Float:
+            return std::isnan(value.get<float>());
+        case type_Double:
+            return std::isnan(value.get<double>());
+        case type_Decimal:
+            return value.get<Decimal128>().is_nan();
+        default:
+            return false;
+    }
+}
+
+template <class LeafType>
+ZoneMap zone_map_create_scalar(const LeafType& leaf)
+{
+    ZoneMap zone_map;
+    size_t sz = leaf.size();
+    size_t ndx = 0;
+
+    // Find the first value
+    for (; ndx < sz; ++ndx) {
+        auto v = leaf.get(ndx);
+        auto kind = zone_classify(v);
+        if (kind == ZoneValue::null) {
+            ++zone_map.null_count;
+        }
+        else if (kind == ZoneValue::value) {
+            zone_map.min = zone_map.max = Mixed(zone_unwrap(v));
+            break;
+        }
+    }
+    if (ndx == sz)
+        return zone_map;
+
+    auto first = leaf.get(ndx);
+    auto min = zone_unwrap(first);
+    auto max = min;
+    for (++ndx; ndx < sz; ++ndx) {
+        auto v = leaf.get(ndx);
+        auto kind = zone_classify(v);
+        if (kind == ZoneValue::null) {
+            ++zone_map.null_count;
+        }
+        else if (kind == ZoneValue::value) {
+            const auto& x = zone_unwrap(v);
+            if (x < min)
+                min = x;
+            if (max < x)
+                max = x;
+        }
+    }
+    zone_map.min = Mixed(min);
+    zone_map.max = Mixed(max);
+    return zone_map;
+}
+
+template <class T>
+ZoneMap zone_map_create_float(const BasicArray<T>& leaf)
+{
+    // Null and NaN never compare less or greater than anything, so they are
+    // skipped by both scans. If no other value is found, the minimum is left
+    // at infinity and the maximum at minus infinity.
+    ZoneMap zone_map;
+    T min = std::numeric_limits<T>::infinity();
+    T max = -min;
+    size_t ndx;
+    size_t value_count = leaf.template minmax_non_null<false>(min, ndx);
+    leaf.template minmax_non_null<true>(max, ndx);
+    zone_map.null_count = leaf.size() - value_count;
+    if (!(max < min)) {
+        zone_map.min = Mixed(min);
+        zone_map.max = Mixed(max);
+    }
+    return zone_map;
+}
+
+} // namespace _impl
+
+template <class LeafType>
+ZoneMap ZoneMap::create(const LeafType& leaf)
+{
+    if constexpr (std::is_same_v<LeafType, ArrayInteger>) {
+        ZoneMap zone_map;
+        int64_t min, max;
+        if (leaf.size() != 0 && leaf.minimum(min) && leaf.maximum(max)) {
+            zone_map.min = Mixed(min);
+            zone_map.max = Mixed(max);
+        }
+        return zone_map;
+    }
+    else if constexpr (std::is_same_v<LeafType, ArrayIntNull>) {
+        // The null value is stored in front of the elements, and may lie
+        // anywhere in between the values, so a leaf with nulls is scanned
+        // one value at a time.
+        const Array& array = leaf;
+        size_t null_count = array.count(leaf.null_value()) - 1;
+        if (null_count != 0)
+            return _impl::zone_map_create_scalar(leaf);
+        ZoneMap zone_map;
+        int64_t min, max;
+        if (leaf.size() != 0 && array.minimum(min, 1) && array.maximum(max, 1)) {
+            zone_map.min = Mixed(min);
+            zone_map.max = Mixed(max);
+        }
+        return zone_map;
+    }
+    else if constexpr (std::is_base_of_v<BasicArray<float>, LeafType>) {
+        return _impl::zone_map_create_float<float>(leaf);
+    }
+    else if constexpr (std::is_base_of_v<BasicArray<double>, LeafType>) {
+        return _impl::zone_map_create_float<double>(leaf);
+    }
+    else {
+        return _impl::zone_map_create_scalar(leaf);
+    }
+}
+
+template <class Cond>
+bool ZoneMap::may_match(Mixed value) const
+{
+    if constexpr (!condition_supported<Cond>) {
+        return true;
+    }
+    else {
+        if (value.is_null())
+            return std::is_same_v<Cond, Equal> ? null_count > 0 : true;
+        if (_impl::zone_is_nan(value))
+            return true;
+        // Null never satisfies a condition against a non-null value
+        if (min.is_null())
+            return false;
+
+        if constexpr (std::is_same_v<Cond, Equal>) {
+            return min.compare(value) <= 0 && max.compare(value) >= 0;
+        }
+        else if constexpr (std::is_same_v<Cond, Greater>) {
+            return max.compare(value) > 0;
+        }
+        else if constexpr (std::is_same_v<Cond, GreaterEqual>) {
+            return max.compare(value) >= 0;
+        }
+        else if constexpr (std::is_same_v<Cond, Less>) {
+            return min.compare(value) < 0;
+        }
+        else {
+            return min.compare(value) <= 0;
+        }
+    }
+}
+
+template <class LeafType>
+util::Optional<ZoneMap> ZoneMaps::get(ColKey col, const LeafType& leaf, Allocator& alloc)
+{
+    ref_type ref = leaf.get_ref();
+    if (!alloc.is_read_only(ref))
+        return util::none;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(ref);
+        if (it != m_entries.end())
+            return it->second;
+        auto is_col = [col](const auto& entry) {
+            return entry.first == col;
+        };
+        if (std::find_if(m_columns.begin(), m_columns.end(), is_col) == m_columns.end())
+            m_columns.emplace_back(col, &summarize<LeafType>); // Throws
+    }
+
+    // Computed outside of the lock, so that queries running in parallel are
+    // not serialized. If two of them summarize the same leaf, the results
+    // are equal.
+    ZoneMap zone_map = ZoneMap::create(leaf);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.emplace(ref, zone_map);
+    return zone_map;
+}
+
+} // namespace realm
+
+#endif // REALM_ZONE_MAP_HPP
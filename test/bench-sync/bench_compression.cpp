@@ -0,0 +1,216 @@
+#include "../util/benchmark_results.hpp"
+#include "../util/timer.hpp"
+#include "../util/test_path.hpp"
+#include "../util/unit_test.hpp"
+#include "../test_all.hpp"
+
+#include <realm/sync/history.hpp>
+#include <realm/sync/object.hpp>
+#include <realm/sync/noinst/compression.hpp>
+
+#if REALM_HAVE_ZSTD
+#include <zdict.h>
+#endif
+
+#include "../peer.hpp"
+
+using namespace realm;
+using namespace realm::sync;
+using namespace realm::test_util;
+using namespace realm::test_util::unit_test;
+
+namespace bench {
+
+namespace compression = _impl::compression;
+
+// Produces a batch of mostly realistic changesets, one per transaction. Each
+// is the body of an UPLOAD message of a client that uploads as soon as it
+// commits, and their concatenation is the body of a DOWNLOAD message as the
+// server would send it.
+template <size_t num_transactions>
+std::vector<std::string> make_changesets(TestContext& test_context)
+{
+    auto client = Peer::create_client(test_context, 2, nullptr);
+    client->start_transaction();
+    TableRef t = sync::create_table_with_primary_key(*client->group, "class_t", type_Int, "pk");
+    ColKey col_str = t->add_column(type_String, "s");
+    ColKey col_int = t->add_column(type_Int, "i");
+    ColKey col_dbl = t->add_column(type_Double, "d");
+    client->commit();
+
+    for (size_t i = 0; i < num_transactions; ++i) {
+        client->start_transaction();
+        t = client->table("class_t");
+        for (size_t j = 0; j < 10; ++j) {
+            int_fast64_t pk = int_fast64_t(i * 10 + j);
+            Obj obj = t->create_object_with_primary_key(pk);
+            obj.set(col_str, StringData(util::format("Object %1 of transaction %2", j, i)));
+            obj.set(col_int, pk * 7);
+            obj.set(col_dbl, pk / 3.0);
+        }
+        client->commit();
+    }
+
+    std::vector<std::string> changesets;
+    for (version_type version = 2; version <= client->current_version; ++version) {
+        HistoryEntry entry;
+        client->history.get_history_entry(version, entry);
+        std::unique_ptr<char[]> data;
+        size_t size = entry.changeset.copy_to(data);
+        changesets.emplace_back(data.get(), size);
+    }
+    return changesets;
+}
+
+#if REALM_HAVE_ZSTD
+// Trains a Zstandard dictionary on the specified changesets, as a server
+// operator would with `zstd --train` on changesets of the same schema.
+std::unique_ptr<compression::ZstdDictionary> train_zstd_dictionary(const std::vector<std::string>& samples)
+{
+    std::string samples_buffer;
+    std::vector<size_t> sample_sizes;
+    for (const std::string& sample : samples) {
+        samples_buffer += sample;
+        sample_sizes.push_back(sample.size());
+    }
+    std::vector<char> content(16 * 1024);
+    size_t size = ZDICT_trainFromBuffer(content.data(), content.size(), samples_buffer.data(), sample_sizes.data(),
+                                        unsigned(sample_sizes.size()));
+    REALM_ASSERT_RELEASE(!ZDICT_isError(size));
+    return std::make_unique<compression::ZstdDictionary>(BinaryData{content.data(), size});
+}
+#endif
+
+struct BenchCodec {
+    compression::Codec codec;
+    const compression::ZstdDictionary* dictionary;
+    std::string name;
+};
+
+// The codecs of this build, and Zstd with \a dictionary if specified.
+std::vector<BenchCodec> get_bench_codecs(const compression::ZstdDictionary* dictionary)
+{
+    std::vector<BenchCodec> codecs;
+    for (auto codec : {compression::Codec::deflate, compression::Codec::zstd, compression::Codec::lz4}) {
+        if (compression::is_codec_available(codec))
+            codecs.push_back({codec, nullptr, compression::get_codec_name(codec)});
+    }
+    if (dictionary)
+        codecs.push_back({compression::Codec::zstd, dictionary, "zstd_dictionary"});
+    return codecs;
+}
+
+// Compresses and decompresses each of the bodies with each codec, and reports
+// the time taken for all of them together with the total compressed size.
+void compress_bodies(TestContext& test_context, BenchmarkResults& results, const std::vector<std::string>& bodies,
+                     const compression::ZstdDictionary* dictionary)
+{
+    compression::CompressMemoryArena compress_memory_arena;
+    std::vector<char> compressed_buf;
+    size_t uncompressed_size = 0;
+    for (const std::string& body : bodies)
+        uncompressed_size += body.size();
+    std::vector<char> decompressed_buf;
+    const size_t num_iterations = 10;
+
+    for (const BenchCodec& codec : get_bench_codecs(dictionary)) {
+        std::string ident = test_context.test_details.test_name + "_" + codec.name;
+        std::string ident_compress = ident + "_Compress";
+        std::string ident_decompress = ident + "_Decompress";
+        size_t compressed_size = 0;
+        for (size_t i = 0; i < num_iterations; ++i) {
+            double compress_time = 0, decompress_time = 0;
+            compressed_size = 0;
+            for (const std::string& body : bodies) {
+                Timer t{Timer::type_RealTime};
+                size_t size = compression::allocate_and_compress(compress_memory_arena, {body.data(), body.size()},
+                                                                 compressed_buf, codec.codec, codec.dictionary);
+                compress_time += t.get_elapsed_time();
+                compressed_size += size;
+
+                decompressed_buf.resize(body.size());
+                t.reset();
+                std::error_code ec = compression::decompress(codec.codec, compressed_buf.data(), size,
+                                                             decompressed_buf.data(), body.size(), codec.dictionary);
+                decompress_time += t.get_elapsed_time();
+                REALM_ASSERT_RELEASE(!ec);
+            }
+            results.submit(ident_compress.c_str(), compress_time);
+            results.submit(ident_decompress.c_str(), decompress_time);
+        }
+        results.finish(ident_compress, ident_compress);
+        results.finish(ident_decompress, ident_decompress);
+        std::cout << ident << ": " << uncompressed_size << " -> " << compressed_size << " bytes ("
+                  << double(uncompressed_size) / double(compressed_size) << "x)" << std::endl;
+    }
+}
+
+// A single DOWNLOAD body holding all the changesets
+template <size_t num_transactions>
+void compress_download_body(TestContext& test_context, BenchmarkResults& results)
+{
+    std::vector<std::string> changesets = make_changesets<num_transactions>(test_context);
+    std::string body;
+    for (const std::string& changeset : changesets)
+        body += changeset;
+    compress_bodies(test_context, results, {body}, nullptr);
+}
+
+// One small UPLOAD body per changeset, which is where a dictionary helps. The
+// dictionary is trained on the first half of the changesets, and the second
+// half is compressed.
+template <size_t num_transactions>
+void compress_upload_bodies(TestContext& test_context, BenchmarkResults& results)
+{
+    std::vector<std::string> changesets = make_changesets<num_transactions>(test_context);
+    auto middle = changesets.begin() + changesets.size() / 2;
+    std::vector<std::string> bodies(middle, changesets.end());
+    std::unique_ptr<compression::ZstdDictionary> dictionary;
+#if REALM_HAVE_ZSTD
+    dictionary = train_zstd_dictionary({changesets.begin(), middle});
+#endif
+    compress_bodies(test_context, results, bodies, dictionary.get());
+}
+
+} // namespace bench
+
+const int max_lead_text_width = 64;
+
+TEST(BenchCompressDownload100Transactions)
+{
+    std::string results_file_stem = test_util::get_test_path_prefix() + "compression_100";
+    BenchmarkResults results(max_lead_text_width, results_file_stem.c_str());
+
+    bench::compress_download_body<100>(test_context, results);
+}
+
+TEST(BenchCompressDownload1000Transactions)
+{
+    std::string results_file_stem = test_util::get_test_path_prefix() + "compression_1000";
+    BenchmarkResults results(max_lead_text_width, results_file_stem.c_str());
+
+    bench::compress_download_body<1000>(test_context, results);
+}
+
+TEST(BenchCompressDownload10000Transactions)
+{
+    std::string results_file_stem = test_util::get_test_path_prefix() + "compression_10000";
+    BenchmarkResults results(max_lead_text_width, results_file_stem.c_str());
+
+    bench::compress_download_body<10000>(test_context, results);
+}
+
+TEST(BenchCompressUpload1000Transactions)
+{
+    std::string results_file_stem = test_util::get_test_path_prefix() + "compression_upload_1000";
+    BenchmarkResults results(max_lead_text_width, results_file_stem.c_str());
+
+    bench::compress_upload_bodies<1000>(test_context, results);
+}
+
+#if !REALM_IOS
+int main(int argc, char** argv)
+{
+    return test_all(argc, argv, nullptr);
+}
+#endif // REALM_IOS
@@ -197,6 +197,62 @@ void connected_objects(TestContext& test_context, BenchmarkResults& results)
     results.finish(ident, ident);
 }
 
+// Two peers update the properties of the same object in every transaction,
+// as when many clients edit a shared document. All the instructions end up in
+// the same conflict group, but instructions on different properties never
+// conflict. One peer receives and merges all transactions from the other.
+template <size_t num_transactions>
+void hot_object(TestContext& test_context, BenchmarkResults& results)
+{
+    std::string ident = test_context.test_details.test_name;
+    const size_t num_iterations = 3;
+    const size_t num_properties = 16;
+
+    for (size_t i = 0; i < num_iterations; ++i) {
+        auto changeset_dump_dir_gen = get_changeset_dump_dir_generator(test_context, s_bench_test_dump_dir);
+
+        auto server = Peer::create_server(test_context, changeset_dump_dir_gen.get());
+        auto origin = Peer::create_client(test_context, 2, changeset_dump_dir_gen.get());
+        auto client = Peer::create_client(test_context, 3, changeset_dump_dir_gen.get());
+
+        auto make_transactions = [&](Peer& peer) {
+            std::vector<ColKey> cols;
+            {
+                peer.start_transaction();
+                TableRef t = sync::create_table_with_primary_key(*peer.group, "class_t", type_Int, "pk");
+                for (size_t j = 0; j < num_properties; ++j)
+                    cols.push_back(t->add_column(type_Int, util::format("p%1", j)));
+                t->create_object_with_primary_key(0);
+                peer.commit();
+            }
+
+            for (size_t j = 0; j < num_transactions - 1; ++j) {
+                peer.start_transaction();
+                Obj obj = peer.table("class_t")->get_object_with_primary_key(0);
+                obj.set(cols[j % num_properties], int64_t(j));
+                obj.set(cols[(j + peer.local_file_ident) % num_properties], int64_t(j));
+                peer.commit();
+            }
+        };
+
+        make_transactions(*origin);
+        make_transactions(*client);
+
+        size_t outstanding = server->count_outstanding_changesets_from(*origin);
+        for (size_t j = 0; j < outstanding; ++j) {
+            server->integrate_next_changeset_from(*origin);
+        }
+
+        outstanding = client->count_outstanding_changesets_from(*server);
+        REALM_ASSERT(outstanding != 0);
+        Timer t{Timer::type_RealTime};
+        client->integrate_next_changesets_from(*server, outstanding);
+        results.submit(ident.c_str(), t.get_elapsed_time());
+    }
+
+    results.finish(ident, ident);
+}
+
 } // namespace bench
 
 const int max_lead_text_width = 40;
@@ -438,6 +494,22 @@ TEST(BenchMerge16000x16000Transactions)
     bench::transform_transactions<16000>(test_context, results);
 }
 
+TEST(BenchMergeHotObject1000x1000Transactions)
+{
+    std::string results_file_stem = test_util::get_test_path_prefix() + "hot_object_1000x1000";
+    BenchmarkResults results(max_lead_text_width, results_file_stem.c_str());
+
+    bench::hot_object<1000>(test_context, results);
+}
+
+TEST(BenchMergeHotObject4000x4000Transactions)
+{
+    std::string results_file_stem = test_util::get_test_path_prefix() + "hot_object_4000x4000";
+    BenchmarkResults results(max_lead_text_width, results_file_stem.c_str());
+
+    bench::hot_object<4000>(test_context, results);
+}
+
 TEST(BenchMergeManyConnectedObjects)
 {
     std::string results_file_stem = test_util::get_test_path_prefix() + "connected_objects";
@@ -1085,6 +1085,63 @@ struct BenchmarkQueryIntEqualityIndexed : BenchmarkQueryIntEquality {
     }
 };
 
+// Scans a single int column packed at the given bit width with one of the four
+// conditions supported by the Array finder kernels (SSE/AVX2/bithacks)
+template <size_t width, class Cond>
+struct BenchmarkQueryIntWidth : BenchmarkWithIntsTable {
+    std::string m_name;
+
+    BenchmarkQueryIntWidth()
+    {
+        std::stringstream ss;
+        ss << "QueryInt" << width << "Bit";
+        if (std::is_same<Cond, Equal>::value)
+            ss << "Equal";
+        else if (std::is_same<Cond, NotEqual>::value)
+            ss << "NotEqual";
+        else if (std::is_same<Cond, Greater>::value)
+            ss << "Greater";
+        else
+            ss << "Less";
+        m_name = ss.str();
+    }
+
+    const char* name() const
+    {
+        return m_name.c_str();
+    }
+
+    void before_all(DBRef group)
+    {
+        BenchmarkWithIntsTable::before_all(group);
+        WrtTrans tr(group);
+        TableRef t = tr.get_table(name());
+
+        const int64_t bound = width == 64 ? std::numeric_limits<int64_t>::max() : (int64_t(1) << (width - 1)) - 1;
+        Random r;
+        for (size_t i = 0; i < BASE_SIZE * 4; ++i) {
+            t->create_object().set(m_col, r.draw_int<int64_t>(-bound, bound));
+        }
+        tr.commit();
+    }
+
+    void operator()(DBRef)
+    {
+        ConstTableRef table = m_table;
+        Query q = table->where();
+        if (std::is_same<Cond, Equal>::value)
+            q.equal(m_col, 7);
+        else if (std::is_same<Cond, NotEqual>::value)
+            q.not_equal(m_col, 7);
+        else if (std::is_same<Cond, Greater>::value)
+            q.greater(m_col, 7);
+        else
+            q.less(m_col, 7);
+        size_t count = q.count();
+        static_cast<void>(count);
+    }
+};
+
 struct BenchmarkQuery : BenchmarkWithStrings {
     const char* name() const
     {
@@ -1953,6 +2010,22 @@ int benchmark_common_tasks_main()
     BENCH(BenchmarkQueryChainedOrIntsIndexed);
     BENCH(BenchmarkQueryIntEquality);
     BENCH(BenchmarkQueryIntEqualityIndexed);
+    BENCH(BenchmarkQueryIntWidth<8, Equal>);
+    BENCH(BenchmarkQueryIntWidth<8, NotEqual>);
+    BENCH(BenchmarkQueryIntWidth<8, Greater>);
+    BENCH(BenchmarkQueryIntWidth<8, Less>);
+    BENCH(BenchmarkQueryIntWidth<16, Equal>);
+    BENCH(BenchmarkQueryIntWidth<16, NotEqual>);
+    BENCH(BenchmarkQueryIntWidth<16, Greater>);
+    BENCH(BenchmarkQueryIntWidth<16, Less>);
+    BENCH(BenchmarkQueryIntWidth<32, Equal>);
+    BENCH(BenchmarkQueryIntWidth<32, NotEqual>);
+    BENCH(BenchmarkQueryIntWidth<32, Greater>);
+    BENCH(BenchmarkQueryIntWidth<32, Less>);
+    BENCH(BenchmarkQueryIntWidth<64, Equal>);
+    BENCH(BenchmarkQueryIntWidth<64, NotEqual>);
+    BENCH(BenchmarkQueryIntWidth<64, Greater>);
+    BENCH(BenchmarkQueryIntWidth<64, Less>);
     BENCH(BenchmarkIntVsDoubleColumns);
     BENCH(BenchmarkQueryStringOverLinks);
     BENCH(BenchmarkQueryTimestampGreaterOverLinks);
@@ -0,0 +1,92 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/sync/noinst/compression.hpp>
+#include <realm/util/assert.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+using namespace realm;
+using namespace realm::_impl;
+
+// Feeds the input to the decoders of the UPLOAD and DOWNLOAD message bodies as
+// if it had been received from a peer. The first byte is the <body codec>
+// (none, zlib, Zstd or LZ4, where codecs that this build does not have are
+// skipped), the next three bytes are the <uncompressed body size> in little
+// endian, and the rest is the body.
+//
+// The decoders must reject malformed bodies without writing outside of the
+// output buffer, and a body that decodes must survive a round trip through the
+// encoder of the same codec.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    if (size < 4 || !compression::is_valid_codec(data[0]))
+        return 0;
+    auto codec = compression::Codec(data[0]);
+    if (!compression::is_codec_available(codec))
+        return 0;
+    size_t uncompressed_size = size_t(data[1]) | size_t(data[2]) << 8 | size_t(data[3]) << 16;
+    const char* body = reinterpret_cast<const char*>(data + 4);
+    size_t body_size = size - 4;
+
+    constexpr size_t guard_size = 64;
+    std::vector<char> decompressed(uncompressed_size + guard_size, 'G');
+    std::error_code ec = compression::decompress(codec, body, body_size, decompressed.data(), uncompressed_size);
+    REALM_ASSERT_RELEASE(std::all_of(decompressed.begin() + uncompressed_size, decompressed.end(), [](char c) {
+        return c == 'G';
+    }));
+    if (ec || codec == compression::Codec::none)
+        return 0;
+
+    compression::CompressMemoryArena compress_memory_arena;
+    std::vector<char> compressed_buf;
+    size_t compressed_size = compression::allocate_and_compress(
+        compress_memory_arena, {decompressed.data(), uncompressed_size}, compressed_buf, codec);
+    std::vector<char> round_trip(uncompressed_size);
+    ec = compression::decompress(codec, compressed_buf.data(), compressed_size, round_trip.data(),
+                                 uncompressed_size);
+    REALM_ASSERT_RELEASE(!ec);
+    REALM_ASSERT_RELEASE(std::equal(round_trip.begin(), round_trip.end(), decompressed.begin()));
+    return 0; // Non-zero return values are reserved for future use.
+}
+
+#ifndef REALM_LIBFUZZER
+// For AFL, and for replaying inputs: reads the input from the file given as
+// argument, or from standard input
+int main(int argc, const char* argv[])
+{
+    std::vector<char> input;
+    if (argc > 1) {
+        std::ifstream in(argv[1], std::ios::binary);
+        if (!in) {
+            std::cerr << "Could not open file for reading: " << argv[1] << "\n";
+            return 1;
+        }
+        input.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    else {
+        input.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+    return LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+}
+#endif
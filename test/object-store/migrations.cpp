@@ -85,7 +85,7 @@ void verify_schema(Realm& r, int line, bool in_migration)
             REQUIRE(col);
             REQUIRE(col == prop.column_key);
             REQUIRE(to_underlying(ObjectSchema::from_core_type(col)) == to_underlying(prop.type));
-            REQUIRE(table->has_search_index(col) == prop.requires_index());
+            REQUIRE((table->search_index_type(col) != IndexType::None) == prop.requires_index());
             REQUIRE(bool(prop.is_primary) == (prop.name == primary_key));
         }
     }
@@ -242,6 +242,35 @@ TEST_CASE("migration: Automatic") {
             REQUIRE_NO_MIGRATION_NEEDED(*realm, schema, set_indexed(schema, "object", "value", false));
         }
 
+        SECTION("index of another type is kept") {
+            config.cache = false;
+            auto realm = Realm::get_shared_realm(config);
+            Schema schema = {
+                {"object",
+                 {{"value", PropertyType::Int, Property::IsPrimary{false}, Property::IsIndexed{true}},
+                  {"text", PropertyType::String, Property::IsPrimary{false}, Property::IsIndexed{true}}}},
+            };
+            REQUIRE_UPDATE_SUCCEEDS(*realm, schema, 0);
+            auto table = get_table(realm, "object");
+            auto col_value = table->get_column_key("value");
+            auto col_text = table->get_column_key("text");
+            realm->begin_transaction();
+            table->add_search_index(col_value, IndexType::Ordered);
+            table->add_search_index(col_text, IndexType::Fulltext);
+            realm->commit_transaction();
+
+            ObjectSchema object_schema(realm->read_group(), "object", table->get_key());
+            REQUIRE(object_schema.property_for_name("value")->is_indexed);
+            REQUIRE(object_schema.property_for_name("text")->is_indexed);
+
+            // A Realm reading the schema from the file finds nothing to change
+            auto realm2 = Realm::get_shared_realm(config);
+            REQUIRE_UPDATE_SUCCEEDS(*realm2, schema, 0);
+            realm->refresh();
+            REQUIRE(table->search_index_type(col_value) == IndexType::Ordered);
+            REQUIRE(table->search_index_type(col_text) == IndexType::Fulltext);
+        }
+
         SECTION("reordering properties") {
             auto realm = Realm::get_shared_realm(config);
 
@@ -41,6 +41,9 @@
 #include <realm/util/fifo_helper.hpp>
 #include <realm/util/scope_exit.hpp>
 
+#include <atomic>
+#include <thread>
+
 namespace realm {
 class TestHelper {
 public:
@@ -766,6 +769,128 @@ TEST_CASE("SharedRealm: notifications") {
     }
 }
 
+TEST_CASE("SharedRealm: async writes") {
+    // Runs the notify callback on the test thread when asked to
+    class ManualScheduler : public util::Scheduler {
+    public:
+        bool is_on_thread() const noexcept override
+        {
+            return true;
+        }
+        bool is_same_as(const Scheduler* other) const noexcept override
+        {
+            return this == other;
+        }
+        bool can_deliver_notifications() const noexcept override
+        {
+            return true;
+        }
+        void set_notify_callback(std::function<void()> callback) override
+        {
+            m_callback = std::move(callback);
+        }
+        void notify() override
+        {
+            m_notified = true;
+        }
+        void run_until(std::function<bool()> predicate)
+        {
+            while (!predicate()) {
+                if (m_notified.exchange(false) && m_callback)
+                    m_callback();
+                else
+                    std::this_thread::yield();
+            }
+        }
+
+    private:
+        std::function<void()> m_callback;
+        std::atomic<bool> m_notified{false};
+    };
+
+    TestFile config;
+    config.cache = false;
+    config.schema_version = 0;
+    config.schema = Schema{
+        {"object", {{"value", PropertyType::Int}}},
+    };
+    auto scheduler = std::make_shared<ManualScheduler>();
+    config.scheduler = scheduler;
+    auto realm = Realm::get_shared_realm(config);
+    auto table = realm->read_group().get_table("class_object");
+    auto col = table->get_column_key("value");
+    // A scheduler notifies a single Realm
+    auto other_config = config;
+    other_config.scheduler = std::make_shared<ManualScheduler>();
+
+    SECTION("begin waits for the write lock without blocking") {
+        auto r2 = Realm::get_shared_realm(other_config);
+        r2->begin_transaction();
+        bool called = false;
+        realm->async_begin_transaction([&] {
+            REQUIRE(realm->is_in_transaction());
+            table->create_object().set(col, 2);
+            called = true;
+        });
+        REQUIRE_FALSE(realm->is_in_transaction());
+        r2->read_group().get_table("class_object")->create_object().set(col, 1);
+        r2->commit_transaction();
+        scheduler->run_until([&] {
+            return called;
+        });
+        realm->commit_transaction();
+        REQUIRE(table->size() == 2);
+    }
+
+    SECTION("commit completes once the changes are durable") {
+        realm->begin_transaction();
+        table->create_object().set(col, 1);
+        bool durable = false;
+        realm->async_commit_transaction([&](std::exception_ptr error) {
+            REQUIRE_FALSE(error);
+            durable = true;
+        });
+        REQUIRE_FALSE(realm->is_in_transaction());
+        scheduler->run_until([&] {
+            return durable;
+        });
+        realm->close();
+        realm = nullptr;
+
+        config.scheduler = nullptr;
+        auto r2 = Realm::get_shared_realm(config);
+        REQUIRE(r2->read_group().get_table("class_object")->size() == 1);
+    }
+
+    SECTION("chained async transactions") {
+        int remaining = 5;
+        std::function<void()> write = [&] {
+            table->create_object().set(col, remaining);
+            realm->async_commit_transaction([&](std::exception_ptr) {
+                if (--remaining > 0)
+                    realm->async_begin_transaction(write);
+            });
+        };
+        realm->async_begin_transaction(write);
+        scheduler->run_until([&] {
+            return remaining == 0;
+        });
+        REQUIRE(table->size() == 5);
+    }
+
+    SECTION("a closed Realm gives up its request") {
+        auto r2 = Realm::get_shared_realm(other_config);
+        r2->begin_transaction();
+        realm->async_begin_transaction([] {
+            FAIL("should not be called");
+        });
+        realm->close();
+        r2->cancel_transaction();
+        r2->begin_transaction();
+        r2->cancel_transaction();
+    }
+}
+
 TEST_CASE("SharedRealm: schema updating from external changes") {
     TestFile config;
     config.schema_version = 0;
@@ -1651,6 +1651,27 @@ TEST_CASE("notifications: results") {
             REQUIRE_INDICES(change.insertions, 0);
         }
 
+        SECTION("changes to most of the table are reported the same as a few changes") {
+            write([&] {
+                for (int i = 0; i < 500; ++i)
+                    table->create_object(ObjKey(100 + i)).set(col_value, i % 10);
+            });
+            REQUIRE(notification_calls == 2);
+            REQUIRE(change.insertions.count() == 450);
+            REQUIRE(results.size() == 454);
+
+            write([&] {
+                table->get_object(ObjKey(101)).set(col_value, 0);
+                table->create_object(ObjKey(99)).set(col_value, 1);
+                table->remove_object(object_keys[3]);
+            });
+            REQUIRE(notification_calls == 3);
+            REQUIRE_INDICES(change.deletions, 2, 4);
+            REQUIRE_INDICES(change.insertions, 3);
+            REQUIRE(results.size() == 453);
+            REQUIRE(results.get(3).get_key() == ObjKey(99));
+        }
+
         SECTION("modification to related table not included in query") {
             write([&] {
                 auto table = r->read_group().get_table("class_linked to object");
@@ -3154,6 +3175,66 @@ TEMPLATE_TEST_CASE("results: aggregate", "[query][aggregate]", ResultsFromTable,
     }
 }
 
+TEST_CASE("results: aggregate on a query", "[query][aggregate]") {
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object",
+         {
+             {"int", PropertyType::Int},
+             {"double", PropertyType::Double},
+             {"date", PropertyType::Date},
+         }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    ColKey col_int = table->get_column_key("int");
+    ColKey col_double = table->get_column_key("double");
+    ColKey col_date = table->get_column_key("date");
+
+    r->begin_transaction();
+    for (int i = 0; i < 10; ++i)
+        table->create_object().set_all(i, i * 1.5, Timestamp(i, 0));
+    r->commit_transaction();
+
+    Results results(r, table->where().greater(col_int, 2));
+
+    SECTION("is done without evaluating the query") {
+        REQUIRE(results.sum(col_int)->get_int() == 42);
+        REQUIRE(results.max(col_int)->get_int() == 9);
+        REQUIRE(results.min(col_double)->get_double() == 4.5);
+        REQUIRE(results.average(col_int)->get_double() == 6.0);
+        REQUIRE(results.get_mode() == Results::Mode::Query);
+    }
+
+    SECTION("ignores sorting") {
+        results = results.sort({{"int", false}});
+        REQUIRE(results.sum(col_int)->get_int() == 42);
+        REQUIRE(results.get_mode() == Results::Mode::Query);
+    }
+
+    SECTION("sees changes made after the Results was created") {
+        r->begin_transaction();
+        table->create_object().set_all(20, 0.0, Timestamp(20, 0));
+        r->commit_transaction();
+        REQUIRE(results.sum(col_int)->get_int() == 62);
+        REQUIRE(results.max(col_int)->get_int() == 20);
+    }
+
+    SECTION("evaluates the query when a limit applies") {
+        results = results.sort({{"int", false}}).limit(2);
+        REQUIRE(results.sum(col_int)->get_int() == 17);
+        REQUIRE(results.get_mode() == Results::Mode::TableView);
+    }
+
+    SECTION("evaluates the query for timestamps") {
+        REQUIRE(results.max(col_date)->get_timestamp() == Timestamp(9, 0));
+        REQUIRE(results.get_mode() == Results::Mode::TableView);
+    }
+}
+
 TEST_CASE("results: set property value on all objects", "[batch_updates]") {
     InMemoryTestFile config;
     config.automatic_change_notifications = false;
@@ -733,7 +733,7 @@ TEST_CASE("Schema") {
                                   {"data", PropertyType::Data},
                                   {"object", PropertyType::Object | PropertyType::Nullable, "object"},
                                   {"array", PropertyType::Array | PropertyType::Object, "object"},
-                                  {"set", PropertyType::Set | PropertyType::Int},
+                                  {"set", PropertyType::Set | PropertyType::Float},
                                   {"decimal", PropertyType::Decimal},
                               }}};
             for (auto& prop : schema.begin()->persisted_properties) {
@@ -755,6 +755,12 @@ TEST_CASE("Schema") {
                      {"date", PropertyType::Date, Property::IsPrimary{false}, Property::IsIndexed{true}},
                      {"object id", PropertyType::ObjectId, Property::IsPrimary{false}, Property::IsIndexed{true}},
                      {"uuid", PropertyType::UUID, Property::IsPrimary{false}, Property::IsIndexed{true}},
+                     {"int array", PropertyType::Array | PropertyType::Int, Property::IsPrimary{false},
+                      Property::IsIndexed{true}},
+                     {"string set", PropertyType::Set | PropertyType::String, Property::IsPrimary{false},
+                      Property::IsIndexed{true}},
+                     {"mixed dictionary", PropertyType::Dictionary | PropertyType::Mixed | PropertyType::Nullable,
+                      Property::IsPrimary{false}, Property::IsIndexed{true}},
                  }}};
             REQUIRE_NOTHROW(schema.validate());
         }
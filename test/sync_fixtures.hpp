@@ -421,6 +421,7 @@ public:
 
         long client_max_open_files = 64;
         long server_max_open_files = 64;
+        unsigned int server_num_worker_threads = 1;
 
         bool enable_server_ssl = false;
 
@@ -437,6 +438,12 @@ public:
 
         size_t max_download_size = 0x1000000; // 16 MB as in Server::Config
 
+        bool enable_download_bootstrap_cache = false;
+
+        size_t max_download_cache_size = 0x10000000; // 256 MB as in Server::Config
+
+        size_t max_integration_batch_size = 0x1000000; // 16 MB as in Client::Config
+
         bool one_connection_per_session = false;
 
         bool disable_upload_activation_delay = false;
@@ -511,6 +518,7 @@ public:
                 public_key = PKey::load_public(config.server_public_key_path);
             Server::Config config_2;
             config_2.max_open_files = config.server_max_open_files;
+            config_2.num_worker_threads = config.server_num_worker_threads;
             config_2.logger = &*m_server_loggers[i];
             config_2.token_expiration_clock = &m_fake_token_expiration_clock;
             config_2.metrics = config.server_metrics;
@@ -520,6 +528,8 @@ public:
             config_2.connection_reaper_timeout = config.server_connection_reaper_timeout;
             config_2.connection_reaper_interval = config.server_connection_reaper_interval;
             config_2.max_download_size = config.max_download_size;
+            config_2.enable_download_bootstrap_cache = config.enable_download_bootstrap_cache;
+            config_2.max_download_cache_size = config.max_download_cache_size;
             config_2.disable_download_compaction = config.disable_download_compaction;
             config_2.disable_history_compaction = config.disable_history_compaction;
             config_2.history_compaction_clock = config.history_compaction_clock;
@@ -550,6 +560,7 @@ public:
             config_2.tcp_no_delay = true;
             config_2.one_connection_per_session = config.one_connection_per_session;
             config_2.disable_upload_activation_delay = config.disable_upload_activation_delay;
+            config_2.max_integration_batch_size = config.max_integration_batch_size;
             m_clients[i] = std::make_unique<Client>(std::move(config_2));
         }
 
@@ -203,37 +203,6 @@ void fix_test_libexec_path(const char* argv_0)
 }
 */
 
-void fix_async_daemon_path()
-{
-// `setenv()` is POSIX. _WIN32 has `_putenv_s()` instead.
-#ifndef _WIN32
-    const char* async_daemon;
-    // When running the unit-tests in Xcode, it runs them
-    // in its own temporary directory. So we have to make sure we
-    // look for the daemon there
-    const char* xcode_env = getenv("__XCODE_BUILT_PRODUCTS_DIR_PATHS");
-    if (xcode_env) {
-#ifdef REALM_DEBUG
-        async_daemon = "realmd-dbg-noinst";
-#else
-        async_daemon = "realmd-noinst";
-#endif
-    }
-    else {
-#ifdef REALM_COVER
-        async_daemon = "../src/realm/realmd-cov-noinst";
-#else
-#ifdef REALM_DEBUG
-        async_daemon = "../src/realm/realmd-dbg-noinst";
-#else
-        async_daemon = "../src/realm/realmd-noinst";
-#endif
-#endif
-    }
-    setenv("REALM_ASYNC_DAEMON", async_daemon, 0);
-#endif // _WIN32
-}
-
 void set_random_seed()
 {
     // Select random seed for the random generator that some of our unit tests are using
@@ -309,7 +278,8 @@ void display_build_config()
 
     const char* cpu_sse = realm::sseavx<42>() ? "4.2" : (realm::sseavx<30>() ? "3.0" : "None");
 
-    const char* cpu_avx = realm::sseavx<1>() ? "Yes" : "No";
+    const char* cpu_avx = realm::sseavx<3>() ? "AVX-512"
+                                             : (realm::sseavx<2>() ? "AVX2" : (realm::sseavx<1>() ? "AVX1" : "None"));
 
     std::cout << std::endl
               << "Realm version: " << Version::get_version() << " with Debug " << with_debug << "\n"
@@ -326,7 +296,7 @@ void display_build_config()
               << "Compiler supported SSE (auto detect):       " << compiler_sse << "\n"
               << "This CPU supports SSE (auto detect):        " << cpu_sse << "\n"
               << "Compiler supported AVX (auto detect):       " << compiler_avx << "\n"
-              << "This CPU supports AVX (AVX1) (auto detect): " << cpu_avx << "\n"
+              << "This CPU supports AVX (auto detect):        " << cpu_avx << "\n"
               << "\n"
               << "Unit test random seed:                      " << unit_test_random_seed << "\n"
               << std::endl;
@@ -604,7 +574,6 @@ int test_all(int argc, char* argv[], util::Logger* logger, bool disable_all_sync
 
     fix_max_open_files();
     // fix_test_libexec_path(argv[0]);
-    fix_async_daemon_path();
 
     display_build_config();
 
@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <numeric>
 
 #include <realm/array.hpp>
 #include <realm/array_unsigned.hpp>
@@ -1006,6 +1007,165 @@ TEST(Array_find_sse)
 }
 
 
+namespace {
+template <class Cond>
+void check_find_all_widths(TestContext& test_context, Random& random)
+{
+    const int64_t bounds[] = {127, 32767, 2147483647LL, 9223372036854775807LL};
+    const size_t size = 300;
+    Cond cond;
+
+    for (int64_t bound : bounds) {
+        Array a(Allocator::get_default());
+        a.create(Array::type_Normal);
+        std::vector<int64_t> values;
+        int64_t needle = random.draw_int<int64_t>(-bound, bound);
+        for (size_t i = 0; i < size; ++i) {
+            int64_t v = random.chance(1, 4) ? needle : random.draw_int<int64_t>(-bound, bound);
+            a.add(v);
+            values.push_back(v);
+        }
+        // Make sure the leaf is packed at the width under test
+        a.add(bound);
+        values.push_back(bound);
+
+        for (size_t start = 0; start < 70; start += 3) {
+            for (size_t end = values.size(); end > values.size() - 70 && end > start; end -= 5) {
+                size_t expected_count = 0;
+                size_t expected_first = not_found;
+                for (size_t i = start; i < end; ++i) {
+                    if (cond(values[i], needle)) {
+                        if (expected_first == not_found)
+                            expected_first = i;
+                        ++expected_count;
+                    }
+                }
+
+                QueryState<int64_t> count_state(act_Count);
+                a.find<Cond>(act_Count, needle, start, end, 0, &count_state);
+                CHECK_EQUAL(expected_count, size_t(count_state.m_state));
+
+                QueryState<int64_t> first_state(act_ReturnFirst, 1);
+                a.find<Cond>(act_ReturnFirst, needle, start, end, 0, &first_state);
+                CHECK_EQUAL(expected_first, size_t(first_state.m_state));
+            }
+        }
+        a.destroy();
+    }
+}
+} // anonymous namespace
+
+// Exercises the vectorized (AVX2/SSE) finders for all conditions and widths, with unaligned start and end
+TEST(Array_FindAllWidths)
+{
+    Random random(random_int<unsigned long>());
+    check_find_all_widths<Equal>(test_context, random);
+    check_find_all_widths<NotEqual>(test_context, random);
+    check_find_all_widths<Greater>(test_context, random);
+    check_find_all_widths<Less>(test_context, random);
+}
+
+namespace {
+
+// Lowers the CPU features seen by the search to the given levels for its lifetime, so that each of the scalar,
+// SSE, AVX2, AVX-512 and NEON paths of Array::find() can be tested on a CPU that supports the next one
+class CpuFeatureOverride {
+public:
+    CpuFeatureOverride(signed char sse, signed char avx, signed char neon)
+        : m_sse(sse_support)
+        , m_avx(avx_support)
+        , m_neon(neon_support)
+    {
+        sse_support = std::min(sse, m_sse);
+        avx_support = std::min(avx, m_avx);
+        neon_support = std::min(neon, m_neon);
+    }
+    ~CpuFeatureOverride()
+    {
+        sse_support = m_sse;
+        avx_support = m_avx;
+        neon_support = m_neon;
+    }
+
+private:
+    const signed char m_sse;
+    const signed char m_avx;
+    const signed char m_neon;
+};
+
+} // anonymous namespace
+
+NONCONCURRENT_TEST(Array_FindAllWidthsEachPath)
+{
+    struct Path {
+        const char* name;
+        signed char sse, avx, neon;
+    };
+    const Path paths[] = {
+        {"scalar", -2, -1, -1}, {"SSE3", 0, -1, -1},    {"SSE4.2", 1, -1, -1},
+        {"AVX2", 1, 1, -1},     {"AVX-512", 1, 2, -1}, {"NEON", -2, -1, 1},
+    };
+    Random random(random_int<unsigned long>());
+    bool tested_neon = false;
+    for (const Path& path : paths) {
+        CpuFeatureOverride cpu(path.sse, path.avx, path.neon);
+        // Skip the paths that this CPU does not support
+        if (sse_support != path.sse || avx_support != path.avx || neon_support != path.neon)
+            continue;
+        test_context.logger.info("Testing the %1 path", path.name);
+        tested_neon = tested_neon || path.neon > 0;
+        check_find_all_widths<Equal>(test_context, random);
+        check_find_all_widths<NotEqual>(test_context, random);
+        check_find_all_widths<Greater>(test_context, random);
+        check_find_all_widths<Less>(test_context, random);
+    }
+#if defined(REALM_COMPILER_NEON)
+    // NEON is part of every AArch64 CPU, so its kernel must not be skipped there
+    CHECK(tested_neon);
+#else
+    CHECK_NOT(tested_neon);
+#endif
+}
+
+// Exercises the SSE minimum/maximum reductions for all widths, including the position of the first occurrence
+TEST(Array_MinMaxWidths)
+{
+    Random random(random_int<unsigned long>());
+    const int64_t bounds[] = {127, 32767, 2147483647LL, 9223372036854775807LL};
+    const size_t size = 300;
+
+    for (int64_t bound : bounds) {
+        Array a(Allocator::get_default());
+        a.create(Array::type_Normal);
+        std::vector<int64_t> values;
+        // Few distinct values, so that the extremes occur several times
+        for (size_t i = 0; i < size; ++i) {
+            int64_t v = random.draw_int<int64_t>(-8, 8) * (bound / 8);
+            a.add(v);
+            values.push_back(v);
+        }
+
+        for (size_t start = 0; start < 70; start += 3) {
+            for (size_t end = size; end > size - 70; end -= 5) {
+                auto max_it = std::max_element(values.begin() + start, values.begin() + end);
+                auto min_it = std::min_element(values.begin() + start, values.begin() + end);
+                int64_t result;
+                size_t ndx;
+                CHECK(a.maximum(result, start, end, &ndx));
+                CHECK_EQUAL(*max_it, result);
+                CHECK_EQUAL(size_t(max_it - values.begin()), ndx);
+                CHECK(a.minimum(result, start, end, &ndx));
+                CHECK_EQUAL(*min_it, result);
+                CHECK_EQUAL(size_t(min_it - values.begin()), ndx);
+                CHECK_EQUAL(std::accumulate(values.begin() + start, values.begin() + end, int64_t(0)),
+                            a.get_sum(start, end));
+            }
+        }
+
+        a.destroy();
+    }
+}
+
 TEST(Array_Greater)
 {
     Array a(Allocator::get_default());
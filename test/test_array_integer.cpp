@@ -18,11 +18,15 @@
 
 #include "testsettings.hpp"
 
+#include <algorithm>
 #include <limits>
+#include <numeric>
 
 #include <realm/array_integer.hpp>
 #include <realm/array_ref.hpp>
 #include <realm/column_integer.hpp>
+#include <realm/db.hpp>
+#include <realm/group.hpp>
 
 #include "test.hpp"
 
@@ -243,3 +247,370 @@ TEST(ArrayRef_Basic)
 
     a.destroy();
 }
+
+namespace {
+
+// Locate the leaf of column `col` in the first (and only) table of `g`. The
+// table must be small enough to fit in a single cluster.
+ref_type get_single_leaf_ref(const Group& g, ColKey col)
+{
+    Allocator& alloc = _impl::GroupFriend::get_alloc(g);
+    Array top(alloc);
+    top.init_from_ref(_impl::GroupFriend::get_top_ref(g));
+    Array tables(alloc);
+    tables.init_from_ref(top.get_as_ref(1));
+    Array table_top(alloc);
+    table_top.init_from_ref(tables.get_as_ref(0));
+    Array cluster(alloc);
+    cluster.init_from_ref(table_top.get_as_ref(2));
+    return cluster.get_as_ref(col.get_index().val + 1);
+}
+
+} // anonymous namespace
+
+TEST(ArrayInteger_FrameOfReference)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(path);
+    ColKey col_big, col_neg;
+    {
+        auto wt = db->start_write();
+        auto t = wt->add_table("table");
+        col_big = t->add_column(type_Int, "big");
+        col_neg = t->add_column(type_Int, "neg");
+        for (int64_t i = 0; i < 100; ++i)
+            t->create_object().set(col_big, 1000000000 + 3 * i).set(col_neg, -5000000 + 7 * i);
+        wt->commit();
+    }
+
+    auto check_leaves = [&](Allocator& alloc, const Group& g) {
+        ArrayInteger big(alloc);
+        big.init_from_ref(get_single_leaf_ref(g, col_big));
+        CHECK_EQUAL(Array::get_wtype_from_header(big.get_header()), Array::wtype_FrameOfReference);
+        CHECK_EQUAL(big.size(), 100);
+        CHECK_EQUAL(big.get(0), 1000000000);
+        CHECK_EQUAL(big.get(99), 1000000297);
+        CHECK_EQUAL(Array::get(big.get_header(), 42), 1000000126);
+        CHECK_EQUAL(big.find_first(1000000126), 42);
+        CHECK_EQUAL(big.find_first(1000000127), not_found);
+        CHECK_EQUAL(big.find_first(126), not_found);
+        CHECK_EQUAL(big.find_first<Greater>(1000000290), 97);
+        CHECK_EQUAL(big.find_first<Less>(1000000001), 0);
+        CHECK_EQUAL(big.find_first<Less>(0), not_found);
+        CHECK_EQUAL(big.find_first<Greater>(2000000000), not_found);
+        CHECK_EQUAL(big.count(1000000003), 1);
+        CHECK_EQUAL(big.get_sum(), 100 * int64_t(1000000000) + 3 * 4950);
+        CHECK_EQUAL(big.lower_bound_int(1000000004), 2);
+        CHECK_EQUAL(big.upper_bound_int(1000000003), 2);
+        CHECK_EQUAL(big.lower_bound_int(0), 0);
+        CHECK_EQUAL(big.upper_bound_int(std::numeric_limits<int64_t>::max()), 100);
+        int64_t res;
+        size_t ndx;
+        CHECK(big.maximum(res, 0, npos, &ndx));
+        CHECK_EQUAL(res, 1000000297);
+        CHECK_EQUAL(ndx, 99);
+        CHECK(big.minimum(res, 10, 20, &ndx));
+        CHECK_EQUAL(res, 1000000030);
+        CHECK_EQUAL(ndx, 10);
+
+        ArrayInteger neg(alloc);
+        neg.init_from_ref(get_single_leaf_ref(g, col_neg));
+        CHECK_EQUAL(Array::get_wtype_from_header(neg.get_header()), Array::wtype_FrameOfReference);
+        CHECK_EQUAL(neg.get(0), -5000000);
+        CHECK_EQUAL(neg.find_first(-4999993), 1);
+        CHECK_EQUAL(neg.find_first<Greater>(-5000000), 1);
+        CHECK_EQUAL(neg.get_sum(), -500000000 + 7 * 4950);
+    };
+
+    {
+        auto rt = db->start_read();
+        check_leaves(_impl::GroupFriend::get_alloc(*rt), *rt);
+        auto t = rt->get_table("table");
+        CHECK_EQUAL(t->where().greater(col_big, 1000000200).count(), 33);
+        CHECK_EQUAL(t->where().equal(col_neg, -4999986).find(), t->get_object(2).get_key());
+        CHECK_EQUAL(t->sum_int(col_big), 100 * int64_t(1000000000) + 3 * 4950);
+        CHECK_EQUAL(t->maximum_int(col_neg), -5000000 + 7 * 99);
+        CHECK_EQUAL(t->minimum_int(col_big), 1000000000);
+    }
+
+    // Modifying an encoded leaf decodes it, and the next commit encodes it again
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->get_object(5).set(col_big, 1000000015 + 1);
+        t->get_object(6).set(col_neg, -5020000);
+        CHECK_EQUAL(t->get_object(5).get<Int>(col_big), 1000000016);
+        CHECK_EQUAL(t->get_object(6).get<Int>(col_neg), -5020000);
+        CHECK_EQUAL(t->get_object(7).get<Int>(col_neg), -4999951);
+        CHECK_EQUAL(t->minimum_int(col_neg), -5020000);
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto t = rt->get_table("table");
+        Allocator& alloc = _impl::GroupFriend::get_alloc(*rt);
+        ArrayInteger neg(alloc);
+        neg.init_from_ref(get_single_leaf_ref(*rt, col_neg));
+        CHECK_EQUAL(Array::get_wtype_from_header(neg.get_header()), Array::wtype_FrameOfReference);
+        CHECK_EQUAL(neg.get(6), -5020000);
+        CHECK_EQUAL(neg.get(7), -4999951);
+        CHECK_EQUAL(t->get_object(5).get<Int>(col_big), 1000000016);
+        CHECK_EQUAL(t->minimum_int(col_neg), -5020000);
+    }
+}
+
+// Ascending leaves, such as timestamps and increasing ids, are stored as their
+// offsets from a line through the first and the last element if that needs
+// fewer bits than their offsets from the smallest element.
+TEST(ArrayInteger_DeltaEncoded)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(path);
+    const size_t n = 100;
+    std::vector<int64_t> times, ids, other;
+    for (size_t i = 0; i < n; ++i) {
+        times.push_back(1600000000000 + 1000 * int64_t(i) + int64_t(i * 37 % 50));
+        ids.push_back(5000000000 + int64_t(i / 2) * 10);
+        // A range of 64 bits, so this one is not encoded
+        other.push_back(i % 3 == 0 ? times[i] : (i % 2 ? std::numeric_limits<int64_t>::min() : times[i] + 1));
+    }
+    ColKey col_time, col_id, col_other;
+    {
+        auto wt = db->start_write();
+        auto t = wt->add_table("table");
+        col_time = t->add_column(type_Int, "time");
+        col_id = t->add_column(type_Int, "id");
+        col_other = t->add_column(type_Int, "other");
+        for (size_t i = 0; i < n; ++i)
+            t->create_object().set(col_time, times[i]).set(col_id, ids[i]).set(col_other, other[i]);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    Allocator& alloc = _impl::GroupFriend::get_alloc(*rt);
+    ArrayInteger time(alloc), id(alloc), oth(alloc);
+    time.init_from_ref(get_single_leaf_ref(*rt, col_time));
+    id.init_from_ref(get_single_leaf_ref(*rt, col_id));
+    oth.init_from_ref(get_single_leaf_ref(*rt, col_other));
+    CHECK_EQUAL(Array::get_wtype_from_header(time.get_header()), Array::wtype_FrameOfReference);
+    CHECK_NOT_EQUAL(Array::get_step_from_header(time.get_header()), 0);
+    // The offsets from the smallest element would need 32 bits, those from
+    // the line 8 bits
+    CHECK_EQUAL(Array::get_width_from_header(time.get_header()), 8);
+    CHECK_LESS(time.get_byte_size(), 8 + 4 * n);
+    CHECK_EQUAL(Array::get_wtype_from_header(id.get_header()), Array::wtype_FrameOfReference);
+    CHECK_NOT_EQUAL(Array::get_step_from_header(id.get_header()), 0);
+    CHECK_EQUAL(Array::get_wtype_from_header(oth.get_header()), Array::wtype_Bits);
+
+    auto check_leaf = [&](const ArrayInteger& leaf, const std::vector<int64_t>& values) {
+        for (size_t i = 0; i < n; ++i) {
+            CHECK_EQUAL(leaf.get(i), values[i]);
+            CHECK_EQUAL(Array::get(leaf.get_header(), i), values[i]);
+        }
+        auto two = Array::get_two(leaf.get_header(), 41);
+        CHECK_EQUAL(two.first, values[41]);
+        CHECK_EQUAL(two.second, values[42]);
+        int64_t chunk[8];
+        leaf.get_chunk(90, chunk);
+        for (size_t i = 0; i < 8; ++i)
+            CHECK_EQUAL(chunk[i], values[90 + i]);
+
+        auto check_find = [&](auto cond, int64_t needle, size_t start, size_t end) {
+            using Cond = decltype(cond);
+            size_t expected_count = 0;
+            size_t expected_first = not_found;
+            for (size_t i = start; i < end; ++i) {
+                if (cond(values[i], needle)) {
+                    if (expected_first == not_found)
+                        expected_first = i;
+                    ++expected_count;
+                }
+            }
+            QueryState<int64_t> count_state(act_Count);
+            leaf.find<Cond>(act_Count, needle, start, end, 0, &count_state);
+            CHECK_EQUAL(size_t(count_state.m_state), expected_count);
+            QueryState<int64_t> first_state(act_ReturnFirst, 1);
+            leaf.find<Cond>(act_ReturnFirst, needle, start, end, 0, &first_state);
+            CHECK_EQUAL(size_t(first_state.m_state), expected_first);
+        };
+        std::vector<int64_t> needles = {std::numeric_limits<int64_t>::min(), 0, values[0] - 1, values[n - 1] + 1,
+                                        std::numeric_limits<int64_t>::max()};
+        for (size_t i = 0; i < n; i += 7) {
+            needles.push_back(values[i]);
+            needles.push_back(values[i] + 1);
+        }
+        for (int64_t needle : needles) {
+            for (auto range : {std::make_pair(size_t(0), n), std::make_pair(size_t(13), size_t(78))}) {
+                check_find(Equal(), needle, range.first, range.second);
+                check_find(NotEqual(), needle, range.first, range.second);
+                check_find(Greater(), needle, range.first, range.second);
+                check_find(Less(), needle, range.first, range.second);
+            }
+            CHECK_EQUAL(leaf.count(needle), size_t(std::count(values.begin(), values.end(), needle)));
+            CHECK_EQUAL(leaf.lower_bound_int(needle),
+                        size_t(std::lower_bound(values.begin(), values.end(), needle) - values.begin()));
+            CHECK_EQUAL(leaf.upper_bound_int(needle),
+                        size_t(std::upper_bound(values.begin(), values.end(), needle) - values.begin()));
+        }
+
+        CHECK_EQUAL(leaf.get_sum(), std::accumulate(values.begin(), values.end(), int64_t(0)));
+        CHECK_EQUAL(leaf.get_sum(13, 78), std::accumulate(values.begin() + 13, values.begin() + 78, int64_t(0)));
+        CHECK_EQUAL(leaf.get_sum(20, 20), 0);
+        int64_t res;
+        size_t ndx;
+        CHECK(leaf.maximum(res, 0, npos, &ndx));
+        CHECK_EQUAL(res, values[n - 1]);
+        CHECK_EQUAL(ndx, size_t(std::find(values.begin(), values.end(), res) - values.begin()));
+        CHECK(leaf.minimum(res, 13, 78, &ndx));
+        CHECK_EQUAL(res, values[13]);
+        CHECK_EQUAL(ndx, 13);
+        CHECK(leaf.maximum(res, 13, 78, &ndx));
+        CHECK_EQUAL(res, values[77]);
+        CHECK_EQUAL(ndx, size_t(std::find(values.begin(), values.end(), res) - values.begin()));
+        CHECK_NOT(leaf.maximum(res, 20, 20));
+    };
+    check_leaf(time, times);
+    check_leaf(id, ids);
+
+    // Comparing with another leaf, in either direction
+    using Callback = bool (*)(int64_t);
+    QueryState<int64_t> equal_state(act_Count);
+    time.compare_leafs<Equal, act_Count, Callback>(&oth, 0, n, 0, &equal_state, nullptr);
+    CHECK_EQUAL(equal_state.m_state, 34);
+    QueryState<int64_t> greater_state(act_Count);
+    oth.compare_leafs<Greater, act_Count, Callback>(&time, 0, n, 0, &greater_state, nullptr);
+    CHECK_EQUAL(greater_state.m_state, 33);
+
+    auto t = rt->get_table("table");
+    CHECK_EQUAL(t->where().greater(col_time, times[50]).count(), 49);
+    CHECK_EQUAL(t->where().equal(col_id, ids[31]).count(), 2);
+    CHECK_EQUAL(t->where().not_equal(col_id, ids[31]).count(), 98);
+    CHECK_EQUAL(t->where().equal(col_time, col_other).count(), 34);
+    CHECK_EQUAL(t->maximum_int(col_time), times[n - 1]);
+    CHECK_EQUAL(t->sum_int(col_id), std::accumulate(ids.begin(), ids.end(), int64_t(0)));
+
+    // Modifying a leaf decodes it. It is no longer ascending, so it is then
+    // encoded without a step.
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->get_object(10).set(col_time, times[90]);
+        times[10] = times[90];
+        CHECK_EQUAL(t->get_object(10).get<Int>(col_time), times[90]);
+        CHECK_EQUAL(t->get_object(11).get<Int>(col_time), times[11]);
+        CHECK_EQUAL(t->where().equal(col_time, times[90]).count(), 2);
+        wt->commit();
+    }
+    rt = db->start_read();
+    time.init_from_ref(get_single_leaf_ref(*rt, col_time));
+    CHECK_EQUAL(Array::get_wtype_from_header(time.get_header()), Array::wtype_FrameOfReference);
+    CHECK_EQUAL(Array::get_step_from_header(time.get_header()), 0);
+    for (size_t i = 0; i < n; ++i)
+        CHECK_EQUAL(time.get(i), times[i]);
+}
+
+// A leaf written unencoded, because its range needed 64 bits, is encoded by a
+// later commit once its range fits, also after copying it from the file.
+TEST(ArrayInteger_FrameOfReferenceAfterReopen)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    ColKey col;
+    {
+        DBRef db = DB::create(path);
+        auto wt = db->start_write();
+        auto t = wt->add_table("table");
+        col = t->add_column(type_Int, "int");
+        for (int64_t i = 0; i < 100; ++i)
+            t->create_object().set(col, i);
+        // The range of the leaf needs more than 32 bits
+        t->get_object(99).set(col, int64_t(1) << 40);
+        wt->commit();
+
+        auto rt = db->start_read();
+        ArrayInteger leaf(_impl::GroupFriend::get_alloc(*rt));
+        leaf.init_from_ref(get_single_leaf_ref(*rt, col));
+        CHECK_EQUAL(Array::get_wtype_from_header(leaf.get_header()), Array::wtype_Bits);
+    }
+    {
+        DBRef db = DB::create(path);
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->get_object(99).set(col, 99);
+        wt->commit();
+
+        auto rt = db->start_read();
+        ArrayInteger leaf(_impl::GroupFriend::get_alloc(*rt));
+        leaf.init_from_ref(get_single_leaf_ref(*rt, col));
+        CHECK_EQUAL(Array::get_wtype_from_header(leaf.get_header()), Array::wtype_FrameOfReference);
+        CHECK_EQUAL(leaf.get(99), 99);
+        CHECK_EQUAL(rt->get_table("table")->sum_int(col), 4950);
+    }
+    {
+        // Erasing from a leaf copied from the file marks it as well
+        DBRef db = DB::create(path);
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->get_object(99).set(col, int64_t(1) << 40);
+        wt->commit();
+        wt = db->start_write();
+        t = wt->get_table("table");
+        t->get_object(99).remove();
+        wt->commit();
+
+        auto rt = db->start_read();
+        ArrayInteger leaf(_impl::GroupFriend::get_alloc(*rt));
+        leaf.init_from_ref(get_single_leaf_ref(*rt, col));
+        CHECK_EQUAL(Array::get_wtype_from_header(leaf.get_header()), Array::wtype_FrameOfReference);
+        CHECK_EQUAL(leaf.size(), 99);
+    }
+}
+
+// Only the leaves of non-nullable integer columns are encoded, and only if that
+// makes them smaller
+TEST(ArrayInteger_FrameOfReferenceByType)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(path);
+    ColKey col_int, col_small, col_null, col_link;
+    {
+        auto wt = db->start_write();
+        auto target = wt->add_table("target");
+        auto t = wt->add_table("table");
+        col_int = t->add_column(type_Int, "int");
+        col_small = t->add_column(type_Int, "small");
+        col_null = t->add_column(type_Int, "null", true);
+        col_link = t->add_column(*target, "link");
+        for (int64_t i = 0; i < 100; ++i) {
+            ObjKey target_key = target->create_object().get_key();
+            t->create_object()
+                .set(col_int, 1000000000 + i)
+                .set(col_small, i % 8)
+                .set(col_null, 1000000000 + i)
+                .set(col_link, target_key);
+        }
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    Allocator& alloc = _impl::GroupFriend::get_alloc(*rt);
+    Array top(alloc);
+    top.init_from_ref(_impl::GroupFriend::get_top_ref(*rt));
+    Array tables(alloc);
+    tables.init_from_ref(top.get_as_ref(1));
+    Array table_top(alloc);
+    table_top.init_from_ref(tables.get_as_ref(1));
+    Array cluster(alloc);
+    cluster.init_from_ref(table_top.get_as_ref(2));
+    auto wtype_of = [&](ColKey col) {
+        return Array::get_wtype_from_header(alloc.translate(cluster.get_as_ref(col.get_index().val + 1)));
+    };
+    CHECK_EQUAL(wtype_of(col_int), Array::wtype_FrameOfReference);
+    CHECK_EQUAL(wtype_of(col_small), Array::wtype_Bits);
+    CHECK_EQUAL(wtype_of(col_null), Array::wtype_Bits);
+    CHECK_EQUAL(wtype_of(col_link), Array::wtype_Bits);
+
+    auto t = rt->get_table("table");
+    CHECK_EQUAL(t->sum_int(col_int), 100 * int64_t(1000000000) + 4950);
+    CHECK_EQUAL(t->sum_int(col_null), 100 * int64_t(1000000000) + 4950);
+    CHECK_EQUAL(t->get_object(42).get<ObjKey>(col_link), rt->get_table("target")->get_object(42).get_key());
+}
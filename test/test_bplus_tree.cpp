@@ -477,4 +477,48 @@ TEST(BPlusTree_LeafCache)
     tree.destroy();
 }
 
+TEST(BPlusTree_PartitionPoint)
+{
+    BPlusTree<Int> tree(Allocator::get_default());
+    tree.create();
+    std::vector<Int> values;
+
+    auto check = [&](size_t begin, size_t end, Int threshold) {
+        auto pred = [threshold](Int v) {
+            return v < threshold;
+        };
+        size_t expected = std::partition_point(values.begin() + begin, values.begin() + end, pred) - values.begin();
+        CHECK_EQUAL(tree.partition_point(begin, end, pred), expected);
+    };
+
+    // Empty tree
+    check(0, 0, 0);
+
+    // A single leaf, then values spread over many leafs, with runs of equal
+    // values crossing leaf boundaries
+    for (size_t size : {size_t(10), size_t(5000)}) {
+        while (values.size() < size) {
+            Int v = Int(values.size() / 7);
+            tree.add(v);
+            values.push_back(v);
+        }
+        for (size_t begin = 0; begin < size; begin += size / 10 + 1) {
+            for (size_t end = begin; end <= size; end += size / 7 + 1) {
+                // Including empty ranges
+                for (Int threshold : {Int(-1), Int(0), Int(3), Int(99), Int(143), Int(500), Int(714), Int(10000)})
+                    check(begin, end, threshold);
+            }
+            check(begin, size, Int(values[begin]));
+            check(begin, size, Int(values[size - 1]));
+            check(begin, size, Int(values[size - 1] + 1));
+        }
+    }
+
+    // Starting with a leaf cached by another access
+    CHECK_EQUAL(tree.get(4500), values[4500]);
+    check(0, 5000, values[100]);
+    check(4000, 5000, values[4600]);
+    tree.destroy();
+}
+
 #endif // TEST_BPLUS_TREE
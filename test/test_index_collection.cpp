@@ -0,0 +1,345 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_COLLECTION
+
+#include <realm.hpp>
+#include <realm/index_collection.hpp>
+#include <realm/history.hpp>
+
+#include "test.hpp"
+#include "util/check_index_results.hpp"
+#include "util/check_logic_error.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+TEST(IndexCollection_AddRemove)
+{
+    Group g;
+    auto target = g.add_table("target");
+    auto table = g.add_table("foo");
+    auto col_list = table->add_column_list(type_Int, "list", true);
+    auto col_set = table->add_column_set(type_String, "set");
+    auto col_dict = table->add_column_dictionary(type_Mixed, "dict");
+    auto col_double_list = table->add_column_list(type_Double, "double list");
+    auto col_mixed_list = table->add_column_list(type_Mixed, "mixed list");
+    auto col_link_list = table->add_column_list(*target, "link list");
+    auto col_link_dict = table->add_column_dictionary(*target, "link dict");
+
+    table->create_object().get_list<util::Optional<Int>>(col_list).add(5);
+    table->add_search_index(col_list);
+    table->add_search_index(col_set);
+    table->add_search_index(col_dict);
+    CHECK(table->has_search_index(col_list));
+    CHECK(table->search_index_type(col_set) == IndexType::General);
+    CHECK(table->get_collection_index(col_dict));
+    CHECK_NOT(table->get_search_index(col_list));
+    CHECK_EQUAL(table->get_collection_index(col_list)->size(), 1);
+    table->add_search_index(col_list);
+
+    CHECK_LOGIC_ERROR(table->add_search_index(col_list, IndexType::Ordered), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table->add_search_index(col_double_list), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table->add_search_index(col_mixed_list), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table->add_search_index(col_link_list), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table->add_search_index(col_link_dict), LogicError::illegal_combination);
+
+    table->remove_search_index(col_list);
+    CHECK_NOT(table->has_search_index(col_list));
+    CHECK_NOT(table->get_collection_index(col_list));
+    CHECK(table->has_search_index(col_set));
+
+    // Removing a column removes its index
+    table->remove_column(col_set);
+    CHECK(table->has_search_index(col_dict));
+    table->get_collection_index(col_dict)->verify();
+}
+
+TEST(IndexCollection_Maintenance)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col_list = table->add_column_list(type_String, "list", true);
+    auto col_set = table->add_column_set(type_Int, "set");
+    table->add_search_index(col_list);
+    table->add_search_index(col_set);
+    auto list_index = table->get_collection_index(col_list);
+    auto set_index = table->get_collection_index(col_set);
+
+    auto obj1 = table->create_object();
+    auto obj2 = table->create_object();
+    auto list1 = obj1.get_list<String>(col_list);
+    auto list2 = obj2.get_list<String>(col_list);
+    list1.add("b");
+    list1.add("a");
+    list1.add("b");
+    list2.add("a");
+    list2.add(StringData());
+    CHECK_EQUAL(list_index->size(), 4);
+    CHECK(list_index->get_value(0).is_null());
+    CHECK_EQUAL(list_index->get_value(1), Mixed("a"));
+    CHECK_EQUAL(list_index->get_key(1), obj1.get_key());
+    CHECK_EQUAL(list_index->get_key(2), obj2.get_key());
+    CHECK_EQUAL(list_index->get_value(3), Mixed("b"));
+    CHECK_EQUAL(list_index->get_count(3), 2);
+
+    list1.set(0, "c");
+    CHECK_EQUAL(list_index->get_count(3), 1);
+    list1.move(0, 2);
+    list1.swap(0, 1);
+    list2.remove(0);
+    list_index->verify();
+    CHECK_EQUAL(list_index->size(), 4);
+    std::vector<ObjKey> found;
+    list_index->find_all(found, "a");
+    CHECK_EQUAL(found.size(), 1);
+    CHECK_EQUAL(found[0], obj1.get_key());
+    found.clear();
+    list_index->find_all(found, Mixed());
+    CHECK_EQUAL(found.size(), 1);
+    CHECK_EQUAL(found[0], obj2.get_key());
+
+    list1.clear();
+    CHECK_EQUAL(list_index->size(), 1);
+
+    auto set1 = obj1.get_set<Int>(col_set);
+    auto set2 = obj2.get_set<Int>(col_set);
+    for (int64_t i = 0; i < 10; ++i) {
+        set1.insert(i);
+        set2.insert(i * 2);
+    }
+    set1.insert(3);
+    CHECK_EQUAL(set_index->size(), 20);
+    set1.erase(4);
+    set2.erase(5);
+    CHECK_EQUAL(set_index->size(), 19);
+    found.clear();
+    set_index->find_all(found, 4);
+    CHECK_EQUAL(found.size(), 1);
+    CHECK_EQUAL(found[0], obj2.get_key());
+
+    // Removing an object removes its entries
+    obj2.remove();
+    CHECK_EQUAL(set_index->size(), 9);
+    CHECK_EQUAL(list_index->size(), 0);
+    set_index->verify();
+
+    table->clear();
+    CHECK_EQUAL(set_index->size(), 0);
+}
+
+TEST(IndexCollection_Dictionary)
+{
+    Group g;
+    auto target = g.add_table("target");
+    auto table = g.add_table("foo");
+    auto col_dict = table->add_column_dictionary(type_Mixed, "dict");
+    table->add_search_index(col_dict);
+    auto index = table->get_collection_index(col_dict);
+    auto target_obj = target->create_object();
+
+    auto obj1 = table->create_object();
+    auto obj2 = table->create_object();
+    auto dict1 = obj1.get_dictionary(col_dict);
+    auto dict2 = obj2.get_dictionary(col_dict);
+    dict1.insert("a", 1);
+    dict1.insert("b", false);
+    dict1.insert("c", "str");
+    dict1.insert("d", target_obj.get_link());
+    dict2.insert("a", 1);
+    dict2.insert("b", 1);
+    // Links are not indexed
+    CHECK_EQUAL(index->size(), 4);
+    std::vector<ObjKey> found;
+    index->find_all(found, 1);
+    CHECK_EQUAL(found.size(), 2);
+    found.clear();
+    index->find_all(found, false);
+    CHECK_EQUAL(found.size(), 1);
+
+    dict1.insert("a", 2);
+    dict2.erase("b");
+    dict2["e"];
+    index->verify();
+    found.clear();
+    index->find_all(found, 1);
+    CHECK_EQUAL(found.size(), 1);
+    CHECK_EQUAL(found[0], obj2.get_key());
+    found.clear();
+    index->find_all(found, Mixed());
+    CHECK_EQUAL(found.size(), 1);
+
+    // A removed target nullifies the link, which is then indexed
+    target_obj.remove();
+    found.clear();
+    index->find_all(found, Mixed());
+    CHECK_EQUAL(found.size(), 2);
+
+    dict1.clear();
+    obj2.remove();
+    CHECK_EQUAL(index->size(), 0);
+}
+
+TEST(IndexCollection_Persistence)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist);
+    ColKey col_list, col_dict;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("foo");
+        col_list = table->add_column_list(type_Timestamp, "list");
+        col_dict = table->add_column_dictionary(type_String, "dict", type_String);
+        table->add_search_index(col_list);
+        for (int i = 0; i < 100; ++i) {
+            auto obj = table->create_object();
+            obj.get_list<Timestamp>(col_list).add(Timestamp(i % 10, 0));
+            obj.get_dictionary(col_dict).insert("key", util::to_string(i % 7));
+        }
+        table->add_search_index(col_dict);
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK(table->has_search_index(col_list));
+        CHECK_EQUAL(table->get_collection_index(col_list)->size(), 100);
+        CHECK_EQUAL(table->get_collection_index(col_dict)->size(), 100);
+        CHECK_EQUAL((table->column<Lst<Timestamp>>(col_list) == Timestamp(3, 0)).count(), 10);
+        table->get_collection_index(col_list)->verify();
+    }
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("foo");
+        table->remove_object(table->begin());
+        table->remove_search_index(col_list);
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK_NOT(table->has_search_index(col_list));
+        CHECK_EQUAL(table->get_collection_index(col_dict)->size(), 99);
+        CHECK_EQUAL((table->column<Dictionary>(col_dict) == StringData("3")).count(), 14);
+    }
+}
+
+TEST(IndexCollection_Query)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Group g;
+    auto origin = g.add_table("origin");
+    auto table = g.add_table("foo");
+    auto col_ints = table->add_column_list(type_Int, "ints", true);
+    auto col_strings = table->add_column_list(type_String, "strings");
+    auto col_set = table->add_column_set(type_ObjectId, "set");
+    auto col_dict = table->add_column_dictionary(type_Mixed, "dict");
+    auto col_link = origin->add_column(*table, "link");
+    const char* strings[] = {"a", "b", "c", "d"};
+    ObjectId ids[] = {ObjectId::gen(), ObjectId::gen(), ObjectId::gen()};
+
+    for (int i = 0; i < 500; ++i) {
+        auto obj = table->create_object();
+        auto ints = obj.get_list<util::Optional<Int>>(col_ints);
+        auto strs = obj.get_list<String>(col_strings);
+        auto set = obj.get_set<ObjectId>(col_set);
+        auto dict = obj.get_dictionary(col_dict);
+        size_t n = random.draw_int_mod(5);
+        for (size_t j = 0; j < n; ++j) {
+            if (random.draw_int_mod(10) == 0)
+                ints.add(util::none);
+            else
+                ints.add(random.draw_int<int64_t>(0, 20));
+            strs.add(strings[random.draw_int_mod(4)]);
+            set.insert(ids[random.draw_int_mod(3)]);
+            switch (random.draw_int_mod(4)) {
+                case 0:
+                    dict.insert(util::to_string(j), random.draw_int<int64_t>(0, 5));
+                    break;
+                case 1:
+                    dict.insert(util::to_string(j), double(random.draw_int<int64_t>(0, 5)));
+                    break;
+                case 2:
+                    dict.insert(util::to_string(j), strings[random.draw_int_mod(4)]);
+                    break;
+                default:
+                    dict.insert(util::to_string(j), Mixed());
+                    break;
+            }
+        }
+        origin->create_object().set(col_link, obj.get_key());
+    }
+    for (auto col : {col_ints, col_strings, col_set, col_dict})
+        table->add_search_index(col);
+
+    for (int64_t v : {-1, 0, 7, 20}) {
+        check_same_result(test_context, *table, col_ints, table->column<Lst<Int>>(col_ints) == v);
+        check_same_result(test_context, *table, col_ints, origin->link(col_link).column<Lst<Int>>(col_ints) == v);
+        check_same_result(test_context, *table, col_dict, table->column<Dictionary>(col_dict) == v);
+        check_same_result(test_context, *table, col_dict, table->column<Dictionary>(col_dict) == double(v));
+        check_same_result(test_context, *table, col_dict,
+                          origin->link(col_link).column<Dictionary>(col_dict) == v);
+    }
+    check_same_result(test_context, *table, col_ints, table->column<Lst<Int>>(col_ints) == null());
+    check_same_result(test_context, *table, col_dict, table->column<Dictionary>(col_dict) == null());
+    for (const char* str : strings) {
+        check_same_result(test_context, *table, col_strings, table->column<Lst<String>>(col_strings) == str);
+        check_same_result(test_context, *table, col_strings,
+                          table->column<Lst<String>>(col_strings) == str ||
+                              table->column<Lst<String>>(col_strings) == "x");
+        check_same_result(test_context, *table, col_dict, table->column<Dictionary>(col_dict) == StringData(str));
+    }
+    for (auto& id : ids)
+        check_same_result(test_context, *table, col_set, table->column<Lst<ObjectId>>(col_set) == id);
+    // The key of a dictionary is not covered by the index
+    check_same_result(test_context, *table, col_dict, table->column<Dictionary>(col_dict).key("0") == 3);
+}
+
+#endif // TEST_INDEX_COLLECTION
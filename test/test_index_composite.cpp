@@ -0,0 +1,310 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_COMPOSITE
+
+#include <realm.hpp>
+#include <realm/index_composite.hpp>
+#include <realm/history.hpp>
+
+#include "test.hpp"
+#include "util/check_index_results.hpp"
+#include "util/check_logic_error.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+TEST(IndexComposite_AddRemove)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_str = table->add_column(type_String, "str");
+    auto col_bool = table->add_column(type_Bool, "bool");
+    auto col_double = table->add_column(type_Double, "double");
+    auto col_list = table->add_column_list(type_Int, "list");
+
+    CHECK_NOT(table->has_composite_index({col_int, col_str}));
+    table->add_composite_index({col_int, col_str});
+    CHECK(table->has_composite_index({col_int, col_str}));
+    CHECK_NOT(table->has_composite_index({col_str, col_int}));
+    table->add_composite_index({col_int, col_str});
+    table->add_composite_index({col_str, col_bool, col_int});
+    CHECK_EQUAL(table->get_composite_indexes().size(), 2);
+
+    table->remove_composite_index({col_int, col_str});
+    CHECK_NOT(table->has_composite_index({col_int, col_str}));
+    CHECK(table->has_composite_index({col_str, col_bool, col_int}));
+    table->remove_composite_index({col_int, col_str});
+
+    // Removing a column removes the indexes including it
+    table->add_composite_index({col_int, col_bool});
+    table->remove_column(col_str);
+    CHECK_EQUAL(table->get_composite_indexes().size(), 1);
+    CHECK(table->has_composite_index({col_int, col_bool}));
+
+    CHECK_LOGIC_ERROR(table->add_composite_index({col_int}), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table->add_composite_index({col_int, col_int}), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table->add_composite_index({col_int, col_double}), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table->add_composite_index({col_int, col_list}), LogicError::illegal_combination);
+}
+
+TEST(IndexComposite_Maintenance)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col_a = table->add_column(type_Int, "a", true);
+    auto col_b = table->add_column(type_String, "b", true);
+    table->add_composite_index({col_a, col_b});
+    auto index = table->get_composite_index({col_a, col_b});
+
+    std::vector<ObjKey> keys;
+    for (int64_t i = 0; i < 10; ++i)
+        keys.push_back(table->create_object().set(col_a, i % 3).set(col_b, i % 2 ? "odd" : "even").get_key());
+    CHECK_EQUAL(index->size(), 10);
+    CHECK_EQUAL(index->get_value(0, 0), Mixed(0));
+    CHECK_EQUAL(index->get_value(0, 1), Mixed("even"));
+    CHECK_EQUAL(index->get_key(0), keys[0]);
+
+    table->get_object(keys[0]).set(col_b, "odd");
+    table->get_object(keys[1]).set_null(col_a);
+    table->get_object(keys[2]).add_int(col_a, -4);
+    table->remove_object(keys[3]);
+    index->verify();
+
+    CHECK_EQUAL(index->size(), 9);
+    CHECK(index->get_value(0, 0).is_null());
+    CHECK_EQUAL(index->get_key(0), keys[1]);
+    CHECK_EQUAL(index->get_value(1, 0), Mixed(-2));
+    CHECK_EQUAL(index->get_key(1), keys[2]);
+
+    std::vector<ObjKey> found;
+    index->find_all(found, {Mixed(0)});
+    CHECK_EQUAL(found.size(), 3);
+    found.clear();
+    index->find_all(found, {Mixed(0), Mixed("odd")});
+    CHECK_EQUAL(found.size(), 2);
+    CHECK_EQUAL(found[0], keys[0]);
+    found.clear();
+    index->find_all(found, {Mixed(1)}, CompositeIndex::Condition::Greater, Mixed("even"));
+    CHECK_EQUAL(found.size(), 1);
+    CHECK_EQUAL(found[0], keys[7]);
+
+    // Making the column non-nullable replaces its key, and the composite index
+    // over it is rebuilt over the new column with all objects
+    auto new_col_a = table->set_nullability(col_a, false, false);
+    CHECK(table->has_composite_index({new_col_a, col_b}));
+    CHECK_EQUAL(table->get_composite_index({new_col_a, col_b})->size(), 9);
+
+    table->clear();
+    CHECK_EQUAL(table->get_composite_index({new_col_a, col_b})->size(), 0);
+}
+
+TEST(IndexComposite_Persistence)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist);
+    ColKey col_a, col_b;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("foo");
+        col_a = table->add_column(type_Int, "a");
+        col_b = table->add_column(type_Timestamp, "b");
+        table->add_composite_index({col_a, col_b});
+        for (int i = 0; i < 100; ++i)
+            table->create_object().set(col_a, i % 10).set(col_b, Timestamp((i * 37) % 100, 0));
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK(table->has_composite_index({col_a, col_b}));
+        auto index = table->get_composite_index({col_a, col_b});
+        CHECK_EQUAL(index->size(), 100);
+        for (size_t i = 1; i < 100; ++i)
+            CHECK_LESS_EQUAL(index->get_value(i - 1, 0).get_int(), index->get_value(i, 0).get_int());
+        index->verify();
+    }
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("foo");
+        table->remove_object(table->begin());
+        table->add_composite_index({col_b, col_a});
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK_EQUAL(table->get_composite_indexes().size(), 2);
+        CHECK_EQUAL(table->get_composite_index({col_a, col_b})->size(), 99);
+        CHECK_EQUAL(table->get_composite_index({col_b, col_a})->size(), 99);
+        table->get_composite_index({col_b, col_a})->verify();
+    }
+}
+
+TEST(IndexComposite_AccessorReuse)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist);
+    ColKey col_a, col_b, col_c;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("foo");
+        col_a = table->add_column(type_Int, "a");
+        col_b = table->add_column(type_Int, "b");
+        col_c = table->add_column(type_String, "c");
+        table->add_composite_index({col_a, col_b});
+        table->add_composite_index({col_a, col_c});
+        for (int i = 0; i < 10; ++i)
+            table->create_object().set(col_a, i).set(col_b, i).set(col_c, "foo");
+        wt->commit();
+    }
+    auto rt = db->start_read();
+    auto table = rt->get_table("foo");
+    const CompositeIndex* index_ac = table->get_composite_index({col_a, col_c});
+
+    // Only the index over the modified column is changed, so the accessor of
+    // the other one is kept
+    {
+        auto wt = db->start_write();
+        wt->get_table("foo")->begin()->set(col_b, 100);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->get_composite_index({col_a, col_c}), index_ac);
+    CHECK_EQUAL(table->get_composite_index({col_a, col_b})->get_value(0, 1), Mixed(100));
+
+    // Also when it has moved to another position
+    {
+        auto wt = db->start_write();
+        wt->get_table("foo")->remove_composite_index({col_a, col_b});
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->get_composite_indexes().size(), 1);
+    CHECK_EQUAL(table->get_composite_index({col_a, col_c}), index_ac);
+    index_ac->verify();
+
+    {
+        auto wt = db->start_write();
+        wt->get_table("foo")->begin()->set(col_c, "bar");
+        wt->commit();
+    }
+    rt->advance_read();
+    auto index = table->get_composite_index({col_a, col_c});
+    CHECK_EQUAL(index->get_value(0, 1), Mixed("bar"));
+    index->verify();
+}
+
+TEST(IndexComposite_Query)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Group g;
+    auto table = g.add_table("foo");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_str = table->add_column(type_String, "str", true);
+    auto col_bool = table->add_column(type_Bool, "bool");
+    auto col_ts = table->add_column(type_Timestamp, "ts", true);
+    auto col_val = table->add_column(type_Int, "val");
+    const char* strings[] = {"a", "b", "c", "d"};
+
+    for (int i = 0; i < 2000; ++i) {
+        auto obj = table->create_object();
+        obj.set(col_int, random.draw_int<int64_t>(0, 9));
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_str, strings[random.draw_int_mod(4)]);
+        obj.set(col_bool, random.draw_bool());
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 100), 0));
+        obj.set(col_val, i);
+    }
+    std::vector<ColKey> columns{col_int, col_str, col_bool, col_ts};
+    table->add_composite_index(columns);
+
+    for (int64_t v : {-1, 0, 5, 9}) {
+        check_same_result(test_context, *table, columns, table->where().equal(col_int, v).equal(col_str, "b"),
+                          col_val);
+        check_same_result(test_context, *table, columns, table->where().equal(col_str, "c").equal(col_int, v),
+                          col_val);
+        check_same_result(test_context, *table, columns, table->where().equal(col_int, v), col_val);
+        check_same_result(test_context, *table, columns,
+                          table->where().equal(col_int, v).equal(col_str, "a").equal(col_bool, true),
+                          col_val);
+        for (int64_t t : {0, 50, 100}) {
+            check_same_result(
+                test_context, *table, columns,
+                table->where().equal(col_int, v).equal(col_str, "d").equal(col_bool, false).less(col_ts,
+                                                                                                   Timestamp(t, 0)),
+                col_val);
+            check_same_result(test_context, *table, columns,
+                              table->where()
+                                  .equal(col_int, v)
+                                  .equal(col_str, "a")
+                                  .equal(col_bool, true)
+                                  .greater_equal(col_ts, Timestamp(t, 0))
+                                  .greater(col_val, 1000),
+                              col_val);
+        }
+    }
+    check_same_result(test_context, *table, columns, table->where().equal(col_int, 3).equal(col_str, StringData()),
+                      col_val);
+    check_same_result(test_context, *table, columns,
+                      table->where().equal(col_int, 3).equal(col_str, "a").equal(col_bool, true).equal(col_ts,
+                                                                                                       Timestamp()),
+                      col_val);
+    // Conditions outside the index and disjunctions are still evaluated
+    check_same_result(test_context, *table, columns,
+                      table->where().equal(col_int, 3).equal(col_str, "a").less(col_val, 500), col_val);
+    check_same_result(test_context, *table, columns,
+                      table->where().equal(col_int, 3).equal(col_str, "a").Or().equal(col_int, 4), col_val);
+}
+
+#endif // TEST_INDEX_COMPOSITE
@@ -0,0 +1,272 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_FULLTEXT
+
+#include <realm.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/history.hpp>
+#include <realm/unicode.hpp>
+
+#include "test.hpp"
+#include "util/check_index_results.hpp"
+#include "util/check_logic_error.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+TEST(IndexFullText_Tokenize)
+{
+    auto tokens = FullTextIndex::tokenize("The quick, brown fox -- the QUICK fox!");
+    CHECK_EQUAL(tokens.size(), 4);
+    CHECK(tokens.count("the"));
+    CHECK(tokens.count("quick"));
+    CHECK(tokens.count("brown"));
+    CHECK(tokens.count("fox"));
+
+    // Non-ASCII characters are part of the words, which are case folded as
+    // far as case_map() knows the characters
+    tokens = FullTextIndex::tokenize("Ærø Æblegrød 42");
+    CHECK_EQUAL(tokens.size(), 3);
+    CHECK(tokens.count(case_map("Ærø", false, IgnoreErrors)));
+    CHECK(tokens.count(case_map("Æblegrød", false, IgnoreErrors)));
+    CHECK(tokens.count("42"));
+
+    // Non-ASCII spaces and punctuation separate words
+    tokens = FullTextIndex::tokenize("«naïve»\xc2\xa0" "fiancé—café 3×4 “über” 東京、大阪 🙂");
+    CHECK_EQUAL(tokens.size(), 8);
+    CHECK(tokens.count(case_map("naïve", false, IgnoreErrors)));
+    CHECK(tokens.count(case_map("fiancé", false, IgnoreErrors)));
+    CHECK(tokens.count(case_map("café", false, IgnoreErrors)));
+    CHECK(tokens.count("3"));
+    CHECK(tokens.count("4"));
+    CHECK(tokens.count(case_map("über", false, IgnoreErrors)));
+    CHECK(tokens.count("東京"));
+    CHECK(tokens.count("大阪"));
+    CHECK_NOT(tokens.count("🙂"));
+    CHECK(FullTextIndex::tokenize("\xe2\x80\xa6\xe3\x80\x80\xef\xbc\x81 \xc2\xbf\xc2\xa1").empty());
+
+    // Invalid and truncated UTF-8 sequences separate words too
+    tokens = FullTextIndex::tokenize(StringData("ab\xff\xfe" "cd\xc3", 7));
+    CHECK_EQUAL(tokens.size(), 2);
+    CHECK(tokens.count("ab"));
+    CHECK(tokens.count("cd"));
+
+    CHECK(FullTextIndex::tokenize(" ,.- ").empty());
+    CHECK(FullTextIndex::tokenize(StringData()).empty());
+
+    CHECK(FullTextIndex::matches("A brown Fox", FullTextIndex::tokenize("fox BROWN")));
+    CHECK_NOT(FullTextIndex::matches("A brown Fox", FullTextIndex::tokenize("brown foxes")));
+    CHECK_NOT(FullTextIndex::matches("A brown Fox", FullTextIndex::tokenize("")));
+}
+
+TEST(IndexFullText_AddRemove)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col_str = table->add_column(type_String, "str", true);
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_list = table->add_column_list(type_String, "list");
+
+    table->create_object().set(col_str, "hello world");
+    table->add_search_index(col_str, IndexType::Fulltext);
+    CHECK(table->search_index_type(col_str) == IndexType::Fulltext);
+    CHECK(table->get_fulltext_index(col_str));
+    CHECK_NOT(table->has_search_index(col_str));
+    CHECK_NOT(table->get_search_index(col_str));
+    CHECK_EQUAL(table->get_fulltext_index(col_str)->size(), 2);
+
+    CHECK_LOGIC_ERROR(table->add_search_index(col_int, IndexType::Fulltext), LogicError::illegal_combination);
+    CHECK_LOGIC_ERROR(table->add_search_index(col_list, IndexType::Fulltext), LogicError::illegal_combination);
+
+    // An index of another type replaces the full-text index, and vice versa
+    table->add_search_index(col_str);
+    CHECK(table->search_index_type(col_str) == IndexType::General);
+    CHECK_NOT(table->get_fulltext_index(col_str));
+    table->add_search_index(col_str, IndexType::Fulltext);
+    CHECK_NOT(table->has_search_index(col_str));
+
+    table->remove_search_index(col_str);
+    CHECK(table->search_index_type(col_str) == IndexType::None);
+    CHECK_NOT(table->get_fulltext_index(col_str));
+
+    // Removing a column removes its index
+    table->add_search_index(col_str, IndexType::Fulltext);
+    table->remove_column(col_str);
+    CHECK(table->search_index_type(col_int) == IndexType::None);
+}
+
+TEST(IndexFullText_Maintenance)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col = table->add_column(type_String, "str", true);
+    table->add_search_index(col, IndexType::Fulltext);
+    auto index = table->get_fulltext_index(col);
+
+    auto obj1 = table->create_object();
+    auto obj2 = table->create_object(ObjKey(), {{col, "red green"}});
+    CHECK_EQUAL(index->size(), 2);
+    obj1.set(col, "Green blue green");
+    CHECK_EQUAL(index->size(), 4);
+
+    std::vector<ObjKey> found;
+    index->find_all(found, "GREEN");
+    CHECK_EQUAL(found.size(), 2);
+    CHECK_EQUAL(found[0], obj1.get_key());
+    CHECK_EQUAL(found[1], obj2.get_key());
+    found.clear();
+    index->find_all(found, "green red");
+    CHECK_EQUAL(found.size(), 1);
+    CHECK_EQUAL(found[0], obj2.get_key());
+    found.clear();
+    index->find_all(found, "green yellow");
+    CHECK_EQUAL(found.size(), 0);
+
+    // Only the changed words are updated
+    obj2.set(col, "red yellow");
+    obj1.set_null(col);
+    index->verify();
+    CHECK_EQUAL(index->size(), 2);
+    index->find_all(found, "yellow");
+    CHECK_EQUAL(found.size(), 1);
+    CHECK_EQUAL(found[0], obj2.get_key());
+
+    // Removing an object removes its entries
+    obj1.set_any(col, Mixed("blue"));
+    obj2.remove();
+    CHECK_EQUAL(index->size(), 1);
+    index->verify();
+
+    table->clear();
+    CHECK_EQUAL(index->size(), 0);
+}
+
+TEST(IndexFullText_Persistence)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("foo");
+        col = table->add_column(type_String, "str");
+        for (int i = 0; i < 100; ++i)
+            table->create_object().set(col, util::format("item %1 of group %2", i, i % 7));
+        table->add_search_index(col, IndexType::Fulltext);
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK(table->search_index_type(col) == IndexType::Fulltext);
+        CHECK_EQUAL(table->where().fulltext(col, "group 3").count(), 14);
+        CHECK_EQUAL(table->where().fulltext(col, "item 30").count(), 1);
+        table->get_fulltext_index(col)->verify();
+    }
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("foo");
+        table->begin()->set(col, "removed");
+        table->remove_object(table->begin() + 1);
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK_EQUAL(table->where().fulltext(col, "group 0").count(), 14);
+        CHECK_EQUAL(table->where().fulltext(col, "removed").count(), 1);
+    }
+}
+
+TEST(IndexFullText_Query)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Group g;
+    auto table = g.add_table("foo");
+    auto col = table->add_column(type_String, "str", true);
+    auto col_int = table->add_column(type_Int, "int");
+    const char* words[] = {"alpha", "Beta", "GAMMA", "delta", "épsilon", "Épsilon"};
+
+    for (int i = 0; i < 500; ++i) {
+        auto obj = table->create_object().set(col_int, i % 10);
+        size_t n = random.draw_int_mod(5);
+        if (n == 0) {
+            if (random.draw_bool())
+                obj.set_null(col);
+            continue;
+        }
+        std::string str;
+        for (size_t j = 0; j < n; ++j) {
+            str += words[random.draw_int_mod(6)];
+            str += (random.draw_bool() ? " " : ", ");
+        }
+        obj.set(col, StringData(str));
+    }
+    table->add_search_index(col, IndexType::Fulltext);
+
+    for (const char* text : {"alpha", "beta gamma", "GAMMA, delta alpha", "ÉPSILON", "zeta", "alpha zeta", ""}) {
+        check_same_result(test_context, *table, col, table->where().fulltext(col, text));
+        check_same_result(test_context, *table, col, table->where().fulltext(col, text).equal(col_int, 3));
+        check_same_result(test_context, *table, col, table->where().equal(col_int, 3).fulltext(col, text));
+        check_same_result(test_context, *table, col, table->where().Not().fulltext(col, text));
+    }
+
+    // Every word of the text is required
+    auto tv = table->where().fulltext(col, "beta gamma").find_all();
+    for (size_t i = 0; i < tv.size(); ++i) {
+        auto str = tv.get_object(i).get<String>(col);
+        CHECK(str.contains("Beta") && str.contains("GAMMA"));
+    }
+
+    CHECK_LOGIC_ERROR(table->where().fulltext(col_int, "alpha"), LogicError::type_mismatch);
+}
+
+#endif // TEST_INDEX_FULLTEXT
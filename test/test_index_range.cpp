@@ -0,0 +1,258 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_RANGE
+
+#include <realm.hpp>
+#include <realm/index_range.hpp>
+#include <realm/history.hpp>
+
+#include "test.hpp"
+#include "util/check_index_results.hpp"
+#include "util/check_logic_error.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+TEST(IndexRange_AddRemove)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_str = table->add_column(type_String, "str");
+
+    CHECK(table->search_index_type(col_int) == IndexType::None);
+    table->add_search_index(col_int, IndexType::Ordered);
+    CHECK(table->has_range_index(col_int));
+    CHECK_NOT(table->has_search_index(col_int));
+    CHECK(table->search_index_type(col_int) == IndexType::Ordered);
+
+    // An index of the other kind is replaced
+    table->add_search_index(col_int);
+    CHECK_NOT(table->has_range_index(col_int));
+    CHECK(table->has_search_index(col_int));
+    table->add_search_index(col_int, IndexType::Ordered);
+    CHECK(table->has_range_index(col_int));
+    CHECK_NOT(table->has_search_index(col_int));
+
+    table->add_search_index(col_int, IndexType::None);
+    CHECK(table->search_index_type(col_int) == IndexType::None);
+
+    CHECK_LOGIC_ERROR(table->add_search_index(col_str, IndexType::Ordered), LogicError::illegal_combination);
+}
+
+TEST(IndexRange_Maintenance)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col = table->add_column(type_Int, "int", true);
+    table->add_search_index(col, IndexType::Ordered);
+    auto index = table->get_range_index(col);
+
+    std::vector<ObjKey> keys;
+    for (int64_t i = 0; i < 10; ++i)
+        keys.push_back(table->create_object().set(col, 9 - i).get_key());
+    CHECK_EQUAL(index->size(), 10);
+    CHECK_EQUAL(index->get_value(0), Mixed(0));
+    CHECK_EQUAL(index->get_key(0), keys[9]);
+
+    table->get_object(keys[0]).set(col, 3);
+    table->get_object(keys[1]).set_null(col);
+    table->get_object(keys[2]).add_int(col, -4);
+    table->remove_object(keys[3]);
+    index->verify();
+
+    CHECK_EQUAL(index->size(), 9);
+    CHECK(index->get_value(0).is_null());
+    CHECK_EQUAL(index->get_key(0), keys[1]);
+    CHECK_EQUAL(table->count_int(col, 3), 3);
+    CHECK_EQUAL(table->find_first_int(col, 3), keys[0]);
+    CHECK_EQUAL(table->find_first_int(col, 6), ObjKey());
+
+    table->clear();
+    CHECK_EQUAL(index->size(), 0);
+}
+
+TEST(IndexRange_Persistence)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("foo");
+        col = table->add_column(type_Timestamp, "ts");
+        table->add_search_index(col, IndexType::Ordered);
+        for (int i = 0; i < 100; ++i)
+            table->create_object().set(col, Timestamp((i * 37) % 100, 0));
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK(table->search_index_type(col) == IndexType::Ordered);
+        auto index = table->get_range_index(col);
+        CHECK_EQUAL(index->size(), 100);
+        for (size_t i = 0; i < 100; ++i)
+            CHECK_EQUAL(index->get_value(i), Mixed(Timestamp(int64_t(i), 0)));
+        index->verify();
+    }
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("foo");
+        table->remove_object(table->begin());
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto index = rt->get_table("foo")->get_range_index(col);
+        CHECK_EQUAL(index->size(), 99);
+        index->verify();
+    }
+}
+
+TEST(IndexRange_Query)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Group g;
+    auto table = g.add_table("foo");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_null = table->add_column(type_Int, "int_null", true);
+    auto col_ts = table->add_column(type_Timestamp, "ts", true);
+    auto col_other = table->add_column(type_Int, "other");
+
+    for (int i = 0; i < 2000; ++i) {
+        auto obj = table->create_object();
+        obj.set(col_int, random.draw_int<int64_t>(-100, 100));
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_null, random.draw_int<int64_t>(-100, 100));
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 100), 0));
+        obj.set(col_other, i % 2);
+    }
+    table->add_search_index(col_int, IndexType::Ordered);
+    table->add_search_index(col_null, IndexType::Ordered);
+    table->add_search_index(col_ts, IndexType::Ordered);
+
+    for (int64_t v : {-101, -50, 0, 17, 100}) {
+        check_same_result(test_context, *table, col_int, table->where().equal(col_int, v));
+        check_same_result(test_context, *table, col_int, table->where().greater(col_int, v));
+        check_same_result(test_context, *table, col_int, table->where().less_equal(col_int, v));
+        check_same_result(test_context, *table, col_int,
+                          table->where().greater_equal(col_int, v).equal(col_other, 1));
+        check_same_result(test_context, *table, col_null, table->where().less(col_null, v));
+        check_same_result(test_context, *table, col_null, table->where().greater_equal(col_null, v));
+        check_same_result(test_context, *table, col_ts, table->where().greater(col_ts, Timestamp(v, 0)));
+        check_same_result(test_context, *table, col_ts, table->where().less_equal(col_ts, Timestamp(v, 0)));
+    }
+    check_same_result(test_context, *table, col_null, table->where().equal(col_null, null()));
+    check_same_result(test_context, *table, col_ts, table->where().equal(col_ts, Timestamp()));
+    check_same_result(test_context, *table, col_ts, table->where().less(col_ts, Timestamp()));
+
+    // Aggregates visit the matches through the index
+    auto q = table->where().greater(col_int, 90);
+    auto expected = q.find_all().sum_int(col_int);
+    CHECK_EQUAL(q.sum_int(col_int), expected);
+}
+
+TEST(IndexRange_SortLimit)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col = table->add_column(type_Int, "int", true);
+    auto col_other = table->add_column(type_Int, "other");
+    for (int i = 0; i < 100; ++i) {
+        auto obj = table->create_object();
+        if (i % 7)
+            obj.set(col, (i * 13) % 10);
+        obj.set(col_other, i % 3);
+    }
+
+    auto check_ordering = [&](Query q, bool ascending, size_t limit) {
+        DescriptorOrdering ordering;
+        ordering.append_sort(SortDescriptor({{col}}, {ascending}));
+        if (limit != npos)
+            ordering.append_limit(limit);
+
+        auto with_index = q.find_all(ordering);
+        table->remove_search_index(col);
+        auto without_index = q.find_all(ordering);
+        table->add_search_index(col, IndexType::Ordered);
+
+        CHECK_EQUAL(with_index.size(), without_index.size());
+        CHECK_EQUAL(with_index.get_num_results_excluded_by_limit(),
+                    without_index.get_num_results_excluded_by_limit());
+        for (size_t i = 0; i < with_index.size() && i < without_index.size(); ++i)
+            CHECK_EQUAL(with_index.get_key(i), without_index.get_key(i));
+    };
+
+    table->add_search_index(col, IndexType::Ordered);
+    for (bool ascending : {true, false}) {
+        for (size_t limit : {size_t(0), size_t(1), size_t(5), size_t(23), size_t(1000), npos}) {
+            check_ordering(table->where(), ascending, limit);
+            check_ordering(table->where().equal(col_other, 1), ascending, limit);
+        }
+    }
+
+    // The number of results excluded by the limit follows the changes to the table
+    DescriptorOrdering ordering;
+    ordering.append_sort(SortDescriptor({{col}}));
+    ordering.append_limit(5);
+    auto tv = table->where().equal(col_other, 1).find_all(ordering);
+    CHECK_EQUAL(tv.size(), 5);
+    CHECK_EQUAL(tv.get_num_results_excluded_by_limit(), 28);
+    for (size_t i = 0; i < 90; ++i)
+        table->remove_object(table->begin());
+    tv.sync_if_needed();
+    CHECK_EQUAL(tv.size(), 3);
+    CHECK_EQUAL(tv.get_num_results_excluded_by_limit(), 0);
+}
+
+#endif // TEST_INDEX_RANGE
@@ -20,11 +20,13 @@
 #ifdef TEST_INDEX_STRING
 
 #include <realm.hpp>
+#include <realm/history.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_expression.hpp>
 #include <realm/util/to_string.hpp>
 #include <set>
 #include "test.hpp"
+#include "util/check_logic_error.hpp"
 #include "util/misc.hpp"
 #include "util/random.hpp"
 
@@ -1790,4 +1792,218 @@ TEST(StringIndex_QuerySingleObject)
     CHECK_EQUAL(q.count(), 0);
 }
 
+TEST(StringIndex_CaseInsensitiveIndex)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col = table->add_column(type_String, "str", true);
+    auto col_int = table->add_column(type_Int, "int");
+
+    const char* strings[] = {"john", "John", "JOHN", "jOhN", "hans", "Hansapark", "", "common", "Common"};
+    for (const char* str : strings)
+        table->create_object().set(col, str);
+    auto null_obj = table->create_object();
+
+    table->add_search_index(col, IndexType::CaseInsensitive);
+    CHECK(table->search_index_type(col) == IndexType::CaseInsensitive);
+    CHECK_NOT(table->has_search_index(col));
+    CHECK_NOT(table->get_search_index(col));
+    const StringIndex* ndx = table->get_case_insensitive_index(col);
+    CHECK(ndx);
+    CHECK(ndx->is_case_insensitive());
+    CHECK_LOGIC_ERROR(table->add_search_index(col_int, IndexType::CaseInsensitive), LogicError::illegal_combination);
+
+    // All lookups ignore case
+    std::vector<ObjKey> results;
+    ndx->find_all(results, "JoHn");
+    CHECK_EQUAL(results.size(), 4);
+    check_result_order(results, test_context);
+    results.clear();
+    ndx->find_all(results, "HANS", true);
+    CHECK_EQUAL(results.size(), 1);
+    results.clear();
+    ndx->find_all(results, StringData());
+    CHECK_EQUAL(results.size(), 1);
+    CHECK_EQUAL(results[0], null_obj.get_key());
+    CHECK_EQUAL(ndx->count("COMMON"), 2);
+    CHECK_EQUAL(ndx->count(""), 1);
+    CHECK_EQUAL(ndx->count("han"), 0);
+
+    // Case insensitive conditions are answered from the index, case sensitive ones are not
+    CHECK_EQUAL(table->where().equal(col, "JOHN", false).count(), 4);
+    CHECK_EQUAL(table->where().equal(col, "JOHN", true).count(), 1);
+    CHECK_EQUAL(table->where().equal(col, "hansaPARK", false).count(), 1);
+    CHECK_EQUAL(table->where().equal(col, StringData(), false).count(), 1);
+
+    // The index is maintained
+    table->begin()->set(col, "Hans");
+    null_obj.set(col, "JOHN");
+    table->create_object().set(col, "hAnS");
+    CHECK_EQUAL(table->where().equal(col, "john", false).count(), 4);
+    CHECK_EQUAL(table->where().equal(col, "hans", false).count(), 3);
+    table->remove_object(table->begin() + 1);
+    CHECK_EQUAL(table->where().equal(col, "john", false).count(), 3);
+    ndx->verify();
+
+    // An index of another type replaces it
+    table->add_search_index(col);
+    CHECK(table->search_index_type(col) == IndexType::General);
+    CHECK_NOT(table->get_case_insensitive_index(col));
+    CHECK_EQUAL(table->where().equal(col, "john", false).count(), 3);
+    table->remove_search_index(col);
+    CHECK(table->search_index_type(col) == IndexType::None);
+}
+
+// Exercise the case insensitive index for strings with long common prefixes, which are stored in lists
+TEST(StringIndex_CaseInsensitiveIndex_VeryLongStrings)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col = table->add_column(type_String, "str");
+    table->add_search_index(col, IndexType::CaseInsensitive);
+
+    std::string long1 = std::string(StringIndex::s_max_offset + 10, 'a');
+    std::string long2 = long1 + "b";
+    std::string upper1 = std::string(StringIndex::s_max_offset + 10, 'A');
+    for (auto& str : {long1, long2, upper1 + "B", upper1, long1 + "c", long2})
+        table->create_object().set(col, str);
+
+    CHECK_EQUAL(table->where().equal(col, StringData(upper1), false).count(), 2);
+    CHECK_EQUAL(table->where().equal(col, StringData(long2), false).count(), 3);
+    std::string upper3 = upper1 + "C";
+    CHECK_EQUAL(table->where().equal(col, StringData(upper3), false).count(), 1);
+    CHECK_EQUAL(table->where().equal(col, StringData(long2), true).count(), 2);
+    table->get_case_insensitive_index(col)->verify();
+}
+
+TEST(StringIndex_CaseInsensitiveIndex_Persistence)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("foo");
+        col = table->add_column(type_String, "str");
+        for (int i = 0; i < 100; ++i)
+            table->create_object().set(col, util::format(i % 2 ? "Item %1" : "ITEM %1", i % 10));
+        table->add_search_index(col, IndexType::CaseInsensitive);
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK(table->search_index_type(col) == IndexType::CaseInsensitive);
+        CHECK(table->get_case_insensitive_index(col)->is_case_insensitive());
+        CHECK_EQUAL(table->where().equal(col, "item 3", false).count(), 10);
+        CHECK_EQUAL(table->where().equal(col, "Item 3", true).count(), 10);
+        CHECK_EQUAL(table->where().equal(col, "ITEM 3", true).count(), 0);
+    }
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("foo");
+        table->begin()->set(col, "item 3");
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK_EQUAL(table->where().equal(col, "ITEM 3", false).count(), 11);
+        CHECK_EQUAL(table->where().equal(col, "item 0", false).count(), 9);
+    }
+    {
+        // The kind of index is recorded by its own attribute, which is
+        // cleared with the index and is not part of the column key
+        auto wt = db->start_write();
+        auto table = wt->get_table("foo");
+        CHECK_EQUAL(table->get_column_key("str"), col);
+        table->remove_search_index(col);
+        CHECK(table->search_index_type(col) == IndexType::None);
+        table->add_search_index(col, IndexType::Fulltext);
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK(table->search_index_type(col) == IndexType::Fulltext);
+        CHECK_EQUAL(table->get_case_insensitive_index(col), nullptr);
+    }
+}
+
+TEST(StringIndex_Prefix)
+{
+    Group g;
+    auto table = g.add_table("foo");
+    auto col = table->add_column(type_String, "str", true);
+    auto col_ins = table->add_column(type_String, "str_ins", true);
+
+    // Strings of all lengths around the key size, with bytes on both sides of the sign bit and with long common
+    // prefixes which end up in lists. There are enough of them to give the index inner nodes.
+    const char* parts[] = {"a", "ab", "aB", "abc", "abcd", "ABCD", "abcde", "b", "\xc3\xa6", "X", ""};
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    std::string long_prefix(StringIndex::s_max_offset, 'p');
+    for (size_t i = 0; i < 2000; ++i) {
+        auto obj = table->create_object();
+        if (i % 50 == 0)
+            continue;
+        std::string str;
+        size_t n = random.draw_int<size_t>(0, 3);
+        for (size_t j = 0; j < n; ++j)
+            str += parts[random.draw_int<size_t>(0, 10)];
+        if (i % 7 == 0)
+            str = long_prefix + str;
+        obj.set(col, StringData(str));
+        obj.set(col_ins, StringData(str));
+    }
+    table->add_search_index(col);
+    table->add_search_index(col_ins, IndexType::CaseInsensitive);
+
+    auto check_prefix = [&](StringData prefix) {
+        std::vector<ObjKey> expected;
+        std::vector<ObjKey> expected_ins;
+        std::string folded_prefix = case_map(prefix, true, IgnoreErrors);
+        for (auto& obj : *table) {
+            StringData str = obj.get<String>(col_ins);
+            if (str.is_null())
+                continue;
+            if (obj.get<String>(col).begins_with(prefix))
+                expected.push_back(obj.get_key());
+            if (StringData(case_map(str, true, IgnoreErrors)).begins_with(folded_prefix))
+                expected_ins.push_back(obj.get_key());
+        }
+
+        std::vector<ObjKey> results;
+        table->get_search_index(col)->find_all_prefix(results, prefix);
+        CHECK(results == expected);
+        results.clear();
+        table->get_case_insensitive_index(col_ins)->find_all_prefix(results, prefix);
+        CHECK(results == expected_ins);
+
+        CHECK_EQUAL(table->where().begins_with(col, prefix).count(), expected.size());
+        CHECK_EQUAL(table->where().begins_with(col_ins, prefix, false).count(), expected_ins.size());
+        auto tv = table->where().begins_with(col, prefix).find_all();
+        CHECK_EQUAL(tv.size(), expected.size());
+        for (size_t i = 0; i < tv.size() && i < expected.size(); ++i)
+            CHECK_EQUAL(tv.get_key(i), expected[i]);
+    };
+
+    for (const char* prefix :
+         {"a", "ab", "Ab", "abc", "abcd", "ABCDa", "abcdeabc", "aX", "\xc3\xa6", "a\xc3\xa6", "b", "p", "q"}) {
+        check_prefix(prefix);
+    }
+    check_prefix(long_prefix);
+    check_prefix(long_prefix + "a");
+    check_prefix(long_prefix + "abcd");
+
+    // The indexes are maintained
+    for (auto it = table->begin(); it != table->begin() + 10; ++it) {
+        it->set(col, "abcdefgh");
+        it->set(col_ins, "ABCDefgh");
+    }
+    table->remove_object(table->begin() + 20);
+    check_prefix("abcdefg");
+    check_prefix("ab");
+}
+
 #endif // TEST_INDEX_STRING
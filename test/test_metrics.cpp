@@ -898,6 +898,37 @@ TEST(Metrics_TransactionVersions)
     }
 }
 
+TEST(Metrics_UnflushedVersions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBOptions options(DBOptions::Durability::Async);
+    options.async_flush_interval = std::chrono::hours(1);
+    options.enable_metrics = true;
+    DBRef sg = DB::create(*hist, options);
+    for (size_t i = 0; i < 3; ++i) {
+        auto wt = sg->start_write();
+        TableRef t = wt->get_or_add_table("table");
+        t->create_object();
+        wt->commit();
+    }
+    sg->flush();
+    {
+        auto rt = sg->start_read();
+    }
+
+    std::shared_ptr<Metrics> metrics = sg->get_metrics();
+    CHECK(metrics);
+    std::unique_ptr<Metrics::TransactionInfoList> transactions = metrics->take_transactions();
+    CHECK(transactions);
+    CHECK_EQUAL(transactions->size(), 4);
+
+    CHECK_EQUAL(transactions->at(0).get_num_unflushed_versions(), 1);
+    CHECK_EQUAL(transactions->at(1).get_num_unflushed_versions(), 2);
+    CHECK_EQUAL(transactions->at(2).get_num_unflushed_versions(), 3);
+    CHECK_EQUAL(transactions->at(3).get_num_unflushed_versions(), 0);
+}
+
 TEST(Metrics_MaxNumTransactionsIsNotExceeded)
 {
     SHARED_GROUP_TEST_PATH(path);
@@ -2,8 +2,10 @@
 #include "util/random.hpp"
 #include "util/compare_groups.hpp"
 #include "util/crypt_key.hpp"
+#include "util/check_system_error.hpp"
 
 #include <realm/sync/noinst/compression.hpp>
+#include <realm/sync/noinst/protocol_codec.hpp>
 #include <realm/sync/history.hpp>
 
 #include <algorithm>
@@ -229,6 +231,153 @@ void make_data_in_realm(const std::string& realm_path, size_t data_size,
     wt.commit();
 }
 
+// Frames written by the reference implementation (the zstd command line tool,
+// version 1.5.6, with --no-check). The inputs are recreated by
+// zstd_reference_frames().
+const unsigned char g_zstd_reference_text[] = { // zstd -1
+    0x28, 0xb5, 0x2f, 0xfd, 0x60, 0xc2, 0x00, 0xb5, 0x01, 0x00, 0xd4, 0x02, 0x54, 0x68, 0x65, 0x20,
+    0x71, 0x75, 0x69, 0x63, 0x6b, 0x20, 0x62, 0x72, 0x6f, 0x77, 0x6e, 0x20, 0x66, 0x6f, 0x78, 0x20,
+    0x6a, 0x75, 0x6d, 0x70, 0x73, 0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6c,
+    0x61, 0x7a, 0x79, 0x20, 0x64, 0x6f, 0x67, 0x2e, 0x20, 0x01, 0x00, 0x95, 0x84, 0xaa, 0x2a, 0x03,
+};
+const unsigned char g_zstd_reference_mixed[] = { // zstd -1
+    0x28, 0xb5, 0x2f, 0xfd, 0x60, 0xe8, 0x02, 0xe5, 0x09, 0x00, 0x54, 0x11, 0x61, 0x61, 0x00, 0x07,
+    0x0e, 0x15, 0x1c, 0x23, 0x2a, 0x31, 0x38, 0x3f, 0x46, 0x4d, 0x54, 0x5c, 0x63, 0x6a, 0x71, 0x78,
+    0x7f, 0x86, 0x8d, 0x94, 0x9b, 0xa2, 0xa9, 0xb0, 0xb8, 0xbf, 0xc6, 0xcd, 0xd4, 0xdb, 0xe2, 0xe9,
+    0xf0, 0xf7, 0xfe, 0x05, 0x0c, 0x14, 0x1b, 0x22, 0x29, 0x30, 0x37, 0x3e, 0x45, 0x4c, 0x53, 0x5a,
+    0x61, 0x68, 0x70, 0x77, 0x7e, 0x85, 0x8c, 0x93, 0x9a, 0xa1, 0xa8, 0xaf, 0xb6, 0xbd, 0xc4, 0xcc,
+    0xd3, 0xda, 0xe1, 0xe8, 0xef, 0xf6, 0xfd, 0x04, 0x0b, 0x12, 0x19, 0x20, 0x28, 0x2f, 0x36, 0x3d,
+    0x44, 0x4b, 0x52, 0x59, 0x60, 0x67, 0x6e, 0x75, 0x7c, 0x84, 0x8b, 0x92, 0x99, 0xa0, 0xa7, 0xae,
+    0xb5, 0xbc, 0xc3, 0xca, 0xd1, 0xd8, 0xe0, 0xe7, 0xee, 0xf5, 0xfc, 0x03, 0x0a, 0x11, 0x18, 0x1f,
+    0x26, 0x2d, 0x34, 0x3c, 0x43, 0x4a, 0x51, 0x58, 0x5f, 0x66, 0x6d, 0x74, 0x7b, 0x82, 0x89, 0x90,
+    0x98, 0x9f, 0xa6, 0xad, 0xb4, 0xbb, 0xc2, 0xc9, 0xd0, 0xd7, 0xde, 0xe5, 0xec, 0xf4, 0xfb, 0x02,
+    0x09, 0x10, 0x17, 0x1e, 0x25, 0x2c, 0x33, 0x3a, 0x41, 0x48, 0x50, 0x57, 0x5e, 0x65, 0x6c, 0x73,
+    0x7a, 0x81, 0x88, 0x8f, 0x96, 0x9d, 0xa4, 0xac, 0xb3, 0xba, 0xc1, 0xc8, 0xcf, 0xd6, 0xdd, 0xe4,
+    0xeb, 0xf2, 0xf9, 0x00, 0x08, 0x0f, 0x16, 0x1d, 0x24, 0x2b, 0x32, 0x39, 0x40, 0x47, 0x4e, 0x55,
+    0x5c, 0x64, 0x6b, 0x72, 0x79, 0x80, 0x87, 0x8e, 0x95, 0x9c, 0xa3, 0xaa, 0xb1, 0xb8, 0xc0, 0xc7,
+    0xce, 0xd5, 0xdc, 0xe3, 0xea, 0xf1, 0xf8, 0xff, 0x06, 0x0d, 0x14, 0x5b, 0x62, 0x69, 0x70, 0xb7,
+    0xbe, 0xc5, 0xcc, 0x13, 0x1a, 0x21, 0x28, 0x6f, 0x76, 0x7d, 0x84, 0xcb, 0xd2, 0xd9, 0xe0, 0x27,
+    0x2e, 0x35, 0x3c, 0x83, 0x8a, 0x91, 0x98, 0xdf, 0xe6, 0xed, 0xf4, 0x3b, 0x42, 0x49, 0x50, 0x97,
+    0x9e, 0xa5, 0xac, 0xf3, 0xfa, 0x01, 0x08, 0x4f, 0x56, 0x5d, 0x64, 0xab, 0xb2, 0xb9, 0xc0, 0x07,
+    0x61, 0x10, 0x00, 0x28, 0x38, 0x85, 0x81, 0x26, 0xa0, 0x10, 0x50, 0x08, 0x28, 0x04, 0x14, 0x02,
+    0x0a, 0x01, 0x85, 0x80, 0x42, 0x40, 0x21, 0xa0, 0x10, 0x50, 0x08, 0x28, 0x04, 0x0a, 0xe9, 0x72,
+    0x4d, 0x21, 0x4f, 0x54, 0x80, 0x05,
+};
+const unsigned char g_zstd_reference_words[] = { // zstd -19
+    0x28, 0xb5, 0x2f, 0xfd, 0x60, 0x25, 0x06, 0x7d, 0x02, 0x00, 0xe2, 0x82, 0x0a, 0x11, 0xb0, 0xb9,
+    0x01, 0x84, 0x8a, 0xb1, 0x6c, 0xb2, 0x14, 0x2e, 0x49, 0xaa, 0x24, 0xa9, 0xc8, 0x58, 0x44, 0xea,
+    0x40, 0x03, 0xea, 0x3a, 0xfe, 0xa6, 0x25, 0x3f, 0xcf, 0x90, 0x8e, 0x4d, 0x82, 0x46, 0x78, 0x71,
+    0xc4, 0xcb, 0x7c, 0x8b, 0x47, 0xda, 0x4d, 0x0d, 0x00, 0xa8, 0xf6, 0xf1, 0x01, 0x10, 0x9c, 0x02,
+    0x1c, 0x29, 0x03, 0xbe, 0x0e, 0x68, 0xe1, 0x82, 0x4d, 0x02, 0xa9, 0x01, 0x41, 0x18, 0x60, 0xd4,
+    0x80, 0x99, 0x03, 0x40, 0x19, 0x2b, 0x11, 0x65, 0x0c,
+};
+// A dictionary trained by the same tool (zstd --train --maxdict=256) on
+// sentences made like the last one of zstd_reference_frames(), and that
+// sentence compressed with the dictionary (zstd -1 -D <dictionary>).
+const unsigned char g_zstd_reference_dictionary[] = {
+    0x37, 0xa4, 0x30, 0xec, 0xf1, 0x0f, 0xd9, 0x16, 0x09, 0x10, 0x10, 0xdf, 0x30, 0x33, 0x33, 0xb3,
+    0x77, 0x0a, 0x83, 0x01, 0x00, 0x00, 0x08, 0x12, 0xa3, 0xab, 0x0d, 0x00, 0x00, 0x00, 0x04, 0x00,
+    0xc1, 0x01, 0x16, 0x14, 0x00, 0x07, 0x00, 0x28, 0x36, 0x22, 0x0d, 0x0e, 0x08, 0x1a, 0x2f, 0x88,
+    0x10, 0xc2, 0x81, 0x70, 0x20, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0xa4,
+    0x41, 0x00, 0x00, 0x18, 0x97, 0x06, 0x00, 0x00, 0xe4, 0x1d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00,
+    0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x20, 0x73, 0x79, 0x6e, 0x63, 0x20, 0x69, 0x6e, 0x64, 0x65,
+    0x78, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x69, 0x6e,
+    0x64, 0x65, 0x78, 0x20, 0x6f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x20, 0x63, 0x6f, 0x6c, 0x75, 0x6d,
+    0x6e, 0x20, 0x63, 0x6f, 0x6c, 0x75, 0x6d, 0x6e, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x73,
+    0x79, 0x6e, 0x63, 0x20, 0x73, 0x79, 0x6e, 0x63, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x74,
+    0x61, 0x62, 0x6c, 0x65, 0x20, 0x71, 0x75, 0x65, 0x72, 0x79, 0x20, 0x71, 0x75, 0x65, 0x72, 0x79,
+    0x20, 0x63, 0x6f, 0x6c, 0x75, 0x6d, 0x6e, 0x20, 0x72, 0x65, 0x69, 0x6e, 0x64, 0x65, 0x78, 0x20,
+    0x69, 0x6e, 0x64, 0x65, 0x78, 0x20, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x72, 0x65, 0x61, 0x6c,
+    0x6d, 0x20, 0x6f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x20, 0x6f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x20,
+    0x72, 0x65, 0x61, 0x6c, 0x6d, 0x20, 0x63, 0x6f, 0x6c, 0x75, 0x6d, 0x6e, 0x20, 0x74, 0x61, 0x62,
+};
+const unsigned char g_zstd_reference_dictionary_frame[] = {
+    0x28, 0xb5, 0x2f, 0xfd, 0x63, 0xf1, 0x0f, 0xd9, 0x16, 0x25, 0x06, 0x1d, 0x01, 0x00, 0x00, 0x11,
+    0x7c, 0x00, 0x9c, 0xf6, 0xec, 0x5c, 0x6f, 0xaa, 0x02, 0x33, 0x8d, 0x9b, 0xc6, 0x87, 0xd5, 0x15,
+    0x32, 0x24, 0x25, 0x0e, 0x06, 0xca, 0x23, 0xd2, 0xeb, 0xc2, 0x05, 0xa1, 0x76, 0x1b, 0x24, 0xeb,
+    0x01,
+};
+
+// Blocks written by the reference implementation of LZ4 (the lz4 command line
+// tool, version 1.9.4, at level 1), taken out of the frame that it wraps them
+// in. They hold the first two inputs of zstd_reference_frames().
+const unsigned char g_lz4_reference_text[] = {
+    0xff, 0x1e, 0x54, 0x68, 0x65, 0x20, 0x71, 0x75, 0x69, 0x63, 0x6b, 0x20, 0x62, 0x72, 0x6f, 0x77,
+    0x6e, 0x20, 0x66, 0x6f, 0x78, 0x20, 0x6a, 0x75, 0x6d, 0x70, 0x73, 0x20, 0x6f, 0x76, 0x65, 0x72,
+    0x20, 0x74, 0x68, 0x65, 0x20, 0x6c, 0x61, 0x7a, 0x79, 0x20, 0x64, 0x6f, 0x67, 0x2e, 0x20, 0x2d,
+    0x00, 0xff, 0x7e, 0x50, 0x64, 0x6f, 0x67, 0x2e, 0x20,
+};
+const unsigned char g_lz4_reference_mixed[] = {
+    0x1f, 0x61, 0x01, 0x00, 0xff, 0x19, 0xf5, 0xce, 0x00, 0x07, 0x0e, 0x15, 0x1c, 0x23, 0x2a, 0x31,
+    0x38, 0x3f, 0x46, 0x4d, 0x54, 0x5c, 0x63, 0x6a, 0x71, 0x78, 0x7f, 0x86, 0x8d, 0x94, 0x9b, 0xa2,
+    0xa9, 0xb0, 0xb8, 0xbf, 0xc6, 0xcd, 0xd4, 0xdb, 0xe2, 0xe9, 0xf0, 0xf7, 0xfe, 0x05, 0x0c, 0x14,
+    0x1b, 0x22, 0x29, 0x30, 0x37, 0x3e, 0x45, 0x4c, 0x53, 0x5a, 0x61, 0x68, 0x70, 0x77, 0x7e, 0x85,
+    0x8c, 0x93, 0x9a, 0xa1, 0xa8, 0xaf, 0xb6, 0xbd, 0xc4, 0xcc, 0xd3, 0xda, 0xe1, 0xe8, 0xef, 0xf6,
+    0xfd, 0x04, 0x0b, 0x12, 0x19, 0x20, 0x28, 0x2f, 0x36, 0x3d, 0x44, 0x4b, 0x52, 0x59, 0x60, 0x67,
+    0x6e, 0x75, 0x7c, 0x84, 0x8b, 0x92, 0x99, 0xa0, 0xa7, 0xae, 0xb5, 0xbc, 0xc3, 0xca, 0xd1, 0xd8,
+    0xe0, 0xe7, 0xee, 0xf5, 0xfc, 0x03, 0x0a, 0x11, 0x18, 0x1f, 0x26, 0x2d, 0x34, 0x3c, 0x43, 0x4a,
+    0x51, 0x58, 0x5f, 0x66, 0x6d, 0x74, 0x7b, 0x82, 0x89, 0x90, 0x98, 0x9f, 0xa6, 0xad, 0xb4, 0xbb,
+    0xc2, 0xc9, 0xd0, 0xd7, 0xde, 0xe5, 0xec, 0xf4, 0xfb, 0x02, 0x09, 0x10, 0x17, 0x1e, 0x25, 0x2c,
+    0x33, 0x3a, 0x41, 0x48, 0x50, 0x57, 0x5e, 0x65, 0x6c, 0x73, 0x7a, 0x81, 0x88, 0x8f, 0x96, 0x9d,
+    0xa4, 0xac, 0xb3, 0xba, 0xc1, 0xc8, 0xcf, 0xd6, 0xdd, 0xe4, 0xeb, 0xf2, 0xf9, 0x00, 0x08, 0x0f,
+    0x16, 0x1d, 0x24, 0x2b, 0x32, 0x39, 0x40, 0x47, 0x4e, 0x55, 0x5c, 0x64, 0x6b, 0x72, 0x79, 0x80,
+    0x87, 0x8e, 0x95, 0x9c, 0xa3, 0xaa, 0xb1, 0xb8, 0xc0, 0xc7, 0xce, 0xd5, 0xdc, 0xe3, 0xea, 0xf1,
+    0xf8, 0xff, 0x06, 0x0d, 0x14, 0xd9, 0x00, 0x45, 0x5b, 0x62, 0x69, 0x70, 0xd9, 0x00, 0x45, 0xb7,
+    0xbe, 0xc5, 0xcc, 0xd9, 0x00, 0x45, 0x13, 0x1a, 0x21, 0x28, 0xd9, 0x00, 0x45, 0x6f, 0x76, 0x7d,
+    0x84, 0xd9, 0x00, 0x45, 0xcb, 0xd2, 0xd9, 0xe0, 0xd9, 0x00, 0x45, 0x27, 0x2e, 0x35, 0x3c, 0xd9,
+    0x00, 0x45, 0x83, 0x8a, 0x91, 0x98, 0xd9, 0x00, 0x45, 0xdf, 0xe6, 0xed, 0xf4, 0xd9, 0x00, 0x45,
+    0x3b, 0x42, 0x49, 0x50, 0xd9, 0x00, 0x45, 0x97, 0x9e, 0xa5, 0xac, 0xd9, 0x00, 0x45, 0xf3, 0xfa,
+    0x01, 0x08, 0xd9, 0x00, 0x45, 0x4f, 0x56, 0x5d, 0x64, 0xd9, 0x00, 0x45, 0xab, 0xb2, 0xb9, 0xc0,
+    0xd9, 0x00, 0x1f, 0x07, 0xbb, 0x02, 0xff, 0x15, 0x50, 0x61, 0x61, 0x61, 0x61, 0x61,
+};
+
+struct ReferenceData {
+    const unsigned char* data;
+    size_t size;
+    std::string uncompressed;
+};
+
+std::vector<ReferenceData> zstd_reference_frames()
+{
+    // 10 copies of a sentence, which are encoded as one long overlapping
+    // match
+    std::string text;
+    for (int i = 0; i < 10; ++i)
+        text += "The quick brown fox jumps over the lazy dog. ";
+
+    // Runs of 300 equal bytes around 400 bytes with few repetitions
+    std::string mixed(300, 'a');
+    for (int i = 0; i < 400; ++i)
+        mixed += char((i * 7 + i / 13) & 0xFF);
+    mixed.append(300, 'a');
+
+    // Words picked by a formula, compressed with the optimal parser
+    const char* words[] = {"realm", "sync", "object", "table", "column", "index", "query", "value"};
+    std::string sentence;
+    for (int i = 0; i < 300; ++i) {
+        if (i > 0)
+            sentence += ' ';
+        sentence += words[(i * i * 31 + i * 7 + i / 5) % 8];
+    }
+
+    return {{g_zstd_reference_text, sizeof g_zstd_reference_text, text},
+            {g_zstd_reference_mixed, sizeof g_zstd_reference_mixed, mixed},
+            {g_zstd_reference_words, sizeof g_zstd_reference_words, sentence}};
+}
+
+std::vector<ReferenceData> lz4_reference_blocks()
+{
+    auto frames = zstd_reference_frames();
+    return {{g_lz4_reference_text, sizeof g_lz4_reference_text, frames[0].uncompressed},
+            {g_lz4_reference_mixed, sizeof g_lz4_reference_mixed, frames[1].uncompressed}};
+}
+
+BinaryData reference_dictionary_content()
+{
+    return {reinterpret_cast<const char*>(g_zstd_reference_dictionary), sizeof g_zstd_reference_dictionary};
+}
+
 } // anonymous namespace
 
 
@@ -364,6 +513,446 @@ TEST_IF(Compression_Allocate_And_Compress_Large, false)
     allocate_and_compress_decompress_compare(test_context, size_t(uncompressed_size), content.get());
 }
 
+// The Zstd codec is checked for data which compresses well, data which does not, and data with long runs.
+TEST_IF(Compression_Zstd_RoundTrip, REALM_HAVE_ZSTD)
+{
+    size_t uncompressed_sizes[] = {0, 1, 12, 13, 100, 1 << 16, (1 << 20) + 7};
+    test_util::Random random(test_util::produce_nondeterministic_random_seed());
+    compression::CompressMemoryArena compress_memory_arena;
+    std::vector<char> compressed_buf;
+
+    for (size_t uncompressed_size : uncompressed_sizes) {
+        std::unique_ptr<char[]> contents[] = {generate_compressible_data(uncompressed_size),
+                                              generate_non_compressible_data(uncompressed_size),
+                                              std::make_unique<char[]>(uncompressed_size)};
+        for (size_t i = 0; i < uncompressed_size; i += random.draw_int<size_t>(1, 1000))
+            contents[2][i] = random.draw_int<char>();
+
+        for (auto& content : contents) {
+            BinaryData uncompressed{content.get(), uncompressed_size};
+            size_t compressed_size = compression::allocate_and_compress(compress_memory_arena, uncompressed,
+                                                                        compressed_buf, compression::Codec::zstd);
+            CHECK_LESS_EQUAL(compressed_size, compression::zstd_compress_bound(uncompressed_size));
+
+            auto decompressed_buf = std::make_unique<char[]>(uncompressed_size);
+            std::error_code ec = compression::decompress(compression::Codec::zstd, compressed_buf.data(),
+                                                         compressed_size, decompressed_buf.get(), uncompressed_size);
+            CHECK_NOT(ec);
+            CHECK(std::equal(content.get(), content.get() + uncompressed_size, decompressed_buf.get()));
+        }
+    }
+
+    size_t uncompressed_size = 1 << 20;
+    auto content = generate_compressible_data(uncompressed_size);
+    size_t compressed_size = compression::allocate_and_compress(
+        compress_memory_arena, {content.get(), uncompressed_size}, compressed_buf, compression::Codec::zstd);
+    CHECK_LESS(compressed_size, uncompressed_size / 10);
+
+    // A buffer which is too small is reported, not overrun
+    char small_buf[8];
+    CHECK_EQUAL(compression::zstd_compress(content.get(), uncompressed_size, small_buf, sizeof(small_buf),
+                                           compressed_size, compress_memory_arena),
+                compression::error::compress_buffer_too_small);
+}
+
+TEST_IF(Compression_Zstd_Reference_Frames, REALM_HAVE_ZSTD)
+{
+    for (auto& frame : zstd_reference_frames()) {
+        size_t uncompressed_size = frame.uncompressed.size();
+        std::vector<char> decompressed(uncompressed_size);
+        std::error_code ec = compression::zstd_decompress(reinterpret_cast<const char*>(frame.data), frame.size,
+                                                          decompressed.data(), uncompressed_size);
+        CHECK_NOT(ec);
+        CHECK(std::equal(decompressed.begin(), decompressed.end(), frame.uncompressed.begin()));
+
+        // Our own output must be accepted by the same decoder, and should not
+        // be much larger than that of the reference
+        compression::CompressMemoryArena compress_memory_arena;
+        std::vector<char> compressed_buf;
+        size_t compressed_size = compression::allocate_and_compress(
+            compress_memory_arena, {frame.uncompressed.data(), uncompressed_size}, compressed_buf,
+            compression::Codec::zstd);
+        CHECK_LESS_EQUAL(compressed_size, frame.size + frame.size / 2);
+        CHECK_NOT(compression::zstd_decompress(compressed_buf.data(), compressed_size, decompressed.data(),
+                                               uncompressed_size));
+        CHECK(std::equal(decompressed.begin(), decompressed.end(), frame.uncompressed.begin()));
+    }
+
+    // The frame that refers to a dictionary is only accepted with that
+    // dictionary
+    std::string sentence = zstd_reference_frames().back().uncompressed;
+    const char* frame = reinterpret_cast<const char*>(g_zstd_reference_dictionary_frame);
+    size_t frame_size = sizeof g_zstd_reference_dictionary_frame;
+    std::vector<char> decompressed(sentence.size());
+    CHECK_EQUAL(compression::zstd_decompress(frame, frame_size, decompressed.data(), decompressed.size()),
+                compression::error::corrupt_input);
+    compression::ZstdDictionary dictionary{reference_dictionary_content()};
+    CHECK_EQUAL(dictionary.get_id(), 383324145u);
+    CHECK_NOT(
+        compression::zstd_decompress(frame, frame_size, decompressed.data(), decompressed.size(), &dictionary));
+    CHECK(std::equal(decompressed.begin(), decompressed.end(), sentence.begin()));
+}
+
+TEST_IF(Compression_Zstd_Dictionary, REALM_HAVE_ZSTD)
+{
+    compression::ZstdDictionary dictionary{reference_dictionary_content()};
+    std::string sentence = zstd_reference_frames().back().uncompressed;
+    size_t uncompressed_size = sentence.size();
+    compression::CompressMemoryArena compress_memory_arena;
+    std::vector<char> compressed_buf;
+    std::vector<char> decompressed(uncompressed_size);
+
+    // A small body compresses better with a dictionary trained on similar
+    // data
+    size_t plain_size = compression::allocate_and_compress(
+        compress_memory_arena, {sentence.data(), uncompressed_size}, compressed_buf, compression::Codec::zstd);
+    size_t compressed_size =
+        compression::allocate_and_compress(compress_memory_arena, {sentence.data(), uncompressed_size},
+                                           compressed_buf, compression::Codec::zstd, &dictionary);
+    CHECK_LESS(compressed_size, plain_size);
+    CHECK_NOT(compression::decompress(compression::Codec::zstd, compressed_buf.data(), compressed_size,
+                                      decompressed.data(), uncompressed_size, &dictionary));
+    CHECK(std::equal(decompressed.begin(), decompressed.end(), sentence.begin()));
+
+    // Missing and different dictionaries are rejected. The other dictionary
+    // differs only by its ID.
+    std::vector<char> other_content(g_zstd_reference_dictionary,
+                                    g_zstd_reference_dictionary + sizeof g_zstd_reference_dictionary);
+    other_content[4] ^= 1;
+    compression::ZstdDictionary other{{other_content.data(), other_content.size()}};
+    CHECK_NOT_EQUAL(other.get_id(), dictionary.get_id());
+    CHECK_EQUAL(compression::zstd_decompress(compressed_buf.data(), compressed_size, decompressed.data(),
+                                             uncompressed_size),
+                compression::error::corrupt_input);
+    CHECK_EQUAL(compression::zstd_decompress(compressed_buf.data(), compressed_size, decompressed.data(),
+                                             uncompressed_size, &other),
+                compression::error::corrupt_input);
+
+    // A frame without a dictionary is accepted on a session that has one
+    compression::allocate_and_compress(compress_memory_arena, {sentence.data(), uncompressed_size}, compressed_buf,
+                                       compression::Codec::zstd);
+    CHECK_NOT(compression::zstd_decompress(compressed_buf.data(), plain_size, decompressed.data(),
+                                           uncompressed_size, &dictionary));
+    CHECK(std::equal(decompressed.begin(), decompressed.end(), sentence.begin()));
+
+    // Content that is not a dictionary, and a dictionary without an ID
+    CHECK_SYSTEM_ERROR(compression::ZstdDictionary(BinaryData{sentence.data(), 64}),
+                       compression::error::invalid_input);
+    std::fill(other_content.begin() + 4, other_content.begin() + 8, 0);
+    CHECK_SYSTEM_ERROR(compression::ZstdDictionary(BinaryData{other_content.data(), other_content.size()}),
+                       compression::error::invalid_input);
+
+    TEST_PATH(path);
+    {
+        util::File file{path, util::File::mode_Write};
+        file.write(reinterpret_cast<const char*>(g_zstd_reference_dictionary), sizeof g_zstd_reference_dictionary);
+    }
+    CHECK_EQUAL(compression::ZstdDictionary::load(path)->get_id(), dictionary.get_id());
+}
+
+// Every prefix of a valid frame is rejected, without writing outside of the
+// output buffer
+TEST_IF(Compression_Zstd_Truncated_Input, REALM_HAVE_ZSTD)
+{
+    constexpr size_t guard_size = 64;
+    for (auto& frame : zstd_reference_frames()) {
+        size_t uncompressed_size = frame.uncompressed.size();
+        std::vector<char> buffer(uncompressed_size + guard_size, 'G');
+        for (size_t size = 0; size < frame.size; ++size) {
+            std::error_code ec = compression::zstd_decompress(reinterpret_cast<const char*>(frame.data), size,
+                                                              buffer.data(), uncompressed_size);
+            CHECK(ec == compression::error::corrupt_input ||
+                  ec == compression::error::incorrect_decompressed_size);
+            CHECK(std::all_of(buffer.begin() + uncompressed_size, buffer.end(), [](char c) {
+                return c == 'G';
+            }));
+        }
+    }
+}
+
+TEST_IF(Compression_Zstd_Malformed_Input, REALM_HAVE_ZSTD)
+{
+    std::vector<char> buffer(1024);
+    auto text = zstd_reference_frames().front();
+    const char* data = reinterpret_cast<const char*>(text.data);
+    size_t size = text.uncompressed.size();
+
+    // An empty input, and input which is not a frame
+    CHECK_EQUAL(compression::zstd_decompress(data, 0, buffer.data(), 0), compression::error::corrupt_input);
+    CHECK_EQUAL(compression::zstd_decompress(text.uncompressed.data(), 64, buffer.data(), 64),
+                compression::error::corrupt_input);
+    // An output of the wrong size
+    CHECK_EQUAL(compression::zstd_decompress(data, text.size, buffer.data(), size - 1),
+                compression::error::incorrect_decompressed_size);
+    CHECK_EQUAL(compression::zstd_decompress(data, text.size, buffer.data(), size + 1),
+                compression::error::incorrect_decompressed_size);
+    // Trailing garbage after the frame, and a second frame
+    std::vector<char> extended(data, data + text.size);
+    extended.push_back(0);
+    CHECK_EQUAL(compression::zstd_decompress(extended.data(), extended.size(), buffer.data(), size),
+                compression::error::corrupt_input);
+    extended.pop_back();
+    extended.insert(extended.end(), data, data + text.size);
+    CHECK_EQUAL(compression::zstd_decompress(extended.data(), extended.size(), buffer.data(), 2 * size),
+                compression::error::corrupt_input);
+
+    // Corrupting any byte of a valid frame either yields output of the
+    // expected size or an error, and never writes outside of the output
+    // buffer
+    constexpr size_t guard_size = 64;
+    test_util::Random random(test_util::produce_nondeterministic_random_seed());
+    for (auto& reference : zstd_reference_frames()) {
+        size_t uncompressed_size = reference.uncompressed.size();
+        std::vector<char> out(uncompressed_size + guard_size, 'G');
+        std::vector<char> frame(reference.data, reference.data + reference.size);
+        for (size_t i = 0; i < frame.size(); ++i) {
+            unsigned char values[] = {0x00, 0x0f, 0xf0, 0xff, random.draw_int<unsigned char>()};
+            for (unsigned char value : values) {
+                char original = frame[i];
+                frame[i] = char(value);
+                std::error_code ec =
+                    compression::zstd_decompress(frame.data(), frame.size(), out.data(), uncompressed_size);
+                CHECK(!ec || ec == compression::error::corrupt_input ||
+                      ec == compression::error::incorrect_decompressed_size);
+                CHECK(std::all_of(out.begin() + uncompressed_size, out.end(), [](char c) {
+                    return c == 'G';
+                }));
+                frame[i] = original;
+            }
+        }
+    }
+}
+
+TEST_IF(Compression_LZ4_RoundTrip, REALM_HAVE_LZ4)
+{
+    size_t uncompressed_sizes[] = {0, 1, 12, 13, 100, 1 << 16, (1 << 20) + 7};
+    compression::CompressMemoryArena compress_memory_arena;
+    std::vector<char> compressed_buf;
+
+    for (size_t uncompressed_size : uncompressed_sizes) {
+        std::unique_ptr<char[]> contents[] = {generate_compressible_data(uncompressed_size),
+                                              generate_non_compressible_data(uncompressed_size)};
+        for (auto& content : contents) {
+            BinaryData uncompressed{content.get(), uncompressed_size};
+            size_t compressed_size = compression::allocate_and_compress(compress_memory_arena, uncompressed,
+                                                                        compressed_buf, compression::Codec::lz4);
+            CHECK_LESS_EQUAL(compressed_size, compression::lz4_compress_bound(uncompressed_size));
+
+            auto decompressed_buf = std::make_unique<char[]>(uncompressed_size);
+            std::error_code ec = compression::decompress(compression::Codec::lz4, compressed_buf.data(),
+                                                         compressed_size, decompressed_buf.get(), uncompressed_size);
+            CHECK_NOT(ec);
+            CHECK(std::equal(content.get(), content.get() + uncompressed_size, decompressed_buf.get()));
+        }
+    }
+
+    size_t uncompressed_size = 1 << 20;
+    auto content = generate_compressible_data(uncompressed_size);
+    size_t compressed_size = compression::allocate_and_compress(
+        compress_memory_arena, {content.get(), uncompressed_size}, compressed_buf, compression::Codec::lz4);
+    CHECK_LESS(compressed_size, uncompressed_size / 10);
+
+    // A buffer which is too small is reported, not overrun
+    char small_buf[8];
+    CHECK_EQUAL(compression::lz4_compress(content.get(), uncompressed_size, small_buf, sizeof(small_buf),
+                                          compressed_size, compress_memory_arena),
+                compression::error::compress_buffer_too_small);
+}
+
+TEST_IF(Compression_LZ4_Reference_Blocks, REALM_HAVE_LZ4)
+{
+    for (auto& block : lz4_reference_blocks()) {
+        size_t uncompressed_size = block.uncompressed.size();
+        std::vector<char> decompressed(uncompressed_size);
+        std::error_code ec = compression::lz4_decompress(reinterpret_cast<const char*>(block.data), block.size,
+                                                         decompressed.data(), uncompressed_size);
+        CHECK_NOT(ec);
+        CHECK(std::equal(decompressed.begin(), decompressed.end(), block.uncompressed.begin()));
+
+        compression::CompressMemoryArena compress_memory_arena;
+        std::vector<char> compressed_buf;
+        size_t compressed_size = compression::allocate_and_compress(
+            compress_memory_arena, {block.uncompressed.data(), uncompressed_size}, compressed_buf,
+            compression::Codec::lz4);
+        CHECK_LESS_EQUAL(compressed_size, block.size + block.size / 2);
+        CHECK_NOT(compression::lz4_decompress(compressed_buf.data(), compressed_size, decompressed.data(),
+                                              uncompressed_size));
+        CHECK(std::equal(decompressed.begin(), decompressed.end(), block.uncompressed.begin()));
+    }
+}
+
+// Every prefix of a valid block is rejected, without writing outside of the
+// output buffer
+TEST_IF(Compression_LZ4_Truncated_Input, REALM_HAVE_LZ4)
+{
+    constexpr size_t guard_size = 64;
+    for (auto& block : lz4_reference_blocks()) {
+        size_t uncompressed_size = block.uncompressed.size();
+        std::vector<char> buffer(uncompressed_size + guard_size, 'G');
+        for (size_t size = 0; size < block.size; ++size) {
+            std::error_code ec = compression::lz4_decompress(reinterpret_cast<const char*>(block.data), size,
+                                                             buffer.data(), uncompressed_size);
+            CHECK(ec == compression::error::corrupt_input ||
+                  ec == compression::error::incorrect_decompressed_size);
+            CHECK(std::all_of(buffer.begin() + uncompressed_size, buffer.end(), [](char c) {
+                return c == 'G';
+            }));
+        }
+    }
+}
+
+TEST_IF(Compression_LZ4_Malformed_Input, REALM_HAVE_LZ4)
+{
+    std::vector<char> buffer(1024);
+    auto text = lz4_reference_blocks().front();
+    const char* data = reinterpret_cast<const char*>(text.data);
+    size_t size = text.uncompressed.size();
+
+    // An empty input
+    CHECK_EQUAL(compression::lz4_decompress(data, 0, buffer.data(), 0), compression::error::corrupt_input);
+    // An output of the wrong size
+    CHECK_EQUAL(compression::lz4_decompress(data, text.size, buffer.data(), size - 1),
+                compression::error::corrupt_input);
+    CHECK_EQUAL(compression::lz4_decompress(data, text.size, buffer.data(), size + 1),
+                compression::error::incorrect_decompressed_size);
+    // Trailing garbage after the block
+    std::vector<char> extended(data, data + text.size);
+    extended.push_back(0);
+    CHECK_EQUAL(compression::lz4_decompress(extended.data(), extended.size(), buffer.data(), size),
+                compression::error::corrupt_input);
+
+    // Corrupting any byte of a valid block either yields output of the
+    // expected size or an error, and never writes outside of the output
+    // buffer
+    constexpr size_t guard_size = 64;
+    test_util::Random random(test_util::produce_nondeterministic_random_seed());
+    for (auto& reference : lz4_reference_blocks()) {
+        size_t uncompressed_size = reference.uncompressed.size();
+        std::vector<char> out(uncompressed_size + guard_size, 'G');
+        std::vector<char> block(reference.data, reference.data + reference.size);
+        for (size_t i = 0; i < block.size(); ++i) {
+            unsigned char values[] = {0x00, 0x0f, 0xf0, 0xff, random.draw_int<unsigned char>()};
+            for (unsigned char value : values) {
+                char original = block[i];
+                block[i] = char(value);
+                std::error_code ec =
+                    compression::lz4_decompress(block.data(), block.size(), out.data(), uncompressed_size);
+                CHECK(!ec || ec == compression::error::corrupt_input ||
+                      ec == compression::error::incorrect_decompressed_size);
+                CHECK(std::all_of(out.begin() + uncompressed_size, out.end(), [](char c) {
+                    return c == 'G';
+                }));
+                block[i] = original;
+            }
+        }
+    }
+}
+
+// Without the libraries, the codecs report that they are not available
+TEST_IF(Compression_Unavailable_Codecs, !REALM_HAVE_ZSTD || !REALM_HAVE_LZ4)
+{
+    char buffer[16] = {};
+    compression::CompressMemoryArena compress_memory_arena;
+    std::vector<char> compressed_buf;
+    size_t compressed_size;
+    if (!compression::is_codec_available(compression::Codec::zstd)) {
+        CHECK_EQUAL(compression::zstd_decompress(buffer, 8, buffer + 8, 8), compression::error::codec_unavailable);
+        CHECK_SYSTEM_ERROR(compression::ZstdDictionary(reference_dictionary_content()),
+                           compression::error::codec_unavailable);
+        CHECK_SYSTEM_ERROR(compression::allocate_and_compress(compress_memory_arena, {buffer, 8}, compressed_buf,
+                                                              compression::Codec::zstd),
+                           compression::error::codec_unavailable);
+    }
+    if (!compression::is_codec_available(compression::Codec::lz4)) {
+        CHECK_EQUAL(compression::lz4_compress(buffer, 8, buffer + 8, 8, compressed_size, compress_memory_arena),
+                    compression::error::codec_unavailable);
+        CHECK_EQUAL(compression::lz4_decompress(buffer, 8, buffer + 8, 8), compression::error::codec_unavailable);
+    }
+}
+
+TEST(Compression_Codecs)
+{
+    CHECK(compression::is_valid_codec(0));
+    CHECK(compression::is_valid_codec(1));
+    CHECK(compression::is_valid_codec(2));
+    CHECK(compression::is_valid_codec(3));
+    CHECK_NOT(compression::is_valid_codec(4));
+    CHECK_NOT(compression::is_valid_codec(-1));
+    CHECK(compression::is_codec_available(compression::Codec::none));
+    CHECK(compression::is_codec_available(compression::Codec::deflate));
+    CHECK_EQUAL(compression::is_codec_available(compression::Codec::zstd), bool(REALM_HAVE_ZSTD));
+    CHECK_EQUAL(compression::is_codec_available(compression::Codec::lz4), bool(REALM_HAVE_LZ4));
+
+    // A peer speaking protocol version 1 can only send the <is body
+    // compressed> flag
+    CHECK(_impl::is_valid_body_codec(1, 0));
+    CHECK(_impl::is_valid_body_codec(1, 1));
+    CHECK_NOT(_impl::is_valid_body_codec(1, 2));
+    CHECK_NOT(_impl::is_valid_body_codec(1, 3));
+    CHECK_EQUAL(_impl::is_valid_body_codec(2, 2), bool(REALM_HAVE_ZSTD));
+    CHECK_EQUAL(_impl::is_valid_body_codec(2, 3), bool(REALM_HAVE_LZ4));
+    CHECK_NOT(_impl::is_valid_body_codec(2, 4));
+
+    size_t uncompressed_size = 10000;
+    auto content = generate_compressible_data(uncompressed_size);
+    compression::CompressMemoryArena compress_memory_arena;
+    std::vector<char> compressed_buf;
+    auto decompressed_buf = std::make_unique<char[]>(uncompressed_size);
+    for (auto codec : {compression::Codec::deflate, compression::Codec::zstd, compression::Codec::lz4}) {
+        if (!compression::is_codec_available(codec))
+            continue;
+        size_t compressed_size = compression::allocate_and_compress(
+            compress_memory_arena, {content.get(), uncompressed_size}, compressed_buf, codec);
+        CHECK_NOT(compression::decompress(codec, compressed_buf.data(), compressed_size, decompressed_buf.get(),
+                                          uncompressed_size));
+        CHECK(std::equal(content.get(), content.get() + uncompressed_size, decompressed_buf.get()));
+    }
+    CHECK_NOT(compression::decompress(compression::Codec::none, content.get(), uncompressed_size,
+                                      decompressed_buf.get(), uncompressed_size));
+    CHECK_EQUAL(compression::decompress(compression::Codec::none, content.get(), uncompressed_size - 1,
+                                        decompressed_buf.get(), uncompressed_size),
+                compression::error::incorrect_decompressed_size);
+}
+
+TEST(Compression_Codec_Negotiation)
+{
+    using compression::Codec;
+    using compression::codec_set;
+    compression::CodecSet zlib_only = codec_set(Codec::none) | codec_set(Codec::deflate);
+    compression::CodecSet all = zlib_only | codec_set(Codec::zstd) | codec_set(Codec::lz4);
+
+    CHECK_EQUAL(_impl::format_codec_list(all), "deflate,zstd,lz4");
+    CHECK_EQUAL(_impl::format_codec_list(zlib_only), "deflate");
+    CHECK_EQUAL(_impl::parse_codec_list(""), zlib_only);
+    CHECK_EQUAL(_impl::parse_codec_list("deflate,zstd,lz4"), all);
+    CHECK_EQUAL(_impl::parse_codec_list(" lz4 ,\tzstd, brotli,,"), all);
+    CHECK_EQUAL(_impl::parse_codec_list("zstd2,LZ4,none"), zlib_only);
+    CHECK_EQUAL(_impl::parse_codec_list(_impl::format_codec_list(compression::get_available_codecs())),
+                compression::get_available_codecs());
+
+    using Ids = std::vector<std::uint_fast32_t>;
+    CHECK(_impl::parse_zstd_dictionary_list("") == Ids{});
+    CHECK(_impl::parse_zstd_dictionary_list("383324145, 7,0,x1,4294967295,4294967296,-3") ==
+          (Ids{383324145, 7, 4294967295}));
+
+    // Protocol version 1 only knows zlib
+    CHECK(_impl::select_body_codec(1, all, 0, true) == Codec::deflate);
+    // Nothing but zlib is common
+    CHECK(_impl::select_body_codec(2, zlib_only, 0, true) == Codec::deflate);
+    CHECK(_impl::select_body_codec(2, all, codec_set(Codec::zstd) | codec_set(Codec::lz4), true) ==
+          Codec::deflate);
+    if (REALM_HAVE_ZSTD) {
+        CHECK(_impl::select_body_codec(2, zlib_only | codec_set(Codec::zstd), 0, false) == Codec::zstd);
+        CHECK(_impl::select_body_codec(2, all, codec_set(Codec::lz4), false) == Codec::zstd);
+        // A dictionary makes Zstd the first choice
+        CHECK(_impl::select_body_codec(2, all, 0, true) == Codec::zstd);
+    }
+    if (REALM_HAVE_LZ4) {
+        CHECK(_impl::select_body_codec(2, all, 0, false) == Codec::lz4);
+        CHECK(_impl::select_body_codec(2, all, codec_set(Codec::zstd), true) == Codec::lz4);
+    }
+}
+
 TEST(Compression_File_1)
 {
     TEST_DIR(dir);
@@ -54,6 +54,7 @@
 
 #include <realm.hpp>
 #include <realm/history.hpp>
+#include <realm/parser/parse_cache.hpp>
 #include <realm/parser/parser.hpp>
 #include <realm/parser/query_builder.hpp>
 #include <realm/query_expression.hpp>
@@ -789,6 +790,41 @@ TEST(Parser_StringOperations)
     CHECK_THROW_ANY(verify_query(test_context, t, "NULL LIKE[c] name", 1));
 }
 
+TEST(Parser_FullText)
+{
+    Group g;
+    TableRef t = g.add_table("book");
+    ColKey title_col = t->add_column(type_String, "title", true);
+    ColKey link_col = t->add_column(*t, "sequel");
+    std::vector<std::string> titles = {"The Quick Brown Fox", "A quick fix", "Brown bread, brown rice",
+                                       "Foxes and hounds"};
+    for (auto& title : titles)
+        t->create_object().set(title_col, StringData(title));
+    t->create_object(); // null
+    t->begin()->set(link_col, t->begin()->get_key());
+
+    for (bool with_index : {false, true}) {
+        if (with_index)
+            t->add_search_index(title_col, IndexType::Fulltext);
+        verify_query(test_context, t, "title TEXT 'quick'", 2);
+        verify_query(test_context, t, "title TEXT 'BROWN quick'", 1);
+        verify_query(test_context, t, "title TEXT 'brown'", 2);
+        verify_query(test_context, t, "title MATCHES 'fox'", 1);
+        verify_query(test_context, t, "title TEXT 'hound'", 0);
+        verify_query(test_context, t, "title TEXT ''", 0);
+        verify_query(test_context, t, "title TEXT 'quick' AND title CONTAINS 'fix'", 1);
+        verify_query(test_context, t, "NOT title TEXT 'brown'", 3);
+    }
+
+    // Only a property of the queried object can be searched for a literal
+    CHECK_THROW_ANY(verify_query(test_context, t, "sequel.title TEXT 'quick'", 1));
+    CHECK_THROW_ANY(verify_query(test_context, t, "'quick' TEXT title", 1));
+    CHECK_THROW_ANY(verify_query(test_context, t, "title TEXT title", 1));
+    // Words are always matched case folded
+    CHECK_THROW_ANY(verify_query(test_context, t, "title TEXT[c] 'quick'", 2));
+    CHECK_THROW_ANY(verify_query(test_context, t, "title MATCHES[c] 'fox'", 1));
+}
+
 
 TEST(Parser_Timestamps)
 {
@@ -1867,7 +1903,7 @@ TEST(Parser_list_of_primitive_ints)
     auto col_int = t->add_column(type_Int, "single_int");
     auto col_int_list_nullable = t->add_column_list(type_Int, "integers_nullable", true);
     auto col_int_nullable = t->add_column(type_Int, "single_int_nullable", true);
-    CHECK_THROW_ANY(t->add_search_index(col_int_list));
+    CHECK_THROW_ANY(t->add_search_index(col_int_list, IndexType::Ordered));
 
     size_t num_objects = 10;
     for (size_t i = 0; i < num_objects; ++i) {
@@ -2067,7 +2103,7 @@ TEST(Parser_list_of_primitive_strings)
 
     constexpr bool nullable = true;
     auto col_str_list = t->add_column_list(type_String, "strings", nullable);
-    CHECK_THROW_ANY(t->add_search_index(col_str_list));
+    CHECK_THROW_ANY(t->add_search_index(col_str_list, IndexType::Ordered));
 
     auto get_string = [](size_t i) -> std::string { return util::format("string_%1", i); };
     size_t num_populated_objects = 10;
@@ -4424,4 +4460,139 @@ TEST(Parser_Decimal128)
 }
 
 
+TEST(Parser_ParseCache)
+{
+    parser::ParseCache cache(2);
+    auto a = cache.parse("age == 1");
+    auto b = cache.parse("age == 2");
+    CHECK_EQUAL(cache.size(), 2);
+    CHECK_EQUAL(cache.get_miss_count(), 2);
+    CHECK(cache.parse("age == 1") == a);
+    CHECK_EQUAL(cache.get_hit_count(), 1);
+
+    // "age == 2" is now the least recently used entry
+    auto c = cache.parse("age == 3");
+    CHECK_EQUAL(cache.size(), 2);
+    CHECK(cache.parse("age == 1") == a);
+    CHECK(cache.parse("age == 3") == c);
+    CHECK(cache.parse("age == 2") != b);
+    CHECK_EQUAL(cache.get_hit_count(), 3);
+    CHECK_EQUAL(cache.get_miss_count(), 4);
+
+    // Parse errors are not cached
+    CHECK_THROW_ANY(cache.parse("age =="));
+    CHECK_THROW_ANY(cache.parse("age =="));
+    CHECK_EQUAL(cache.size(), 2);
+
+    cache.set_capacity(1);
+    CHECK_EQUAL(cache.size(), 1);
+    CHECK(cache.parse("age == 2") != b);
+    CHECK_EQUAL(cache.get_hit_count(), 4);
+
+    cache.set_capacity(0);
+    CHECK_EQUAL(cache.size(), 0);
+    CHECK(cache.parse("age == 1") != cache.parse("age == 1"));
+    CHECK_EQUAL(cache.size(), 0);
+
+    cache.clear();
+    CHECK_EQUAL(cache.get_hit_count(), 0);
+    CHECK_EQUAL(cache.get_miss_count(), 0);
+}
+
+TEST(Parser_ParseCacheRebindsArguments)
+{
+    Group g;
+    TableRef table = g.add_table("table");
+    auto col = table->add_column(type_Int, "age");
+    for (int i = 0; i < 10; ++i)
+        table->create_object().set(col, i % 3);
+
+    // A cache of its own, as other tests use the default one concurrently
+    parser::ParseCache cache;
+    auto count = [&](TableRef t, util::Any arg) {
+        query_builder::AnyContext ctx;
+        query_builder::ArgumentConverter<util::Any, query_builder::AnyContext> args(ctx, &arg, 1);
+        Query q = t->where();
+        query_builder::apply_predicate(q, cache.parse("age == $0")->predicate, args);
+        return q.count();
+    };
+    CHECK_EQUAL(count(table, int64_t(0)), 4);
+    CHECK_EQUAL(count(table, int64_t(1)), 3);
+    CHECK_EQUAL(count(table, int64_t(5)), 0);
+    CHECK_EQUAL(cache.get_miss_count(), 1);
+    CHECK_EQUAL(cache.get_hit_count(), 2);
+
+    // The same string is bound to the columns of another table
+    TableRef other = g.add_table("other");
+    auto other_col = other->add_column(type_Int, "age", true);
+    other->create_object();
+    other->create_object().set(other_col, 1);
+    CHECK_EQUAL(count(other, realm::null()), 1);
+    CHECK_EQUAL(count(other, int64_t(1)), 1);
+    CHECK_EQUAL(cache.get_miss_count(), 1);
+    CHECK_EQUAL(cache.get_hit_count(), 4);
+
+    // Table::query() goes through the default cache
+    CHECK_EQUAL(table->query("age == $0", {2}).count(), 3);
+}
+
+TEST(Parser_QueryTemplate)
+{
+    Group g;
+    TableRef person = g.add_table("class_Person");
+    TableRef dog = g.add_table("class_Dog");
+    auto col_age = person->add_column(type_Int, "age");
+    auto col_dog = person->add_column(*dog, "dog");
+    auto col_dog_name = dog->add_column(type_String, "name");
+    auto rex = dog->create_object().set(col_dog_name, "Rex");
+    auto fido = dog->create_object().set(col_dog_name, "Fido");
+    for (int i = 0; i < 10; ++i)
+        person->create_object().set(col_age, i).set(col_dog, i % 2 ? rex.get_key() : fido.get_key());
+
+    parser::ParseCache cache;
+    auto count = [&](const std::string& query, std::vector<util::Any> args, parser::KeyPathMapping mapping = {}) {
+        Query q = person->where();
+        auto query_template = cache.get_template(*person, query, mapping);
+        query_builder::AnyContext ctx;
+        query_builder::ArgumentConverter<util::Any, query_builder::AnyContext> arguments(ctx, args.data(),
+                                                                                       args.size());
+        query_template->apply(q, arguments, mapping);
+        return q.count();
+    };
+
+    // Only the arguments are bound anew
+    CHECK_EQUAL(count("age > $0 && dog.name == $1", {Int(3), String("Rex")}), 3);
+    CHECK_EQUAL(count("age > $0 && dog.name == $1", {Int(0), String("Fido")}), 4);
+    CHECK_EQUAL(count("age > $0 && dog.name == $1", {Int(8), String("Rex")}), 1);
+    CHECK_EQUAL(cache.get_num_templates(), 1);
+    CHECK_EQUAL(cache.get_miss_count(), 1);
+
+    // A template per table and mapping, which share the parse result
+    cache.get_template(*dog, "age > $0 && dog.name == $1", {});
+    parser::KeyPathMapping mapping;
+    mapping.add_mapping(person, "years", "age");
+    CHECK_EQUAL(count("age > $0 && dog.name == $1", {Int(3), String("Rex")}, mapping), 3);
+    CHECK_EQUAL(count("years > $0", {Int(3)}, mapping), 6);
+    CHECK_EQUAL(cache.get_num_templates(), 4);
+    CHECK_EQUAL(cache.get_miss_count(), 2);
+
+    // The keypaths are resolved again after the schema has changed
+    dog->rename_column(col_dog_name, "nickname");
+    auto col_new_name = dog->add_column(type_String, "name");
+    dog->get_object(rex.get_key()).set(col_new_name, "Fido");
+    CHECK_EQUAL(count("age > $0 && dog.name == $1", {Int(3), String("Rex")}), 0);
+    CHECK_EQUAL(count("age > $0 && dog.name == $1", {Int(3), String("Fido")}), 3);
+    person->remove_column(col_dog);
+    CHECK_THROW_ANY(count("age > $0 && dog.name == $1", {Int(3), String("Fido")}));
+    CHECK_EQUAL(count("years > $0", {Int(3)}, mapping), 6);
+
+    // Keypaths which only resolve inside a subquery are not taken from it
+    auto col_friends = person->add_column_list(*person, "friends");
+    for (auto& obj : *person)
+        obj.get_linklist(col_friends).add(obj.get_key());
+    CHECK_EQUAL(count("SUBQUERY(friends, $x, $x.age > $0).@count > 0", {Int(6)}), 3);
+    CHECK_THROW_ANY(count("SUBQUERY(friends, $x, $x.age > $0).@count > 0 && $x.age > 0", {Int(6)}));
+}
+
+
 #endif // TEST_PARSER
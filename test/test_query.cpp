@@ -5839,4 +5839,97 @@ TEST(Query_OptimalNode)
     // std::cout << "cnt: " << cnt << " dur3: " << dur3 << " us" << std::endl;
 }
 
+TEST(Query_ParallelEvaluation)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    auto db = DB::create(*hist, DBOptions(crypt_key()));
+    ColKey col_int, col_double;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int", true);
+        col_double = table->add_column(type_Double, "double");
+        Random random(random_int<unsigned long>());
+        // Spans many clusters
+        for (int i = 0; i < 10000; i++) {
+            auto obj = table->create_object();
+            if (i % 13)
+                obj.set(col_int, random.draw_int<int64_t>(-1000, 1000));
+            obj.set(col_double, random.draw_float<double>());
+        }
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    for (size_t max_threads : {2, 3, 8, 100000}) {
+        Query sequential = table->where().greater(col_int, 100).less(col_double, 0.5);
+        Query parallel = sequential;
+        parallel.set_max_threads(max_threads);
+
+        auto tv1 = sequential.find_all();
+        auto tv2 = parallel.find_all();
+        CHECK_EQUAL(tv1.size(), tv2.size());
+        bool same_keys = true;
+        for (size_t i = 0; i < tv1.size() && i < tv2.size(); i++)
+            same_keys = same_keys && tv1.get_key(i) == tv2.get_key(i);
+        CHECK(same_keys);
+
+        CHECK_EQUAL(sequential.count(), parallel.count());
+        CHECK_EQUAL(sequential.sum_int(col_int), parallel.sum_int(col_int));
+        // Partial sums are added in a different order
+        CHECK_APPROXIMATELY_EQUAL(sequential.sum_double(col_double), parallel.sum_double(col_double), 1e-10);
+        CHECK_EQUAL(sequential.average_int(col_int), parallel.average_int(col_int));
+
+        ObjKey k1, k2;
+        CHECK_EQUAL(sequential.maximum_int(col_int, &k1), parallel.maximum_int(col_int, &k2));
+        CHECK_EQUAL(k1, k2);
+        CHECK_EQUAL(sequential.minimum_double(col_double, &k1), parallel.minimum_double(col_double, &k2));
+        CHECK_EQUAL(k1, k2);
+        CHECK_EQUAL(sequential.minimum_int(col_int, &k1), parallel.minimum_int(col_int, &k2));
+        CHECK_EQUAL(k1, k2);
+
+        // No matches at all
+        Query none = table->where().greater(col_int, 5000);
+        none.set_max_threads(max_threads);
+        CHECK_EQUAL(none.count(), 0);
+        CHECK_EQUAL(none.find_all().size(), 0);
+        size_t count = 1;
+        none.average_int(col_int, &count);
+        CHECK_EQUAL(count, 0);
+    }
+}
+
+TEST(Query_FindAllFromMatches)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    for (int i = 0; i < 100; i++)
+        table.create_object(ObjKey(i)).set(col_int, i % 7);
+
+    Query q = table.where().greater(col_int, 3);
+    std::vector<ObjKey> candidates{ObjKey(1), ObjKey(4), ObjKey(5), ObjKey(6), ObjKey(500)};
+    auto matching = q.find_matching(candidates);
+    CHECK_EQUAL(matching.size(), 3);
+    CHECK_EQUAL(matching[0], ObjKey(4));
+    CHECK_EQUAL(matching[1], ObjKey(5));
+    CHECK_EQUAL(matching[2], ObjKey(6));
+
+    std::vector<ObjKey> matches;
+    TableView all = q.find_all();
+    for (size_t i = 0; i < all.size(); i++)
+        matches.push_back(all.get_key(i));
+
+    DescriptorOrdering ordering;
+    ordering.append_sort(SortDescriptor({{col_int}}, {false}));
+    ordering.append_limit(LimitDescriptor(20));
+    TableView expected = q.find_all(ordering);
+    TableView tv = q.find_all(matches, ordering);
+    CHECK(tv.is_in_sync());
+    CHECK_EQUAL(tv.size(), expected.size());
+    for (size_t i = 0; i < tv.size() && i < expected.size(); i++)
+        CHECK_EQUAL(tv.get_key(i), expected.get_key(i));
+}
+
 #endif // TEST_QUERY
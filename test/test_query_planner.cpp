@@ -0,0 +1,273 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_QUERY_PLANNER
+
+#include <realm.hpp>
+#include <realm/history.hpp>
+
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+TEST(QueryPlanner_ColumnStatistics)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_str = table.add_column(type_String, "str");
+    auto col_list = table.add_column_list(type_Int, "list");
+    // The tolerances below hold for the sample drawn with this seed
+    Random random(6361);
+    for (int64_t i = 0; i < 2000; ++i) {
+        Obj obj = table.create_object();
+        // One value in twenty is null
+        if (i > 0 && random.draw_int_mod(20))
+            obj.set(col_int, random.draw_int_mod(10));
+        obj.set(col_str, "s" + util::to_string(i));
+    }
+
+    auto stats = table.get_column_statistics(col_int);
+    CHECK_EQUAL(stats->get_row_count(), 2000);
+    CHECK_EQUAL(stats->get_sample_size(), ColumnStatistics::max_sample_size);
+    // Sampling errors are well within these bounds
+    CHECK_LESS(std::abs(stats->null_fraction() - 0.05), 0.04);
+    CHECK_EQUAL(stats->estimated_cardinality(), 10);
+    CHECK_LESS(std::abs(stats->fraction_equal(3) - 0.095), 0.06);
+    CHECK_EQUAL(stats->fraction_equal(Mixed()), stats->null_fraction());
+    CHECK_LESS(std::abs(stats->fraction_less(5, false) - 0.475), 0.1);
+    CHECK_LESS(std::abs(stats->fraction_greater(7, true) - 0.285), 0.09);
+    CHECK_EQUAL(stats->fraction_less(Mixed(), true), 0);
+    CHECK(std::is_sorted(stats->get_values().begin(), stats->get_values().end(), [](Mixed a, Mixed b) {
+        return a.compare(b) < 0;
+    }));
+
+    // Unique values
+    auto str_stats = table.get_column_statistics(col_str);
+    CHECK_EQUAL(str_stats->estimated_cardinality(), 2000);
+    CHECK_EQUAL(str_stats->fraction_equal("none"), 1.0 / 2000);
+    CHECK_EQUAL(str_stats->fraction_equal("s0"), 1.0 / ColumnStatistics::max_sample_size);
+    CHECK(!table.get_column_statistics(col_list));
+
+    // Kept while the table is modified, until its number of rows has changed
+    // by more than an eighth
+    CHECK_EQUAL(table.get_column_statistics(col_int), stats);
+    table.begin()->set(col_int, 4);
+    CHECK_EQUAL(table.get_column_statistics(col_int), stats);
+    for (int64_t i = 0; i < 250; ++i)
+        table.create_object().set(col_int, 4);
+    CHECK_EQUAL(table.get_column_statistics(col_int), stats);
+    table.create_object().set(col_int, 4);
+    auto new_stats = table.get_column_statistics(col_int);
+    CHECK_NOT_EQUAL(new_stats, stats);
+    CHECK_EQUAL(new_stats->get_row_count(), 2251);
+
+    // All rows of small tables are sampled
+    Table small;
+    auto col = small.add_column(type_String, "str", true);
+    for (auto str : {"a", "b", "b", "c"})
+        small.create_object().set(col, str);
+    small.create_object();
+    auto small_stats = small.get_column_statistics(col);
+    CHECK_EQUAL(small_stats->get_sample_size(), 5);
+    CHECK_EQUAL(small_stats->fraction_equal("b"), 0.4);
+    CHECK_EQUAL(small_stats->fraction_equal("d"), 0);
+    CHECK_EQUAL(small_stats->fraction_equal(Mixed()), 0.2);
+    CHECK_EQUAL(small_stats->fraction_greater("a", false), 0.6);
+    CHECK_EQUAL(small_stats->estimated_cardinality(), 3);
+}
+
+TEST(QueryPlanner_StatisticsVersion)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto t = wt->add_table("table");
+        col = t->add_column(type_Int, "int");
+        t->add_search_index(col);
+        wt->add_table("other");
+        for (int64_t i = 0; i < 2000; ++i)
+            t->create_object().set(col, i % 100);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    auto stats = table->get_column_statistics(col);
+
+    // Commits that do not modify the table keep its statistics
+    {
+        auto wt = db->start_write();
+        wt->get_table("other")->create_object();
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->get_column_statistics(col), stats);
+
+    // A commit modifying the table discards them
+    {
+        auto wt = db->start_write();
+        wt->get_table("table")->begin()->set(col, 1000);
+        wt->commit();
+    }
+    rt->advance_read();
+    auto committed_stats = table->get_column_statistics(col);
+    CHECK_NOT_EQUAL(committed_stats, stats);
+
+    // Within a write transaction they are collected again after the first
+    // modification only, so that queries interleaved with modifications do
+    // not sample the table every time
+    rt->promote_to_write();
+    CHECK_EQUAL(table->get_column_statistics(col), committed_stats);
+    size_t count = 0;
+    for (auto& obj : *table) {
+        obj.set(col, obj.get<Int>(col) + 1);
+        count += table->where().equal(col, 50).count();
+    }
+    CHECK_EQUAL(count, 40020);
+    auto write_stats = table->get_column_statistics(col);
+    CHECK_NOT_EQUAL(write_stats, committed_stats);
+    table->begin()->set(col, 1001);
+    CHECK_EQUAL(table->get_column_statistics(col), write_stats);
+    rt->commit_and_continue_as_read();
+    CHECK_NOT_EQUAL(table->get_column_statistics(col), write_stats);
+}
+
+TEST(QueryPlanner_DrivingCondition)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_str = table.add_column(type_String, "str");
+    table.add_search_index(col_str);
+    for (int64_t i = 0; i < 5000; ++i)
+        table.create_object().set_all(i, i % 1000 ? "common" : "rare");
+
+    // The unselective index is not followed, the scan of the other column
+    // drives the search
+    Query q = table.where().equal(col_str, "common").equal(col_int, 1234);
+    QueryPlan plan = q.explain();
+    CHECK(!plan.index_driven);
+    CHECK_EQUAL(plan.conditions.size(), 2);
+    CHECK_EQUAL(plan.conditions[0].description, "int == 1234");
+    CHECK(!plan.conditions[0].uses_index);
+    CHECK_EQUAL(plan.conditions[0].actual_rows, 1);
+    CHECK_EQUAL(plan.conditions[1].description, "str == \"common\"");
+    CHECK(plan.conditions[1].uses_index);
+    CHECK_LESS(std::abs(plan.conditions[1].estimated_rows - 5000), 100);
+    CHECK_EQUAL(plan.conditions[1].actual_rows, 4995);
+    CHECK_EQUAL(plan.actual_rows, 1);
+    CHECK_EQUAL(q.count(), 1);
+    CHECK_EQUAL(q.find_all().size(), 1);
+    CHECK_EQUAL(table.get_object(q.find()).get<Int>(col_int), 1234);
+
+    // A selective index drives the search
+    q = table.where().greater(col_int, 10).equal(col_str, "rare");
+    plan = q.explain();
+    CHECK(plan.index_driven);
+    CHECK_EQUAL(plan.conditions[0].description, "str == \"rare\"");
+    CHECK_EQUAL(plan.conditions[0].actual_rows, 5);
+    CHECK_EQUAL(plan.conditions[1].actual_rows, 4989);
+    CHECK_EQUAL(plan.actual_rows, 4);
+    CHECK_EQUAL(q.count(), 4);
+    CHECK_EQUAL(q.find_all().size(), 4);
+
+    // The most selective of several scanned conditions is tested first
+    q = table.where().greater(col_int, 100).less(col_int, 4990).less(col_int, 200);
+    plan = q.explain();
+    CHECK_EQUAL(plan.conditions[0].description, "int < 200");
+    CHECK_EQUAL(plan.actual_rows, 99);
+    CHECK_EQUAL(q.count(), 99);
+
+    CHECK_EQUAL(table.where().explain().actual_rows, 5000);
+    CHECK(table.where().explain().conditions.empty());
+    CHECK_EQUAL(plan.description().substr(0, 5), "SCAN ");
+}
+
+TEST(QueryPlanner_OrOfEqualities)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int");
+    auto col_str = table.add_column(type_String, "str");
+    auto col_plain = table.add_column(type_Int, "plain");
+    table.add_search_index(col_int);
+    table.add_search_index(col_str);
+    for (int64_t i = 0; i < 4000; ++i)
+        table.create_object().set_all(i % 4, util::to_string(i % 8), i % 4);
+
+    // The values match too many rows to look each of them up in the index
+    for (auto col : {col_int, col_plain}) {
+        Query q = table.where().equal(col, 1).Or().equal(col, 2).Or().equal(col, 7);
+        CHECK_EQUAL(q.count(), 2000);
+        CHECK_EQUAL(q.find_all().size(), 2000);
+        QueryPlan plan = q.explain();
+        CHECK_EQUAL(plan.conditions.size(), 1);
+        CHECK_LESS(std::abs(plan.estimated_rows - 2000), 400);
+        CHECK(!plan.index_driven);
+    }
+    Query q = table.where().equal(col_str, "1").Or().equal(col_str, "2").Or().equal(col_str, "5");
+    CHECK_EQUAL(q.count(), 1500);
+    CHECK_EQUAL(q.find_all().size(), 1500);
+
+    // Few matches are still looked up in the index
+    Table unique;
+    auto col_key = unique.add_column(type_Int, "key");
+    unique.add_search_index(col_key);
+    for (int64_t i = 0; i < 4000; ++i)
+        unique.create_object().set(col_key, i);
+    q = unique.where().equal(col_key, 5).Or().equal(col_key, 3000);
+    CHECK_EQUAL(q.count(), 2);
+    CHECK_EQUAL(q.find_all().size(), 2);
+    CHECK_EQUAL(q.get_description(), "(key == 5 or key == 3000)");
+}
+
+#endif // TEST_QUERY_PLANNER
@@ -167,8 +167,8 @@ DWORD winfork(std::string unit_test_name)
 
 namespace {
 
-// async deamon does not start when launching unit tests from osx, so async is currently disabled on osx.
-// Also: async requires interprocess communication, which does not work with our current encryption support.
+// The multiprocess async test relies on fork(), which is not usable in the osx unit test runner.
+// Also: it requires interprocess communication, which does not work with our current encryption support.
 #if !defined(_WIN32) && !REALM_PLATFORM_APPLE
 #if REALM_ANDROID || defined DISABLE_ASYNC || REALM_ENABLE_ENCRYPTION
 bool allow_async = false;
@@ -1933,11 +1933,7 @@ TEST(Shared_ClearColumnWithLinksToSelf)
     }
 }
 
-// disable shared async on windows and any Apple operating system
-// TODO: enable async daemon for OS X - think how to do it in XCode (no issue for build.sh)
-#if !defined(_WIN32) && !REALM_PLATFORM_APPLE
-// Todo. Keywords: winbug
-TEST_IF(Shared_Async, allow_async)
+TEST(Shared_Async)
 {
     SHARED_GROUP_TEST_PATH(path);
 
@@ -1960,10 +1956,6 @@ TEST_IF(Shared_Async, allow_async)
         }
     }
 
-    // Wait for async_commit process to shutdown
-    // FIXME: we need a way to determine properly if the daemon has shot down instead of just sleeping
-    millisleep(1000);
-
     // Read the db again in normal mode to verify
     {
         DBRef db = DB::create(path);
@@ -1976,6 +1968,120 @@ TEST_IF(Shared_Async, allow_async)
 }
 
 
+TEST(Shared_AsyncFlush)
+{
+    SHARED_GROUP_TEST_PATH(path);
+
+    // Nothing is flushed in the background within the duration of the test
+    DBOptions options(DBOptions::Durability::Async);
+    options.async_flush_interval = std::chrono::hours(1);
+    DBRef db = DB::create(path, false, options);
+    {
+        WriteTransaction wt(db);
+        wt.add_table("test")->add_column(type_Int, "value");
+        wt.commit();
+    }
+    CHECK_EQUAL(db->get_number_of_unflushed_versions(), 1);
+    for (int i = 0; i < 3; ++i) {
+        WriteTransaction wt(db);
+        wt.get_table("test")->create_object().set("value", i);
+        wt.commit();
+    }
+    CHECK_EQUAL(db->get_number_of_unflushed_versions(), 4);
+    {
+        // The file header is still bound to the initial snapshot
+        Group g(path);
+        CHECK_NOT(g.has_table("test"));
+    }
+
+    db->flush();
+    CHECK_EQUAL(db->get_number_of_unflushed_versions(), 0);
+    {
+        Group g(path);
+        CHECK_EQUAL(g.get_table("test")->size(), 3);
+    }
+    // Flushing without outstanding versions is a no-op
+    db->flush();
+    CHECK_EQUAL(db->get_number_of_unflushed_versions(), 0);
+
+    // Changes are not lost when the db is closed before they have been flushed
+    {
+        WriteTransaction wt(db);
+        wt.get_table("test")->create_object().set("value", 3);
+        wt.commit();
+    }
+    CHECK_EQUAL(db->get_number_of_unflushed_versions(), 1);
+    db->close();
+    {
+        Group g(path);
+        CHECK_EQUAL(g.get_table("test")->size(), 4);
+    }
+}
+
+
+TEST(Shared_AsyncFlushInterval)
+{
+    SHARED_GROUP_TEST_PATH(path);
+
+    DBOptions options(DBOptions::Durability::Async);
+    options.async_flush_interval = std::chrono::milliseconds(10);
+    DBRef db = DB::create(path, false, options);
+    for (int i = 0; i < 10; ++i) {
+        WriteTransaction wt(db);
+        auto table = wt.get_or_add_table("test");
+        if (table->get_column_count() == 0)
+            table->add_column(type_Int, "value");
+        table->create_object().set("value", i);
+        wt.commit();
+    }
+
+    // The commits are flushed in the background
+    for (int i = 0; i < 1000 && db->get_number_of_unflushed_versions() > 0; ++i)
+        millisleep(10);
+    CHECK_EQUAL(db->get_number_of_unflushed_versions(), 0);
+    {
+        Group g(path);
+        CHECK_EQUAL(g.get_table("test")->size(), 10);
+    }
+}
+
+TEST(Shared_SyncCommitAfterDeferredCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(path);
+    {
+        WriteTransaction wt(db);
+        wt.add_table("test")->add_column(type_Int, "value");
+        wt.commit();
+    }
+
+    // A commit which is not flushed keeps the durable snapshot bound
+    {
+        auto tr = db->start_write();
+        tr->get_table("test")->create_object().set("value", 0);
+        tr->commit_and_continue_as_read(false);
+    }
+    CHECK_EQUAL(db->get_number_of_unflushed_versions(), 1);
+    CHECK_GREATER_EQUAL(db->get_number_of_versions(), 2);
+
+    // The first synchronous commit makes it durable, after which earlier
+    // snapshots are no longer kept
+    for (int i = 1; i < 10; ++i) {
+        WriteTransaction wt(db);
+        wt.get_table("test")->create_object().set("value", i);
+        wt.commit();
+    }
+    CHECK_EQUAL(db->get_number_of_unflushed_versions(), 0);
+    CHECK_LESS_EQUAL(db->get_number_of_versions(), 2);
+    {
+        Group g(path);
+        CHECK_EQUAL(g.get_table("test")->size(), 10);
+    }
+}
+
+// The multiprocess test is disabled on windows and any Apple operating system
+#if !defined(_WIN32) && !REALM_PLATFORM_APPLE
+
 namespace {
 
 #define multiprocess_increments 100
@@ -2076,9 +2182,6 @@ void multiprocess_make_table(std::string path, std::string lock_path, std::strin
     }
 #endif
 #endif
-    // Wait for async_commit process to shutdown
-    // FIXME: No good way of doing this
-    millisleep(1000);
 #else
     {
         Group g(alone_path, Group::mode_ReadWrite);
@@ -2132,10 +2235,7 @@ void multiprocess_threaded(TestContext& test_context, std::string path, int64_t
 void multiprocess_validate_and_clear(TestContext& test_context, std::string path, std::string lock_path, size_t rows,
                                      int result)
 {
-    // Wait for async_commit process to shutdown
-    // FIXME: this is not apropriate
     static_cast<void>(lock_path);
-    millisleep(1000);
 
     // Verify - once more, in sync mode - that the changes were made
     {
@@ -2178,9 +2278,6 @@ TEST_IF(Shared_AsyncMultiprocess, allow_async)
     SHARED_GROUP_TEST_PATH(path);
     SHARED_GROUP_TEST_PATH(alone_path);
 
-    // wait for any daemon hanging around to exit
-    millisleep(1); // FIXME: Is this really acceptable?
-
 #if TEST_DURATION < 1
     multiprocess_make_table(path, path.get_lock_path(), alone_path, 4);
 
@@ -2915,6 +3012,12 @@ TEST(Shared_SessionDurabilityConsistency)
 
         DBOptions::Durability durability_2 = DBOptions::Durability::MemOnly;
         CHECK_LOGIC_ERROR(DB::create(path, no_create, DBOptions(durability_2)), LogicError::mixed_durability);
+
+        // The same durability with and without group commit is reported as a
+        // group commit mismatch
+        DBOptions options(durability_1);
+        options.enable_group_commit = true;
+        CHECK_LOGIC_ERROR(DB::create(path, no_create, options), LogicError::mixed_group_commit);
     }
 }
 
@@ -2941,6 +3044,357 @@ TEST(Shared_CompactEmpty)
 }
 
 
+TEST(Shared_OnlineCompaction)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef sg = DB::create(*hist);
+    ColKey col_int, col_str;
+    {
+        WriteTransaction wt(sg);
+        auto filler = wt.add_table("filler");
+        auto col = filler->add_column(type_String, "str");
+        std::string str(100, 'x');
+        for (int i = 0; i < 20000; ++i)
+            filler->create_object().set(col, str);
+        wt.commit();
+    }
+    {
+        // The live data ends up at the end of the file
+        WriteTransaction wt(sg);
+        auto live = wt.add_table("live");
+        col_int = live->add_column(type_Int, "int");
+        col_str = live->add_column(type_String, "str");
+        live->add_search_index(col_str);
+        for (int i = 0; i < 1000; ++i)
+            live->create_object(ObjKey(i)).set(col_int, i).set(col_str, std::string(20, 'a' + i % 26));
+        wt.commit();
+    }
+    {
+        WriteTransaction wt(sg);
+        wt.get_group().remove_table("filler");
+        wt.commit();
+    }
+    auto check_live = [&](ConstTableRef live) {
+        CHECK_EQUAL(live->size(), 1000);
+        for (int i = 0; i < 1000; i += 7) {
+            Obj obj = live->get_object(ObjKey(i));
+            CHECK_EQUAL(obj.get<Int>(col_int), i);
+            CHECK_EQUAL(obj.get<String>(col_str), std::string(20, 'a' + i % 26));
+        }
+    };
+    size_t orig_file_size = size_t(File(path).get_size());
+
+    CHECK_NOT(sg->online_compaction_in_progress());
+    CHECK(sg->start_online_compaction(16 * 1024));
+    CHECK(sg->online_compaction_in_progress());
+
+    // A reader is not blocked, but holds on to the space it uses
+    std::unique_ptr<Replication> hist2(make_in_realm_history(path));
+    DBRef sg2 = DB::create(*hist2);
+    auto rt = sg->start_read();
+    int commits = 0;
+    while (sg->online_compaction_in_progress() && commits < 1000) {
+        // A snapshot bound in another session is never cut off from the file
+        auto rt2 = sg2->start_read();
+        auto wt = sg->start_write();
+        if (commits % 10 == 0) {
+            auto live = wt->get_table("live");
+            live->create_object(ObjKey(5000)).set(col_str, "temp");
+            live->remove_object(ObjKey(5000));
+        }
+        if (commits % 2)
+            wt->commit();
+        else
+            wt->commit_and_continue_as_read();
+        if (commits == 20) {
+            check_live(rt->get_table("live"));
+            rt = nullptr;
+        }
+        check_live(rt2->get_table("live"));
+        rt2->verify();
+        ++commits;
+    }
+    CHECK_NOT(sg->online_compaction_in_progress());
+    CHECK_GREATER(commits, 2);
+
+    // The file is truncated once no snapshot still bound uses its end, while
+    // the other session keeps it open
+    sg->start_write()->commit();
+    size_t shrunk_file_size = size_t(File(path).get_size());
+    CHECK_LESS(shrunk_file_size, orig_file_size / 4);
+    {
+        ReadTransaction rt2(sg2);
+        check_live(rt2.get_table("live"));
+        rt2.get_group().verify();
+    }
+    {
+        // The file keeps working after having been shrunk, in both sessions
+        WriteTransaction wt(sg2);
+        auto live = wt.get_table("live");
+        for (int i = 1000; i < 2000; ++i)
+            live->create_object(ObjKey(i)).set(col_int, i);
+        wt.commit();
+    }
+    CHECK_GREATER(size_t(File(path).get_size()), shrunk_file_size);
+    {
+        ReadTransaction rt2(sg);
+        CHECK_EQUAL(rt2.get_table("live")->size(), 2000);
+        rt2.get_group().verify();
+    }
+    sg2->close();
+    sg->close();
+    CHECK_LESS(size_t(File(path).get_size()), orig_file_size / 4);
+    sg = DB::create(*hist);
+    {
+        ReadTransaction rt2(sg);
+        auto live = rt2.get_table("live");
+        CHECK_EQUAL(live->size(), 2000);
+        CHECK_EQUAL(live->find_first_string(col_str, std::string(20, 'c')), ObjKey(2));
+        rt2.get_group().verify();
+    }
+}
+
+
+TEST(Shared_OnlineCompactionContinueAsRead)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef sg = DB::create(*hist);
+    ColKey col_int, col_str, col_list;
+    {
+        WriteTransaction wt(sg);
+        auto filler = wt.add_table("filler");
+        auto col = filler->add_column(type_String, "str");
+        std::string str(100, 'x');
+        for (int i = 0; i < 20000; ++i)
+            filler->create_object().set(col, str);
+        wt.commit();
+    }
+    {
+        WriteTransaction wt(sg);
+        auto live = wt.add_table("live");
+        col_int = live->add_column(type_Int, "int");
+        col_str = live->add_column(type_String, "str");
+        col_list = live->add_column_list(type_Int, "list");
+        live->add_search_index(col_str);
+        live->add_search_index(col_int, IndexType::Ordered);
+        for (int i = 0; i < 1000; ++i) {
+            Obj obj = live->create_object(ObjKey(i)).set(col_int, i).set(col_str, std::string(20, 'a' + i % 26));
+            auto list = obj.get_list<Int>(col_list);
+            for (int j = 0; j < 10; ++j)
+                list.add(i + j);
+        }
+        wt.commit();
+    }
+    {
+        WriteTransaction wt(sg);
+        wt.get_group().remove_table("filler");
+        wt.commit();
+    }
+    CHECK(sg->start_online_compaction(4 * 1024));
+
+    // Arrays moved by the commits must not be used through the accessors
+    // that the transaction keeps using afterwards
+    auto tr = sg->start_write();
+    TableRef live = tr->get_table("live");
+    Obj obj = live->get_object(ObjKey(500));
+    auto list = obj.get_list<Int>(col_list);
+    int commits = 0;
+    while (sg->online_compaction_in_progress() && commits < 1000) {
+        obj.set(col_int, commits);
+        tr->commit_and_continue_as_read();
+        CHECK_EQUAL(obj.get<Int>(col_int), commits);
+        CHECK_EQUAL(obj.get<String>(col_str), std::string(20, 'a' + 500 % 26));
+        CHECK_EQUAL(list.size(), 10);
+        CHECK_EQUAL(list.get(3), 503);
+        CHECK_EQUAL(live->size(), 1000);
+        CHECK_EQUAL(live->get_object(ObjKey(999)).get<Int>(col_int), 999);
+        CHECK_EQUAL(live->find_first_string(col_str, std::string(20, 'h')), ObjKey(7));
+        CHECK_EQUAL(live->where().between(col_int, 900, 999).count(), 100);
+        tr->promote_to_write();
+        ++commits;
+    }
+    CHECK_NOT(sg->online_compaction_in_progress());
+    CHECK_GREATER(commits, 2);
+
+    list.add(42);
+    obj.set(col_str, "moved");
+    tr->commit_and_continue_as_read();
+    CHECK_EQUAL(list.size(), 11);
+    CHECK_EQUAL(list.get(10), 42);
+    CHECK_EQUAL(live->find_first_string(col_str, StringData("moved")), ObjKey(500));
+    tr->verify();
+}
+
+
+TEST(Shared_GroupCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.enable_group_commit = true;
+    options.group_commit_max_delay = std::chrono::milliseconds(1);
+    constexpr int num_threads = 4;
+    constexpr int num_commits = 100;
+    ColKey col;
+    {
+        DBRef sg = DB::create(path, false, options);
+        {
+            WriteTransaction wt(sg);
+            auto table = wt.add_table("counters");
+            col = table->add_column(type_Int, "value");
+            for (int i = 0; i < num_threads; ++i)
+                table->create_object(ObjKey(i));
+            wt.commit();
+        }
+
+        // Other participants must agree on the setting
+        CHECK_LOGIC_ERROR(DB::create(path, false, DBOptions()), LogicError::mixed_group_commit);
+
+        // Two of the threads use a DB object of their own
+        DBRef sg_2 = DB::create(path, false, options);
+        auto committer = [&](int ndx) {
+            DBRef db = ndx % 2 ? sg_2 : sg;
+            for (int i = 0; i < num_commits; ++i) {
+                auto wt = db->start_write();
+                auto obj = wt->get_table("counters")->get_object(ObjKey(ndx));
+                obj.set(col, obj.get<Int>(col) + 1);
+                if (i % 3)
+                    wt->commit();
+                else
+                    wt->commit_and_continue_as_read();
+            }
+        };
+        Thread threads[num_threads];
+        for (int i = 0; i < num_threads; ++i)
+            threads[i].start([&committer, i] {
+                committer(i);
+            });
+        for (int i = 0; i < num_threads; ++i)
+            threads[i].join();
+        {
+            WriteTransaction wt(sg_2);
+            wt.get_table("counters")->create_object(ObjKey(num_threads));
+            wt.get_table("counters")->create_object(ObjKey(num_threads + 1));
+            wt.commit();
+        }
+        sg_2->close();
+        ReadTransaction rt(sg);
+        rt.get_group().verify();
+    }
+
+    // A new session starts from the snapshot bound by the file header
+    DBRef sg = DB::create(path);
+    ReadTransaction rt(sg);
+    auto table = rt.get_table("counters");
+    CHECK_EQUAL(table->size(), num_threads + 2);
+    for (int i = 0; i < num_threads; ++i)
+        CHECK_EQUAL(table->get_object(ObjKey(i)).get<Int>(col), num_commits);
+    rt.get_group().verify();
+}
+
+
+TEST(Shared_AsyncWrite)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef sg = DB::create(*hist, DBOptions(crypt_key()));
+    ColKey col;
+    {
+        WriteTransaction wt(sg);
+        col = wt.add_table("table")->add_column(type_Int, "value");
+        wt.commit();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    TransactionRef acquired;
+    int num_durable = 0;
+    auto wait_for = [&](auto&& pred) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, pred);
+    };
+    auto when_durable = [&](std::exception_ptr error) {
+        CHECK_NOT(error);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++num_durable;
+        cv.notify_all();
+    };
+
+    // Does not block while another thread holds the write lock
+    auto wt = sg->start_write();
+    sg->async_begin_write([&](TransactionRef tr, std::exception_ptr error) {
+        CHECK_NOT(error);
+        std::lock_guard<std::mutex> lock(mutex);
+        acquired = std::move(tr);
+        cv.notify_all();
+    });
+    wt->get_table("table")->create_object(ObjKey(0)).set(col, 1);
+    millisleep(10);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        CHECK_NOT(acquired);
+    }
+    wt->commit();
+    wait_for([&] {
+        return bool(acquired);
+    });
+    CHECK_EQUAL(acquired->get_transact_stage(), DB::transact_Writing);
+    CHECK_EQUAL(acquired->get_table("table")->size(), 1);
+    acquired->get_table("table")->create_object(ObjKey(1)).set(col, 2);
+    acquired->async_commit(when_durable);
+    CHECK_EQUAL(acquired->get_transact_stage(), DB::transact_Reading);
+    wait_for([&] {
+        return num_durable == 1;
+    });
+
+    // The lock acquired on behalf of a transaction is lent to it by promote_to_write()
+    auto rt = sg->start_read();
+    bool lock_acquired = false;
+    rt->async_request_write_lock([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        lock_acquired = true;
+        cv.notify_all();
+    });
+    wait_for([&] {
+        return lock_acquired;
+    });
+    CHECK_NOT(sg->start_write(true));
+    rt->promote_to_write();
+    rt->get_table("table")->create_object(ObjKey(2)).set(col, 3);
+    rt->async_commit(when_durable);
+    wait_for([&] {
+        return num_durable == 2;
+    });
+    CHECK(sg->start_write(true));
+
+    // Promoting before the lock has been acquired waits for it, and an
+    // ended transaction gives up its request
+    rt->async_request_write_lock([] {});
+    rt->promote_to_write();
+    rt->rollback_and_continue_as_read();
+    wt = sg->start_write();
+    rt->async_request_write_lock([] {});
+    rt->end_read();
+    wt->commit();
+
+    sg->async_sync_to_disk(when_durable);
+    wait_for([&] {
+        return num_durable == 3;
+    });
+    acquired = nullptr;
+    rt = nullptr;
+    sg->close();
+
+    sg = DB::create(*hist, DBOptions(crypt_key()));
+    ReadTransaction rt2(sg);
+    auto table = rt2.get_table("table");
+    CHECK_EQUAL(table->size(), 3);
+    CHECK_EQUAL(table->get_object(ObjKey(2)).get<Int>(col), 3);
+    rt2.get_group().verify();
+}
+
+
 TEST(Shared_VersionOfBoundSnapshot)
 {
     SHARED_GROUP_TEST_PATH(path);
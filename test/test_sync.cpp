@@ -999,6 +999,315 @@ TEST(Sync_Replication)
 }
 
 
+TEST(Sync_ParallelIntegration)
+{
+    // Replicate changes between pairs of files, with each pair synchronized
+    // through a different server-side file, and with fewer files allowed to be
+    // open than are being integrated concurrently.
+
+    const int num_files = 4;
+    std::vector<std::unique_ptr<DBTestPathGuard>> shared_group_test_path_guards;
+    std::vector<std::unique_ptr<Replication>> histories;
+    std::vector<DBRef> sgs;
+    for (int i = 0; i < 2 * num_files; ++i) {
+        std::string path = get_test_path(test_context.get_test_name(), std::to_string(i));
+        shared_group_test_path_guards.push_back(std::make_unique<DBTestPathGuard>(path));
+        histories.push_back(make_client_replication(path));
+        sgs.push_back(DB::create(*histories.back()));
+    }
+
+    TEST_DIR(dir);
+    ClientServerFixture::Config config;
+    config.server_num_worker_threads = num_files;
+    config.server_max_open_files = 2;
+    ClientServerFixture fixture(dir, test_context, config);
+    fixture.start();
+
+    std::vector<Session> sessions;
+    for (int i = 0; i < 2 * num_files; ++i) {
+        sessions.push_back(fixture.make_session(std::string(*shared_group_test_path_guards[i])));
+        fixture.bind_session(sessions.back(), "/test_" + std::to_string(i / 2));
+    }
+
+    for (int i = 0; i < num_files; ++i) {
+        WriteTransaction wt(sgs[2 * i]);
+        TableRef table = sync::create_table(wt, "class_foo");
+        table->add_column(type_Int, "i");
+        version_type new_version = wt.commit();
+        sessions[2 * i].nonsync_transact_notify(new_version);
+    }
+    for (int j = 0; j < 50; ++j) {
+        for (int i = 0; i < num_files; ++i) {
+            WriteTransaction wt(sgs[2 * i]);
+            wt.get_table("class_foo")->create_object().set("i", int64_t(i * 1000 + j));
+            version_type new_version = wt.commit();
+            sessions[2 * i].nonsync_transact_notify(new_version);
+        }
+    }
+
+    for (int i = 0; i < num_files; ++i) {
+        sessions[2 * i].wait_for_upload_complete_or_client_stopped();
+        sessions[2 * i + 1].wait_for_download_complete_or_client_stopped();
+    }
+
+    for (int i = 0; i < num_files; ++i) {
+        ReadTransaction rt_1(sgs[2 * i]);
+        ReadTransaction rt_2(sgs[2 * i + 1]);
+        CHECK(compare_groups(rt_1, rt_2));
+        ConstTableRef table = rt_2.get_table("class_foo");
+        CHECK(table);
+        if (table)
+            CHECK_EQUAL(50, table->size());
+    }
+}
+
+
+TEST(Sync_ChunkedBootstrapDownload)
+{
+    // Bootstrap two files from a history many times larger than the maximum
+    // download size, the second one from the chunks cached while
+    // bootstrapping the first, and integrate every downloaded changeset in a
+    // transaction of its own.
+
+    SHARED_GROUP_TEST_PATH(path_1);
+    SHARED_GROUP_TEST_PATH(path_2);
+    SHARED_GROUP_TEST_PATH(path_3);
+    std::unique_ptr<Replication> history_1 = make_client_replication(path_1);
+    std::unique_ptr<Replication> history_2 = make_client_replication(path_2);
+    std::unique_ptr<Replication> history_3 = make_client_replication(path_3);
+    DBRef sg_1 = DB::create(*history_1);
+    DBRef sg_2 = DB::create(*history_2);
+    DBRef sg_3 = DB::create(*history_3);
+
+    const int num_transactions = 100;
+    {
+        WriteTransaction wt(sg_1);
+        TableRef table = sync::create_table(wt, "class_foo");
+        table->add_column(type_String, "s");
+        wt.commit();
+    }
+    for (int i = 0; i < num_transactions; ++i) {
+        WriteTransaction wt(sg_1);
+        std::string str = std::to_string(i) + std::string(1000, 'x');
+        wt.get_table("class_foo")->create_object().set("s", StringData(str));
+        wt.commit();
+    }
+
+    TEST_DIR(dir);
+    MockMetrics metrics;
+    ClientServerFixture::Config config;
+    config.server_metrics = &metrics;
+    config.max_download_size = 10000;
+    config.enable_download_bootstrap_cache = true;
+    config.max_integration_batch_size = 1;
+    ClientServerFixture fixture(dir, test_context, config);
+    fixture.start();
+
+    Session session_1 = fixture.make_bound_session(path_1, "/test");
+    session_1.wait_for_upload_complete_or_client_stopped();
+
+    Session session_2 = fixture.make_bound_session(path_2, "/test");
+    session_2.wait_for_download_complete_or_client_stopped();
+    CHECK_EQUAL(metrics.sum_equal("download.cache.hit"), 0);
+    Session session_3 = fixture.make_bound_session(path_3, "/test");
+    session_3.wait_for_download_complete_or_client_stopped();
+    // The history spans more than ten chunks, all of which were cached
+    CHECK_GREATER(metrics.sum_equal("download.cache.hit"), 9);
+
+    ReadTransaction rt_1(sg_1);
+    ReadTransaction rt_2(sg_2);
+    ReadTransaction rt_3(sg_3);
+    CHECK(compare_groups(rt_1, rt_2));
+    CHECK(compare_groups(rt_1, rt_3));
+    CHECK_EQUAL(num_transactions, rt_3.get_table("class_foo")->size());
+    CHECK_GREATER(rt_2.get_version(), version_type(num_transactions));
+    CHECK_GREATER(rt_3.get_version(), version_type(num_transactions));
+}
+
+
+TEST(Sync_SharedBootstrapDownloadCache)
+{
+    // Bootstrap a file, then add to the server-side history and bootstrap
+    // another one. The second bootstrap must reuse the chunks cached by the
+    // first one for the part of the history they have in common, unless the
+    // cache is too small to hold any of them.
+
+    for (size_t max_download_cache_size : {size_t(0x10000000), size_t(1)}) {
+        SHARED_GROUP_TEST_PATH(path_1);
+        SHARED_GROUP_TEST_PATH(path_2);
+        SHARED_GROUP_TEST_PATH(path_3);
+        std::unique_ptr<Replication> history_1 = make_client_replication(path_1);
+        std::unique_ptr<Replication> history_2 = make_client_replication(path_2);
+        std::unique_ptr<Replication> history_3 = make_client_replication(path_3);
+        DBRef sg_1 = DB::create(*history_1);
+        DBRef sg_2 = DB::create(*history_2);
+        DBRef sg_3 = DB::create(*history_3);
+
+        {
+            WriteTransaction wt(sg_1);
+            TableRef table = sync::create_table(wt, "class_foo");
+            table->add_column(type_String, "s");
+            wt.commit();
+        }
+        auto add_objects = [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                WriteTransaction wt(sg_1);
+                std::string str = std::to_string(i) + std::string(1000, 'x');
+                wt.get_table("class_foo")->create_object().set("s", StringData(str));
+                wt.commit();
+            }
+        };
+        add_objects(0, 100);
+
+        TEST_DIR(dir);
+        MockMetrics metrics;
+        ClientServerFixture::Config config;
+        config.server_metrics = &metrics;
+        config.max_download_size = 10000;
+        config.enable_download_bootstrap_cache = true;
+        config.max_download_cache_size = max_download_cache_size;
+        ClientServerFixture fixture(dir, test_context, config);
+        fixture.start();
+
+        Session session_1 = fixture.make_bound_session(path_1, "/test");
+        session_1.wait_for_upload_complete_or_client_stopped();
+
+        Session session_2 = fixture.make_bound_session(path_2, "/test");
+        session_2.wait_for_download_complete_or_client_stopped();
+        CHECK_EQUAL(metrics.sum_equal("download.cache.hit"), 0);
+
+        add_objects(100, 110);
+        session_1.nonsync_transact_notify(sg_1->get_version_of_latest_snapshot());
+        session_1.wait_for_upload_complete_or_client_stopped();
+
+        double num_misses = metrics.sum_equal("download.cache.miss");
+        // The size of the history left to download is reported from the
+        // current history, also when a chunk is served from the cache
+        std::mutex mutex;
+        std::vector<std::uint_fast64_t> totals;
+        Session session_3 = fixture.make_session(path_3);
+        session_3.set_progress_handler([&](std::uint_fast64_t downloaded, std::uint_fast64_t downloadable,
+                                           std::uint_fast64_t, std::uint_fast64_t, std::uint_fast64_t,
+                                           std::uint_fast64_t) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (downloaded > 0)
+                totals.push_back(downloadable);
+        });
+        fixture.bind_session(session_3, "/test");
+        session_3.wait_for_download_complete_or_client_stopped();
+        std::lock_guard<std::mutex> lock(mutex);
+        CHECK_GREATER(totals.size(), 1);
+        for (std::uint_fast64_t total : totals)
+            CHECK_EQUAL(total, totals.back());
+        if (max_download_cache_size == 1) {
+            CHECK_EQUAL(metrics.sum_equal("download.cache.hit"), 0);
+            CHECK_EQUAL(metrics.count_equal("download.cache.size"), 0);
+        }
+        else {
+            CHECK_GREATER(metrics.sum_equal("download.cache.hit"), 5);
+            CHECK_GREATER(metrics.last_equal("download.cache.size"), 0);
+            // Only the history added after the first bootstrap is fetched
+            // again
+            CHECK_LESS(metrics.sum_equal("download.cache.miss") - num_misses, 3);
+        }
+
+        ReadTransaction rt_1(sg_1);
+        ReadTransaction rt_3(sg_3);
+        CHECK(compare_groups(rt_1, rt_3));
+        CHECK_EQUAL(110, rt_3.get_table("class_foo")->size());
+    }
+}
+
+
+TEST(Sync_DownloadCacheServerWideLimit)
+{
+    // Bootstrap from two server files with histories of the same size, the
+    // cache being large enough for the messages of one of them, but not for
+    // those of both. The cache is shared by all files, so bootstrapping from
+    // the second file evicts messages of the first one.
+
+    auto add_history = [&](DBRef sg) {
+        {
+            WriteTransaction wt(sg);
+            TableRef table = sync::create_table(wt, "class_foo");
+            table->add_column(type_String, "s");
+            wt.commit();
+        }
+        Random random(random_int<unsigned long>()); // Seed from slow global generator
+        for (int i = 0; i < 100; ++i) {
+            WriteTransaction wt(sg);
+            std::string str(1000, ' ');
+            for (char& c : str)
+                c = char(random.draw_int('a', 'z'));
+            wt.get_table("class_foo")->create_object().set("s", StringData(str));
+            wt.commit();
+        }
+    };
+
+    double size_of_one_file = 0;
+    for (bool limited : {false, true}) {
+        SHARED_GROUP_TEST_PATH(path_1);
+        SHARED_GROUP_TEST_PATH(path_2);
+        SHARED_GROUP_TEST_PATH(path_3);
+        SHARED_GROUP_TEST_PATH(path_4);
+        SHARED_GROUP_TEST_PATH(path_5);
+        std::unique_ptr<Replication> history_1 = make_client_replication(path_1);
+        std::unique_ptr<Replication> history_2 = make_client_replication(path_2);
+        std::unique_ptr<Replication> history_3 = make_client_replication(path_3);
+        std::unique_ptr<Replication> history_4 = make_client_replication(path_4);
+        std::unique_ptr<Replication> history_5 = make_client_replication(path_5);
+        DBRef sg_1 = DB::create(*history_1);
+        DBRef sg_2 = DB::create(*history_2);
+        DBRef sg_3 = DB::create(*history_3);
+        DBRef sg_4 = DB::create(*history_4);
+        DBRef sg_5 = DB::create(*history_5);
+        add_history(sg_1);
+        add_history(sg_2);
+
+        TEST_DIR(dir);
+        MockMetrics metrics;
+        ClientServerFixture::Config config;
+        config.server_metrics = &metrics;
+        config.max_download_size = 10000;
+        config.enable_download_bootstrap_cache = true;
+        if (limited)
+            config.max_download_cache_size = std::size_t(size_of_one_file * 1.5);
+        ClientServerFixture fixture(dir, test_context, config);
+        fixture.start();
+
+        Session session_1 = fixture.make_bound_session(path_1, "/a");
+        Session session_2 = fixture.make_bound_session(path_2, "/b");
+        session_1.wait_for_upload_complete_or_client_stopped();
+        session_2.wait_for_upload_complete_or_client_stopped();
+
+        Session session_3 = fixture.make_bound_session(path_3, "/a");
+        session_3.wait_for_download_complete_or_client_stopped();
+        if (!limited) {
+            size_of_one_file = metrics.last_equal("download.cache.size");
+            CHECK_GREATER(size_of_one_file, 0);
+            continue;
+        }
+        CHECK_LESS_EQUAL(metrics.last_equal("download.cache.size"), double(config.max_download_cache_size));
+
+        Session session_4 = fixture.make_bound_session(path_4, "/b");
+        session_4.wait_for_download_complete_or_client_stopped();
+        CHECK_LESS_EQUAL(metrics.last_equal("download.cache.size"), double(config.max_download_cache_size));
+        CHECK_EQUAL(metrics.sum_equal("download.cache.hit"), 0);
+
+        // Some of the messages of the first file were evicted
+        double num_misses = metrics.sum_equal("download.cache.miss");
+        Session session_5 = fixture.make_bound_session(path_5, "/a");
+        session_5.wait_for_download_complete_or_client_stopped();
+        CHECK_GREATER(metrics.sum_equal("download.cache.miss"), num_misses);
+        CHECK_LESS_EQUAL(metrics.last_equal("download.cache.size"), double(config.max_download_cache_size));
+
+        ReadTransaction rt_1(sg_1);
+        ReadTransaction rt_5(sg_5);
+        CHECK(compare_groups(rt_1, rt_5));
+    }
+}
+
+
 TEST(Sync_Merge)
 {
 
@@ -903,6 +903,84 @@ TEST(Table_AggregateFuzz)
     }
 }
 
+TEST(Table_AggregateWholeLeaves)
+{
+    // Table aggregates reduce each cluster leaf as a whole. Check them against a
+    // scan of the objects for all integer widths, with and without nulls, and with
+    // enough rows for the SIMD paths and several clusters to be involved.
+    const int64_t ranges[] = {100, 30000, 2000000000, 1000000000000000};
+    for (int64_t range : ranges) {
+        for (bool with_nulls : {false, true}) {
+            Group g;
+            TableRef table = g.add_table("test_table");
+            auto int_col = table->add_column(type_Int, "int");
+            auto int_null_col = table->add_column(type_Int, "int_null", true);
+            auto float_col = table->add_column(type_Float, "float", true);
+            auto double_col = table->add_column(type_Double, "double");
+
+            const size_t rows = 3000;
+            for (size_t t = 0; t < rows; t++) {
+                int64_t value = int64_t(t * 7919 % 2001) * (range / 1000) - range;
+                auto obj = table->create_object().set(int_col, value).set(double_col, double(value) / 3);
+                if (with_nulls && t % 13 == 5)
+                    continue;
+                obj.set(int_null_col, value).set(float_col, float(value % 1000) / 4);
+            }
+
+            int64_t sum_int = 0, sum_int_null = 0;
+            double sum_float = 0, sum_double = 0;
+            size_t nulls = 0;
+            ObjKey max_int_key, min_int_key, max_int_null_key, min_float_key, max_double_key;
+            for (auto obj : *table) {
+                int64_t i = obj.get<Int>(int_col);
+                sum_int += i;
+                sum_double += obj.get<double>(double_col);
+                if (!max_int_key || i > table->get_object(max_int_key).get<Int>(int_col))
+                    max_int_key = obj.get_key();
+                if (!min_int_key || i < table->get_object(min_int_key).get<Int>(int_col))
+                    min_int_key = obj.get_key();
+                if (!max_double_key ||
+                    obj.get<double>(double_col) > table->get_object(max_double_key).get<double>(double_col))
+                    max_double_key = obj.get_key();
+                if (obj.is_null(int_null_col)) {
+                    nulls++;
+                    continue;
+                }
+                sum_int_null += i;
+                sum_float += obj.get<float>(float_col);
+                if (!max_int_null_key || i > *table->get_object(max_int_null_key).get<Optional<Int>>(int_null_col))
+                    max_int_null_key = obj.get_key();
+                if (!min_float_key ||
+                    obj.get<float>(float_col) < table->get_object(min_float_key).get<float>(float_col))
+                    min_float_key = obj.get_key();
+            }
+
+            ObjKey key;
+            size_t cnt;
+            CHECK_EQUAL(table->sum_int(int_col), sum_int);
+            CHECK_EQUAL(table->sum_int(int_null_col), sum_int_null);
+            CHECK_APPROXIMATELY_EQUAL(table->sum_float(float_col), sum_float, 1e-10);
+            CHECK_APPROXIMATELY_EQUAL(table->sum_double(double_col), sum_double, 1e-10);
+            CHECK_APPROXIMATELY_EQUAL(table->average_int(int_null_col, &cnt), double(sum_int_null) / (rows - nulls),
+                                      1e-10);
+            CHECK_EQUAL(cnt, rows - nulls);
+            table->average_float(float_col, &cnt);
+            CHECK_EQUAL(cnt, rows - nulls);
+
+            table->maximum_int(int_col, &key);
+            CHECK_EQUAL(key, max_int_key);
+            table->minimum_int(int_col, &key);
+            CHECK_EQUAL(key, min_int_key);
+            table->maximum_int(int_null_col, &key);
+            CHECK_EQUAL(key, max_int_null_key);
+            table->minimum_float(float_col, &key);
+            CHECK_EQUAL(key, min_float_key);
+            table->maximum_double(double_col, &key);
+            CHECK_EQUAL(key, max_double_key);
+        }
+    }
+}
+
 TEST(Table_ColumnNameTooLong)
 {
     Group group;
@@ -26,6 +26,7 @@
 #include <cwchar>
 
 #include <realm.hpp>
+#include <realm/history.hpp>
 
 #include "util/misc.hpp"
 
@@ -2951,4 +2952,181 @@ TEST(TableView_UpdateQuery)
     CHECK_EQUAL(3, v[1].get<Int>(col));
 }
 
+namespace {
+
+// The order SortDescriptor is expected to produce for `tv`, found by comparing
+// the objects one column at a time
+std::vector<ObjKey> expected_sort_order(TableView& tv, const std::vector<std::vector<ColKey>>& columns,
+                                        const std::vector<bool>& ascending)
+{
+    struct Entry {
+        ObjKey key;
+        size_t index_in_view;
+    };
+    std::vector<Entry> entries;
+    for (size_t i = 0; i < tv.size(); ++i)
+        entries.push_back({tv.get_key(i), i});
+    ConstTableRef table = tv.get_parent();
+
+    // The object at the end of the link path, or an invalid Obj for a null link
+    auto follow = [&](ObjKey key, const std::vector<ColKey>& path) {
+        Obj obj = table->get_object(key);
+        for (size_t i = 0; i + 1 < path.size(); ++i) {
+            if (obj.is_null(path[i]))
+                return Obj();
+            obj = obj.get_linked_object(path[i]);
+        }
+        return obj;
+    };
+
+    std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+        for (size_t t = 0; t < columns.size(); ++t) {
+            Obj obj_a = follow(a.key, columns[t]);
+            Obj obj_b = follow(b.key, columns[t]);
+            if (!obj_a && !obj_b)
+                continue;
+            if (!obj_a || !obj_b)
+                return ascending[t] == bool(obj_a);
+            // Values of the first column are compared as Mixed
+            ColKey col = columns[t].back();
+            int c = t == 0 ? obj_a.get_any(col).compare(obj_b.get_any(col)) : obj_a.cmp(obj_b, col);
+            if (c)
+                return ascending[t] ? c < 0 : c > 0;
+        }
+        return a.index_in_view < b.index_in_view;
+    });
+
+    std::vector<ObjKey> keys;
+    for (auto& entry : entries)
+        keys.push_back(entry.key);
+    return keys;
+}
+
+std::vector<ObjKey> view_keys(const TableView& tv)
+{
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+} // unnamed namespace
+
+TEST(TableView_SortLimit)
+{
+    Group g;
+    TableRef target = g.add_table("target");
+    TableRef origin = g.add_table("origin");
+    auto col_link = origin->add_column(*target, "link");
+    auto col_int = origin->add_column(type_Int, "int", true);
+    auto col_str = origin->add_column(type_String, "str", true);
+    auto col_double = origin->add_column(type_Double, "double");
+    auto col_date = origin->add_column(type_Timestamp, "date", true);
+    auto col_bool = origin->add_column(type_Bool, "bool");
+    auto col_target = target->add_column(type_String, "name", true);
+
+    Random random(random_int<unsigned long>());
+    std::vector<ObjKey> target_keys;
+    for (int i = 0; i < 20; ++i) {
+        Obj obj = target->create_object();
+        if (i % 7)
+            obj.set(col_target, util::to_string(random.draw_int_mod(10)));
+        target_keys.push_back(obj.get_key());
+    }
+    // Few distinct values, so that the later columns decide
+    for (int i = 0; i < 1000; ++i) {
+        Obj obj = origin->create_object();
+        if (random.draw_int_mod(10))
+            obj.set(col_link, target_keys[random.draw_int_mod(20)]);
+        if (random.draw_int_mod(10))
+            obj.set(col_int, random.draw_int<int64_t>(-3, 3));
+        if (random.draw_int_mod(10))
+            obj.set(col_str, std::string(random.draw_int_mod(3), 'a' + char(random.draw_int_mod(3))));
+        obj.set(col_double, double(random.draw_int_mod(5)) / 2);
+        if (random.draw_int_mod(10))
+            obj.set(col_date, Timestamp(random.draw_int_mod(4), 0));
+        obj.set(col_bool, random.draw_bool());
+    }
+
+    std::vector<std::vector<std::vector<ColKey>>> orderings = {
+        {{col_int}},
+        {{col_int}, {col_str}, {col_double}},
+        {{col_str}, {col_link, col_target}, {col_date}},
+        {{col_bool}, {col_link, col_target}, {col_double}, {col_int}},
+        {{col_double}, {col_date}, {col_bool}, {col_str}},
+    };
+    for (auto& columns : orderings) {
+        for (bool ascending : {true, false}) {
+            std::vector<bool> asc(columns.size(), ascending);
+            asc.back() = !ascending;
+            TableView tv = origin->where().find_all();
+            std::vector<ObjKey> expected = expected_sort_order(tv, columns, asc);
+
+            TableView sorted = tv;
+            sorted.sort(SortDescriptor(columns, asc));
+            CHECK(view_keys(sorted) == expected);
+
+            for (size_t limit : {size_t(0), size_t(1), size_t(10), size_t(500), expected.size(), size_t(5000)}) {
+                DescriptorOrdering order;
+                order.append_sort(SortDescriptor(columns, asc));
+                order.append_limit(LimitDescriptor(limit));
+                TableView limited = origin->where().find_all(order);
+                size_t expected_size = std::min(limit, expected.size());
+                CHECK_EQUAL(limited.size(), expected_size);
+                CHECK(view_keys(limited) == std::vector<ObjKey>(expected.begin(), expected.begin() + expected_size));
+                CHECK_EQUAL(limited.get_num_results_excluded_by_limit(), expected.size() - expected_size);
+            }
+        }
+    }
+}
+
+TEST(TableView_ParallelSort)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    auto db = DB::create(*hist, DBOptions(crypt_key()));
+    ColKey col_int, col_str, col_double;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int", true);
+        col_str = table->add_column(type_String, "str");
+        col_double = table->add_column(type_Double, "double");
+        Random random(random_int<unsigned long>());
+        for (int i = 0; i < 40000; i++) {
+            auto obj = table->create_object();
+            if (i % 13)
+                obj.set(col_int, random.draw_int<int64_t>(-100, 100));
+            obj.set(col_str, util::to_string(random.draw_int_mod(1000)));
+            obj.set(col_double, double(random.draw_int_mod(100)));
+        }
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    std::vector<std::vector<ColKey>> columns = {{col_int}, {col_str}, {col_double}};
+    std::vector<bool> ascending = {true, false, true};
+    for (size_t max_threads : {2, 3, 8}) {
+        Query sequential = table->where().not_equal(col_double, 50.0);
+        Query parallel = sequential;
+        parallel.set_max_threads(max_threads);
+
+        DescriptorOrdering order;
+        order.append_sort(SortDescriptor(columns, ascending));
+        auto tv1 = sequential.find_all(order);
+        auto tv2 = parallel.find_all(order);
+        CHECK(view_keys(tv1) == view_keys(tv2));
+        if (max_threads == 2)
+            CHECK(view_keys(tv2) == expected_sort_order(tv2, columns, ascending));
+
+        DescriptorOrdering distinct;
+        distinct.append_distinct(DistinctDescriptor({{col_int}, {col_str}}));
+        distinct.append_sort(SortDescriptor({{col_str}}, {false}));
+        tv1 = sequential.find_all(distinct);
+        tv2 = parallel.find_all(distinct);
+        CHECK(view_keys(tv1) == view_keys(tv2));
+    }
+}
+
 #endif // TEST_TABLE_VIEW
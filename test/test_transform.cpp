@@ -2074,4 +2074,147 @@ TEST(Transform_ArrayEraseVsArrayErase)
     server->integrate_next_changeset_from(*client_5);
 }
 
+TEST(Transform_ParseRemoteChangesetsInParallel)
+{
+    auto client = Peer::create_client(test_context, 2, nullptr);
+    client->transaction([](Peer& c) {
+        TableRef t = sync::create_table_with_primary_key(*c.group, "class_t", type_Int, "pk");
+        t->add_column(type_String, "s");
+    });
+    std::string value(1000, 'x');
+    for (int i = 0; i < 200; ++i) {
+        client->transaction([&](Peer& c) {
+            TableRef t = c.table("class_t");
+            t->create_object_with_primary_key(i).set("s", StringData(value));
+        });
+    }
+
+    std::vector<Transformer::RemoteChangeset> remote_changesets;
+    for (version_type version = 2; version <= client->current_version; ++version) {
+        HistoryEntry entry;
+        client->history.get_history_entry(version, entry);
+        Transformer::RemoteChangeset changeset;
+        changeset.remote_version = version;
+        changeset.last_integrated_local_version = 1;
+        changeset.origin_timestamp = entry.origin_timestamp;
+        changeset.origin_file_ident = 2;
+        changeset.data = entry.changeset;
+        remote_changesets.push_back(changeset);
+    }
+    size_t num_changesets = remote_changesets.size();
+
+    std::vector<Changeset> sequential(num_changesets);
+    std::vector<Changeset> parallel(num_changesets);
+    sync::parse_remote_changesets(remote_changesets.data(), num_changesets, sequential.data(), 1);
+    sync::parse_remote_changesets(remote_changesets.data(), num_changesets, parallel.data(), 4);
+    for (size_t i = 0; i < num_changesets; ++i) {
+        CHECK(parallel[i] == sequential[i]);
+        CHECK_EQUAL(parallel[i].version, remote_changesets[i].remote_version);
+        CHECK_EQUAL(parallel[i].last_integrated_remote_version, 1);
+        CHECK_EQUAL(parallel[i].origin_file_ident, 2);
+    }
+
+    // The error is reported on the calling thread
+    const char garbage[] = "\xff\xff\xff\xff";
+    remote_changesets[num_changesets / 2].data = BinaryData{garbage, sizeof garbage};
+    std::vector<Changeset> failed(num_changesets);
+    CHECK_THROW(sync::parse_remote_changesets(remote_changesets.data(), num_changesets, failed.data(), 4),
+                TransformError);
+}
+
+
+TEST(Transform_LargeMergeWindow)
+{
+    auto changeset_dump_dir_gen = get_changeset_dump_dir_generator(test_context);
+    auto server = Peer::create_server(test_context, changeset_dump_dir_gen.get());
+    auto client_1 = Peer::create_client(test_context, 2, changeset_dump_dir_gen.get());
+    auto client_2 = Peer::create_client(test_context, 3, changeset_dump_dir_gen.get());
+
+    // Both clients produce enough concurrent changes for the reciprocal
+    // transforms in the merge window to be parsed on several threads.
+    std::string value(2000, 'x');
+    for (Peer* client : {client_1.get(), client_2.get()}) {
+        client->transaction([](Peer& c) {
+            TableRef t = sync::create_table_with_primary_key(*c.group, "class_t", type_Int, "pk");
+            t->add_column(type_String, "s");
+            t->add_column(type_Int, "i");
+        });
+        for (int i = 0; i < 100; ++i) {
+            client->transaction([&](Peer& c) {
+                TableRef t = c.table("class_t");
+                Obj obj = t->create_object_with_primary_key(i % 10);
+                obj.set("s", StringData(value));
+                obj.add_int("i", c.local_file_ident);
+            });
+        }
+    }
+
+    synchronize(server.get(), {client_1.get(), client_2.get()});
+    synchronize(server.get(), {client_1.get(), client_2.get()});
+
+    ReadTransaction read_server(server->shared_group);
+    ReadTransaction read_client_1(client_1->shared_group);
+    ReadTransaction read_client_2(client_2->shared_group);
+    CHECK(compare_groups(read_server, read_client_1));
+    CHECK(compare_groups(read_server, read_client_2));
+    CHECK_EQUAL(read_server.get_table("class_t")->size(), 10);
+}
+
+
+TEST(Transform_HotObject)
+{
+    // Every transaction modifies the same object, so all instructions end up
+    // in one conflict group, in which each instruction is only merged with the
+    // instructions modifying the same property or erasing the object.
+    auto changeset_dump_dir_gen = get_changeset_dump_dir_generator(test_context);
+    Associativity assoc{test_context, 2, changeset_dump_dir_gen.get()};
+    assoc.for_each_permutation([&](auto& it) {
+        auto server = &*it.server;
+        auto client_1 = &*it.clients[0];
+        auto client_2 = &*it.clients[1];
+
+        client_1->transaction([&](Peer& c) {
+            auto table = sync::create_table_with_primary_key(*c.group, "class_table", type_Int, "pk");
+            table->add_column(type_Int, "a");
+            table->add_column(type_Int, "b");
+            table->add_column(type_Int, "c");
+            table->add_column_list(type_Int, "list");
+            table->create_object_with_primary_key(1);
+            table->create_object_with_primary_key(2);
+        });
+        it.sync_all();
+
+        client_2->history.advance_time(10);
+        for (int64_t i = 0; i < 10; ++i) {
+            client_1->transaction([&](Peer& c) {
+                auto table = c.table("class_table");
+                auto obj = table->get_object_with_primary_key(1);
+                obj.set("a", i);
+                obj.set("c", 100 + i);
+                obj.get_list<Int>("list").add(i);
+                table->get_object_with_primary_key(2).set("a", i);
+            });
+            client_2->transaction([&](Peer& c) {
+                auto table = c.table("class_table");
+                auto obj = table->get_object_with_primary_key(1);
+                obj.set("b", i);
+                obj.set("c", 200 + i);
+                obj.get_list<Int>("list").insert(0, 10 + i);
+                if (i == 5)
+                    table->get_object_with_primary_key(2).remove();
+            });
+        }
+        it.sync_all();
+
+        ReadTransaction rt(server->shared_group);
+        auto table = rt.get_table("class_table");
+        CHECK_EQUAL(table->size(), 1);
+        auto obj = table->get_object_with_primary_key(1);
+        CHECK_EQUAL(obj.get<Int>("a"), 9);
+        CHECK_EQUAL(obj.get<Int>("b"), 9);
+        CHECK_EQUAL(obj.get<Int>("c"), 209);
+        CHECK_EQUAL(obj.get_list<Int>("list").size(), 20);
+    });
+}
+
 } // unnamed namespace
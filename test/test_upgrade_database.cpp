@@ -1707,6 +1707,87 @@ TEST(Upgrade_FixColumnKeys)
     DB::create(*hist)->start_read()->verify();
 }
 
+namespace {
+
+// This Header declaration must match the file format header declared in alloc_slab.hpp
+struct Header {
+    uint64_t m_top_ref[2];
+    uint8_t m_mnemonic[4];
+    uint8_t m_file_format[2];
+    uint8_t m_reserved;
+    uint8_t m_flags;
+};
+
+} // anonymous namespace
+
+// Format 20 files are only upgraded to format 21 on request, and the indexes
+// of format 21 cannot be added to them until then.
+TEST(Upgrade_Database_20_21)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    ColKey col_int, col_str;
+    {
+        DBRef db = DB::create(*hist);
+        auto wt = db->start_write();
+        auto t = wt->add_table("table");
+        col_int = t->add_column(type_Int, "int");
+        col_str = t->add_column(type_String, "str");
+        t->create_object().set(col_int, 5).set(col_str, "a");
+        wt->commit();
+    }
+    {
+        // Nothing in the file is specific to format 21 yet
+        File f(path, File::mode_Update);
+        File::Map<Header> header_map(f, File::access_ReadWrite);
+        Header* header = header_map.get_addr();
+        header->m_file_format[0] = header->m_file_format[1] = 20;
+        header_map.sync();
+    }
+
+    {
+        DBOptions options;
+        options.allow_file_format_upgrade = false;
+        DBRef db = DB::create(*hist, options);
+        auto wt = db->start_write();
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(*wt), 20);
+        auto t = wt->get_table("table");
+        t->add_search_index(col_str);
+        CHECK_THROW_EX(t->add_search_index(col_int, IndexType::Ordered), LogicError,
+                       e.kind() == LogicError::file_format_upgrade_required);
+        CHECK_THROW_EX(t->add_search_index(col_str, IndexType::CaseInsensitive), LogicError,
+                       e.kind() == LogicError::file_format_upgrade_required);
+        CHECK_THROW_EX(t->add_composite_index({col_int, col_str}), LogicError,
+                       e.kind() == LogicError::file_format_upgrade_required);
+        CHECK(t->search_index_type(col_str) == IndexType::General);
+        wt->commit();
+    }
+
+    {
+        DBOptions options;
+        options.upgrade_to_file_format_21 = true;
+        options.allow_file_format_upgrade = false;
+        CHECK_THROW(DB::create(*hist, options), FileFormatUpgradeRequired);
+    }
+
+    int upgraded_from = 0;
+    DBOptions options;
+    options.upgrade_to_file_format_21 = true;
+    options.upgrade_callback = [&](int from, int to) {
+        upgraded_from = from;
+        CHECK_EQUAL(to, 21);
+    };
+    DBRef db = DB::create(*hist, options);
+    CHECK_EQUAL(upgraded_from, 20);
+    auto wt = db->start_write();
+    CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(*wt), 21);
+    auto t = wt->get_table("table");
+    t->add_search_index(col_int, IndexType::Ordered);
+    CHECK(t->search_index_type(col_int) == IndexType::Ordered);
+    CHECK_EQUAL(t->where().greater(col_int, 4).count(), 1);
+    wt->commit();
+}
+
 /*
 TEST(Upgrade_bug)
 {
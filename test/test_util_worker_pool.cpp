@@ -0,0 +1,163 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <realm/util/worker_pool.hpp>
+
+#include "test.hpp"
+
+using namespace realm;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+namespace {
+
+TEST(Util_WorkerPool_RunsEveryIndexOnce)
+{
+    util::WorkerPool pool(3);
+    for (size_t n : {0, 1, 2, 3, 4, 17}) {
+        std::vector<std::atomic<int>> calls(n);
+        pool.run(n, [&](size_t i) {
+            ++calls[i];
+        });
+        for (size_t i = 0; i < n; ++i)
+            CHECK_EQUAL(calls[i].load(), 1);
+    }
+}
+
+TEST(Util_WorkerPool_FirstCallOnCallingThread)
+{
+    util::WorkerPool pool(2);
+    std::thread::id first;
+    pool.run(3, [&](size_t i) {
+        if (i == 0)
+            first = std::this_thread::get_id();
+    });
+    CHECK(first == std::this_thread::get_id());
+}
+
+TEST(Util_WorkerPool_RethrowsLowestIndex)
+{
+    util::WorkerPool pool(2);
+    std::atomic<size_t> num_calls{0};
+    auto func = [&](size_t i) {
+        ++num_calls;
+        if (i % 2 == 1)
+            throw std::runtime_error(std::to_string(i));
+    };
+    try {
+        pool.run(6, func);
+        CHECK(false);
+    }
+    catch (const std::runtime_error& e) {
+        CHECK_EQUAL(std::string(e.what()), "1");
+    }
+    // Every call is made even if some of them throw
+    CHECK_EQUAL(num_calls.load(), 6);
+
+    // The pool is still usable
+    std::atomic<size_t> sum{0};
+    pool.run(4, [&](size_t i) {
+        sum += i;
+    });
+    CHECK_EQUAL(sum.load(), 6);
+}
+
+TEST(Util_WorkerPool_Nested)
+{
+    // More nested calls than there are threads in the pool must not deadlock,
+    // as callers run the calls no pool thread has started
+    util::WorkerPool pool(1);
+    std::atomic<size_t> count{0};
+    pool.run(4, [&](size_t) {
+        pool.run(4, [&](size_t) {
+            pool.run(4, [&](size_t) {
+                ++count;
+            });
+        });
+    });
+    CHECK_EQUAL(count.load(), 64);
+}
+
+TEST(Util_WorkerPool_ConcurrentCallers)
+{
+    util::WorkerPool pool(2);
+    constexpr size_t num_callers = 4;
+    std::vector<size_t> sums(num_callers);
+    std::vector<std::thread> callers;
+    for (size_t c = 0; c < num_callers; ++c) {
+        callers.emplace_back([&, c] {
+            for (int round = 0; round < 100; ++round) {
+                std::atomic<size_t> sum{0};
+                pool.run(8, [&](size_t i) {
+                    sum += i;
+                });
+                sums[c] += sum;
+            }
+        });
+    }
+    for (auto& caller : callers)
+        caller.join();
+    for (size_t c = 0; c < num_callers; ++c)
+        CHECK_EQUAL(sums[c], 2800);
+}
+
+TEST(Util_WorkerPool_RunInParallel)
+{
+    std::vector<int> values(5);
+    util::run_in_parallel(values.size(), [&](size_t i) {
+        values[i] = int(i * i);
+    });
+    for (size_t i = 0; i < values.size(); ++i)
+        CHECK_EQUAL(values[i], int(i * i));
+}
+
+} // unnamed namespace
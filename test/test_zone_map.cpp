@@ -0,0 +1,328 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_ZONE_MAP
+
+#include <realm.hpp>
+#include <realm/history.hpp>
+
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+TEST(ZoneMap_Caching)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("foo");
+        col = table->add_column(type_Int, "int");
+        wt->add_table("bar")->add_column(type_Int, "int");
+        for (int64_t i = 0; i < 3000; ++i)
+            table->create_object().set(col, i);
+
+        // Leafs which are being written are never summarized
+        CHECK_EQUAL(table->where().greater(col, 2500).count(), 499);
+        CHECK_EQUAL(table->get_num_zone_maps(), 0);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto table = rt->get_table("foo");
+    CHECK_EQUAL(table->get_num_zone_maps(), 0);
+    CHECK_EQUAL(table->where().greater(col, 2500).count(), 499);
+    size_t num_leafs = table->get_num_zone_maps();
+    CHECK_GREATER(num_leafs, 1);
+
+    // Unrelated commit
+    {
+        auto wt = db->start_write();
+        wt->get_table("bar")->create_object();
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->get_num_zone_maps(), num_leafs);
+    CHECK_EQUAL(table->where().less(col, 0).count(), 0);
+
+    // The summary of the modified leaf is replaced by that of the new leaf
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("foo");
+        t->get_object(t->size() - 1).set(col, -5);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->get_num_zone_maps(), num_leafs);
+    CHECK_EQUAL(table->where().less(col, 0).count(), 1);
+    CHECK_EQUAL(table->where().greater_equal(col, 2999).count(), 0);
+    CHECK_EQUAL(table->get_num_zone_maps(), num_leafs);
+
+    // Leafs of columns which have not been scanned are not summarized
+    ColKey col2;
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("foo");
+        col2 = t->add_column(type_Int, "int2");
+        for (auto& obj : *t)
+            obj.set(col2, obj.get<int64_t>(col));
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->get_num_zone_maps(), num_leafs);
+    CHECK_EQUAL(table->where().greater(col2, 2500).count(), 498);
+    CHECK_EQUAL(table->get_num_zone_maps(), 2 * num_leafs);
+
+    // Nor those of a column which has been removed
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("foo");
+        t->remove_column(col2);
+        t->get_object(0).set(col, 1);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->where().greater(col, 2500).count(), 498);
+    CHECK_EQUAL(table->where().equal(col, 0).count(), 0);
+    CHECK_LESS_EQUAL(table->get_num_zone_maps(), num_leafs);
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("foo");
+        t->get_object(0).set(col, 0);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->where().equal(col, 0).count(), 1);
+
+    // Changes made by a write transaction promoted from the read transaction
+    rt->promote_to_write();
+    table->get_object(0).set(col, 10000);
+    CHECK_EQUAL(table->where().greater(col, 5000).count(), 1);
+    rt->commit_and_continue_as_read();
+    CHECK_EQUAL(table->where().greater(col, 5000).count(), 1);
+    CHECK_EQUAL(table->where().equal(col, 0).count(), 0);
+
+    rt->promote_to_write();
+    table->get_object(1).set(col, 20000);
+    rt->rollback_and_continue_as_read();
+    CHECK_EQUAL(table->where().greater(col, 15000).count(), 0);
+    CHECK_EQUAL(table->where().equal(col, 1).count(), 1);
+}
+
+TEST(ZoneMap_Query)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history(path);
+    DBRef db = DB::create(*hist);
+
+    auto wt = db->start_write();
+    auto table = wt->add_table("foo");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_int_null = table->add_column(type_Int, "int_null", true);
+    auto col_float = table->add_column(type_Float, "float", true);
+    auto col_double = table->add_column(type_Double, "double");
+    auto col_ts = table->add_column(type_Timestamp, "ts", true);
+    auto col_dec = table->add_column(type_Decimal, "dec", true);
+
+    // Values increase with the object key, so that most leafs can be skipped
+    for (int i = 0; i < 5000; ++i) {
+        int64_t v = i / 10 + random.draw_int<int64_t>(0, 5);
+        auto obj = table->create_object();
+        obj.set(col_int, v);
+        obj.set(col_double, random.draw_int_mod(100) ? double(v) : std::nan(""));
+        if (random.draw_int_mod(20)) {
+            obj.set(col_int_null, v);
+            obj.set(col_float, random.draw_int_mod(100) ? float(v) : std::nanf(""));
+            obj.set(col_ts, Timestamp(v, 0));
+            obj.set(col_dec, random.draw_int_mod(100) ? Decimal128(v) : Decimal128("nan"));
+        }
+    }
+
+    std::vector<Query> queries;
+    for (int64_t v : {-1, 0, 17, 250, 499, 504, 600}) {
+        queries.push_back(table->where().equal(col_int, v));
+        queries.push_back(table->where().greater(col_int, v));
+        queries.push_back(table->where().less_equal(col_int, v));
+        queries.push_back(table->where().less(col_int_null, v));
+        queries.push_back(table->where().greater_equal(col_int_null, v));
+        queries.push_back(table->where().equal(col_int_null, v));
+        queries.push_back(table->where().greater(col_float, float(v)));
+        queries.push_back(table->where().less(col_float, float(v)));
+        queries.push_back(table->where().equal(col_double, double(v)));
+        queries.push_back(table->where().less_equal(col_double, double(v)));
+        queries.push_back(table->where().greater(col_ts, Timestamp(v, 0)));
+        queries.push_back(table->where().less_equal(col_ts, Timestamp(v, 0)));
+        queries.push_back(table->where().less(col_dec, Decimal128(v)));
+        queries.push_back(table->where().greater_equal(col_dec, Decimal128(v)));
+        queries.push_back(table->where().greater(col_int, v).less(col_double, double(v + 20)));
+    }
+    queries.push_back(table->where().equal(col_int_null, null()));
+    queries.push_back(table->where().equal(col_float, null()));
+    queries.push_back(table->where().equal(col_ts, Timestamp()));
+    queries.push_back(table->where().equal(col_dec, Decimal128(null())));
+    queries.push_back(table->where().equal(col_double, std::nan("")));
+
+    // The leafs are not summarized in the write transaction
+    std::vector<size_t> expected;
+    for (auto& q : queries)
+        expected.push_back(q.count());
+    int64_t expected_sum = table->where().greater(col_int, 400).sum_int(col_int);
+    CHECK_EQUAL(table->get_num_zone_maps(), 0);
+    wt->commit_and_continue_as_read();
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+        CHECK_EQUAL(queries[i].count(), expected[i]);
+        CHECK_EQUAL(queries[i].find_all().size(), expected[i]);
+    }
+    CHECK_EQUAL(table->where().greater(col_int, 400).sum_int(col_int), expected_sum);
+    CHECK_GREATER(table->get_num_zone_maps(), 0);
+}
+
+namespace {
+
+template <class LeafType>
+void check_zone_map(unit_test::TestContext& test_context, const LeafType& leaf)
+{
+    // The vectorized summaries must equal the ones computed one value at a
+    // time
+    ZoneMap zone_map = ZoneMap::create(leaf);
+    ZoneMap expected = _impl::zone_map_create_scalar(leaf);
+    CHECK_EQUAL(zone_map.null_count, expected.null_count);
+    CHECK_EQUAL(zone_map.min.is_null(), expected.min.is_null());
+    if (!expected.min.is_null()) {
+        CHECK_EQUAL(zone_map.min, expected.min);
+        CHECK_EQUAL(zone_map.max, expected.max);
+    }
+}
+
+} // unnamed namespace
+
+TEST(ZoneMap_Create)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Allocator& alloc = Allocator::get_default();
+    const double inf = std::numeric_limits<double>::infinity();
+
+    ArrayInteger ints(alloc);
+    ArrayIntNull int_nulls(alloc);
+    BasicArray<double> doubles(alloc);
+    ArrayFloatNull float_nulls(alloc);
+    ints.create();
+    int_nulls.create();
+    doubles.create();
+    float_nulls.create();
+
+    // Empty leafs
+    check_zone_map(test_context, ints);
+    check_zone_map(test_context, int_nulls);
+    check_zone_map(test_context, doubles);
+    check_zone_map(test_context, float_nulls);
+    CHECK(ZoneMap::create(ints).min.is_null());
+    CHECK(ZoneMap::create(doubles).min.is_null());
+
+    // Leafs of only nulls and NaNs
+    for (int i = 0; i < 10; ++i) {
+        int_nulls.add(util::none);
+        doubles.add(std::nan(""));
+        float_nulls.add(i % 2 ? util::Optional<float>() : util::Optional<float>(std::nanf("")));
+    }
+    check_zone_map(test_context, int_nulls);
+    check_zone_map(test_context, doubles);
+    check_zone_map(test_context, float_nulls);
+    CHECK_EQUAL(ZoneMap::create(int_nulls).null_count, 10);
+    CHECK(ZoneMap::create(doubles).min.is_null());
+    CHECK_EQUAL(ZoneMap::create(float_nulls).null_count, 5);
+
+    // Leafs of only infinities
+    doubles.clear();
+    doubles.add(inf);
+    doubles.add(std::nan(""));
+    doubles.add(inf);
+    check_zone_map(test_context, doubles);
+    CHECK_EQUAL(ZoneMap::create(doubles).min, Mixed(inf));
+    doubles.add(-inf);
+    check_zone_map(test_context, doubles);
+    CHECK_EQUAL(ZoneMap::create(doubles).min, Mixed(-inf));
+
+    // Random values of all bit widths, with and without nulls
+    for (int round = 0; round < 100; ++round) {
+        ints.clear();
+        int_nulls.clear();
+        doubles.clear();
+        float_nulls.clear();
+        int bits = random.draw_int(0, 62);
+        int64_t bound = int64_t(uint64_t(1) << bits);
+        bool with_nulls = random.draw_bool();
+        size_t size = random.draw_int<size_t>(1, 1000);
+        for (size_t i = 0; i < size; ++i) {
+            int64_t v = random.draw_int<int64_t>(-bound, bound - 1);
+            bool is_null = with_nulls && random.draw_int_mod(10) == 0;
+            ints.add(v);
+            int_nulls.add(is_null ? util::none : util::make_optional(v));
+            doubles.add(random.draw_int_mod(50) == 0 ? std::nan("") : double(v));
+            float_nulls.add(is_null ? util::none : util::make_optional(float(v)));
+        }
+        check_zone_map(test_context, ints);
+        check_zone_map(test_context, int_nulls);
+        check_zone_map(test_context, doubles);
+        check_zone_map(test_context, float_nulls);
+    }
+
+    ints.destroy();
+    int_nulls.destroy();
+    doubles.destroy();
+    float_nulls.destroy();
+}
+
+#endif // TEST_ZONE_MAP
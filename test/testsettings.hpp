@@ -57,15 +57,21 @@
 #define TEST_GROUP
 #define TEST_UPGRADE
 #define TEST_INDEX_STRING
+#define TEST_INDEX_RANGE
+#define TEST_INDEX_COMPOSITE
+#define TEST_INDEX_COLLECTION
+#define TEST_INDEX_FULLTEXT
 #define TEST_LANG_BIND_HELPER
 #define TEST_METRICS
 #define TEST_PARSER
 #define TEST_QUERY
+#define TEST_QUERY_PLANNER
 #define TEST_SHARED
 #define TEST_STRING_DATA
 #define TEST_BINARY_DATA
 #define TEST_TABLE
 #define TEST_TABLE_VIEW
+#define TEST_ZONE_MAP
 #define TEST_LINK_VIEW
 #define TEST_THREAD
 #define TEST_TRANSACTIONS
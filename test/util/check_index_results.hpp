@@ -0,0 +1,90 @@
+/*************************************************************************
+ *
+ * Copyright 2021 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_TEST_UTIL_CHECK_INDEX_RESULTS_HPP
+#define REALM_TEST_UTIL_CHECK_INDEX_RESULTS_HPP
+
+#include <vector>
+
+#include <realm/query.hpp>
+#include <realm/table.hpp>
+#include <realm/table_view.hpp>
+
+#include "unit_test.hpp"
+
+namespace realm {
+namespace test_util {
+
+/// Run the query, then run it again after `remove_index()` has been called,
+/// and check that both runs find the same objects in the same order, and the
+/// same sum of `sum_col` if it is specified. `add_index()` is called last to
+/// restore the index.
+template <class Remove, class Add>
+void check_same_result(unit_test::TestContext& test_context, Query& q, Remove remove_index, Add add_index,
+                       ColKey sum_col = {})
+{
+    auto with_index = q.find_all();
+    auto count_with_index = q.count();
+    int64_t sum_with_index = sum_col ? q.sum_int(sum_col) : 0;
+    remove_index();
+    auto without_index = q.find_all();
+    int64_t sum_without_index = sum_col ? q.sum_int(sum_col) : 0;
+    add_index();
+
+    CHECK_EQUAL(with_index.size(), without_index.size());
+    CHECK_EQUAL(count_with_index, without_index.size());
+    CHECK_EQUAL(sum_with_index, sum_without_index);
+    for (size_t i = 0; i < with_index.size() && i < without_index.size(); ++i)
+        CHECK_EQUAL(with_index.get_key(i), without_index.get_key(i));
+}
+
+/// Run the query with and without the index on `col`, whatever its type, and
+/// compare the results.
+inline void check_same_result(unit_test::TestContext& test_context, Table& table, ColKey col, Query q)
+{
+    IndexType type = table.search_index_type(col);
+    check_same_result(
+        test_context, q,
+        [&] {
+            table.remove_search_index(col);
+        },
+        [&] {
+            table.add_search_index(col, type);
+        });
+}
+
+/// Run the query with and without the composite index over `columns` and
+/// compare the results.
+inline void check_same_result(unit_test::TestContext& test_context, Table& table, const std::vector<ColKey>& columns,
+                              Query q, ColKey sum_col)
+{
+    check_same_result(
+        test_context, q,
+        [&] {
+            table.remove_composite_index(columns);
+        },
+        [&] {
+            table.add_composite_index(columns);
+        },
+        sum_col);
+}
+
+} // namespace test_util
+} // namespace realm
+
+#endif // REALM_TEST_UTIL_CHECK_INDEX_RESULTS_HPP
@@ -0,0 +1,71 @@
+#[=======================================================================[.rst:
+FindLZ4
+-------
+
+Find the LZ4 library.
+
+Imported Targets
+^^^^^^^^^^^^^^^^
+
+An :ref:`imported target <Imported targets>` named
+``LZ4::LZ4`` is provided if LZ4 has been found.
+
+Result Variables
+^^^^^^^^^^^^^^^^
+
+This module defines the following variables:
+
+``LZ4_FOUND``
+  True if LZ4 was found, false otherwise.
+``LZ4_INCLUDE_DIRS``
+  Include directories needed to include the LZ4 headers.
+``LZ4_LIBRARIES``
+  Libraries needed to link to LZ4.
+``LZ4_VERSION``
+  The version of LZ4 found.
+
+Cache Variables
+^^^^^^^^^^^^^^^
+
+``LZ4_LIBRARY`` and ``LZ4_INCLUDE_DIR`` (the directory containing ``lz4.h``)
+may be set by end users to point at LZ4.
+#]=======================================================================]
+
+find_library(LZ4_LIBRARY
+  NAMES lz4 liblz4
+  )
+mark_as_advanced(LZ4_LIBRARY)
+
+find_path(LZ4_INCLUDE_DIR
+  NAMES lz4.h
+  )
+mark_as_advanced(LZ4_INCLUDE_DIR)
+
+if(LZ4_INCLUDE_DIR AND EXISTS "${LZ4_INCLUDE_DIR}/lz4.h")
+  file(STRINGS "${LZ4_INCLUDE_DIR}/lz4.h" _LZ4_version_lines
+    REGEX "^#define[ \t]+LZ4_VERSION_(MAJOR|MINOR|RELEASE)[ \t]+[0-9]+")
+  foreach(_part MAJOR MINOR RELEASE)
+    string(REGEX REPLACE ".*#define[ \t]+LZ4_VERSION_${_part}[ \t]+([0-9]+).*" "\\1"
+      _LZ4_version_${_part} "${_LZ4_version_lines}")
+  endforeach()
+  set(LZ4_VERSION "${_LZ4_version_MAJOR}.${_LZ4_version_MINOR}.${_LZ4_version_RELEASE}")
+  unset(_LZ4_version_lines)
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4
+  REQUIRED_VARS LZ4_LIBRARY LZ4_INCLUDE_DIR
+  VERSION_VAR LZ4_VERSION
+  )
+
+if(LZ4_FOUND)
+  set(LZ4_INCLUDE_DIRS ${LZ4_INCLUDE_DIR})
+  set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+  if(NOT TARGET LZ4::LZ4)
+    add_library(LZ4::LZ4 UNKNOWN IMPORTED)
+    set_target_properties(LZ4::LZ4 PROPERTIES
+      IMPORTED_LOCATION "${LZ4_LIBRARY}"
+      INTERFACE_INCLUDE_DIRECTORIES "${LZ4_INCLUDE_DIRS}"
+      )
+  endif()
+endif()
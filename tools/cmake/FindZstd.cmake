@@ -0,0 +1,71 @@
+#[=======================================================================[.rst:
+FindZstd
+--------
+
+Find the Zstandard library.
+
+Imported Targets
+^^^^^^^^^^^^^^^^
+
+An :ref:`imported target <Imported targets>` named
+``Zstd::Zstd`` is provided if Zstandard has been found.
+
+Result Variables
+^^^^^^^^^^^^^^^^
+
+This module defines the following variables:
+
+``Zstd_FOUND``
+  True if Zstandard was found, false otherwise.
+``Zstd_INCLUDE_DIRS``
+  Include directories needed to include the Zstandard headers.
+``Zstd_LIBRARIES``
+  Libraries needed to link to Zstandard.
+``Zstd_VERSION``
+  The version of Zstandard found.
+
+Cache Variables
+^^^^^^^^^^^^^^^
+
+``Zstd_LIBRARY`` and ``Zstd_INCLUDE_DIR`` (the directory containing
+``zstd.h``) may be set by end users to point at Zstandard.
+#]=======================================================================]
+
+find_library(Zstd_LIBRARY
+  NAMES zstd zstd_static libzstd
+  )
+mark_as_advanced(Zstd_LIBRARY)
+
+find_path(Zstd_INCLUDE_DIR
+  NAMES zstd.h
+  )
+mark_as_advanced(Zstd_INCLUDE_DIR)
+
+if(Zstd_INCLUDE_DIR AND EXISTS "${Zstd_INCLUDE_DIR}/zstd.h")
+  file(STRINGS "${Zstd_INCLUDE_DIR}/zstd.h" _Zstd_version_lines
+    REGEX "^#define[ \t]+ZSTD_VERSION_(MAJOR|MINOR|RELEASE)[ \t]+[0-9]+")
+  foreach(_part MAJOR MINOR RELEASE)
+    string(REGEX REPLACE ".*#define[ \t]+ZSTD_VERSION_${_part}[ \t]+([0-9]+).*" "\\1"
+      _Zstd_version_${_part} "${_Zstd_version_lines}")
+  endforeach()
+  set(Zstd_VERSION "${_Zstd_version_MAJOR}.${_Zstd_version_MINOR}.${_Zstd_version_RELEASE}")
+  unset(_Zstd_version_lines)
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Zstd
+  REQUIRED_VARS Zstd_LIBRARY Zstd_INCLUDE_DIR
+  VERSION_VAR Zstd_VERSION
+  )
+
+if(Zstd_FOUND)
+  set(Zstd_INCLUDE_DIRS ${Zstd_INCLUDE_DIR})
+  set(Zstd_LIBRARIES ${Zstd_LIBRARY})
+  if(NOT TARGET Zstd::Zstd)
+    add_library(Zstd::Zstd UNKNOWN IMPORTED)
+    set_target_properties(Zstd::Zstd PROPERTIES
+      IMPORTED_LOCATION "${Zstd_LIBRARY}"
+      INTERFACE_INCLUDE_DIRECTORIES "${Zstd_INCLUDE_DIRS}"
+      )
+  endif()
+endif()